@@ -3,32 +3,46 @@
 #include "../iv_logic/ailee_decision_engine.hpp"
 #include "../src/iv_system_types.hpp"
 #include "../src/config_defaults.hpp"
+#include "../src/SeqLock.hpp"
+#include <cstdint>
 #include <string>
-#include <mutex>
 
 namespace ivsys {
 namespace extensions {
 
-// Not thread-safe when using the instance directly; singleton access via
-// get_instance() is protected internally per method with mutex_.
+// What the last apply_decision() did; the log line is rendered from this
+// on read so the control path never formats text.
+struct FlowAdjustmentRecord {
+    std::int64_t wall_time_ms = 0;     // system_clock, ms since epoch
+    DecisionAction action = DecisionAction::MAINTAIN_FLOW;
+    double rate_ml_min = 0.0;
+    double confidence = 0.0;
+    std::uint32_t signal_count = 0;
+    bool fallback_active = false;
+    bool valid = false;                // false until the first decision
+};
+
+// One instance per patient: the fallback EWMA is that patient's history.
+// apply_decision() belongs to the patient's control cycle (one thread at a
+// time) and takes no lock and never allocates; latest() and
+// get_latest_log() may be called from any thread.
 class FlowAdjustmentPlugin {
 public:
     FlowAdjustmentPlugin();
 
-    // Self-registering style, though explicitly called in our integration
-    static FlowAdjustmentPlugin& get_instance();
+    FlowAdjustmentPlugin(const FlowAdjustmentPlugin&) = delete;
+    FlowAdjustmentPlugin& operator=(const FlowAdjustmentPlugin&) = delete;
 
     // Applies the validated decision to the IV simulation's ControlOutput.
-    // Thread-safe: protected by internal mutex.
     void apply_decision(const AileeDecision& decision, ivsys::ControlOutput& current_control);
 
-    // Get latest log string for the observer.
-    // Thread-safe: protected by internal mutex.
+    FlowAdjustmentRecord latest() const { return latest_.load(); }
+
+    // Latest log line for the observer; empty before the first decision.
     std::string get_latest_log() const;
 
 private:
-    mutable std::mutex mutex_;
-    std::string latest_log_;
+    SeqLock<FlowAdjustmentRecord> latest_;
 
     // Fallback logic: EWMA of accepted infusion rates.
     // Initialised to the system minimum so that a pre-warmup fallback is safe.
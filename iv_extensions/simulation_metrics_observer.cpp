@@ -1,75 +1,142 @@
 #include "simulation_metrics_observer.hpp"
 #include <algorithm>
 #include <cmath>
+#include <utility>
+#include <vector>
 
 namespace ivsys {
 namespace extensions {
 
+namespace {
+
+std::atomic<std::uint64_t> g_next_observer_id{1};
+
+// Each shard has exactly one writer, so a relaxed load/store pair is a
+// complete update and readers see either the old or the new value.
+template <typename T>
+void add_relaxed(std::atomic<T>& cell, T delta) {
+    cell.store(cell.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+} // namespace
+
 SimulationMetricsObserver::SimulationMetricsObserver()
-    : total_adjustments_(0), fallback_count_(0), cumulative_confidence_(0.0),
-      decision_count_(0), cumulative_latency_ms_(0.0),
-      prev_aggregate_confidence_(1.0), stability_score_(100.0),
-      cumulative_signal_volatility_(0.0), signal_observation_count_(0) {}
+    : id_(g_next_observer_id.fetch_add(1, std::memory_order_relaxed)) {}
 
 SimulationMetricsObserver& SimulationMetricsObserver::get_instance() {
     static SimulationMetricsObserver instance;
     return instance;
 }
 
+SimulationMetricsObserver::Recorder SimulationMetricsObserver::make_recorder() {
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    shards_.emplace_back();
+    return Recorder(&shards_.back());
+}
+
+SimulationMetricsObserver::Recorder& SimulationMetricsObserver::thread_recorder() {
+    // Keyed by observer id rather than address so a destroyed observer's
+    // entry is never picked up by a new one at the same address.
+    thread_local std::vector<std::pair<std::uint64_t, Recorder>> recorders;
+    for (auto& entry : recorders) {
+        if (entry.first == id_) return entry.second;
+    }
+    recorders.emplace_back(id_, make_recorder());
+    return recorders.back().second;
+}
+
 void SimulationMetricsObserver::observe_decision(const AileeDecision& decision, double latency_ms) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    thread_recorder().observe_decision(decision, latency_ms);
+}
+
+void SimulationMetricsObserver::observe_signals(const SignalFrame& signals) {
+    thread_recorder().observe_signals(signals);
+}
 
-    decision_count_++;
-    cumulative_latency_ms_ += latency_ms;
-    cumulative_confidence_ += decision.aggregate_confidence;
+void SimulationMetricsObserver::Recorder::observe_decision(const AileeDecision& decision, double latency_ms) {
+    Shard& s = *shard_;
+    add_relaxed<std::uint64_t>(s.decisions, 1);
+    add_relaxed(s.cumulative_latency_ms, latency_ms);
+    add_relaxed(s.cumulative_confidence, decision.aggregate_confidence);
 
     if (decision.action == DecisionAction::INCREASE_FLOW || decision.action == DecisionAction::DECREASE_FLOW) {
-        total_adjustments_++;
+        add_relaxed<std::uint64_t>(s.adjustments, 1);
     } else if (decision.action == DecisionAction::FALLBACK_FLOW) {
-        fallback_count_++;
+        add_relaxed<std::uint64_t>(s.fallbacks, 1);
     }
 
     // Update stability score based on confidence volatility.
     // Clamp conf_change to [0.0, 1.0] so that the EWMA term stays non-negative
-    // even on the first call (when prev_aggregate_confidence_ is initialised to 1.0).
-    double conf_change = std::min(1.0, std::abs(decision.aggregate_confidence - prev_aggregate_confidence_));
-    stability_score_ = (stability_score_ * 0.95) + ((1.0 - conf_change) * 100.0 * 0.05);
-    prev_aggregate_confidence_ = decision.aggregate_confidence;
+    // even on the first call (when prev_aggregate_confidence is initialised to 1.0).
+    double conf_change = std::min(1.0, std::abs(decision.aggregate_confidence - s.prev_aggregate_confidence));
+    double stability = s.stability_score.load(std::memory_order_relaxed);
+    s.stability_score.store((stability * 0.95) + ((1.0 - conf_change) * 100.0 * 0.05),
+                            std::memory_order_relaxed);
+    s.prev_aggregate_confidence = decision.aggregate_confidence;
 }
 
-void SimulationMetricsObserver::observe_signals(const std::vector<ModelSignal>& signals) {
-    std::lock_guard<std::mutex> lock(mutex_);
-
+void SimulationMetricsObserver::Recorder::observe_signals(const SignalFrame& signals) {
+    Shard& s = *shard_;
     double current_volatility = 0.0;
-    for (const auto& sig : signals) {
-        if (prev_signal_values_.find(sig.model_id) != prev_signal_values_.end()) {
-            current_volatility += std::abs(sig.value - prev_signal_values_[sig.model_id]);
+    for (const auto& sig : signals.signals) {
+        double& prev = s.prev_signal_values[static_cast<size_t>(sig.id)];
+        if (s.has_prev_signals) {
+            current_volatility += std::abs(sig.value - prev);
         }
-        prev_signal_values_[sig.model_id] = sig.value;
+        prev = sig.value;
     }
+    s.has_prev_signals = true;
 
-    if (!signals.empty()) {
-        cumulative_signal_volatility_ += (current_volatility / signals.size());
-        signal_observation_count_++;
+    add_relaxed(s.cumulative_signal_volatility, current_volatility / signals.size());
+    add_relaxed<std::uint64_t>(s.signal_observations, 1);
+}
+
+SimulationMetricsObserver::Metrics SimulationMetricsObserver::snapshot() const {
+    Metrics m;
+    double confidence = 0.0, latency = 0.0, volatility = 0.0, weighted_stability = 0.0;
+    {
+        std::lock_guard<std::mutex> lock(shards_mutex_);
+        m.shards = shards_.size();
+        for (const Shard& s : shards_) {
+            std::uint64_t decisions = s.decisions.load(std::memory_order_relaxed);
+            m.decisions += decisions;
+            m.total_adjustments += s.adjustments.load(std::memory_order_relaxed);
+            m.fallbacks += s.fallbacks.load(std::memory_order_relaxed);
+            m.signal_observations += s.signal_observations.load(std::memory_order_relaxed);
+            confidence += s.cumulative_confidence.load(std::memory_order_relaxed);
+            latency += s.cumulative_latency_ms.load(std::memory_order_relaxed);
+            volatility += s.cumulative_signal_volatility.load(std::memory_order_relaxed);
+            weighted_stability += s.stability_score.load(std::memory_order_relaxed) * decisions;
+        }
+    }
+    if (m.decisions > 0) {
+        m.fallback_frequency = static_cast<double>(m.fallbacks) / m.decisions;
+        m.average_confidence = confidence / m.decisions;
+        m.average_decision_latency_ms = latency / m.decisions;
+        m.stability_score = weighted_stability / m.decisions;
+    }
+    // Divide by signal observations (not decisions) to avoid a systematically
+    // incorrect average when observe_signals() and observe_decision() are
+    // called at different rates.
+    if (m.signal_observations > 0) {
+        m.vital_signal_volatility = volatility / m.signal_observations;
     }
+    return m;
 }
 
 std::map<std::string, std::string> SimulationMetricsObserver::get_metrics() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    Metrics m = snapshot();
     std::map<std::string, std::string> metrics;
 
-    metrics["total_adjustments"] = std::to_string(total_adjustments_);
-    metrics["fallback_frequency"] = decision_count_ > 0 ? std::to_string((double)fallback_count_ / decision_count_) : "0.0";
-    metrics["average_confidence"] = decision_count_ > 0 ? std::to_string(cumulative_confidence_ / decision_count_) : "0.0";
-    metrics["stability_score"] = std::to_string(stability_score_);
-    metrics["average_decision_latency_ms"] = decision_count_ > 0 ? std::to_string(cumulative_latency_ms_ / decision_count_) : "0.0";
-    // Divide by signal_observation_count_ (not decision_count_) to avoid a
-    // systematically incorrect average when observe_signals() and observe_decision()
-    // are called at different rates.
-    metrics["vital_signal_volatility"] = signal_observation_count_ > 0 ? std::to_string(cumulative_signal_volatility_ / signal_observation_count_) : "0.0";
+    metrics["total_adjustments"] = std::to_string(m.total_adjustments);
+    metrics["fallback_frequency"] = m.decisions > 0 ? std::to_string(m.fallback_frequency) : "0.0";
+    metrics["average_confidence"] = m.decisions > 0 ? std::to_string(m.average_confidence) : "0.0";
+    metrics["stability_score"] = std::to_string(m.stability_score);
+    metrics["average_decision_latency_ms"] = m.decisions > 0 ? std::to_string(m.average_decision_latency_ms) : "0.0";
+    metrics["vital_signal_volatility"] = m.signal_observations > 0 ? std::to_string(m.vital_signal_volatility) : "0.0";
 
     return metrics;
 }
 
 } // namespace extensions
-} // namespace ivsys
\ No newline at end of file
+} // namespace ivsys
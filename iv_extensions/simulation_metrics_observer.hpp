@@ -1,46 +1,97 @@
 #pragma once
 
-#include <mutex>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
 #include <map>
+#include <mutex>
 #include <string>
 #include "../iv_logic/ailee_decision_engine.hpp"
 
 namespace ivsys {
 namespace extensions {
 
+// Passive AILEE metrics, sharded so observing never contends.
+//
+// Each patient cycle (or thread) takes a Recorder; a Recorder owns one
+// cache-line-aligned shard and is the only writer to it, so an observation
+// is a handful of relaxed atomic loads and stores: no lock, no RMW, no
+// allocation.  snapshot() and get_metrics() add the shards up on read.
+// Confidence stability and signal volatility are tracked per shard, i.e.
+// per patient stream when each patient has its own Recorder.
 class SimulationMetricsObserver {
+    struct Shard;
+
 public:
+    struct Metrics {
+        std::uint64_t decisions = 0;
+        std::uint64_t total_adjustments = 0;
+        std::uint64_t fallbacks = 0;
+        std::uint64_t signal_observations = 0;
+        double fallback_frequency = 0.0;
+        double average_confidence = 0.0;
+        double stability_score = 100.0;       // decision-weighted mean over shards, 0-100
+        double average_decision_latency_ms = 0.0;
+        double vital_signal_volatility = 0.0;
+        size_t shards = 0;
+    };
+
+    // Single-writer handle; cheap to copy, valid for the observer's lifetime.
+    // Copies share the shard, so they must stay on one thread at a time.
+    class Recorder {
+    public:
+        void observe_decision(const AileeDecision& decision, double latency_ms);
+        void observe_signals(const SignalFrame& signals);
+
+    private:
+        friend class SimulationMetricsObserver;
+        explicit Recorder(Shard* shard) : shard_(shard) {}
+        Shard* shard_;
+    };
+
     SimulationMetricsObserver();
 
-    // Singleton access
+    // Process-wide instance for code without its own observer
     static SimulationMetricsObserver& get_instance();
 
-    // Called passively when a new decision is made
+    // New shard, e.g. one per patient at setup.  Takes a lock; keep it off
+    // the per-tick path.
+    Recorder make_recorder();
+
+    // Convenience: routed to the calling thread's own shard (made on its
+    // first call).
     void observe_decision(const AileeDecision& decision, double latency_ms);
-    void observe_signals(const std::vector<ModelSignal>& signals);
+    void observe_signals(const SignalFrame& signals);
+
+    Metrics snapshot() const;
 
-    // Read-only access for REST API compatibility
+    // Read-only access for REST API compatibility (snapshot() as text)
     std::map<std::string, std::string> get_metrics() const;
 
 private:
-    mutable std::mutex mutex_;
-
-    // Metrics
-    unsigned long total_adjustments_;
-    unsigned long fallback_count_;
-    double cumulative_confidence_;
-    unsigned long decision_count_;
-    double cumulative_latency_ms_;
-
-    // Volatility tracking
-    double prev_aggregate_confidence_;
-    double stability_score_; // 0-100
-
-    // Vital-signal tracking (uses its own counter to avoid division by decision_count_)
-    std::map<std::string, double> prev_signal_values_;
-    double cumulative_signal_volatility_;
-    unsigned long signal_observation_count_;
+    struct alignas(64) Shard {
+        std::atomic<std::uint64_t> decisions{0};
+        std::atomic<std::uint64_t> adjustments{0};
+        std::atomic<std::uint64_t> fallbacks{0};
+        std::atomic<std::uint64_t> signal_observations{0};
+        std::atomic<double> cumulative_confidence{0.0};
+        std::atomic<double> cumulative_latency_ms{0.0};
+        std::atomic<double> cumulative_signal_volatility{0.0};
+        std::atomic<double> stability_score{100.0};
+
+        // Writer-only state
+        double prev_aggregate_confidence = 1.0;
+        std::array<double, kSignalCount> prev_signal_values{}; // by SignalId
+        bool has_prev_signals = false;
+    };
+
+    Recorder& thread_recorder();
+
+    const std::uint64_t id_;            // keys the per-thread recorder cache
+    mutable std::mutex shards_mutex_;   // registration and aggregation only
+    std::deque<Shard> shards_;          // stable addresses
 };
 
 } // namespace extensions
-} // namespace ivsys
\ No newline at end of file
+} // namespace ivsys
@@ -1,32 +1,56 @@
 #include "ailee_decision_engine.hpp"
-#include <numeric>
+#include <bitset>
 
 namespace ivsys {
 namespace extensions {
 
-AileeDecisionEngine::AileeDecisionEngine() {}
+const char* AileeDecision::reasoning() const {
+    switch (verdict) {
+        case AileeVerdict::ACCEPTED:
+            return "[AILEE: ACCEPTED] High aggregate confidence. Consensus reached.";
+        case AileeVerdict::GRACE:
+            return "[AILEE: GRACE] Borderline confidence. Mediating to MAINTAIN (safe).";
+        case AileeVerdict::GRACE_FAILED:
+            return proposed_action == DecisionAction::INCREASE_FLOW
+                ? "[AILEE: GRACE FAILED] Borderline confidence. Unsafe to apply INCREASE. Triggering FALLBACK."
+                : "[AILEE: GRACE FAILED] Borderline confidence. Unsafe to apply DECREASE. Triggering FALLBACK.";
+        case AileeVerdict::REJECTED:
+            return "[AILEE: REJECTED] Aggregate confidence below safe threshold. Triggering FALLBACK.";
+    }
+    return "";
+}
+
+size_t AileeDecision::contributing_count() const {
+    return std::bitset<32>(contributing_mask).count();
+}
+
+std::vector<std::string> describe_contributing_signals(const AileeDecision& decision,
+                                                       const SignalFrame& frame) {
+    std::vector<std::string> out;
+    for (const auto& sig : frame.signals) {
+        if (decision.contributing_mask & (1u << static_cast<unsigned>(sig.id))) {
+            out.push_back(std::string(sig.model_id()) + " (conf: " + std::to_string(sig.confidence) + ")");
+        }
+    }
+    return out;
+}
 
-double AileeDecisionEngine::calculate_aggregate_confidence(const std::vector<ModelSignal>& signals) const {
-    if (signals.empty()) return 0.0;
+AileeDecisionEngine::AileeDecisionEngine() {}
 
+double AileeDecisionEngine::calculate_aggregate_confidence(const SignalFrame& signals) const {
     double sum = 0.0;
-    for (const auto& sig : signals) {
+    for (const auto& sig : signals.signals) {
         sum += sig.confidence;
     }
     return sum / signals.size();
 }
 
-DecisionAction AileeDecisionEngine::determine_baseline_action(const std::vector<ModelSignal>& signals) const {
+DecisionAction AileeDecisionEngine::determine_baseline_action(const SignalFrame& signals) const {
     // Simulation heuristic: if HR is elevated and BP is low, increase flow;
     // if BP is elevated, decrease flow. Thresholds are simulation-only and
     // are not clinical diagnostic criteria.
-    double hr = 0.0;
-    double bp = 0.0;
-
-    for (const auto& sig : signals) {
-        if (sig.model_id == "hr_monitor_v1")   hr = sig.value;
-        if (sig.model_id == "nibp_monitor_v1") bp = sig.value;
-    }
+    double hr = signals[SignalId::HeartRate].value;
+    double bp = signals[SignalId::BloodPressure].value;
 
     if (hr > HEURISTIC_HR_TACHYCARDIA_BPM && bp < HEURISTIC_BP_HYPOTENSION_MMHG)
         return DecisionAction::INCREASE_FLOW;
@@ -36,45 +60,41 @@ DecisionAction AileeDecisionEngine::determine_baseline_action(const std::vector<
     return DecisionAction::MAINTAIN_FLOW;
 }
 
-AileeDecision AileeDecisionEngine::process_signals(const std::vector<ModelSignal>& signals) {
-    AileeDecision decision;
-
+void AileeDecisionEngine::process_signals(const SignalFrame& signals, AileeDecision& decision) const {
     decision.aggregate_confidence = calculate_aggregate_confidence(signals);
     decision.used_fallback = false;
 
-    for (const auto& sig : signals) {
-        decision.contributing_signals.push_back(sig.model_id + " (conf: " + std::to_string(sig.confidence) + ")");
+    decision.contributing_mask = 0;
+    for (const auto& sig : signals.signals) {
+        decision.contributing_mask |= 1u << static_cast<unsigned>(sig.id);
     }
 
     DecisionAction proposed_action = determine_baseline_action(signals);
+    decision.proposed_action = proposed_action;
 
     // AILEE Logic Application
     if (decision.aggregate_confidence >= CONFIDENCE_THRESHOLD_HIGH) {
         // High confidence -> accept proposed action
         decision.action = proposed_action;
-        decision.reasoning = "[AILEE: ACCEPTED] High aggregate confidence. Consensus reached.";
+        decision.verdict = AileeVerdict::ACCEPTED;
     } else if (decision.aggregate_confidence >= CONFIDENCE_THRESHOLD_LOW) {
         // Borderline confidence -> Grace Logic
         if (proposed_action == DecisionAction::MAINTAIN_FLOW) {
             decision.action = DecisionAction::MAINTAIN_FLOW;
-            decision.reasoning = "[AILEE: GRACE] Borderline confidence. Mediating to MAINTAIN (safe).";
+            decision.verdict = AileeVerdict::GRACE;
         } else {
             // Unsafe to change flow with borderline confidence
             decision.action = DecisionAction::FALLBACK_FLOW;
             decision.used_fallback = true;
-            decision.reasoning = "[AILEE: GRACE FAILED] Borderline confidence. Unsafe to apply " +
-                                 std::string(proposed_action == DecisionAction::INCREASE_FLOW ? "INCREASE" : "DECREASE") +
-                                 ". Triggering FALLBACK.";
+            decision.verdict = AileeVerdict::GRACE_FAILED;
         }
     } else {
         // Low confidence -> Outright Rejected -> Fallback
         decision.action = DecisionAction::FALLBACK_FLOW;
         decision.used_fallback = true;
-        decision.reasoning = "[AILEE: REJECTED] Aggregate confidence below safe threshold. Triggering FALLBACK.";
+        decision.verdict = AileeVerdict::REJECTED;
     }
-
-    return decision;
 }
 
 } // namespace extensions
-} // namespace ivsys
\ No newline at end of file
+} // namespace ivsys
@@ -1,7 +1,8 @@
 #pragma once
 
-#include <vector>
+#include <cstdint>
 #include <string>
+#include <vector>
 #include "vital_signal_generator.hpp"
 
 namespace ivsys {
@@ -14,24 +15,50 @@ enum class DecisionAction {
     FALLBACK_FLOW
 };
 
+// Which AILEE trust layer settled the decision
+enum class AileeVerdict : std::uint8_t {
+    ACCEPTED,       // high confidence, baseline action applied
+    GRACE,          // borderline confidence, mediated to MAINTAIN
+    GRACE_FAILED,   // borderline confidence, change refused -> FALLBACK
+    REJECTED        // low confidence -> FALLBACK
+};
+
+// Trivially copyable: filling one never allocates.  The reasoning text is
+// looked up from the verdict only when it is read.
 struct AileeDecision {
-    DecisionAction action;
-    std::string reasoning;
-    std::vector<std::string> contributing_signals;
-    double aggregate_confidence;
+    DecisionAction action = DecisionAction::MAINTAIN_FLOW;
+    DecisionAction proposed_action = DecisionAction::MAINTAIN_FLOW; // baseline heuristic
+    AileeVerdict verdict = AileeVerdict::REJECTED;
+    double aggregate_confidence = 0.0;
     bool used_fallback = false; // true when FALLBACK_FLOW is triggered
+    std::uint32_t contributing_mask = 0; // bit per SignalId in the aggregate
+
+    // "[AILEE: ACCEPTED] ..." etc.; static storage.
+    const char* reasoning() const;
+    size_t contributing_count() const;
 };
 
+// "hr_monitor_v1 (conf: 0.800000)" per contributing signal of `frame`,
+// the frame the decision was made from.  Allocates; for logs and tests.
+std::vector<std::string> describe_contributing_signals(const AileeDecision& decision,
+                                                       const SignalFrame& frame);
+
 class AileeDecisionEngine {
 public:
     AileeDecisionEngine();
 
-    // Process vital signals and return a validated decision based on AILEE principles.
-    AileeDecision process_signals(const std::vector<ModelSignal>& signals);
+    // Process vital signals and return a validated decision based on AILEE
+    // principles.  No allocation and no string handling.
+    void process_signals(const SignalFrame& signals, AileeDecision& out) const;
+    AileeDecision process_signals(const SignalFrame& signals) const {
+        AileeDecision decision;
+        process_signals(signals, decision);
+        return decision;
+    }
 
 private:
-    double calculate_aggregate_confidence(const std::vector<ModelSignal>& signals) const;
-    DecisionAction determine_baseline_action(const std::vector<ModelSignal>& signals) const;
+    double calculate_aggregate_confidence(const SignalFrame& signals) const;
+    DecisionAction determine_baseline_action(const SignalFrame& signals) const;
 
     // AILEE Trust Thresholds.
     // CONFIDENCE_THRESHOLD_HIGH matches the AILEE Python default (accept_threshold = 0.85).
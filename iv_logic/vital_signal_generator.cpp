@@ -5,28 +5,48 @@
 namespace ivsys {
 namespace extensions {
 
+const char* signal_model_id(SignalId id) {
+    switch (id) {
+        case SignalId::HeartRate:       return "hr_monitor_v1";
+        case SignalId::BloodPressure:   return "nibp_monitor_v1";
+        case SignalId::SpO2:            return "pulse_ox_v1";
+        case SignalId::Temperature:     return "temp_probe_v1";
+        case SignalId::RespiratoryRate: return "resp_estimator_v1";
+        case SignalId::Count:           break;
+    }
+    return "unknown";
+}
+
+const char* degradation_reason_text(DegradationReason reason) {
+    switch (reason) {
+        case DegradationReason::Stable:            return "Stable";
+        case DegradationReason::HighVolatility:    return "High Volatility";
+        case DegradationReason::PoorSensorQuality: return "Poor Sensor Quality";
+        case DegradationReason::DerivedStable:     return "Derived Stable";
+    }
+    return "Unknown";
+}
+
 VitalSignalGenerator::VitalSignalGenerator() {}
 
-double VitalSignalGenerator::calculate_confidence(double base_confidence, double stability_penalty, std::string& reason) {
+double VitalSignalGenerator::calculate_confidence(double base_confidence, double stability_penalty, DegradationReason& reason) {
     double confidence = base_confidence - stability_penalty;
 
     if (confidence < 0.0) confidence = 0.0;
     if (confidence > 1.0) confidence = 1.0;
 
     if (stability_penalty > 0.2) {
-        reason = "High Volatility";
+        reason = DegradationReason::HighVolatility;
     } else if (base_confidence < 0.5) {
-        reason = "Poor Sensor Quality";
+        reason = DegradationReason::PoorSensorQuality;
     } else {
-        reason = "Stable";
+        reason = DegradationReason::Stable;
     }
 
     return confidence;
 }
 
-std::vector<ModelSignal> VitalSignalGenerator::generate_signals(const ivsys::Telemetry& telemetry) {
-    std::vector<ModelSignal> signals;
-
+void VitalSignalGenerator::generate_signals(const ivsys::Telemetry& telemetry, SignalFrame& out) {
     double hr = telemetry.heart_rate_bpm;
     double spo2 = telemetry.spo2_pct;
     double temp = telemetry.temp_celsius;
@@ -52,9 +72,9 @@ std::vector<ModelSignal> VitalSignalGenerator::generate_signals(const ivsys::Tel
     {
         double delta_hr = std::abs(hr - prev_hr_);
         double stability_penalty = std::min(delta_hr / 20.0, 0.5); // Penalty if HR jumps > 20 bpm
-        std::string reason;
+        DegradationReason reason;
         double conf = calculate_confidence(sensor_quality, stability_penalty, reason);
-        signals.push_back({hr, conf, "hr_monitor_v1", reason});
+        out[SignalId::HeartRate] = {SignalId::HeartRate, hr, conf, reason};
         prev_hr_ = hr;
     }
 
@@ -62,9 +82,9 @@ std::vector<ModelSignal> VitalSignalGenerator::generate_signals(const ivsys::Tel
     {
         double delta_bp = std::abs(bp_sys - prev_bp_sys_);
         double stability_penalty = std::min(delta_bp / 30.0, 0.5);
-        std::string reason;
+        DegradationReason reason;
         double conf = calculate_confidence(sensor_quality * 0.9, stability_penalty, reason); // BP slightly less confident
-        signals.push_back({bp_sys, conf, "nibp_monitor_v1", reason});
+        out[SignalId::BloodPressure] = {SignalId::BloodPressure, bp_sys, conf, reason};
         prev_bp_sys_ = bp_sys;
     }
 
@@ -72,9 +92,9 @@ std::vector<ModelSignal> VitalSignalGenerator::generate_signals(const ivsys::Tel
     {
         double delta_spo2 = std::abs(spo2 - prev_spo2_);
         double stability_penalty = std::min(delta_spo2 / 5.0, 0.5);
-        std::string reason;
+        DegradationReason reason;
         double conf = calculate_confidence(sensor_quality, stability_penalty, reason);
-        signals.push_back({spo2, conf, "pulse_ox_v1", reason});
+        out[SignalId::SpO2] = {SignalId::SpO2, spo2, conf, reason};
         prev_spo2_ = spo2;
     }
 
@@ -82,19 +102,18 @@ std::vector<ModelSignal> VitalSignalGenerator::generate_signals(const ivsys::Tel
     {
         double delta_temp = std::abs(temp - prev_temp_);
         double stability_penalty = std::min(delta_temp / 1.0, 0.5);
-        std::string reason;
+        DegradationReason reason;
         double conf = calculate_confidence(sensor_quality, stability_penalty, reason);
-        signals.push_back({temp, conf, "temp_probe_v1", reason});
+        out[SignalId::Temperature] = {SignalId::Temperature, temp, conf, reason};
         prev_temp_ = temp;
     }
 
     // 5. Respiratory Rate (Simulated based on HR & Lactate)
     {
         double resp_rate = 16.0 + (hr - 70.0) * 0.1 + telemetry.lactate_mmol * 1.5;
-        signals.push_back({resp_rate, sensor_quality * 0.85, "resp_estimator_v1", "Derived Stable"});
+        out[SignalId::RespiratoryRate] = {SignalId::RespiratoryRate, resp_rate, sensor_quality * 0.85,
+                                          DegradationReason::DerivedStable};
     }
-
-    return signals;
 }
 
 } // namespace extensions
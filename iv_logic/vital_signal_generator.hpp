@@ -1,19 +1,58 @@
 #pragma once
 
-#include <string>
-#include <vector>
-#include <optional>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include "../src/iv_system_types.hpp"
 
 namespace ivsys {
 namespace extensions {
 
+// One slot per modelled vital.  Adding a vital means adding an id here, its
+// model id in signal_model_id(), and a block in generate_signals().
+enum class SignalId : std::uint8_t {
+    HeartRate,
+    BloodPressure,     // simulated systolic BP
+    SpO2,
+    Temperature,
+    RespiratoryRate,   // derived from HR and lactate
+    Count
+};
+
+constexpr size_t kSignalCount = static_cast<size_t>(SignalId::Count);
+
+// Interned AILEE model id ("hr_monitor_v1", ...); static storage.
+const char* signal_model_id(SignalId id);
+
+// Documented rules for confidence degradation
+enum class DegradationReason : std::uint8_t {
+    Stable,
+    HighVolatility,
+    PoorSensorQuality,
+    DerivedStable
+};
+
+// "Stable", "High Volatility", ...; static storage.
+const char* degradation_reason_text(DegradationReason reason);
+
 // AILEE-style ModelSignal representation
 struct ModelSignal {
+    SignalId id = SignalId::HeartRate;
     double value = 0.0;
     double confidence = 0.0;
-    std::string model_id;
-    std::string degradation_reason; // Documented rules for confidence degradation
+    DegradationReason degradation = DegradationReason::Stable;
+
+    const char* model_id() const { return signal_model_id(id); }
+    const char* degradation_reason() const { return degradation_reason_text(degradation); }
+};
+
+// Every vital in a fixed slot, indexed by SignalId.
+struct SignalFrame {
+    std::array<ModelSignal, kSignalCount> signals{};
+
+    const ModelSignal& operator[](SignalId id) const { return signals[static_cast<size_t>(id)]; }
+    ModelSignal& operator[](SignalId id) { return signals[static_cast<size_t>(id)]; }
+    size_t size() const { return signals.size(); }
 };
 
 // Not thread-safe: instances must be accessed from a single thread.
@@ -23,11 +62,12 @@ class VitalSignalGenerator {
 public:
     VitalSignalGenerator();
 
-    // Convert simulated patient vitals into AILEE-style ModelSignal objects.
-    std::vector<ModelSignal> generate_signals(const ivsys::Telemetry& telemetry);
+    // Convert simulated patient vitals into AILEE-style ModelSignals, one
+    // per slot of the caller's frame.  Never allocates.
+    void generate_signals(const ivsys::Telemetry& telemetry, SignalFrame& out);
 
 private:
-    double calculate_confidence(double raw_confidence, double stability_penalty, std::string& reason);
+    double calculate_confidence(double raw_confidence, double stability_penalty, DegradationReason& reason);
 
     // Track previous values for stability analysis
     double prev_hr_ = 0.0;
@@ -1,12 +1,13 @@
 #include "AdaptiveController.hpp"
 #include "Utils.hpp"
 #include "config_defaults.hpp"
-#include <sstream>
-#include <iomanip>
+#include "control_text.hpp"
 
 namespace ivsys {
 
-double AdaptiveController::calculate_base_rate(const PatientState& state) {
+template <typename Policy>
+double BasicAdaptiveController<Policy>::calculate_base_rate(const PatientState& state) {
+    const config::ControlTuning& tuning = policy_.limits();
     double hydration_deficit = (100.0 - state.hydration_pct) / 100.0;
     double hydration_urgency = hydration_deficit < 0.5 ?
         hydration_deficit : Utils::sigmoid(hydration_deficit, 0.5, 5.0);
@@ -16,50 +17,62 @@ double AdaptiveController::calculate_base_rate(const PatientState& state) {
 
     double risk_amplifier = 1.0 + 0.5 * state.risk_score;
 
-    double base = 0.4 + 1.4 * Utils::clamp(
-        (0.6 * hydration_urgency + 0.4 * energy_need) * risk_amplifier,
+    double base = tuning.base_rate_floor_ml_min + tuning.base_rate_gain * Utils::clamp(
+        (tuning.hydration_urgency_weight * hydration_urgency +
+         tuning.energy_need_weight * energy_need) * risk_amplifier,
         0.0, 1.0
     );
 
     return base;
 }
 
-double AdaptiveController::apply_coherence_modulation(double base_rate, const PatientState& state) {
+template <typename Policy>
+double BasicAdaptiveController<Policy>::apply_coherence_modulation(double base_rate, const PatientState& state) {
     return base_rate * state.coherence_sigma;
 }
 
-double AdaptiveController::apply_cardiac_limiting(double rate, const PatientState& state) {
-    if (state.cardiac_reserve < config::CARDIAC_LIMIT_THRESHOLD) {
-        double scaling = config::CARDIAC_SCALING_BASE + config::CARDIAC_SCALING_RANGE *
-            Utils::sigmoid(state.cardiac_reserve, config::CARDIAC_LIMIT_THRESHOLD, config::CARDIAC_SIGMOID_STEEPNESS);
+template <typename Policy>
+double BasicAdaptiveController<Policy>::apply_cardiac_limiting(double rate, const PatientState& state) {
+    const config::ControlTuning& tuning = policy_.limits();
+    if (state.cardiac_reserve < tuning.cardiac_limit_threshold) {
+        double scaling = tuning.cardiac_scaling_base + config::CARDIAC_SCALING_RANGE *
+            Utils::sigmoid(state.cardiac_reserve, tuning.cardiac_limit_threshold, config::CARDIAC_SIGMOID_STEEPNESS);
         return rate * scaling;
     }
     return rate;
 }
 
-std::string AdaptiveController::generate_rationale(const PatientState& state, double rate,
+Rationale AdaptiveControllerCore::make_rationale(const PatientState& state, double rate,
+                                                 bool safety_limited, bool predictive_boost) {
+    Rationale r;
+    r.code = RationaleCode::Controller;
+    r.safety_limited = safety_limited;
+    r.predictive_boost = predictive_boost;
+    r.hydration_pct = state.hydration_pct;
+    r.energy_T = state.energy_T;
+    r.energy_T_absolute = state.energy_T_absolute;
+    r.risk_score = state.risk_score;
+    r.cardiac_reserve = state.cardiac_reserve;
+    r.coherence_sigma = state.coherence_sigma;
+    r.flow_velocity_cm_s = state.estimated_flow_velocity_cm_s;
+    r.flow_efficiency = state.flow_efficiency;
+    r.rate_ml_min = rate;
+    return r;
+}
+
+std::string AdaptiveControllerCore::generate_rationale(const PatientState& state, double rate,
                                bool safety_limited, bool predictive_boost) {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(2);
-    oss << "H=" << state.hydration_pct << "% ";
-    oss << "E_T=" << state.energy_T << " ";
-    oss << "T=" << state.energy_T_absolute << "W/kg ";
-    oss << "R=" << state.risk_score << " ";
-    oss << "C_res=" << state.cardiac_reserve << " ";
-    oss << "σ=" << state.coherence_sigma << " ";
-    oss << "v=" << state.estimated_flow_velocity_cm_s << "cm/s ";
-    oss << "G(v)=" << state.flow_efficiency << " ";
-    oss << "u=" << rate << "ml/min";
-    if (safety_limited) oss << " [SAFETY_LIM]";
-    if (predictive_boost) oss << " [PRED_BOOST]";
-    return oss.str();
+    return to_string(make_rationale(state, rate, safety_limited, predictive_boost));
 }
 
-AdaptiveController::AdaptiveController(const PatientProfile& prof)
-    : profile(prof), last_command(0.4) {}
+template <typename Policy>
+BasicAdaptiveController<Policy>::BasicAdaptiveController(const PatientProfile& prof, const Policy& policy)
+    : profile(prof), policy_(policy), last_command(0.4) {}
 
-ControlOutput AdaptiveController::decide(const PatientState& state, SafetyMonitor& safety,
-                    StateEstimator& estimator, double dt_minutes) {
+template <typename Policy>
+ControlOutput BasicAdaptiveController<Policy>::decide(const PatientState& state, BasicSafetyMonitor<Policy>& safety,
+                                                      StateEstimatorCore& estimator, double dt_minutes) {
+    const config::ControlTuning& tuning = policy_.limits();
     ControlOutput output;
     bool predictive_boost = false;
 
@@ -67,9 +80,9 @@ ControlOutput AdaptiveController::decide(const PatientState& state, SafetyMonito
     double desired_rate = calculate_base_rate(state);
 
     // Step 2: Predictive control
-    auto predicted = estimator.predict_forward(10);
-    if (predicted.has_value() && predicted->hydration_pct < config::PREDICTIVE_HYDRATION_THRESHOLD) {
-        desired_rate *= config::PREDICTIVE_BOOST_MULTIPLIER;
+    auto predicted = estimator.predict_forward(tuning.prediction_horizon_min);
+    if (predicted.has_value() && predicted->hydration_pct < tuning.predictive_hydration_threshold) {
+        desired_rate *= tuning.predictive_boost_multiplier;
         predictive_boost = true;
     }
 
@@ -92,7 +105,7 @@ ControlOutput AdaptiveController::decide(const PatientState& state, SafetyMonito
     // Step 6: Final output
     output.infusion_ml_per_min = desired_rate;
     output.confidence = 1.0 - state.uncertainty;
-    output.rationale = generate_rationale(state, desired_rate, safety_limited, predictive_boost);
+    output.rationale = make_rationale(state, desired_rate, safety_limited, predictive_boost);
     output.safety_override = !safety_check.passed;
     output.warning_flags = safety_check.warnings;
 
@@ -100,4 +113,10 @@ ControlOutput AdaptiveController::decide(const PatientState& state, SafetyMonito
     return output;
 }
 
+template class BasicAdaptiveController<TunedPolicy>;
+template class BasicAdaptiveController<StandardPolicy>;
+template class BasicAdaptiveController<CardiacPolicy>;
+template class BasicAdaptiveController<RenalPolicy>;
+template class BasicAdaptiveController<PediatricPolicy>;
+
 } // namespace ivsys
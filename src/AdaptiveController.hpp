@@ -3,27 +3,49 @@
 #include "iv_system_types.hpp"
 #include "SafetyMonitor.hpp"
 #include "StateEstimator.hpp"
+#include "config_defaults.hpp"
+#include "control_policy.hpp"
 #include <string>
 
 namespace ivsys {
 
-class AdaptiveController {
+// Rationale helpers shared by every policy.
+class AdaptiveControllerCore {
+public:
+    // Decision summary stored in ControlOutput::rationale: the inputs of
+    // the text, not the text.  Pure function of its arguments, so logs can
+    // store the state and rebuild it on export.
+    static Rationale make_rationale(const PatientState& state, double rate,
+                                    bool safety_limited, bool predictive_boost);
+
+    // The rendered text of make_rationale() (control_text.hpp).
+    static std::string generate_rationale(const PatientState& state, double rate,
+                                          bool safety_limited, bool predictive_boost);
+};
+
+// Instantiated for TunedPolicy and every PatientClassPolicy (AdaptiveController.cpp).
+template <typename Policy>
+class BasicAdaptiveController : public AdaptiveControllerCore {
 private:
     PatientProfile profile;
+    Policy policy_;
     double last_command;
 
     double calculate_base_rate(const PatientState& state);
     double apply_coherence_modulation(double base_rate, const PatientState& state);
     double apply_cardiac_limiting(double rate, const PatientState& state);
-    std::string generate_rationale(const PatientState& state, double rate,
-                                   bool safety_limited, bool predictive_boost);
 
 public:
-    AdaptiveController(const PatientProfile& prof);
+    explicit BasicAdaptiveController(const PatientProfile& prof, const Policy& policy = Policy{});
 
     // Updated to accept explicit time delta (dt_minutes)
-    ControlOutput decide(const PatientState& state, SafetyMonitor& safety,
-                        StateEstimator& estimator, double dt_minutes);
+    ControlOutput decide(const PatientState& state, BasicSafetyMonitor<Policy>& safety,
+                         StateEstimatorCore& estimator, double dt_minutes);
+
+    const Policy& policy() const { return policy_; }
 };
 
+// Run-time tuned controller; a default ControlTuning reproduces config_defaults.hpp.
+using AdaptiveController = BasicAdaptiveController<TunedPolicy>;
+
 } // namespace ivsys
@@ -0,0 +1,209 @@
+#include "BatchStateEstimator.hpp"
+#include "Utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace ivsys {
+
+void TelemetryBatch::reserve(size_t n) {
+    for (auto* col : {&hydration_pct, &heart_rate_bpm, &temp_celsius, &blood_loss_idx,
+                      &fatigue_idx, &anxiety_idx, &signal_quality, &spo2_pct,
+                      &lactate_mmol, &age_years}) {
+        col->reserve(n);
+    }
+}
+
+void TelemetryBatch::clear() {
+    for (auto* col : {&hydration_pct, &heart_rate_bpm, &temp_celsius, &blood_loss_idx,
+                      &fatigue_idx, &anxiety_idx, &signal_quality, &spo2_pct,
+                      &lactate_mmol, &age_years}) {
+        col->clear();
+    }
+}
+
+void TelemetryBatch::push_back(const Telemetry& m, double patient_age_years) {
+    hydration_pct.push_back(m.hydration_pct);
+    heart_rate_bpm.push_back(m.heart_rate_bpm);
+    temp_celsius.push_back(m.temp_celsius);
+    blood_loss_idx.push_back(m.blood_loss_idx);
+    fatigue_idx.push_back(m.fatigue_idx);
+    anxiety_idx.push_back(m.anxiety_idx);
+    signal_quality.push_back(m.signal_quality);
+    spo2_pct.push_back(m.spo2_pct);
+    lactate_mmol.push_back(m.lactate_mmol);
+    age_years.push_back(patient_age_years);
+}
+
+void StateBatch::resize(size_t n) {
+    for (auto* col : {&hydration_pct, &heart_rate_bpm, &coherence_sigma, &energy_T,
+                      &metabolic_load, &cardiac_reserve, &risk_score, &uncertainty}) {
+        col->resize(n);
+    }
+}
+
+PatientState StateBatch::row(size_t i) const {
+    PatientState s;
+    s.hydration_pct = hydration_pct[i];
+    s.heart_rate_bpm = heart_rate_bpm[i];
+    s.coherence_sigma = coherence_sigma[i];
+    s.energy_T = energy_T[i];
+    s.metabolic_load = metabolic_load[i];
+    s.cardiac_reserve = cardiac_reserve[i];
+    s.risk_score = risk_score[i];
+    s.uncertainty = uncertainty[i];
+    return s;
+}
+
+namespace {
+
+// Column forms of the Utils exp shapes: the fastmath batch kernels in
+// ENABLE_FAST_MATH builds (bit-identical to the scalar fastmath path),
+// element-wise Utils otherwise.  in and out may alias.
+void sigmoid_column(const double* in, double* out, size_t n, double center, double steepness) {
+#ifdef ENABLE_FAST_MATH
+    fastmath::sigmoid_batch(in, out, n, center, steepness);
+#else
+    for (size_t i = 0; i < n; ++i) out[i] = Utils::sigmoid(in[i], center, steepness);
+#endif
+}
+
+void exponential_decay_column(const double* in, double* out, size_t n, double rate) {
+#ifdef ENABLE_FAST_MATH
+    fastmath::exponential_decay_batch(in, out, n, rate);
+#else
+    for (size_t i = 0; i < n; ++i) out[i] = Utils::exponential_decay(in[i], rate);
+#endif
+}
+
+} // namespace
+
+// Each block below mirrors the corresponding StateEstimator::calculate_*
+// member expression-for-expression; keep them in sync.
+void BatchStateEstimator::estimate(const TelemetryBatch& in, BatchLayout layout, StateBatch& out) {
+    const size_t n = in.size();
+    for (const auto* col : {&in.heart_rate_bpm, &in.temp_celsius, &in.blood_loss_idx,
+                            &in.fatigue_idx, &in.anxiety_idx, &in.signal_quality,
+                            &in.spo2_pct, &in.lactate_mmol, &in.age_years}) {
+        if (col->size() != n) {
+            throw std::invalid_argument("TelemetryBatch columns must have equal length");
+        }
+    }
+    out.resize(n);
+
+    const double* hyd = in.hydration_pct.data();
+    const double* hr = in.heart_rate_bpm.data();
+    const double* temp = in.temp_celsius.data();
+    const double* blood = in.blood_loss_idx.data();
+    const double* fat = in.fatigue_idx.data();
+    const double* anx = in.anxiety_idx.data();
+    const double* sq = in.signal_quality.data();
+    const double* spo2 = in.spo2_pct.data();
+    const double* lac = in.lactate_mmol.data();
+    const double* age = in.age_years.data();
+
+    double* o_hyd = out.hydration_pct.data();
+    double* o_hr = out.heart_rate_bpm.data();
+    double* o_coh = out.coherence_sigma.data();
+    double* o_e = out.energy_T.data();
+    double* o_load = out.metabolic_load.data();
+    double* o_res = out.cardiac_reserve.data();
+    double* o_risk = out.risk_score.data();
+    double* o_unc = out.uncertainty.data();
+
+    // Pass-through clamps
+    for (size_t i = 0; i < n; ++i) {
+        o_hyd[i] = Utils::clamp(hyd[i], 0.0, 100.0);
+        o_hr[i] = std::max(0.0, hr[i]);
+    }
+
+    // Coherence (range penalties)
+    for (size_t i = 0; i < n; ++i) {
+        double c = sq[i];
+        c *= (hr[i] < 40 || hr[i] > 180) ? 0.5 : 1.0;
+        c *= (temp[i] < 35.0 || temp[i] > 40.0) ? 0.7 : 1.0;
+        c *= (spo2[i] < 85.0) ? 0.6 : 1.0;
+        o_coh[i] = c;
+    }
+
+    // Coherence (HR variance over the previous HR_WINDOW ticks)
+    if (layout == BatchLayout::Series) {
+        for (size_t i = HR_WINDOW; i < n; ++i) {
+            double hr_variance = 0.0;
+            for (size_t k = i - HR_WINDOW; k < i; ++k) {
+                hr_variance += std::pow(hr[k] - hr[i], 2);
+            }
+            hr_variance /= 5.0;
+            o_coh[i] *= (hr_variance > 400.0) ? 0.7 : 1.0;
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        o_coh[i] = Utils::clamp(o_coh[i], 0.1, 1.0);
+    }
+
+    // Energy proxy (rule-based).  The exp terms are computed a column at
+    // a time into output columns that are only filled further down.
+    double* h_term = o_load;
+    double* b_term = o_res;
+    double* o_term = o_risk;
+    double* l_term = o_unc;
+    sigmoid_column(hyd, h_term, n, 60.0, 0.1);
+    exponential_decay_column(blood, b_term, n, 3.0);
+    sigmoid_column(spo2, o_term, n, 92.0, 0.3);
+    for (size_t i = 0; i < n; ++i) l_term[i] = std::max(0.0, lac[i] - 2.0);
+    exponential_decay_column(l_term, l_term, n, 0.5);
+    for (size_t i = 0; i < n; ++i) {
+        double f_term = fat[i] < 0.7 ? 1.0 - fat[i] : 0.3 * (1.0 - fat[i]);
+
+        double energy = 0.30 * h_term[i] + 0.25 * b_term[i] + 0.20 * f_term +
+                        0.15 * o_term[i] + 0.10 * l_term[i];
+        o_e[i] = Utils::clamp(energy, 0.0, 1.0);
+    }
+
+    // Metabolic load
+    for (size_t i = 0; i < n; ++i) {
+        double hr_stress = Utils::clamp((hr[i] - 60.0) / 100.0, 0.0, 1.0);
+        double temp_stress = std::abs(temp[i] - 37.0) / 3.0;
+        double lactate_stress = Utils::clamp(lac[i] / 10.0, 0.0, 1.0);
+        double anxiety_stress = anx[i];
+
+        o_load[i] = Utils::clamp(0.3*hr_stress + 0.25*temp_stress +
+                                 0.25*lactate_stress + 0.2*anxiety_stress, 0.0, 1.0);
+    }
+
+    // Cardiac reserve (sigmoid column computed in place)
+    for (size_t i = 0; i < n; ++i) {
+        double max_predicted_hr = std::max(1.0, 220.0 - age[i]);
+        o_res[i] = hr[i] / max_predicted_hr;   // current_percentage
+    }
+    sigmoid_column(o_res, o_res, n, 0.85, 10.0);
+    for (size_t i = 0; i < n; ++i) {
+        double reserve = 1.0 - o_res[i];
+        reserve *= Utils::clamp(spo2[i] / 95.0, 0.5, 1.0);
+        o_res[i] = Utils::clamp(reserve, 0.0, 1.0);
+    }
+
+    // Risk score
+    for (size_t i = 0; i < n; ++i) {
+        double blood_loss_risk = blood[i];
+        double hypoxia_risk = Utils::clamp((95.0 - spo2[i]) / 10.0, 0.0, 1.0);
+        double hypothermia_risk = std::max(0.0, (36.0 - temp[i]) / 2.0);
+
+        double R_critical = std::max(blood_loss_risk, std::max(hypoxia_risk, hypothermia_risk));
+
+        double dehydration_risk = Utils::clamp((100.0 - hyd[i]) / 50.0, 0.0, 1.0);
+        double energy_depletion_risk = 1.0 - o_e[i];
+        double R_metabolic = 0.4 * dehydration_risk + 0.6 * energy_depletion_risk;
+
+        double R_thermal = std::max(0.0, (temp[i] - 38.5) / 2.0);
+
+        o_risk[i] = Utils::clamp(0.6*R_critical + 0.3*R_metabolic + 0.1*R_thermal, 0.0, 1.0);
+    }
+
+    // Uncertainty
+    for (size_t i = 0; i < n; ++i) {
+        o_unc[i] = 1.0 - (o_coh[i] * (1.0 - 0.3*o_load[i]));
+    }
+}
+
+} // namespace ivsys
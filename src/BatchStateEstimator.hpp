@@ -0,0 +1,92 @@
+#pragma once
+
+/*
+ * BatchStateEstimator.hpp
+ *
+ * Column-oriented (structure-of-arrays) batch variant of StateEstimator for
+ * fleet-wide scoring and offline session re-scoring.
+ *
+ * Each column is a contiguous std::vector<double> and every derived metric
+ * is computed in its own branch-free loop over the batch, so the compiler
+ * can vectorize the arithmetic.  The exp-based terms are evaluated a
+ * column at a time, through the fastmath batch kernels in
+ * ENABLE_FAST_MATH builds (see FastMath.hpp).
+ *
+ * Computed per row: hydration_pct, heart_rate_bpm, coherence_sigma,
+ * energy_T (rule-based proxy), metabolic_load, cardiac_reserve, risk_score
+ * and uncertainty.  Flow velocity and absolute energy transfer depend on
+ * per-patient infusion state and are left to the scalar path.
+ *
+ * Equivalence contract: every output matches StateEstimator::estimate()
+ * within BatchStateEstimator::SCALAR_TOLERANCE (absolute), where
+ *   - BatchLayout::Fleet  rows are independent patients, each equivalent to
+ *                         the first estimate() call on a fresh estimator;
+ *   - BatchLayout::Series rows are consecutive ticks of one patient,
+ *                         equivalent to calling estimate() on one fresh
+ *                         estimator for every row in order.
+ * The neural energy proxy is never used here.
+ */
+
+#include "iv_system_types.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace ivsys {
+
+enum class BatchLayout {
+    Fleet,   // one row per patient
+    Series   // one row per tick of a single patient
+};
+
+struct TelemetryBatch {
+    std::vector<double> hydration_pct;
+    std::vector<double> heart_rate_bpm;
+    std::vector<double> temp_celsius;
+    std::vector<double> blood_loss_idx;
+    std::vector<double> fatigue_idx;
+    std::vector<double> anxiety_idx;
+    std::vector<double> signal_quality;
+    std::vector<double> spo2_pct;
+    std::vector<double> lactate_mmol;
+    std::vector<double> age_years;   // patient age for the row
+
+    size_t size() const { return hydration_pct.size(); }
+    void reserve(size_t n);
+    void clear();
+    void push_back(const Telemetry& m, double patient_age_years);
+};
+
+struct StateBatch {
+    std::vector<double> hydration_pct;
+    std::vector<double> heart_rate_bpm;
+    std::vector<double> coherence_sigma;
+    std::vector<double> energy_T;
+    std::vector<double> metabolic_load;
+    std::vector<double> cardiac_reserve;
+    std::vector<double> risk_score;
+    std::vector<double> uncertainty;
+
+    size_t size() const { return hydration_pct.size(); }
+    void resize(size_t n);
+
+    // Gather one row back into the scalar representation.  Fields not
+    // computed by the batch path are left at their defaults.
+    PatientState row(size_t i) const;
+};
+
+class BatchStateEstimator {
+public:
+    // Maximum absolute deviation from the scalar StateEstimator path.
+    // Both paths evaluate the same expressions in the same order through
+    // libm, so in practice results are bit-identical; the bound leaves room
+    // for compilers that contract multiply-adds differently per loop.
+    static constexpr double SCALAR_TOLERANCE = 1e-12;
+
+    // Number of prior heart-rate samples in the coherence variance window.
+    static constexpr size_t HR_WINDOW = 5;
+
+    // Score every row of `in` into `out` (resized to in.size()).
+    static void estimate(const TelemetryBatch& in, BatchLayout layout, StateBatch& out);
+};
+
+} // namespace ivsys
@@ -0,0 +1,162 @@
+#pragma once
+
+/*
+ * ControlLoopMetrics.hpp
+ *
+ * Per-stage latency and tick-timing counters for a control loop.
+ *
+ * - One LatencyHistogram per LoopStage, plus whole-tick execution time
+ *   and wake-up jitter (tick start minus scheduled time).  Recording is a
+ *   few relaxed atomic adds, so the control thread never blocks and never
+ *   allocates; REST handlers and the logger take snapshots at any time.
+ * - StageClock reads steady_clock once per stage boundary and charges the
+ *   elapsed time to the stage that just finished.  A StageClock without
+ *   metrics does nothing, so uninstrumented cycles pay one branch per lap.
+ * - overrun:         the tick finished after the next tick was due
+ * - skipped periods: whole periods dropped to get back on schedule
+ *
+ * - scheduling:      how the loop thread runs (see realtime_scheduling.hpp),
+ *                    set once by the loop and reported next to the jitter
+ *
+ * A single instance may be shared by several loops; the histograms then
+ * aggregate across them.
+ */
+
+#include "LatencyHistogram.hpp"
+#include "SeqLock.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace ivsys {
+
+enum class LoopStage : size_t {
+    Acquire,    // telemetry acquisition
+    Vault,      // MetaboJoint vault update
+    Uncertainty,  // Monte Carlo rate interval (only with an UncertaintyEngine)
+    Estimate,   // StateEstimator::estimate
+    Spine,      // precision-spine routing
+    Decide,     // AdaptiveController::decide (includes safety evaluation)
+    Log,        // telemetry/control logging and alert emission
+    Publish,    // REST snapshot publication
+    Display,    // console status
+    Count
+};
+
+// Scheduling the loop thread actually obtained; all defaults mean an
+// ordinary time-shared thread.
+struct LoopScheduling {
+    bool realtime = false;          // real-time mode was requested
+    int cpu = -1;                   // pinned core, -1: not pinned
+    int fifo_priority = 0;          // SCHED_FIFO priority, 0: SCHED_OTHER
+    bool memory_locked = false;     // mlockall succeeded
+    std::int64_t spin_ns = 0;       // busy-wait window before each tick
+};
+
+class ControlLoopMetrics {
+public:
+    static constexpr size_t kStageCount = static_cast<size_t>(LoopStage::Count);
+
+    explicit ControlLoopMetrics(std::chrono::nanoseconds period = std::chrono::milliseconds(200))
+        : period_(period) {}
+
+    ControlLoopMetrics(const ControlLoopMetrics&) = delete;
+    ControlLoopMetrics& operator=(const ControlLoopMetrics&) = delete;
+
+    static const char* stage_name(LoopStage stage) {
+        static const char* const kNames[kStageCount] = {
+            "acquire", "vault", "uncertainty", "estimate", "spine", "decide", "log", "publish", "display",
+        };
+        return kNames[static_cast<size_t>(stage)];
+    }
+
+    std::chrono::nanoseconds period() const { return period_; }
+
+    void set_scheduling(const LoopScheduling& scheduling) { scheduling_.store(scheduling); }
+    LoopScheduling scheduling() const { return scheduling_.load(); }
+
+    void record_stage(LoopStage stage, std::chrono::nanoseconds elapsed) {
+        stages_[static_cast<size_t>(stage)].record(elapsed);
+    }
+
+    void record_tick(std::chrono::nanoseconds exec, std::chrono::nanoseconds jitter,
+                     bool overrun, std::uint64_t skipped_periods) {
+        tick_.record(exec);
+        jitter_.record(jitter);
+        ticks_.fetch_add(1, std::memory_order_relaxed);
+        if (overrun) overruns_.fetch_add(1, std::memory_order_relaxed);
+        if (skipped_periods) skipped_.fetch_add(skipped_periods, std::memory_order_relaxed);
+    }
+
+    struct Snapshot {
+        std::uint64_t ticks = 0;
+        std::uint64_t overruns = 0;
+        std::uint64_t skipped_periods = 0;
+        LatencyHistogram::Snapshot tick;
+        LatencyHistogram::Snapshot jitter;
+        std::array<LatencyHistogram::Snapshot, kStageCount> stages;
+
+        const LatencyHistogram::Snapshot& stage(LoopStage s) const {
+            return stages[static_cast<size_t>(s)];
+        }
+
+        // Activity since `earlier` (see LatencyHistogram::Snapshot::since).
+        Snapshot since(const Snapshot& earlier) const {
+            Snapshot d;
+            d.ticks = ticks - earlier.ticks;
+            d.overruns = overruns - earlier.overruns;
+            d.skipped_periods = skipped_periods - earlier.skipped_periods;
+            d.tick = tick.since(earlier.tick);
+            d.jitter = jitter.since(earlier.jitter);
+            for (size_t i = 0; i < kStageCount; ++i) d.stages[i] = stages[i].since(earlier.stages[i]);
+            return d;
+        }
+    };
+
+    Snapshot snapshot() const {
+        Snapshot s;
+        s.ticks = ticks_.load(std::memory_order_relaxed);
+        s.overruns = overruns_.load(std::memory_order_relaxed);
+        s.skipped_periods = skipped_.load(std::memory_order_relaxed);
+        s.tick = tick_.snapshot();
+        s.jitter = jitter_.snapshot();
+        for (size_t i = 0; i < kStageCount; ++i) s.stages[i] = stages_[i].snapshot();
+        return s;
+    }
+
+private:
+    std::chrono::nanoseconds period_;
+    SeqLock<LoopScheduling> scheduling_;
+    std::array<LatencyHistogram, kStageCount> stages_;
+    LatencyHistogram tick_;
+    LatencyHistogram jitter_;
+    std::atomic<std::uint64_t> ticks_{0};
+    std::atomic<std::uint64_t> overruns_{0};
+    std::atomic<std::uint64_t> skipped_{0};
+};
+
+class StageClock {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit StageClock(ControlLoopMetrics* metrics)
+        : metrics_(metrics), last_(metrics ? Clock::now() : Clock::time_point{}) {}
+    StageClock(ControlLoopMetrics* metrics, Clock::time_point start)
+        : metrics_(metrics), last_(start) {}
+
+    // Charge the time since the previous lap (or construction) to `stage`.
+    void lap(LoopStage stage) {
+        if (!metrics_) return;
+        Clock::time_point now = Clock::now();
+        metrics_->record_stage(stage, now - last_);
+        last_ = now;
+    }
+
+private:
+    ControlLoopMetrics* metrics_;
+    Clock::time_point last_;
+};
+
+} // namespace ivsys
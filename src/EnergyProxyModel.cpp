@@ -0,0 +1,116 @@
+#include "EnergyProxyModel.hpp"
+#include "StateEstimator.hpp"
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+
+#ifdef ENABLE_NEURAL_ESTIMATOR
+#include <iostream>
+#endif
+
+namespace ivsys {
+
+void EnergyProxyModel::normalised_inputs(const Telemetry& m, float out[SensorFusionKernel::kInputs]) {
+    out[0] = static_cast<float>(m.hydration_pct  / 100.0);
+    out[1] = static_cast<float>(m.heart_rate_bpm / 200.0);
+    out[2] = static_cast<float>(m.spo2_pct       / 100.0);
+    out[3] = static_cast<float>(m.lactate_mmol   /  20.0);
+    out[4] = static_cast<float>(m.fatigue_idx);
+}
+
+double RuleEnergyProxy::energy_proxy(const Telemetry& m) const {
+    return StateEstimator::rule_energy_proxy(m);
+}
+
+double KernelEnergyProxy::energy_proxy(const Telemetry& m) const {
+    float inputs[SensorFusionKernel::kInputs];
+    normalised_inputs(m, inputs);
+    return static_cast<double>(kernel_.predict(inputs));
+}
+
+#ifdef ENABLE_NEURAL_ESTIMATOR
+double NeuralEnergyProxy::energy_proxy(const Telemetry& m) const {
+    float x[SensorFusionKernel::kInputs];
+    normalised_inputs(m, x);
+    return static_cast<double>(estimator_.predict(x[0], x[1], x[2], x[3], x[4]));
+}
+#endif
+
+EnergyProxyModelPtr rule_energy_proxy() {
+    static const EnergyProxyModelPtr model = std::make_shared<RuleEnergyProxy>();
+    return model;
+}
+
+namespace {
+
+// Blob first, then JSON; make(path, format) builds the model.  Returns
+// null (with report->fallback_reason set) if neither loads.
+template <typename Make>
+EnergyProxyModelPtr load_fastest(const std::string& model_path, EnergyProxyLoadReport& report, Make make) {
+    const struct { ModelFormat format; const char* source; std::string path; } sources[] = {
+        {ModelFormat::Blob, "blob", SensorFusionKernel::blob_path_for(model_path)},
+        {ModelFormat::Json, "json", model_path},
+    };
+    for (const auto& s : sources) {
+        auto start = std::chrono::steady_clock::now();
+        try {
+            EnergyProxyModelPtr model = make(model_path, s.format);
+            report.load_us = std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - start).count();
+            report.model = model->name();
+            report.source = s.source;
+            report.path = s.path;
+            return model;
+        } catch (const std::exception& e) {
+            if (!report.fallback_reason.empty()) report.fallback_reason += "; ";
+            report.fallback_reason += std::string(s.source) + ": " + e.what();
+        }
+    }
+    return nullptr;
+}
+
+struct DefaultModel {
+    EnergyProxyModelPtr model;
+    EnergyProxyLoadReport report;
+};
+
+const DefaultModel& default_model() {
+    static const DefaultModel loaded = [] {
+        DefaultModel d;
+#ifdef ENABLE_NEURAL_ESTIMATOR
+        d.model = load_fastest(NEURAL_MODEL_PATH, d.report, [](const std::string& path, ModelFormat format) {
+            return std::make_shared<const NeuralEnergyProxy>(path, format);
+        });
+        if (!d.model) {
+            std::cerr << "[NeuralEstimator] WARNING: could not load model ("
+                      << d.report.fallback_reason << "); falling back to rule-based estimator.\n";
+        }
+#endif
+        if (!d.model) d.model = rule_energy_proxy();
+        return d;
+    }();
+    return loaded;
+}
+
+} // namespace
+
+EnergyProxyModelPtr load_kernel_energy_proxy(const std::string& model_path, EnergyProxyLoadReport* report) {
+    EnergyProxyLoadReport local;
+    EnergyProxyLoadReport& r = report ? *report : local;
+    r = EnergyProxyLoadReport{};
+    EnergyProxyModelPtr model = load_fastest(model_path, r, [](const std::string& path, ModelFormat format) {
+        return std::make_shared<const KernelEnergyProxy>(path, format);
+    });
+    if (!model) throw std::runtime_error("KernelEnergyProxy: " + r.fallback_reason);
+    return model;
+}
+
+EnergyProxyModelPtr default_energy_proxy() {
+    return default_model().model;
+}
+
+const EnergyProxyLoadReport& default_energy_proxy_report() {
+    return default_model().report;
+}
+
+} // namespace ivsys
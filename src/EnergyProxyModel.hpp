@@ -0,0 +1,134 @@
+#pragma once
+
+/*
+ * EnergyProxyModel.hpp
+ *
+ * Pluggable energy-proxy (E_T) strategy for StateEstimator.
+ *
+ * A model is immutable once constructed: energy_proxy() is const, keeps no
+ * per-call state and never allocates, so one instance is shared read-only
+ * (std::shared_ptr<const EnergyProxyModel>) by every estimator, worker
+ * thread and replay that should use it.  Loading happens in the model's
+ * constructor, i.e. at startup, never on the estimate() path.
+ *
+ * Kernel-backed models load either the fdeep JSON or the packed blob next
+ * to it (SensorFusionKernel::blob_path_for(), built by ai_iv_model_pack).
+ * The blob is mapped and checksummed instead of parsed, so the default
+ * model tries it first and falls back to the JSON, also when the blob was
+ * packed from a different JSON; the load report says which one was used
+ * and how long it took.
+ *
+ *   RuleEnergyProxy    - the hand-crafted formula (StateEstimator::rule_energy_proxy)
+ *   KernelEnergyProxy  - SensorFusionKernel over the fdeep JSON weights;
+ *                        available in every build
+ *   NeuralEnergyProxy  - NeuralStateEstimator (kernel cross-checked against
+ *                        frugally-deep); ENABLE_NEURAL_ESTIMATOR builds only
+ *
+ * A TFLite backend would be another subclass.
+ */
+
+#include "iv_system_types.hpp"
+#include "SensorFusionKernel.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#ifdef ENABLE_NEURAL_ESTIMATOR
+#include "NeuralStateEstimator.hpp"
+#endif
+
+namespace ivsys {
+
+class EnergyProxyModel {
+public:
+    virtual ~EnergyProxyModel() = default;
+
+    virtual const char* name() const = 0;
+
+    // E_T in [0, 1] for one telemetry sample.  Must be safe to call from
+    // any number of threads at once.
+    virtual double energy_proxy(const Telemetry& m) const = 0;
+
+    // Network inputs {hydration/100, hr/200, spo2/100, lactate/20, fatigue}.
+    static void normalised_inputs(const Telemetry& m, float out[SensorFusionKernel::kInputs]);
+};
+
+using EnergyProxyModelPtr = std::shared_ptr<const EnergyProxyModel>;
+
+// What a kernel-backed model is loaded from, given the JSON model path.
+enum class ModelFormat : std::uint8_t {
+    Json,    // the frugally-deep JSON itself
+    Blob,    // blob_path_for(model_path), rejected if packed from another JSON
+};
+
+// How a model was obtained, for the startup log.
+struct EnergyProxyLoadReport {
+    std::string model = "rule";      // EnergyProxyModel::name()
+    std::string source = "builtin";  // "blob", "json" or "builtin"
+    std::string path;                // file loaded, empty for builtin
+    double load_us = 0.0;            // wall time of the successful load
+    std::string fallback_reason;     // why a faster source was skipped
+};
+
+class RuleEnergyProxy : public EnergyProxyModel {
+public:
+    const char* name() const override { return "rule"; }
+    double energy_proxy(const Telemetry& m) const override;
+};
+
+class KernelEnergyProxy : public EnergyProxyModel {
+public:
+    // Throws std::runtime_error if the model cannot be loaded.
+    explicit KernelEnergyProxy(const std::string& model_path, ModelFormat format = ModelFormat::Json) {
+        if (format == ModelFormat::Blob) kernel_.load_blob(SensorFusionKernel::blob_path_for(model_path), model_path);
+        else kernel_.load(model_path);
+    }
+
+    const char* name() const override { return "kernel"; }
+    double energy_proxy(const Telemetry& m) const override;
+
+    const SensorFusionKernel& kernel() const { return kernel_; }
+
+private:
+    SensorFusionKernel kernel_;
+};
+
+#ifdef ENABLE_NEURAL_ESTIMATOR
+class NeuralEnergyProxy : public EnergyProxyModel {
+public:
+    // Throws std::runtime_error if the model cannot be loaded or verified.
+    // A blob loads the kernel alone (see NeuralStateEstimator::load_blob()).
+    explicit NeuralEnergyProxy(const std::string& model_path, ModelFormat format = ModelFormat::Json) {
+        if (format == ModelFormat::Blob) {
+            estimator_.load_blob(SensorFusionKernel::blob_path_for(model_path), model_path);
+        } else {
+            estimator_.load(model_path);
+        }
+    }
+
+    const char* name() const override { return "neural"; }
+    double energy_proxy(const Telemetry& m) const override;
+
+private:
+    NeuralStateEstimator estimator_;
+};
+#endif
+
+// Shared rule-based model.
+EnergyProxyModelPtr rule_energy_proxy();
+
+// KernelEnergyProxy from blob_path_for(model_path) if that loads and is
+// current, else from the JSON at model_path.  Throws std::runtime_error if neither does.
+EnergyProxyModelPtr load_kernel_energy_proxy(const std::string& model_path,
+                                             EnergyProxyLoadReport* report = nullptr);
+
+// The build's default model, constructed on the first call and shared
+// afterwards; call it during startup.  Neural builds load the blob next to
+// NEURAL_MODEL_PATH, then the JSON itself, and fall back to the rule model
+// (with a warning on stderr) if both fail; other builds return
+// rule_energy_proxy().
+EnergyProxyModelPtr default_energy_proxy();
+// How default_energy_proxy() was loaded (loads it if it was not yet).
+const EnergyProxyLoadReport& default_energy_proxy_report();
+
+} // namespace ivsys
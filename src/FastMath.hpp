@@ -0,0 +1,139 @@
+#pragma once
+
+/*
+ * FastMath.hpp
+ *
+ * Bounded-error exp() kernels for bulk analytics (batch scoring, replay,
+ * what-if sweeps), plus the three Utils shapes built on them.
+ *
+ * - exp(x): Cody-Waite reduction x = n*ln2 + r with |r| <= ln2/2, a
+ *   degree-8 Taylor polynomial in r, and 2^n assembled directly in the
+ *   exponent bits.  No table, no branches, no libm call.
+ * - Every kernel is written once over 2-lane double vectors (SSE2 / NEON
+ *   width, GCC vector extensions); the scalar forms run the same lanes, so
+ *   scalar and batch results are bit-identical.
+ *
+ * Accuracy contract (checked by tests/test_fast_math.cpp):
+ *   exp(x)                 relative error <= kExpMaxRelError for
+ *                          -707.5 <= x <= 709.78; exp(x < -707.5) = 0
+ *                          (no subnormals), overflow gives +inf, NaN -> NaN
+ *   sigmoid(x, c, k)       absolute error <= kExpMaxRelError / 4
+ *   exponential_decay(x,k) absolute error <= kExpMaxRelError for k*x >= 0
+ *   gaussian(x, c, s)      absolute error <= kExpMaxRelError
+ *
+ * Utils uses these only when built with -DENABLE_FAST_MATH (make
+ * FAST_MATH=1); clinical builds keep libm.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ivsys {
+namespace fastmath {
+
+// Taylor remainder (ln2/2)^9 / 9! * e^(ln2/2) = 2.8e-10, plus rounding.
+constexpr double kExpMaxRelError = 3e-10;
+
+typedef double Doubles __attribute__((vector_size(16)));
+typedef std::int64_t Int64s __attribute__((vector_size(16)));
+constexpr size_t kLanes = 2;
+
+inline Doubles exp_lanes(Doubles x) {
+    const Doubles lo = {-707.5, -707.5};    // keeps 2^(n-1) a normal number
+    const Doubles hi = {710.0, 710.0};
+    const Doubles zero = {0.0, 0.0};
+    const Doubles log2e = {1.4426950408889634, 1.4426950408889634};
+    const Doubles shifter = {0x1.8p52, 0x1.8p52};            // round-to-nearest trick
+    const Doubles ln2_hi = {0x1.62e42fee00000p-1, 0x1.62e42fee00000p-1};
+    const Doubles ln2_lo = {0x1.a39ef35793c76p-33, 0x1.a39ef35793c76p-33};
+
+    Int64s underflow = x < lo;
+    Doubles xc = x < lo ? lo : x;
+    xc = xc > hi ? hi : xc;                 // NaN passes through both
+
+    Doubles t = xc * log2e + shifter;
+    Doubles n = t - shifter;                // nearest integer to x / ln2
+    Doubles r = (xc - n * ln2_hi) - n * ln2_lo;
+
+    Doubles p = r * (1.0 / 40320.0) + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    p = p * r + 1.0;
+
+    // 2^(n-1) from the exponent bits (the low bits of t hold n offset by
+    // the shifter's own bits), then one more doubling so results just
+    // below DBL_MAX do not overflow early.
+    Int64s k = (Int64s)t - (Int64s)shifter;
+    Doubles scale = (Doubles)((k + 1022) << 52);
+
+    Doubles result = p * scale * 2.0;
+    return underflow ? zero : result;
+}
+
+inline double exp(double x) {
+    Doubles v = {x, x};
+    return exp_lanes(v)[0];
+}
+
+inline double sigmoid(double x, double center = 0.0, double steepness = 1.0) {
+    return 1.0 / (1.0 + exp(-steepness * (x - center)));
+}
+
+inline double exponential_decay(double x, double rate = 1.0) {
+    return exp(-rate * x);
+}
+
+inline double gaussian(double x, double center, double sigma) {
+    if (sigma <= 0.0) return 0.0;
+    double z = (x - center) / sigma;
+    return exp(-0.5 * z * z);
+}
+
+// Batch forms: out[i] = f(in[i]) for i < n.  in and out may alias.
+template <typename Lanewise>
+inline void apply_lanes(const double* in, double* out, size_t n, Lanewise f) {
+    size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        Doubles v = {in[i], in[i + 1]};
+        Doubles r = f(v);
+        out[i] = r[0];
+        out[i + 1] = r[1];
+    }
+    if (i < n) {
+        Doubles v = {in[i], in[i]};
+        out[i] = f(v)[0];
+    }
+}
+
+inline void exp_batch(const double* in, double* out, size_t n) {
+    apply_lanes(in, out, n, [](Doubles v) { return exp_lanes(v); });
+}
+
+inline void sigmoid_batch(const double* in, double* out, size_t n,
+                          double center = 0.0, double steepness = 1.0) {
+    apply_lanes(in, out, n, [=](Doubles v) {
+        return 1.0 / (1.0 + exp_lanes(-steepness * (v - center)));
+    });
+}
+
+inline void exponential_decay_batch(const double* in, double* out, size_t n, double rate = 1.0) {
+    apply_lanes(in, out, n, [=](Doubles v) { return exp_lanes(-rate * v); });
+}
+
+inline void gaussian_batch(const double* in, double* out, size_t n, double center, double sigma) {
+    if (sigma <= 0.0) {
+        for (size_t i = 0; i < n; ++i) out[i] = 0.0;
+        return;
+    }
+    apply_lanes(in, out, n, [=](Doubles v) {
+        Doubles z = (v - center) / sigma;
+        return exp_lanes(-0.5 * z * z);
+    });
+}
+
+} // namespace fastmath
+} // namespace ivsys
@@ -0,0 +1,134 @@
+#include "ForwardPredictor.hpp"
+#include "Utils.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace ivsys {
+
+// x = [level, trend], F = [[1, 1], [0, 1]], H = [1, 0],
+// Q = diag(level, trend), R = measurement.
+
+void ForwardPredictor::TrendFilter::init(double z, const ChannelNoise& noise) {
+    level = z;
+    trend = 0.0;
+    p00 = noise.measurement;
+    p01 = 0.0;
+    p11 = noise.measurement;   // slope unknown to within one reading
+}
+
+void ForwardPredictor::TrendFilter::update(double z, const ChannelNoise& noise) {
+    // Predict one step
+    double l = level + trend;
+    double q00 = p00 + 2.0 * p01 + p11 + noise.level;
+    double q01 = p01 + p11;
+    double q11 = p11 + noise.trend;
+
+    // Correct
+    double s = q00 + noise.measurement;
+    double k0 = q00 / s;
+    double k1 = q01 / s;
+    double innovation = z - l;
+    level = l + k0 * innovation;
+    trend += k1 * innovation;
+    p00 = (1.0 - k0) * q00;
+    p01 = (1.0 - k0) * q01;
+    p11 = q11 - k1 * q01;
+}
+
+double ForwardPredictor::TrendFilter::forecast_variance(int h, const ChannelNoise& noise) const {
+    // Var(l + h b) plus h level disturbances and the trend disturbances
+    // each carried over the remaining steps: sum_{m<h} m^2.
+    double hd = h;
+    double carried = (hd - 1.0) * hd * (2.0 * hd - 1.0) / 6.0;
+    return p00 + 2.0 * hd * p01 + hd * hd * p11 + hd * noise.level + std::max(carried, 0.0) * noise.trend;
+}
+
+ForwardPredictor::ForwardPredictor(const Params& params) : params_(params) {
+    params_.warmup_samples = std::max<size_t>(params_.warmup_samples, 1);
+}
+
+void ForwardPredictor::update(const PatientState& state) {
+    if (samples_ == 0) {
+        hydration_.init(state.hydration_pct, params_.hydration);
+        energy_.init(state.energy_T, params_.energy);
+    } else {
+        hydration_.update(state.hydration_pct, params_.hydration);
+        energy_.update(state.energy_T, params_.energy);
+    }
+    last_ = state;
+    ++samples_;
+    ++epoch_;
+}
+
+void ForwardPredictor::reset() {
+    hydration_ = TrendFilter{};
+    energy_ = TrendFilter{};
+    last_ = PatientState{};
+    samples_ = 0;
+    ++epoch_;
+}
+
+void ForwardPredictor::save_checkpoint(CheckpointWriter& out) const {
+    for (const TrendFilter* f : {&hydration_, &energy_}) {
+        out.put(f->level);
+        out.put(f->trend);
+        out.put(f->p00);
+        out.put(f->p01);
+        out.put(f->p11);
+    }
+    out.put(last_);
+    out.put(static_cast<std::uint64_t>(samples_));
+    out.put(epoch_);
+}
+
+bool ForwardPredictor::restore_checkpoint(CheckpointReader& in) {
+    for (TrendFilter* f : {&hydration_, &energy_}) {
+        in.get(f->level);
+        in.get(f->trend);
+        in.get(f->p00);
+        in.get(f->p01);
+        in.get(f->p11);
+    }
+    std::uint64_t samples = 0;
+    in.get(last_);
+    in.get(samples);
+    in.get(epoch_);
+    samples_ = static_cast<size_t>(samples);
+    cache_.fill(CacheSlot{});
+    next_slot_ = 0;
+    return in.ok();
+}
+
+ForwardPrediction ForwardPredictor::compute(int horizon) const {
+    ForwardPrediction p;
+    p.horizon = horizon;
+    p.state = last_;
+    p.state.hydration_pct = Utils::clamp(hydration_.forecast(horizon), 0.0, 100.0);
+    p.state.energy_T = Utils::clamp(energy_.forecast(horizon), 0.0, 1.0);
+    p.state.uncertainty = std::min(1.0, last_.uncertainty + params_.uncertainty_growth * horizon);
+    p.hydration_sd = std::sqrt(std::max(hydration_.forecast_variance(horizon, params_.hydration), 0.0));
+    p.energy_sd = std::sqrt(std::max(energy_.forecast_variance(horizon, params_.energy), 0.0));
+    return p;
+}
+
+std::optional<ForwardPrediction> ForwardPredictor::predict(int horizon) {
+    if (!ready()) return std::nullopt;
+    horizon = std::max(horizon, 0);
+    for (const CacheSlot& slot : cache_) {
+        if (slot.epoch == epoch_ && slot.prediction.horizon == horizon) return slot.prediction;
+    }
+    CacheSlot& slot = cache_[next_slot_];
+    next_slot_ = (next_slot_ + 1) % CACHE_SLOTS;
+    slot.epoch = epoch_;
+    slot.prediction = compute(horizon);
+    ++computed_;
+    return slot.prediction;
+}
+
+size_t ForwardPredictor::predict(const int* horizons, size_t count, ForwardPrediction* out) {
+    if (!ready()) return 0;
+    for (size_t i = 0; i < count; ++i) out[i] = *predict(horizons[i]);
+    return count;
+}
+
+} // namespace ivsys
@@ -0,0 +1,122 @@
+#pragma once
+
+/*
+ * ForwardPredictor.hpp
+ *
+ * Incrementally updated look-ahead for StateEstimator.
+ *
+ * Hydration and energy_T each run a local-linear-trend Kalman filter
+ * (level + slope per step) updated once per estimate(), O(1).  A forecast
+ * h steps ahead is level + h * slope with its closed-form variance, so any
+ * horizon costs the same and nothing rescans history.
+ *
+ * Horizons are counted in estimate() steps, the scale predict_forward's
+ * `minutes_ahead` has always used.  Predictions are cached per horizon
+ * until the next update(), so the controller's look-ahead, the REST
+ * publish and anything else querying the same tick compute each horizon
+ * once.
+ *
+ * Fixed-size state, no allocation; one control thread owns an instance.
+ */
+
+#include "iv_system_types.hpp"
+#include "config_defaults.hpp"
+#include "checkpoint_codec.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace ivsys {
+
+struct ForwardPrediction {
+    int horizon = 0;
+    PatientState state;          // latest estimate with forecast hydration / energy_T
+    double hydration_sd = 0.0;   // forecast standard deviations
+    double energy_sd = 0.0;
+};
+
+class ForwardPredictor {
+public:
+    static constexpr size_t CACHE_SLOTS = 8;
+
+    // Per-step variances of one channel.
+    struct ChannelNoise {
+        double measurement;
+        double level;
+        double trend;
+    };
+    struct Params {
+        ChannelNoise hydration{config::HYDRATION_MEASUREMENT_VAR, config::HYDRATION_LEVEL_VAR,
+                               config::HYDRATION_TREND_VAR};
+        ChannelNoise energy{config::ENERGY_MEASUREMENT_VAR, config::ENERGY_LEVEL_VAR,
+                            config::ENERGY_TREND_VAR};
+        size_t warmup_samples = config::PREDICTION_WARMUP_SAMPLES;
+        double uncertainty_growth = config::UNCERTAINTY_GROWTH_PER_MIN;
+    };
+
+    ForwardPredictor() : ForwardPredictor(Params{}) {}
+    explicit ForwardPredictor(const Params& params);
+
+    // Fold in one estimate; invalidates every cached prediction.
+    void update(const PatientState& state);
+    void reset();
+
+    // False until warmup_samples updates have been seen.
+    bool ready() const { return samples_ >= params_.warmup_samples; }
+    size_t samples() const { return samples_; }
+    // Bumped by every update(); cached predictions belong to one epoch.
+    std::uint64_t epoch() const { return epoch_; }
+
+    // nullopt until ready().  Negative horizons are treated as 0.
+    std::optional<ForwardPrediction> predict(int horizon);
+    // Fills out[0, count) for horizons[0, count); returns 0 (and writes
+    // nothing) until ready(), otherwise count.
+    size_t predict(const int* horizons, size_t count, ForwardPrediction* out);
+
+    // Filtered level and slope per step.
+    double hydration_level() const { return hydration_.level; }
+    double hydration_trend() const { return hydration_.trend; }
+    double energy_level() const { return energy_.level; }
+    double energy_trend() const { return energy_.trend; }
+
+    // Forecasts computed rather than served from the cache.
+    std::uint64_t computed() const { return computed_; }
+
+    // Filter state, last estimate and epoch (checkpoint_codec.hpp).  The
+    // prediction cache is not carried; restore empties it, and forecasts
+    // are recomputed from the restored state to the same values.
+    void save_checkpoint(CheckpointWriter& out) const;
+    bool restore_checkpoint(CheckpointReader& in);
+
+private:
+    struct TrendFilter {
+        double level = 0.0;
+        double trend = 0.0;
+        double p00 = 0.0, p01 = 0.0, p11 = 0.0;   // covariance
+
+        void init(double z, const ChannelNoise& noise);
+        void update(double z, const ChannelNoise& noise);
+        double forecast(int h) const { return level + h * trend; }
+        double forecast_variance(int h, const ChannelNoise& noise) const;
+    };
+
+    struct CacheSlot {
+        std::uint64_t epoch = 0;   // 0: empty (epochs start at 1)
+        ForwardPrediction prediction;
+    };
+
+    ForwardPrediction compute(int horizon) const;
+
+    Params params_;
+    TrendFilter hydration_;
+    TrendFilter energy_;
+    PatientState last_;
+    size_t samples_ = 0;
+    std::uint64_t epoch_ = 0;
+    std::array<CacheSlot, CACHE_SLOTS> cache_{};
+    size_t next_slot_ = 0;
+    std::uint64_t computed_ = 0;
+};
+
+} // namespace ivsys
@@ -0,0 +1,137 @@
+#pragma once
+
+/*
+ * LatencyHistogram.hpp
+ *
+ * Fixed-size, lock-free latency histogram with log-linear buckets.
+ *
+ * - Each power of two of nanoseconds is split into kSubBuckets linear
+ *   buckets, so any recorded value is reported within 25% of its true
+ *   value from 4 ns up to the 64-bit range.  Values 0-3 ns are exact.
+ * - record() is a handful of relaxed atomic increments: safe to call from
+ *   any number of threads, never allocates, never blocks.
+ * - snapshot() copies the counters for reporting.  Under concurrent
+ *   writers the copy is approximate (count and buckets may disagree by a
+ *   few in-flight samples), which is fine for monitoring.
+ */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace ivsys {
+
+class LatencyHistogram {
+public:
+    static constexpr size_t kSubBuckets = 4;               // per power of two
+    static constexpr size_t kBuckets = 64 * kSubBuckets;
+
+    struct Snapshot {
+        std::uint64_t count = 0;
+        std::uint64_t sum_ns = 0;
+        std::uint64_t max_ns = 0;
+        std::array<std::uint64_t, kBuckets> buckets{};
+
+        double mean_us() const {
+            return count == 0 ? 0.0 : static_cast<double>(sum_ns) / static_cast<double>(count) / 1e3;
+        }
+        double max_us() const { return static_cast<double>(max_ns) / 1e3; }
+
+        // q in [0, 1]; reports the midpoint of the bucket holding the q-th
+        // sample, clamped to the observed maximum.
+        double percentile_us(double q) const {
+            if (count == 0) return 0.0;
+            if (q < 0.0) q = 0.0;
+            if (q > 1.0) q = 1.0;
+            std::uint64_t rank = static_cast<std::uint64_t>(q * static_cast<double>(count - 1)) + 1;
+            std::uint64_t seen = 0;
+            for (size_t i = 0; i < kBuckets; ++i) {
+                seen += buckets[i];
+                if (seen >= rank) {
+                    double lo = static_cast<double>(bucket_lower_ns(i));
+                    double hi = static_cast<double>(bucket_upper_ns(i));
+                    double mid = 0.5 * (lo + hi);
+                    double cap = static_cast<double>(max_ns);
+                    return (mid < cap ? mid : cap) / 1e3;
+                }
+            }
+            return max_us();
+        }
+
+        // Samples recorded after `earlier` was taken.  The maximum is not
+        // recoverable per interval, so max_ns stays the overall maximum (an
+        // upper bound for the interval).
+        Snapshot since(const Snapshot& earlier) const {
+            Snapshot d;
+            d.count = count - earlier.count;
+            d.sum_ns = sum_ns - earlier.sum_ns;
+            d.max_ns = max_ns;
+            for (size_t i = 0; i < kBuckets; ++i) d.buckets[i] = buckets[i] - earlier.buckets[i];
+            return d;
+        }
+    };
+
+    LatencyHistogram() = default;
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record_ns(std::uint64_t ns) {
+        buckets_[bucket_for(ns)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+        std::uint64_t prev = max_ns_.load(std::memory_order_relaxed);
+        while (ns > prev &&
+               !max_ns_.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    template <typename Rep, typename Period>
+    void record(std::chrono::duration<Rep, Period> d) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+        record_ns(ns < 0 ? 0 : static_cast<std::uint64_t>(ns));
+    }
+
+    Snapshot snapshot() const {
+        Snapshot s;
+        s.count = count_.load(std::memory_order_relaxed);
+        s.sum_ns = sum_ns_.load(std::memory_order_relaxed);
+        s.max_ns = max_ns_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < kBuckets; ++i) {
+            s.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        }
+        return s;
+    }
+
+    static size_t bucket_for(std::uint64_t ns) {
+        if (ns < kSubBuckets) return static_cast<size_t>(ns);
+        size_t msb = 63 - static_cast<size_t>(__builtin_clzll(ns));
+        size_t sub = static_cast<size_t>(ns >> (msb - 2)) & (kSubBuckets - 1);
+        return (msb - 1) * kSubBuckets + sub;
+    }
+
+    static std::uint64_t bucket_lower_ns(size_t index) {
+        if (index < kSubBuckets) return index;
+        size_t msb = index / kSubBuckets + 1;
+        std::uint64_t sub = index % kSubBuckets;
+        return (kSubBuckets + sub) << (msb - 2);
+    }
+
+    // Exclusive upper bound (saturates for the top bucket).
+    static std::uint64_t bucket_upper_ns(size_t index) {
+        if (index < kSubBuckets) return index + 1;
+        size_t msb = index / kSubBuckets + 1;
+        std::uint64_t lower = bucket_lower_ns(index);
+        std::uint64_t width = std::uint64_t{1} << (msb - 2);
+        return lower > UINT64_MAX - width ? UINT64_MAX : lower + width;
+    }
+
+private:
+    std::array<std::atomic<std::uint64_t>, kBuckets> buckets_{};
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::uint64_t> sum_ns_{0};
+    std::atomic<std::uint64_t> max_ns_{0};
+};
+
+} // namespace ivsys
@@ -3,7 +3,7 @@
  *
  * Neural-network-based energy proxy estimator for the AI-IV system.
  *
- * Replaces StateEstimator::calculate_energy_proxy() with a 241-parameter
+ * Replaces StateEstimator::rule_energy_proxy() with a 241-parameter
  * feedforward network (Dense-16-ReLU → Dense-8-ReLU → Dense-1-Sigmoid)
  * loaded at startup from a frugally-deep JSON model file.
  *
@@ -26,13 +26,27 @@
  *   SetInputTensor()   → (passed directly to predict())
  *   Invoke()           → predict()
  *   GetOutputTensor()  → return value of predict()
+ *
+ * Inference itself runs on SensorFusionKernel: load() also reads the
+ * weights into the kernel's fixed-size arrays and checks the kernel
+ * against the fdeep model on a grid of inputs, so predict() and
+ * predict_batch() never allocate.  The fdeep model is kept only as the
+ * reference (predict_reference()).
+ *
+ * load_blob() is the fast start: it maps the packed kernel blob
+ * (tools/pack_sensor_fusion_model.cpp) and skips fdeep entirely.  The blob
+ * still carries fdeep's test vectors, and SensorFusionKernel re-runs them,
+ * but there is no reference model afterwards.
  */
 
 #pragma once
 
 #ifdef ENABLE_NEURAL_ESTIMATOR
 
+#include "SensorFusionKernel.hpp"
 #include <fdeep/fdeep.hpp>
+#include <cmath>
+#include <cstddef>
 #include <optional>
 #include <string>
 #include <stdexcept>
@@ -41,16 +55,57 @@ namespace ivsys {
 
 class NeuralStateEstimator {
 public:
+    // Grid points per input for the load-time kernel/fdeep comparison.
+    static constexpr int kVerifyGridSteps = 4;
+
     // Load model from a frugally-deep JSON file.
-    // Throws std::runtime_error if the file cannot be found or is invalid.
+    // Throws std::runtime_error if the file cannot be found or is invalid,
+    // or if the kernel disagrees with fdeep by more than
+    // SensorFusionKernel::kVerifyTolerance anywhere on the check grid.
     void load(const std::string& model_path) {
+        loaded_ = false;
         model_.emplace(fdeep::load_model(model_path,
             /*verify=*/true,
             fdeep::dev_null_logger));
+        kernel_.load(model_path);
+
+        float worst = 0.0f;
+        float x[SensorFusionKernel::kInputs];
+        int total = 1;
+        for (size_t i = 0; i < SensorFusionKernel::kInputs; ++i) total *= kVerifyGridSteps;
+        for (int point = 0; point < total; ++point) {
+            int rest = point;
+            for (size_t i = 0; i < SensorFusionKernel::kInputs; ++i) {
+                x[i] = static_cast<float>(rest % kVerifyGridSteps) / (kVerifyGridSteps - 1);
+                rest /= kVerifyGridSteps;
+            }
+            float error = std::fabs(kernel_.predict(x) -
+                                    reference(x[0], x[1], x[2], x[3], x[4]));
+            if (error > worst) worst = error;
+        }
+        if (!(worst <= SensorFusionKernel::kVerifyTolerance)) {
+            throw std::runtime_error(
+                "NeuralStateEstimator: inference kernel differs from fdeep by " +
+                std::to_string(worst));
+        }
+        verify_error_ = worst;
+        loaded_ = true;
+    }
+
+    // Load only the inference kernel from a packed blob; no fdeep model, so
+    // predict_reference() throws and verify_error() is the blob's
+    // test-vector error.  Throws std::runtime_error as
+    // SensorFusionKernel::load_blob() does.
+    void load_blob(const std::string& blob_path, const std::string& source_path = std::string()) {
+        loaded_ = false;
+        model_.reset();
+        kernel_.load_blob(blob_path, source_path);
+        verify_error_ = kernel_.load_check_error();
         loaded_ = true;
     }
 
     bool is_loaded() const { return loaded_; }
+    bool has_reference() const { return model_.has_value(); }
 
     // Predict energy proxy E_T ∈ [0,1] from normalised telemetry inputs.
     // Inputs must already be normalised:
@@ -64,10 +119,49 @@ public:
                   float spo2_norm,
                   float lactate_norm,
                   float fatigue) const {
+        require_loaded();
+        return kernel_.predict(hydration_norm, hr_norm, spo2_norm, lactate_norm, fatigue);
+    }
+
+    // Many samples at once: inputs are count rows of 5 normalised values
+    // (same order as predict()), outputs receives count values.
+    void predict_batch(const float* inputs, size_t count, float* outputs) const {
+        require_loaded();
+        kernel_.predict_batch(inputs, count, outputs);
+    }
+
+    // Same prediction through the full frugally-deep model (allocates).
+    float predict_reference(float hydration_norm,
+                            float hr_norm,
+                            float spo2_norm,
+                            float lactate_norm,
+                            float fatigue) const {
+        require_loaded();
+        if (!model_) {
+            throw std::runtime_error(
+                "NeuralStateEstimator: loaded from a blob, no reference model");
+        }
+        return reference(hydration_norm, hr_norm, spo2_norm, lactate_norm, fatigue);
+    }
+
+    // Largest kernel/fdeep difference seen by load() (or load_blob()).
+    float verify_error() const { return verify_error_; }
+
+private:
+    std::optional<fdeep::model> model_;
+    SensorFusionKernel kernel_;
+    bool loaded_ = false;
+    float verify_error_ = 0.0f;
+
+    void require_loaded() const {
         if (!loaded_) {
             throw std::runtime_error(
                 "NeuralStateEstimator::predict called before load()");
         }
+    }
+
+    float reference(float hydration_norm, float hr_norm, float spo2_norm,
+                    float lactate_norm, float fatigue) const {
         const auto result = model_->predict(
             {fdeep::tensor(fdeep::tensor_shape(5),
                 std::vector<float>{
@@ -75,10 +169,6 @@ public:
                 })});
         return result[0].get(fdeep::tensor_pos(0));
     }
-
-private:
-    std::optional<fdeep::model> model_;
-    bool loaded_ = false;
 };
 
 } // namespace ivsys
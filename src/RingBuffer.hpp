@@ -0,0 +1,260 @@
+#pragma once
+
+/*
+ * RingBuffer.hpp
+ *
+ * Fixed-capacity, allocation-free history containers for per-tick data.
+ *
+ * RingBuffer<T, N>   - overwrite-oldest circular buffer; index 0 is the
+ *                      oldest retained element, size()-1 the newest.
+ * RollingStats<N>    - RingBuffer<double, N> plus incrementally maintained
+ *                      mean, population variance and least-squares trend
+ *                      (slope per sample) over the retained window.
+ *                      Non-finite samples make the statistics NaN only
+ *                      while they are in the window.
+ *
+ * Storage lives inline in the object (std::array), so pushing never touches
+ * the heap and never shifts elements.
+ */
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+namespace ivsys {
+
+template <typename T, size_t N>
+class RingBuffer {
+    static_assert(N > 0, "RingBuffer capacity must be positive");
+
+public:
+    template <bool Const>
+    class basic_iterator {
+        using Owner = std::conditional_t<Const, const RingBuffer, RingBuffer>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+
+        basic_iterator() = default;
+        basic_iterator(Owner* owner, size_t pos) : owner_(owner), pos_(pos) {}
+
+        reference operator*() const { return (*owner_)[pos_]; }
+        pointer operator->() const { return &(*owner_)[pos_]; }
+        reference operator[](difference_type n) const { return (*owner_)[pos_ + n]; }
+
+        basic_iterator& operator++() { ++pos_; return *this; }
+        basic_iterator operator++(int) { auto t = *this; ++pos_; return t; }
+        basic_iterator& operator--() { --pos_; return *this; }
+        basic_iterator operator--(int) { auto t = *this; --pos_; return t; }
+        basic_iterator& operator+=(difference_type n) { pos_ += n; return *this; }
+        basic_iterator& operator-=(difference_type n) { pos_ -= n; return *this; }
+        basic_iterator operator+(difference_type n) const { return {owner_, pos_ + n}; }
+        basic_iterator operator-(difference_type n) const { return {owner_, pos_ - n}; }
+        difference_type operator-(const basic_iterator& o) const {
+            return static_cast<difference_type>(pos_) - static_cast<difference_type>(o.pos_);
+        }
+
+        bool operator==(const basic_iterator& o) const { return pos_ == o.pos_; }
+        bool operator!=(const basic_iterator& o) const { return pos_ != o.pos_; }
+        bool operator<(const basic_iterator& o) const { return pos_ < o.pos_; }
+
+    private:
+        Owner* owner_ = nullptr;
+        size_t pos_ = 0;
+    };
+
+    using value_type = T;
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    static constexpr size_t capacity() { return N; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    bool full() const { return size_ == N; }
+
+    // Append `value`; when full, the oldest element is overwritten.
+    void push_back(const T& value) {
+        data_[(head_ + size_) % N] = value;
+        if (size_ < N) {
+            ++size_;
+        } else {
+            head_ = (head_ + 1) % N;
+        }
+    }
+
+    void pop_front() {
+        if (size_ == 0) return;
+        head_ = (head_ + 1) % N;
+        --size_;
+    }
+
+    void clear() {
+        head_ = 0;
+        size_ = 0;
+    }
+
+    T& operator[](size_t i) { return data_[(head_ + i) % N]; }
+    const T& operator[](size_t i) const { return data_[(head_ + i) % N]; }
+
+    T& front() { return (*this)[0]; }
+    const T& front() const { return (*this)[0]; }
+    T& back() { return (*this)[size_ - 1]; }
+    const T& back() const { return (*this)[size_ - 1]; }
+
+    iterator begin() { return {this, 0}; }
+    iterator end() { return {this, size_}; }
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, size_}; }
+
+private:
+    std::array<T, N> data_{};
+    size_t head_ = 0;
+    size_t size_ = 0;
+};
+
+template <size_t N>
+class RollingStats {
+public:
+    static constexpr size_t capacity() { return N; }
+    size_t size() const { return window_.size(); }
+    bool empty() const { return window_.empty(); }
+    bool full() const { return window_.full(); }
+    const RingBuffer<double, N>& window() const { return window_; }
+
+    void push(double x) {
+        // A NaN or inf poisons the running sums for good; re-derive them
+        // whenever one enters or leaves so only the window that holds it
+        // is affected.
+        bool non_finite = !std::isfinite(x);
+        if (window_.full()) {
+            non_finite = non_finite || !std::isfinite(window_.front());
+            remove_oldest();
+        }
+        // Welford insert
+        size_t n = window_.size() + 1;
+        double d = x - mean_;
+        mean_ += d / static_cast<double>(n);
+        m2_ += d * (x - mean_);
+
+        // Index-weighted sum for the slope; indices run 0..n-1 oldest first.
+        weighted_sum_ += static_cast<double>(n - 1) * x;
+        sum_ += x;
+        window_.push_back(x);
+
+        // Periodically re-derive the accumulators from the window so that
+        // add/remove rounding cannot drift over a 24 h session.
+        if (++pushes_since_resync_ >= RESYNC_INTERVAL || non_finite) {
+            resync();
+        }
+    }
+
+    void clear() {
+        window_.clear();
+        mean_ = m2_ = sum_ = weighted_sum_ = 0.0;
+        pushes_since_resync_ = 0;
+    }
+
+    double mean() const { return mean_; }
+
+    // Population variance of the retained window.
+    double variance() const {
+        size_t n = window_.size();
+        if (n == 0) return 0.0;
+        double v = m2_ / static_cast<double>(n);
+        return v > 0.0 ? v : 0.0;
+    }
+
+    // Mean squared deviation of the window from an arbitrary reference:
+    // (1/n) * sum (x_k - ref)^2 = variance + (mean - ref)^2.
+    double mean_squared_deviation(double ref) const {
+        double d = mean_ - ref;
+        return variance() + d * d;
+    }
+
+    // Least-squares slope of the window per sample (0 for fewer than two).
+    double trend() const {
+        size_t n = window_.size();
+        if (n < 2) return 0.0;
+        double nd = static_cast<double>(n);
+        double sum_k = nd * (nd - 1.0) / 2.0;
+        double sum_k2 = (nd - 1.0) * nd * (2.0 * nd - 1.0) / 6.0;
+        double denom = nd * sum_k2 - sum_k * sum_k;
+        return (nd * weighted_sum_ - sum_k * sum_) / denom;
+    }
+
+    double newest() const { return window_.back(); }
+    double oldest() const { return window_.front(); }
+
+    // Running sums behind mean(), variance() and trend().  Checkpoints carry
+    // them as they are: re-deriving them from the window rounds differently.
+    struct Accumulators {
+        double mean = 0.0;
+        double m2 = 0.0;
+        double sum = 0.0;
+        double weighted_sum = 0.0;
+        uint32_t pushes_since_resync = 0;
+    };
+
+    Accumulators accumulators() const { return {mean_, m2_, sum_, weighted_sum_, pushes_since_resync_}; }
+
+    void restore(const RingBuffer<double, N>& window, const Accumulators& a) {
+        window_ = window;
+        mean_ = a.mean;
+        m2_ = a.m2;
+        sum_ = a.sum;
+        weighted_sum_ = a.weighted_sum;
+        pushes_since_resync_ = a.pushes_since_resync;
+    }
+
+private:
+    static constexpr uint32_t RESYNC_INTERVAL = 1024;
+
+    void remove_oldest() {
+        double x = window_.front();
+        size_t n = window_.size();
+
+        // Welford remove
+        if (n == 1) {
+            mean_ = m2_ = 0.0;
+        } else {
+            double d = x - mean_;
+            mean_ -= d / static_cast<double>(n - 1);
+            m2_ -= d * (x - mean_);
+        }
+
+        // Shift every remaining index down by one.
+        sum_ -= x;
+        weighted_sum_ -= sum_;
+        window_.pop_front();
+    }
+
+    void resync() {
+        mean_ = m2_ = sum_ = weighted_sum_ = 0.0;
+        size_t n = 0;
+        for (double x : window_) {
+            ++n;
+            double d = x - mean_;
+            mean_ += d / static_cast<double>(n);
+            m2_ += d * (x - mean_);
+            weighted_sum_ += static_cast<double>(n - 1) * x;
+            sum_ += x;
+        }
+        pushes_since_resync_ = 0;
+    }
+
+    RingBuffer<double, N> window_;
+    double mean_ = 0.0;
+    double m2_ = 0.0;
+    double sum_ = 0.0;
+    double weighted_sum_ = 0.0;
+    uint32_t pushes_since_resync_ = 0;
+};
+
+} // namespace ivsys
@@ -1,90 +1,118 @@
 #include "SafetyMonitor.hpp"
 #include "config_defaults.hpp"
 #include <algorithm>
-#include <sstream>
 #include <cmath>
 
 namespace ivsys {
 
-SafetyMonitor::SafetyMonitor(const PatientProfile& prof)
+SafetyMonitorCore::SafetyMonitorCore(const PatientProfile& prof, double daily_volume_per_kg_ml)
     : profile(prof), cumulative_volume_ml(0.0) {
-    max_volume_24h_ml = profile.weight_kg * config::DAILY_VOLUME_PER_KG_ML;
+    max_volume_24h_ml = profile.weight_kg * daily_volume_per_kg_ml;
     if (profile.cardiac_condition) max_volume_24h_ml *= config::CARDIAC_CONDITION_VOLUME_FACTOR;
     if (profile.renal_impairment) max_volume_24h_ml *= config::RENAL_IMPAIRMENT_VOLUME_FACTOR;
 }
 
-SafetyMonitor::SafetyCheck SafetyMonitor::evaluate(double requested_rate, const PatientState& state, double dt_minutes) {
+template <typename Policy>
+BasicSafetyMonitor<Policy>::BasicSafetyMonitor(const PatientProfile& prof, const Policy& policy)
+    : SafetyMonitorCore(prof, policy.limits().daily_volume_per_kg_ml), policy_(policy) {}
+
+template <typename Policy>
+SafetyMonitorCore::SafetyCheck BasicSafetyMonitor<Policy>::evaluate(double requested_rate, const PatientState& state,
+                                                                    double dt_minutes) {
+    // A constant for PatientClassPolicy, the run-time tuning for TunedPolicy
+    const config::ControlTuning& tuning = policy_.limits();
     dt_minutes = std::max(0.0, dt_minutes);
 
     SafetyCheck result;
     result.passed = true;
     result.max_allowed_rate = profile.max_safe_infusion_rate;
-    std::ostringstream warnings;
 
     // Check 1: Volume overload
     // Calculate projected volume using explicit time step
     double elapsed_h = dt_minutes / 60.0;
 
     double projected_volume = cumulative_volume_ml + (requested_rate * 60.0 * elapsed_h);
-    if (projected_volume > max_volume_24h_ml * config::VOLUME_APPROACH_FRACTION) {
-        result.max_allowed_rate = std::min(result.max_allowed_rate, config::VOLUME_LIMIT_RATE_CAP);
-        warnings << "VOLUME_LIMIT_APPROACH ";
+    if (projected_volume > max_volume_24h_ml * tuning.volume_approach_fraction) {
+        result.max_allowed_rate = std::min(result.max_allowed_rate, tuning.volume_limit_rate_cap);
+        result.warnings.set(WarningFlag::VolumeLimitApproach);
+    }
+    // Never schedule more than what is left of the 24h limit this step
+    double remaining_volume = std::max(0.0, max_volume_24h_ml - cumulative_volume_ml);
+    if (dt_minutes > 0.0 && requested_rate * dt_minutes > remaining_volume) {
+        result.max_allowed_rate = std::min(result.max_allowed_rate, remaining_volume / dt_minutes);
+        result.warnings.set(WarningFlag::VolumeLimitApproach);
     }
 
     // Check 2: Cardiac load
-    if (state.cardiac_reserve < MIN_CARDIAC_RESERVE) {
-        result.max_allowed_rate = std::min(result.max_allowed_rate, config::LOW_CARDIAC_RATE_CAP);
-        warnings << "LOW_CARDIAC_RESERVE ";
+    if (state.cardiac_reserve < tuning.min_cardiac_reserve) {
+        result.max_allowed_rate = std::min(result.max_allowed_rate, tuning.low_cardiac_rate_cap);
+        result.warnings.set(WarningFlag::LowCardiacReserve);
     }
 
     // Check 3: Rate of change limiting
     if (!recent_rates.empty()) {
         double rate_change = std::abs(requested_rate - recent_rates.back());
-        if (rate_change > MAX_RATE_CHANGE) {
+        double max_change = tuning.max_rate_change_ml_min;
+        if (rate_change > max_change) {
             double limited = recent_rates.back() +
-                (requested_rate > recent_rates.back() ? MAX_RATE_CHANGE : -MAX_RATE_CHANGE);
+                (requested_rate > recent_rates.back() ? max_change : -max_change);
             limited = std::max(0.0, limited);
             result.max_allowed_rate = std::min(result.max_allowed_rate, limited);
-            warnings << "RATE_CHANGE_LIMITED ";
+            result.warnings.set(WarningFlag::RateChangeLimited);
         }
     }
 
     // Check 4: High risk state
-    if (state.risk_score > MAX_RISK_THRESHOLD) {
-        result.max_allowed_rate = std::min(result.max_allowed_rate, config::HIGH_RISK_RATE_CAP);
-        warnings << "HIGH_RISK_STATE ";
+    if (state.risk_score > tuning.high_risk_threshold) {
+        result.max_allowed_rate = std::min(result.max_allowed_rate, tuning.high_risk_rate_cap);
+        result.warnings.set(WarningFlag::HighRiskState);
     }
 
     // Check 5: Tachycardia
-    if (profile.baseline_hr_bpm > 0.0 && state.heart_rate_bpm > profile.baseline_hr_bpm * config::TACHYCARDIA_HR_MULTIPLIER) {
-        result.max_allowed_rate = std::min(result.max_allowed_rate, config::TACHYCARDIA_RATE_CAP);
-        warnings << "TACHYCARDIA_DETECTED ";
+    if (profile.baseline_hr_bpm > 0.0 && state.heart_rate_bpm > profile.baseline_hr_bpm * tuning.tachycardia_hr_multiplier) {
+        result.max_allowed_rate = std::min(result.max_allowed_rate, tuning.tachycardia_rate_cap);
+        result.warnings.set(WarningFlag::TachycardiaDetected);
     }
 
-    // Check 6: Minimum safe rate
-    if (result.max_allowed_rate < config::EMERGENCY_MIN_RATE && state.hydration_pct < config::EMERGENCY_HYDRATION_THRESHOLD) {
-        result.max_allowed_rate = config::EMERGENCY_MIN_RATE;
-        warnings << "EMERGENCY_MIN_RATE ";
+    // Check 6: Minimum safe rate (never above the profile's own maximum)
+    double emergency_rate = std::min(config::EMERGENCY_MIN_RATE, profile.max_safe_infusion_rate);
+    if (result.max_allowed_rate < emergency_rate && state.hydration_pct < config::EMERGENCY_HYDRATION_THRESHOLD) {
+        result.max_allowed_rate = emergency_rate;
+        result.warnings.set(WarningFlag::EmergencyMinRate);
     }
 
-    result.warnings = warnings.str();
     result.passed = (result.max_allowed_rate >= config::EMERGENCY_MIN_RATE);
 
     return result;
 }
 
-void SafetyMonitor::update_volume(double rate_ml_per_min, double duration_min) {
+template class BasicSafetyMonitor<TunedPolicy>;
+template class BasicSafetyMonitor<StandardPolicy>;
+template class BasicSafetyMonitor<CardiacPolicy>;
+template class BasicSafetyMonitor<RenalPolicy>;
+template class BasicSafetyMonitor<PediatricPolicy>;
+
+void SafetyMonitorCore::update_volume(double rate_ml_per_min, double duration_min) {
     rate_ml_per_min = std::max(0.0, rate_ml_per_min);
     duration_min = std::max(0.0, duration_min);
     cumulative_volume_ml += rate_ml_per_min * duration_min;
     recent_rates.push_back(rate_ml_per_min);
-    if (recent_rates.size() > 20) recent_rates.pop_front();
 }
 
-void SafetyMonitor::reset_24h_counter() {
+void SafetyMonitorCore::reset_24h_counter() {
     cumulative_volume_ml = 0.0;
 }
 
-double SafetyMonitor::get_cumulative_volume() const { return cumulative_volume_ml; }
+double SafetyMonitorCore::get_cumulative_volume() const { return cumulative_volume_ml; }
+
+void SafetyMonitorCore::save_checkpoint(CheckpointWriter& out, bool full) const {
+    out.put(cumulative_volume_ml);
+    out.put_ring(recent_rates, full);
+}
+
+bool SafetyMonitorCore::restore_checkpoint(CheckpointReader& in, bool full) {
+    in.get(cumulative_volume_ml);
+    return in.get_ring(recent_rates, full);
+}
 
 } // namespace ivsys
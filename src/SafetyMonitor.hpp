@@ -2,41 +2,62 @@
 
 #include "iv_system_types.hpp"
 #include "config_defaults.hpp"
-#include <deque>
+#include "control_policy.hpp"
+#include "RingBuffer.hpp"
+#include "checkpoint_codec.hpp"
 #include <chrono>
 #include <string>
 
 namespace ivsys {
 
-class SafetyMonitor {
-private:
-    PatientProfile profile;
-    double cumulative_volume_ml;
-    double max_volume_24h_ml;
-    std::deque<double> recent_rates;
-    // Removed internal time state 'last_check' to make evaluate pure/stateless regarding time
-
-    static constexpr double MAX_RATE_CHANGE     = config::MAX_RATE_CHANGE_ML_MIN;
-    static constexpr double MIN_CARDIAC_RESERVE = config::MIN_CARDIAC_RESERVE;
-    static constexpr double MAX_RISK_THRESHOLD  = config::HIGH_RISK_THRESHOLD;
-
+// Volume and rate accounting shared by every policy.
+class SafetyMonitorCore {
 public:
-    SafetyMonitor(const PatientProfile& prof);
-
     struct SafetyCheck {
         bool passed;
         double max_allowed_rate;
-        std::string warnings;
+        WarningFlags warnings;
     };
 
-    // Updated to accept explicit time delta (dt_minutes)
-    SafetyCheck evaluate(double requested_rate, const PatientState& state, double dt_minutes);
-
     void update_volume(double rate_ml_per_min, double duration_min);
 
     void reset_24h_counter();
 
     double get_cumulative_volume() const;
+    // Volume allowed per 24 h window for this profile and tuning.
+    double get_max_volume_24h() const { return max_volume_24h_ml; }
+
+    // Cumulative volume and recent rates for replication
+    // (checkpoint_codec.hpp); a delta follows exactly one update_volume().
+    void save_checkpoint(CheckpointWriter& out, bool full) const;
+    bool restore_checkpoint(CheckpointReader& in, bool full);
+
+protected:
+    SafetyMonitorCore(const PatientProfile& prof, double daily_volume_per_kg_ml);
+
+    PatientProfile profile;
+    double cumulative_volume_ml;
+    double max_volume_24h_ml;
+    RingBuffer<double, 20> recent_rates;
+    // Removed internal time state 'last_check' to make evaluate pure/stateless regarding time
+};
+
+// Instantiated for TunedPolicy and every PatientClassPolicy (SafetyMonitor.cpp).
+template <typename Policy>
+class BasicSafetyMonitor : public SafetyMonitorCore {
+public:
+    explicit BasicSafetyMonitor(const PatientProfile& prof, const Policy& policy = Policy{});
+
+    // Updated to accept explicit time delta (dt_minutes)
+    SafetyCheck evaluate(double requested_rate, const PatientState& state, double dt_minutes);
+
+    const Policy& policy() const { return policy_; }
+
+private:
+    Policy policy_;
 };
 
+// Run-time tuned monitor; a default ControlTuning reproduces config_defaults.hpp.
+using SafetyMonitor = BasicSafetyMonitor<TunedPolicy>;
+
 } // namespace ivsys
@@ -0,0 +1,514 @@
+#include "SensorFusionKernel.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ivsys {
+
+static_assert(sizeof(SensorFusionKernel::BlobHeader) == 72, "blob header layout is part of the format");
+
+namespace {
+
+// Just enough JSON to walk a frugally-deep model file: objects, arrays,
+// strings, and skipping everything else.
+class JsonCursor {
+public:
+    explicit JsonCursor(const std::string& text) : text_(text) {}
+
+    void expect(char c) {
+        skip_ws();
+        if (pos_ >= text_.size() || text_[pos_] != c) fail(std::string("expected '") + c + "'");
+        ++pos_;
+    }
+
+    bool consume(char c) {
+        skip_ws();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    std::string read_string() {
+        expect('"');
+        std::string out;
+        while (pos_ < text_.size() && text_[pos_] != '"') {
+            if (text_[pos_] == '\\') ++pos_;  // keys and base64 never need more
+            if (pos_ < text_.size()) out += text_[pos_++];
+        }
+        expect('"');
+        return out;
+    }
+
+    // Calls on_key(key) for each member; on_key must consume the value.
+    template <typename F>
+    void read_object(F on_key) {
+        expect('{');
+        if (consume('}')) return;
+        do {
+            std::string key = read_string();
+            expect(':');
+            on_key(key);
+        } while (consume(','));
+        expect('}');
+    }
+
+    template <typename F>
+    void read_array(F on_element) {
+        expect('[');
+        if (consume(']')) return;
+        do {
+            on_element();
+        } while (consume(','));
+        expect(']');
+    }
+
+    void skip_value() {
+        skip_ws();
+        if (pos_ >= text_.size()) fail("unexpected end of input");
+        char c = text_[pos_];
+        if (c == '{') {
+            read_object([this](const std::string&) { skip_value(); });
+        } else if (c == '[') {
+            read_array([this]() { skip_value(); });
+        } else if (c == '"') {
+            read_string();
+        } else {
+            while (pos_ < text_.size() && std::strchr(",}] \t\r\n", text_[pos_]) == nullptr) ++pos_;
+        }
+    }
+
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error("SensorFusionKernel: malformed model JSON (" + what +
+                                 " at offset " + std::to_string(pos_) + ")");
+    }
+
+private:
+    void skip_ws() {
+        while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t' ||
+                                       text_[pos_] == '\r' || text_[pos_] == '\n')) {
+            ++pos_;
+        }
+    }
+
+    const std::string& text_;
+    size_t pos_ = 0;
+};
+
+// fdeep stores float tensors as base64 of little-endian float32, possibly
+// split across several strings.
+void append_base64_floats(const std::string& encoded, std::vector<float>& out) {
+    static const std::string kAlphabet =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::vector<std::uint8_t> bytes;
+    std::uint32_t acc = 0;
+    int bits = 0;
+    for (char c : encoded) {
+        if (c == '=') break;
+        size_t v = kAlphabet.find(c);
+        if (v == std::string::npos) {
+            throw std::runtime_error("SensorFusionKernel: invalid base64 in model weights");
+        }
+        acc = (acc << 6) | static_cast<std::uint32_t>(v);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            bytes.push_back(static_cast<std::uint8_t>((acc >> bits) & 0xFF));
+        }
+    }
+    if (bytes.size() % 4 != 0) {
+        throw std::runtime_error("SensorFusionKernel: weight blob is not a whole number of floats");
+    }
+    for (size_t i = 0; i < bytes.size(); i += 4) {
+        std::uint32_t word = static_cast<std::uint32_t>(bytes[i]) |
+                             static_cast<std::uint32_t>(bytes[i + 1]) << 8 |
+                             static_cast<std::uint32_t>(bytes[i + 2]) << 16 |
+                             static_cast<std::uint32_t>(bytes[i + 3]) << 24;
+        float value;
+        std::memcpy(&value, &word, sizeof(value));
+        out.push_back(value);
+    }
+}
+
+std::vector<float> read_float_strings(JsonCursor& cursor) {
+    std::vector<float> values;
+    cursor.read_array([&]() { append_base64_floats(cursor.read_string(), values); });
+    return values;
+}
+
+// "inputs"/"outputs" of a test case: an array of {shape, values} tensors.
+std::vector<float> read_test_tensors(JsonCursor& cursor) {
+    std::vector<float> values;
+    cursor.read_array([&]() {
+        cursor.read_object([&](const std::string& key) {
+            if (key == "values") {
+                std::vector<float> part = read_float_strings(cursor);
+                values.insert(values.end(), part.begin(), part.end());
+            } else {
+                cursor.skip_value();
+            }
+        });
+    });
+    return values;
+}
+
+std::uint64_t fnv1a64(const void* data, size_t size) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    std::uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= p[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+struct DenseParams {
+    std::vector<float> weights;  // [inputs][units], row-major (Keras kernel layout)
+    std::vector<float> bias;
+};
+
+struct TestCase {
+    std::vector<float> inputs;
+    std::vector<float> outputs;
+};
+
+} // namespace
+
+void SensorFusionKernel::load(const std::string& model_path) {
+    std::ifstream in(model_path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("SensorFusionKernel: cannot open model file " + model_path);
+    }
+    std::ostringstream text;
+    text << in.rdbuf();
+    const std::string json = text.str();
+    load_from_json(json);
+    source_checksum_ = fnv1a64(json.data(), json.size());
+}
+
+void SensorFusionKernel::load_from_json(const std::string& json) {
+    loaded_ = false;
+    source_checksum_ = 0;
+
+    std::vector<DenseParams> layers;
+    std::vector<TestCase> tests;
+    JsonCursor cursor(json);
+    cursor.read_object([&](const std::string& key) {
+        if (key == "trainable_params") {
+            // One member per Dense layer, in network order.
+            cursor.read_object([&](const std::string&) {
+                DenseParams layer;
+                cursor.read_object([&](const std::string& field) {
+                    if (field == "weights") {
+                        layer.weights = read_float_strings(cursor);
+                    } else if (field == "bias") {
+                        layer.bias = read_float_strings(cursor);
+                    } else {
+                        cursor.skip_value();
+                    }
+                });
+                layers.push_back(std::move(layer));
+            });
+        } else if (key == "tests") {
+            cursor.read_array([&]() {
+                TestCase test;
+                cursor.read_object([&](const std::string& field) {
+                    if (field == "inputs") {
+                        test.inputs = read_test_tensors(cursor);
+                    } else if (field == "outputs") {
+                        test.outputs = read_test_tensors(cursor);
+                    } else {
+                        cursor.skip_value();
+                    }
+                });
+                tests.push_back(std::move(test));
+            });
+        } else {
+            cursor.skip_value();
+        }
+    });
+
+    const size_t shapes[3][2] = {{kInputs, kHidden1}, {kHidden1, kHidden2}, {kHidden2, 1}};
+    if (layers.size() != 3) {
+        throw std::runtime_error("SensorFusionKernel: expected 3 dense layers, found " +
+                                 std::to_string(layers.size()));
+    }
+    for (size_t l = 0; l < 3; ++l) {
+        if (layers[l].weights.size() != shapes[l][0] * shapes[l][1] ||
+            layers[l].bias.size() != shapes[l][1]) {
+            throw std::runtime_error("SensorFusionKernel: layer " + std::to_string(l + 1) +
+                                     " does not match the 5-16-8-1 architecture");
+        }
+    }
+
+    std::vector<float> params;
+    params.reserve(kParams);
+    for (const DenseParams& layer : layers) {
+        params.insert(params.end(), layer.weights.begin(), layer.weights.end());
+        params.insert(params.end(), layer.bias.begin(), layer.bias.end());
+    }
+    std::vector<float> rows;
+    for (const TestCase& test : tests) {
+        if (test.inputs.size() != kInputs || test.outputs.size() != 1) {
+            throw std::runtime_error("SensorFusionKernel: embedded test vector has the wrong shape");
+        }
+        rows.insert(rows.end(), test.inputs.begin(), test.inputs.end());
+        rows.push_back(test.outputs[0]);
+    }
+    install(params.data(), std::move(rows));
+}
+
+void SensorFusionKernel::install(const float* params, std::vector<float> tests) {
+    loaded_ = false;
+    const float* p = params;
+    for (size_t i = 0; i < kInputs; ++i) {
+        for (size_t j = 0; j < kHidden1; ++j) w1_[i][j / kLanes][j % kLanes] = *p++;
+    }
+    for (size_t j = 0; j < kHidden1; ++j) b1_[j / kLanes][j % kLanes] = *p++;
+    for (size_t i = 0; i < kHidden1; ++i) {
+        for (size_t j = 0; j < kHidden2; ++j) w2_[i][j / kLanes][j % kLanes] = *p++;
+    }
+    for (size_t j = 0; j < kHidden2; ++j) b2_[j / kLanes][j % kLanes] = *p++;
+    for (size_t i = 0; i < kHidden2; ++i) w3_[i] = *p++;
+    b3_ = *p++;
+    loaded_ = true;
+
+    constexpr size_t row = kInputs + 1;
+    load_check_error_ = 0.0f;
+    load_check_samples_ = 0;
+    for (size_t t = 0; t + row <= tests.size(); t += row) {
+        float error = std::fabs(predict(&tests[t]) - tests[t + kInputs]);
+        if (!(error <= kVerifyTolerance)) {
+            loaded_ = false;
+            throw std::runtime_error("SensorFusionKernel: output differs from the model's test vector by " +
+                                     std::to_string(error));
+        }
+        if (error > load_check_error_) load_check_error_ = error;
+        ++load_check_samples_;
+    }
+    tests_ = std::move(tests);
+}
+
+std::string SensorFusionKernel::blob_path_for(const std::string& model_path) {
+    const std::string ext = ".json";
+    if (model_path.size() >= ext.size() &&
+        model_path.compare(model_path.size() - ext.size(), ext.size(), ext) == 0) {
+        return model_path.substr(0, model_path.size() - ext.size()) + ".aimb";
+    }
+    return model_path + ".aimb";
+}
+
+bool SensorFusionKernel::file_checksum(const std::string& path, std::uint64_t& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::ostringstream text;
+    text << in.rdbuf();
+    const std::string bytes = text.str();
+    out = fnv1a64(bytes.data(), bytes.size());
+    return true;
+}
+
+std::string SensorFusionKernel::to_blob() const {
+    require_loaded();
+    std::vector<float> payload;
+    payload.reserve(kParams + tests_.size());
+    for (size_t i = 0; i < kInputs; ++i) {
+        for (size_t j = 0; j < kHidden1; ++j) payload.push_back(w1_[i][j / kLanes][j % kLanes]);
+    }
+    for (size_t j = 0; j < kHidden1; ++j) payload.push_back(b1_[j / kLanes][j % kLanes]);
+    for (size_t i = 0; i < kHidden1; ++i) {
+        for (size_t j = 0; j < kHidden2; ++j) payload.push_back(w2_[i][j / kLanes][j % kLanes]);
+    }
+    for (size_t j = 0; j < kHidden2; ++j) payload.push_back(b2_[j / kLanes][j % kLanes]);
+    for (size_t i = 0; i < kHidden2; ++i) payload.push_back(w3_[i]);
+    payload.push_back(b3_);
+    payload.insert(payload.end(), tests_.begin(), tests_.end());
+
+    BlobHeader h{};
+    std::memcpy(h.magic, kBlobMagic, sizeof(h.magic));
+    h.version = kBlobVersion;
+    h.header_size = sizeof(BlobHeader);
+    h.inputs = kInputs;
+    h.hidden1 = kHidden1;
+    h.hidden2 = kHidden2;
+    h.outputs = 1;
+    h.params = kParams;
+    h.test_count = static_cast<std::uint32_t>(tests_.size() / (kInputs + 1));
+    h.payload_bytes = payload.size() * sizeof(float);
+    h.checksum = fnv1a64(payload.data(), h.payload_bytes);
+    h.check_error = load_check_error_;
+    h.source_checksum = source_checksum_;
+
+    std::string blob(sizeof(h) + h.payload_bytes, '\0');
+    std::memcpy(&blob[0], &h, sizeof(h));
+    std::memcpy(&blob[sizeof(h)], payload.data(), h.payload_bytes);
+    return blob;
+}
+
+void SensorFusionKernel::write_blob(const std::string& blob_path) const {
+    const std::string blob = to_blob();
+    const std::string tmp = blob_path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+        if (!out.flush()) {
+            throw std::runtime_error("SensorFusionKernel: cannot write " + tmp);
+        }
+    }
+    if (std::rename(tmp.c_str(), blob_path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("SensorFusionKernel: cannot replace " + blob_path);
+    }
+}
+
+void SensorFusionKernel::load_blob(const std::string& blob_path, const std::string& source_path) {
+    int fd = ::open(blob_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("SensorFusionKernel: cannot open model blob " + blob_path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        throw std::runtime_error("SensorFusionKernel: empty or unreadable model blob " + blob_path);
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("SensorFusionKernel: cannot map model blob " + blob_path);
+    }
+    try {
+        load_from_blob(addr, size);
+    } catch (...) {
+        ::munmap(addr, size);
+        throw;
+    }
+    ::munmap(addr, size);
+
+    std::uint64_t source = 0;
+    if (!source_path.empty() && file_checksum(source_path, source) && source != source_checksum_) {
+        loaded_ = false;
+        throw std::runtime_error("SensorFusionKernel: " + blob_path + " was not packed from " + source_path +
+                                 " (stale blob; re-run ai_iv_model_pack)");
+    }
+}
+
+void SensorFusionKernel::load_from_blob(const void* data, size_t size) {
+    loaded_ = false;
+    auto reject = [](const std::string& what) {
+        throw std::runtime_error("SensorFusionKernel: bad model blob (" + what + ")");
+    };
+    BlobHeader h;
+    if (size < sizeof(h)) reject("truncated header");
+    std::memcpy(&h, data, sizeof(h));
+    if (std::memcmp(h.magic, kBlobMagic, sizeof(h.magic)) != 0) reject("not a model blob");
+    if (h.version != kBlobVersion) reject("format version " + std::to_string(h.version));
+    if (h.header_size != sizeof(BlobHeader) || h.inputs != kInputs || h.hidden1 != kHidden1 ||
+        h.hidden2 != kHidden2 || h.outputs != 1 || h.params != kParams) {
+        reject("does not match the 5-16-8-1 architecture");
+    }
+    const std::uint64_t expected = (static_cast<std::uint64_t>(kParams) +
+                                    static_cast<std::uint64_t>(h.test_count) * (kInputs + 1)) * sizeof(float);
+    if (h.payload_bytes != expected || size - sizeof(h) != expected) reject("payload size");
+    const char* payload = static_cast<const char*>(data) + sizeof(h);
+    if (fnv1a64(payload, h.payload_bytes) != h.checksum) reject("checksum mismatch");
+
+    // The mapping is only page-aligned at the start; copy out of it
+    std::vector<float> floats(h.payload_bytes / sizeof(float));
+    std::memcpy(floats.data(), payload, h.payload_bytes);
+    install(floats.data(), std::vector<float>(floats.begin() + kParams, floats.end()));
+    source_checksum_ = h.source_checksum;
+}
+
+void SensorFusionKernel::require_loaded() const {
+    if (!loaded_) {
+        throw std::runtime_error("SensorFusionKernel::predict called before load()");
+    }
+}
+
+float SensorFusionKernel::predict(const float inputs[kInputs]) const {
+    require_loaded();
+    constexpr size_t H1 = kHidden1 / kLanes;
+    constexpr size_t H2 = kHidden2 / kLanes;
+    const Lanes zero = {};
+
+    // Layer 1: lanes run over the 16 hidden units.
+    Lanes h1[H1];
+    for (size_t v = 0; v < H1; ++v) h1[v] = b1_[v];
+    for (size_t i = 0; i < kInputs; ++i) {
+        for (size_t v = 0; v < H1; ++v) h1[v] += inputs[i] * w1_[i][v];
+    }
+    float a1[kHidden1];
+    for (size_t v = 0; v < H1; ++v) {
+        Lanes r = h1[v] > zero ? h1[v] : zero;
+        std::memcpy(a1 + v * kLanes, &r, sizeof(r));
+    }
+
+    // Layer 2
+    Lanes h2[H2];
+    for (size_t v = 0; v < H2; ++v) h2[v] = b2_[v];
+    for (size_t i = 0; i < kHidden1; ++i) {
+        for (size_t v = 0; v < H2; ++v) h2[v] += a1[i] * w2_[i][v];
+    }
+    float a2[kHidden2];
+    for (size_t v = 0; v < H2; ++v) {
+        Lanes r = h2[v] > zero ? h2[v] : zero;
+        std::memcpy(a2 + v * kLanes, &r, sizeof(r));
+    }
+
+    // Output unit
+    float z = b3_;
+    for (size_t i = 0; i < kHidden2; ++i) z += a2[i] * w3_[i];
+    return 1.0f / (1.0f + std::exp(-z));
+}
+
+void SensorFusionKernel::predict_batch(const float* inputs, size_t count, float* outputs) const {
+    require_loaded();
+    const Lanes zero = {};
+
+    for (size_t base = 0; base < count; base += kLanes) {
+        size_t n = count - base < kLanes ? count - base : kLanes;
+
+        // Transpose kLanes samples so each lane holds one sample; a short
+        // tail block is zero-padded.
+        Lanes x[kInputs] = {};
+        for (size_t s = 0; s < n; ++s) {
+            for (size_t i = 0; i < kInputs; ++i) x[i][s] = inputs[(base + s) * kInputs + i];
+        }
+
+        // Input-major loops keep every unit's accumulator independent, so
+        // the adds pipeline instead of forming one long dependency chain.
+        // Per unit the summation order is the same as in predict().
+        Lanes a1[kHidden1];
+        for (size_t j = 0; j < kHidden1; ++j) a1[j] = zero + b1_[j / kLanes][j % kLanes];
+        for (size_t i = 0; i < kInputs; ++i) {
+#pragma GCC unroll 16
+            for (size_t j = 0; j < kHidden1; ++j) a1[j] += x[i] * w1_[i][j / kLanes][j % kLanes];
+        }
+        for (size_t j = 0; j < kHidden1; ++j) a1[j] = a1[j] > zero ? a1[j] : zero;
+
+        Lanes a2[kHidden2];
+        for (size_t j = 0; j < kHidden2; ++j) a2[j] = zero + b2_[j / kLanes][j % kLanes];
+        for (size_t i = 0; i < kHidden1; ++i) {
+#pragma GCC unroll 8
+            for (size_t j = 0; j < kHidden2; ++j) a2[j] += a1[i] * w2_[i][j / kLanes][j % kLanes];
+        }
+        for (size_t j = 0; j < kHidden2; ++j) a2[j] = a2[j] > zero ? a2[j] : zero;
+
+        Lanes z = zero + b3_;
+        for (size_t i = 0; i < kHidden2; ++i) z += a2[i] * w3_[i];
+        for (size_t s = 0; s < n; ++s) outputs[base + s] = 1.0f / (1.0f + std::exp(-z[s]));
+    }
+}
+
+} // namespace ivsys
@@ -0,0 +1,137 @@
+#pragma once
+
+/*
+ * SensorFusionKernel.hpp
+ *
+ * Allocation-free inference for the sensor-fusion energy-proxy network
+ * (Dense-16-ReLU -> Dense-8-ReLU -> Dense-1-Sigmoid, 241 parameters).
+ *
+ * - load() reads the weights straight out of the frugally-deep JSON model
+ *   (models/sensor_fusion_fdeep.json) once, into fixed-size arrays of
+ *   4-float SIMD lanes.  No fdeep, Eigen or JSON library is needed, so the
+ *   kernel builds in every configuration.
+ * - predict() runs one sample with the layers vectorized across units;
+ *   predict_batch() runs kLanes samples at a time with one sample per lane
+ *   (many patients, or every step of a replay).  Both accumulate in the
+ *   same order, and neither allocates or takes a lock.
+ * - load() re-evaluates the test vectors fdeep embeds in the model file
+ *   and throws if any output is off by more than kVerifyTolerance, so a
+ *   layout or activation mismatch is caught at startup rather than as a
+ *   silently wrong energy proxy.  NeuralStateEstimator additionally
+ *   cross-checks it against the fdeep model itself.
+ * - write_blob() packs the checked weights and test vectors into a
+ *   versioned binary blob (ai_iv_model_pack, models/<name>.aimb).  load_blob()
+ *   maps it, verifies magic, version, shapes and an FNV-1a checksum, and
+ *   re-runs the test vectors: no JSON parsing or base64 decoding, so a
+ *   cold load takes microseconds instead of milliseconds.
+ *
+ * Inputs are normalised as for NeuralStateEstimator::predict():
+ *   { hydration_pct/100, heart_rate_bpm/200, spo2_pct/100,
+ *     lactate_mmol/20, fatigue_idx }
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ivsys {
+
+class SensorFusionKernel {
+public:
+    static constexpr size_t kInputs = 5;
+    static constexpr size_t kHidden1 = 16;
+    static constexpr size_t kHidden2 = 8;
+    static constexpr size_t kLanes = 4;           // floats per SIMD vector
+    static constexpr float kVerifyTolerance = 1e-5f;
+    static constexpr size_t kParams =
+        kInputs * kHidden1 + kHidden1 + kHidden1 * kHidden2 + kHidden2 + kHidden2 + 1;
+
+    // Packed weight blob.  Fields are host byte order (little-endian on
+    // every supported target); the payload is kParams floats in Keras order
+    // (w1 [in][out], b1, w2, b2, w3, b3) followed by test_count rows of
+    // kInputs inputs and 1 expected output.
+    static constexpr char kBlobMagic[8] = {'A', 'I', 'I', 'V', 'S', 'F', 'K', '1'};
+    static constexpr std::uint32_t kBlobVersion = 1;
+    struct BlobHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t header_size;
+        std::uint32_t inputs;
+        std::uint32_t hidden1;
+        std::uint32_t hidden2;
+        std::uint32_t outputs;
+        std::uint32_t params;
+        std::uint32_t test_count;
+        std::uint64_t payload_bytes;
+        std::uint64_t checksum;           // FNV-1a 64 of the payload
+        float check_error;                // test-vector error when packed
+        std::uint32_t reserved;
+        std::uint64_t source_checksum;    // FNV-1a 64 of the JSON packed from, 0 if unknown
+    };
+
+    // Throws std::runtime_error if the file is missing, malformed, has the
+    // wrong layer shapes or fails its embedded test vectors.
+    void load(const std::string& model_path);
+    void load_from_json(const std::string& json);
+
+    // Throws std::runtime_error if the blob is missing, truncated, from
+    // another format version or architecture, fails its checksum or its
+    // test vectors.  With a source_path that exists, the blob must also
+    // have been packed from that exact file, so a retrained JSON is never
+    // shadowed by a stale blob.
+    void load_blob(const std::string& blob_path, const std::string& source_path = std::string());
+    void load_from_blob(const void* data, size_t size);
+
+    // The loaded model as a blob; write_blob() replaces blob_path
+    // atomically (temporary file + rename).
+    std::string to_blob() const;
+    void write_blob(const std::string& blob_path) const;
+
+    // models/x.json -> models/x.aimb
+    static std::string blob_path_for(const std::string& model_path);
+    // FNV-1a 64 of a file's bytes; false if it cannot be read.
+    static bool file_checksum(const std::string& path, std::uint64_t& out);
+    // Of the JSON the weights came from (0 for load_from_json() text).
+    std::uint64_t source_checksum() const { return source_checksum_; }
+
+    bool is_loaded() const { return loaded_; }
+
+    float predict(const float inputs[kInputs]) const;
+    float predict(float hydration_norm, float hr_norm, float spo2_norm,
+                  float lactate_norm, float fatigue) const {
+        const float inputs[kInputs] = {hydration_norm, hr_norm, spo2_norm, lactate_norm, fatigue};
+        return predict(inputs);
+    }
+
+    // inputs: count rows of kInputs floats (row-major); outputs: count floats.
+    void predict_batch(const float* inputs, size_t count, float* outputs) const;
+
+    // Largest deviation seen while checking the embedded test vectors.
+    float load_check_error() const { return load_check_error_; }
+    size_t load_check_samples() const { return load_check_samples_; }
+
+private:
+    typedef float Lanes __attribute__((vector_size(kLanes * sizeof(float))));
+
+    // Rows are input units, lanes run over output units.
+    Lanes w1_[kInputs][kHidden1 / kLanes] = {};
+    Lanes b1_[kHidden1 / kLanes] = {};
+    Lanes w2_[kHidden1][kHidden2 / kLanes] = {};
+    Lanes b2_[kHidden2 / kLanes] = {};
+    float w3_[kHidden2] = {};
+    float b3_ = 0.0f;
+
+    bool loaded_ = false;
+    float load_check_error_ = 0.0f;
+    size_t load_check_samples_ = 0;
+    std::uint64_t source_checksum_ = 0;
+    std::vector<float> tests_;            // rows of kInputs inputs + 1 output
+
+    // params: kParams floats in blob order.  Checks the test vectors and
+    // throws (leaving the kernel unloaded) if one is off.
+    void install(const float* params, std::vector<float> tests);
+    void require_loaded() const;
+};
+
+} // namespace ivsys
@@ -0,0 +1,94 @@
+#pragma once
+
+/*
+ * SeqLock.hpp
+ *
+ * Sequence-lock cell for publishing small trivially copyable records from
+ * one writer to any number of readers.
+ *
+ * - store() never blocks and never allocates: bump the sequence to odd,
+ *   write the words, bump it back to even.
+ * - load() copies the record and retries if a store overlapped the copy,
+ *   so readers never hold anything the writer has to wait for.
+ * - The payload is kept as relaxed atomic 64-bit words (the fence-based
+ *   scheme from Boehm, "Can Seqlocks Get Along With Programming Language
+ *   Memory Models?"), which keeps the racing copy well-defined.
+ *
+ * Stores must not run concurrently with each other; callers with more
+ * than one writer serialize them externally.
+ */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace ivsys {
+
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SeqLock payload must be trivially copyable");
+    static_assert(alignof(T) <= alignof(std::uint64_t),
+                  "SeqLock payload alignment must not exceed 8 bytes");
+
+public:
+    SeqLock() { store(T{}); }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    void store(const T& value) {
+        std::uint64_t raw[kWords] = {};
+        std::memcpy(raw, &value, sizeof(T));
+
+        std::uint64_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < kWords; ++i) {
+            words_[i].store(raw[i], std::memory_order_relaxed);
+        }
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    // Copies the latest complete record into out; returns how many times
+    // the copy had to be retried because a store overlapped it.
+    unsigned load(T& out) const {
+        std::uint64_t raw[kWords];
+        unsigned retries = 0;
+        while (true) {
+            std::uint64_t before = seq_.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                for (size_t i = 0; i < kWords; ++i) {
+                    raw[i] = words_[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (seq_.load(std::memory_order_relaxed) == before) {
+                    std::memcpy(&out, raw, sizeof(T));
+                    return retries;
+                }
+            }
+            if (++retries % 64 == 0) std::this_thread::yield();
+        }
+    }
+
+    T load() const {
+        T out;
+        load(out);
+        return out;
+    }
+
+    // Number of completed stores (including the initial one).
+    std::uint64_t version() const { return seq_.load(std::memory_order_acquire) / 2; }
+
+private:
+    static constexpr size_t kWords = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    std::atomic<std::uint64_t> seq_{0};
+    std::array<std::atomic<std::uint64_t>, kWords> words_{};
+};
+
+} // namespace ivsys
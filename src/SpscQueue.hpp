@@ -0,0 +1,92 @@
+#pragma once
+
+/*
+ * SpscQueue.hpp
+ *
+ * Bounded, lock-free single-producer / single-consumer queue.
+ *
+ * - Capacity is rounded up to a power of two and allocated once.
+ * - try_push / try_pop never block and never allocate.
+ * - Producer and consumer indices live on separate cache lines.
+ *
+ * "Single producer" means at most one thread pushes at a time; handing the
+ * producer role between threads is fine as long as the hand-off itself is
+ * synchronized (e.g. MultiPatientEngine's ready queue).
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace ivsys {
+
+template <typename T>
+class SpscQueue {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SpscQueue elements must be trivially copyable");
+
+public:
+    explicit SpscQueue(size_t min_capacity)
+        : capacity_(round_up_pow2(min_capacity < 2 ? 2 : min_capacity)),
+          mask_(capacity_ - 1),
+          slots_(new T[capacity_]) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    size_t capacity() const { return capacity_; }
+
+    // Approximate element count; exact when called from either endpoint
+    // while the other side is idle.
+    size_t size() const {
+        size_t tail = tail_.load(std::memory_order_acquire);
+        size_t head = head_.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    size_t free_slots() const { return capacity_ - size(); }
+    bool empty() const { return size() == 0; }
+
+    bool try_push(const T& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ >= capacity_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ >= capacity_) return false;
+        }
+        slots_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& out) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) return false;
+        }
+        out = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static size_t round_up_pow2(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    static constexpr size_t kCacheLine = 64;
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<T[]> slots_;
+
+    alignas(kCacheLine) std::atomic<size_t> head_{0};   // consumer-owned
+    size_t tail_cache_ = 0;                             // consumer's view of tail
+    alignas(kCacheLine) std::atomic<size_t> tail_{0};   // producer-owned
+    size_t head_cache_ = 0;                             // producer's view of head
+};
+
+} // namespace ivsys
@@ -3,40 +3,18 @@
 #include <cmath>
 #include <algorithm>
 
-#ifdef ENABLE_NEURAL_ESTIMATOR
-#include "NeuralStateEstimator.hpp"
-#include <iostream>
-#include <mutex>
-static ivsys::NeuralStateEstimator g_neural_estimator;
-static std::once_flag g_neural_init_flag;
-static void init_neural_estimator() {
-    std::call_once(g_neural_init_flag, []() {
-        try {
-            g_neural_estimator.load(NEURAL_MODEL_PATH);
-        } catch (const std::exception& e) {
-            std::cerr << "[NeuralEstimator] WARNING: could not load model ("
-                      << e.what() << "); falling back to rule-based estimator.\n";
-        }
-    });
-}
-#endif
-
 namespace ivsys {
 
-double StateEstimator::calculate_coherence(const Telemetry& m) {
+double StateEstimatorCore::calculate_coherence(const Telemetry& m) {
     double base_coherence = m.signal_quality;
 
     if (m.heart_rate_bpm < 40 || m.heart_rate_bpm > 180) base_coherence *= 0.5;
     if (m.temp_celsius < 35.0 || m.temp_celsius > 40.0) base_coherence *= 0.7;
     if (m.spo2_pct < 85.0) base_coherence *= 0.6;
 
-    if (telemetry_history.size() >= 5) {
-        double hr_variance = 0.0;
-        size_t start_idx = telemetry_history.size() - 5;
-        for (size_t i = start_idx; i < telemetry_history.size(); ++i) {
-            hr_variance += std::pow(telemetry_history[i].heart_rate_bpm - m.heart_rate_bpm, 2);
-        }
-        hr_variance /= 5.0;
+    if (hr_window.full()) {
+        // mean of (hr_k - hr_now)^2 over the window, maintained incrementally
+        double hr_variance = hr_window.mean_squared_deviation(m.heart_rate_bpm);
 
         if (hr_variance > 400.0) base_coherence *= 0.7;
     }
@@ -44,7 +22,7 @@ double StateEstimator::calculate_coherence(const Telemetry& m) {
     return Utils::clamp(base_coherence, 0.1, 1.0);
 }
 
-double StateEstimator::estimate_flow_velocity(const Telemetry& m, double infusion_rate_ml_min,
+double StateEstimatorCore::estimate_flow_velocity(const Telemetry& m, double infusion_rate_ml_min,
                                double weight_kg) {
     double cardiac_flow_ml_s = m.cardiac_output_L_min * 1000.0 / 60.0;
     double infusion_flow_ml_s = infusion_rate_ml_min / 60.0;
@@ -55,7 +33,7 @@ double StateEstimator::estimate_flow_velocity(const Telemetry& m, double infusio
     return Utils::clamp(v_estimated, 0.05, 40.0);
 }
 
-double StateEstimator::calculate_tissue_efficiency(const Telemetry& m,
+double StateEstimatorCore::calculate_tissue_efficiency(const Telemetry& m,
                                    const EnergyTransferParams& params,
                                    double perfusion_state) {
     double base_efficiency = params.eta_muscle;
@@ -75,7 +53,7 @@ double StateEstimator::calculate_tissue_efficiency(const Telemetry& m,
     return Utils::clamp(base_efficiency, params.eta_ischemic, params.eta_brain_heart);
 }
 
-double StateEstimator::calculate_energy_transfer_absolute(const Telemetry& m,
+double StateEstimatorCore::calculate_energy_transfer_absolute(const Telemetry& m,
                                            const EnergyTransferParams& params,
                                            double infusion_rate_ml_min,
                                            double weight_kg,
@@ -97,7 +75,7 @@ double StateEstimator::calculate_energy_transfer_absolute(const Telemetry& m,
     return T_t;
 }
 
-double StateEstimator::calculate_energy_proxy(const Telemetry& m) {
+double StateEstimatorCore::rule_energy_proxy(const Telemetry& m) {
     double h_term = Utils::sigmoid(m.hydration_pct, 60.0, 0.1);
 
     double b_term = Utils::exponential_decay(m.blood_loss_idx, 3.0);
@@ -119,7 +97,7 @@ double StateEstimator::calculate_energy_proxy(const Telemetry& m) {
     return Utils::clamp(energy, 0.0, 1.0);
 }
 
-double StateEstimator::calculate_metabolic_load(const Telemetry& m) {
+double StateEstimatorCore::calculate_metabolic_load(const Telemetry& m) {
     double hr_stress = Utils::clamp((m.heart_rate_bpm - 60.0) / 100.0, 0.0, 1.0);
     double temp_stress = std::abs(m.temp_celsius - 37.0) / 3.0;
     double lactate_stress = Utils::clamp(m.lactate_mmol / 10.0, 0.0, 1.0);
@@ -129,7 +107,7 @@ double StateEstimator::calculate_metabolic_load(const Telemetry& m) {
                        0.25*lactate_stress + 0.2*anxiety_stress, 0.0, 1.0);
 }
 
-double StateEstimator::calculate_cardiac_reserve(const Telemetry& m, double age_years) {
+double StateEstimatorCore::calculate_cardiac_reserve(const Telemetry& m, double age_years) {
     double max_predicted_hr = std::max(1.0, 220.0 - age_years);  // Fox formula (1971) for age-predicted HRmax
     double current_percentage = m.heart_rate_bpm / max_predicted_hr;
 
@@ -140,7 +118,7 @@ double StateEstimator::calculate_cardiac_reserve(const Telemetry& m, double age_
     return Utils::clamp(reserve, 0.0, 1.0);
 }
 
-double StateEstimator::calculate_risk_score(const Telemetry& m, double energy_T) {
+double StateEstimatorCore::calculate_risk_score(const Telemetry& m, double energy_T) {
     double blood_loss_risk = m.blood_loss_idx;
     double hypoxia_risk = Utils::clamp((95.0 - m.spo2_pct) / 10.0, 0.0, 1.0);
     double hypothermia_risk = std::max(0.0, (36.0 - m.temp_celsius) / 2.0);
@@ -156,29 +134,15 @@ double StateEstimator::calculate_risk_score(const Telemetry& m, double energy_T)
     return Utils::clamp(0.6*R_critical + 0.3*R_metabolic + 0.1*R_thermal, 0.0, 1.0);
 }
 
-PatientState StateEstimator::estimate(const Telemetry& m, const PatientProfile& profile,
-                     double current_infusion_rate) {
+PatientState StateEstimatorCore::estimate_with_energy(const Telemetry& m, const PatientProfile& profile,
+                                                  double current_infusion_rate, double energy_T) {
     PatientState state;
 
     state.hydration_pct = Utils::clamp(m.hydration_pct, 0.0, 100.0);
     state.heart_rate_bpm = std::max(0.0, m.heart_rate_bpm);
     state.coherence_sigma = calculate_coherence(m);
 
-#ifdef ENABLE_NEURAL_ESTIMATOR
-    init_neural_estimator();
-    if (g_neural_estimator.is_loaded()) {
-        state.energy_T = static_cast<double>(g_neural_estimator.predict(
-            static_cast<float>(m.hydration_pct  / 100.0),
-            static_cast<float>(m.heart_rate_bpm / 200.0),
-            static_cast<float>(m.spo2_pct       / 100.0),
-            static_cast<float>(m.lactate_mmol   /  20.0),
-            static_cast<float>(m.fatigue_idx)));
-    } else {
-        state.energy_T = calculate_energy_proxy(m);
-    }
-#else
-    state.energy_T = calculate_energy_proxy(m);
-#endif
+    state.energy_T = energy_T;
 
     state.energy_T_absolute = calculate_energy_transfer_absolute(
         m, profile.energy_params, current_infusion_rate,
@@ -199,35 +163,46 @@ PatientState StateEstimator::estimate(const Telemetry& m, const PatientProfile&
 
     history.push_back(state);
     telemetry_history.push_back(m);
-    if (history.size() > MAX_HISTORY) {
-        history.pop_front();
-        telemetry_history.pop_front();
-    }
+    predictor.update(state);
+    hr_window.push(m.heart_rate_bpm);
 
     return state;
 }
 
-std::optional<PatientState> StateEstimator::predict_forward(int minutes_ahead) {
-    if (history.size() < 5) return std::nullopt;
-
-    PatientState predicted = history.back();
-
-    size_t history_idx = history.size() - 5;
-    double hydration_trend = (history.back().hydration_pct -
-                             history[history_idx].hydration_pct) / 5.0;
-    double energy_trend = (history.back().energy_T -
-                          history[history_idx].energy_T) / 5.0;
-
-    predicted.hydration_pct += hydration_trend * minutes_ahead;
-    predicted.energy_T += energy_trend * minutes_ahead;
-    predicted.hydration_pct = Utils::clamp(predicted.hydration_pct, 0.0, 100.0);
-    predicted.energy_T = Utils::clamp(predicted.energy_T, 0.0, 1.0);
-
-    predicted.uncertainty = std::min(1.0, predicted.uncertainty + 0.05 * minutes_ahead);
+std::optional<PatientState> StateEstimatorCore::predict_forward(int minutes_ahead) {
+    auto prediction = predictor.predict(minutes_ahead);
+    if (!prediction) return std::nullopt;
+    return prediction->state;
+}
 
-    return predicted;
+const StateEstimatorCore::History& StateEstimatorCore::get_history() const { return history; }
+
+void StateEstimatorCore::save_checkpoint(CheckpointWriter& out, bool full) const {
+    out.put_ring(history, full);
+    out.put_ring(telemetry_history, full);
+    out.put_ring(hr_window.window(), full);
+    auto a = hr_window.accumulators();
+    out.put(a.mean);
+    out.put(a.m2);
+    out.put(a.sum);
+    out.put(a.weighted_sum);
+    out.put(a.pushes_since_resync);
+    predictor.save_checkpoint(out);
 }
 
-const std::deque<PatientState>& StateEstimator::get_history() const { return history; }
+bool StateEstimatorCore::restore_checkpoint(CheckpointReader& in, bool full) {
+    in.get_ring(history, full);
+    in.get_ring(telemetry_history, full);
+    RingBuffer<double, HR_VARIANCE_WINDOW> hr = hr_window.window();
+    in.get_ring(hr, full);
+    RollingStats<HR_VARIANCE_WINDOW>::Accumulators a;
+    in.get(a.mean);
+    in.get(a.m2);
+    in.get(a.sum);
+    in.get(a.weighted_sum);
+    in.get(a.pushes_since_resync);
+    hr_window.restore(hr, a);
+    return predictor.restore_checkpoint(in) && in.ok();
+}
 
 } // namespace ivsys
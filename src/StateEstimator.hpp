@@ -1,30 +1,111 @@
 #pragma once
 
 #include "iv_system_types.hpp"
-#include <deque>
+#include "RingBuffer.hpp"
+#include "EnergyProxyModel.hpp"
+#include "ForwardPredictor.hpp"
+#include "checkpoint_codec.hpp"
 #include <optional>
 
 namespace ivsys {
 
-class StateEstimator {
+// History, forward prediction and the physiological formulas; everything
+// an estimator does except choose its energy proxy.
+class StateEstimatorCore {
+public:
+    static constexpr size_t MAX_HISTORY = 50;
+    static constexpr size_t HR_VARIANCE_WINDOW = 5;
+    using History = RingBuffer<PatientState, MAX_HISTORY>;
+
+    // Latest estimate with hydration and energy_T forecast minutes_ahead
+    // estimate() steps on; nullopt for the first few estimates.  Served
+    // from ForwardPredictor, cached until the next estimate().
+    std::optional<PatientState> predict_forward(int minutes_ahead);
+    // Several horizons at once; returns how many were written (0 or count).
+    size_t predict_horizons(const int* horizons, size_t count, ForwardPrediction* out) {
+        return predictor.predict(horizons, count, out);
+    }
+    const ForwardPredictor& forward_predictor() const { return predictor; }
+    const History& get_history() const;
+
+    // Histories and predictor for replication (checkpoint_codec.hpp); a
+    // delta follows exactly one estimate() after the previous checkpoint.
+    // false leaves the estimator inconsistent; restore from a full one.
+    void save_checkpoint(CheckpointWriter& out, bool full) const;
+    bool restore_checkpoint(CheckpointReader& in, bool full);
+
+    // The hand-crafted energy proxy (also the RuleEnergyProxy model).
+    static double rule_energy_proxy(const Telemetry& m);
+
+protected:
+    // Every field but energy_T from the telemetry, then records the estimate.
+    PatientState estimate_with_energy(const Telemetry& m, const PatientProfile& profile,
+                                      double current_infusion_rate, double energy_T);
+
 private:
-    std::deque<PatientState> history;
-    std::deque<Telemetry> telemetry_history;
-    const size_t MAX_HISTORY = 50;
+    History history;
+    RingBuffer<Telemetry, MAX_HISTORY> telemetry_history;
+    RollingStats<HR_VARIANCE_WINDOW> hr_window;   // last 5 HR samples before the current one
+    ForwardPredictor predictor;                   // updated by every estimate()
 
     double calculate_coherence(const Telemetry& m);
     double estimate_flow_velocity(const Telemetry& m, double infusion_rate_ml_min, double weight_kg);
     double calculate_tissue_efficiency(const Telemetry& m, const EnergyTransferParams& params, double perfusion_state);
     double calculate_energy_transfer_absolute(const Telemetry& m, const EnergyTransferParams& params, double infusion_rate_ml_min, double weight_kg, double perfusion_state);
-    double calculate_energy_proxy(const Telemetry& m);
     double calculate_metabolic_load(const Telemetry& m);
     double calculate_cardiac_reserve(const Telemetry& m, double age_years);
     double calculate_risk_score(const Telemetry& m, double energy_T);
+};
+
+// Energy-proxy strategies for BasicStateEstimator.
+
+// The rule formula, called directly: no model, no virtual call.
+struct RuleEnergy {
+    double operator()(const Telemetry& m) const { return StateEstimatorCore::rule_energy_proxy(m); }
+};
+
+// A shared EnergyProxyModel (null: the rule formula), with a run-time
+// switch back to the rule formula.
+struct ModelEnergy {
+    EnergyProxyModelPtr model;
+    bool enabled = true;
 
+    double operator()(const Telemetry& m) const {
+        return (model && enabled) ? model->energy_proxy(m) : StateEstimatorCore::rule_energy_proxy(m);
+    }
+};
+
+template <typename Energy>
+class BasicStateEstimator : public StateEstimatorCore {
 public:
-    PatientState estimate(const Telemetry& m, const PatientProfile& profile, double current_infusion_rate);
-    std::optional<PatientState> predict_forward(int minutes_ahead);
-    const std::deque<PatientState>& get_history() const;
+    BasicStateEstimator() = default;
+    explicit BasicStateEstimator(Energy energy) : energy_(std::move(energy)) {}
+
+    PatientState estimate(const Telemetry& m, const PatientProfile& profile, double current_infusion_rate) {
+        return estimate_with_energy(m, profile, current_infusion_rate, energy_(m));
+    }
+
+    const Energy& energy() const { return energy_; }
+
+protected:
+    Energy energy_;
+};
+
+// The run-time configurable estimator (TunedPolicy's).
+class StateEstimator : public BasicStateEstimator<ModelEnergy> {
+public:
+    // energy_model supplies E_T; null uses the rule formula directly.
+    // The model is shared read-only, so any number of estimators (and
+    // threads) may hold the same instance.
+    explicit StateEstimator(EnergyProxyModelPtr model = nullptr)
+        : BasicStateEstimator(ModelEnergy{std::move(model), true}) {}
+
+    void set_energy_proxy_model(EnergyProxyModelPtr model) { energy_.model = std::move(model); }
+    const EnergyProxyModelPtr& energy_proxy_model() const { return energy_.model; }
+
+    // false forces the rule-based energy proxy whatever model is set.
+    void set_neural_energy_proxy(bool enabled) { energy_.enabled = enabled; }
+    bool uses_neural_energy_proxy() const { return energy_.enabled; }
 };
 
 } // namespace ivsys
@@ -1,13 +1,18 @@
 #include "SystemLogger.hpp"
 #include "Utils.hpp"
+#include "json_format.hpp"
+#include "control_text.hpp"
 #include <sstream>
 #include <iomanip>
 #include <stdexcept>
 #include <regex>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 
 namespace ivsys {
 
-std::string SystemLogger::severity_to_string(AlertSeverity severity) {
+const char* SystemLogger::severity_to_string(AlertSeverity severity) {
     switch (severity) {
         case AlertSeverity::Debug: return "DEBUG";
         case AlertSeverity::Info: return "INFO";
@@ -18,41 +23,50 @@ std::string SystemLogger::severity_to_string(AlertSeverity severity) {
     return "INFO";
 }
 
-std::string SystemLogger::escape_json_string(const std::string& input) {
-    std::ostringstream oss;
-    for (char c : input) {
+void SystemLogger::write_json_escaped(std::ostream& os, const char* text) {
+    static const char kHex[] = "0123456789abcdef";
+    for (const char* p = text; *p; ++p) {
+        char c = *p;
         switch (c) {
-            case '\\': oss << "\\\\"; break;
-            case '"': oss << "\\\""; break;
-            case '\n': oss << "\\n"; break;
-            case '\r': oss << "\\r"; break;
-            case '\t': oss << "\\t"; break;
+            case '\\': os << "\\\\"; break;
+            case '"': os << "\\\""; break;
+            case '\n': os << "\\n"; break;
+            case '\r': os << "\\r"; break;
+            case '\t': os << "\\t"; break;
             default:
                 if (static_cast<unsigned char>(c) < 0x20) {
-                    oss << "\\u"
-                        << std::hex << std::setw(4) << std::setfill('0')
-                        << static_cast<int>(static_cast<unsigned char>(c))
-                        << std::dec << std::setfill(' ');
+                    unsigned char u = static_cast<unsigned char>(c);
+                    os << "\\u00" << kHex[u >> 4] << kHex[u & 0xF];
                 } else {
-                    oss << c;
+                    os << c;
                 }
         }
     }
-    return oss.str();
 }
 
 void SystemLogger::log_alert_event(const AlertEvent& event) {
-    log_file << "ALERT {\"timestamp\":" << event.timestamp_ms
-             << ",\"severity\":\"" << severity_to_string(event.severity) << "\""
-             << ",\"source\":\"" << escape_json_string(event.source) << "\""
-             << ",\"code\":\"" << escape_json_string(event.code) << "\""
-             << ",\"message\":\"" << escape_json_string(event.message) << "\"";
-    if (event.context_json && !event.context_json->empty()) {
-        const std::string& ctx = *event.context_json;
-        if (!ctx.empty() && (ctx.front() == '{' || ctx.front() == '[')) {
-            log_file << ",\"context\":" << ctx;
+    write_alert(event.timestamp_ms, event.severity, event.source.c_str(), event.code.c_str(),
+                event.message.c_str(), event.context_json ? event.context_json->c_str() : nullptr);
+}
+
+void SystemLogger::write_alert(long long timestamp_ms, AlertSeverity severity, const char* source,
+                               const char* code, const char* message, const char* context) {
+    log_file << "ALERT {\"timestamp\":" << timestamp_ms
+             << ",\"severity\":\"" << severity_to_string(severity) << "\""
+             << ",\"source\":\"";
+    write_json_escaped(log_file, source);
+    log_file << "\",\"code\":\"";
+    write_json_escaped(log_file, code);
+    log_file << "\",\"message\":\"";
+    write_json_escaped(log_file, message);
+    log_file << "\"";
+    if (context && *context) {
+        if (context[0] == '{' || context[0] == '[') {
+            log_file << ",\"context\":" << context;
         } else {
-            log_file << ",\"context\":\"" << escape_json_string(ctx) << "\"";
+            log_file << ",\"context\":\"";
+            write_json_escaped(log_file, context);
+            log_file << "\"";
         }
     }
     log_file << "}\n";
@@ -60,12 +74,24 @@ void SystemLogger::log_alert_event(const AlertEvent& event) {
     if (++log_flush_counter % kFlushEvery == 0) {
         log_file.flush();
     }
-    if (event.severity == AlertSeverity::Critical) {
+    if (severity == AlertSeverity::Critical) {
         log_file.flush();
     }
 }
 
-SystemLogger::SystemLogger(const std::string& session_id) {
+const char* const SystemLogger::kTelemetryCsvHeader =
+    "timestamp,hydration_pct,heart_rate_bpm,temp_c,blood_loss_idx,"
+    "fatigue_idx,anxiety_idx,signal_quality,spo2_pct,lactate_mmol,"
+    "cardiac_output_L_min,vault_mesh_size_nm,vault_payload_pct,vault_cage_breached\n";
+
+const char* const SystemLogger::kControlCsvHeader =
+    "timestamp,infusion_rate_ml_min,confidence,energy_T,energy_T_abs_W_kg,"
+    "flow_velocity_cm_s,flow_efficiency,risk_score,"
+    "cardiac_reserve,warnings,rationale\n";
+
+SystemLogger::SystemLogger(const std::string& session_id, LoggerMode mode, size_t queue_capacity,
+                           SessionFormat format)
+    : mode_(mode), format_(format) {
     // Validate session_id against allowlist: only [a-zA-Z0-9_-] permitted
     static const std::regex session_id_pattern("^[a-zA-Z0-9_-]+$");
     if (session_id.empty() || !std::regex_match(session_id, session_id_pattern)) {
@@ -73,87 +99,413 @@ SystemLogger::SystemLogger(const std::string& session_id) {
     }
     std::string prefix = "ai_iv_" + session_id;
     log_file.open(prefix + "_system.log");
-    telemetry_file.open(prefix + "_telemetry.csv");
-    control_file.open(prefix + "_control.csv");
-    if (!log_file.is_open() || !telemetry_file.is_open() || !control_file.is_open()) {
+    if (!log_file.is_open()) {
         throw std::runtime_error("Failed to open one or more log files for session " + session_id);
     }
 
-    telemetry_file << "timestamp,hydration_pct,heart_rate_bpm,temp_c,blood_loss_idx,"
-                   << "fatigue_idx,anxiety_idx,signal_quality,spo2_pct,lactate_mmol,"
-                   << "cardiac_output_L_min,vault_mesh_size_nm,vault_payload_pct,vault_cage_breached\n";
+    if (format_ != SessionFormat::Binary) {
+        telemetry_file.open(prefix + "_telemetry.csv");
+        control_file.open(prefix + "_control.csv");
+        if (!telemetry_file.is_open() || !control_file.is_open()) {
+            throw std::runtime_error("Failed to open one or more log files for session " + session_id);
+        }
+        telemetry_file << kTelemetryCsvHeader;
+        control_file << kControlCsvHeader;
+    }
+    if (format_ != SessionFormat::Csv) {
+        session_writer_ = std::make_unique<session_format::SessionWriter>(
+            prefix + session_format::kFileSuffix, session_id);
+    }
 
-    control_file << "timestamp,infusion_rate_ml_min,confidence,energy_T,energy_T_abs_W_kg,"
-                << "flow_velocity_cm_s,flow_efficiency,risk_score,"
-                << "cardiac_reserve,warnings,rationale\n";
+    if (mode_ == LoggerMode::Async) {
+        queue_ = std::make_unique<SpscQueue<LogRecord>>(
+            std::max(queue_capacity, kCriticalReserve * 2));
+        writer_running_.store(true);
+        writer_ = std::thread(&SystemLogger::writer_loop, this);
+    }
 }
 
 SystemLogger::~SystemLogger() {
+    if (writer_.joinable()) {
+        writer_running_.store(false);
+        wake_cv_.notify_one();
+        writer_.join();
+    }
+    if (session_writer_) session_writer_->close();
     log_file.close();
     telemetry_file.close();
     control_file.close();
 }
 
-void SystemLogger::log_telemetry(const Telemetry& m) {
-    telemetry_file << Utils::timestamp_str(m.timestamp) << ","
-                   << m.hydration_pct << ","
-                   << m.heart_rate_bpm << ","
-                   << m.temp_celsius << ","
-                   << m.blood_loss_idx << ","
-                   << m.fatigue_idx << ","
-                   << m.anxiety_idx << ","
-                   << m.signal_quality << ","
-                   << m.spo2_pct << ","
-                   << m.lactate_mmol << ","
-                   << m.cardiac_output_L_min << ","
-                   << m.vault_mesh_size_nm << ","
-                   << m.vault_payload_pct << ","
-                   << m.vault_cage_breached << "\n";
+void SystemLogger::write_telemetry_row(std::ostream& os, const Telemetry& m) {
+    os << Utils::timestamp_str(m.timestamp) << ","
+       << m.hydration_pct << ","
+       << m.heart_rate_bpm << ","
+       << m.temp_celsius << ","
+       << m.blood_loss_idx << ","
+       << m.fatigue_idx << ","
+       << m.anxiety_idx << ","
+       << m.signal_quality << ","
+       << m.spo2_pct << ","
+       << m.lactate_mmol << ","
+       << m.cardiac_output_L_min << ","
+       << m.vault_mesh_size_nm << ","
+       << m.vault_payload_pct << ","
+       << m.vault_cage_breached << "\n";
+}
+
+void SystemLogger::write_control_row(std::ostream& os, const ControlOutput& out,
+                                     const PatientState& state,
+                                     std::chrono::steady_clock::time_point t) {
+    os << Utils::timestamp_str(t) << ","
+       << out.infusion_ml_per_min << ","
+       << out.confidence << ","
+       << state.energy_T << ","
+       << state.energy_T_absolute << ","
+       << state.estimated_flow_velocity_cm_s << ","
+       << state.flow_efficiency << ","
+       << state.risk_score << ","
+       << state.cardiac_reserve << ",\"";
+    write_warnings(os, out.warning_flags);
+    os << "\",\"";
+    write_rationale(os, out.rationale);
+    os << "\"\n";
+}
+
+void SystemLogger::write_telemetry(const Telemetry& m) {
+    if (session_writer_) session_writer_->append_telemetry(m);
+    if (format_ == SessionFormat::Binary) return;
+    write_telemetry_row(telemetry_file, m);
     if (++telemetry_flush_counter % kFlushEvery == 0) {
         telemetry_file.flush();
     }
 }
 
-void SystemLogger::log_control(const ControlOutput& out, const PatientState& state,
+void SystemLogger::write_control(const ControlOutput& out, const PatientState& state,
                  std::chrono::steady_clock::time_point t) {
-    control_file << Utils::timestamp_str(t) << ","
-                 << out.infusion_ml_per_min << ","
-                 << out.confidence << ","
-                 << state.energy_T << ","
-                 << state.energy_T_absolute << ","
-                 << state.estimated_flow_velocity_cm_s << ","
-                 << state.flow_efficiency << ","
-                 << state.risk_score << ","
-                 << state.cardiac_reserve << ","
-                 << "\"" << out.warning_flags << "\","
-                 << "\"" << out.rationale << "\"\n";
+    if (session_writer_) session_writer_->append_control(out, state, t);
+    if (format_ == SessionFormat::Binary) return;
+    write_control_row(control_file, out, state, t);
     if (++control_flush_counter % kFlushEvery == 0) {
         control_file.flush();
     }
 }
 
-void SystemLogger::log_event(const std::string& event) {
-    auto now = std::chrono::steady_clock::now();
-    log_file << "[" << Utils::timestamp_str(now) << "] " << event << "\n";
+void SystemLogger::write_event(const std::string& event, std::chrono::steady_clock::time_point t) {
+    log_file << "[" << Utils::timestamp_str(t) << "] " << event << "\n";
     if (++log_flush_counter % kFlushEvery == 0) {
         log_file.flush();
     }
 }
 
+void SystemLogger::log_telemetry(const Telemetry& m) {
+    if (mode_ == LoggerMode::Sync) {
+        write_telemetry(m);
+        return;
+    }
+    LogRecord rec;
+    rec.kind = RecordKind::Telemetry;
+    rec.telemetry = m;
+    enqueue(rec, false);
+}
+
+void SystemLogger::log_control(const ControlOutput& out, const PatientState& state,
+                 std::chrono::steady_clock::time_point t) {
+    if (mode_ == LoggerMode::Sync) {
+        write_control(out, state, t);
+        return;
+    }
+    LogRecord rec;
+    rec.kind = RecordKind::Control;
+    rec.control = ControlFields{};
+    rec.control.infusion_ml_per_min = out.infusion_ml_per_min;
+    rec.control.confidence = out.confidence;
+    rec.control.safety_override = out.safety_override;
+    rec.control.state = state;
+    rec.control.t = t;
+    rec.control.warnings = out.warning_flags;
+    rec.control.rationale = out.rationale;
+    enqueue(rec, false);
+}
+
+void SystemLogger::log_event(const std::string& event) {
+    auto now = std::chrono::steady_clock::now();
+    if (mode_ == LoggerMode::Sync) {
+        write_event(event, now);
+        return;
+    }
+    LogRecord rec;
+    rec.kind = RecordKind::Event;
+    rec.text = TextFields{};
+    rec.text.t = now;
+    if (copy_text(rec.text.message, sizeof(rec.text.message), event)) {
+        truncated_.fetch_add(1, std::memory_order_relaxed);
+    }
+    enqueue(rec, false);
+}
+
+void SystemLogger::log_loop_metrics(const ControlLoopMetrics::Snapshot& s) {
+    std::string line = "LOOP_METRICS ticks=";
+    json::append_uint(line, s.ticks);
+    line += " overruns=";
+    json::append_uint(line, s.overruns);
+    line += " skipped=";
+    json::append_uint(line, s.skipped_periods);
+    line += " exec_us=p50:";
+    json::append_fixed(line, s.tick.percentile_us(0.50), 0);
+    line += ",p99:";
+    json::append_fixed(line, s.tick.percentile_us(0.99), 0);
+    line += ",max:";
+    json::append_fixed(line, s.tick.max_us(), 0);
+    line += " jitter_us=p99:";
+    json::append_fixed(line, s.jitter.percentile_us(0.99), 0);
+    line += ",max:";
+    json::append_fixed(line, s.jitter.max_us(), 0);
+    log_event(line);
+
+    line = "LOOP_STAGES p99_us";
+    for (size_t i = 0; i < ControlLoopMetrics::kStageCount; ++i) {
+        line += ' ';
+        line += ControlLoopMetrics::stage_name(static_cast<LoopStage>(i));
+        line += '=';
+        json::append_fixed(line, s.stages[i].percentile_us(0.99), 0);
+    }
+    log_event(line);
+}
+
 void SystemLogger::log_alert(AlertSeverity severity,
                const std::string& source,
                const std::string& code,
                const std::string& message,
                const std::optional<std::string>& context_json) {
-    AlertEvent event{
-        Utils::epoch_ms(),
-        severity,
-        source,
-        code,
-        message,
-        context_json
-    };
-    log_alert_event(event);
+    if (mode_ == LoggerMode::Sync) {
+        AlertEvent event{
+            Utils::epoch_ms(),
+            severity,
+            source,
+            code,
+            message,
+            context_json
+        };
+        log_alert_event(event);
+        return;
+    }
+    LogRecord rec;
+    rec.kind = RecordKind::Alert;
+    rec.text = TextFields{};
+    rec.text.timestamp_ms = Utils::epoch_ms();
+    rec.text.severity = severity;
+    bool cut = copy_text(rec.text.source, sizeof(rec.text.source), source);
+    cut |= copy_text(rec.text.code, sizeof(rec.text.code), code);
+    cut |= copy_text(rec.text.message, sizeof(rec.text.message), message);
+    if (context_json && !context_json->empty()) {
+        rec.text.has_context = true;
+        // A truncated JSON context is no longer valid JSON; the writer then
+        // emits it as an escaped string instead.
+        rec.text.context_truncated =
+            copy_text(rec.text.context, sizeof(rec.text.context), *context_json);
+        cut |= rec.text.context_truncated;
+    }
+    if (cut) truncated_.fetch_add(1, std::memory_order_relaxed);
+    enqueue(rec, severity == AlertSeverity::Critical);
+}
+
+void SystemLogger::log_alert(AlertSeverity severity, const char* source, const char* code,
+                             const char* message, const AlertValue* values, size_t count) {
+    char context[sizeof(TextFields::context)];
+    size_t len = 0;
+    bool cut = false;
+    for (size_t i = 0; i < count; ++i) {
+        int n = std::snprintf(context + len, sizeof(context) - len, "%s\"%s\":%f",
+                              i == 0 ? "{" : ",", values[i].key, values[i].value);
+        if (n < 0 || len + static_cast<size_t>(n) + 2 > sizeof(context)) {
+            cut = true;   // drop the pair rather than emit broken JSON
+            context[len] = '\0';
+            break;
+        }
+        len += static_cast<size_t>(n);
+    }
+    if (len > 0) {
+        context[len++] = '}';
+        context[len] = '\0';
+    } else {
+        context[0] = '\0';
+    }
+
+    if (mode_ == LoggerMode::Sync) {
+        write_alert(Utils::epoch_ms(), severity, source, code, message, context);
+        return;
+    }
+    LogRecord rec;
+    rec.kind = RecordKind::Alert;
+    rec.text = TextFields{};
+    rec.text.timestamp_ms = Utils::epoch_ms();
+    rec.text.severity = severity;
+    cut |= copy_text(rec.text.source, sizeof(rec.text.source), source);
+    cut |= copy_text(rec.text.code, sizeof(rec.text.code), code);
+    cut |= copy_text(rec.text.message, sizeof(rec.text.message), message);
+    if (len > 0) {
+        rec.text.has_context = true;
+        copy_text(rec.text.context, sizeof(rec.text.context), context);
+    }
+    if (cut) truncated_.fetch_add(1, std::memory_order_relaxed);
+    enqueue(rec, severity == AlertSeverity::Critical);
+}
+
+LoggerStats SystemLogger::stats() const {
+    LoggerStats s;
+    s.enqueued = enqueued_.load(std::memory_order_relaxed);
+    s.written = written_.load(std::memory_order_relaxed);
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    s.truncated = truncated_.load(std::memory_order_relaxed);
+    if (queue_) {
+        s.queue_depth = queue_->size();
+        s.queue_capacity = queue_->capacity();
+    }
+    s.max_queue_depth = max_queue_depth_.load(std::memory_order_relaxed);
+    if (mode_ == LoggerMode::Async && s.written > 0) {
+        s.mean_write_latency_ms = latency_sum_ms_.load(std::memory_order_relaxed) /
+                                  static_cast<double>(s.written);
+    }
+    s.max_write_latency_ms = latency_max_ms_.load(std::memory_order_relaxed);
+    return s;
+}
+
+// ============================================================================
+// Async backend
+// ============================================================================
+
+bool SystemLogger::copy_text(char* dst, size_t cap, const std::string& src) {
+    size_t n = std::min(src.size(), cap - 1);
+    std::memcpy(dst, src.data(), n);
+    dst[n] = '\0';
+    return n < src.size();
+}
+
+bool SystemLogger::copy_text(char* dst, size_t cap, const char* src) {
+    size_t n = 0;
+    while (n + 1 < cap && src[n]) {
+        dst[n] = src[n];
+        ++n;
+    }
+    dst[n] = '\0';
+    return src[n] != '\0';
+}
+
+bool SystemLogger::enqueue(const LogRecord& rec, bool critical) {
+    // Non-critical records may not consume the slots reserved for Critical
+    // alerts, so a backed-up writer can never cause a Critical to be lost.
+    if (!critical && queue_->free_slots() <= kCriticalReserve) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    LogRecord stamped = rec;
+    stamped.enqueued_at = std::chrono::steady_clock::now();
+    if (!queue_->try_push(stamped)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    enqueued_.fetch_add(1, std::memory_order_relaxed);
+
+    size_t depth = queue_->size();
+    if (depth > max_queue_depth_.load(std::memory_order_relaxed)) {
+        max_queue_depth_.store(depth, std::memory_order_relaxed);
+    }
+    if (critical) {
+        critical_pending_.store(true, std::memory_order_release);
+        wake_cv_.notify_one();
+    }
+    return true;
+}
+
+void SystemLogger::writer_loop() {
+    auto last_flush = std::chrono::steady_clock::now();
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait_for(lock, kAsyncFlushInterval, [this] {
+                return !writer_running_.load() || critical_pending_.load(std::memory_order_acquire);
+            });
+        }
+        bool stopping = !writer_running_.load();
+        bool critical = critical_pending_.exchange(false, std::memory_order_acq_rel);
+
+        size_t n = drain();
+
+        // Batch flushes: immediately for Critical, otherwise at most once
+        // per second of wall time or kFlushEvery records.
+        auto now = std::chrono::steady_clock::now();
+        if (critical || stopping || n >= kFlushEvery ||
+            (n > 0 && now - last_flush >= std::chrono::seconds(1))) {
+            log_file.flush();
+            telemetry_file.flush();
+            control_file.flush();
+            last_flush = now;
+        }
+        if (stopping) {
+            drain();
+            return;
+        }
+    }
+}
+
+size_t SystemLogger::drain() {
+    size_t n = 0;
+    LogRecord rec;
+    while (queue_->try_pop(rec)) {
+        write_record(rec);
+        ++n;
+    }
+    return n;
+}
+
+void SystemLogger::write_record(const LogRecord& rec) {
+    switch (rec.kind) {
+        case RecordKind::Telemetry:
+            write_telemetry(rec.telemetry);
+            break;
+        case RecordKind::Control: {
+            ControlOutput out;
+            out.infusion_ml_per_min = rec.control.infusion_ml_per_min;
+            out.confidence = rec.control.confidence;
+            out.safety_override = rec.control.safety_override;
+            out.warning_flags = rec.control.warnings;
+            out.rationale = rec.control.rationale;
+            write_control(out, rec.control.state, rec.control.t);
+            break;
+        }
+        case RecordKind::Event:
+            write_event(rec.text.message, rec.text.t);
+            break;
+        case RecordKind::Alert: {
+            AlertEvent event{
+                rec.text.timestamp_ms,
+                rec.text.severity,
+                rec.text.source,
+                rec.text.code,
+                rec.text.message,
+                std::nullopt
+            };
+            if (rec.text.has_context) {
+                // Prefixing a quote forces the string branch in log_alert_event.
+                event.context_json = rec.text.context_truncated
+                    ? std::string("\"") + rec.text.context
+                    : std::string(rec.text.context);
+            }
+            log_alert_event(event);
+            break;
+        }
+    }
+
+    double latency_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - rec.enqueued_at).count();
+    // Only the writer thread updates the latency accumulators.
+    latency_sum_ms_.store(latency_sum_ms_.load(std::memory_order_relaxed) + latency_ms,
+                          std::memory_order_relaxed);
+    if (latency_ms > latency_max_ms_.load(std::memory_order_relaxed)) {
+        latency_max_ms_.store(latency_ms, std::memory_order_relaxed);
+    }
+    written_.fetch_add(1, std::memory_order_relaxed);
 }
 
 } // namespace ivsys
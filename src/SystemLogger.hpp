@@ -1,14 +1,69 @@
 #pragma once
 
 #include "iv_system_types.hpp"
+#include "SpscQueue.hpp"
+#include "session_format.hpp"
+#include "ControlLoopMetrics.hpp"
 #include <string>
 #include <fstream>
 #include <optional>
 #include <chrono>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 namespace ivsys {
 
+enum class LoggerMode {
+    Sync,   // format and write on the calling thread (default)
+    Async   // enqueue fixed-size records; a writer thread formats and writes
+};
+
+// Which per-session telemetry/control files are written.  The system log
+// is always text.  Binary sessions are ai_iv_<id>_session.aivs (see
+// session_format.hpp); tools/session_to_csv converts them back to the CSV
+// layout below.
+enum class SessionFormat {
+    Csv,
+    Binary,
+    Both
+};
+
+// Counters for the async backend.  All zero in Sync mode.
+struct LoggerStats {
+    std::uint64_t enqueued = 0;
+    std::uint64_t written = 0;
+    std::uint64_t dropped = 0;          // non-critical records refused on a full queue
+    std::uint64_t truncated = 0;        // text fields cut to fit a record
+    size_t queue_depth = 0;
+    size_t max_queue_depth = 0;
+    size_t queue_capacity = 0;
+    double mean_write_latency_ms = 0.0; // enqueue -> formatted and handed to the stream
+    double max_write_latency_ms = 0.0;
+};
+
 class SystemLogger {
+public:
+    // Async-mode Critical alerts are flushed to the OS within this bound of
+    // being logged; it is also the writer's idle wake-up period.
+    static constexpr std::chrono::milliseconds kAsyncFlushInterval{50};
+    static constexpr size_t kDefaultQueueCapacity = 1024;
+    // Slots held back for Critical alerts when the queue is nearly full.
+    static constexpr size_t kCriticalReserve = 16;
+
+    static const char* const kTelemetryCsvHeader;
+    static const char* const kControlCsvHeader;
+
+    // One CSV data row (with trailing newline).  Shared with the binary
+    // session converter so both paths produce byte-identical files.
+    static void write_telemetry_row(std::ostream& os, const Telemetry& m);
+    static void write_control_row(std::ostream& os, const ControlOutput& out,
+                                  const PatientState& state,
+                                  std::chrono::steady_clock::time_point t);
+
 private:
     std::ofstream log_file;
     std::ofstream telemetry_file;
@@ -18,23 +73,118 @@ private:
     size_t control_flush_counter = 0;
     static constexpr size_t kFlushEvery = 25;
 
-    static std::string severity_to_string(AlertSeverity severity);
-    static std::string escape_json_string(const std::string& input);
+    static const char* severity_to_string(AlertSeverity severity);
+    static void write_json_escaped(std::ostream& os, const char* text);
     void log_alert_event(const AlertEvent& event);
+    // context: JSON object/array written as-is, anything else as a string
+    void write_alert(long long timestamp_ms, AlertSeverity severity, const char* source,
+                     const char* code, const char* message, const char* context);
+
+    void write_telemetry(const Telemetry& m);
+    void write_control(const ControlOutput& out, const PatientState& state,
+                       std::chrono::steady_clock::time_point t);
+    void write_event(const std::string& event, std::chrono::steady_clock::time_point t);
+
+    // ---- Async backend ----
+    enum class RecordKind : std::uint8_t { Telemetry, Control, Event, Alert };
+
+    struct ControlFields {
+        double infusion_ml_per_min;
+        double confidence;
+        bool safety_override;
+        PatientState state;
+        std::chrono::steady_clock::time_point t;
+        WarningFlags warnings;
+        Rationale rationale;
+    };
+
+    struct TextFields {
+        std::chrono::steady_clock::time_point t;
+        long long timestamp_ms;
+        AlertSeverity severity;
+        bool has_context;
+        bool context_truncated;
+        char source[32];
+        char code[48];
+        char message[192];
+        char context[224];
+    };
+
+    struct LogRecord {
+        RecordKind kind;
+        std::chrono::steady_clock::time_point enqueued_at;
+        union {
+            Telemetry telemetry;
+            ControlFields control;
+            TextFields text;
+        };
+        LogRecord() : kind(RecordKind::Event), enqueued_at(), text() {}
+    };
+
+    bool copy_text(char* dst, size_t cap, const std::string& src);
+    bool copy_text(char* dst, size_t cap, const char* src);
+    bool enqueue(const LogRecord& rec, bool critical);
+    void writer_loop();
+    size_t drain();
+    void write_record(const LogRecord& rec);
+
+    LoggerMode mode_;
+    SessionFormat format_;
+    std::unique_ptr<session_format::SessionWriter> session_writer_;
+    std::unique_ptr<SpscQueue<LogRecord>> queue_;
+    std::thread writer_;
+    std::atomic<bool> writer_running_{false};
+    std::atomic<bool> critical_pending_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+
+    std::atomic<std::uint64_t> enqueued_{0};
+    std::atomic<std::uint64_t> written_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<std::uint64_t> truncated_{0};
+    std::atomic<size_t> max_queue_depth_{0};
+    std::atomic<double> latency_sum_ms_{0.0};
+    std::atomic<double> latency_max_ms_{0.0};
 
 public:
-    SystemLogger(const std::string& session_id);
+    SystemLogger(const std::string& session_id, LoggerMode mode = LoggerMode::Sync,
+                 size_t queue_capacity = kDefaultQueueCapacity,
+                 SessionFormat format = SessionFormat::Csv);
     ~SystemLogger();
 
+    SystemLogger(const SystemLogger&) = delete;
+    SystemLogger& operator=(const SystemLogger&) = delete;
+
+    // The log_* calls are not thread-safe: at most one thread may log at a
+    // time (in Async mode it is the single producer of the record queue).
+    // Hand over between threads only with a join or similar barrier.
     void log_telemetry(const Telemetry& m);
     void log_control(const ControlOutput& out, const PatientState& state,
                      std::chrono::steady_clock::time_point t);
     void log_event(const std::string& event);
+    // Loop timing summary as two events, each short enough for an async
+    // record, e.g. for the interval since the previous summary:
+    //   LOOP_METRICS ticks=300 overruns=0 skipped=0 exec_us=p50:41,p99:97,max:130 jitter_us=p99:88,max:95
+    //   LOOP_STAGES p99_us acquire=1 vault=2 estimate=9 ... display=3
+    void log_loop_metrics(const ControlLoopMetrics::Snapshot& s);
     void log_alert(AlertSeverity severity,
                    const std::string& source,
                    const std::string& code,
                    const std::string& message,
                    const std::optional<std::string>& context_json = std::nullopt);
+    // Same line with a numeric context {"key":value,...} (values formatted
+    // like std::to_string).  Takes no allocation on the calling thread, for
+    // alerts raised from the control tick.
+    struct AlertValue {
+        const char* key;
+        double value;
+    };
+    void log_alert(AlertSeverity severity, const char* source, const char* code,
+                   const char* message, const AlertValue* values, size_t count);
+
+    LoggerMode mode() const { return mode_; }
+    SessionFormat format() const { return format_; }
+    LoggerStats stats() const;
 };
 
 } // namespace ivsys
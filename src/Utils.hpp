@@ -7,6 +7,10 @@
 #include <chrono>
 #include <algorithm>
 
+#ifdef ENABLE_FAST_MATH
+#include "FastMath.hpp"
+#endif
+
 namespace ivsys {
 
 class Utils {
@@ -15,18 +19,35 @@ public:
         return std::max(lo, std::min(v, hi));
     }
 
+    // libm unless built with -DENABLE_FAST_MATH (bulk analytics builds),
+    // which swaps in fastmath::exp and its error bound (FastMath.hpp).
+    static constexpr bool kFastMath =
+#ifdef ENABLE_FAST_MATH
+        true;
+#else
+        false;
+#endif
+
+    static double exp(double x) {
+#ifdef ENABLE_FAST_MATH
+        return fastmath::exp(x);
+#else
+        return std::exp(x);
+#endif
+    }
+
     static double sigmoid(double x, double center = 0.0, double steepness = 1.0) {
-        return 1.0 / (1.0 + std::exp(-steepness * (x - center)));
+        return 1.0 / (1.0 + exp(-steepness * (x - center)));
     }
 
     static double exponential_decay(double x, double rate = 1.0) {
-        return std::exp(-rate * x);
+        return exp(-rate * x);
     }
 
     static double gaussian(double x, double center, double sigma) {
         if (sigma <= 0.0) return 0.0;  // Prevent division by zero
         double z = (x - center) / sigma;
-        return std::exp(-0.5 * z * z);
+        return exp(-0.5 * z * z);
     }
 
     static std::string timestamp_str(std::chrono::steady_clock::time_point t) {
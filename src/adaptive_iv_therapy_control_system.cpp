@@ -17,6 +17,9 @@
 #include <atomic>
 #include <memory>
 #include <map>
+#include <cstdlib>
+#include <cstdint>
+#include <iterator>
 
 #include "iv_system_types.hpp"
 #include "config_defaults.hpp"
@@ -24,9 +27,15 @@
 #include "SystemLogger.hpp"
 #include "SafetyMonitor.hpp"
 #include "StateEstimator.hpp"
+#include "EnergyProxyModel.hpp"
 #include "AdaptiveController.hpp"
-#include "domains/metabojoint_domain.hpp"
-#include "precision_spine/PrecisionSpine.hpp"
+#include "control_cycle.hpp"
+#include "multi_patient_engine.hpp"
+#include "status_display.hpp"
+#include "realtime_scheduling.hpp"
+#include "uncertainty_engine.hpp"
+#include "simulation_engine.hpp"
+#include "shm_telemetry_ring.hpp"
 
 // REST API Server (optional - enable with -DENABLE_REST_API flag)
 #ifdef ENABLE_REST_API
@@ -41,32 +50,97 @@ using namespace ivsys;
 // MAIN CONTROL LOOP
 // ============================================================================
 
+// Simulated sensor waveform shared by the single-patient loop and ward mode
+// (SimulationEngine's baseline, stamped with the wall clock).
+// SIMULATION: used when no external feed is given (--telemetry-shm)
+static Telemetry simulate_telemetry(const SimulationEngine& sim, double sim_time) {
+    Telemetry m = sim.generate_telemetry(sim_time);
+    m.timestamp = std::chrono::steady_clock::now();
+    return m;
+}
+
 class AIIVSystem {
 private:
     PatientProfile profile;
-    StateEstimator estimator;
-    AdaptiveController controller;
-    SafetyMonitor safety;
-    SystemLogger logger;
+    PatientControlCycle cycle;
     
     std::atomic<bool> running;
-    double current_infusion_rate;
     const std::chrono::milliseconds control_period{200};  // 5 Hz
+    SimulationEngine sim;
+    double sim_time = 0.0;
+
+    // Per-stage timing; a LOOP_METRICS summary is logged every
+    // loop_summary_ticks ticks (one minute at 5 Hz).
+    ControlLoopMetrics loop_metrics{control_period};
+    static constexpr std::uint64_t loop_summary_ticks = 300;
+
+    // Console status panel, drawn by its own low-priority thread so
+    // terminal speed never reaches the control tick.
+    StatusDisplay display;
 
-    ai_iv::domains::metabojoint::MetaboJointVault vault;
-    bool steric_cage_was_breached = false;
+    // Opt-in real-time mode for the control thread (--rt-* flags).
+    RealtimeOptions realtime;
+
+    // Opt-in Monte Carlo rate interval per tick (--mc-* flags); its pool
+    // threads start here, before real-time setup, so they stay unpinned.
+    std::unique_ptr<UncertaintyEngine> uncertainty;
+    RateInterval last_interval;
+
+    // Opt-in external sensor feed (--telemetry-shm); the simulated
+    // waveform is used when absent.  A stale feed holds the last sample
+    // at zero signal quality.
+    std::unique_ptr<ShmTelemetryReader> telemetry_source;
+    std::optional<Telemetry> last_source_sample;
+    std::uint64_t degraded_ticks = 0;
     
 #ifdef ENABLE_REST_API
+    TimeSeriesStore trends;    // /api/telemetry/range; outlives rest_api
     std::unique_ptr<RestApiServer> rest_api;
 #endif
     
 public:
-    AIIVSystem(const PatientProfile& prof, const std::string& session_id)
-        : profile(prof), controller(prof), safety(prof), logger(session_id), 
-          running(false), current_infusion_rate(0.4) {
+    AIIVSystem(const PatientProfile& prof, const std::string& session_id,
+               LoggerMode log_mode = LoggerMode::Sync,
+               SessionFormat session_format = SessionFormat::Csv,
+               const StatusDisplay::Options& display_options = StatusDisplay::Options{},
+               const RealtimeOptions& realtime_options = RealtimeOptions{},
+               const std::optional<UncertaintyEngine::Options>& uncertainty_options = std::nullopt,
+               std::unique_ptr<ShmTelemetryReader> telemetry_reader = nullptr,
+               PatientClass patient_class = PatientClass::Standard)
+        : profile(prof), cycle(prof, session_id, log_mode, session_format, nullptr, patient_class),
+          running(false), sim(prof),
+          display(display_options), realtime(realtime_options),
+          telemetry_source(std::move(telemetry_reader)) {
+        cycle.set_loop_metrics(&loop_metrics);
+        SystemLogger& logger = cycle.logger();
+        if (uncertainty_options) {
+            uncertainty = std::make_unique<UncertaintyEngine>(*uncertainty_options);
+            cycle.set_uncertainty_engine(uncertainty.get());
+            logger.log_event("Monte Carlo uncertainty: " + std::to_string(uncertainty->sample_count()) +
+                             " samples on " + std::to_string(uncertainty->thread_count()) +
+                             " thread(s), budget_us=" +
+                             std::to_string(uncertainty_options->budget.count()));
+        }
+        if (telemetry_source) {
+            logger.log_event("Telemetry source: shared-memory ring, producer_pid=" +
+                             std::to_string(telemetry_source->producer_pid()) + " capacity=" +
+                             std::to_string(telemetry_source->capacity()) + " max_age_ms=" +
+                             std::to_string(telemetry_source->options().max_age.count()));
+        }
         logger.log_event("System initialized - Enhanced Energy Transfer Model v1.0");
         logger.log_event("Patient: " + std::to_string(prof.weight_kg) + "kg, " + 
                         std::to_string(prof.age_years) + "y");
+        logger.log_event(std::string("Patient class: ") + patient_class_name(patient_class));
+        const EnergyProxyLoadReport& model = default_energy_proxy_report();
+        if (model.source == "builtin") {
+            logger.log_event("Energy proxy: " + model.model + " (builtin)");
+        } else {
+            logger.log_event("Energy proxy: " + model.model + " from " + model.source + " " + model.path +
+                             " in " + std::to_string(static_cast<long>(model.load_us)) + " us");
+        }
+        if (!model.fallback_reason.empty()) {
+            logger.log_event("Energy proxy fallback: " + model.fallback_reason);
+        }
         logger.log_event("Optimal flow velocity: " + 
                         std::to_string(prof.energy_params.v_optimal_cm_s) + " cm/s");
         
@@ -80,243 +154,205 @@ public:
         config["patient_age_years"] = std::to_string(prof.age_years);
         config["max_infusion_rate"] = std::to_string(prof.max_safe_infusion_rate);
         config["baseline_hr_bpm"] = std::to_string(prof.baseline_hr_bpm);
+        config["patient_class"] = patient_class_name(patient_class);
         config["session_id"] = session_id;
         rest_api->update_config(config);
+        rest_api->set_loop_metrics(&loop_metrics);
+        rest_api->set_timeseries(&trends);
         
         logger.log_event("REST API initialized on port 8080");
 #endif
     }
     
     void start() {
+        SystemLogger& logger = cycle.logger();
         running = true;
         logger.log_event("Control loop started");
+        display.start();
         
 #ifdef ENABLE_REST_API
         if (rest_api && rest_api->start()) {
             logger.log_event("REST API server started on port 8080");
         }
 #endif
+
+        // After the helper threads exist, so they keep default scheduling
+        RealtimeResult rt = apply_realtime(realtime);
+        loop_metrics.set_scheduling(rt.scheduling);
+        if (realtime.enabled) {
+            logger.log_event("Real-time mode: cpu=" + std::to_string(rt.scheduling.cpu) +
+                             " fifo_priority=" + std::to_string(rt.scheduling.fifo_priority) +
+                             " memory_locked=" + std::to_string(rt.scheduling.memory_locked) +
+                             " spin_us=" + std::to_string(rt.scheduling.spin_ns / 1000));
+        }
+        for (const std::string& failure : rt.failures) {
+            logger.log_alert(AlertSeverity::Warn, "AIIVSystem", "REALTIME_SETUP_DEGRADED",
+                             "Real-time setup step failed: " + failure);
+        }
+        const std::chrono::nanoseconds spin(rt.scheduling.spin_ns);
         
-        auto next_tick = std::chrono::steady_clock::now();
+        using Clock = std::chrono::steady_clock;
+        auto next_tick = Clock::now();
+        auto last_tick = next_tick;
+        bool has_run = false;
+        ControlLoopMetrics::Snapshot last_summary = loop_metrics.snapshot();
+        std::uint64_t ticks_since_summary = 0;
         
         while (running) {
-            // 1. Acquire telemetry
-            Telemetry measurement = acquire_telemetry();
-            
-            // MetaboJointDomain integration
-            double dt_seconds = control_period.count() / 1000.0;
-            // Drive vault state estimation from current telemetry before elution tick.
-            // Lower pH and higher fatigue/lactate imply a more proteolytic niche.
-            double ambient_ph = std::clamp(7.4 - (measurement.lactate_mmol - 1.0) * 0.18, 6.2, 7.6);
-            double cathepsin_k_activity = std::clamp(
-                0.15 + (measurement.fatigue_idx * 0.6) + (measurement.blood_loss_idx * 0.4), 0.0, 1.0);
-            vault.update_telemetry(ambient_ph, cathepsin_k_activity);
-            vault.tick_elution(dt_seconds);
-
-            measurement.vault_mesh_size_nm = vault.get_mesh_size();
-            measurement.vault_payload_pct = vault.get_payload_remaining();
-            measurement.vault_cage_breached = vault.is_steric_cage_breached();
-
-            if (!steric_cage_was_breached && vault.is_steric_cage_breached()) {
-                logger.log_alert(
-                    AlertSeverity::Info,
-                    "MetaboJointDomain",
-                    "PAYLOAD_ELUTION_STARTED",
-                    "Steric cage breached, CRISPR payload elution initiated.",
-                    std::string("{\"mesh_size_nm\":") + std::to_string(vault.get_mesh_size()) + "}");
-                steric_cage_was_breached = true;
-            }
-
-            // 2. State estimation with energy transfer model
-            PatientState state = estimator.estimate(measurement, profile, current_infusion_rate);
-            
-            double cycle_duration_min = control_period.count() / 60000.0;
+            auto scheduled = next_tick;
+            auto tick_start = Clock::now();
+            StageClock stages(&loop_metrics, tick_start);
 
-            // 3. Precision Spine Routing
-            // Enforce deterministic validation and fallback floor before adaptive control
-            precision_spine::TreatmentFlow routed_flow = precision_spine::dose_route(state);
-            precision_spine::TreatmentFlow safe_flow = precision_spine::reject_noise(routed_flow);
-            PatientState validated_state = precision_spine::fallback_floor(safe_flow);
-            
-            // 4. Control decision with predictive capability on validated state
-            ControlOutput command = controller.decide(validated_state, safety, estimator, cycle_duration_min);
+            // Therapy time covered by this tick, including any skipped periods
+            double dt_seconds = std::chrono::duration<double>(
+                has_run ? scheduled - last_tick : control_period).count();
 
-            // 5. Update current rate for next cycle
-            current_infusion_rate = command.infusion_ml_per_min;
-            
-            // 6. Logging
-            logger.log_telemetry(measurement);
-            logger.log_control(command, validated_state, measurement.timestamp);
+            // 1. Acquire telemetry; an external feed that has not delivered
+            //    its first sample yet leaves nothing to act on
+            std::optional<Telemetry> acquired = acquire_telemetry(dt_seconds);
+            stages.lap(LoopStage::Acquire);
+            if (acquired) {
+                const Telemetry& measurement = *acquired;
 
-#ifdef ENABLE_REST_API
-            // Update REST API with current data
-            if (rest_api) {
-                rest_api->update_telemetry(measurement);
-                rest_api->update_patient_state(state);
-                rest_api->update_control_output(command.infusion_ml_per_min, command.rationale);
-            }
-#endif
+                // 2-6. Vault update, state estimation, precision spine routing,
+                //      control decision, logging and safety accounting (timed
+                //      per stage inside the cycle)
+                CycleResult result = cycle.step(measurement, dt_seconds);
+                stages = StageClock(&loop_metrics);
+                if (result.rate_interval.samples > 0) last_interval = result.rate_interval;
 
-            if (measurement.signal_quality < 0.6) {
-                logger.log_alert(
-                    AlertSeverity::Warn,
-                    "Telemetry",
-                    "SENSOR_QUALITY_LOW",
-                    "Telemetry signal quality below threshold",
-                    std::string("{\"signal_quality\":") +
-                        std::to_string(measurement.signal_quality) +
-                        ",\"threshold\":0.6}");
 #ifdef ENABLE_REST_API
+                // Update REST API with current data
                 if (rest_api) {
-                    rest_api->add_alert("warning", "Telemetry signal quality below threshold");
+                    rest_api->update_telemetry(result.measurement);
+                    rest_api->update_patient_state(result.state);
+                    rest_api->update_control_output(result.command);
+                    std::int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count();
+                    trends.append(now_ms, result.measurement, result.command.infusion_ml_per_min);
+                    ForwardPrediction predictions[std::size(config::PUBLISHED_PREDICTION_HORIZON_STEPS)];
+                    size_t predicted = cycle.estimator().predict_horizons(
+                        config::PUBLISHED_PREDICTION_HORIZON_STEPS,
+                        std::size(config::PUBLISHED_PREDICTION_HORIZON_STEPS), predictions);
+                    rest_api->update_prediction(predictions, predicted);
+                    if (result.sensor_quality_low) {
+                        rest_api->add_alert("warning", "Telemetry signal quality below threshold");
+                    }
                 }
+                stages.lap(LoopStage::Publish);
 #endif
-            }
 
-            if (!command.warning_flags.empty()) {
-                if (has_warning_flag(command.warning_flags, "VOLUME_LIMIT_APPROACH")) {
-                    logger.log_alert(
-                        AlertSeverity::Warn,
-                        "SafetyMonitor",
-                        "VOLUME_LIMIT_APPROACH",
-                        "Projected volume approaching 24h limit",
-                        std::string("{\"cumulative_volume_ml\":") +
-                            std::to_string(safety.get_cumulative_volume()) + "}");
-                }
-                if (has_warning_flag(command.warning_flags, "LOW_CARDIAC_RESERVE")) {
-                    logger.log_alert(
-                        AlertSeverity::Warn,
-                        "SafetyMonitor",
-                        "LOW_CARDIAC_RESERVE",
-                        "Cardiac reserve below minimum threshold",
-                        std::string("{\"cardiac_reserve\":") +
-                            std::to_string(state.cardiac_reserve) + "}");
-                }
-                if (has_warning_flag(command.warning_flags, "RATE_CHANGE_LIMITED")) {
-                    logger.log_alert(
-                        AlertSeverity::Info,
-                        "SafetyMonitor",
-                        "RATE_CHANGE_LIMITED",
-                        "Infusion rate change limited by safety constraints",
-                        std::string("{\"infusion_rate_ml_min\":") +
-                            std::to_string(command.infusion_ml_per_min) + "}");
-                }
-                if (has_warning_flag(command.warning_flags, "HIGH_RISK_STATE")) {
-                    logger.log_alert(
-                        AlertSeverity::Warn,
-                        "SafetyMonitor",
-                        "HIGH_RISK_STATE",
-                        "Risk score exceeded threshold",
-                        std::string("{\"risk_score\":") +
-                            std::to_string(state.risk_score) + "}");
-                }
-                if (has_warning_flag(command.warning_flags, "TACHYCARDIA_DETECTED")) {
-                    logger.log_alert(
-                        AlertSeverity::Warn,
-                        "SafetyMonitor",
-                        "TACHYCARDIA_DETECTED",
-                        "Tachycardia detected",
-                        std::string("{\"heart_rate_bpm\":") +
-                            std::to_string(state.heart_rate_bpm) + "}");
-                }
-                if (has_warning_flag(command.warning_flags, "EMERGENCY_MIN_RATE")) {
-                    logger.log_alert(
-                        AlertSeverity::Critical,
-                        "SafetyMonitor",
-                        "EMERGENCY_MIN_RATE",
-                        "Emergency minimum infusion rate enforced",
-                        std::string("{\"hydration_pct\":") +
-                            std::to_string(state.hydration_pct) + "}");
-                }
+                // 7. Publish the status panel (rendered by the display thread)
+                display.publish(result.validated_state, result.command,
+                                cycle.safety().get_cumulative_volume());
+                stages.lap(LoopStage::Display);
+
+                // 8. Send command to infusion pump (placeholder)
+                // send_to_pump(result.command.infusion_ml_per_min);
             }
             
-            // 7. Display status
-            display_status(validated_state, command);
-            
-            // 8. Update safety monitor
-            safety.update_volume(command.infusion_ml_per_min, cycle_duration_min);
-            
-            // 9. Send command to infusion pump (placeholder)
-            // send_to_pump(command.infusion_ml_per_min);
-            
-            // 10. Timing
-            next_tick += control_period;
-            std::this_thread::sleep_until(next_tick);
+            // 9. Timing: an overrunning tick skips the periods it ran into
+            //    instead of firing a burst of late ticks
+            auto finish = Clock::now();
+            next_tick = scheduled + control_period;
+            std::uint64_t skipped = 0;
+            while (next_tick <= finish) {
+                next_tick += control_period;
+                ++skipped;
+            }
+            loop_metrics.record_tick(finish - tick_start, tick_start - scheduled,
+                                     finish > scheduled + control_period, skipped);
+            last_tick = scheduled;
+            has_run = true;
+
+            // 10. Periodic timing summary
+            if (++ticks_since_summary >= loop_summary_ticks) {
+                ControlLoopMetrics::Snapshot now = loop_metrics.snapshot();
+                logger.log_loop_metrics(now.since(last_summary));
+                if (uncertainty) log_rate_interval();
+                if (telemetry_source) log_telemetry_source();
+                last_summary = now;
+                ticks_since_summary = 0;
+            }
+
+            hybrid_sleep_until(next_tick, spin);
         }
         
-        logger.log_event("Control loop stopped");
-    }
-    
-    void stop() {
-        running = false;
-        
+        display.stop();
+        logger.log_loop_metrics(loop_metrics.snapshot().since(last_summary));
+        if (telemetry_source) log_telemetry_source();
 #ifdef ENABLE_REST_API
+        // Shut down here rather than in stop(): the logger takes one
+        // producer at a time, and this thread is it.
         if (rest_api) {
             rest_api->stop();
             logger.log_event("REST API server stopped");
         }
 #endif
+        logger.log_event("Control loop stopped");
+    }
+    
+    // Safe from any thread; start() returns within one tick.
+    void stop() {
+        running = false;
     }
     
 private:
-    static bool has_warning_flag(const std::string& flags, const std::string& token) {
-        return flags.find(token) != std::string::npos;
+    void log_rate_interval() {
+        const RateInterval& r = last_interval;
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(3)
+             << "MC_UNCERTAINTY samples=" << r.samples << " rate=" << r.nominal
+             << " interval=[" << r.lower << "," << r.upper << "] coverage=" << r.coverage
+             << " sd=" << r.sd << " fallback=" << r.fallback_fraction
+             << " safety_limited=" << r.safety_limited_fraction
+             << " elapsed_ms=" << std::chrono::duration<double, std::milli>(r.elapsed).count()
+             << " ns_per_sample=" << uncertainty->ns_per_sample()
+             << " next_samples=" << uncertainty->sample_count();
+        cycle.logger().log_event(line.str());
     }
 
-    Telemetry acquire_telemetry() {
-        // SIMULATION: Replace with actual sensor interface
-        static double sim_time = 0.0;
-        sim_time += control_period.count() / 1000.0;
-        
-        Telemetry m;
-        m.timestamp = std::chrono::steady_clock::now();
-        
-        // Simulate gradual dehydration and recovery pattern
-        m.hydration_pct = 65.0 + 15.0 * std::sin(sim_time * 0.05);
-        m.heart_rate_bpm = profile.baseline_hr_bpm + 20.0 * std::sin(sim_time * 0.1);
-        m.temp_celsius = 37.0 + 0.5 * std::sin(sim_time * 0.03);
-        m.blood_loss_idx = 0.0;
-        m.fatigue_idx = 0.3 + 0.2 * std::sin(sim_time * 0.02);
-        m.anxiety_idx = 0.2;
-        m.signal_quality = 0.85 + 0.1 * std::sin(sim_time * 0.5);
-        m.spo2_pct = 97.0 + 2.0 * std::sin(sim_time * 0.08);
-        m.lactate_mmol = 2.0 + 1.0 * std::sin(sim_time * 0.04);
-        
-        // NEW: Simulated cardiac output (L/min)
-        m.cardiac_output_L_min = 5.0 + 1.0 * std::sin(sim_time * 0.06);
-        
-        return m;
+    void log_telemetry_source() {
+        const ShmTelemetryReader::Stats& s = telemetry_source->stats();
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(1)
+             << "TELEMETRY_SHM reads=" << s.reads << " fresh=" << s.fresh << " repeats=" << s.repeats
+             << " stale=" << s.stale << " empty=" << s.empty << " torn=" << s.torn
+             << " retries=" << s.retries << " skipped=" << s.skipped
+             << " sequence=" << s.last_sequence << " age_ms=" << s.last_age_ms
+             << " degraded_ticks=" << degraded_ticks;
+        cycle.logger().log_event(line.str());
     }
-    
-    void display_status(const PatientState& state, const ControlOutput& cmd) {
-        static int display_counter = 0;
-        if (++display_counter % 10 == 0) {  // Update display every 2 seconds
-            std::cout << "\n=== AI-IV Enhanced Energy Transfer System ===\n";
-            std::cout << "Hydration: " << std::fixed << std::setprecision(1) 
-                     << state.hydration_pct << "%  ";
-            std::cout << "Energy_T: " << std::setprecision(3) << state.energy_T << "  ";
-            std::cout << "HR: " << std::setprecision(0) << state.heart_rate_bpm << " bpm\n";
-            
-            std::cout << "Energy Transfer: " << std::setprecision(2) 
-                     << state.energy_T_absolute << " W/kg  ";
-            std::cout << "Flow: " << state.estimated_flow_velocity_cm_s << " cm/s  ";
-            std::cout << "G(v): " << std::setprecision(3) << state.flow_efficiency << "\n";
-            
-            std::cout << "Risk: " << std::setprecision(2) << state.risk_score << "  ";
-            std::cout << "Cardiac Reserve: " << state.cardiac_reserve << "  ";
-            std::cout << "Coherence: " << state.coherence_sigma << "\n";
-            
-            std::cout << "Infusion Rate: " << std::setprecision(2) 
-                     << cmd.infusion_ml_per_min << " ml/min  ";
-            std::cout << "Confidence: " << cmd.confidence << "\n";
-            
-            if (!cmd.warning_flags.empty()) {
-                std::cout << "⚠️  WARNINGS: " << cmd.warning_flags << "\n";
+
+    std::optional<Telemetry> acquire_telemetry(double dt_seconds) {
+        if (!telemetry_source) {
+            sim_time += dt_seconds;
+            return simulate_telemetry(sim, sim_time);
+        }
+
+        Telemetry m;
+        ShmReadStatus status = telemetry_source->read_latest(m);
+        if (status == ShmReadStatus::Fresh || status == ShmReadStatus::Repeat) {
+            if (degraded_ticks > 0) {
+                cycle.logger().log_event("Shared-memory telemetry recovered after " +
+                                         std::to_string(degraded_ticks) + " degraded tick(s)");
+                degraded_ticks = 0;
             }
-            std::cout << "24h Volume: " << std::setprecision(0) 
-                     << safety.get_cumulative_volume() << " ml\n";
-            std::cout << std::flush;
+            last_source_sample = m;
+            return m;
         }
+
+        if (status == ShmReadStatus::Stale) last_source_sample = m;
+        if (degraded_ticks++ == 0) {
+            cycle.logger().log_alert(AlertSeverity::Warn, "AIIVSystem", "TELEMETRY_STALE",
+                std::string("Shared-memory telemetry ") + shm_read_status_name(status) +
+                "; holding the last sample at zero signal quality");
+        }
+        if (!last_source_sample) return std::nullopt;
+        Telemetry held = *last_source_sample;
+        held.timestamp = std::chrono::steady_clock::now();
+        held.signal_quality = 0.0;
+        return held;
     }
 };
 
@@ -325,7 +361,55 @@ private:
 // ============================================================================
 
 #ifndef AI_IV_ALERT_LOG_TEST
-int main() {
+// Ward mode: run many simulated beds on a shared worker pool and report
+// per-bed tick jitter and deadline misses.
+static int run_ward(const PatientProfile& patient, const std::string& session_id,
+                    size_t bed_count, size_t worker_count, int duration_s,
+                    LoggerMode log_mode, SessionFormat session_format,
+                    std::optional<PatientClass> patient_class) {
+    MultiPatientEngine::Options options;
+    options.worker_threads = worker_count;
+    options.log_mode = log_mode;
+    options.session_format = session_format;
+    MultiPatientEngine engine(options);
+
+    for (size_t i = 0; i < bed_count; ++i) {
+        PatientProfile bed = patient;
+        // Spread baselines a little so beds do not move in lockstep.
+        bed.baseline_hr_bpm += static_cast<double>(i % 11) - 5.0;
+        engine.add_patient(bed, session_id + "_bed" + std::to_string(i),
+            [sim = SimulationEngine(bed)](double t) { return simulate_telemetry(sim, t); },
+            patient_class.value_or(select_patient_class(bed)));
+    }
+
+    std::cout << "Ward mode: " << bed_count << " beds on " << worker_count
+              << " worker thread(s) for " << duration_s << " s...\n";
+    engine.start();
+    std::this_thread::sleep_for(std::chrono::seconds(duration_s));
+    engine.stop();
+
+    std::uint64_t ticks = 0, misses = 0, skipped = 0;
+    double worst_jitter = 0.0, worst_exec = 0.0, mean_exec = 0.0;
+    for (const auto& s : engine.all_stats()) {
+        ticks += s.ticks;
+        misses += s.deadline_misses;
+        skipped += s.skipped_periods;
+        worst_jitter = std::max(worst_jitter, s.max_jitter_ms);
+        worst_exec = std::max(worst_exec, s.max_exec_ms);
+        mean_exec += s.mean_exec_ms / static_cast<double>(bed_count);
+    }
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "  Ticks:            " << ticks << "\n"
+              << "  Deadline misses:  " << misses << "\n"
+              << "  Skipped periods:  " << skipped << "\n"
+              << "  Max jitter:       " << worst_jitter << " ms\n"
+              << "  Mean cycle time:  " << mean_exec << " ms\n"
+              << "  Max cycle time:   " << worst_exec << " ms\n";
+    return misses == 0 ? 0 : 3;
+}
+
+int main(int argc, char** argv) {
     std::cout << "╔════════════════════════════════════════════════════════════╗\n";
     std::cout << "║  AI-IV Control System v4.2.0 - Enhanced Energy Transfer    ║\n";
     std::cout << "║  Full nonlinear dynamics from white paper section 4.1      ║\n";
@@ -375,10 +459,153 @@ int main() {
     std::cout << "  σ_velocity: " << patient.energy_params.sigma_velocity << " cm/s\n";
     std::cout << "  Tissue perfusion: " << patient.current_tissue_perfusion << "\n\n";
     
+    // Optional ward mode: --patients N [--workers W] [--duration S]
+    // Optional async logging: --log-mode sync|async
+    // Optional binary sessions: --session-format csv|binary|both
+    // Optional status panel: --display console|headless [--display-ms MS]
+    // Optional real-time mode, enabled by any of: --rt-cpu C --rt-priority P --rt-spin-us U
+    // Optional Monte Carlo rate interval, enabled by any of:
+    //   --mc-samples N --mc-budget-ms MS --mc-workers W
+    // Optional external sensor feed: --telemetry-shm NAME [--telemetry-max-age-ms MS]
+    // Optional control pipeline: --patient-class auto|standard|cardiac|renal|pediatric
+    //   (auto, the default, derives it from each profile)
+    size_t ward_beds = 0;
+    size_t ward_workers = std::max(1u, std::thread::hardware_concurrency());
+    int ward_duration_s = 60;
+    LoggerMode log_mode = LoggerMode::Sync;
+    SessionFormat session_format = SessionFormat::Csv;
+    StatusDisplay::Options display_options;
+    RealtimeOptions realtime_options;
+    std::optional<UncertaintyEngine::Options> uncertainty_options;
+    std::string telemetry_shm;
+    ShmTelemetryReader::Options telemetry_options;
+    std::optional<PatientClass> patient_class;
+    if ((argc - 1) % 2 != 0) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--patients N] [--workers W] [--duration S] [--log-mode sync|async]"
+                  << " [--session-format csv|binary|both] [--display console|headless]"
+                  << " [--display-ms MS] [--rt-cpu C] [--rt-priority P] [--rt-spin-us U]"
+                  << " [--mc-samples N] [--mc-budget-ms MS] [--mc-workers W]"
+                  << " [--telemetry-shm NAME] [--telemetry-max-age-ms MS]"
+                  << " [--patient-class auto|standard|cardiac|renal|pediatric]\n";
+        return 1;
+    }
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        std::string arg = argv[i + 1];
+        if (flag == "--log-mode") {
+            if (arg == "async") log_mode = LoggerMode::Async;
+            else if (arg == "sync") log_mode = LoggerMode::Sync;
+            else {
+                std::cerr << "Error: --log-mode expects sync or async\n";
+                return 1;
+            }
+            continue;
+        }
+        if (flag == "--session-format") {
+            if (arg == "csv") session_format = SessionFormat::Csv;
+            else if (arg == "binary") session_format = SessionFormat::Binary;
+            else if (arg == "both") session_format = SessionFormat::Both;
+            else {
+                std::cerr << "Error: --session-format expects csv, binary or both\n";
+                return 1;
+            }
+            continue;
+        }
+        if (flag == "--telemetry-shm") {
+            telemetry_shm = arg;
+            continue;
+        }
+        if (flag == "--patient-class") {
+            PatientClass parsed;
+            if (arg == "auto") patient_class.reset();
+            else if (parse_patient_class(arg, parsed)) patient_class = parsed;
+            else {
+                std::cerr << "Error: --patient-class expects auto, standard, cardiac, renal or pediatric\n";
+                return 1;
+            }
+            continue;
+        }
+        if (flag == "--display") {
+            if (arg == "console") display_options.mode = DisplayMode::Console;
+            else if (arg == "headless") display_options.mode = DisplayMode::Headless;
+            else {
+                std::cerr << "Error: --display expects console or headless\n";
+                return 1;
+            }
+            continue;
+        }
+        if (flag == "--rt-cpu" || flag == "--rt-priority" || flag == "--rt-spin-us") {
+            // Zero is meaningful here: core 0, SCHED_OTHER, no spinning
+            char* end = nullptr;
+            long value = std::strtol(arg.c_str(), &end, 10);
+            if (end == arg.c_str() || *end != '\0' || value < 0 ||
+                (flag == "--rt-priority" && value > 99)) {
+                std::cerr << "Error: " << flag << " expects a non-negative integer"
+                          << (flag == "--rt-priority" ? " up to 99" : "") << "\n";
+                return 1;
+            }
+            realtime_options.enabled = true;
+            if (flag == "--rt-cpu") {
+                realtime_options.cpu = static_cast<int>(value);
+            } else if (flag == "--rt-priority") {
+                realtime_options.fifo_priority = static_cast<int>(value);
+            } else {
+                realtime_options.spin_window = std::chrono::microseconds(value);
+            }
+            continue;
+        }
+        long value = std::strtol(arg.c_str(), nullptr, 10);
+        if (value <= 0) {
+            std::cerr << "Error: " << flag << " expects a positive integer\n";
+            return 1;
+        }
+        if (flag == "--patients") ward_beds = static_cast<size_t>(value);
+        else if (flag == "--workers") ward_workers = static_cast<size_t>(value);
+        else if (flag == "--duration") ward_duration_s = static_cast<int>(value);
+        else if (flag == "--display-ms") display_options.refresh_interval = std::chrono::milliseconds(value);
+        else if (flag == "--telemetry-max-age-ms") telemetry_options.max_age = std::chrono::milliseconds(value);
+        else if (flag == "--mc-samples" || flag == "--mc-budget-ms" || flag == "--mc-workers") {
+            if (!uncertainty_options) uncertainty_options.emplace();
+            if (flag == "--mc-samples") uncertainty_options->samples = static_cast<size_t>(value);
+            else if (flag == "--mc-budget-ms") uncertainty_options->budget = std::chrono::milliseconds(value);
+            else uncertainty_options->worker_threads = static_cast<size_t>(value);
+        }
+        else {
+            std::cerr << "Error: unknown option " << flag << "\n";
+            return 1;
+        }
+    }
+    if (ward_beds > 0 && !telemetry_shm.empty()) {
+        std::cerr << "Error: --telemetry-shm feeds a single patient and cannot be used with --patients\n";
+        return 1;
+    }
+    if (ward_beds > 0) {
+        return run_ward(patient, session_id, ward_beds, ward_workers, ward_duration_s,
+                        log_mode, session_format, patient_class);
+    }
+
     std::cout << "Session ID: " << session_id << "\n";
-    std::cout << "Log files: ai_iv_" << session_id << "_*.{log,csv}\n\n";
+    std::cout << "Log files: ai_iv_" << session_id << "_*.{log,csv,aivs}\n\n";
     
-    AIIVSystem system(patient, session_id);
+    std::unique_ptr<ShmTelemetryReader> telemetry_reader;
+    if (!telemetry_shm.empty()) {
+        try {
+            telemetry_reader = std::make_unique<ShmTelemetryReader>(telemetry_shm, telemetry_options);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << " (is the sensor driver running?)\n";
+            return 1;
+        }
+        std::cout << "Telemetry: shared-memory ring " << telemetry_shm << "\n";
+    }
+
+    PatientClass selected_class = patient_class.value_or(select_patient_class(patient));
+    std::cout << "Patient class: " << patient_class_name(selected_class)
+              << (patient_class ? "" : " (from profile)") << "\n";
+
+    AIIVSystem system(patient, session_id, log_mode, session_format, display_options,
+                      realtime_options, uncertainty_options, std::move(telemetry_reader),
+                      selected_class);
     
     std::cout << "Starting control loop (press Ctrl+C to stop)...\n\n";
     
@@ -0,0 +1,139 @@
+#pragma once
+
+/*
+ * checkpoint_codec.hpp
+ *
+ * Byte codec for per-patient control-state checkpoints (cluster_replication.hpp).
+ *
+ * Values are copied as native (little-endian) bytes with no alignment or
+ * padding; Telemetry is written field by field so its padding never
+ * reaches the wire.  Ring buffers are written oldest first, either whole
+ * (full checkpoint) or as their size plus the newest element (delta): a
+ * control tick appends exactly one element to every history ring, so the
+ * newest element is all a replica one tick behind is missing.  A delta
+ * whose size does not match the replica after the push is rejected; the
+ * replica then needs a full checkpoint.
+ *
+ * The reader never throws: a short or inconsistent buffer makes every
+ * further get fail and ok() false.
+ */
+
+#include "iv_system_types.hpp"
+#include "RingBuffer.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ivsys {
+
+static_assert(sizeof(PatientState) == 11 * sizeof(double), "PatientState is copied as plain doubles");
+
+class CheckpointWriter {
+public:
+    // Appends to `out`, which the caller may reuse across checkpoints.
+    explicit CheckpointWriter(std::vector<std::uint8_t>& out) : out_(out) {}
+
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "checkpoint values are raw bytes");
+        const auto* p = reinterpret_cast<const std::uint8_t*>(&value);
+        out_.insert(out_.end(), p, p + sizeof(T));
+    }
+
+    void put(const Telemetry& m) {
+        put(static_cast<std::int64_t>(m.timestamp.time_since_epoch().count()));
+        for (auto field : kTelemetryFields) put(m.*field);
+        put(static_cast<std::uint8_t>(m.vault_cage_breached));
+    }
+
+    void put(const std::string& s) {
+        put(static_cast<std::uint16_t>(s.size()));
+        out_.insert(out_.end(), s.begin(), s.begin() + static_cast<std::ptrdiff_t>(s.size() & 0xFFFF));
+    }
+
+    template <typename T, size_t N>
+    void put_ring(const RingBuffer<T, N>& ring, bool full) {
+        put(static_cast<std::uint16_t>(ring.size()));
+        if (full) {
+            for (const T& v : ring) put(v);
+        } else if (!ring.empty()) {
+            put(ring.back());
+        }
+    }
+
+    size_t size() const { return out_.size(); }
+
+    static constexpr double Telemetry::* kTelemetryFields[] = {
+        &Telemetry::hydration_pct, &Telemetry::heart_rate_bpm, &Telemetry::temp_celsius,
+        &Telemetry::blood_loss_idx, &Telemetry::fatigue_idx, &Telemetry::anxiety_idx,
+        &Telemetry::signal_quality, &Telemetry::spo2_pct, &Telemetry::lactate_mmol,
+        &Telemetry::cardiac_output_L_min, &Telemetry::vault_mesh_size_nm, &Telemetry::vault_payload_pct,
+    };
+
+private:
+    std::vector<std::uint8_t>& out_;
+};
+
+class CheckpointReader {
+public:
+    CheckpointReader(const std::uint8_t* data, size_t size) : p_(data), end_(data + size) {}
+
+    template <typename T>
+    bool get(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "checkpoint values are raw bytes");
+        if (!ok_ || static_cast<size_t>(end_ - p_) < sizeof(T)) return ok_ = false;
+        std::memcpy(&value, p_, sizeof(T));
+        p_ += sizeof(T);
+        return true;
+    }
+
+    bool get(Telemetry& m) {
+        std::int64_t ticks = 0;
+        std::uint8_t breached = 0;
+        get(ticks);
+        for (auto field : CheckpointWriter::kTelemetryFields) get(m.*field);
+        get(breached);
+        m.timestamp = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(ticks));
+        m.vault_cage_breached = breached != 0;
+        return ok_;
+    }
+
+    bool get(std::string& s) {
+        std::uint16_t n = 0;
+        if (!get(n) || static_cast<size_t>(end_ - p_) < n) return ok_ = false;
+        s.assign(reinterpret_cast<const char*>(p_), n);
+        p_ += n;
+        return true;
+    }
+
+    template <typename T, size_t N>
+    bool get_ring(RingBuffer<T, N>& ring, bool full) {
+        std::uint16_t size = 0;
+        if (!get(size) || size > N) return ok_ = false;
+        T v{};
+        if (full) {
+            ring.clear();
+            for (std::uint16_t i = 0; i < size && get(v); ++i) ring.push_back(v);
+        } else if (size == 0) {
+            ring.clear();
+        } else if (get(v)) {
+            ring.push_back(v);
+        }
+        if (ring.size() != size) ok_ = false;
+        return ok_;
+    }
+
+    bool ok() const { return ok_; }
+    bool at_end() const { return p_ == end_; }
+    const std::uint8_t* position() const { return p_; }
+
+private:
+    const std::uint8_t* p_;
+    const std::uint8_t* end_;
+    bool ok_ = true;
+};
+
+} // namespace ivsys
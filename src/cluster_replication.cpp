@@ -0,0 +1,395 @@
+#include "cluster_replication.hpp"
+#include "session_format.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace ivsys {
+namespace replication {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::uint64_t fnv1a64(const std::uint8_t* data, size_t size) {
+    std::uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= data[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+std::uint64_t mix64(std::uint64_t x) {
+    // splitmix64 finalizer
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+constexpr double EnergyTransferParams::* kEnergyParams[] = {
+    &EnergyTransferParams::P_baseline, &EnergyTransferParams::P_iv_supplement,
+    &EnergyTransferParams::P_energy_cells, &EnergyTransferParams::I_sp_standard,
+    &EnergyTransferParams::I_sp_atp_loaded, &EnergyTransferParams::I_sp_mitochondrial,
+    &EnergyTransferParams::eta_brain_heart, &EnergyTransferParams::eta_muscle,
+    &EnergyTransferParams::eta_ischemic, &EnergyTransferParams::v_optimal_cm_s,
+    &EnergyTransferParams::sigma_velocity,
+};
+
+void put_profile(CheckpointWriter& out, const PatientProfile& p) {
+    out.put(p.weight_kg);
+    out.put(p.age_years);
+    out.put(static_cast<std::uint8_t>(p.cardiac_condition));
+    out.put(static_cast<std::uint8_t>(p.renal_impairment));
+    out.put(static_cast<std::uint8_t>(p.diabetes));
+    out.put(p.baseline_hr_bpm);
+    out.put(p.max_safe_infusion_rate);
+    for (auto field : kEnergyParams) out.put(p.energy_params.*field);
+    out.put(p.current_tissue_perfusion);
+}
+
+bool get_profile(CheckpointReader& in, PatientProfile& p) {
+    std::uint8_t cardiac = 0, renal = 0, diabetes = 0;
+    in.get(p.weight_kg);
+    in.get(p.age_years);
+    in.get(cardiac);
+    in.get(renal);
+    in.get(diabetes);
+    in.get(p.baseline_hr_bpm);
+    in.get(p.max_safe_infusion_rate);
+    for (auto field : kEnergyParams) in.get(p.energy_params.*field);
+    in.get(p.current_tissue_perfusion);
+    p.cardiac_condition = cardiac != 0;
+    p.renal_impairment = renal != 0;
+    p.diabetes = diabetes != 0;
+    return in.ok();
+}
+
+// Header checks that do not need the payload.
+bool plausible(const FrameHeader& h) {
+    return h.magic == kFrameMagic && h.version == kVersion &&
+           (h.kind == static_cast<std::uint8_t>(FrameKind::Full) ||
+            h.kind == static_cast<std::uint8_t>(FrameKind::Delta)) &&
+           h.payload_bytes <= kMaxFrameBytes - sizeof(FrameHeader);
+}
+
+} // namespace
+
+std::uint64_t patient_key(const std::string& session_id) {
+    return fnv1a64(reinterpret_cast<const std::uint8_t*>(session_id.data()), session_id.size());
+}
+
+// ============================================================================
+// CheckpointPublisher
+// ============================================================================
+
+CheckpointPublisher::CheckpointPublisher(const std::string& session_id, ReplicationSink* sink)
+    : CheckpointPublisher(session_id, sink, Options{}) {}
+
+CheckpointPublisher::CheckpointPublisher(const std::string& session_id, ReplicationSink* sink,
+                                         const Options& options)
+    : session_id_(session_id), key_(patient_key(session_id)), sink_(sink), options_(options) {
+    if (!sink_) {
+        throw std::invalid_argument("CheckpointPublisher: sink is required");
+    }
+    options_.keyframe_interval = std::max<std::uint32_t>(options_.keyframe_interval, 1);
+}
+
+bool CheckpointPublisher::publish(const PatientControlCycle& cycle, Clock::time_point timestamp) {
+    auto start = Clock::now();
+    // A delta is only valid exactly one step() after the previous frame.
+    bool full = force_full_ || since_full_ + 1 >= options_.keyframe_interval ||
+                cycle.ticks() != last_ticks_ + 1;
+    last_ticks_ = cycle.ticks();
+
+    buffer_.resize(sizeof(FrameHeader));
+    CheckpointWriter out(buffer_);
+    if (full) {
+        out.put(session_id_);
+        put_profile(out, cycle.profile());
+        out.put(static_cast<std::uint8_t>(cycle.patient_class()));
+    }
+    cycle.save_checkpoint(out, full);
+
+    FrameHeader h{};
+    h.magic = kFrameMagic;
+    h.version = kVersion;
+    h.kind = static_cast<std::uint8_t>(full ? FrameKind::Full : FrameKind::Delta);
+    h.payload_bytes = static_cast<std::uint32_t>(buffer_.size() - sizeof(FrameHeader));
+    h.patient_key = key_;
+    h.sequence = ++sequence_;
+    h.checksum = fnv1a64(buffer_.data() + sizeof(FrameHeader), h.payload_bytes);
+    h.timestamp_ns = session_format::to_ns(timestamp);
+    std::memcpy(buffer_.data(), &h, sizeof(h));
+
+    bool accepted = false;
+    if (buffer_.size() > options_.max_frame_bytes) {
+        ++stats_.oversized;
+    } else {
+        accepted = sink_->publish(buffer_.data(), buffer_.size());
+        if (!accepted) ++stats_.rejected;
+    }
+    if (accepted) {
+        ++stats_.frames;
+        stats_.bytes += buffer_.size();
+        if (full) {
+            ++stats_.full_frames;
+            stats_.max_full_bytes = std::max(stats_.max_full_bytes, buffer_.size());
+            since_full_ = 0;
+            force_full_ = false;
+        } else {
+            ++stats_.delta_frames;
+            stats_.max_delta_bytes = std::max(stats_.max_delta_bytes, buffer_.size());
+            ++since_full_;
+        }
+    } else {
+        force_full_ = true;
+    }
+
+    auto elapsed = Clock::now() - start;
+    encode_.record(elapsed);
+    if (elapsed > options_.budget) ++stats_.over_budget;
+    return accepted;
+}
+
+PublisherStats CheckpointPublisher::stats() const {
+    PublisherStats s = stats_;
+    s.encode = encode_.snapshot();
+    return s;
+}
+
+// ============================================================================
+// ReplicaStore
+// ============================================================================
+
+ApplyStatus ReplicaStore::apply(const std::uint8_t* frame, size_t size) {
+    FrameHeader h;
+    if (size < sizeof(h)) return ApplyStatus::Corrupt;
+    std::memcpy(&h, frame, sizeof(h));
+    const std::uint8_t* payload = frame + sizeof(h);
+    if (!plausible(h) || h.payload_bytes != size - sizeof(h) ||
+        fnv1a64(payload, h.payload_bytes) != h.checksum) {
+        return ApplyStatus::Corrupt;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = Clock::now();
+    if (h.kind == static_cast<std::uint8_t>(FrameKind::Full)) {
+        // Always accepted: it supersedes everything, including a
+        // restarted primary whose sequence began again.
+        CheckpointReader in(payload, h.payload_bytes);
+        Replica fresh;
+        std::uint8_t patient_class = 0;
+        in.get(fresh.info.session_id);
+        get_profile(in, fresh.profile);
+        in.get(patient_class);
+        if (!in.ok() || patient_class > static_cast<std::uint8_t>(PatientClass::Pediatric)) {
+            return ApplyStatus::Corrupt;
+        }
+        Replica& r = replicas_[h.patient_key];
+        r.info.session_id = std::move(fresh.info.session_id);
+        r.info.patient_class = static_cast<PatientClass>(patient_class);
+        r.profile = fresh.profile;
+        r.state.assign(in.position(), payload + h.payload_bytes);
+        r.deltas.clear();
+        r.info.deltas = 0;
+        r.waiting_for_full = false;
+        r.info.in_sync = true;
+        r.info.sequence = h.sequence;
+        r.info.timestamp_ns = h.timestamp_ns;
+        r.info.received = now;
+        r.info.bytes = r.state.size();
+        return ApplyStatus::Applied;
+    }
+
+    auto it = replicas_.find(h.patient_key);
+    if (it == replicas_.end()) return ApplyStatus::NeedsFull;
+    Replica& r = it->second;
+    if (h.sequence <= r.info.sequence) return ApplyStatus::Duplicate;
+    if (r.waiting_for_full || h.sequence != r.info.sequence + 1 || r.info.deltas >= max_deltas_) {
+        r.waiting_for_full = true;
+        r.info.in_sync = false;
+        return ApplyStatus::NeedsFull;
+    }
+    r.deltas.insert(r.deltas.end(), payload, payload + h.payload_bytes);
+    ++r.info.deltas;
+    r.info.sequence = h.sequence;
+    r.info.timestamp_ns = h.timestamp_ns;
+    r.info.received = now;
+    r.info.bytes = r.state.size() + r.deltas.size();
+    return ApplyStatus::Applied;
+}
+
+bool ReplicaStore::contains(std::uint64_t key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return replicas_.count(key) != 0;
+}
+
+bool ReplicaStore::info(std::uint64_t key, ReplicaInfo& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = replicas_.find(key);
+    if (it == replicas_.end()) return false;
+    out = it->second.info;
+    return true;
+}
+
+std::vector<std::uint64_t> ReplicaStore::keys() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::uint64_t> out;
+    out.reserve(replicas_.size());
+    for (const auto& entry : replicas_) out.push_back(entry.first);
+    return out;
+}
+
+std::vector<std::uint64_t> ReplicaStore::silent(Clock::time_point now, Clock::duration timeout) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::uint64_t> out;
+    for (const auto& entry : replicas_) {
+        if (now - entry.second.info.received > timeout) out.push_back(entry.first);
+    }
+    return out;
+}
+
+std::unique_ptr<PatientControlCycle> ReplicaStore::promote(std::uint64_t key, const PromoteOptions& options) {
+    Replica r;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = replicas_.find(key);
+        if (it == replicas_.end()) {
+            throw std::runtime_error("ReplicaStore: no replica for patient " + std::to_string(key));
+        }
+        if (!it->second.info.in_sync && !options.allow_out_of_sync) {
+            throw std::runtime_error("ReplicaStore: replica of " + it->second.info.session_id +
+                                     " is out of sync since sequence " +
+                                     std::to_string(it->second.info.sequence) + "; waiting for a full frame");
+        }
+        r = std::move(it->second);
+        replicas_.erase(it);
+    }
+
+    std::string session_id = options.session_id.empty() ? r.info.session_id + "_failover" : options.session_id;
+    auto cycle = std::make_unique<PatientControlCycle>(r.profile, session_id, options.log_mode,
+                                                       options.session_format, options.energy_model,
+                                                       r.info.patient_class);
+    CheckpointReader full(r.state.data(), r.state.size());
+    if (!cycle->restore_checkpoint(full, true) || !full.at_end()) {
+        throw std::runtime_error("ReplicaStore: malformed checkpoint for " + r.info.session_id);
+    }
+    CheckpointReader deltas(r.deltas.data(), r.deltas.size());
+    for (size_t i = 0; i < r.info.deltas; ++i) {
+        if (!cycle->restore_checkpoint(deltas, false)) {
+            throw std::runtime_error("ReplicaStore: delta " + std::to_string(i + 1) +
+                                     " does not follow for " + r.info.session_id);
+        }
+    }
+    return cycle;
+}
+
+void ReplicaStore::drop(std::uint64_t key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    replicas_.erase(key);
+}
+
+size_t ReplicaStore::bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t total = 0;
+    for (const auto& entry : replicas_) total += entry.second.info.bytes;
+    return total;
+}
+
+// ============================================================================
+// Stream transport
+// ============================================================================
+
+namespace {
+
+// Bytes written, or -1 if the descriptor would block or failed.
+ssize_t write_some(int fd, const std::uint8_t* data, size_t size) {
+    while (true) {
+        ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0 && errno == ENOTSOCK) n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        return n;
+    }
+}
+
+} // namespace
+
+bool StreamReplicationSink::flush_pending() {
+    while (!pending_.empty()) {
+        ssize_t n = write_some(fd_, pending_.data(), pending_.size());
+        if (n <= 0) return false;
+        pending_.erase(pending_.begin(), pending_.begin() + n);
+    }
+    return true;
+}
+
+bool StreamReplicationSink::publish(const std::uint8_t* frame, size_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!flush_pending()) return false;
+    ssize_t n = write_some(fd_, frame, size);
+    if (n <= 0) return false;
+    // The receiver already has the head of the frame; finish it later.
+    if (static_cast<size_t>(n) < size) pending_.assign(frame + n, frame + size);
+    return true;
+}
+
+size_t FrameStreamDecoder::feed(const std::uint8_t* data, size_t size, ReplicaStore& store) {
+    buffer_.insert(buffer_.end(), data, data + size);
+    size_t applied = 0, pos = 0;
+    while (buffer_.size() - pos >= sizeof(FrameHeader)) {
+        FrameHeader h;
+        std::memcpy(&h, buffer_.data() + pos, sizeof(h));
+        if (!plausible(h)) {
+            // Skip to the next byte that could start a frame
+            ++pos;
+            while (buffer_.size() - pos >= sizeof(kFrameMagic) &&
+                   std::memcmp(buffer_.data() + pos, &kFrameMagic, sizeof(kFrameMagic)) != 0) {
+                ++pos;
+            }
+            continue;
+        }
+        size_t frame_size = sizeof(h) + h.payload_bytes;
+        if (buffer_.size() - pos < frame_size) break;
+        if (store.apply(buffer_.data() + pos, frame_size) == ApplyStatus::Applied) ++applied;
+        pos += frame_size;
+    }
+    buffer_.erase(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(pos));
+    return applied;
+}
+
+// ============================================================================
+// ShardMap
+// ============================================================================
+
+ShardMap::ShardMap(size_t node_count) : alive_(node_count, true) {
+    if (node_count == 0) {
+        throw std::invalid_argument("ShardMap: at least one node is required");
+    }
+}
+
+size_t ShardMap::ranked(std::uint64_t key, size_t place) const {
+    size_t best = npos, second = npos;
+    std::uint64_t best_score = 0, second_score = 0;
+    for (size_t node = 0; node < alive_.size(); ++node) {
+        if (!alive_[node]) continue;
+        std::uint64_t score = mix64(key ^ mix64(node));
+        if (best == npos || score > best_score) {
+            second = best;
+            second_score = best_score;
+            best = node;
+            best_score = score;
+        } else if (second == npos || score > second_score) {
+            second = node;
+            second_score = score;
+        }
+    }
+    return place == 0 ? best : second;
+}
+
+} // namespace replication
+} // namespace ivsys
@@ -0,0 +1,282 @@
+#pragma once
+
+/*
+ * cluster_replication.hpp
+ *
+ * Cluster mode: patients sharded across nodes, each one's control state
+ * streamed every tick to a standby node that can take over.
+ *
+ * ShardMap places every patient on a primary and a standby node by
+ * rendezvous hashing of replication::patient_key(session_id).  When the
+ * primary is marked down, the standby is by construction the patient's new
+ * primary, and only that node's patients move.
+ *
+ * After each step() the primary's CheckpointPublisher sends one frame to a
+ * ReplicationSink:
+ *
+ *   FrameHeader   (48 bytes: magic, kind, patient key, sequence, checksum)
+ *   payload       Full:  session id, profile, class, cycle state
+ *                 Delta: cycle state with only the newest history entries
+ *
+ * The cycle state is PatientControlCycle::save_checkpoint(): estimator ring
+ * buffers and predictor, SafetyMonitor cumulative volume and recent rates,
+ * vault state and current rate.  Deltas are a fixed ~0.5 KB; a full frame
+ * (~10 KB) goes out every keyframe_interval ticks, after a skipped tick and
+ * whenever the sink rejects a frame.  Encoding writes into a buffer kept
+ * by the publisher, so a steady-state tick does not allocate.  Frames over
+ * max_frame_bytes are refused, and ticks whose replication took longer than
+ * budget are counted: replication cost per tick is bounded in size and
+ * measured in time.
+ *
+ * The standby's ReplicaStore keeps per patient the last full payload and
+ * the deltas since, checking sequence and checksum on arrival; a gap makes
+ * it refuse deltas until the next full frame.  promote() builds a new
+ * PatientControlCycle and replays at most keyframe_interval deltas into
+ * it, well inside one control period, after which the cycle's decisions
+ * are bit-identical to those the primary would have made.
+ */
+
+#include "control_cycle.hpp"
+#include "LatencyHistogram.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ivsys {
+namespace replication {
+
+constexpr std::uint32_t kFrameMagic = 0x4B434941u;   // "AICK"
+constexpr std::uint16_t kVersion = 1;
+constexpr size_t kMaxFrameBytes = 64 * 1024;
+
+enum class FrameKind : std::uint8_t {
+    Full = 1,
+    Delta = 2,
+};
+
+struct FrameHeader {
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint8_t kind;
+    std::uint8_t reserved;
+    std::uint32_t payload_bytes;
+    std::uint32_t reserved2;
+    std::uint64_t patient_key;
+    std::uint64_t sequence;       // per patient, +1 per frame
+    std::uint64_t checksum;       // FNV-1a 64 of the payload
+    std::int64_t timestamp_ns;    // telemetry time of the tick
+};
+
+static_assert(sizeof(FrameHeader) == 48, "FrameHeader layout is part of the protocol");
+
+// Stable 64-bit key for a patient (FNV-1a 64 of the session id).
+std::uint64_t patient_key(const std::string& session_id);
+
+// Receives encoded frames.  publish() runs on the control thread after
+// every tick and must not block; returning false (queue full, standby
+// out of sync) makes the next frame a full one.  Implementations must be
+// thread-safe when publishers on several threads share them.
+class ReplicationSink {
+public:
+    virtual ~ReplicationSink() = default;
+    virtual bool publish(const std::uint8_t* frame, size_t size) = 0;
+};
+
+struct PublisherStats {
+    std::uint64_t frames = 0;
+    std::uint64_t full_frames = 0;
+    std::uint64_t delta_frames = 0;
+    std::uint64_t rejected = 0;        // refused by the sink
+    std::uint64_t oversized = 0;       // over max_frame_bytes, not sent
+    std::uint64_t over_budget = 0;     // ticks over Options::budget
+    std::uint64_t bytes = 0;
+    size_t max_full_bytes = 0;
+    size_t max_delta_bytes = 0;
+    LatencyHistogram::Snapshot encode;   // encode + checksum + publish
+};
+
+// Primary side, one per patient.  Not thread-safe: call publish() from the
+// thread that steps the cycle.
+class CheckpointPublisher {
+public:
+    struct Options {
+        std::uint32_t keyframe_interval = 25;    // full frame at least every N ticks
+        size_t max_frame_bytes = kMaxFrameBytes;
+        std::chrono::microseconds budget{200};   // per tick; 0.1% of the 5 Hz period
+    };
+
+    CheckpointPublisher(const std::string& session_id, ReplicationSink* sink);
+    CheckpointPublisher(const std::string& session_id, ReplicationSink* sink, const Options& options);
+
+    // Encode the cycle's state after its latest step() and hand it to the
+    // sink.  Returns false if the frame was refused or not sent.
+    bool publish(const PatientControlCycle& cycle, std::chrono::steady_clock::time_point timestamp);
+
+    // Send a full frame next (e.g. the standby reported a gap).
+    void request_full() { force_full_ = true; }
+
+    std::uint64_t key() const { return key_; }
+    const std::string& session_id() const { return session_id_; }
+    PublisherStats stats() const;
+    // The counters alone (encode left empty); cheap enough for every tick.
+    const PublisherStats& counters() const { return stats_; }
+
+private:
+    std::string session_id_;
+    std::uint64_t key_;
+    ReplicationSink* sink_;
+    Options options_;
+    std::vector<std::uint8_t> buffer_;
+    std::uint64_t sequence_ = 0;
+    std::uint64_t last_ticks_ = 0;
+    std::uint32_t since_full_ = 0;
+    bool force_full_ = true;
+    PublisherStats stats_;
+    LatencyHistogram encode_;
+};
+
+enum class ApplyStatus {
+    Applied,
+    Duplicate,    // sequence already seen; ignored
+    NeedsFull,    // gap or unknown patient; waiting for a full frame
+    Corrupt,      // bad magic, version, size or checksum
+};
+
+struct ReplicaInfo {
+    std::string session_id;
+    PatientClass patient_class = PatientClass::Standard;
+    std::uint64_t sequence = 0;
+    std::int64_t timestamp_ns = 0;
+    size_t deltas = 0;                              // since the full frame
+    bool in_sync = true;                            // false after a gap, until the next full frame
+    size_t bytes = 0;                               // held for this patient
+    std::chrono::steady_clock::time_point received; // last frame accepted
+};
+
+// Standby side: replicas of every patient streamed to this node.
+// Thread-safe.
+class ReplicaStore {
+public:
+    struct PromoteOptions {
+        std::string session_id;    // empty: "<replicated id>_failover"
+        LoggerMode log_mode = LoggerMode::Sync;
+        SessionFormat session_format = SessionFormat::Csv;
+        EnergyProxyModelPtr energy_model;
+        // Resume from a replica that is not in_sync anyway.  It restores the
+        // state from before the gap, up to keyframe_interval ticks behind the
+        // primary, with the infused volume of that tick.
+        bool allow_out_of_sync = false;
+    };
+
+    // A replica holding more deltas than this refuses further ones until a
+    // full frame arrives (a primary that never sends one).
+    explicit ReplicaStore(size_t max_deltas = 1024) : max_deltas_(max_deltas) {}
+
+    ApplyStatus apply(const std::uint8_t* frame, size_t size);
+
+    bool contains(std::uint64_t key) const;
+    bool info(std::uint64_t key, ReplicaInfo& out) const;
+    std::vector<std::uint64_t> keys() const;
+    // Patients with no accepted frame since `now - timeout`.
+    std::vector<std::uint64_t> silent(std::chrono::steady_clock::time_point now,
+                                      std::chrono::steady_clock::duration timeout) const;
+
+    // Rebuild the patient's cycle from its replica and drop the replica.
+    // The cycle continues exactly where the last applied frame left off.
+    // Throws std::runtime_error, keeping the replica, if it is not in_sync
+    // (unless options.allow_out_of_sync): its volume and history would lag
+    // the primary's.  Also throws if there is no replica or its frames do
+    // not restore.
+    std::unique_ptr<PatientControlCycle> promote(std::uint64_t key, const PromoteOptions& options);
+    std::unique_ptr<PatientControlCycle> promote(std::uint64_t key) { return promote(key, PromoteOptions{}); }
+
+    void drop(std::uint64_t key);
+    size_t bytes() const;
+
+private:
+    struct Replica {
+        ReplicaInfo info;
+        PatientProfile profile;
+        std::vector<std::uint8_t> state;    // full frame's cycle state
+        std::vector<std::uint8_t> deltas;   // delta payloads since, in order
+        bool waiting_for_full = false;
+    };
+
+    mutable std::mutex mutex_;
+    std::map<std::uint64_t, Replica> replicas_;
+    size_t max_deltas_;
+};
+
+// In-process sink delivering straight to a standby's store; rejects a
+// frame the store could not apply so the publisher resends a full one.
+class LocalReplicaSink : public ReplicationSink {
+public:
+    explicit LocalReplicaSink(ReplicaStore& store) : store_(store) {}
+    bool publish(const std::uint8_t* frame, size_t size) override {
+        ApplyStatus s = store_.apply(frame, size);
+        return s == ApplyStatus::Applied || s == ApplyStatus::Duplicate;
+    }
+
+private:
+    ReplicaStore& store_;
+};
+
+// Sink writing frames to a connected stream socket or pipe (frames are
+// self-delimiting).  The descriptor should be non-blocking: a write that
+// would block drops the frame rather than stall the control thread, and
+// the publisher follows up with a full frame.  Partially written frames
+// are completed on the next publish() before anything new is sent.
+class StreamReplicationSink : public ReplicationSink {
+public:
+    explicit StreamReplicationSink(int fd) : fd_(fd) {}
+    bool publish(const std::uint8_t* frame, size_t size) override;
+
+private:
+    bool flush_pending();
+
+    std::mutex mutex_;
+    int fd_;
+    std::vector<std::uint8_t> pending_;   // unsent tail of a frame
+};
+
+// Splits a byte stream into frames for ReplicaStore::apply.
+class FrameStreamDecoder {
+public:
+    // Appends `data`, applies every complete frame to `store` and returns
+    // how many were Applied.  A corrupt header resynchronizes on the next
+    // frame magic.
+    size_t feed(const std::uint8_t* data, size_t size, ReplicaStore& store);
+
+private:
+    std::vector<std::uint8_t> buffer_;
+};
+
+// Rendezvous-hash placement of patients on nodes.
+class ShardMap {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    explicit ShardMap(size_t node_count);
+
+    size_t node_count() const { return alive_.size(); }
+    void set_alive(size_t node, bool alive) { alive_.at(node) = alive; }
+    bool alive(size_t node) const { return alive_.at(node); }
+
+    // Highest- and second-highest-ranked live nodes for the patient; npos
+    // with fewer than one (two) live nodes.
+    size_t primary(std::uint64_t key) const { return ranked(key, 0); }
+    size_t standby(std::uint64_t key) const { return ranked(key, 1); }
+
+private:
+    size_t ranked(std::uint64_t key, size_t place) const;
+
+    std::vector<bool> alive_;
+};
+
+} // namespace replication
+} // namespace ivsys
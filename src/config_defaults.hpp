@@ -61,6 +61,19 @@ constexpr double DEFAULT_FLOW_SIGMA_CM_S = 5.0;
 // -----------------------------
 constexpr int PREDICTION_HORIZON_MIN = 10;
 constexpr double UNCERTAINTY_GROWTH_PER_MIN = 0.05;
+constexpr int PREDICTION_WARMUP_SAMPLES = 5;
+
+// ForwardPredictor local-linear-trend filter, variances per estimate()
+constexpr double HYDRATION_MEASUREMENT_VAR = 0.25;
+constexpr double HYDRATION_LEVEL_VAR       = 1e-3;
+constexpr double HYDRATION_TREND_VAR       = 1e-5;
+constexpr double ENERGY_MEASUREMENT_VAR    = 1e-4;
+constexpr double ENERGY_LEVEL_VAR          = 1e-6;
+constexpr double ENERGY_TREND_VAR          = 1e-8;
+
+// Horizons published on /api/prediction, in estimate() steps (control
+// ticks): 1, 2, 3 and 6 s ahead at the 5 Hz loop
+constexpr int PUBLISHED_PREDICTION_HORIZON_STEPS[] = {5, 10, 15, 30};
 
 // -----------------------------
 // Volume Safety
@@ -106,5 +119,49 @@ constexpr double CARDIAC_SIGMOID_STEEPNESS = 10.0;
 constexpr double CARDIAC_CONDITION_VOLUME_FACTOR = 0.7;
 constexpr double RENAL_IMPAIRMENT_VOLUME_FACTOR  = 0.6;
 
+// -----------------------------
+// Base Rate Gains
+// -----------------------------
+constexpr double BASE_RATE_FLOOR_ML_MIN    = 0.4;
+constexpr double BASE_RATE_GAIN            = 1.4;
+constexpr double HYDRATION_URGENCY_WEIGHT  = 0.6;
+constexpr double ENERGY_NEED_WEIGHT        = 0.4;
+
+// -----------------------------
+// Runtime Tuning
+// -----------------------------
+// The subset of the constants above that SafetyMonitor, AdaptiveController
+// and StateEstimator read at run time.  A default-constructed ControlTuning
+// reproduces the compile-time configuration exactly; what-if replays
+// override individual fields.
+struct ControlTuning {
+    // SafetyMonitor
+    double max_rate_change_ml_min    = MAX_RATE_CHANGE_ML_MIN;
+    double min_cardiac_reserve       = MIN_CARDIAC_RESERVE;
+    double high_risk_threshold       = HIGH_RISK_THRESHOLD;
+    double tachycardia_hr_multiplier = TACHYCARDIA_HR_MULTIPLIER;
+    double volume_approach_fraction  = VOLUME_APPROACH_FRACTION;
+    double daily_volume_per_kg_ml    = DAILY_VOLUME_PER_KG_ML;
+    double volume_limit_rate_cap     = VOLUME_LIMIT_RATE_CAP;
+    double low_cardiac_rate_cap      = LOW_CARDIAC_RATE_CAP;
+    double high_risk_rate_cap        = HIGH_RISK_RATE_CAP;
+    double tachycardia_rate_cap      = TACHYCARDIA_RATE_CAP;
+
+    // AdaptiveController
+    double base_rate_floor_ml_min         = BASE_RATE_FLOOR_ML_MIN;
+    double base_rate_gain                 = BASE_RATE_GAIN;
+    double hydration_urgency_weight       = HYDRATION_URGENCY_WEIGHT;
+    double energy_need_weight             = ENERGY_NEED_WEIGHT;
+    double predictive_boost_multiplier    = PREDICTIVE_BOOST_MULTIPLIER;
+    double predictive_hydration_threshold = PREDICTIVE_HYDRATION_THRESHOLD;
+    int prediction_horizon_min            = PREDICTION_HORIZON_MIN;
+    double cardiac_limit_threshold        = CARDIAC_LIMIT_THRESHOLD;
+    double cardiac_scaling_base           = CARDIAC_SCALING_BASE;
+
+    // StateEstimator: use the neural energy proxy when the build has one
+    // and its model loaded; false forces the rule-based proxy.
+    bool neural_energy_proxy = true;
+};
+
 } // namespace config
 } // namespace ivsys
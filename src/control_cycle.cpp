@@ -0,0 +1,225 @@
+#include "control_cycle.hpp"
+#include "precision_spine/PrecisionSpine.hpp"
+#include "control_text.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+namespace ivsys {
+
+namespace {
+
+template <typename Policy>
+class PolicyControlPipeline final : public ControlPipeline {
+public:
+    PolicyControlPipeline(const PatientProfile& profile, EnergyProxyModelPtr energy_model)
+        : ControlPipeline(Policy::patient_class, &estimator_, &safety_),
+          estimator_(make_energy(std::move(energy_model))), controller_(profile), safety_(profile) {}
+
+    void run(const Telemetry& measurement, const PatientProfile& profile,
+             double current_infusion_rate, double dt_minutes,
+             UncertaintyEngine* uncertainty, StageClock& stages, CycleResult& result) override {
+        // Optional rate interval, from the state before this tick's estimate
+        if (uncertainty) {
+            result.rate_interval = uncertainty->evaluate(measurement, profile, estimator_, controller_,
+                                                         safety_, current_infusion_rate, dt_minutes);
+            stages.lap(LoopStage::Uncertainty);
+        }
+
+        // State estimation with energy transfer model
+        result.state = estimator_.estimate(measurement, profile, current_infusion_rate);
+        stages.lap(LoopStage::Estimate);
+
+        // Precision Spine Routing
+        // Enforce deterministic validation and fallback floor before adaptive control
+        precision_spine::TreatmentFlow routed_flow = precision_spine::dose_route(result.state);
+        precision_spine::TreatmentFlow safe_flow = precision_spine::reject_noise(routed_flow);
+        result.validated_state = precision_spine::fallback_floor(safe_flow);
+        stages.lap(LoopStage::Spine);
+
+        // Control decision with predictive capability on validated state
+        result.command = controller_.decide(result.validated_state, safety_, estimator_, dt_minutes);
+        stages.lap(LoopStage::Decide);
+    }
+
+private:
+    using Energy = typename Policy::Energy;
+
+    static Energy make_energy(EnergyProxyModelPtr energy_model) {
+        if constexpr (std::is_same<Energy, ModelEnergy>::value) {
+            return ModelEnergy{std::move(energy_model), true};
+        } else {
+            return Energy{};
+        }
+    }
+
+    PolicyStateEstimator<Policy> estimator_;
+    BasicAdaptiveController<Policy> controller_;
+    BasicSafetyMonitor<Policy> safety_;
+};
+
+} // namespace
+
+std::unique_ptr<ControlPipeline> make_control_pipeline(PatientClass patient_class,
+                                                       const PatientProfile& profile,
+                                                       EnergyProxyModelPtr energy_model) {
+    switch (patient_class) {
+        case PatientClass::Standard:
+            return std::make_unique<PolicyControlPipeline<StandardPolicy>>(profile, std::move(energy_model));
+        case PatientClass::Cardiac:
+            return std::make_unique<PolicyControlPipeline<CardiacPolicy>>(profile, std::move(energy_model));
+        case PatientClass::Renal:
+            return std::make_unique<PolicyControlPipeline<RenalPolicy>>(profile, std::move(energy_model));
+        case PatientClass::Pediatric:
+            return std::make_unique<PolicyControlPipeline<PediatricPolicy>>(profile, std::move(energy_model));
+    }
+    throw std::invalid_argument("make_control_pipeline: unknown patient class");
+}
+
+PatientControlCycle::PatientControlCycle(const PatientProfile& prof, const std::string& session_id,
+                                         LoggerMode log_mode, SessionFormat session_format,
+                                         EnergyProxyModelPtr energy_model, PatientClass patient_class)
+    : profile_(prof),
+      pipeline_(make_control_pipeline(patient_class, prof,
+                                      energy_model ? std::move(energy_model) : default_energy_proxy())),
+      logger_(session_id, log_mode, SystemLogger::kDefaultQueueCapacity, session_format) {}
+
+void PatientControlCycle::update_vault(Telemetry& measurement, double dt_seconds) {
+    // Drive vault state estimation from current telemetry before elution tick.
+    // Lower pH and higher fatigue/lactate imply a more proteolytic niche.
+    double ambient_ph = std::clamp(7.4 - (measurement.lactate_mmol - 1.0) * 0.18, 6.2, 7.6);
+    double cathepsin_k_activity = std::clamp(
+        0.15 + (measurement.fatigue_idx * 0.6) + (measurement.blood_loss_idx * 0.4), 0.0, 1.0);
+    vault_.update_telemetry(ambient_ph, cathepsin_k_activity);
+    vault_.tick_elution(dt_seconds);
+
+    measurement.vault_mesh_size_nm = vault_.get_mesh_size();
+    measurement.vault_payload_pct = vault_.get_payload_remaining();
+    measurement.vault_cage_breached = vault_.is_steric_cage_breached();
+
+    if (!steric_cage_was_breached_ && vault_.is_steric_cage_breached()) {
+        logger_.log_alert(
+            AlertSeverity::Info,
+            "MetaboJointDomain",
+            "PAYLOAD_ELUTION_STARTED",
+            "Steric cage breached, CRISPR payload elution initiated.",
+            std::string("{\"mesh_size_nm\":") + std::to_string(vault_.get_mesh_size()) + "}");
+        steric_cage_was_breached_ = true;
+    }
+}
+
+CycleResult PatientControlCycle::step(Telemetry measurement, double dt_seconds) {
+    CycleResult result;
+    double cycle_duration_min = dt_seconds / 60.0;
+    StageClock stages(loop_metrics_);
+
+    // MetaboJointDomain integration
+    update_vault(measurement, dt_seconds);
+    stages.lap(LoopStage::Vault);
+
+    // Rate interval, estimate, precision spine and decision, compiled for
+    // the patient's class
+    pipeline_->run(measurement, profile_, current_infusion_rate_, cycle_duration_min,
+                   uncertainty_, stages, result);
+
+    // Update current rate for next cycle
+    current_infusion_rate_ = result.command.infusion_ml_per_min;
+
+    // Logging
+    logger_.log_telemetry(measurement);
+    logger_.log_control(result.command, result.validated_state, measurement.timestamp);
+
+    result.measurement = measurement;
+    result.sensor_quality_low = measurement.signal_quality < SENSOR_QUALITY_ALERT_THRESHOLD;
+    emit_alerts(result);
+    stages.lap(LoopStage::Log);
+
+    // Update safety monitor
+    pipeline_->safety().update_volume(result.command.infusion_ml_per_min, cycle_duration_min);
+    ++ticks_;
+
+    return result;
+}
+
+void PatientControlCycle::save_checkpoint(CheckpointWriter& out, bool full) const {
+    out.put(ticks_);
+    out.put(current_infusion_rate_);
+    out.put(static_cast<std::uint8_t>(steric_cage_was_breached_));
+    out.put(vault_.get_mesh_size());
+    out.put(vault_.get_cleavage_progression());
+    out.put(vault_.get_payload_remaining());
+    pipeline_->estimator().save_checkpoint(out, full);
+    pipeline_->safety().save_checkpoint(out, full);
+}
+
+bool PatientControlCycle::restore_checkpoint(CheckpointReader& in, bool full) {
+    std::uint64_t ticks = 0;
+    std::uint8_t breached = 0;
+    double mesh = 0.0, cleavage = 0.0, payload = 0.0;
+    in.get(ticks);
+    in.get(current_infusion_rate_);
+    in.get(breached);
+    in.get(mesh);
+    in.get(cleavage);
+    in.get(payload);
+    if (!in.ok() || (!full && ticks != ticks_ + 1)) return false;
+    ticks_ = ticks;
+    steric_cage_was_breached_ = breached != 0;
+    vault_.restore_state(mesh, cleavage, payload);
+    return pipeline_->estimator().restore_checkpoint(in, full) &&
+           pipeline_->safety().restore_checkpoint(in, full);
+}
+
+void PatientControlCycle::emit_alerts(const CycleResult& result) {
+    using AlertValue = SystemLogger::AlertValue;
+    const Telemetry& measurement = result.measurement;
+    const PatientState& state = result.state;
+    const ControlOutput& command = result.command;
+
+    if (result.sensor_quality_low) {
+        const AlertValue context[] = {
+            {"signal_quality", measurement.signal_quality},
+            {"threshold", SENSOR_QUALITY_ALERT_THRESHOLD},
+        };
+        logger_.log_alert(AlertSeverity::Warn, "Telemetry", "SENSOR_QUALITY_LOW",
+                          "Telemetry signal quality below threshold", context, 2);
+    }
+
+    if (!command.warning_flags.any()) return;
+
+    // One alert per SafetyMonitor finding, in check order.
+    struct WarningAlert {
+        WarningFlag flag;
+        AlertSeverity severity;
+        const char* message;
+        const char* key;
+        double value;
+    };
+    const WarningAlert alerts[] = {
+        {WarningFlag::VolumeLimitApproach, AlertSeverity::Warn,
+         "Projected volume approaching 24h limit",
+         "cumulative_volume_ml", pipeline_->safety().get_cumulative_volume()},
+        {WarningFlag::LowCardiacReserve, AlertSeverity::Warn,
+         "Cardiac reserve below minimum threshold",
+         "cardiac_reserve", state.cardiac_reserve},
+        {WarningFlag::RateChangeLimited, AlertSeverity::Info,
+         "Infusion rate change limited by safety constraints",
+         "infusion_rate_ml_min", command.infusion_ml_per_min},
+        {WarningFlag::HighRiskState, AlertSeverity::Warn,
+         "Risk score exceeded threshold",
+         "risk_score", state.risk_score},
+        {WarningFlag::TachycardiaDetected, AlertSeverity::Warn,
+         "Tachycardia detected",
+         "heart_rate_bpm", state.heart_rate_bpm},
+        {WarningFlag::EmergencyMinRate, AlertSeverity::Critical,
+         "Emergency minimum infusion rate enforced",
+         "hydration_pct", state.hydration_pct},
+    };
+    for (const WarningAlert& a : alerts) {
+        if (!command.warning_flags.has(a.flag)) continue;
+        const AlertValue context[] = {{a.key, a.value}};
+        logger_.log_alert(a.severity, "SafetyMonitor", warning_token(a.flag), a.message, context, 1);
+    }
+}
+
+} // namespace ivsys
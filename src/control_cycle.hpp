@@ -0,0 +1,150 @@
+#pragma once
+
+/*
+ * control_cycle.hpp
+ *
+ * One patient's estimate -> precision-spine -> decide -> log cycle.
+ *
+ * PatientControlCycle owns every piece of per-patient state (estimator
+ * history, safety accounting, vault, logger) so that a single process can
+ * host any number of independent cycles.  AIIVSystem drives one cycle from
+ * its own 5 Hz loop; MultiPatientEngine drives many from a worker pool.
+ *
+ * The estimator, controller and safety monitor come from a
+ * ControlPipeline compiled for the patient's class (control_policy.hpp),
+ * chosen once at construction; step() makes one virtual call into it per
+ * tick and never branches on the class.
+ *
+ * step() is not thread-safe: a given cycle must only be stepped by one
+ * thread at a time.
+ */
+
+#include "iv_system_types.hpp"
+#include "StateEstimator.hpp"
+#include "AdaptiveController.hpp"
+#include "SafetyMonitor.hpp"
+#include "SystemLogger.hpp"
+#include "ControlLoopMetrics.hpp"
+#include "uncertainty_engine.hpp"
+#include "control_policy.hpp"
+#include "checkpoint_codec.hpp"
+#include "domains/metabojoint_domain.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace ivsys {
+
+struct CycleResult {
+    Telemetry measurement;          // telemetry with vault fields populated
+    PatientState state;             // raw estimator output
+    PatientState validated_state;   // state after precision-spine routing
+    ControlOutput command;
+    bool sensor_quality_low = false;
+    RateInterval rate_interval;     // samples == 0 without an uncertainty engine
+};
+
+// One patient class's estimator, controller and safety monitor.
+class ControlPipeline {
+public:
+    virtual ~ControlPipeline() = default;
+
+    ControlPipeline(const ControlPipeline&) = delete;
+    ControlPipeline& operator=(const ControlPipeline&) = delete;
+
+    // The estimate -> precision-spine -> decide part of a tick, preceded by
+    // the rate interval when `uncertainty` is set.  Fills result.state,
+    // validated_state, command and rate_interval, lapping `stages` after
+    // each stage.  Safety accounting is left to the caller.
+    virtual void run(const Telemetry& measurement, const PatientProfile& profile,
+                     double current_infusion_rate, double dt_minutes,
+                     UncertaintyEngine* uncertainty, StageClock& stages, CycleResult& result) = 0;
+
+    PatientClass patient_class() const { return patient_class_; }
+    StateEstimatorCore& estimator() { return *estimator_; }
+    SafetyMonitorCore& safety() { return *safety_; }
+    const SafetyMonitorCore& safety() const { return *safety_; }
+
+protected:
+    ControlPipeline(PatientClass patient_class, StateEstimatorCore* estimator, SafetyMonitorCore* safety)
+        : patient_class_(patient_class), estimator_(estimator), safety_(safety) {}
+
+private:
+    PatientClass patient_class_;
+    StateEstimatorCore* estimator_;
+    SafetyMonitorCore* safety_;
+};
+
+// Pipeline specialized for patient_class.  energy_model is used by the
+// classes on the model energy proxy.
+std::unique_ptr<ControlPipeline> make_control_pipeline(PatientClass patient_class,
+                                                       const PatientProfile& profile,
+                                                       EnergyProxyModelPtr energy_model);
+
+class PatientControlCycle {
+public:
+    static constexpr double SENSOR_QUALITY_ALERT_THRESHOLD = 0.6;
+
+    // energy_model defaults to default_energy_proxy().  patient_class
+    // selects the compiled pipeline; select_patient_class() derives one
+    // from the profile.
+    PatientControlCycle(const PatientProfile& prof, const std::string& session_id,
+                        LoggerMode log_mode = LoggerMode::Sync,
+                        SessionFormat session_format = SessionFormat::Csv,
+                        EnergyProxyModelPtr energy_model = nullptr,
+                        PatientClass patient_class = PatientClass::Standard);
+
+    // Run one full control cycle covering dt_seconds of therapy.
+    CycleResult step(Telemetry measurement, double dt_seconds);
+
+    // Record the vault, estimate, spine, decide and log stages of every
+    // step() into `metrics` (null: no timing).  The caller keeps it alive.
+    void set_loop_metrics(ControlLoopMetrics* metrics) { loop_metrics_ = metrics; }
+
+    // Evaluate a Monte Carlo interval for every step() before its own
+    // decision (null: none).  The caller keeps it alive; it must not be
+    // shared with another cycle running at the same time.
+    void set_uncertainty_engine(UncertaintyEngine* engine) { uncertainty_ = engine; }
+
+    // Start a new 24 h volume accounting window (SafetyMonitor::reset_24h_counter).
+    void reset_24h_volume() { pipeline_->safety().reset_24h_counter(); }
+
+    SystemLogger& logger() { return logger_; }
+    StateEstimatorCore& estimator() { return pipeline_->estimator(); }
+    const SafetyMonitorCore& safety() const { return pipeline_->safety(); }
+    const PatientProfile& profile() const { return profile_; }
+    PatientClass patient_class() const { return pipeline_->patient_class(); }
+    double current_infusion_rate() const { return current_infusion_rate_; }
+    // step() calls so far, including those replayed into a restored cycle.
+    std::uint64_t ticks() const { return ticks_; }
+
+    /*
+     * Everything step() carries from one tick to the next: estimator
+     * histories and predictor, safety accounting, vault, current rate
+     * (checkpoint_codec.hpp; cluster_replication.hpp streams it).  A
+     * delta (full = false) must be taken exactly one step() after the
+     * previous checkpoint and applied to a cycle restored to that one.
+     * Profile, class and logger are not included; a restored cycle is
+     * built with the originals.  false if `in` is malformed or does not
+     * follow this cycle's state, which is then unusable.
+     */
+    void save_checkpoint(CheckpointWriter& out, bool full) const;
+    bool restore_checkpoint(CheckpointReader& in, bool full);
+
+private:
+    void update_vault(Telemetry& measurement, double dt_seconds);
+    void emit_alerts(const CycleResult& result);
+
+    PatientProfile profile_;
+    std::unique_ptr<ControlPipeline> pipeline_;
+    SystemLogger logger_;
+
+    ai_iv::domains::metabojoint::MetaboJointVault vault_;
+    bool steric_cage_was_breached_ = false;
+    double current_infusion_rate_ = 0.4;
+    std::uint64_t ticks_ = 0;
+    ControlLoopMetrics* loop_metrics_ = nullptr;
+    UncertaintyEngine* uncertainty_ = nullptr;
+};
+
+} // namespace ivsys
@@ -0,0 +1,152 @@
+#pragma once
+
+/*
+ * control_policy.hpp
+ *
+ * Compile-time control policies, one per patient class.
+ *
+ * SafetyMonitor, AdaptiveController and StateEstimator take their limits
+ * and energy proxy from a policy type:
+ *
+ * - TunedPolicy carries a run-time config::ControlTuning.  It is what the
+ *   SafetyMonitor / AdaptiveController / StateEstimator names stand for,
+ *   and what replay, what-if and the fuzzer use to vary thresholds.
+ * - PatientClassPolicy<C> fixes the limits of a patient class as a
+ *   constexpr ControlTuning and picks its energy-proxy strategy by type,
+ *   so each class compiles to its own pipeline with the constants folded
+ *   in and no per-tick branch on the class.
+ *
+ * Every class ships in the same binary; PatientControlCycle picks one per
+ * patient when it is built.  patient_class_tuning() exposes the same
+ * limits at run time, so replaying a session with TunedPolicy and the
+ * class's tuning reproduces its decisions exactly.
+ *
+ * SIMULATION: the class limits below are illustrative simulation
+ * parameters, not clinical dosing guidance.  The 24 h volume factors
+ * still follow the profile's cardiac_condition / renal_impairment flags.
+ */
+
+#include "config_defaults.hpp"
+#include "iv_system_types.hpp"
+#include "StateEstimator.hpp"
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+namespace ivsys {
+
+// Adding a class means adding it here, in patient_class_tuning() and the
+// name table, and to the explicit instantiations in SafetyMonitor.cpp,
+// AdaptiveController.cpp, uncertainty_engine.cpp and control_cycle.cpp.
+enum class PatientClass : std::uint8_t {
+    Standard,    // the compile-time defaults of config_defaults.hpp
+    Cardiac,
+    Renal,
+    Pediatric,
+};
+
+constexpr PatientClass kPatientClasses[] = {
+    PatientClass::Standard, PatientClass::Cardiac, PatientClass::Renal, PatientClass::Pediatric,
+};
+
+constexpr config::ControlTuning patient_class_tuning(PatientClass c) {
+    config::ControlTuning t;
+    switch (c) {
+        case PatientClass::Standard:
+            break;
+        case PatientClass::Cardiac:
+            // Smaller steps, earlier cardiac and tachycardia limiting
+            t.max_rate_change_ml_min      = 0.2;
+            t.min_cardiac_reserve         = 0.3;
+            t.low_cardiac_rate_cap        = 0.4;
+            t.tachycardia_hr_multiplier   = 1.3;
+            t.tachycardia_rate_cap        = 0.3;
+            t.volume_approach_fraction    = 0.85;
+            t.base_rate_gain              = 1.1;
+            t.predictive_boost_multiplier = 1.1;
+            t.cardiac_limit_threshold     = 0.4;
+            break;
+        case PatientClass::Renal:
+            // Volume limiting starts earlier and bites harder
+            t.volume_approach_fraction = 0.8;
+            t.volume_limit_rate_cap    = 0.2;
+            t.high_risk_rate_cap       = 0.5;
+            t.base_rate_gain           = 1.2;
+            break;
+        case PatientClass::Pediatric:
+            // Gentler gains; a higher resting HR is normal
+            t.max_rate_change_ml_min    = 0.15;
+            t.base_rate_floor_ml_min    = 0.2;
+            t.base_rate_gain            = 0.8;
+            t.tachycardia_hr_multiplier = 1.5;
+            t.high_risk_rate_cap        = 0.4;
+            // The neural proxy was fit to adult telemetry
+            t.neural_energy_proxy       = false;
+            break;
+    }
+    return t;
+}
+
+inline const char* patient_class_name(PatientClass c) {
+    switch (c) {
+        case PatientClass::Standard:  return "standard";
+        case PatientClass::Cardiac:   return "cardiac";
+        case PatientClass::Renal:     return "renal";
+        case PatientClass::Pediatric: return "pediatric";
+    }
+    return "unknown";
+}
+
+// Inverse of patient_class_name(); false leaves out untouched.
+inline bool parse_patient_class(const std::string& name, PatientClass& out) {
+    for (PatientClass c : kPatientClasses) {
+        if (name == patient_class_name(c)) {
+            out = c;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Class implied by a profile: pediatric under 18, then cardiac, renal,
+// standard.  A profile with no age set (0) counts as an adult.
+inline PatientClass select_patient_class(const PatientProfile& profile) {
+    if (profile.age_years > 0.0 && profile.age_years < 18.0) return PatientClass::Pediatric;
+    if (profile.cardiac_condition) return PatientClass::Cardiac;
+    if (profile.renal_impairment) return PatientClass::Renal;
+    return PatientClass::Standard;
+}
+
+// Limits chosen at run time.
+class TunedPolicy {
+public:
+    using Energy = ModelEnergy;
+
+    TunedPolicy(const config::ControlTuning& tuning = config::ControlTuning{}) : tuning_(tuning) {}
+
+    const config::ControlTuning& limits() const { return tuning_; }
+
+private:
+    config::ControlTuning tuning_;
+};
+
+// Limits fixed at compile time for one patient class.
+template <PatientClass C>
+struct PatientClassPolicy {
+    static constexpr PatientClass patient_class = C;
+    static constexpr config::ControlTuning kLimits = patient_class_tuning(C);
+    using Energy = std::conditional_t<kLimits.neural_energy_proxy, ModelEnergy, RuleEnergy>;
+
+    static constexpr const config::ControlTuning& limits() { return kLimits; }
+};
+
+// The estimator a policy's pipeline uses.
+template <typename Policy>
+using PolicyStateEstimator = BasicStateEstimator<typename Policy::Energy>;
+
+using StandardPolicy  = PatientClassPolicy<PatientClass::Standard>;
+using CardiacPolicy   = PatientClassPolicy<PatientClass::Cardiac>;
+using RenalPolicy     = PatientClassPolicy<PatientClass::Renal>;
+using PediatricPolicy = PatientClassPolicy<PatientClass::Pediatric>;
+
+} // namespace ivsys
@@ -0,0 +1,169 @@
+#include "control_text.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+
+namespace ivsys {
+
+namespace {
+
+// Check order in SafetyMonitor::evaluate, so rendering in table order
+// reproduces the original token sequence.
+struct WarningToken {
+    WarningFlag flag;
+    const char* token;
+};
+constexpr WarningToken kWarningTokens[] = {
+    {WarningFlag::VolumeLimitApproach, "VOLUME_LIMIT_APPROACH"},
+    {WarningFlag::LowCardiacReserve, "LOW_CARDIAC_RESERVE"},
+    {WarningFlag::RateChangeLimited, "RATE_CHANGE_LIMITED"},
+    {WarningFlag::HighRiskState, "HIGH_RISK_STATE"},
+    {WarningFlag::TachycardiaDetected, "TACHYCARDIA_DETECTED"},
+    {WarningFlag::EmergencyMinRate, "EMERGENCY_MIN_RATE"},
+    {WarningFlag::Other, "OTHER_WARNING"},
+};
+
+// Appends to a fixed buffer, keeping it NUL-terminated and dropping what
+// does not fit.
+struct BufferWriter {
+    char* buf;
+    size_t cap;
+    size_t len = 0;
+
+    void append(const char* text) {
+        size_t n = std::strlen(text);
+        if (len + 1 >= cap) return;
+        n = std::min(n, cap - 1 - len);
+        std::memcpy(buf + len, text, n);
+        len += n;
+        buf[len] = '\0';
+    }
+    void append_fixed2(double value) {
+        if (len + 1 >= cap) return;
+        int n = std::snprintf(buf + len, cap - len, "%.2f", value);
+        if (n > 0) len = std::min(len + static_cast<size_t>(n), cap - 1);
+    }
+};
+
+} // namespace
+
+const char* warning_token(WarningFlag flag) {
+    for (const auto& w : kWarningTokens) {
+        if (w.flag == flag) return w.token;
+    }
+    return "OTHER_WARNING";
+}
+
+WarningFlags parse_warnings(const std::string& text) {
+    WarningFlags flags;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t start = text.find_first_not_of(" \t\r\n", pos);
+        if (start == std::string::npos) break;
+        size_t end = text.find_first_of(" \t\r\n", start);
+        if (end == std::string::npos) end = text.size();
+        WarningFlag flag = WarningFlag::Other;
+        for (const auto& w : kWarningTokens) {
+            if (text.compare(start, end - start, w.token) == 0) {
+                flag = w.flag;
+                break;
+            }
+        }
+        flags.set(flag);
+        pos = end;
+    }
+    return flags;
+}
+
+void write_warnings(std::ostream& os, WarningFlags flags) {
+    for (const auto& w : kWarningTokens) {
+        if (flags.has(w.flag)) os << w.token << ' ';
+    }
+}
+
+void write_rationale(std::ostream& os, const Rationale& r) {
+    switch (r.code) {
+        case RationaleCode::None:
+            return;
+        case RationaleCode::Custom:
+            if (r.text) os << r.text;
+            return;
+        case RationaleCode::Controller:
+            break;
+    }
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << std::fixed << std::setprecision(2);
+    os << "H=" << r.hydration_pct << "% ";
+    os << "E_T=" << r.energy_T << " ";
+    os << "T=" << r.energy_T_absolute << "W/kg ";
+    os << "R=" << r.risk_score << " ";
+    os << "C_res=" << r.cardiac_reserve << " ";
+    os << "σ=" << r.coherence_sigma << " ";
+    os << "v=" << r.flow_velocity_cm_s << "cm/s ";
+    os << "G(v)=" << r.flow_efficiency << " ";
+    os << "u=" << r.rate_ml_min << "ml/min";
+    if (r.safety_limited) os << " [SAFETY_LIM]";
+    if (r.predictive_boost) os << " [PRED_BOOST]";
+    os.flags(flags);
+    os.precision(precision);
+}
+
+size_t format_warnings(char* buf, size_t cap, WarningFlags flags) {
+    if (cap == 0) return 0;
+    BufferWriter w{buf, cap};
+    buf[0] = '\0';
+    for (const auto& t : kWarningTokens) {
+        if (flags.has(t.flag)) {
+            w.append(t.token);
+            w.append(" ");
+        }
+    }
+    return w.len;
+}
+
+size_t format_rationale(char* buf, size_t cap, const Rationale& r) {
+    if (cap == 0) return 0;
+    BufferWriter w{buf, cap};
+    buf[0] = '\0';
+    switch (r.code) {
+        case RationaleCode::None:
+            return 0;
+        case RationaleCode::Custom:
+            if (r.text) w.append(r.text);
+            return w.len;
+        case RationaleCode::Controller:
+            break;
+    }
+    // Same sequence as write_rationale(); printf's %.2f is what the
+    // stream's fixed/precision(2) formatting produces.
+    w.append("H="); w.append_fixed2(r.hydration_pct); w.append("% ");
+    w.append("E_T="); w.append_fixed2(r.energy_T); w.append(" ");
+    w.append("T="); w.append_fixed2(r.energy_T_absolute); w.append("W/kg ");
+    w.append("R="); w.append_fixed2(r.risk_score); w.append(" ");
+    w.append("C_res="); w.append_fixed2(r.cardiac_reserve); w.append(" ");
+    w.append("σ="); w.append_fixed2(r.coherence_sigma); w.append(" ");
+    w.append("v="); w.append_fixed2(r.flow_velocity_cm_s); w.append("cm/s ");
+    w.append("G(v)="); w.append_fixed2(r.flow_efficiency); w.append(" ");
+    w.append("u="); w.append_fixed2(r.rate_ml_min); w.append("ml/min");
+    if (r.safety_limited) w.append(" [SAFETY_LIM]");
+    if (r.predictive_boost) w.append(" [PRED_BOOST]");
+    return w.len;
+}
+
+std::string to_string(WarningFlags flags) {
+    std::ostringstream oss;
+    write_warnings(oss, flags);
+    return oss.str();
+}
+
+std::string to_string(const Rationale& rationale) {
+    std::ostringstream oss;
+    write_rationale(oss, rationale);
+    return oss.str();
+}
+
+} // namespace ivsys
@@ -0,0 +1,47 @@
+#pragma once
+
+/*
+ * control_text.hpp
+ *
+ * Text forms of WarningFlags and Rationale (iv_system_types.hpp).
+ *
+ * The control tick carries only bits and numbers; these render them where
+ * text is needed (CSV rows, the system log, REST bodies, the console).
+ *   warnings:  "VOLUME_LIMIT_APPROACH HIGH_RISK_STATE "  (each token plus a
+ *              space, in check order; unknown bits as OTHER_WARNING)
+ *   rationale: "H=65.00% E_T=0.81 T=1.80W/kg R=0.11 C_res=0.99 σ=0.94
+ *               v=2.28cm/s G(v)=0.00 u=0.77ml/min [SAFETY_LIM] [PRED_BOOST]"
+ * The stream writers and format_* never allocate; to_string() is for cold
+ * paths and tests.
+ */
+
+#include "iv_system_types.hpp"
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+namespace ivsys {
+
+// format_warnings() output always fits; format_rationale() output fits
+// unless a field is far outside its physiological range.
+constexpr size_t kWarningTextCapacity = 160;
+constexpr size_t kRationaleTextCapacity = 256;
+
+const char* warning_token(WarningFlag flag);
+
+// Space-separated tokens as written by write_warnings(); an unknown token
+// sets WarningFlag::Other.
+WarningFlags parse_warnings(const std::string& text);
+
+void write_warnings(std::ostream& os, WarningFlags flags);
+void write_rationale(std::ostream& os, const Rationale& rationale);
+
+// NUL-terminated, truncated to cap - 1 characters; returns the length
+// written.
+size_t format_warnings(char* buf, size_t cap, WarningFlags flags);
+size_t format_rationale(char* buf, size_t cap, const Rationale& rationale);
+
+std::string to_string(WarningFlags flags);
+std::string to_string(const Rationale& rationale);
+
+} // namespace ivsys
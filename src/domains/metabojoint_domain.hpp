@@ -8,6 +8,21 @@ namespace ai_iv {
 namespace domains {
 namespace metabojoint {
 
+/**
+ * @brief Vault parameterization.  The defaults are the V3.1 constants; the
+ * population studies in metabojoint_population.hpp sweep them.
+ */
+struct VaultParams {
+    // --- V3.1 Physical Constants ---
+    double hydrodynamic_radius_nm = 9.0;  // Cas9 RNP R_H
+    double overlap_param_y = 1.0;         // CBMA Critical overlap
+    double vol_fraction_v2s = 0.18;       // Equilibrium swollen vol fraction
+    double cleavage_ph_max = 7.1;         // Cathepsin K active at or below this pH
+    double cathepsin_threshold = 0.1;     // ... and above this activity
+    double cleavage_gain_pct = 2.0;       // Cleavage per tick at full activity
+    double release_gain_per_min = 0.8;    // Elution rate per unit efficiency
+};
+
 /**
  * @brief Pre-clinical deterministic state estimator and safety monitor 
  * for the MetaboJoint V3.1 in vivo delivery substrate.
@@ -16,10 +31,8 @@ namespace metabojoint {
  */
 class MetaboJointVault {
 private:
-    // --- V3.1 Immutable Physical Constants ---
-    static constexpr double HYDRODYNAMIC_RADIUS_NM = 9.0; // Cas9 RNP R_H
-    static constexpr double OVERLAP_PARAM_Y = 1.0;        // CBMA Critical overlap
-    static constexpr double VOL_FRACTION_V2S = 0.18;      // Equilibrium swollen vol fraction
+    // --- Physical Parameters (V3.1 constants by default) ---
+    VaultParams params_;
     
     // --- Bounded State Variables ---
     double current_mesh_size_nm = 2.0;    // Sealed state at pH 7.4
@@ -28,6 +41,7 @@ private:
 
 public:
     MetaboJointVault() = default;
+    explicit MetaboJointVault(const VaultParams& params) : params_(params) {}
 
     /**
      * @brief Updates the biochemical telemetry and recalculates the structural state.
@@ -41,9 +55,9 @@ public:
 
         // State Estimation: Calculate cleavage progression (simplified proxy model)
         // In the marrow niche (pH ~6.5 - 7.1), Cathepsin K becomes highly active
-        if (ambient_ph <= 7.1 && cathepsin_k_activity > 0.1) {
+        if (ambient_ph <= params_.cleavage_ph_max && cathepsin_k_activity > params_.cathepsin_threshold) {
              // Incremental cleavage modeled per tick
-             cleavage_progression_pct = std::clamp(cleavage_progression_pct + (cathepsin_k_activity * 2.0), 0.0, 100.0);
+             cleavage_progression_pct = std::clamp(cleavage_progression_pct + (cathepsin_k_activity * params_.cleavage_gain_pct), 0.0, 100.0);
         }
 
         // State Estimation: Peppas-Rehner Mesh Expansion
@@ -58,13 +72,13 @@ public:
     [[nodiscard]] double calculate_fickian_efficiency() const {
         // SAFETY MONITOR: The Steric Trap (Hard Constraint)
         // If the mesh is smaller than the payload, diffusion is strictly 0.0
-        if (current_mesh_size_nm <= HYDRODYNAMIC_RADIUS_NM) {
+        if (current_mesh_size_nm <= params_.hydrodynamic_radius_nm) {
             return 0.0; 
         }
 
         // CONTROLLER: Lustig-Peppas Fickian Diffusion Model
-        double fractional_escape = 1.0 - (HYDRODYNAMIC_RADIUS_NM / current_mesh_size_nm);
-        double hydration_penalty = std::exp(-OVERLAP_PARAM_Y * (VOL_FRACTION_V2S / (1.0 - VOL_FRACTION_V2S)));
+        double fractional_escape = 1.0 - (params_.hydrodynamic_radius_nm / current_mesh_size_nm);
+        double hydration_penalty = std::exp(-params_.overlap_param_y * (params_.vol_fraction_v2s / (1.0 - params_.vol_fraction_v2s)));
         
         return fractional_escape * hydration_penalty;
     }
@@ -78,7 +92,7 @@ public:
         double d_ratio = calculate_fickian_efficiency();
         
         // Elution rate is proportional to diffusion efficiency and remaining gradient
-        double release_rate = 0.8 * d_ratio * current_payload_pct; 
+        double release_rate = params_.release_gain_per_min * d_ratio * current_payload_pct; 
         double release_amount = release_rate * (dt_seconds / 60.0); // scaled per minute
 
         release_amount = std::clamp(release_amount, 0.0, current_payload_pct);
@@ -90,7 +104,19 @@ public:
     // --- Observability Getters ---
     [[nodiscard]] double get_mesh_size() const { return current_mesh_size_nm; }
     [[nodiscard]] double get_payload_remaining() const { return current_payload_pct; }
-    [[nodiscard]] bool is_steric_cage_breached() const { return current_mesh_size_nm > HYDRODYNAMIC_RADIUS_NM; }
+    [[nodiscard]] bool is_steric_cage_breached() const { return current_mesh_size_nm > params_.hydrodynamic_radius_nm; }
+    [[nodiscard]] double get_cleavage_progression() const { return cleavage_progression_pct; }
+    [[nodiscard]] const VaultParams& params() const { return params_; }
+
+    /**
+     * @brief Reinstates state captured from the getters above (cluster
+     * replication).  Values are clamped to the same bounds the tick enforces.
+     */
+    void restore_state(double mesh_size_nm, double cleavage_progression, double payload_remaining) {
+        current_mesh_size_nm = std::clamp(mesh_size_nm, 2.0, 12.0);
+        cleavage_progression_pct = std::clamp(cleavage_progression, 0.0, 100.0);
+        current_payload_pct = std::clamp(payload_remaining, 0.0, 100.0);
+    }
 };
 
 } // namespace metabojoint
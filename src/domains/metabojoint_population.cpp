@@ -0,0 +1,283 @@
+#include "metabojoint_population.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace ai_iv {
+namespace domains {
+namespace metabojoint {
+
+namespace {
+
+// Telemetry for padding lanes: sealed vault, no cleavage.
+constexpr double kIdlePh = 7.4;
+// Most phase-2 steps between checks for a payload fixed point.
+constexpr size_t kFixedPointStride = 64;
+
+// std::clamp as two flat selects (a nested one is split into per-lane
+// branches).  Identical to std::clamp whenever lo <= hi, which holds for
+// every range used here (p never goes negative).
+template <typename V>
+inline V clamp_lanes(V x, V lo, V hi) {
+    x = x < lo ? lo : x;
+    return hi < x ? hi : x;
+}
+
+} // namespace
+
+VaultPopulation::VaultPopulation(size_t count, const VaultParams& params) {
+    init(std::vector<VaultParams>(count, params));
+}
+
+VaultPopulation::VaultPopulation(const std::vector<VaultParams>& params) {
+    init(params);
+}
+
+void VaultPopulation::init(const std::vector<VaultParams>& params) {
+    count_ = params.size();
+    size_t blocks = (count_ + kLanes - 1) / kLanes;
+    blocks_ = (blocks + kTile - 1) / kTile * kTile;
+    for (std::vector<Lanes>* column : {&radius_, &ph_max_, &cathepsin_threshold_, &cleavage_gain_,
+                                       &release_gain_, &hydration_penalty_, &mesh_, &cleavage_,
+                                       &payload_, &ph_in_, &cathepsin_in_}) {
+        column->assign(blocks_, Lanes{});
+    }
+
+    const VaultParams idle;
+    const MetaboJointVault sealed;
+    for (size_t i = 0; i < blocks_ * kLanes; ++i) {
+        const VaultParams& p = i < count_ ? params[i] : idle;
+        size_t b = i / kLanes, l = i % kLanes;
+        radius_[b][l] = p.hydrodynamic_radius_nm;
+        ph_max_[b][l] = p.cleavage_ph_max;
+        cathepsin_threshold_[b][l] = p.cathepsin_threshold;
+        cleavage_gain_[b][l] = p.cleavage_gain_pct;
+        release_gain_[b][l] = p.release_gain_per_min;
+        // Same expression as calculate_fickian_efficiency(), so the same value
+        hydration_penalty_[b][l] = std::exp(-p.overlap_param_y * (p.vol_fraction_v2s / (1.0 - p.vol_fraction_v2s)));
+        mesh_[b][l] = sealed.get_mesh_size();
+        cleavage_[b][l] = sealed.get_cleavage_progression();
+        payload_[b][l] = sealed.get_payload_remaining();
+    }
+}
+
+// --- Lane kernels ---------------------------------------------------------
+// Each mirrors one statement of MetaboJointVault, in the same operation
+// order, with std::clamp's comparisons.
+
+void VaultPopulation::stage_telemetry(const double* ambient_ph, const double* cathepsin_k_activity,
+                                      double ph_all, double cathepsin_all) {
+    for (size_t i = 0; i < blocks_ * kLanes; ++i) {
+        size_t b = i / kLanes, l = i % kLanes;
+        bool vault = i < count_;
+        ph_in_[b][l] = !vault ? kIdlePh : ambient_ph ? ambient_ph[i] : ph_all;
+        cathepsin_in_[b][l] = !vault ? 0.0 : cathepsin_k_activity ? cathepsin_k_activity[i] : cathepsin_all;
+    }
+    const Lanes zero = {}, one = zero + 1.0, eight = zero + 8.0;
+    for (size_t b = 0; b < blocks_; ++b) {
+        ph_in_[b] = clamp_lanes(ph_in_[b], one, eight);
+        cathepsin_in_[b] = clamp_lanes(cathepsin_in_[b], zero, one);
+    }
+}
+
+void VaultPopulation::update_telemetry(const double* ambient_ph, const double* cathepsin_k_activity) {
+    stage_telemetry(ambient_ph, cathepsin_k_activity, 0.0, 0.0);
+    apply_telemetry();
+}
+
+void VaultPopulation::update_telemetry(double ambient_ph, double cathepsin_k_activity) {
+    stage_telemetry(nullptr, nullptr, ambient_ph, cathepsin_k_activity);
+    apply_telemetry();
+}
+
+void VaultPopulation::apply_telemetry() {
+    const Lanes zero = {}, hundred = zero + 100.0;
+    for (size_t b = 0; b < blocks_; ++b) {
+        Lanes ph = ph_in_[b], cat = cathepsin_in_[b];
+        Lanes c = cleavage_[b];
+        Lanes next = c + cat * cleavage_gain_[b];
+        next = clamp_lanes(next, zero, hundred);
+        c = (ph <= ph_max_[b]) & (cat > cathepsin_threshold_[b]) ? next : c;
+        cleavage_[b] = c;
+        mesh_[b] = 2.0 + (10.0 * (c / 100.0));
+    }
+}
+
+double VaultPopulation::tick_elution(double dt_seconds, double* released) {
+    const Lanes zero = {};
+    const double minutes = dt_seconds / 60.0;
+    double total = 0.0;
+    for (size_t b = 0; b < blocks_; ++b) {
+        Lanes m = mesh_[b], r = radius_[b], p = payload_[b];
+        Lanes efficiency = m <= r ? zero : (1.0 - (r / m)) * hydration_penalty_[b];
+        Lanes amount = release_gain_[b] * efficiency * p * minutes;
+        amount = clamp_lanes(amount, zero, p);
+        payload_[b] = p - amount;
+        for (size_t l = 0; l < kLanes && b * kLanes + l < count_; ++l) {
+            if (released) released[b * kLanes + l] = amount[l];
+            total += amount[l];
+        }
+    }
+    ++ticks_;
+    elapsed_seconds_ += dt_seconds;
+    return total;
+}
+
+size_t VaultPopulation::breached_count() const {
+    size_t n = 0;
+    for (size_t i = 0; i < count_; ++i) n += is_steric_cage_breached(i);
+    return n;
+}
+
+// --- Fast-forward ---------------------------------------------------------
+
+void VaultPopulation::fast_forward(size_t steps, double dt_seconds, double ambient_ph,
+                                   double cathepsin_k_activity, ElutionCurve* curve, size_t record_every) {
+    stage_telemetry(nullptr, nullptr, ambient_ph, cathepsin_k_activity);
+    advance(steps, dt_seconds, curve, record_every);
+}
+
+void VaultPopulation::fast_forward(size_t steps, double dt_seconds, const double* ambient_ph,
+                                   const double* cathepsin_k_activity, ElutionCurve* curve,
+                                   size_t record_every) {
+    stage_telemetry(ambient_ph, cathepsin_k_activity, 0.0, 0.0);
+    advance(steps, dt_seconds, curve, record_every);
+}
+
+void VaultPopulation::advance(size_t steps, double dt_seconds, ElutionCurve* curve, size_t record_every) {
+    if (steps == 0) return;
+    record_every = record_every ? record_every : 1;
+
+    // The clock and sample times, advanced exactly as tick_elution() does.
+    size_t first_sample = 0;
+    if (curve) {
+        if (curve->vaults != count_) {
+            curve->vaults = count_;
+            curve->elapsed_seconds.clear();
+            curve->payload_pct.clear();
+        }
+        first_sample = curve->samples();
+    }
+    std::uint64_t start_tick = ticks_;
+    for (size_t i = 0; i < steps; ++i) {
+        ++ticks_;
+        elapsed_seconds_ += dt_seconds;
+        if (curve && ticks_ % record_every == 0) curve->elapsed_seconds.push_back(elapsed_seconds_);
+    }
+    if (curve) curve->payload_pct.resize(curve->samples() * count_);
+
+    // Step i is tick start_tick + i + 1; the first one to record:
+    size_t first_record = static_cast<size_t>((record_every - (start_tick + 1) % record_every) % record_every);
+    for (size_t t = 0; t < blocks_ / kTile; ++t) {
+        advance_tile(t, steps, dt_seconds, ph_in_.data() + t * kTile, cathepsin_in_.data() + t * kTile,
+                     curve, first_sample, record_every, first_record);
+    }
+}
+
+void VaultPopulation::advance_tile(size_t tile, size_t steps, double dt_seconds, const Lanes* ph,
+                                   const Lanes* cathepsin, ElutionCurve* curve, size_t first_sample,
+                                   size_t record_every, size_t first_record) {
+    const Lanes zero = {}, hundred = zero + 100.0;
+    const double minutes = dt_seconds / 60.0;
+    const size_t base = tile * kTile;
+
+    Lanes c[kTile], m[kTile], p[kTile], inc[kTile], r[kTile], pen[kTile], gain[kTile];
+    decltype(zero < zero) active[kTile];
+    for (size_t k = 0; k < kTile; ++k) {
+        c[k] = cleavage_[base + k];
+        m[k] = mesh_[base + k];
+        p[k] = payload_[base + k];
+        r[k] = radius_[base + k];
+        pen[k] = hydration_penalty_[base + k];
+        gain[k] = release_gain_[base + k];
+        inc[k] = cathepsin[k] * cleavage_gain_[base + k];
+        active[k] = (ph[k] <= ph_max_[base + k]) & (cathepsin[k] > cathepsin_threshold_[base + k]);
+    }
+
+    size_t next_record = curve ? first_record : steps;
+    size_t row = first_sample;
+    auto record = [&](size_t i) {
+        if (i != next_record) return;
+        double* out = curve->payload_pct.data() + row * curve->vaults;
+        for (size_t k = 0; k < kTile; ++k) {
+            for (size_t l = 0; l < kLanes; ++l) {
+                size_t v = (base + k) * kLanes + l;
+                if (v < count_) out[v] = p[k][l];
+            }
+        }
+        ++row;
+        next_record += record_every;
+    };
+
+    // Phase 1: cleavage still moving, so the mesh and efficiency follow it.
+    size_t i = 0;
+    bool settled = false;
+    for (; i < steps && !settled; ++i) {
+        decltype(zero < zero) moved = {};
+        for (size_t k = 0; k < kTile; ++k) {
+            Lanes next = c[k] + inc[k];
+            next = clamp_lanes(next, zero, hundred);
+            next = active[k] ? next : c[k];
+            moved |= next != c[k];
+            c[k] = next;
+            m[k] = 2.0 + (10.0 * (c[k] / 100.0));
+            Lanes efficiency = m[k] <= r[k] ? zero : (1.0 - (r[k] / m[k])) * pen[k];
+            Lanes amount = gain[k] * efficiency * p[k] * minutes;
+            amount = clamp_lanes(amount, zero, p[k]);
+            p[k] = p[k] - amount;
+        }
+        record(i);
+        settled = true;
+        for (size_t l = 0; l < kLanes; ++l) settled = settled && moved[l] == 0;
+    }
+
+    // Phase 2: cleavage at a fixed point, so the efficiency is too (the
+    // same deterministic function of an unchanged mesh).  Only the payload
+    // recurrence remains.
+    Lanes k_rate[kTile];
+    for (size_t k = 0; k < kTile; ++k) {
+        Lanes efficiency = m[k] <= r[k] ? zero : (1.0 - (r[k] / m[k])) * pen[k];
+        k_rate[k] = gain[k] * efficiency;
+    }
+    // With a non-negative rate and dt the amount is never below zero (the
+    // payload never is), so the lower clamp can be skipped for the span.
+    bool nonnegative = minutes >= 0.0;
+    for (size_t k = 0; k < kTile; ++k) {
+        for (size_t l = 0; l < kLanes; ++l) nonnegative = nonnegative && k_rate[k][l] >= 0.0;
+    }
+    auto release = [&](Lanes* payload) {
+        for (size_t k = 0; k < kTile; ++k) {
+            Lanes amount = k_rate[k] * payload[k] * minutes;
+            if (nonnegative) amount = payload[k] < amount ? payload[k] : amount;
+            else amount = clamp_lanes(amount, zero, payload[k]);
+            payload[k] = payload[k] - amount;
+        }
+    };
+    // Chunks end at the next recorded tick or after kFixedPointStride
+    // steps; the chunk's last step is compared with the one before.
+    bool fixed = false;
+    while (i < steps && !fixed) {
+        size_t stop = std::min(std::min(steps, i + kFixedPointStride), next_record + 1);
+        for (; i + 1 < stop; ++i) release(p);
+        Lanes before[kTile];
+        for (size_t k = 0; k < kTile; ++k) before[k] = p[k];
+        release(p);
+        record(i++);
+        decltype(zero < zero) changed = {};
+        for (size_t k = 0; k < kTile; ++k) changed |= before[k] != p[k];
+        fixed = true;
+        for (size_t l = 0; l < kLanes; ++l) fixed = fixed && changed[l] == 0;
+    }
+
+    // Phase 3: nothing changes any more.
+    while (next_record < steps) record(next_record);
+
+    for (size_t k = 0; k < kTile; ++k) {
+        cleavage_[base + k] = c[k];
+        mesh_[base + k] = m[k];
+        payload_[base + k] = p[k];
+    }
+}
+
+} // namespace metabojoint
+} // namespace domains
+} // namespace ai_iv
@@ -0,0 +1,138 @@
+#pragma once
+
+/*
+ * metabojoint_population.hpp
+ *
+ * Structure-of-arrays population of MetaboJoint vaults for pre-clinical
+ * parameter and trajectory sweeps.
+ *
+ * Every vault has its own VaultParams and state.  Columns are stored as
+ * kLanes-wide GCC vectors, and the steric-trap and cleavage conditions are lane
+ * selects, not branches. The padding lanes of the last block run as default
+ * vaults and are never reported.
+ *
+ * Equivalence contract: after any sequence of update_telemetry() /
+ * tick_elution() calls, vault i holds exactly (bit for bit) the state of a
+ * MetaboJointVault(params[i]) given the same calls. fast_forward() is the
+ * same as calling update_telemetry() then tick_elution() `steps` times.
+ * It keeps each tile of vaults in registers for the whole span. It stops
+ * recomputing the mesh once cleavage reaches a fixed point, and stops
+ * altogether once the payload stops changing.
+ */
+
+#include "metabojoint_domain.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ai_iv {
+namespace domains {
+namespace metabojoint {
+
+/**
+ * @brief Payload remaining per vault, sampled every `record_every` ticks.
+ */
+struct ElutionCurve {
+    size_t vaults = 0;
+    std::vector<double> elapsed_seconds;   // one per sample
+    std::vector<double> payload_pct;       // samples x vaults, row-major
+
+    [[nodiscard]] size_t samples() const { return elapsed_seconds.size(); }
+    [[nodiscard]] double payload(size_t sample, size_t vault) const {
+        return payload_pct[sample * vaults + vault];
+    }
+};
+
+class VaultPopulation {
+public:
+    static constexpr size_t kLanes = 2;   // doubles per vector (one SSE2 register)
+    static constexpr size_t kTile = 16;    // vectors advanced together by fast_forward()
+
+    explicit VaultPopulation(size_t count, const VaultParams& params = VaultParams{});
+    explicit VaultPopulation(const std::vector<VaultParams>& params);
+
+    [[nodiscard]] size_t size() const { return count_; }
+
+    /**
+     * @brief MetaboJointVault::update_telemetry for every vault.
+     * @param ambient_ph, cathepsin_k_activity size() values each
+     */
+    void update_telemetry(const double* ambient_ph, const double* cathepsin_k_activity);
+    // The same telemetry for every vault
+    void update_telemetry(double ambient_ph, double cathepsin_k_activity);
+
+    /**
+     * @brief MetaboJointVault::tick_elution for every vault.
+     * @param released If non-null, receives size() per-vault release amounts
+     * @return Total payload released across the population
+     */
+    double tick_elution(double dt_seconds, double* released = nullptr);
+
+    /**
+     * @brief Advances every vault `steps` ticks of dt_seconds under constant
+     * per-vault telemetry (one segment of a piecewise-constant trajectory).
+     * @param curve If non-null, a sample is appended whenever the total tick
+     * count reaches a multiple of record_every.
+     */
+    void fast_forward(size_t steps, double dt_seconds, const double* ambient_ph,
+                      const double* cathepsin_k_activity, ElutionCurve* curve = nullptr,
+                      size_t record_every = 1);
+    void fast_forward(size_t steps, double dt_seconds, double ambient_ph, double cathepsin_k_activity,
+                      ElutionCurve* curve = nullptr, size_t record_every = 1);
+
+    // --- Observability, per vault ---
+    [[nodiscard]] double mesh_size(size_t vault) const { return lane(mesh_, vault); }
+    [[nodiscard]] double payload_remaining(size_t vault) const { return lane(payload_, vault); }
+    [[nodiscard]] double cleavage_progression(size_t vault) const { return lane(cleavage_, vault); }
+    [[nodiscard]] bool is_steric_cage_breached(size_t vault) const {
+        return lane(mesh_, vault) > lane(radius_, vault);
+    }
+    [[nodiscard]] size_t breached_count() const;
+
+    [[nodiscard]] std::uint64_t ticks() const { return ticks_; }
+    [[nodiscard]] double elapsed_seconds() const { return elapsed_seconds_; }
+
+private:
+    typedef double Lanes __attribute__((vector_size(kLanes * sizeof(double))));
+
+    static double lane(const std::vector<Lanes>& column, size_t vault) {
+        return column[vault / kLanes][vault % kLanes];
+    }
+
+    void init(const std::vector<VaultParams>& params);
+    // Clamped per-vault telemetry into ph_in_ / cathepsin_in_; a null
+    // array means the *_all value for every vault.
+    void stage_telemetry(const double* ambient_ph, const double* cathepsin_k_activity,
+                         double ph_all, double cathepsin_all);
+    void apply_telemetry();
+    void advance(size_t steps, double dt_seconds, ElutionCurve* curve, size_t record_every);
+    void advance_tile(size_t tile, size_t steps, double dt_seconds, const Lanes* ph, const Lanes* cathepsin,
+                      ElutionCurve* curve, size_t first_sample, size_t record_every, size_t first_record);
+
+    size_t count_ = 0;
+    size_t blocks_ = 0;   // padded to a multiple of kTile
+
+    // Parameters
+    std::vector<Lanes> radius_;
+    std::vector<Lanes> ph_max_;
+    std::vector<Lanes> cathepsin_threshold_;
+    std::vector<Lanes> cleavage_gain_;
+    std::vector<Lanes> release_gain_;
+    std::vector<Lanes> hydration_penalty_;
+
+    // State
+    std::vector<Lanes> mesh_;
+    std::vector<Lanes> cleavage_;
+    std::vector<Lanes> payload_;
+
+    std::uint64_t ticks_ = 0;
+    double elapsed_seconds_ = 0.0;
+
+    // Staged telemetry
+    std::vector<Lanes> ph_in_;
+    std::vector<Lanes> cathepsin_in_;
+};
+
+} // namespace metabojoint
+} // namespace domains
+} // namespace ai_iv
@@ -0,0 +1,170 @@
+#include "feature_export.hpp"
+#include "session_format.hpp"
+#include "work_stealing_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <thread>
+#include <sys/stat.h>
+
+namespace ivsys {
+
+namespace {
+
+using feature_table::Column;
+using feature_table::ColumnType;
+
+constexpr double Telemetry::* kInputFields[] = {
+    &Telemetry::hydration_pct,
+    &Telemetry::heart_rate_bpm,
+    &Telemetry::temp_celsius,
+    &Telemetry::blood_loss_idx,
+    &Telemetry::fatigue_idx,
+    &Telemetry::anxiety_idx,
+    &Telemetry::signal_quality,
+    &Telemetry::spo2_pct,
+    &Telemetry::lactate_mmol,
+    &Telemetry::cardiac_output_L_min,
+};
+
+constexpr double PatientState::* kStateFields[] = {
+    &PatientState::coherence_sigma,
+    &PatientState::energy_T,
+    &PatientState::energy_T_absolute,
+    &PatientState::metabolic_load,
+    &PatientState::cardiac_reserve,
+    &PatientState::risk_score,
+    &PatientState::estimated_flow_velocity_cm_s,
+    &PatientState::flow_efficiency,
+    &PatientState::uncertainty,
+};
+
+std::vector<Column> make_schema() {
+    std::vector<Column> s;
+    // Telemetry CSV / export_reconstructed_state names
+    s.push_back({"timestamp_ns", ColumnType::Int64});
+    for (const char* name : {"hydration_pct", "heart_rate_bpm", "temp_celsius", "blood_loss_idx",
+                             "fatigue_idx", "anxiety_idx", "signal_quality", "spo2_pct",
+                             "lactate_mmol", "cardiac_output_L_min"}) {
+        s.push_back({name, ColumnType::Float64});
+    }
+    for (const char* name : {"coherence_sigma", "energy_T", "energy_T_abs_W_kg", "metabolic_load",
+                             "cardiac_reserve", "risk_score", "flow_velocity_cm_s",
+                             "flow_efficiency", "uncertainty"}) {
+        s.push_back({name, ColumnType::Float64});
+    }
+    s.push_back({"infusion_rate_ml_min", ColumnType::Float64});
+    s.push_back({"confidence", ColumnType::Float64});
+    s.push_back({"safety_override", ColumnType::Int64});
+    s.push_back({"warning_bits", ColumnType::Int64});
+    s.push_back({"cumulative_volume_ml", ColumnType::Float64});
+    return s;
+}
+
+std::uint64_t file_size(const std::string& path) {
+    struct stat st;
+    return !path.empty() && ::stat(path.c_str(), &st) == 0 ? static_cast<std::uint64_t>(st.st_size) : 0;
+}
+
+} // namespace
+
+FeatureExporter::FeatureExporter() : FeatureExporter(Options{}) {}
+
+FeatureExporter::FeatureExporter(const Options& options) : options_(options) {
+    if (options_.worker_threads == 0) {
+        options_.worker_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    options_.chunk_rows = std::max<size_t>(options_.chunk_rows, 1);
+    options_.replay.resolve_energy_model();
+}
+
+const std::vector<feature_table::Column>& FeatureExporter::schema() {
+    static const std::vector<Column> columns = make_schema();
+    return columns;
+}
+
+std::string FeatureExporter::output_path_for(const std::string& output_dir, const std::string& session_id) {
+    return (output_dir.empty() ? std::string(".") : output_dir) + "/" + session_id + feature_table::kFileSuffix;
+}
+
+size_t FeatureExporter::worker_buffer_bytes() const {
+    return options_.chunk_rows * sizeof(Telemetry) +
+           static_cast<size_t>(options_.row_group_rows) * schema().size() * sizeof(std::uint64_t);
+}
+
+FeatureExportFile FeatureExporter::export_session(const FeatureExportSession& session) const {
+    FeatureExportFile file;
+    file.session_id = session.info.session_id;
+    file.output_path = output_path_for(options_.output_dir, file.session_id);
+    file.from_binary = !session.info.binary_file.empty() && !options_.replay.prefer_csv;
+    file.input_bytes = file.from_binary ? file_size(session.info.binary_file)
+                                        : file_size(session.info.telemetry_file);
+    auto start = std::chrono::steady_clock::now();
+    try {
+        ReplayStepper stepper(session.profile, options_.replay);
+        feature_table::Writer writer(file.output_path, schema(), file.session_id, options_.row_group_rows);
+        ReplayLogger::stream_telemetry(session.info, options_.replay, options_.chunk_rows,
+            [&](const Telemetry* rows, size_t count) {
+                for (size_t i = 0; i < count; ++i) {
+                    const Telemetry& m = rows[i];
+                    PatientState s;
+                    ControlOutput c = stepper.step(m, stepper.dt_seconds(m), s);
+                    size_t col = 0;
+                    writer.set(col++, session_format::to_ns(m.timestamp));
+                    for (auto field : kInputFields) writer.set(col++, m.*field);
+                    for (auto field : kStateFields) writer.set(col++, s.*field);
+                    writer.set(col++, c.infusion_ml_per_min);
+                    writer.set(col++, c.confidence);
+                    writer.set(col++, static_cast<std::int64_t>(c.safety_override));
+                    writer.set(col++, static_cast<std::int64_t>(c.warning_flags.bits));
+                    writer.set(col++, stepper.cumulative_volume_ml());
+                    writer.end_row();
+                }
+            });
+        writer.close();
+        file.rows = static_cast<size_t>(writer.rows());
+        file.row_groups = writer.row_groups();
+        file.output_bytes = file_size(file.output_path);
+    } catch (const std::exception& e) {
+        file.error = e.what();
+    }
+    file.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return file;
+}
+
+FeatureExportResult FeatureExporter::run(const std::vector<FeatureExportSession>& sessions) const {
+    FeatureExportResult result;
+    result.files.resize(sessions.size());
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        WorkStealingPool pool(options_.worker_threads);
+        for (size_t s = 0; s < sessions.size(); ++s) {
+            pool.submit([this, s, &sessions, &result] {
+                result.files[s] = export_session(sessions[s]);
+            });
+        }
+        pool.wait_idle();
+        result.steals = pool.steal_count();
+    }
+    result.wall_seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    for (const FeatureExportFile& f : result.files) {
+        if (!f.error.empty()) {
+            ++result.failed;
+            continue;
+        }
+        ++result.exported;
+        result.rows += f.rows;
+        result.input_bytes += f.input_bytes;
+        result.output_bytes += f.output_bytes;
+    }
+    if (result.wall_seconds > 0.0) {
+        result.rows_per_sec = static_cast<double>(result.rows) / result.wall_seconds;
+        result.input_mb_per_sec = static_cast<double>(result.input_bytes) / 1e6 / result.wall_seconds;
+    }
+    return result;
+}
+
+} // namespace ivsys
@@ -0,0 +1,98 @@
+#pragma once
+
+/*
+ * feature_export.hpp
+ *
+ * Bulk export of recorded sessions to columnar training data.
+ *
+ * Every session is streamed through ReplayStepper (the same estimator ->
+ * precision spine -> controller -> safety monitor path as ReplayLogger)
+ * and written as one feature table, <output_dir>/<session_id>.aift
+ * (feature_table.hpp), holding per tick the telemetry inputs, the
+ * reconstructed PatientState and the replayed decision.  The columns are
+ * those of ReplayLogger::export_reconstructed_state() plus the raw inputs.
+ *
+ * Sessions are decoded in chunks of chunk_rows (ReplayLogger::
+ * stream_telemetry) and written in row groups, so a worker holds one
+ * chunk and one row group however long its session is; memory does not
+ * grow with the archive.  Sessions run in parallel on a WorkStealingPool,
+ * one task per file, and results are reported in session order.  A
+ * session's output depends only on its logs, not on the worker count or
+ * chunk size.
+ */
+
+#include "feature_table.hpp"
+#include "replay_logger.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ivsys {
+
+struct FeatureExportSession {
+    ReplaySessionInfo info;
+    PatientProfile profile;
+};
+
+struct FeatureExportFile {
+    std::string session_id;
+    std::string output_path;
+    std::string error;                 // empty = exported
+    bool from_binary = false;
+    size_t rows = 0;
+    size_t row_groups = 0;
+    std::uint64_t input_bytes = 0;     // session files read
+    std::uint64_t output_bytes = 0;
+    double seconds = 0.0;
+};
+
+struct FeatureExportResult {
+    std::vector<FeatureExportFile> files;   // in session order
+    size_t exported = 0;
+    size_t failed = 0;
+    size_t rows = 0;
+    std::uint64_t input_bytes = 0;
+    std::uint64_t output_bytes = 0;
+    double wall_seconds = 0.0;
+    double rows_per_sec = 0.0;
+    double input_mb_per_sec = 0.0;
+    std::uint64_t steals = 0;
+};
+
+class FeatureExporter {
+public:
+    struct Options {
+        size_t worker_threads = 0;              // 0 = hardware concurrency
+        size_t chunk_rows = 4096;               // telemetry rows decoded at a time
+        std::uint32_t row_group_rows = feature_table::kDefaultRowGroupRows;
+        std::string output_dir = ".";
+        // dt, prefer_csv, tuning and energy_model for the replay
+        ReplayOptions replay;
+    };
+
+    FeatureExporter();
+    explicit FeatureExporter(const Options& options);
+
+    // Sessions that fail are reported in their FeatureExportFile::error and
+    // leave no output file behind.  Session ids must be distinct: each
+    // names its output file.
+    FeatureExportResult run(const std::vector<FeatureExportSession>& sessions) const;
+
+    // One session on the calling thread.
+    FeatureExportFile export_session(const FeatureExportSession& session) const;
+
+    // Column layout of every exported table.
+    static const std::vector<feature_table::Column>& schema();
+    static std::string output_path_for(const std::string& output_dir, const std::string& session_id);
+
+    // Buffers one worker holds (telemetry chunk + row group), bytes.
+    size_t worker_buffer_bytes() const;
+
+    const Options& options() const { return options_; }
+
+private:
+    Options options_;
+};
+
+} // namespace ivsys
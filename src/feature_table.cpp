@@ -0,0 +1,210 @@
+#include "feature_table.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace ivsys {
+namespace feature_table {
+
+Writer::Writer(const std::string& path, const std::vector<Column>& schema, const std::string& table_id,
+               std::uint32_t row_group_rows)
+    : path_(path), tmp_path_(path + ".tmp"), row_group_rows_(row_group_rows > 0 ? row_group_rows : 1) {
+    if (schema.empty()) {
+        throw std::invalid_argument("feature_table: empty schema");
+    }
+    for (const Column& c : schema) {
+        if (c.name.empty() || c.name.size() >= kMaxColumnName) {
+            throw std::invalid_argument("feature_table: bad column name '" + c.name + "'");
+        }
+        ColumnDesc d{};
+        std::memcpy(d.name, c.name.data(), c.name.size());
+        d.type = static_cast<std::uint32_t>(c.type);
+        columns_.push_back(d);
+    }
+    words_.assign(columns_.size() * row_group_rows_, 0);
+
+    file_.open(tmp_path_, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        throw std::runtime_error("feature_table: cannot create " + tmp_path_);
+    }
+    FileHeader h{};
+    std::memcpy(h.magic, kMagic, sizeof(h.magic));
+    h.version = kVersion;
+    h.byte_order = kByteOrderMark;
+    h.header_size = sizeof(FileHeader);
+    h.column_count = static_cast<std::uint32_t>(columns_.size());
+    h.row_group_rows = row_group_rows_;
+    std::strncpy(h.table_id, table_id.c_str(), sizeof(h.table_id) - 1);
+    file_.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    offset_ = sizeof(h);
+}
+
+Writer::~Writer() {
+    if (!closed_) {
+        file_.close();
+        std::remove(tmp_path_.c_str());
+    }
+}
+
+std::uint64_t Writer::to_word(double value) {
+    std::uint64_t word;
+    std::memcpy(&word, &value, sizeof(word));
+    return word;
+}
+
+void Writer::end_row() {
+    if (closed_) return;
+    ++rows_;
+    ++total_rows_;
+    if (rows_ == row_group_rows_) write_group();
+}
+
+void Writer::write_group() {
+    if (rows_ == 0) return;
+    RowGroupEntry entry{};
+    entry.offset = offset_;
+    entry.rows = rows_;
+    if (static_cast<ColumnType>(columns_[0].type) == ColumnType::Int64) {
+        entry.first_key = static_cast<std::int64_t>(words_[0]);
+        entry.last_key = static_cast<std::int64_t>(words_[rows_ - 1]);
+    }
+
+    RowGroupHeader h{kRowGroupMagic, rows_, static_cast<std::uint32_t>(columns_.size()), 0};
+    file_.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    const size_t run = static_cast<size_t>(rows_) * sizeof(std::uint64_t);
+    for (size_t c = 0; c < columns_.size(); ++c) {
+        file_.write(reinterpret_cast<const char*>(&words_[c * row_group_rows_]),
+                    static_cast<std::streamsize>(run));
+    }
+    offset_ += sizeof(h) + run * columns_.size();
+    groups_.push_back(entry);
+    std::fill(words_.begin(), words_.end(), 0);
+    rows_ = 0;
+}
+
+void Writer::close() {
+    if (closed_) return;
+    write_group();
+    Trailer t{};
+    t.footer_offset = offset_;
+    t.total_rows = total_rows_;
+    t.row_group_count = static_cast<std::uint32_t>(groups_.size());
+    t.magic = kTrailerMagic;
+    file_.write(reinterpret_cast<const char*>(columns_.data()),
+                static_cast<std::streamsize>(columns_.size() * sizeof(ColumnDesc)));
+    file_.write(reinterpret_cast<const char*>(groups_.data()),
+                static_cast<std::streamsize>(groups_.size() * sizeof(RowGroupEntry)));
+    file_.write(reinterpret_cast<const char*>(&t), sizeof(t));
+    file_.close();
+    if (!file_) {
+        throw std::runtime_error("feature_table: write failed for " + tmp_path_);
+    }
+    if (std::rename(tmp_path_.c_str(), path_.c_str()) != 0) {
+        throw std::runtime_error("feature_table: cannot replace " + path_);
+    }
+    closed_ = true;
+}
+
+// ---- Reader ----
+
+Reader::Reader(const void* data, size_t size)
+    : data_(static_cast<const unsigned char*>(data)), size_(size) {
+    auto reject = [](const std::string& what) {
+        throw std::runtime_error("feature_table: " + what);
+    };
+    if (size_ < sizeof(FileHeader) + sizeof(Trailer)) reject("file too short");
+    std::memcpy(&header_, data_, sizeof(header_));
+    if (std::memcmp(header_.magic, kMagic, sizeof(kMagic)) != 0) reject("not a feature table");
+    if (header_.version != kVersion) reject("unsupported version " + std::to_string(header_.version));
+    if (header_.byte_order != kByteOrderMark) reject("byte order mismatch");
+    if (header_.header_size != sizeof(FileHeader) || header_.column_count == 0) reject("bad header");
+
+    Trailer t;
+    std::memcpy(&t, data_ + size_ - sizeof(t), sizeof(t));
+    const std::uint64_t footer_bytes = static_cast<std::uint64_t>(header_.column_count) * sizeof(ColumnDesc) +
+                                       static_cast<std::uint64_t>(t.row_group_count) * sizeof(RowGroupEntry);
+    if (t.magic != kTrailerMagic || t.footer_offset < sizeof(FileHeader) ||
+        t.footer_offset + footer_bytes + sizeof(Trailer) != size_) {
+        reject("missing or damaged footer (unfinished export?)");
+    }
+
+    const unsigned char* p = data_ + t.footer_offset;
+    for (std::uint32_t c = 0; c < header_.column_count; ++c, p += sizeof(ColumnDesc)) {
+        ColumnDesc d;
+        std::memcpy(&d, p, sizeof(d));
+        d.name[kMaxColumnName - 1] = '\0';
+        ColumnType type = static_cast<ColumnType>(d.type);
+        if (type != ColumnType::Int64 && type != ColumnType::Float64) reject("unknown column type");
+        schema_.push_back(Column{d.name, type});
+    }
+    std::uint64_t end = sizeof(FileHeader);
+    for (std::uint32_t g = 0; g < t.row_group_count; ++g, p += sizeof(RowGroupEntry)) {
+        RowGroupEntry e;
+        std::memcpy(&e, p, sizeof(e));
+        RowGroupHeader h;
+        if (e.offset != end || e.offset + sizeof(h) > t.footer_offset) reject("bad row group offset");
+        std::memcpy(&h, data_ + e.offset, sizeof(h));
+        if (h.magic != kRowGroupMagic || h.rows != e.rows || h.columns != header_.column_count) {
+            reject("bad row group header");
+        }
+        end = e.offset + sizeof(h) + e.rows * sizeof(std::uint64_t) * header_.column_count;
+        if (end > t.footer_offset) reject("row group overruns the footer");
+        groups_.push_back(e);
+        total_rows_ += e.rows;
+    }
+    if (end != t.footer_offset || total_rows_ != t.total_rows) reject("row count mismatch");
+}
+
+std::string Reader::table_id() const {
+    return std::string(header_.table_id, strnlen(header_.table_id, sizeof(header_.table_id)));
+}
+
+size_t Reader::column_index(const std::string& name) const {
+    for (size_t c = 0; c < schema_.size(); ++c) {
+        if (schema_[c].name == name) return c;
+    }
+    return npos;
+}
+
+const unsigned char* Reader::column_data(size_t group, size_t column, ColumnType type) const {
+    if (group >= groups_.size() || column >= schema_.size()) {
+        throw std::out_of_range("feature_table: no such row group or column");
+    }
+    if (schema_[column].type != type) {
+        throw std::invalid_argument("feature_table: column " + schema_[column].name + " has another type");
+    }
+    const RowGroupEntry& e = groups_[group];
+    return data_ + e.offset + sizeof(RowGroupHeader) + column * e.rows * sizeof(std::uint64_t);
+}
+
+const std::int64_t* Reader::int64_column(size_t group, size_t column) const {
+    return reinterpret_cast<const std::int64_t*>(column_data(group, column, ColumnType::Int64));
+}
+
+const double* Reader::float64_column(size_t group, size_t column) const {
+    return reinterpret_cast<const double*>(column_data(group, column, ColumnType::Float64));
+}
+
+std::vector<std::int64_t> Reader::read_int64(size_t column) const {
+    std::vector<std::int64_t> out;
+    out.reserve(total_rows_);
+    for (size_t g = 0; g < groups_.size(); ++g) {
+        const std::int64_t* v = int64_column(g, column);
+        out.insert(out.end(), v, v + groups_[g].rows);
+    }
+    return out;
+}
+
+std::vector<double> Reader::read_float64(size_t column) const {
+    std::vector<double> out;
+    out.reserve(total_rows_);
+    for (size_t g = 0; g < groups_.size(); ++g) {
+        const double* v = float64_column(g, column);
+        out.insert(out.end(), v, v + groups_[g].rows);
+    }
+    return out;
+}
+
+} // namespace feature_table
+} // namespace ivsys
@@ -0,0 +1,189 @@
+#pragma once
+
+/*
+ * feature_table.hpp
+ *
+ * Columnar feature table for ML training data ("AIIVFEAT", .aift).
+ *
+ * Laid out like a Parquet file without the encodings: rows are written in
+ * row groups, each column of a group is one contiguous run of 8-byte
+ * values, and the schema and row-group index live in a footer found from
+ * the trailer.  A reader (tools/read_feature_table.py, or numpy.memmap on
+ * a column's offset) can load one column of every group without touching
+ * the rest.  All integers and doubles are native (little-endian) order:
+ *
+ *   FileHeader                        (96 bytes: magic, version, table id)
+ *   RowGroup*
+ *     RowGroupHeader                  (16 bytes: rows, columns)
+ *     value column_c[rows]            (int64 or float64, per the schema)
+ *   ColumnDesc[column_count]          (48 bytes each: name, type)
+ *   RowGroupEntry[row_group_count]    (32 bytes each: offset, rows, key range)
+ *   Trailer                           (24 bytes, locates the footer)
+ *
+ * The writer buffers one row group (row_group_rows x columns x 8 bytes),
+ * so its memory does not grow with the table.  It writes to "<path>.tmp"
+ * and renames on close(); a writer destroyed without close() removes the
+ * temporary file, so a half-exported table is never published.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ivsys {
+namespace feature_table {
+
+constexpr char kMagic[8] = {'A', 'I', 'I', 'V', 'F', 'E', 'A', 'T'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint32_t kByteOrderMark = 0x01020304u;
+constexpr std::uint32_t kRowGroupMagic = 0x31505247u;   // "GRP1"
+constexpr std::uint32_t kTrailerMagic = 0x31525446u;    // "FTR1"
+constexpr std::uint32_t kDefaultRowGroupRows = 16384;   // ~55 min of 5 Hz ticks
+constexpr size_t kMaxColumnName = 40;                   // including the NUL
+constexpr const char* kFileSuffix = ".aift";
+
+enum class ColumnType : std::uint32_t {
+    Int64 = 1,
+    Float64 = 2,
+};
+
+struct Column {
+    std::string name;
+    ColumnType type = ColumnType::Float64;
+};
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint32_t header_size;
+    std::uint32_t column_count;
+    std::uint32_t row_group_rows;
+    std::uint32_t reserved;
+    char table_id[64];
+};
+
+struct RowGroupHeader {
+    std::uint32_t magic;
+    std::uint32_t rows;
+    std::uint32_t columns;
+    std::uint32_t reserved;
+};
+
+struct ColumnDesc {
+    char name[kMaxColumnName];
+    std::uint32_t type;
+    std::uint32_t reserved;
+};
+
+// first/last_key are column 0's first and last value when it is Int64
+// (the timestamp, for exported sessions), else 0.
+struct RowGroupEntry {
+    std::uint64_t offset;   // of the RowGroupHeader
+    std::uint64_t rows;
+    std::int64_t first_key;
+    std::int64_t last_key;
+};
+
+struct Trailer {
+    std::uint64_t footer_offset;
+    std::uint64_t total_rows;
+    std::uint32_t row_group_count;
+    std::uint32_t magic;
+};
+
+static_assert(sizeof(FileHeader) == 96, "FileHeader layout is part of the format");
+static_assert(sizeof(RowGroupHeader) == 16, "RowGroupHeader layout is part of the format");
+static_assert(sizeof(ColumnDesc) == 48, "ColumnDesc layout is part of the format");
+static_assert(sizeof(RowGroupEntry) == 32, "RowGroupEntry layout is part of the format");
+static_assert(sizeof(Trailer) == 24, "Trailer layout is part of the format");
+
+// ---- Writer ----
+
+class Writer {
+public:
+    // Throws std::runtime_error if the file cannot be created, and
+    // std::invalid_argument for an empty schema or a name that is too long.
+    Writer(const std::string& path, const std::vector<Column>& schema, const std::string& table_id,
+           std::uint32_t row_group_rows = kDefaultRowGroupRows);
+    ~Writer();
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    // Cells of the current row; a cell not set is 0.  The overload must
+    // match the column's type.
+    void set(size_t column, double value) { cell(column) = to_word(value); }
+    void set(size_t column, std::int64_t value) { cell(column) = static_cast<std::uint64_t>(value); }
+    void end_row();
+
+    // Writes the last row group, the footer and the trailer, then renames
+    // the file into place.  Throws std::runtime_error on an I/O failure.
+    void close();
+
+    std::uint64_t rows() const { return total_rows_; }
+    size_t row_groups() const { return groups_.size(); }
+    // Bytes held for the open row group.
+    size_t buffer_bytes() const { return words_.size() * sizeof(std::uint64_t); }
+
+private:
+    std::uint64_t& cell(size_t column) { return words_[column * row_group_rows_ + rows_]; }
+    static std::uint64_t to_word(double value);
+    void write_group();
+
+    std::string path_;
+    std::string tmp_path_;
+    std::ofstream file_;
+    std::vector<ColumnDesc> columns_;
+    std::uint32_t row_group_rows_;
+    std::vector<std::uint64_t> words_;    // column-major, columns x row_group_rows
+    std::uint32_t rows_ = 0;               // in the open group
+    std::uint64_t total_rows_ = 0;
+    std::uint64_t offset_ = 0;
+    std::vector<RowGroupEntry> groups_;
+    bool closed_ = false;
+};
+
+// ---- Reader ----
+
+// Parses a table held in memory (a loaded file or a mapping).  The buffer
+// must stay alive for the reader's lifetime and be 8-byte aligned; column
+// accessors return pointers into it.  Throws std::runtime_error on a
+// truncated or malformed table.
+class Reader {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    Reader(const void* data, size_t size);
+
+    std::string table_id() const;
+    const std::vector<Column>& schema() const { return schema_; }
+    size_t column_index(const std::string& name) const;   // npos if absent
+
+    size_t row_group_count() const { return groups_.size(); }
+    const RowGroupEntry& row_group(size_t group) const { return groups_[group]; }
+    std::uint64_t total_rows() const { return total_rows_; }
+
+    // One column of one group; throws std::invalid_argument on a type mismatch.
+    const std::int64_t* int64_column(size_t group, size_t column) const;
+    const double* float64_column(size_t group, size_t column) const;
+
+    // A whole column, every group in order.
+    std::vector<std::int64_t> read_int64(size_t column) const;
+    std::vector<double> read_float64(size_t column) const;
+
+private:
+    const unsigned char* column_data(size_t group, size_t column, ColumnType type) const;
+
+    const unsigned char* data_;
+    size_t size_;
+    FileHeader header_;
+    std::vector<Column> schema_;
+    std::vector<RowGroupEntry> groups_;
+    std::uint64_t total_rows_ = 0;
+};
+
+} // namespace feature_table
+} // namespace ivsys
@@ -0,0 +1,444 @@
+#include "invariant_fuzzer.hpp"
+#include "AdaptiveController.hpp"
+#include "SafetyMonitor.hpp"
+#include "StateEstimator.hpp"
+#include "precision_spine/PrecisionSpine.hpp"
+#include "work_stealing_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+namespace ivsys {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr double kMaxCaseSeconds = 24.0 * 3600.0;
+
+std::uint64_t splitmix64(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+class FuzzRng {
+public:
+    explicit FuzzRng(std::uint64_t seed) : state_(seed) {}
+
+    double uniform() { return static_cast<double>(splitmix64(state_) >> 11) * 0x1.0p-53; }
+    double range(double lo, double hi) { return lo + (hi - lo) * uniform(); }
+    bool chance(double p) { return uniform() < p; }
+    size_t index(size_t n) { return static_cast<size_t>(uniform() * static_cast<double>(n)); }
+    // Roughly standard normal, bounded to +-3
+    double normal() { return 2.0 * (uniform() + uniform() + uniform() - 1.5); }
+
+private:
+    std::uint64_t state_;
+};
+
+// One telemetry channel: field, plausible range and calm reference value.
+struct Channel {
+    double Telemetry::*field;
+    double lo;
+    double hi;
+    double calm;
+};
+
+// heart_rate_bpm's calm value is the profile baseline (see calm_value).
+const Channel kChannels[] = {
+    {&Telemetry::hydration_pct, 30.0, 90.0, 65.0},
+    {&Telemetry::heart_rate_bpm, 30.0, 200.0, 70.0},
+    {&Telemetry::temp_celsius, 34.0, 41.0, 37.0},
+    {&Telemetry::blood_loss_idx, 0.0, 1.0, 0.0},
+    {&Telemetry::fatigue_idx, 0.0, 1.0, 0.3},
+    {&Telemetry::anxiety_idx, 0.0, 1.0, 0.2},
+    {&Telemetry::signal_quality, 0.0, 1.0, 0.9},
+    {&Telemetry::spo2_pct, 70.0, 100.0, 97.0},
+    {&Telemetry::lactate_mmol, 0.5, 15.0, 2.0},
+    {&Telemetry::cardiac_output_L_min, 1.0, 10.0, 5.0},
+};
+constexpr size_t kChannelCount = sizeof(kChannels) / sizeof(kChannels[0]);
+
+double calm_value(const Channel& c, const PatientProfile& profile) {
+    return c.field == &Telemetry::heart_rate_bpm ? profile.baseline_hr_bpm : c.calm;
+}
+
+PatientProfile reference_profile() {
+    PatientProfile p;
+    p.weight_kg = 75.0;
+    p.age_years = 35.0;
+    p.baseline_hr_bpm = 70.0;
+    p.max_safe_infusion_rate = 1.5;
+    p.current_tissue_perfusion = 0.85;
+    p.energy_params = EnergyTransferParams();
+    return p;
+}
+
+void truncate(FuzzCase& c, size_t ticks) {
+    if (c.ticks.size() > ticks) c.ticks.resize(ticks);
+}
+
+} // namespace
+
+double FuzzCase::duration_seconds() const {
+    double total = 0.0;
+    for (const FuzzTick& t : ticks) total += t.dt_seconds;
+    return total;
+}
+
+std::uint64_t FuzzReport::total_violations() const {
+    std::uint64_t total = 0;
+    for (std::uint64_t v : violations) total += v;
+    return total;
+}
+
+InvariantFuzzer::InvariantFuzzer(const Options& options) : options_(options) {}
+
+std::uint64_t InvariantFuzzer::case_seed(std::uint64_t run_seed, std::uint64_t index) {
+    std::uint64_t state = run_seed ^ (index * 0xd1342543de82ef95ULL);
+    return splitmix64(state);
+}
+
+FuzzCase InvariantFuzzer::generate(std::uint64_t seed) const {
+    FuzzRng rng(seed);
+    FuzzCase c;
+    c.seed = seed;
+    c.adversarial = rng.chance(options_.adversarial_fraction);
+
+    // Clinically configurable, if extreme, profiles; light patients more often
+    PatientProfile& p = c.profile;
+    double w = rng.uniform();
+    p.weight_kg = 2.0 + 198.0 * w * w;
+    p.age_years = rng.range(0.0, 100.0);
+    p.baseline_hr_bpm = rng.range(35.0, 180.0);
+    p.max_safe_infusion_rate = rng.chance(0.2) ? rng.range(0.02, 0.5) : rng.range(0.5, 3.0);
+    p.cardiac_condition = rng.chance(0.2);
+    p.renal_impairment = rng.chance(0.2);
+    p.diabetes = rng.chance(0.2);
+    p.current_tissue_perfusion = rng.range(0.2, 1.0);
+    p.energy_params = EnergyTransferParams();
+
+    // Log-uniform length; a long base dt reaches the 24 h volume limit
+    size_t max_ticks = std::max<size_t>(1, options_.max_ticks);
+    size_t n = std::min(max_ticks, static_cast<size_t>(
+                                       std::exp(rng.uniform() * std::log(static_cast<double>(max_ticks)))) + 1);
+    double u = rng.uniform();
+    double base_dt = u < 0.5 ? 0.2 : (u < 0.75 ? rng.range(0.05, 5.0) : rng.range(5.0, 300.0));
+    double adversity = c.adversarial ? rng.range(0.02, 0.5) : 0.0;
+
+    double value[kChannelCount], setpoint[kChannelCount], volatility[kChannelCount];
+    for (size_t k = 0; k < kChannelCount; ++k) {
+        const Channel& ch = kChannels[k];
+        value[k] = rng.chance(0.5) ? calm_value(ch, p) : rng.range(ch.lo, ch.hi);
+        setpoint[k] = rng.range(ch.lo, ch.hi);
+        volatility[k] = rng.range(0.0, 0.05);
+    }
+
+    double elapsed = 0.0;
+    c.ticks.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        FuzzTick tick;
+        tick.dt_seconds = base_dt * rng.range(0.9, 1.1);
+        if (c.adversarial && rng.chance(0.05)) {
+            const double odd_dt[] = {0.0, 1e-6, 3600.0};
+            tick.dt_seconds = odd_dt[rng.index(3)];
+        }
+        if (elapsed + tick.dt_seconds > kMaxCaseSeconds) break;
+        elapsed += tick.dt_seconds;
+
+        for (size_t k = 0; k < kChannelCount; ++k) {
+            const Channel& ch = kChannels[k];
+            double span = ch.hi - ch.lo;
+            if (rng.chance(0.01)) {   // regime change
+                setpoint[k] = rng.range(ch.lo, ch.hi);
+                if (rng.chance(0.5)) value[k] = setpoint[k];
+            }
+            value[k] += volatility[k] * span * rng.normal() + 0.05 * (setpoint[k] - value[k]);
+            value[k] = std::clamp(value[k], ch.lo, ch.hi);
+            double reading = value[k];
+            if (c.adversarial && rng.chance(adversity)) {
+                switch (rng.index(options_.non_finite ? 7 : 4)) {
+                case 0: reading = ch.lo - span; break;
+                case 1: reading = ch.hi + span * 10.0; break;
+                case 2: reading = (i % 2) ? ch.hi : ch.lo; break;   // alternate extremes
+                case 3: reading = 0.0; break;
+                case 4: reading = std::numeric_limits<double>::quiet_NaN(); break;
+                case 5: reading = std::numeric_limits<double>::infinity(); break;
+                default: reading = -std::numeric_limits<double>::infinity(); break;
+                }
+            }
+            tick.telemetry.*ch.field = reading;
+        }
+        c.ticks.push_back(tick);
+    }
+    if (c.ticks.empty()) {   // a first dt of an hour can still not overrun the day
+        FuzzTick tick;
+        for (const Channel& ch : kChannels) tick.telemetry.*ch.field = calm_value(ch, p);
+        c.ticks.push_back(tick);
+    }
+    return c;
+}
+
+std::optional<InvariantViolation> InvariantFuzzer::check(const FuzzCase& fuzz_case,
+                                                         const config::ControlTuning& tuning,
+                                                         const config::ControlTuning& limits) {
+    const PatientProfile& profile = fuzz_case.profile;
+    StateEstimator estimator(default_energy_proxy());
+    AdaptiveController controller(profile, tuning);
+    SafetyMonitor safety(profile, tuning);
+    const double volume_limit = SafetyMonitor(profile, limits).get_max_volume_24h();
+
+    double rate = 0.4;   // PatientControlCycle's starting rate
+    double capped_volume = 0.0;   // volume outside emergency-floor ticks
+    for (size_t i = 0; i < fuzz_case.ticks.size(); ++i) {
+        const FuzzTick& tick = fuzz_case.ticks[i];
+        double dt_min = tick.dt_seconds / 60.0;
+
+        PatientState state = estimator.estimate(tick.telemetry, profile, rate);
+        precision_spine::TreatmentFlow routed = precision_spine::dose_route(state);
+        PatientState validated = precision_spine::fallback_floor(precision_spine::reject_noise(routed));
+        ControlOutput out = controller.decide(validated, safety, estimator, dt_min);
+
+        double r = out.infusion_ml_per_min;
+        bool emergency = out.warning_flags.has(WarningFlag::EmergencyMinRate);
+        if (!std::isfinite(r)) return InvariantViolation{InvariantKind::RateNotFinite, i, r, 0.0};
+        if (r < -kTolerance) return InvariantViolation{InvariantKind::RateOutOfBounds, i, r, 0.0};
+        if (r > profile.max_safe_infusion_rate + kTolerance) {
+            return InvariantViolation{InvariantKind::RateOutOfBounds, i, r, profile.max_safe_infusion_rate};
+        }
+        if (i > 0 && !emergency && r - rate > limits.max_rate_change_ml_min + kTolerance) {
+            return InvariantViolation{InvariantKind::RateChangeExceeded, i, r - rate,
+                                      limits.max_rate_change_ml_min};
+        }
+
+        safety.update_volume(r, dt_min);
+        if (!emergency) capped_volume += std::max(0.0, r) * std::max(0.0, dt_min);
+        if (capped_volume > volume_limit + kTolerance) {
+            return InvariantViolation{InvariantKind::VolumeCapExceeded, i, capped_volume, volume_limit};
+        }
+        rate = r;
+    }
+    return std::nullopt;
+}
+
+FuzzCase InvariantFuzzer::shrink(const FuzzCase& fuzz_case, InvariantKind kind,
+                                 const config::ControlTuning& tuning,
+                                 const config::ControlTuning& limits, size_t max_checks,
+                                 size_t* checks_used) {
+    size_t checks = 0;
+    // Tick of the violation if the candidate still breaks `kind`
+    auto still_fails = [&](const FuzzCase& candidate) -> std::optional<size_t> {
+        if (checks >= max_checks || candidate.ticks.empty()) return std::nullopt;
+        ++checks;
+        auto v = check(candidate, tuning, limits);
+        if (v && v->kind == kind) return v->tick;
+        return std::nullopt;
+    };
+
+    FuzzCase best = fuzz_case;
+    auto first = check(best, tuning, limits);
+    if (!first || first->kind != kind) {
+        if (checks_used) *checks_used = 0;
+        return best;
+    }
+    truncate(best, first->tick + 1);
+
+    auto accept = [&](FuzzCase& candidate) {
+        if (auto tick = still_fails(candidate)) {
+            truncate(candidate, *tick + 1);
+            best = std::move(candidate);
+            return true;
+        }
+        return false;
+    };
+
+    const PatientProfile reference = reference_profile();
+    bool progress = true;
+    while (progress && checks < max_checks) {
+        progress = false;
+
+        // Remove chunks of ticks, halving the chunk size
+        for (size_t chunk = std::max<size_t>(1, best.ticks.size() / 2); chunk >= 1; chunk /= 2) {
+            for (size_t start = 0; start + chunk <= best.ticks.size() && best.ticks.size() > 1;) {
+                FuzzCase candidate = best;
+                candidate.ticks.erase(candidate.ticks.begin() + static_cast<std::ptrdiff_t>(start),
+                                      candidate.ticks.begin() + static_cast<std::ptrdiff_t>(start + chunk));
+                if (accept(candidate)) progress = true;
+                else start += chunk;
+            }
+            if (chunk == 1) break;
+        }
+
+        // Merge neighbours into one tick covering both dts
+        for (size_t i = 0; i + 1 < best.ticks.size();) {
+            FuzzCase candidate = best;
+            candidate.ticks[i + 1].dt_seconds += candidate.ticks[i].dt_seconds;
+            candidate.ticks.erase(candidate.ticks.begin() + static_cast<std::ptrdiff_t>(i));
+            if (accept(candidate)) progress = true;
+            else ++i;
+        }
+
+        // Reset readings, then dt, to calm values
+        for (size_t i = 0; i < best.ticks.size(); ++i) {
+            for (const Channel& ch : kChannels) {
+                double calm = calm_value(ch, best.profile);
+                double current = best.ticks[i].telemetry.*ch.field;
+                if (current == calm) continue;
+                FuzzCase candidate = best;
+                candidate.ticks[i].telemetry.*ch.field = calm;
+                if (accept(candidate)) progress = true;
+                if (i >= best.ticks.size()) break;
+            }
+            if (i < best.ticks.size() && best.ticks[i].dt_seconds != config::CONTROL_PERIOD_SEC) {
+                FuzzCase candidate = best;
+                candidate.ticks[i].dt_seconds = config::CONTROL_PERIOD_SEC;
+                if (accept(candidate)) progress = true;
+            }
+        }
+
+        // Move the profile towards the reference patient
+        auto try_profile = [&](auto&& edit) {
+            FuzzCase candidate = best;
+            edit(candidate.profile);
+            if (candidate.profile.weight_kg == best.profile.weight_kg &&
+                candidate.profile.age_years == best.profile.age_years &&
+                candidate.profile.baseline_hr_bpm == best.profile.baseline_hr_bpm &&
+                candidate.profile.max_safe_infusion_rate == best.profile.max_safe_infusion_rate &&
+                candidate.profile.current_tissue_perfusion == best.profile.current_tissue_perfusion &&
+                candidate.profile.cardiac_condition == best.profile.cardiac_condition &&
+                candidate.profile.renal_impairment == best.profile.renal_impairment &&
+                candidate.profile.diabetes == best.profile.diabetes) {
+                return;
+            }
+            if (accept(candidate)) progress = true;
+        };
+        try_profile([](PatientProfile& p) { p.cardiac_condition = false; });
+        try_profile([](PatientProfile& p) { p.renal_impairment = false; });
+        try_profile([](PatientProfile& p) { p.diabetes = false; });
+        try_profile([&](PatientProfile& p) { p.age_years = reference.age_years; });
+        try_profile([&](PatientProfile& p) { p.current_tissue_perfusion = reference.current_tissue_perfusion; });
+        try_profile([&](PatientProfile& p) { p.baseline_hr_bpm = reference.baseline_hr_bpm; });
+        try_profile([&](PatientProfile& p) { p.weight_kg = reference.weight_kg; });
+        try_profile([&](PatientProfile& p) { p.max_safe_infusion_rate = reference.max_safe_infusion_rate; });
+    }
+    if (checks_used) *checks_used = checks;
+    return best;
+}
+
+FuzzReport InvariantFuzzer::run() const {
+    size_t workers = options_.worker_threads ? options_.worker_threads
+                                             : std::max(1u, std::thread::hardware_concurrency());
+    WorkStealingPool pool(workers);
+    FuzzReport report;
+    report.workers = workers;
+
+    struct Found {
+        std::uint64_t index;
+        InvariantKind kind;
+    };
+    std::mutex merge_mutex;
+    std::vector<Found> found;
+    std::atomic<std::uint64_t> next{0};
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point deadline = start + options_.time_budget;
+
+    for (size_t w = 0; w < workers; ++w) {
+        pool.submit([&] {
+            FuzzReport local;
+            std::vector<Found> local_found;
+            while (true) {
+                if (options_.time_budget.count() > 0 && Clock::now() >= deadline) break;
+                std::uint64_t first = next.fetch_add(kBatch, std::memory_order_relaxed);
+                if (first >= options_.cases) break;
+                std::uint64_t last = std::min<std::uint64_t>(options_.cases, first + kBatch);
+                for (std::uint64_t index = first; index < last; ++index) {
+                    FuzzCase c = generate(case_seed(options_.seed, index));
+                    auto v = check(c, options_.tuning, options_.limits);
+                    ++local.cases;
+                    local.adversarial_cases += c.adversarial;
+                    local.ticks += v ? v->tick + 1 : c.ticks.size();
+                    local.simulated_seconds += c.duration_seconds();
+                    if (v) {
+                        ++local.violations[static_cast<size_t>(v->kind)];
+                        local_found.push_back({index, v->kind});
+                    }
+                }
+            }
+            std::lock_guard<std::mutex> lock(merge_mutex);
+            report.cases += local.cases;
+            report.adversarial_cases += local.adversarial_cases;
+            report.ticks += local.ticks;
+            report.simulated_seconds += local.simulated_seconds;
+            for (size_t k = 0; k < local.violations.size(); ++k) report.violations[k] += local.violations[k];
+            found.insert(found.end(), local_found.begin(), local_found.end());
+        });
+    }
+    pool.wait_idle();
+    report.wall_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (report.wall_seconds > 0.0) {
+        report.cases_per_second = static_cast<double>(report.cases) / report.wall_seconds;
+        report.ticks_per_second = static_cast<double>(report.ticks) / report.wall_seconds;
+    }
+
+    // Shrink the lowest-index failures, one task each
+    std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) { return a.index < b.index; });
+    if (found.size() > options_.max_failures) found.resize(options_.max_failures);
+    report.failures.resize(found.size());
+    for (size_t f = 0; f < found.size(); ++f) {
+        pool.submit([&, f] {
+            FuzzFailure& failure = report.failures[f];
+            failure.case_index = found[f].index;
+            failure.case_seed = case_seed(options_.seed, found[f].index);
+            FuzzCase original = generate(failure.case_seed);
+            failure.original_ticks = original.ticks.size();
+            failure.minimized = options_.max_shrink_checks > 0
+                ? shrink(original, found[f].kind, options_.tuning, options_.limits,
+                         options_.max_shrink_checks, &failure.shrink_checks)
+                : original;
+            failure.violation = *check(failure.minimized, options_.tuning, options_.limits);
+        });
+    }
+    pool.wait_idle();
+    return report;
+}
+
+const char* InvariantFuzzer::kind_name(InvariantKind kind) {
+    switch (kind) {
+    case InvariantKind::RateNotFinite: return "rate_not_finite";
+    case InvariantKind::RateOutOfBounds: return "rate_out_of_bounds";
+    case InvariantKind::RateChangeExceeded: return "rate_change_exceeded";
+    case InvariantKind::VolumeCapExceeded: return "volume_cap_exceeded";
+    case InvariantKind::Count: break;
+    }
+    return "unknown";
+}
+
+void InvariantFuzzer::write_case(std::ostream& os, const FuzzCase& c) {
+    const PatientProfile& p = c.profile;
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << std::defaultfloat << std::setprecision(17)
+       << "# seed=" << c.seed << " adversarial=" << c.adversarial << "\n"
+       << "# weight_kg=" << p.weight_kg << " age_years=" << p.age_years
+       << " baseline_hr_bpm=" << p.baseline_hr_bpm
+       << " max_safe_infusion_rate=" << p.max_safe_infusion_rate
+       << " cardiac_condition=" << p.cardiac_condition << " renal_impairment=" << p.renal_impairment
+       << " diabetes=" << p.diabetes << " current_tissue_perfusion=" << p.current_tissue_perfusion << "\n"
+       << "tick,dt_s,hydration_pct,heart_rate_bpm,temp_celsius,blood_loss_idx,fatigue_idx,"
+          "anxiety_idx,signal_quality,spo2_pct,lactate_mmol,cardiac_output_L_min\n";
+    for (size_t i = 0; i < c.ticks.size(); ++i) {
+        os << i << "," << c.ticks[i].dt_seconds;
+        for (const Channel& ch : kChannels) os << "," << c.ticks[i].telemetry.*ch.field;
+        os << "\n";
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
+
+} // namespace ivsys
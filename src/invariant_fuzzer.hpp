@@ -0,0 +1,150 @@
+#pragma once
+
+/*
+ * invariant_fuzzer.hpp
+ *
+ * Randomized property testing of the decision path against the safety
+ * invariants the SafetyMonitor promises.
+ *
+ * A FuzzCase is a PatientProfile plus a sequence of telemetry ticks with
+ * their own dt.  check() runs it through the tick's decision path
+ * (estimate -> precision spine -> decide -> update_volume) on fresh
+ * objects and checks after every tick that:
+ *
+ *   - the rate is finite and within [0, max_safe_infusion_rate]
+ *   - the rate rose by at most max_rate_change_ml_min since the last tick
+ *   - the volume infused stays within the SafetyMonitor's 24 h limit
+ *
+ * For the last two, ticks on which the emergency minimum rate was enforced
+ * are exempt: the emergency floor outranks every other cap by design.  The
+ * first finding ends the case.  The objects run with Options::tuning; the
+ * rate-change and volume limits come from Options::limits, so a candidate
+ * tuning can be checked against the compile-time envelope.
+ *
+ * Cases come from a seed alone: physiological random walks with regime
+ * jumps, or adversarial sequences (saturated and out-of-range readings,
+ * alternating extremes, NaN and infinities, zero and hour-long dt).  Each
+ * case lasts at most 24 h of therapy, so one volume window covers it.
+ *
+ * run() deals batches of case indices to a WorkStealingPool.  A failing
+ * case is shrunk (truncation, chunk removal, then values reset to a calm
+ * reference) while it still breaks the same invariant.  Without a time
+ * budget the cases run, and the failures reported, do not depend on the
+ * worker count.
+ */
+
+#include "iv_system_types.hpp"
+#include "config_defaults.hpp"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+namespace ivsys {
+
+struct FuzzTick {
+    Telemetry telemetry;       // timestamp unused
+    double dt_seconds = 0.2;
+};
+
+struct FuzzCase {
+    std::uint64_t seed = 0;
+    bool adversarial = false;
+    PatientProfile profile;
+    std::vector<FuzzTick> ticks;
+
+    double duration_seconds() const;
+};
+
+enum class InvariantKind {
+    RateNotFinite,
+    RateOutOfBounds,     // below 0 or above max_safe_infusion_rate
+    RateChangeExceeded,  // rose by more than max_rate_change_ml_min in one tick
+    VolumeCapExceeded,   // over the SafetyMonitor's 24 h volume limit
+    Count
+};
+
+struct InvariantViolation {
+    InvariantKind kind = InvariantKind::RateNotFinite;
+    size_t tick = 0;
+    double observed = 0.0;    // rate, rate rise or volume
+    double limit = 0.0;
+};
+
+struct FuzzFailure {
+    size_t case_index = 0;
+    std::uint64_t case_seed = 0;
+    size_t original_ticks = 0;
+    FuzzCase minimized;
+    InvariantViolation violation;   // as found on `minimized`
+    size_t shrink_checks = 0;
+};
+
+struct FuzzReport {
+    std::uint64_t cases = 0;
+    std::uint64_t adversarial_cases = 0;
+    std::uint64_t ticks = 0;
+    double simulated_seconds = 0.0;
+    double wall_seconds = 0.0;
+    double cases_per_second = 0.0;
+    double ticks_per_second = 0.0;
+    size_t workers = 0;
+    std::array<std::uint64_t, static_cast<size_t>(InvariantKind::Count)> violations{};
+    std::vector<FuzzFailure> failures;   // first max_failures by case index, shrunk
+
+    std::uint64_t total_violations() const;
+};
+
+class InvariantFuzzer {
+public:
+    // Absolute slack on every comparison, for floating-point accumulation.
+    static constexpr double kTolerance = 1e-9;
+    // Cases handed to a worker at a time.
+    static constexpr size_t kBatch = 64;
+
+    struct Options {
+        std::uint64_t seed = 1;
+        std::uint64_t cases = 100000;
+        std::chrono::milliseconds time_budget{0};   // > 0: stop claiming cases after this
+        size_t worker_threads = 0;                  // 0 = hardware concurrency
+        size_t max_ticks = 512;                     // per case
+        double adversarial_fraction = 0.25;
+        bool non_finite = true;                     // NaN/inf readings in adversarial cases
+        size_t max_failures = 8;                    // shrunk and reported
+        size_t max_shrink_checks = 20000;           // per failure; 0 disables shrinking
+        config::ControlTuning tuning;               // what the controller and monitor run
+        config::ControlTuning limits;               // what the invariants enforce
+    };
+
+    InvariantFuzzer() : InvariantFuzzer(Options{}) {}
+    explicit InvariantFuzzer(const Options& options);
+
+    FuzzReport run() const;
+
+    // Case `index` of a run seeded with `run_seed`.
+    static std::uint64_t case_seed(std::uint64_t run_seed, std::uint64_t index);
+    FuzzCase generate(std::uint64_t case_seed) const;
+
+    // First violation on the case, if any.
+    static std::optional<InvariantViolation> check(const FuzzCase& fuzz_case,
+                                                   const config::ControlTuning& tuning,
+                                                   const config::ControlTuning& limits);
+    // Smallest variant found that still breaks `kind`.
+    static FuzzCase shrink(const FuzzCase& fuzz_case, InvariantKind kind,
+                           const config::ControlTuning& tuning, const config::ControlTuning& limits,
+                           size_t max_checks, size_t* checks_used = nullptr);
+
+    static const char* kind_name(InvariantKind kind);
+    // Profile, then one CSV row per tick: dt and every telemetry field.
+    static void write_case(std::ostream& os, const FuzzCase& fuzz_case);
+
+    const Options& options() const { return options_; }
+
+private:
+    Options options_;
+};
+
+} // namespace ivsys
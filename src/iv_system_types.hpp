@@ -9,6 +9,7 @@
 
 #include <string>
 #include <chrono>
+#include <cstdint>
 #include <optional>
 #include <deque>
 #include <vector>
@@ -94,12 +95,59 @@ struct PatientState {
     double uncertainty = 0.0;        // confidence in state estimate (0-1)
 };
 
+// SafetyMonitor findings, one bit per check in evaluation order.  Binary
+// sessions store the bits as they are (session_format.hpp).
+enum class WarningFlag : std::uint32_t {
+    VolumeLimitApproach = 1u << 0,
+    LowCardiacReserve   = 1u << 1,
+    RateChangeLimited   = 1u << 2,
+    HighRiskState       = 1u << 3,
+    TachycardiaDetected = 1u << 4,
+    EmergencyMinRate    = 1u << 5,
+    Other               = 1u << 31   // decoded token this build does not know
+};
+
+struct WarningFlags {
+    std::uint32_t bits = 0;
+
+    bool any() const { return bits != 0; }
+    bool has(WarningFlag f) const { return (bits & static_cast<std::uint32_t>(f)) != 0; }
+    void set(WarningFlag f) { bits |= static_cast<std::uint32_t>(f); }
+    bool operator==(const WarningFlags& other) const { return bits == other.bits; }
+    bool operator!=(const WarningFlags& other) const { return bits != other.bits; }
+};
+
+enum class RationaleCode : std::uint8_t {
+    None,         // no decision recorded
+    Controller,   // AdaptiveController formula; the fields below are its inputs
+    Custom        // fixed text in Rationale::text
+};
+
+// Why a rate was chosen, as a code plus the numbers the text is built
+// from.  The text ("H=65.00% E_T=...") is rendered only when it is logged
+// or served; see control_text.hpp.
+struct Rationale {
+    RationaleCode code = RationaleCode::None;
+    bool safety_limited = false;
+    bool predictive_boost = false;
+    double hydration_pct = 0.0;
+    double energy_T = 0.0;
+    double energy_T_absolute = 0.0;
+    double risk_score = 0.0;
+    double cardiac_reserve = 0.0;
+    double coherence_sigma = 0.0;
+    double flow_velocity_cm_s = 0.0;
+    double flow_efficiency = 0.0;
+    double rate_ml_min = 0.0;
+    const char* text = nullptr;   // Custom only; must have static storage duration
+};
+
 struct ControlOutput {
     double infusion_ml_per_min = 0.0;
     double confidence = 0.0;
-    std::string rationale;
+    Rationale rationale;
     bool safety_override = false;
-    std::string warning_flags;
+    WarningFlags warning_flags;
 };
 
 struct PatientProfile {
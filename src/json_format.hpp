@@ -0,0 +1,77 @@
+#pragma once
+
+/*
+ * json_format.hpp
+ *
+ * Append-only JSON value formatting into a std::string.
+ *
+ * Numbers go through std::to_chars, so output never depends on the global
+ * or stream locale and never touches an ostringstream.  append_fixed
+ * produces the same digits as `std::fixed << std::setprecision(p)`;
+ * non-finite values, which JSON cannot represent, are written as null.
+ */
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+namespace ivsys {
+namespace json {
+
+inline void append_fixed(std::string& out, double value, int precision) {
+    if (!std::isfinite(value)) {
+        out += "null";
+        return;
+    }
+    char buf[64];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::fixed, precision);
+    if (result.ec != std::errc()) {
+        // |value| too large for the buffer in fixed notation
+        result = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::scientific, precision);
+    }
+    out.append(buf, static_cast<size_t>(result.ptr - buf));
+}
+
+inline void append_uint(std::string& out, std::uint64_t value) {
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, static_cast<size_t>(result.ptr - buf));
+}
+
+inline void append_int(std::string& out, std::int64_t value) {
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, static_cast<size_t>(result.ptr - buf));
+}
+
+// Appends the characters of a JSON string body (no surrounding quotes).
+inline void append_escaped(std::string& out, const char* text, size_t length) {
+    static const char kHex[] = "0123456789abcdef";
+    for (size_t i = 0; i < length; ++i) {
+        char c = text[i];
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out += "\\u00";
+                    out += kHex[(c >> 4) & 0xF];
+                    out += kHex[c & 0xF];
+                } else {
+                    out += c;
+                }
+                break;
+        }
+    }
+}
+
+inline void append_escaped(std::string& out, const std::string& text) {
+    append_escaped(out, text.data(), text.size());
+}
+
+} // namespace json
+} // namespace ivsys
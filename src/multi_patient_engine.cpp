@@ -0,0 +1,249 @@
+#include "multi_patient_engine.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace ivsys {
+
+// ============================================================================
+// TimerWheel
+// ============================================================================
+
+TimerWheel::TimerWheel(std::chrono::milliseconds resolution, size_t slot_count)
+    : resolution_(std::max(resolution, std::chrono::milliseconds(1))),
+      slots_(std::max<size_t>(slot_count, 1)),
+      cursor_time_(Clock::now()) {}
+
+size_t TimerWheel::slot_for(Clock::time_point due) const {
+    long long delta_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        due - cursor_time_).count();
+    long long res_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(resolution_).count();
+    // Round up so an entry never fires before its due time; anything
+    // already due fires on the next slot visit.
+    long long ticks = delta_ns > 0 ? (delta_ns + res_ns - 1) / res_ns : 1;
+    ticks = std::max<long long>(ticks, 1);
+    return (cursor_ + static_cast<size_t>(ticks)) % slots_.size();
+}
+
+void TimerWheel::schedule(size_t id, Clock::time_point due) {
+    slots_[slot_for(due)].push_back({id, due});
+}
+
+void TimerWheel::advance(Clock::time_point now, std::vector<size_t>& expired) {
+    while (cursor_time_ + resolution_ <= now) {
+        cursor_ = (cursor_ + 1) % slots_.size();
+        cursor_time_ += resolution_;
+
+        auto& slot = slots_[cursor_];
+        auto keep = std::partition(slot.begin(), slot.end(),
+            [this](const Entry& e) { return e.due > cursor_time_; });
+        for (auto it = keep; it != slot.end(); ++it) {
+            expired.push_back(it->id);
+        }
+        slot.erase(keep, slot.end());
+    }
+}
+
+// ============================================================================
+// MultiPatientEngine
+// ============================================================================
+
+MultiPatientEngine::MultiPatientEngine() : MultiPatientEngine(Options{}) {}
+
+MultiPatientEngine::MultiPatientEngine(const Options& options)
+    : options_(options), wheel_(options.timer_resolution, options.wheel_slots) {
+    if (options_.period.count() <= 0) {
+        throw std::invalid_argument("MultiPatientEngine: period must be positive");
+    }
+    options_.worker_threads = std::max<size_t>(options_.worker_threads, 1);
+    if (!options_.energy_model) options_.energy_model = default_energy_proxy();
+}
+
+MultiPatientEngine::~MultiPatientEngine() {
+    stop();
+}
+
+size_t MultiPatientEngine::add_patient(const PatientProfile& profile,
+                                       const std::string& session_id,
+                                       TelemetrySource source,
+                                       PatientClass patient_class) {
+    if (running_.load()) {
+        throw std::logic_error("MultiPatientEngine: add_patient called while running");
+    }
+    if (!source) {
+        throw std::invalid_argument("MultiPatientEngine: telemetry source is required");
+    }
+    patients_.push_back(std::make_unique<PatientSlot>(profile, session_id, std::move(source),
+                                                     options_.log_mode,
+                                                     options_.session_format,
+                                                     options_.energy_model, patient_class));
+    patients_.back()->stats.session_id = session_id;
+    if (options_.replication) {
+        patients_.back()->publisher = std::make_unique<replication::CheckpointPublisher>(
+            session_id, options_.replication, options_.replication_options);
+    }
+    return patients_.size() - 1;
+}
+
+void MultiPatientEngine::start() {
+    if (running_.load()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(wheel_mutex_);
+        wheel_ = TimerWheel(options_.timer_resolution, options_.wheel_slots);
+
+        // Stagger start phases evenly across one control period.
+        auto now = Clock::now();
+        auto period_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(options_.period);
+        for (size_t i = 0; i < patients_.size(); ++i) {
+            auto offset = period_ns * static_cast<long long>(i) /
+                          static_cast<long long>(patients_.size());
+            patients_[i]->scheduled = now + options_.period + offset;
+            // After a stop() the first tick must not span the pause: nothing
+            // was infused while the engine was stopped.
+            patients_[i]->has_run = false;
+            wheel_.schedule(i, patients_[i]->scheduled);
+        }
+    }
+
+    running_.store(true);
+    for (size_t i = 0; i < options_.worker_threads; ++i) {
+        workers_.emplace_back(&MultiPatientEngine::worker_loop, this);
+    }
+    timer_thread_ = std::thread(&MultiPatientEngine::timer_loop, this);
+}
+
+void MultiPatientEngine::stop() {
+    if (!running_.exchange(false)) return;
+
+    queue_cv_.notify_all();
+    if (timer_thread_.joinable()) timer_thread_.join();
+    for (auto& w : workers_) {
+        if (w.joinable()) w.join();
+    }
+    workers_.clear();
+
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    ready_queue_.clear();
+}
+
+void MultiPatientEngine::timer_loop() {
+    std::vector<size_t> expired;
+    while (running_.load()) {
+        Clock::time_point wake;
+        {
+            std::lock_guard<std::mutex> lock(wheel_mutex_);
+            wake = wheel_.next_slot_time();
+        }
+        std::this_thread::sleep_until(wake);
+
+        expired.clear();
+        {
+            std::lock_guard<std::mutex> lock(wheel_mutex_);
+            wheel_.advance(Clock::now(), expired);
+        }
+        if (expired.empty()) continue;
+
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            ready_queue_.insert(ready_queue_.end(), expired.begin(), expired.end());
+        }
+        queue_cv_.notify_all();
+    }
+}
+
+void MultiPatientEngine::worker_loop() {
+    while (true) {
+        size_t index;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait(lock, [this] { return !running_.load() || !ready_queue_.empty(); });
+            if (!running_.load()) return;
+            index = ready_queue_.front();
+            ready_queue_.pop_front();
+        }
+        run_patient(index);
+    }
+}
+
+void MultiPatientEngine::run_patient(size_t index) {
+    PatientSlot& p = *patients_[index];
+
+    auto start = Clock::now();
+    auto scheduled = p.scheduled;
+
+    // Volume and elution accounting cover the nominal time since the
+    // previous executed tick, including any periods that were skipped.
+    double dt_seconds = p.has_run
+        ? std::chrono::duration<double>(scheduled - p.last_scheduled).count()
+        : std::chrono::duration<double>(options_.period).count();
+    p.therapy_time_s += dt_seconds;
+
+    Telemetry measurement = p.source(p.therapy_time_s);
+    measurement.timestamp = start;
+    CycleResult result = p.cycle.step(measurement, dt_seconds);
+
+    auto replicated = Clock::now();
+    if (p.publisher) p.publisher->publish(p.cycle, measurement.timestamp);
+    auto finish = Clock::now();
+
+    auto next = scheduled + options_.period;
+    std::uint64_t skipped = 0;
+    while (next <= finish) {
+        next += options_.period;
+        ++skipped;
+    }
+
+    double jitter_ms = std::chrono::duration<double, std::milli>(start - scheduled).count();
+    double exec_ms = std::chrono::duration<double, std::milli>(finish - start).count();
+    bool missed = finish > scheduled + options_.period;
+
+    {
+        std::lock_guard<std::mutex> lock(p.stats_mutex);
+        PatientTickStats& s = p.stats;
+        ++s.ticks;
+        if (missed) ++s.deadline_misses;
+        s.skipped_periods += skipped;
+        s.last_jitter_ms = jitter_ms;
+        s.mean_jitter_ms += (jitter_ms - s.mean_jitter_ms) / static_cast<double>(s.ticks);
+        s.max_jitter_ms = std::max(s.max_jitter_ms, jitter_ms);
+        s.mean_exec_ms += (exec_ms - s.mean_exec_ms) / static_cast<double>(s.ticks);
+        s.max_exec_ms = std::max(s.max_exec_ms, exec_ms);
+        s.current_infusion_rate = result.command.infusion_ml_per_min;
+        if (p.publisher) {
+            double replication_us = std::chrono::duration<double, std::micro>(finish - replicated).count();
+            const replication::PublisherStats& r = p.publisher->counters();
+            s.replication_frames = r.frames;
+            s.replication_full_frames = r.full_frames;
+            s.replication_rejected = r.rejected + r.oversized;
+            s.replication_bytes = r.bytes;
+            s.mean_replication_us += (replication_us - s.mean_replication_us) / static_cast<double>(s.ticks);
+            s.max_replication_us = std::max(s.max_replication_us, replication_us);
+        }
+    }
+
+    p.last_scheduled = scheduled;
+    p.has_run = true;
+    p.scheduled = next;
+
+    if (running_.load()) {
+        std::lock_guard<std::mutex> lock(wheel_mutex_);
+        wheel_.schedule(index, next);
+    }
+}
+
+PatientTickStats MultiPatientEngine::stats(size_t patient_index) const {
+    const PatientSlot& p = *patients_.at(patient_index);
+    std::lock_guard<std::mutex> lock(p.stats_mutex);
+    return p.stats;
+}
+
+std::vector<PatientTickStats> MultiPatientEngine::all_stats() const {
+    std::vector<PatientTickStats> out;
+    out.reserve(patients_.size());
+    for (size_t i = 0; i < patients_.size(); ++i) {
+        out.push_back(stats(i));
+    }
+    return out;
+}
+
+} // namespace ivsys
@@ -0,0 +1,185 @@
+#pragma once
+
+/*
+ * multi_patient_engine.hpp
+ *
+ * Ward-scale scheduler that runs many PatientControlCycle instances in one
+ * process.
+ *
+ * Design:
+ * - A single timer thread advances a hashed timer wheel at a fixed
+ *   resolution and hands due patients to a fixed-size worker pool.
+ * - Each patient is re-armed by the worker that ran it, so a patient is
+ *   never stepped by two workers at once.
+ * - Patient start phases are staggered across the control period so a
+ *   ward does not fire every bed in the same wheel slot.
+ *
+ * Per-patient counters:
+ * - jitter:          dispatch start time minus scheduled tick time
+ * - deadline miss:   cycle finished after scheduled time + period
+ * - skipped periods: whole periods lost because a cycle overran
+ *
+ * These counters answer "how many beds fit on a core" without CI-visible
+ * timing assertions; the engine itself never throttles or drops patients.
+ */
+
+#include "control_cycle.hpp"
+#include "cluster_replication.hpp"
+#include "config_defaults.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ivsys {
+
+// Produces the next telemetry sample for a patient at the given therapy time.
+using TelemetrySource = std::function<Telemetry(double therapy_time_seconds)>;
+
+struct PatientTickStats {
+    std::string session_id;
+    std::uint64_t ticks = 0;
+    std::uint64_t deadline_misses = 0;
+    std::uint64_t skipped_periods = 0;
+    double last_jitter_ms = 0.0;
+    double mean_jitter_ms = 0.0;
+    double max_jitter_ms = 0.0;
+    double mean_exec_ms = 0.0;
+    double max_exec_ms = 0.0;
+    double current_infusion_rate = 0.0;
+
+    // Cluster replication (zeros without a sink)
+    std::uint64_t replication_frames = 0;
+    std::uint64_t replication_full_frames = 0;
+    std::uint64_t replication_rejected = 0;
+    std::uint64_t replication_bytes = 0;
+    double mean_replication_us = 0.0;
+    double max_replication_us = 0.0;
+};
+
+// Fixed-resolution hashed timer wheel.  Entries further out than one
+// revolution simply stay in their slot until their due time is reached.
+// Not thread-safe; MultiPatientEngine guards it with its own mutex.
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TimerWheel(std::chrono::milliseconds resolution, size_t slot_count);
+
+    void schedule(size_t id, Clock::time_point due);
+
+    // Advance the cursor to `now`, appending every id whose due time has
+    // been reached to `expired`.
+    void advance(Clock::time_point now, std::vector<size_t>& expired);
+
+    Clock::time_point next_slot_time() const { return cursor_time_ + resolution_; }
+    std::chrono::milliseconds resolution() const { return resolution_; }
+
+private:
+    struct Entry {
+        size_t id;
+        Clock::time_point due;
+    };
+
+    size_t slot_for(Clock::time_point due) const;
+
+    std::chrono::milliseconds resolution_;
+    std::vector<std::vector<Entry>> slots_;
+    size_t cursor_ = 0;
+    Clock::time_point cursor_time_;
+};
+
+class MultiPatientEngine {
+public:
+    struct Options {
+        size_t worker_threads = 1;
+        std::chrono::milliseconds period{
+            static_cast<int>(config::CONTROL_PERIOD_SEC * 1000.0)};
+        std::chrono::milliseconds timer_resolution{5};
+        size_t wheel_slots = 64;
+        // Async logging keeps per-bed file I/O off the worker threads.
+        LoggerMode log_mode = LoggerMode::Sync;
+        SessionFormat session_format = SessionFormat::Csv;
+        // One read-only model shared by every bed; null loads
+        // default_energy_proxy() when the engine is constructed.
+        EnergyProxyModelPtr energy_model;
+        // Cluster mode: every tick's checkpoint goes to this standby sink
+        // (cluster_replication.hpp), timed as part of the tick.  The sink
+        // is shared by all workers and must outlive the engine.
+        replication::ReplicationSink* replication = nullptr;
+        replication::CheckpointPublisher::Options replication_options;
+    };
+
+    MultiPatientEngine();
+    explicit MultiPatientEngine(const Options& options);
+    ~MultiPatientEngine();
+
+    MultiPatientEngine(const MultiPatientEngine&) = delete;
+    MultiPatientEngine& operator=(const MultiPatientEngine&) = delete;
+
+    // Register a patient.  Must be called before start().
+    // Returns the patient's index for stats lookup.
+    size_t add_patient(const PatientProfile& profile,
+                       const std::string& session_id,
+                       TelemetrySource source,
+                       PatientClass patient_class = PatientClass::Standard);
+
+    void start();
+    void stop();
+    bool is_running() const { return running_.load(); }
+
+    size_t patient_count() const { return patients_.size(); }
+    PatientTickStats stats(size_t patient_index) const;
+    std::vector<PatientTickStats> all_stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct PatientSlot {
+        PatientSlot(const PatientProfile& profile, const std::string& sid,
+                    TelemetrySource src, LoggerMode log_mode, SessionFormat format,
+                    EnergyProxyModelPtr energy_model, PatientClass patient_class)
+            : session_id(sid), cycle(profile, sid, log_mode, format, std::move(energy_model), patient_class),
+              source(std::move(src)) {}
+
+        std::string session_id;
+        PatientControlCycle cycle;
+        TelemetrySource source;
+        std::unique_ptr<replication::CheckpointPublisher> publisher;
+
+        Clock::time_point scheduled;        // tick currently armed
+        Clock::time_point last_scheduled;   // previous tick that ran
+        bool has_run = false;
+        double therapy_time_s = 0.0;
+
+        mutable std::mutex stats_mutex;
+        PatientTickStats stats;
+    };
+
+    void timer_loop();
+    void worker_loop();
+    void run_patient(size_t index);
+
+    Options options_;
+    std::vector<std::unique_ptr<PatientSlot>> patients_;
+
+    std::atomic<bool> running_{false};
+    std::thread timer_thread_;
+    std::vector<std::thread> workers_;
+
+    std::mutex wheel_mutex_;
+    TimerWheel wheel_;
+
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<size_t> ready_queue_;
+};
+
+} // namespace ivsys
@@ -66,5 +66,48 @@ std::vector<TreatmentFlow> align_buffer(size_t size) {
     return buffer;
 }
 
+void route_batch(TreatmentFlow* flows, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        TreatmentFlow& flow = flows[i];
+        PatientState& s = flow.state;
+
+        // dose_route: out-of-range hydration is clamped and invalidates the
+        // flow (the clamp is an identity in range, but NaN must pass through)
+        bool in_range = !((s.hydration_pct < 0.0) | (s.hydration_pct > 100.0));
+        double clamped = Utils::clamp(s.hydration_pct, 0.0, 100.0);
+        s.hydration_pct = in_range ? s.hydration_pct : clamped;
+        flow.confidence = 1.0 - s.uncertainty;
+        flow.desired_rate = 0.0;
+
+        // reject_noise
+        bool noisy = s.uncertainty > 0.8;
+        double damped = s.coherence_sigma * 0.5;
+        double risk_floor = std::max(s.risk_score, 0.5);
+        s.coherence_sigma = noisy ? damped : s.coherence_sigma;
+        s.risk_score = noisy ? risk_floor : s.risk_score;
+        bool artifact = (s.heart_rate_bpm < 20.0) | (s.heart_rate_bpm > 300.0);
+        bool valid = in_range & !noisy & !artifact;
+        flow.is_valid = valid;
+
+        // fallback_floor
+        bool floor = !valid | (s.coherence_sigma < 0.2);
+        double energy_cap = std::min(s.energy_T, 0.5);
+        double risk_cap = std::max(s.risk_score, 0.7);
+        double reserve_floor = std::max(s.cardiac_reserve, 0.1);
+        s.coherence_sigma = floor ? 0.2 : s.coherence_sigma;
+        s.energy_T = floor ? energy_cap : s.energy_T;
+        s.risk_score = floor ? risk_cap : s.risk_score;
+        s.cardiac_reserve = floor ? reserve_floor : s.cardiac_reserve;
+        flow.fallback_triggered = floor;
+
+        s.estimated_flow_velocity_cm_s = std::max(s.estimated_flow_velocity_cm_s, 0.0);
+        s.flow_efficiency = Utils::clamp(s.flow_efficiency, 0.0, 1.0);
+    }
+}
+
+void route_batch(std::vector<TreatmentFlow>& flows) {
+    route_batch(flows.data(), flows.size());
+}
+
 } // namespace precision_spine
 } // namespace ivsys
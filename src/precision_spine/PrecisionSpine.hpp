@@ -22,5 +22,15 @@ PatientState fallback_floor(const TreatmentFlow& flow);
 // Allocates a vector of aligned TreatmentFlow objects
 std::vector<TreatmentFlow> align_buffer(size_t size);
 
+// run dose_route -> reject_noise -> fallback_floor in place over many flows
+// On entry only flows[i].state (the raw estimator output) is read.  On
+// return state is the validated state, is_valid and confidence match the
+// scalar pipeline's reject_noise() result, desired_rate is 0 and
+// fallback_triggered records whether the fallback floor was applied.
+// Bit-identical to the scalar stages; no per-flow copies and no branches
+// on the data, so the loop compiles to selects.
+void route_batch(TreatmentFlow* flows, size_t count);
+void route_batch(std::vector<TreatmentFlow>& flows);
+
 } // namespace precision_spine
 } // namespace ivsys
@@ -0,0 +1,113 @@
+#include "realtime_scheduling.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#ifdef __linux__
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+namespace ivsys {
+
+namespace {
+
+std::string failure(const char* step, int err) {
+    return std::string(step) + ": " + std::strerror(err);
+}
+
+#ifdef __linux__
+// Touch every page of a stack region so later calls never fault it in.
+__attribute__((noinline)) void prefault_stack(size_t bytes) {
+    constexpr size_t kChunk = 16 * 1024;
+    volatile unsigned char buf[kChunk];
+    for (size_t i = 0; i < kChunk; i += 4096) buf[i] = 0;
+    if (bytes > kChunk) prefault_stack(bytes - kChunk);
+    buf[0] = buf[0];   // keeps the frame live across the call (no tail call)
+}
+#endif
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+} // namespace
+
+RealtimeResult apply_realtime(const RealtimeOptions& options) {
+    if (options.fifo_priority < 0 || options.fifo_priority > 99) {
+        throw std::invalid_argument("realtime: fifo_priority must be 0-99");
+    }
+    RealtimeResult result;
+    result.scheduling.realtime = options.enabled;
+    if (!options.enabled) return result;
+    result.scheduling.spin_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(options.spin_window).count();
+
+#ifdef __linux__
+    if (options.cpu >= 0) {
+        if (options.cpu >= CPU_SETSIZE) {
+            result.failures.push_back(failure("sched_setaffinity", EINVAL));
+        } else {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(options.cpu, &set);
+            int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+            if (rc == 0) result.scheduling.cpu = options.cpu;
+            else result.failures.push_back(failure("sched_setaffinity", rc));
+        }
+    }
+
+    if (options.fifo_priority > 0) {
+        sched_param param{};
+        param.sched_priority = options.fifo_priority;
+        int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (rc == 0) result.scheduling.fifo_priority = options.fifo_priority;
+        else result.failures.push_back(failure("SCHED_FIFO", rc));
+    }
+
+    if (options.lock_memory) {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+            result.scheduling.memory_locked = true;
+        } else {
+            result.failures.push_back(failure("mlockall", errno));
+        }
+        // Keep freed memory in the arena and serve large blocks from it,
+        // then grow the arena once so steady-state allocations reuse
+        // resident pages.
+        mallopt(M_TRIM_THRESHOLD, -1);
+        mallopt(M_MMAP_MAX, 0);
+        if (options.prefault_heap_bytes > 0) {
+            auto* block = static_cast<volatile unsigned char*>(std::malloc(options.prefault_heap_bytes));
+            if (block) {
+                for (size_t i = 0; i < options.prefault_heap_bytes; i += 4096) block[i] = 0;
+                std::free(const_cast<unsigned char*>(block));
+            }
+        }
+        prefault_stack(options.prefault_stack_bytes);
+    }
+#else
+    result.failures.push_back("realtime scheduling is only implemented for Linux");
+#endif
+    return result;
+}
+
+void hybrid_sleep_until(std::chrono::steady_clock::time_point deadline,
+                        std::chrono::nanoseconds spin) {
+    using Clock = std::chrono::steady_clock;
+    if (spin.count() <= 0) {
+        std::this_thread::sleep_until(deadline);
+        return;
+    }
+    if (Clock::now() < deadline - spin) std::this_thread::sleep_until(deadline - spin);
+    while (Clock::now() < deadline) cpu_relax();
+}
+
+} // namespace ivsys
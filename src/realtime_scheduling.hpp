@@ -0,0 +1,59 @@
+#pragma once
+
+/*
+ * realtime_scheduling.hpp
+ *
+ * Opt-in real-time setup for a control-loop thread (Linux).
+ *
+ * apply_realtime() configures the calling thread, step by step:
+ *   1. pin it to one core        (sched_setaffinity; use an isolcpus core)
+ *   2. SCHED_FIFO at a priority  (needs CAP_SYS_NICE or an rtprio limit)
+ *   3. lock and prefault memory  (mlockall, malloc trimming and mmap
+ *                                 allocation disabled, a heap arena and
+ *                                 the stack touched up front)
+ * A step that fails is reported in RealtimeResult::failures and the rest
+ * still run, so an unprivileged run degrades to whatever it is allowed.
+ * Threads inherit affinity and policy from their creator: call it after
+ * the REST, logger and display threads have been started.
+ *
+ * After step 3, per-tick allocations are served from the locked,
+ * prefaulted arena: no page faults and no mmap/brk system calls in the
+ * steady state.
+ *
+ * hybrid_sleep_until() sleeps until `spin` before the deadline and
+ * busy-waits the rest, which removes most of the timer-slack and wake-up
+ * latency of a plain sleep_until.
+ */
+
+#include "ControlLoopMetrics.hpp"
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ivsys {
+
+struct RealtimeOptions {
+    bool enabled = false;
+    int cpu = -1;                                   // -1: keep the current affinity
+    int fifo_priority = 80;                         // 1-99; 0: keep SCHED_OTHER
+    bool lock_memory = true;
+    size_t prefault_heap_bytes = 8 * 1024 * 1024;
+    size_t prefault_stack_bytes = 256 * 1024;
+    std::chrono::microseconds spin_window{500};     // 0: plain sleep_until
+};
+
+struct RealtimeResult {
+    LoopScheduling scheduling;          // what was achieved
+    std::vector<std::string> failures;  // one line per step that failed
+};
+
+// Applies `options` to the calling thread.  Throws std::invalid_argument
+// for a priority outside 0-99; OS refusals are reported, not thrown.
+RealtimeResult apply_realtime(const RealtimeOptions& options);
+
+// Returns at or after `deadline`, never before.
+void hybrid_sleep_until(std::chrono::steady_clock::time_point deadline,
+                        std::chrono::nanoseconds spin);
+
+} // namespace ivsys
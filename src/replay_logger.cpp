@@ -0,0 +1,481 @@
+#include "replay_logger.hpp"
+#include "StateEstimator.hpp"
+#include "AdaptiveController.hpp"
+#include "SafetyMonitor.hpp"
+#include "session_format.hpp"
+#include "precision_spine/PrecisionSpine.hpp"
+#include "Utils.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+
+namespace ivsys {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Read-only private mapping of a whole file.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("ReplayLogger: cannot open " + path);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("ReplayLogger: cannot stat " + path);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ > 0) {
+            addr_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr_ == MAP_FAILED) {
+                addr_ = nullptr;
+                ::close(fd);
+                throw std::runtime_error("ReplayLogger: cannot map " + path);
+            }
+            ::madvise(addr_, size_, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+    }
+
+    ~MappedFile() {
+        if (addr_) ::munmap(addr_, size_);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return static_cast<const char*>(addr_); }
+    size_t size() const { return size_; }
+
+    // Drop the resident pages wholly before `offset`; they are re-read
+    // from the file if touched again.
+    void release_before(size_t offset) {
+        size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        size_t end = offset / page * page;
+        if (addr_ && end > released_) {
+            ::madvise(static_cast<char*>(addr_) + released_, end - released_, MADV_DONTNEED);
+            released_ = end;
+        }
+    }
+
+private:
+    size_t released_ = 0;
+    void* addr_ = nullptr;
+    size_t size_ = 0;
+};
+
+bool file_exists(const std::string& path) {
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0;
+}
+
+// ---- CSV decoding (layout written by SystemLogger) ----
+
+class CsvCursor {
+public:
+    CsvCursor(const char* begin, const char* end) : p_(begin), end_(end) {}
+
+    bool at_end() const { return p_ >= end_; }
+    const char* position() const { return p_; }
+
+    void skip_line() {
+        if (p_ >= end_) return;
+        const char* nl = static_cast<const char*>(std::memchr(p_, '\n', end_ - p_));
+        p_ = nl ? nl + 1 : end_;
+    }
+
+    // Utils::timestamp_str: "<seconds>.<millis>"
+    bool timestamp(Clock::time_point& out) {
+        long long secs = 0, millis = 0;
+        auto r = std::from_chars(p_, end_, secs);
+        if (r.ec != std::errc() || r.ptr >= end_ || *r.ptr != '.') return false;
+        auto r2 = std::from_chars(r.ptr + 1, end_, millis);
+        if (r2.ec != std::errc()) return false;
+        p_ = r2.ptr;
+        out = Clock::time_point(std::chrono::duration_cast<Clock::duration>(
+            std::chrono::milliseconds(secs * 1000 + millis)));
+        return separator();
+    }
+
+    bool number(double& out) {
+        auto r = std::from_chars(p_, end_, out);
+        if (r.ec != std::errc()) return false;
+        p_ = r.ptr;
+        return separator();
+    }
+
+private:
+    bool separator() {
+        if (p_ < end_ && (*p_ == ',' || *p_ == '\n')) {
+            ++p_;
+            return true;
+        }
+        return p_ >= end_;
+    }
+
+    const char* p_;
+    const char* end_;
+};
+
+constexpr double Telemetry::* kCsvTelemetryFields[] = {
+    &Telemetry::hydration_pct,
+    &Telemetry::heart_rate_bpm,
+    &Telemetry::temp_celsius,
+    &Telemetry::blood_loss_idx,
+    &Telemetry::fatigue_idx,
+    &Telemetry::anxiety_idx,
+    &Telemetry::signal_quality,
+    &Telemetry::spo2_pct,
+    &Telemetry::lactate_mmol,
+    &Telemetry::cardiac_output_L_min,
+    &Telemetry::vault_mesh_size_nm,
+    &Telemetry::vault_payload_pct,
+};
+
+// One telemetry CSV row; false if it is malformed.
+bool parse_telemetry_row(CsvCursor& cur, Telemetry& m) {
+    bool ok = cur.timestamp(m.timestamp);
+    for (auto field : kCsvTelemetryFields) {
+        ok = ok && cur.number(m.*field);
+    }
+    double breached = 0.0;
+    ok = ok && cur.number(breached);
+    m.vault_cage_breached = breached != 0.0;
+    return ok;
+}
+
+void decode_telemetry_csv(const MappedFile& file, std::vector<Telemetry>& out) {
+    CsvCursor cur(file.data(), file.data() + file.size());
+    cur.skip_line();   // header
+    size_t line = 1;
+    while (!cur.at_end()) {
+        ++line;
+        Telemetry m;
+        if (!parse_telemetry_row(cur, m)) {
+            throw std::runtime_error("ReplayLogger: malformed telemetry CSV at line " +
+                                     std::to_string(line));
+        }
+        out.push_back(m);
+    }
+}
+
+// Only the decision itself is needed; warnings and rationale are skipped.
+void decode_control_csv(const MappedFile& file, std::vector<double>& rates) {
+    CsvCursor cur(file.data(), file.data() + file.size());
+    cur.skip_line();   // header
+    size_t line = 1;
+    while (!cur.at_end()) {
+        ++line;
+        Clock::time_point t;
+        double rate = 0.0;
+        if (!cur.timestamp(t) || !cur.number(rate)) {
+            throw std::runtime_error("ReplayLogger: malformed control CSV at line " +
+                                     std::to_string(line));
+        }
+        rates.push_back(rate);
+        cur.skip_line();
+    }
+}
+
+void decode_into(const ReplaySessionInfo& session, const ReplayOptions& options,
+                 DecodedSession& decoded) {
+    if (!session.binary_file.empty() && !options.prefer_csv) {
+        MappedFile file(session.binary_file);
+        session_format::SessionReader reader(file.data(), file.size());
+        decoded.telemetry = reader.all_telemetry();
+        decoded.logged_rates.reserve(decoded.telemetry.size());
+        for (size_t b = 0; b < reader.blocks().size(); ++b) {
+            const auto& e = reader.blocks()[b];
+            if (e.type != static_cast<std::uint16_t>(session_format::RecordType::Control)) continue;
+            const double* rate = reader.column(b, 1);
+            decoded.logged_rates.insert(decoded.logged_rates.end(), rate, rate + e.rows);
+        }
+        decoded.from_binary = true;
+        return;
+    }
+
+    MappedFile telemetry(session.telemetry_file);
+    decode_telemetry_csv(telemetry, decoded.telemetry);
+    if (file_exists(session.control_file)) {
+        MappedFile control(session.control_file);
+        decoded.logged_rates.reserve(decoded.telemetry.size());
+        decode_control_csv(control, decoded.logged_rates);
+    }
+}
+
+void finish_stage(ReplayStageStats& stage, Clock::duration elapsed, size_t rows) {
+    stage.seconds = std::chrono::duration<double>(elapsed).count();
+    stage.rows_per_sec = stage.seconds > 0.0 ? static_cast<double>(rows) / stage.seconds : 0.0;
+}
+
+} // namespace
+
+ReplaySessionInfo ReplayLogger::load_session(const std::string& session_id) {
+    return load_session(session_id, std::string());
+}
+
+ReplaySessionInfo ReplayLogger::load_session(const std::string& session_id,
+                                             const std::string& directory) {
+    ReplaySessionInfo info;
+    info.session_id = session_id;
+    std::string prefix = "ai_iv_" + session_id;
+    if (!directory.empty()) prefix = directory + "/" + prefix;
+    info.telemetry_file = prefix + "_telemetry.csv";
+    info.control_file = prefix + "_control.csv";
+    info.system_log_file = prefix + "_system.log";
+    std::string binary = prefix + session_format::kFileSuffix;
+    if (file_exists(binary)) info.binary_file = binary;
+
+    if (info.binary_file.empty() && !file_exists(info.telemetry_file)) {
+        throw std::runtime_error("ReplayLogger: no session files found for " + session_id);
+    }
+    return info;
+}
+
+std::vector<std::string> ReplayLogger::find_sessions(const std::string& directory) {
+    DIR* dir = ::opendir(directory.c_str());
+    if (!dir) {
+        throw std::runtime_error("ReplayLogger: cannot read directory " + directory);
+    }
+    const std::string prefix = "ai_iv_";
+    const std::string suffixes[] = {"_telemetry.csv", session_format::kFileSuffix};
+    std::vector<std::string> ids;
+    while (const dirent* entry = ::readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.compare(0, prefix.size(), prefix) != 0) continue;
+        for (const std::string& suffix : suffixes) {
+            if (name.size() > prefix.size() + suffix.size() &&
+                name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                ids.push_back(name.substr(prefix.size(), name.size() - prefix.size() - suffix.size()));
+            }
+        }
+    }
+    ::closedir(dir);
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+DecodedSession ReplayLogger::decode(const ReplaySessionInfo& session,
+                                   const ReplayOptions& options) {
+    DecodedSession decoded;
+    decoded.session_id = session.session_id;
+    auto start = Clock::now();
+    decode_into(session, options, decoded);
+    finish_stage(decoded.decode, Clock::now() - start, decoded.telemetry.size());
+    return decoded;
+}
+
+size_t ReplayLogger::stream_telemetry(const ReplaySessionInfo& session, const ReplayOptions& options,
+                                      size_t chunk_rows, const TelemetryChunkVisitor& visit) {
+    chunk_rows = std::max<size_t>(chunk_rows, 1);
+    std::vector<Telemetry> chunk;
+    chunk.reserve(chunk_rows);
+    size_t total = 0;
+    auto deliver = [&] {
+        if (chunk.empty()) return;
+        visit(chunk.data(), chunk.size());
+        total += chunk.size();
+        chunk.clear();
+    };
+
+    if (!session.binary_file.empty() && !options.prefer_csv) {
+        MappedFile file(session.binary_file);
+        session_format::SessionReader reader(file.data(), file.size());
+        std::vector<Telemetry> block_rows;
+        for (size_t b = 0; b < reader.blocks().size(); ++b) {
+            const auto& e = reader.blocks()[b];
+            if (e.type != static_cast<std::uint16_t>(session_format::RecordType::Telemetry)) continue;
+            block_rows.clear();
+            reader.read_telemetry(b, block_rows);
+            for (const Telemetry& m : block_rows) {
+                chunk.push_back(m);
+                if (chunk.size() == chunk_rows) deliver();
+            }
+            // Blocks are written in time order, so telemetry before this
+            // one is done with; the index at the end stays mapped
+            file.release_before(static_cast<size_t>(e.offset));
+        }
+        deliver();
+        return total;
+    }
+
+    MappedFile file(session.telemetry_file);
+    CsvCursor cur(file.data(), file.data() + file.size());
+    cur.skip_line();   // header
+    size_t line = 1;
+    while (!cur.at_end()) {
+        ++line;
+        Telemetry m;
+        if (!parse_telemetry_row(cur, m)) {
+            deliver();
+            throw std::runtime_error("ReplayLogger: malformed telemetry CSV at line " +
+                                     std::to_string(line));
+        }
+        chunk.push_back(m);
+        if (chunk.size() == chunk_rows) {
+            deliver();
+            file.release_before(static_cast<size_t>(cur.position() - file.data()));
+        }
+    }
+    deliver();
+    return total;
+}
+
+ReplayStepper::ReplayStepper(const PatientProfile& profile, const ReplayOptions& options)
+    : profile_(profile),
+      estimator_(options.energy_model ? options.energy_model : default_energy_proxy()),
+      controller_(profile, options.tuning),
+      safety_(profile, options.tuning),
+      dt_seconds_(options.dt_seconds) {
+    if (profile.weight_kg <= 0.0) {
+        throw std::invalid_argument("ReplayLogger: patient weight must be positive");
+    }
+    estimator_.set_neural_energy_proxy(options.tuning.neural_energy_proxy);
+}
+
+double ReplayStepper::dt_seconds(const Telemetry& m) const {
+    if (dt_seconds_ > 0.0) return dt_seconds_;
+    return rows_ > 0 ? std::chrono::duration<double>(m.timestamp - previous_).count()
+                     : config::CONTROL_PERIOD_SEC;
+}
+
+ControlOutput ReplayStepper::step(const Telemetry& m, double dt_seconds, PatientState& validated,
+                                  StageTimes* times) {
+    double dt_minutes = dt_seconds / 60.0;
+    auto t0 = Clock::now();
+    PatientState state = estimator_.estimate(m, profile_, current_rate_);
+    auto t1 = Clock::now();
+    precision_spine::TreatmentFlow routed = precision_spine::dose_route(state);
+    precision_spine::TreatmentFlow safe = precision_spine::reject_noise(routed);
+    validated = precision_spine::fallback_floor(safe);
+    auto t2 = Clock::now();
+    ControlOutput command = controller_.decide(validated, safety_, estimator_, dt_minutes);
+    safety_.update_volume(command.infusion_ml_per_min, dt_minutes);
+    auto t3 = Clock::now();
+    if (times) {
+        times->estimate += t1 - t0;
+        times->spine += t2 - t1;
+        times->control += t3 - t2;
+    }
+    current_rate_ = command.infusion_ml_per_min;
+    previous_ = m.timestamp;
+    ++rows_;
+    return command;
+}
+
+ReplayReport ReplayLogger::replay(const ReplaySessionInfo& session,
+                                  const PatientProfile& profile,
+                                  const ReplayOptions& options,
+                                  const ReplayObserver& observer) {
+    return replay(decode(session, options), profile, options, observer);
+}
+
+ReplayReport ReplayLogger::replay(const DecodedSession& decoded,
+                                  const PatientProfile& profile,
+                                  const ReplayOptions& options,
+                                  const ReplayObserver& observer) {
+    ReplayReport report;
+    report.session_id = decoded.session_id;
+    report.from_binary = decoded.from_binary;
+    report.ticks = decoded.telemetry.size();
+    report.decode = decoded.decode;
+
+    auto loop_start = Clock::now();
+    ReplayStepper stepper(profile, options);
+    double rate_sum = 0.0, abs_change_sum = 0.0;
+
+    ReplayStepper::StageTimes times;
+    const auto& rows = decoded.telemetry;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const Telemetry& m = rows[i];
+        double dt_seconds = stepper.dt_seconds(m);
+        report.session_seconds += dt_seconds;
+
+        double previous_rate = stepper.current_rate();
+        PatientState validated;
+        ControlOutput command = stepper.step(m, dt_seconds, validated, &times);
+
+        double change = std::fabs(command.infusion_ml_per_min - previous_rate);
+        if (i > 0) {
+            abs_change_sum += change;
+            report.max_abs_rate_change = std::max(report.max_abs_rate_change, change);
+        }
+        double current_rate = command.infusion_ml_per_min;
+        rate_sum += current_rate;
+        if (command.safety_override) ++report.safety_overrides;
+        if (command.warning_flags.has(WarningFlag::RateChangeLimited)) {
+            ++report.rate_limited_ticks;
+        }
+
+        if (i < decoded.logged_rates.size()) {
+            double deviation = std::fabs(current_rate - decoded.logged_rates[i]);
+            report.max_rate_deviation = std::max(report.max_rate_deviation, deviation);
+            if (deviation > options.mismatch_tolerance) ++report.mismatches;
+            ++report.compared;
+        }
+        if (observer) observer(m, validated, command);
+    }
+
+    finish_stage(report.estimate, times.estimate, report.ticks);
+    finish_stage(report.spine, times.spine, report.ticks);
+    finish_stage(report.control, times.control, report.ticks);
+    report.total_volume_ml = stepper.cumulative_volume_ml();
+    if (report.ticks > 0) report.mean_rate_ml_min = rate_sum / static_cast<double>(report.ticks);
+    if (report.ticks > 1) {
+        report.mean_abs_rate_change = abs_change_sum / static_cast<double>(report.ticks - 1);
+    }
+    report.total_seconds = report.decode.seconds +
+        std::chrono::duration<double>(Clock::now() - loop_start).count();
+    report.speedup = report.total_seconds > 0.0 ? report.session_seconds / report.total_seconds : 0.0;
+    return report;
+}
+
+ReplayReport ReplayLogger::export_reconstructed_state(const ReplaySessionInfo& session,
+                                                      const PatientProfile& profile,
+                                                      const std::string& output_path,
+                                                      const ReplayOptions& options) {
+    std::ofstream out(output_path);
+    if (!out.is_open()) {
+        throw std::runtime_error("ReplayLogger: cannot open " + output_path);
+    }
+    out << "timestamp,hydration_pct,heart_rate_bpm,coherence_sigma,energy_T,"
+        << "energy_T_abs_W_kg,metabolic_load,cardiac_reserve,risk_score,"
+        << "flow_velocity_cm_s,flow_efficiency,uncertainty,"
+        << "infusion_rate_ml_min,confidence,safety_override\n";
+
+    return replay(session, profile, options,
+        [&out](const Telemetry& m, const PatientState& s, const ControlOutput& c) {
+            out << Utils::timestamp_str(m.timestamp) << ","
+                << s.hydration_pct << ","
+                << s.heart_rate_bpm << ","
+                << s.coherence_sigma << ","
+                << s.energy_T << ","
+                << s.energy_T_absolute << ","
+                << s.metabolic_load << ","
+                << s.cardiac_reserve << ","
+                << s.risk_score << ","
+                << s.estimated_flow_velocity_cm_s << ","
+                << s.flow_efficiency << ","
+                << s.uncertainty << ","
+                << c.infusion_ml_per_min << ","
+                << c.confidence << ","
+                << c.safety_override << "\n";
+        });
+}
+
+} // namespace ivsys
@@ -3,17 +3,36 @@
 /*
  * replay_logger.hpp
  *
- * Conceptual interface for replaying and analyzing
- * logged IV control sessions.
+ * Offline replay of logged IV control sessions.
  *
- * This file documents how telemetry and control logs
- * can be reconstructed for offline analysis, validation,
- * and visualization.
+ * A session's logs (the binary .aivs file when present, otherwise the
+ * telemetry/control CSVs) are memory-mapped and decoded in one pass, then
+ * every telemetry row is pushed through StateEstimator -> precision_spine
+ * -> AdaptiveController -> SafetyMonitor exactly as PatientControlCycle
+ * would, with no sleeps and no logging.  Each stage is timed separately so
+ * the report shows where replay time goes.
  *
- * No runtime behavior is implemented here.
+ * The replayed infusion rate is compared against the logged one.  Binary
+ * sessions replay bit-for-bit; CSV sessions carry six significant digits,
+ * so small deviations are expected there.
+ *
+ * The patient profile is not part of the session logs and must be given.
+ * ReplayOptions::tuning replaces the compile-time safety thresholds and
+ * controller gains, which is how WhatIfEngine compares configurations; a
+ * DecodedSession can be replayed any number of times, from any thread.
  */
 
+#include "iv_system_types.hpp"
+#include "config_defaults.hpp"
+#include "EnergyProxyModel.hpp"
+#include "StateEstimator.hpp"
+#include "AdaptiveController.hpp"
+#include "SafetyMonitor.hpp"
+#include <chrono>
+#include <cstddef>
+#include <functional>
 #include <string>
+#include <vector>
 
 namespace ivsys {
 
@@ -22,36 +41,177 @@ struct ReplaySessionInfo {
     std::string telemetry_file;
     std::string control_file;
     std::string system_log_file;
+    std::string binary_file;      // empty when the session has no .aivs file
+};
+
+struct ReplayOptions {
+    // Therapy time per row.  <= 0 derives it from consecutive telemetry
+    // timestamps instead (for sessions recorded by MultiPatientEngine).
+    double dt_seconds = config::CONTROL_PERIOD_SEC;
+    // |replayed - logged| infusion rate above which a row counts as a mismatch.
+    double mismatch_tolerance = 1e-4;
+    // Decode the CSV pair even if a binary session file exists.
+    bool prefer_csv = false;
+    // Thresholds and gains used by the replayed controller.
+    config::ControlTuning tuning;
+    // Energy-proxy model for the replayed estimator; null uses
+    // default_energy_proxy().  tuning.neural_energy_proxy = false still
+    // forces the rule formula.
+    EnergyProxyModelPtr energy_model;
+
+    // Fill in energy_model now rather than in each ReplayStepper.  Engines
+    // that replay on a worker pool call it when constructed, so the default
+    // model is loaded once on the caller's thread and every worker shares it.
+    void resolve_energy_model() {
+        if (!energy_model) energy_model = default_energy_proxy();
+    }
+};
+
+struct ReplayStageStats {
+    double seconds = 0.0;
+    double rows_per_sec = 0.0;
+};
+
+// A session's telemetry and logged decisions, decoded into memory.
+struct DecodedSession {
+    std::string session_id;
+    bool from_binary = false;
+    std::vector<Telemetry> telemetry;
+    std::vector<double> logged_rates;   // one per logged decision; may be shorter
+    ReplayStageStats decode;            // map + parse
+};
+
+struct ReplayReport {
+    std::string session_id;
+    bool from_binary = false;
+    size_t ticks = 0;
+    double session_seconds = 0.0;   // therapy time covered by the replay
+
+    ReplayStageStats decode;        // map + parse
+    ReplayStageStats estimate;
+    ReplayStageStats spine;
+    ReplayStageStats control;       // controller decision + safety accounting
+    double total_seconds = 0.0;
+    double speedup = 0.0;           // session_seconds / total_seconds
+
+    size_t compared = 0;            // rows with a logged control decision
+    size_t mismatches = 0;
+    double max_rate_deviation = 0.0;
+
+    // Replayed decisions
+    size_t safety_overrides = 0;      // ticks with ControlOutput::safety_override
+    size_t rate_limited_ticks = 0;    // ticks flagged RATE_CHANGE_LIMITED
+    double total_volume_ml = 0.0;
+    double mean_rate_ml_min = 0.0;
+    double mean_abs_rate_change = 0.0;   // ml/min per tick
+    double max_abs_rate_change = 0.0;
+};
+
+// Called once per replayed tick with the decoded telemetry, the validated
+// state and the replayed decision.
+using ReplayObserver = std::function<void(const Telemetry&, const PatientState&,
+                                          const ControlOutput&)>;
+
+// Called with consecutive runs of a session's telemetry, oldest first.
+using TelemetryChunkVisitor = std::function<void(const Telemetry* rows, size_t count)>;
+
+/*
+ * One session's replay pipeline, advanced a row at a time.  replay() runs
+ * it over a decoded session; streaming consumers (FeatureExporter) feed
+ * it chunk by chunk, so both reconstruct exactly the same states and
+ * decisions.  Not thread-safe; one per session.
+ */
+class ReplayStepper {
+public:
+    struct StageTimes {
+        std::chrono::steady_clock::duration estimate{0};
+        std::chrono::steady_clock::duration spine{0};
+        std::chrono::steady_clock::duration control{0};   // decision + safety accounting
+    };
+
+    ReplayStepper(const PatientProfile& profile, const ReplayOptions& options);
+
+    // Therapy seconds row m covers: options.dt_seconds, or the gap since
+    // the previous row when that is <= 0.
+    double dt_seconds(const Telemetry& m) const;
+
+    // Estimate -> precision spine -> decide -> volume accounting for one
+    // row.  validated receives the state the controller saw; times, when
+    // given, accumulates per-stage wall time.
+    ControlOutput step(const Telemetry& m, double dt_seconds, PatientState& validated,
+                       StageTimes* times = nullptr);
+
+    double current_rate() const { return current_rate_; }
+    double cumulative_volume_ml() const { return safety_.get_cumulative_volume(); }
+    size_t rows() const { return rows_; }
+
+private:
+    PatientProfile profile_;
+    StateEstimator estimator_;
+    AdaptiveController controller_;
+    SafetyMonitor safety_;
+    double dt_seconds_;
+    double current_rate_ = 0.4;   // PatientControlCycle's initial rate
+    std::chrono::steady_clock::time_point previous_{};
+    size_t rows_ = 0;
 };
 
 class ReplayLogger {
 public:
     /*
-     * Load a completed session for offline analysis.
-     *
-     * Intended use:
-     * - Reconstruct control decisions
-     * - Validate safety behavior
-     * - Compare strategies
-     * - Support scientific review
+     * Locate a completed session's files in the working directory
+     * (ai_iv_<session_id>_*).  Throws std::runtime_error when neither the
+     * binary file nor the CSV pair exists.
      */
     static ReplaySessionInfo load_session(const std::string& session_id);
+    // Same, for a session archived in `directory`.
+    static ReplaySessionInfo load_session(const std::string& session_id,
+                                          const std::string& directory);
+
+    // Ids of every session in `directory` (a telemetry CSV or .aivs file),
+    // sorted.  Throws std::runtime_error if it cannot be read.
+    static std::vector<std::string> find_sessions(const std::string& directory);
+
+    /*
+     * Map and decode a session's logs (binary unless options.prefer_csv).
+     * Throws std::runtime_error on missing or malformed files.
+     */
+    static DecodedSession decode(const ReplaySessionInfo& session,
+                                 const ReplayOptions& options = ReplayOptions{});
 
     /*
-     * Replay telemetry and control events in time order.
-     *
-     * Future extensions may support:
-     * - accelerated playback
-     * - stepwise inspection
-     * - alternative controller comparison
+     * Decode a session's telemetry in runs of at most chunk_rows and hand
+     * each run to visit, releasing the mapped pages already consumed, so
+     * memory stays bounded however long the session is.  Returns the
+     * number of rows.  Throws as decode() does; rows visited before a
+     * malformed line have already been delivered.
      */
-    static void replay(const ReplaySessionInfo& session);
+    static size_t stream_telemetry(const ReplaySessionInfo& session, const ReplayOptions& options,
+                                   size_t chunk_rows, const TelemetryChunkVisitor& visit);
+
+    /*
+     * Replay the session at unbounded speed and report per-stage throughput
+     * and agreement with the logged decisions.
+     */
+    static ReplayReport replay(const ReplaySessionInfo& session,
+                               const PatientProfile& profile,
+                               const ReplayOptions& options = ReplayOptions{},
+                               const ReplayObserver& observer = nullptr);
+
+    // Replay an already decoded session; report.decode echoes its decode cost.
+    static ReplayReport replay(const DecodedSession& decoded,
+                               const PatientProfile& profile,
+                               const ReplayOptions& options = ReplayOptions{},
+                               const ReplayObserver& observer = nullptr);
 
     /*
-     * Export reconstructed state for visualization or ML analysis.
+     * Replay and write the reconstructed state per tick as CSV for
+     * visualization or ML analysis.
      */
-    static void export_reconstructed_state(const ReplaySessionInfo& session,
-                                           const std::string& output_path);
+    static ReplayReport export_reconstructed_state(const ReplaySessionInfo& session,
+                                                   const PatientProfile& profile,
+                                                   const std::string& output_path,
+                                                   const ReplayOptions& options = ReplayOptions{});
 };
 
 } // namespace ivsys
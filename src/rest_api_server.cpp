@@ -3,26 +3,105 @@
  */
 
 #include "rest_api_server.hpp"
+#include "control_text.hpp"
+#include "json_format.hpp"
+#include "config_defaults.hpp"
 #include <chrono>
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <charconv>
 #include <iostream>
-#include <sys/time.h>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstdio>
+#include <ctime>
+#include <limits>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 
 namespace ivsys {
 
-RestApiServer::RestApiServer(int port, const std::string& bind_address)
-    : port_(port), bind_address_(bind_address), server_socket_(-1), running_(false) {
-    
-    // Initialize with default values
-    current_telemetry_ = {0, 0, 0, 0, 0, 0, ""};
-    current_state_ = {0, 0, 0, 0, 0};
-    current_control_ = {0, "", ""};
+namespace {
+
+template <size_t N>
+void copy_text(char (&dst)[N], const std::string& src) {
+    size_t n = std::min(src.size(), N - 1);
+    std::memcpy(dst, src.data(), n);
+    dst[n] = '\0';
+}
+
+// Value of `key` in an undecoded query string; false if absent.
+bool query_param(const std::string& query, const char* key, std::string& out) {
+    const size_t key_len = std::strlen(key);
+    size_t pos = 0;
+    while (pos <= query.size()) {
+        size_t end = query.find('&', pos);
+        if (end == std::string::npos) end = query.size();
+        if (end - pos > key_len && query.compare(pos, key_len, key) == 0 && query[pos + key_len] == '=') {
+            out = query.substr(pos + key_len + 1, end - pos - key_len - 1);
+            return true;
+        }
+        pos = end + 1;
+    }
+    return false;
+}
+
+bool parse_int64(const std::string& text, std::int64_t& out) {
+    std::int64_t value = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec != std::errc() || result.ptr != text.data() + text.size()) return false;
+    out = value;
+    return true;
+}
+
+// Whole string, digits only: no sign, no whitespace, no overflow.
+bool parse_size(const std::string& text, size_t& out) {
+    size_t value = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec != std::errc() || result.ptr != text.data() + text.size()) return false;
+    out = value;
+    return true;
+}
+
+void write_latency_json(std::ostream& json, const LatencyHistogram::Snapshot& h) {
+    json << "{"
+         << "\"count\":" << h.count << ","
+         << "\"mean_us\":" << h.mean_us() << ","
+         << "\"p50_us\":" << h.percentile_us(0.50) << ","
+         << "\"p99_us\":" << h.percentile_us(0.99) << ","
+         << "\"max_us\":" << h.max_us()
+         << "}";
+}
+
+} // namespace
+
+const char* const RestApiServer::ENDPOINT_NAMES[RestApiServer::ENDPOINT_COUNT] = {
+    "/api/status", "/api/telemetry", "/api/telemetry/history", "/api/control",
+    "/api/state", "/api/alerts", "/api/config", "/api/metrics", "/api/metrics/loop", "/api/prediction",
+    "/api/telemetry/range", "/", "other",
+};
+
+RestApiServer::RestApiServer(int port, const std::string& bind_address, size_t worker_threads)
+    : port_(port), bind_address_(bind_address),
+      worker_count_(worker_threads == 0 ? 1 : worker_threads),
+      server_socket_(-1), epoll_fd_(-1), wake_fd_(-1), running_(false),
+      history_fragments_(TELEMETRY_HISTORY_SIZE), history_chunks_(HISTORY_CHUNK_SLOTS) {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    std::ostringstream tag;
+    tag << std::hex << std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+    instance_tag_ = tag.str();
+
+    // Created once so publishers can signal it whether or not the server
+    // is running.
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
 }
 
 RestApiServer::~RestApiServer() {
     stop();
+    if (wake_fd_ >= 0) close(wake_fd_);
 }
 
 bool RestApiServer::start() {
@@ -31,7 +110,7 @@ bool RestApiServer::start() {
     }
     
     // Create socket
-    server_socket_ = socket(AF_INET, SOCK_STREAM, 0);
+    server_socket_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
     if (server_socket_ < 0) {
         std::cerr << "Failed to create server socket" << std::endl;
         return false;
@@ -42,11 +121,13 @@ bool RestApiServer::start() {
     if (setsockopt(server_socket_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
         std::cerr << "Failed to set socket options" << std::endl;
         close(server_socket_);
+        server_socket_ = -1;
         return false;
     }
     
     // Bind to address
     struct sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
     address.sin_family = AF_INET;
     address.sin_port = htons(port_);
     
@@ -56,6 +137,7 @@ bool RestApiServer::start() {
         if (inet_pton(AF_INET, bind_address_.c_str(), &address.sin_addr) <= 0) {
             std::cerr << "Invalid bind address" << std::endl;
             close(server_socket_);
+            server_socket_ = -1;
             return false;
         }
     }
@@ -63,21 +145,61 @@ bool RestApiServer::start() {
     if (bind(server_socket_, (struct sockaddr*)&address, sizeof(address)) < 0) {
         std::cerr << "Failed to bind to port " << port_ << std::endl;
         close(server_socket_);
+        server_socket_ = -1;
         return false;
     }
     
     // Start listening
-    if (listen(server_socket_, 10) < 0) {
+    if (listen(server_socket_, SOMAXCONN) < 0) {
         std::cerr << "Failed to listen on socket" << std::endl;
         close(server_socket_);
+        server_socket_ = -1;
+        return false;
+    }
+
+    // Resolve an ephemeral port request
+    socklen_t address_len = sizeof(address);
+    if (getsockname(server_socket_, (struct sockaddr*)&address, &address_len) == 0) {
+        port_ = ntohs(address.sin_port);
+    }
+
+    // Event loop: listener plus the wake-up eventfd
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    bool registered = epoll_fd_ >= 0 && wake_fd_ >= 0;
+    if (registered) {
+        ev.data.fd = server_socket_;
+        registered = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, server_socket_, &ev) == 0;
+    }
+    if (registered) {
+        ev.data.fd = wake_fd_;
+        registered = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev) == 0;
+    }
+    if (!registered) {
+        std::cerr << "Failed to set up epoll event loop" << std::endl;
+        if (epoll_fd_ >= 0) close(epoll_fd_);
+        close(server_socket_);
+        epoll_fd_ = server_socket_ = -1;
         return false;
     }
     
-    // Start server thread
+    // Start worker pool and server thread
     running_.store(true);
+    stream_have_last_ = false;
+    stream_last_heartbeat_ = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(job_mutex_);
+        workers_stopping_ = false;
+    }
+    for (size_t i = 0; i < worker_count_; ++i) {
+        workers_.emplace_back(&RestApiServer::worker_loop, this);
+    }
     server_thread_ = std::thread(&RestApiServer::server_loop, this);
     
-    std::cout << "REST API Server started on " << bind_address_ << ":" << port_ << std::endl;
+    std::cout << "REST API Server started on " << bind_address_ << ":" << port_
+              << " (" << worker_count_ << " workers)" << std::endl;
     return true;
 }
 
@@ -85,246 +207,1126 @@ void RestApiServer::stop() {
     if (running_.load()) {
         running_.store(false);
         
-        // Close server socket to unblock accept()
-        if (server_socket_ >= 0) {
-            close(server_socket_);
-            server_socket_ = -1;
-        }
-        
-        // Wait for thread to finish
+        // Wake the event loop and wait for it to close every connection
+        wake_event_loop();
         if (server_thread_.joinable()) {
             server_thread_.join();
         }
+
+        {
+            std::lock_guard<std::mutex> lock(job_mutex_);
+            workers_stopping_ = true;
+            jobs_.clear();
+        }
+        job_cv_.notify_all();
+        for (auto& w : workers_) {
+            if (w.joinable()) w.join();
+        }
+        workers_.clear();
+        completions_.clear();
+
+        close(epoll_fd_);
+        close(server_socket_);
+        epoll_fd_ = server_socket_ = -1;
         
         std::cout << "REST API Server stopped" << std::endl;
     }
 }
 
+void RestApiServer::wake_event_loop() {
+    std::uint64_t one = 1;
+    if (wake_fd_ >= 0) {
+        ssize_t written = write(wake_fd_, &one, sizeof(one));
+        (void)written;  // EAGAIN only if the counter is already non-zero
+    }
+}
+
 void RestApiServer::server_loop() {
+    constexpr int MAX_EVENTS = 64;
+    struct epoll_event events[MAX_EVENTS];
+    auto last_sweep = std::chrono::steady_clock::now();
+
     while (running_.load()) {
+        int n = epoll_wait(epoll_fd_, events, MAX_EVENTS, EPOLL_TIMEOUT_MS);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "epoll_wait failed" << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == server_socket_) {
+                accept_connections();
+                continue;
+            }
+            if (fd == wake_fd_) {
+                std::uint64_t count;
+                while (read(wake_fd_, &count, sizeof(count)) > 0) {
+                }
+                drain_completions();
+                if (stream_pending_.exchange(false)) broadcast_stream_frame();
+                continue;
+            }
+
+            auto it = connections_.find(fd);
+            if (it == connections_.end()) continue;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                close_connection(fd);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                flush_output(fd, it->second);
+                it = connections_.find(fd);
+                if (it == connections_.end()) continue;
+            }
+            if (events[i].events & EPOLLIN) {
+                handle_readable(fd, it->second);
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_sweep >= std::chrono::milliseconds(EPOLL_TIMEOUT_MS)) {
+            close_idle_connections();
+            send_stream_heartbeats();
+            last_sweep = now;
+        }
+    }
+
+    while (!connections_.empty()) {
+        close_connection(connections_.begin()->first);
+    }
+}
+
+void RestApiServer::accept_connections() {
+    while (true) {
         struct sockaddr_in client_addr;
         socklen_t client_len = sizeof(client_addr);
-        
-        int client_socket = accept(server_socket_, (struct sockaddr*)&client_addr, &client_len);
-        
-        if (client_socket < 0) {
-            if (running_.load()) {
+        int fd = accept4(server_socket_, (struct sockaddr*)&client_addr, &client_len,
+                         SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK && running_.load()) {
                 std::cerr << "Accept failed" << std::endl;
             }
-            break;
+            return;
         }
-        
-        // Handle client in same thread (simple implementation)
-        // Could be improved with thread pool for production
-        handle_client(client_socket);
-        close(client_socket);
+
+        if (connections_.size() >= MAX_CONNECTIONS) {
+            close(fd);
+            continue;
+        }
+
+        int nodelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+        Connection conn;
+        conn.id = next_connection_id_++;
+        conn.last_activity = std::chrono::steady_clock::now();
+        conn.events = EPOLLIN;
+        struct epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = conn.events;
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            continue;
+        }
+        connections_.emplace(fd, std::move(conn));
+        open_connections_.store(connections_.size());
+    }
+}
+
+void RestApiServer::handle_readable(int fd, Connection& conn) {
+    char buffer[4096];
+    while (true) {
+        ssize_t bytes_read = recv(fd, buffer, sizeof(buffer), 0);
+        if (bytes_read > 0) {
+            conn.in.append(buffer, static_cast<size_t>(bytes_read));
+            conn.last_activity = std::chrono::steady_clock::now();
+            if (conn.in.size() > MAX_REQUEST_SIZE) break;  // parsed (and rejected) below
+            continue;
+        }
+        if (bytes_read < 0 && errno == EINTR) continue;
+        if (bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        close_connection(fd);  // orderly shutdown or hard error
+        return;
+    }
+    if (conn.streaming) {
+        conn.in.clear();  // subscribers have nothing more to say
+        return;
     }
+    dispatch_request(fd, conn);
 }
 
-void RestApiServer::handle_client(int client_socket) {
-    // Set a 5-second receive timeout to prevent slow-loris denial-of-service
-    struct timeval tv;
-    tv.tv_sec = 5;
-    tv.tv_usec = 0;
-    if (setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0) {
-        std::cerr << "Warning: failed to set SO_RCVTIMEO on client socket" << std::endl;
+void RestApiServer::dispatch_request(int fd, Connection& conn) {
+    if (conn.busy || conn.out_offset < conn.out.size() || conn.close_after_write) {
+        update_interest(fd, conn);
+        return;
     }
 
-    char buffer[MAX_REQUEST_SIZE];
-    ssize_t bytes_read = recv(client_socket, buffer, sizeof(buffer) - 1, 0);
-    
-    if (bytes_read <= 0 || static_cast<size_t>(bytes_read) >= MAX_REQUEST_SIZE) {
-        if (static_cast<size_t>(bytes_read) >= MAX_REQUEST_SIZE) {
-            std::string response = build_http_response(400, build_json_error("Request too large"));
-            send(client_socket, response.c_str(), response.length(), 0);
+    auto reject = [&](int status, const std::string& error) {
+        conn.in.clear();
+        conn.out = build_http_response(status, build_json_error(error), "application/json", false);
+        conn.out_offset = 0;
+        conn.close_after_write = true;
+        flush_output(fd, conn);
+    };
+
+    size_t header_end = conn.in.find("\r\n\r\n");
+    if (header_end == std::string::npos) {
+        if (conn.in.size() >= MAX_REQUEST_SIZE) {
+            reject(400, "Request too large");
+        } else {
+            update_interest(fd, conn);
         }
         return;
     }
-    
-    buffer[bytes_read] = '\0';
-    std::string request(buffer);
-    
-    // Parse HTTP method and path
-    std::istringstream request_stream(request);
+    if (header_end + 4 > MAX_REQUEST_SIZE) {
+        reject(400, "Request too large");
+        return;
+    }
+
+    // Request line
+    std::istringstream request_stream(conn.in.substr(0, header_end));
     std::string method, path, version;
     request_stream >> method >> path >> version;
+    std::string query;
+    size_t query_start = path.find('?');
+    if (query_start != std::string::npos) {
+        query = path.substr(query_start + 1);
+        path.erase(query_start);
+    }
+
+    // Headers we act on: Connection and Content-Length
+    std::string line;
+    std::getline(request_stream, line);
+    std::string connection_header;
+    std::string if_none_match;
+    size_t content_length = 0;
+    bool bad_length = false;
+    while (std::getline(request_stream, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string name = line.substr(0, colon);
+        std::string value = line.substr(colon + 1);
+        auto lower = [](std::string& text) {
+            std::transform(text.begin(), text.end(), text.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        };
+        lower(name);
+        value.erase(0, value.find_first_not_of(" \t"));
+        value.erase(value.find_last_not_of(" \t") + 1);
+        if (name == "connection") {
+            lower(value);
+            connection_header = value;
+        } else if (name == "if-none-match") {
+            if_none_match = value;   // entity tags are case-sensitive
+        } else if (name == "content-length") {
+            bad_length = bad_length || !parse_size(value, content_length);
+        }
+    }
+
+    // GET requests have no body, but drain one if sent so the next
+    // pipelined request starts at the right byte.  The length is framing:
+    // anything unparsable closes the connection rather than guess.
+    if (bad_length) {
+        reject(400, "Invalid Content-Length");
+        return;
+    }
+    if (content_length > MAX_REQUEST_SIZE - (header_end + 4)) {
+        reject(400, "Request too large");
+        return;
+    }
+    size_t request_size = header_end + 4 + content_length;
+    if (conn.in.size() < request_size) {
+        update_interest(fd, conn);
+        return;
+    }
+    conn.in.erase(0, request_size);
+
+    bool keep_alive = (version == "HTTP/1.1") ? connection_header != "close"
+                                              : connection_header == "keep-alive";
 
     // Validate path: reject traversal patterns
-    if (path.find("..") != std::string::npos ||
+    if (method.empty() || path.empty() ||
+        path.find("..") != std::string::npos ||
         path.find('\\') != std::string::npos) {
-        std::string response = build_http_response(400, build_json_error("Bad request"));
-        send(client_socket, response.c_str(), response.length(), 0);
+        reject(400, "Bad request");
         return;
     }
-    
-    // Route request
-    std::string response = route_request(method, path);
-    
-    // Send response
-    send(client_socket, response.c_str(), response.length(), 0);
+
+    if (method == "GET" && (path == "/api/stream" || path == "/api/stream/")) {
+        start_stream(fd, conn);
+        return;
+    }
+
+    Job job{fd, conn.id, HttpRequest{method, path, query, if_none_match, keep_alive},
+            std::chrono::steady_clock::now()};
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(job_mutex_);
+        if (jobs_.size() < MAX_PENDING_REQUESTS) {
+            jobs_.push_back(std::move(job));
+            queued = true;
+        }
+    }
+    if (!queued) {
+        rejected_requests_.fetch_add(1);
+        conn.out = build_http_response(503, build_json_error("Server busy"),
+                                       "application/json", keep_alive);
+        conn.out_offset = 0;
+        conn.close_after_write = !keep_alive;
+        flush_output(fd, conn);
+        return;
+    }
+    job_cv_.notify_one();
+    conn.busy = true;
+    update_interest(fd, conn);
+}
+
+void RestApiServer::worker_loop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(job_mutex_);
+            job_cv_.wait(lock, [this] { return workers_stopping_ || !jobs_.empty(); });
+            if (workers_stopping_) return;
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        const HttpRequest& request = job.request;
+        Completion done{job.fd, job.connection_id, route_request(request), request.keep_alive};
+        size_t endpoint = request.method == "GET" ? endpoint_index(request.path) : ENDPOINT_COUNT - 1;
+        endpoint_latency_[endpoint].record(std::chrono::steady_clock::now() - job.received);
+
+        {
+            std::lock_guard<std::mutex> lock(completion_mutex_);
+            completions_.push_back(std::move(done));
+        }
+        wake_event_loop();
+    }
+}
+
+void RestApiServer::drain_completions() {
+    std::vector<Completion> ready;
+    {
+        std::lock_guard<std::mutex> lock(completion_mutex_);
+        ready.swap(completions_);
+    }
+    for (auto& done : ready) {
+        auto it = connections_.find(done.fd);
+        if (it == connections_.end() || it->second.id != done.connection_id) continue;
+        Connection& conn = it->second;
+        conn.busy = false;
+        conn.out = std::move(done.response);
+        conn.out_offset = 0;
+        conn.close_after_write = !done.keep_alive;
+        flush_output(done.fd, conn);
+    }
+}
+
+void RestApiServer::flush_output(int fd, Connection& conn) {
+    while (conn.out_offset < conn.out.size()) {
+        ssize_t sent = send(fd, conn.out.data() + conn.out_offset,
+                            conn.out.size() - conn.out_offset, MSG_NOSIGNAL);
+        if (sent > 0) {
+            conn.out_offset += static_cast<size_t>(sent);
+            conn.last_activity = std::chrono::steady_clock::now();
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            update_interest(fd, conn);  // wait for EPOLLOUT
+            return;
+        }
+        close_connection(fd);
+        return;
+    }
+
+    conn.out.clear();
+    conn.out_offset = 0;
+    if (conn.streaming) {
+        update_interest(fd, conn);
+        return;
+    }
+    if (conn.close_after_write) {
+        close_connection(fd);
+        return;
+    }
+    // Next pipelined request, if one is already buffered
+    dispatch_request(fd, conn);
+}
+
+void RestApiServer::update_interest(int fd, Connection& conn) {
+    // Read only while no request is outstanding, so a pipelining client
+    // cannot make the server buffer without bound.
+    // Subscribers stay readable so a disconnect is noticed promptly.
+    std::uint32_t wanted = 0;
+    if (conn.streaming) {
+        wanted = EPOLLIN | (conn.out_offset < conn.out.size() ? EPOLLOUT : 0u);
+    } else if (conn.out_offset < conn.out.size()) {
+        wanted = EPOLLOUT;
+    } else if (!conn.busy) {
+        wanted = EPOLLIN;
+    }
+    if (wanted == conn.events) return;
+
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = wanted;
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) == 0) {
+        conn.events = wanted;
+    }
+}
+
+void RestApiServer::close_connection(int fd) {
+    auto it = connections_.find(fd);
+    if (it != connections_.end() && it->second.streaming) stream_clients_.fetch_sub(1);
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    // Discard unread input so close() sends FIN rather than a reset that
+    // could destroy a just-sent error response.
+    char discard[4096];
+    while (recv(fd, discard, sizeof(discard), MSG_DONTWAIT) > 0) {
+    }
+    close(fd);
+    connections_.erase(fd);
+    open_connections_.store(connections_.size());
+}
+
+void RestApiServer::close_idle_connections() {
+    auto now = std::chrono::steady_clock::now();
+    auto cutoff = now - std::chrono::milliseconds(KEEP_ALIVE_IDLE_MS);
+    auto stall_cutoff = now - std::chrono::milliseconds(STREAM_STALL_MS);
+    std::vector<int> idle;
+    for (const auto& entry : connections_) {
+        const Connection& conn = entry.second;
+        if (conn.streaming) {
+            // Idle subscribers are expected; stuck ones are not.
+            if (conn.out_offset < conn.out.size() && conn.last_activity < stall_cutoff) {
+                idle.push_back(entry.first);
+            }
+        } else if (!conn.busy && conn.last_activity < cutoff) {
+            idle.push_back(entry.first);
+        }
+    }
+    for (int fd : idle) close_connection(fd);
+}
+
+void RestApiServer::start_stream(int fd, Connection& conn) {
+    conn.in.clear();
+    conn.streaming = true;
+    conn.stream_resync = false;
+    stream_clients_.fetch_add(1);
+
+    // Every subscriber starts from the same baseline the shared deltas
+    // are computed against.
+    if (!stream_have_last_) {
+        stream_last_ = read_snapshot();
+        stream_have_last_ = true;
+    }
+
+    std::string bytes =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/event-stream\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "Connection: keep-alive\r\n"
+        "X-Accel-Buffering: no\r\n"
+        "\r\n"
+        "retry: 2000\n\n";
+    bytes += build_stream_frame("snapshot", nullptr, stream_last_);
+    stream_frames_sent_.fetch_add(1, std::memory_order_relaxed);
+    int tracked = fd;
+    queue_stream_bytes(fd, conn, bytes);
+
+    // Catch up at once if a publish landed after the baseline.
+    if (connections_.count(tracked)) broadcast_stream_frame();
+}
+
+std::string RestApiServer::build_stream_frame(const char* event, const PublishedSnapshot* before,
+                                              const PublishedSnapshot& now) const {
+    std::string frame = "id: ";
+    json::append_uint(frame, stream_frame_id_);
+    frame += "\nevent: ";
+    frame += event;
+    frame += "\ndata: ";
+    if (before) {
+        append_snapshot_delta(frame, *before, now);
+    } else {
+        frame += "{\"telemetry\":";
+        append_telemetry_json(frame, now.telemetry);
+        frame += ",\"state\":";
+        append_state_json(frame, now.state);
+        frame += ",\"control\":";
+        append_control_json(frame, now.control);
+        frame += '}';
+    }
+    frame += "\n\n";
+    return frame;
+}
+
+void RestApiServer::broadcast_stream_frame() {
+    if (stream_clients_.load() == 0 || !stream_have_last_) return;
+
+    PublishedSnapshot now = read_snapshot();
+    if (now.telemetry.version == stream_last_.telemetry.version &&
+        now.state.version == stream_last_.state.version &&
+        now.control.version == stream_last_.control.version) {
+        return;
+    }
+
+    ++stream_frame_id_;
+    const std::string delta = build_stream_frame("delta", &stream_last_, now);
+    std::string full;  // built only if some subscriber needs a resync
+
+    std::vector<int> subscribers;
+    for (const auto& entry : connections_) {
+        if (entry.second.streaming) subscribers.push_back(entry.first);
+    }
+    for (int fd : subscribers) {
+        auto it = connections_.find(fd);
+        if (it == connections_.end()) continue;
+        Connection& conn = it->second;
+        size_t backlog = conn.out.size() - conn.out_offset;
+
+        if (conn.stream_resync) {
+            if (backlog > 0) {
+                stream_frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+                continue;  // still draining
+            }
+            if (full.empty()) full = build_stream_frame("snapshot", nullptr, now);
+            conn.stream_resync = false;
+            stream_resyncs_.fetch_add(1, std::memory_order_relaxed);
+            stream_frames_sent_.fetch_add(1, std::memory_order_relaxed);
+            queue_stream_bytes(fd, conn, full);
+        } else if (backlog + delta.size() > STREAM_MAX_BACKLOG) {
+            conn.stream_resync = true;
+            stream_frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            stream_frames_sent_.fetch_add(1, std::memory_order_relaxed);
+            queue_stream_bytes(fd, conn, delta);
+        }
+    }
+    stream_last_ = now;
+}
+
+void RestApiServer::send_stream_heartbeats() {
+    auto now = std::chrono::steady_clock::now();
+    if (now - stream_last_heartbeat_ < std::chrono::milliseconds(STREAM_HEARTBEAT_MS)) return;
+    stream_last_heartbeat_ = now;
+
+    // SSE comment line: keeps proxies from timing out a quiet stream.
+    const std::string ping = ": ping\n\n";
+    std::vector<int> subscribers;
+    for (const auto& entry : connections_) {
+        if (entry.second.streaming && entry.second.out_offset == entry.second.out.size()) {
+            subscribers.push_back(entry.first);
+        }
+    }
+    for (int fd : subscribers) {
+        auto it = connections_.find(fd);
+        if (it != connections_.end()) queue_stream_bytes(fd, it->second, ping);
+    }
 }
 
-std::string RestApiServer::route_request(const std::string& method, const std::string& path) {
+void RestApiServer::queue_stream_bytes(int fd, Connection& conn, const std::string& bytes) {
+    if (conn.out_offset > 0) {
+        conn.out.erase(0, conn.out_offset);
+        conn.out_offset = 0;
+    }
+    conn.out += bytes;
+    flush_output(fd, conn);  // may close the connection
+}
+
+RestApiServer::StreamMetrics RestApiServer::stream_metrics() const {
+    StreamMetrics m;
+    m.clients = stream_clients_.load();
+    m.frames_sent = stream_frames_sent_.load(std::memory_order_relaxed);
+    m.frames_dropped = stream_frames_dropped_.load(std::memory_order_relaxed);
+    m.resyncs = stream_resyncs_.load(std::memory_order_relaxed);
+    return m;
+}
+
+size_t RestApiServer::endpoint_index(const std::string& path) {
+    std::string p = path;
+    if (p.size() > 1 && p.back() == '/') p.pop_back();
+    if (p == "/api") p = "/";
+    for (size_t i = 0; i + 1 < ENDPOINT_COUNT; ++i) {
+        if (p == ENDPOINT_NAMES[i]) return i;
+    }
+    return ENDPOINT_COUNT - 1;
+}
+
+std::vector<RestApiServer::EndpointLatency> RestApiServer::endpoint_latencies() const {
+    std::vector<EndpointLatency> out;
+    out.reserve(ENDPOINT_COUNT);
+    for (size_t i = 0; i < ENDPOINT_COUNT; ++i) {
+        out.push_back({ENDPOINT_NAMES[i], endpoint_latency_[i].snapshot()});
+    }
+    return out;
+}
+
+std::string RestApiServer::route_request(const HttpRequest& request) {
+    const std::string json_type = "application/json";
+    const std::string& path = request.path;
+    const bool keep_alive = request.keep_alive;
+
     // Only support GET for safety (read-only API)
-    if (method != "GET") {
-        return build_http_response(405, build_json_error("Method not allowed"));
+    if (request.method != "GET") {
+        return build_http_response(405, build_json_error("Method not allowed"), json_type, keep_alive);
     }
     
     // Route to appropriate handler
     if (path == "/api/status" || path == "/api/status/") {
-        return build_http_response(200, handle_status());
+        return build_http_response(200, handle_status(), json_type, keep_alive);
     } else if (path == "/api/telemetry" || path == "/api/telemetry/") {
-        return build_http_response(200, handle_telemetry());
+        return build_cached_response(request, handle_telemetry());
     } else if (path == "/api/telemetry/history" || path == "/api/telemetry/history/") {
-        return build_http_response(200, handle_telemetry_history());
+        return build_cached_response(request, handle_telemetry_history());
+    } else if (path == "/api/telemetry/range" || path == "/api/telemetry/range/") {
+        int status = 200;
+        std::string body = handle_telemetry_range(request.query, status);
+        return build_http_response(status, body, json_type, keep_alive);
     } else if (path == "/api/control" || path == "/api/control/") {
-        return build_http_response(200, handle_control());
+        return build_cached_response(request, handle_control());
     } else if (path == "/api/state" || path == "/api/state/") {
-        return build_http_response(200, handle_state());
+        return build_cached_response(request, handle_state());
     } else if (path == "/api/alerts" || path == "/api/alerts/") {
-        return build_http_response(200, handle_alerts());
+        return build_cached_response(request, handle_alerts());
     } else if (path == "/api/config" || path == "/api/config/") {
-        return build_http_response(200, handle_config());
+        return build_cached_response(request, handle_config());
+    } else if (path == "/api/metrics" || path == "/api/metrics/") {
+        return build_http_response(200, handle_metrics(), json_type, keep_alive);
+    } else if (path == "/api/metrics/loop" || path == "/api/metrics/loop/") {
+        return build_http_response(200, handle_loop_metrics(), json_type, keep_alive);
+    } else if (path == "/api/prediction" || path == "/api/prediction/") {
+        return build_cached_response(request, handle_prediction());
     } else if (path == "/" || path == "/api" || path == "/api/") {
         // Root endpoint - list available endpoints
-        std::ostringstream json;
-        json << "{"
-             << "\"service\":\"AI-IV Therapy REST API\","
-             << "\"version\":\"4.2.0\","
-             << "\"endpoints\":["
-             << "\"/api/status\","
-             << "\"/api/telemetry\","
-             << "\"/api/telemetry/history\","
-             << "\"/api/control\","
-             << "\"/api/state\","
-             << "\"/api/alerts\","
-             << "\"/api/config\""
-             << "]"
-             << "}";
-        return build_http_response(200, json.str());
+        static const std::string root =
+            "{"
+            "\"service\":\"AI-IV Therapy REST API\","
+            "\"version\":\"4.2.0\","
+            "\"endpoints\":["
+            "\"/api/status\","
+            "\"/api/telemetry\","
+            "\"/api/telemetry/history\","
+            "\"/api/telemetry/range\","
+            "\"/api/control\","
+            "\"/api/state\","
+            "\"/api/alerts\","
+            "\"/api/config\","
+            "\"/api/metrics\","
+            "\"/api/metrics/loop\","
+            "\"/api/prediction\","
+            "\"/api/stream\""
+            "]"
+            "}";
+        return build_http_response(200, root, json_type, keep_alive);
     } else {
-        return build_http_response(404, build_json_error("Endpoint not found"));
+        return build_http_response(404, build_json_error("Endpoint not found"), json_type, keep_alive);
+    }
+}
+
+template <typename Serialize>
+RestApiServer::CachedBody RestApiServer::cached_body(ResponseCache& cache, char kind,
+                                                     std::uint64_t version, Serialize serialize) {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (cache.entry.filled && cache.entry.version >= version) {
+        return cache.entry;  // same data, or newer than the caller saw
+    }
+
+    // serialize() returns the version it actually rendered, which can be
+    // newer than the caller's if the underlying data moved on meanwhile.
+    auto body = std::make_shared<std::string>();
+    std::uint64_t rendered = serialize(*body);
+
+    cache.entry.filled = true;
+    cache.entry.version = rendered;
+    cache.entry.etag = "\"" + instance_tag_ + "-" + kind;
+    json::append_uint(cache.entry.etag, rendered);
+    cache.entry.etag += '"';
+    cache.entry.body = std::move(body);
+    return cache.entry;
+}
+
+void RestApiServer::append_telemetry_json(std::string& json, const TelemetrySnapshot& t) {
+    json += "{\"timestamp\":\"";
+    json += t.timestamp;
+    json += "\",\"hydration_pct\":";
+    json::append_fixed(json, t.hydration_pct, 2);
+    json += ",\"heart_rate_bpm\":";
+    json::append_fixed(json, t.heart_rate_bpm, 2);
+    json += ",\"temp_celsius\":";
+    json::append_fixed(json, t.temp_celsius, 2);
+    json += ",\"spo2_pct\":";
+    json::append_fixed(json, t.spo2_pct, 2);
+    json += ",\"lactate_mmol\":";
+    json::append_fixed(json, t.lactate_mmol, 2);
+    json += ",\"cardiac_output_L_min\":";
+    json::append_fixed(json, t.cardiac_output_L_min, 2);
+    json += '}';
+}
+
+void RestApiServer::append_state_json(std::string& json, const StateSnapshot& st) {
+    json += "{\"hydration_pct\":";
+    json::append_fixed(json, st.hydration_pct, 3);
+    json += ",\"energy_T\":";
+    json::append_fixed(json, st.energy_T, 3);
+    json += ",\"metabolic_load\":";
+    json::append_fixed(json, st.metabolic_load, 3);
+    json += ",\"cardiac_reserve\":";
+    json::append_fixed(json, st.cardiac_reserve, 3);
+    json += ",\"risk_score\":";
+    json::append_fixed(json, st.risk_score, 3);
+    json += '}';
+}
+
+const char* RestApiServer::rationale_text(const ControlSnapshot& c, char (&buf)[RATIONALE_SIZE]) {
+    if (c.decision.code == RationaleCode::None) return c.rationale;
+    format_rationale(buf, RATIONALE_SIZE, c.decision);
+    return buf;
+}
+
+void RestApiServer::append_control_json(std::string& json, const ControlSnapshot& c) {
+    char buf[RATIONALE_SIZE];
+    const char* rationale = rationale_text(c, buf);
+    json += "{\"timestamp\":\"";
+    json += c.timestamp;
+    json += "\",\"infusion_rate_ml_min\":";
+    json::append_fixed(json, c.infusion_rate, 3);
+    json += ",\"rationale\":\"";
+    json::append_escaped(json, rationale, std::strlen(rationale));
+    json += "\"}";
+}
+
+void RestApiServer::append_snapshot_delta(std::string& json, const PublishedSnapshot& before,
+                                          const PublishedSnapshot& now) {
+    // Only sections whose version moved, and within them only changed fields.
+    bool first_section = true;
+    std::string section;
+    auto open_section = [&](const char* name) {
+        section.clear();
+        section += '"';
+        section += name;
+        section += "\":{";
+    };
+    auto close_section = [&](bool any) {
+        if (!any) return;
+        json += first_section ? "" : ",";
+        json += section;
+        json += '}';
+        first_section = false;
+    };
+    auto number = [&](bool& any, const char* key, double value, double previous, int precision) {
+        if (value == previous) return;
+        if (any) section += ',';
+        section += '"';
+        section += key;
+        section += "\":";
+        json::append_fixed(section, value, precision);
+        any = true;
+    };
+    auto text = [&](bool& any, const char* key, const char* value, const char* previous) {
+        if (std::strcmp(value, previous) == 0) return;
+        if (any) section += ',';
+        section += '"';
+        section += key;
+        section += "\":\"";
+        json::append_escaped(section, value, std::strlen(value));
+        section += '"';
+        any = true;
+    };
+
+    json += '{';
+    if (now.telemetry.version != before.telemetry.version) {
+        const TelemetrySnapshot& t = now.telemetry;
+        const TelemetrySnapshot& p = before.telemetry;
+        bool any = false;
+        open_section("telemetry");
+        text(any, "timestamp", t.timestamp, p.timestamp);
+        number(any, "hydration_pct", t.hydration_pct, p.hydration_pct, 2);
+        number(any, "heart_rate_bpm", t.heart_rate_bpm, p.heart_rate_bpm, 2);
+        number(any, "temp_celsius", t.temp_celsius, p.temp_celsius, 2);
+        number(any, "spo2_pct", t.spo2_pct, p.spo2_pct, 2);
+        number(any, "lactate_mmol", t.lactate_mmol, p.lactate_mmol, 2);
+        number(any, "cardiac_output_L_min", t.cardiac_output_L_min, p.cardiac_output_L_min, 2);
+        close_section(any);
+    }
+    if (now.state.version != before.state.version) {
+        const StateSnapshot& st = now.state;
+        const StateSnapshot& p = before.state;
+        bool any = false;
+        open_section("state");
+        number(any, "hydration_pct", st.hydration_pct, p.hydration_pct, 3);
+        number(any, "energy_T", st.energy_T, p.energy_T, 3);
+        number(any, "metabolic_load", st.metabolic_load, p.metabolic_load, 3);
+        number(any, "cardiac_reserve", st.cardiac_reserve, p.cardiac_reserve, 3);
+        number(any, "risk_score", st.risk_score, p.risk_score, 3);
+        close_section(any);
     }
+    if (now.control.version != before.control.version) {
+        const ControlSnapshot& c = now.control;
+        const ControlSnapshot& p = before.control;
+        bool any = false;
+        open_section("control");
+        text(any, "timestamp", c.timestamp, p.timestamp);
+        number(any, "infusion_rate_ml_min", c.infusion_rate, p.infusion_rate, 3);
+        char now_buf[RATIONALE_SIZE];
+        char before_buf[RATIONALE_SIZE];
+        text(any, "rationale", rationale_text(c, now_buf), rationale_text(p, before_buf));
+        close_section(any);
+    }
+    json += '}';
 }
 
 std::string RestApiServer::handle_status() {
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    
-    std::ostringstream json;
-    json << "{"
-         << "\"status\":\"running\","
-         << "\"timestamp\":\"" << get_current_timestamp() << "\","
-         << "\"api_version\":\"4.2.0\","
-         << "\"system\":\"AI-IV Therapy Control System\""
-         << "}";
-    
-    return json.str();
+    // The timestamp changes on every call, so this one is not cached.
+    std::string json = "{\"status\":\"running\",\"timestamp\":\"";
+    json += get_current_timestamp();
+    json += "\",\"api_version\":\"4.2.0\",\"system\":\"AI-IV Therapy Control System\"}";
+    return json;
 }
 
-std::string RestApiServer::handle_telemetry() {
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    
-    std::ostringstream json;
-    json << std::fixed << std::setprecision(2);
-    json << "{"
-         << "\"timestamp\":\"" << current_telemetry_.timestamp << "\","
-         << "\"hydration_pct\":" << current_telemetry_.hydration_pct << ","
-         << "\"heart_rate_bpm\":" << current_telemetry_.heart_rate_bpm << ","
-         << "\"temp_celsius\":" << current_telemetry_.temp_celsius << ","
-         << "\"spo2_pct\":" << current_telemetry_.spo2_pct << ","
-         << "\"lactate_mmol\":" << current_telemetry_.lactate_mmol << ","
-         << "\"cardiac_output_L_min\":" << current_telemetry_.cardiac_output_L_min
-         << "}";
-    
-    return json.str();
+RestApiServer::CachedBody RestApiServer::handle_telemetry() {
+    const TelemetrySnapshot t = read_snapshot().telemetry;
+    return cached_body(telemetry_cache_, 't', t.version, [&t](std::string& json) {
+        append_telemetry_json(json, t);
+        return t.version;
+    });
 }
 
-std::string RestApiServer::handle_telemetry_history() {
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    
-    std::ostringstream json;
-    json << std::fixed << std::setprecision(2);
-    json << "{\"history\":[";
-    
-    for (size_t i = 0; i < telemetry_history_.size(); ++i) {
-        if (i > 0) json << ",";
-        const auto& t = telemetry_history_[i];
-        json << "{"
-             << "\"timestamp\":\"" << t.timestamp << "\","
-             << "\"hydration_pct\":" << t.hydration_pct << ","
-             << "\"heart_rate_bpm\":" << t.heart_rate_bpm << ","
-             << "\"temp_celsius\":" << t.temp_celsius << ","
-             << "\"spo2_pct\":" << t.spo2_pct << ","
-             << "\"lactate_mmol\":" << t.lactate_mmol << ","
-             << "\"cardiac_output_L_min\":" << t.cardiac_output_L_min
-             << "}";
+const std::string& RestApiServer::history_fragment(std::uint64_t sequence) {
+    CachedFragment& fragment = history_fragments_[sequence % TELEMETRY_HISTORY_SIZE];
+    if (fragment.sequence == sequence) return fragment.json;
+
+    HistorySlot slot;
+    unsigned retries = telemetry_history_[sequence % TELEMETRY_HISTORY_SIZE].load(slot);
+    snapshot_reads_.fetch_add(1, std::memory_order_relaxed);
+    if (retries > 0) snapshot_read_retries_.fetch_add(retries, std::memory_order_relaxed);
+
+    fragment.sequence = sequence;
+    fragment.json.clear();
+    // A slot the writer has lapped carries a newer sequence number; that
+    // entry is gone for good and is left out.
+    if (slot.sequence == sequence) append_telemetry_json(fragment.json, slot.telemetry);
+    return fragment.json;
+}
+
+size_t RestApiServer::append_history_chunk(std::string& json, std::uint64_t chunk, bool& first) {
+    CachedChunk& cached = history_chunks_[chunk % HISTORY_CHUNK_SLOTS];
+    if (cached.index != chunk) {
+        cached.index = chunk;
+        cached.json.clear();
+        cached.entries = 0;
+        for (std::uint64_t seq = chunk * HISTORY_CHUNK_SIZE; seq < (chunk + 1) * HISTORY_CHUNK_SIZE; ++seq) {
+            const std::string& fragment = history_fragment(seq);
+            if (fragment.empty()) continue;
+            if (cached.entries > 0) cached.json += ',';
+            cached.json += fragment;
+            ++cached.entries;
+        }
     }
-    
-    json << "],\"count\":" << telemetry_history_.size() << "}";
-    return json.str();
+    if (cached.entries == 0) return 0;
+    if (!first) json += ',';
+    json += cached.json;
+    first = false;
+    return cached.entries;
 }
 
-std::string RestApiServer::handle_control() {
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    
-    std::ostringstream json;
-    json << std::fixed << std::setprecision(3);
-    json << "{"
-         << "\"timestamp\":\"" << current_control_.timestamp << "\","
-         << "\"infusion_rate_ml_min\":" << current_control_.infusion_rate << ","
-         << "\"rationale\":\"" << escape_json_string(current_control_.rationale) << "\""
-         << "}";
-    
-    return json.str();
+RestApiServer::CachedBody RestApiServer::handle_telemetry_history() {
+    // Walk the retained window oldest-first: whole sealed chunks where the
+    // window covers them, single fragments at the ragged ends.
+    std::uint64_t end = telemetry_count_.load(std::memory_order_acquire);
+    return cached_body(history_cache_, 'h', end, [this, end](std::string& json) {
+        std::uint64_t begin = end > TELEMETRY_HISTORY_SIZE ? end - TELEMETRY_HISTORY_SIZE : 0;
+        json.reserve((end - begin) * 170 + 32);
+        json += "{\"history\":[";
+
+        size_t count = 0;
+        bool first = true;
+        std::uint64_t seq = begin;
+        while (seq < end) {
+            std::uint64_t chunk = seq / HISTORY_CHUNK_SIZE;
+            if (seq == chunk * HISTORY_CHUNK_SIZE && (chunk + 1) * HISTORY_CHUNK_SIZE <= end) {
+                count += append_history_chunk(json, chunk, first);
+                seq += HISTORY_CHUNK_SIZE;
+                continue;
+            }
+            const std::string& fragment = history_fragment(seq++);
+            if (fragment.empty()) continue;
+            if (!first) json += ',';
+            json += fragment;
+            first = false;
+            ++count;
+        }
+
+        json += "],\"count\":";
+        json::append_uint(json, count);
+        json += '}';
+        return end;
+    });
 }
 
-std::string RestApiServer::handle_state() {
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    
-    std::ostringstream json;
-    json << std::fixed << std::setprecision(3);
-    json << "{"
-         << "\"hydration_pct\":" << current_state_.hydration_pct << ","
-         << "\"energy_T\":" << current_state_.energy_T << ","
-         << "\"metabolic_load\":" << current_state_.metabolic_load << ","
-         << "\"cardiac_reserve\":" << current_state_.cardiac_reserve << ","
-         << "\"risk_score\":" << current_state_.risk_score
-         << "}";
-    
-    return json.str();
+std::string RestApiServer::handle_telemetry_range(const std::string& query, int& status) {
+    status = 200;
+    const TimeSeriesStore* store = timeseries_.load();
+    if (!store) return "{\"enabled\":false}";
+
+    // Defaults: the RANGE_DEFAULT_SPAN_MS up to the newest sample, at the
+    // finest resolution that covers it
+    std::string value;
+    std::int64_t to_ms = store->latest_ms();
+    if (query_param(query, "to", value) && !parse_int64(value, to_ms)) {
+        status = 400;
+        return build_json_error("to must be a time in milliseconds");
+    }
+    // Saturating: `to` is client input and may be near INT64_MIN
+    std::int64_t from_ms = to_ms < std::numeric_limits<std::int64_t>::min() + RANGE_DEFAULT_SPAN_MS
+        ? std::numeric_limits<std::int64_t>::min()
+        : to_ms - RANGE_DEFAULT_SPAN_MS;
+    if (query_param(query, "from", value) && !parse_int64(value, from_ms)) {
+        status = 400;
+        return build_json_error("from must be a time in milliseconds");
+    }
+    if (from_ms > to_ms) {
+        status = 400;
+        return build_json_error("from must not be after to");
+    }
+    bool automatic = !query_param(query, "resolution", value) || value == "auto";
+    SeriesResolution resolution = SeriesResolution::Raw;
+    if (automatic) {
+        resolution = store->pick_resolution(from_ms, to_ms);
+    } else if (!parse_series_resolution(value.c_str(), resolution)) {
+        status = 400;
+        return build_json_error("resolution must be auto, raw, 1s, 1m or 10m");
+    }
+
+    TimeSeriesStore::Range range = store->query(from_ms, to_ms, resolution);
+    const std::vector<SeriesBucket>& buckets = range.buckets;
+
+    // Columnar: one array per field, index i is bucket i
+    std::string json;
+    json.reserve(256 + buckets.size() * (24 + kSeriesChannelCount * 3 * 10));
+    json += "{\"enabled\":true,\"resolution\":\"";
+    json += series_resolution_name(range.resolution);
+    json += "\",\"auto\":";
+    json += automatic ? "true" : "false";
+    json += ",\"bucket_ms\":";
+    json::append_int(json, range.bucket_ms);
+    json += ",\"from_ms\":";
+    json::append_int(json, from_ms);
+    json += ",\"to_ms\":";
+    json::append_int(json, to_ms);
+    json += ",\"retained_from_ms\":";
+    json::append_int(json, range.retained_from_ms);
+    json += ",\"complete\":";
+    json += range.complete ? "true" : "false";
+    json += ",\"count\":";
+    json::append_uint(json, buckets.size());
+    json += ",\"t_ms\":[";
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        if (i) json += ',';
+        json::append_int(json, buckets[i].start_ms);
+    }
+    json += "],\"samples\":[";
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        if (i) json += ',';
+        json::append_uint(json, buckets[i].samples);
+    }
+    json += "],\"series\":{";
+    for (size_t c = 0; c < kSeriesChannelCount; ++c) {
+        SeriesChannel channel = static_cast<SeriesChannel>(c);
+        if (c) json += ',';
+        json += '"';
+        json += series_channel_name(channel);
+        json += "\":{\"min\":[";
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            if (i) json += ',';
+            json::append_fixed(json, buckets[i].min[c], 3);
+        }
+        json += "],\"mean\":[";
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            if (i) json += ',';
+            json::append_fixed(json, buckets[i].mean(channel), 3);
+        }
+        json += "],\"max\":[";
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            if (i) json += ',';
+            json::append_fixed(json, buckets[i].max[c], 3);
+        }
+        json += "]}";
+    }
+    json += "}}";
+    return json;
 }
 
-std::string RestApiServer::handle_alerts() {
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    
-    std::ostringstream json;
-    json << "{\"alerts\":[";
-    
-    for (size_t i = 0; i < recent_alerts_.size(); ++i) {
-        if (i > 0) json << ",";
-        const auto& alert = recent_alerts_[i];
-        json << "{"
-             << "\"timestamp\":\"" << alert.timestamp << "\","
-             << "\"severity\":\"" << alert.severity << "\","
-             << "\"message\":\"" << escape_json_string(alert.message) << "\""
-             << "}";
+RestApiServer::CachedBody RestApiServer::handle_control() {
+    const ControlSnapshot c = read_snapshot().control;
+    return cached_body(control_cache_, 'c', c.version, [&c](std::string& json) {
+        append_control_json(json, c);
+        return c.version;
+    });
+}
+
+RestApiServer::CachedBody RestApiServer::handle_state() {
+    const StateSnapshot st = read_snapshot().state;
+    return cached_body(state_cache_, 's', st.version, [&st](std::string& json) {
+        append_state_json(json, st);
+        return st.version;
+    });
+}
+
+void RestApiServer::append_prediction_json(std::string& json, const PredictionSnapshot& p) {
+    json += "{\"timestamp\":\"";
+    json += p.timestamp;
+    json += "\",\"available\":";
+    json += p.count > 0 ? "true" : "false";
+    json += ",\"horizons\":[";
+    for (std::uint32_t i = 0; i < p.count; ++i) {
+        const PredictionSnapshot::Horizon& h = p.horizons[i];
+        if (i > 0) json += ',';
+        json += "{\"steps\":";
+        json::append_uint(json, static_cast<std::uint64_t>(h.steps));
+        json += ",\"seconds\":";
+        json::append_fixed(json, h.steps * config::CONTROL_PERIOD_SEC, 1);
+        json += ",\"hydration_pct\":";
+        json::append_fixed(json, h.hydration_pct, 3);
+        json += ",\"hydration_sd\":";
+        json::append_fixed(json, h.hydration_sd, 3);
+        json += ",\"energy_T\":";
+        json::append_fixed(json, h.energy_T, 3);
+        json += ",\"energy_sd\":";
+        json::append_fixed(json, h.energy_sd, 3);
+        json += ",\"uncertainty\":";
+        json::append_fixed(json, h.uncertainty, 3);
+        json += '}';
     }
-    
-    json << "],\"count\":" << recent_alerts_.size() << "}";
-    return json.str();
+    json += "]}";
 }
 
-std::string RestApiServer::handle_config() {
-    std::lock_guard<std::mutex> lock(data_mutex_);
+RestApiServer::CachedBody RestApiServer::handle_prediction() {
+    PredictionSnapshot p;
+    unsigned retries = prediction_.load(p);
+    snapshot_reads_.fetch_add(1, std::memory_order_relaxed);
+    if (retries > 0) snapshot_read_retries_.fetch_add(retries, std::memory_order_relaxed);
+    return cached_body(prediction_cache_, 'p', p.version, [&p](std::string& json) {
+        append_prediction_json(json, p);
+        return p.version;
+    });
+}
+
+RestApiServer::CachedBody RestApiServer::handle_alerts() {
+    std::uint64_t version;
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        version = alerts_version_;
+    }
+    return cached_body(alerts_cache_, 'a', version, [this](std::string& json) {
+        std::vector<AlertRecord> alerts;
+        std::uint64_t rendered;
+        {
+            std::lock_guard<std::mutex> lock(data_mutex_);
+            alerts = recent_alerts_;
+            rendered = alerts_version_;
+        }
+
+        json += "{\"alerts\":[";
+        for (size_t i = 0; i < alerts.size(); ++i) {
+            if (i > 0) json += ',';
+            const auto& alert = alerts[i];
+            json += "{\"timestamp\":\"";
+            json += alert.timestamp;
+            json += "\",\"severity\":\"";
+            json::append_escaped(json, alert.severity);
+            json += "\",\"message\":\"";
+            json::append_escaped(json, alert.message);
+            json += "\"}";
+        }
+        json += "],\"count\":";
+        json::append_uint(json, alerts.size());
+        json += '}';
+        return rendered;
+    });
+}
+
+RestApiServer::CachedBody RestApiServer::handle_config() {
+    std::uint64_t version;
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        version = config_version_;
+    }
+    return cached_body(config_cache_, 'g', version, [this](std::string& json) {
+        std::map<std::string, std::string> config;
+        std::uint64_t rendered;
+        {
+            std::lock_guard<std::mutex> lock(data_mutex_);
+            config = current_config_;
+            rendered = config_version_;
+        }
+
+        json += "{\"config\":{";
+        bool first = true;
+        for (const auto& pair : config) {
+            if (!first) json += ',';
+            json += '"';
+            json::append_escaped(json, pair.first);
+            json += "\":\"";
+            json::append_escaped(json, pair.second);
+            json += '"';
+            first = false;
+        }
+        json += "}}";
+        return rendered;
+    });
+}
+
+std::string RestApiServer::handle_metrics() {
+    PublicationMetrics pub = publication_metrics();
+    StreamMetrics streams = stream_metrics();
+    std::uint64_t published = telemetry_count_.load(std::memory_order_acquire);
     
     std::ostringstream json;
-    json << "{\"config\":{";
+    json << std::fixed << std::setprecision(3);
+    json << "{\"snapshot\":{"
+         << "\"version\":" << pub.version << ","
+         << "\"reads\":" << pub.reads << ","
+         << "\"read_retries\":" << pub.read_retries << ","
+         << "\"publish_latency\":";
+    write_latency_json(json, pub.publish_latency);
+    json << "},"
+         << "\"telemetry_history\":{"
+         << "\"published\":" << published << ","
+         << "\"retained\":" << std::min<std::uint64_t>(published, TELEMETRY_HISTORY_SIZE)
+         << "},";
+    const TimeSeriesStore* store = timeseries_.load();
+    json << "\"timeseries\":{\"enabled\":" << (store ? "true" : "false");
+    if (store) {
+        json << ",\"samples\":" << store->sample_count()
+             << ",\"memory_bytes\":" << store->memory_bytes();
+    }
+    json << "},"
+         << "\"connections\":{"
+         << "\"open\":" << open_connections() << ","
+         << "\"rejected_requests\":" << rejected_requests()
+         << "},"
+         << "\"streams\":{"
+         << "\"clients\":" << streams.clients << ","
+         << "\"frames_sent\":" << streams.frames_sent << ","
+         << "\"frames_dropped\":" << streams.frames_dropped << ","
+         << "\"resyncs\":" << streams.resyncs
+         << "},"
+         << "\"endpoints\":{";
     
     bool first = true;
-    for (const auto& pair : current_config_) {
+    for (const auto& e : endpoint_latencies()) {
         if (!first) json << ",";
-        json << "\"" << escape_json_string(pair.first) << "\":"
-             << "\"" << escape_json_string(pair.second) << "\"";
+        json << "\"" << e.endpoint << "\":";
+        write_latency_json(json, e.latency);
         first = false;
     }
     
@@ -332,54 +1334,168 @@ std::string RestApiServer::handle_config() {
     return json.str();
 }
 
+std::string RestApiServer::handle_loop_metrics() {
+    const ControlLoopMetrics* metrics = loop_metrics_.load();
+    if (!metrics) return "{\"enabled\":false}";
+
+    ControlLoopMetrics::Snapshot s = metrics->snapshot();
+    LoopScheduling sched = metrics->scheduling();
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3);
+    json << "{\"enabled\":true,"
+         << "\"period_ms\":"
+         << std::chrono::duration<double, std::milli>(metrics->period()).count() << ","
+         << "\"scheduling\":{\"realtime\":" << (sched.realtime ? "true" : "false") << ","
+         << "\"cpu\":" << sched.cpu << ","
+         << "\"policy\":\"" << (sched.fifo_priority > 0 ? "fifo" : "other") << "\","
+         << "\"priority\":" << sched.fifo_priority << ","
+         << "\"memory_locked\":" << (sched.memory_locked ? "true" : "false") << ","
+         << "\"spin_us\":" << static_cast<double>(sched.spin_ns) / 1000.0 << "},"
+         << "\"ticks\":" << s.ticks << ","
+         << "\"overruns\":" << s.overruns << ","
+         << "\"skipped_periods\":" << s.skipped_periods << ","
+         << "\"tick\":";
+    write_latency_json(json, s.tick);
+    json << ",\"jitter\":";
+    write_latency_json(json, s.jitter);
+    json << ",\"stages\":{";
+    for (size_t i = 0; i < ControlLoopMetrics::kStageCount; ++i) {
+        if (i) json << ",";
+        json << "\"" << ControlLoopMetrics::stage_name(static_cast<LoopStage>(i)) << "\":";
+        write_latency_json(json, s.stages[i]);
+    }
+    json << "}}";
+    return json.str();
+}
+
+RestApiServer::PublicationMetrics RestApiServer::publication_metrics() const {
+    PublicationMetrics m;
+    m.version = snapshot_.version() - 1;  // the constructor's empty record is not a publish
+    m.reads = snapshot_reads_.load(std::memory_order_relaxed);
+    m.read_retries = snapshot_read_retries_.load(std::memory_order_relaxed);
+    m.publish_latency = publish_latency_.snapshot();
+    return m;
+}
+
+void RestApiServer::publish_snapshot() {
+    snapshot_.store(staging_);
+    // Wake the event loop for subscribers; one eventfd write per batch of
+    // publishes it has not consumed yet.
+    if (stream_clients_.load(std::memory_order_relaxed) > 0 &&
+        !stream_pending_.exchange(true)) {
+        wake_event_loop();
+    }
+}
+
+RestApiServer::PublishedSnapshot RestApiServer::read_snapshot() const {
+    PublishedSnapshot snap;
+    unsigned retries = snapshot_.load(snap);
+    snapshot_reads_.fetch_add(1, std::memory_order_relaxed);
+    if (retries > 0) snapshot_read_retries_.fetch_add(retries, std::memory_order_relaxed);
+    return snap;
+}
+
 void RestApiServer::update_telemetry(const ivsys::Telemetry& telemetry) {
-    std::lock_guard<std::mutex> lock(data_mutex_);
+    auto start = std::chrono::steady_clock::now();
+    char timestamp[TIMESTAMP_SIZE];
+    format_current_timestamp(timestamp);
+    std::lock_guard<std::mutex> lock(publish_mutex_);
     
-    TelemetrySnapshot snapshot;
+    std::uint64_t seq = telemetry_count_.load(std::memory_order_relaxed);
+    TelemetrySnapshot& snapshot = staging_.telemetry;
+    snapshot.version = seq + 1;
     snapshot.hydration_pct = telemetry.hydration_pct;
     snapshot.heart_rate_bpm = telemetry.heart_rate_bpm;
     snapshot.temp_celsius = telemetry.temp_celsius;
     snapshot.spo2_pct = telemetry.spo2_pct;
     snapshot.lactate_mmol = telemetry.lactate_mmol;
     snapshot.cardiac_output_L_min = telemetry.cardiac_output_L_min;
-    snapshot.timestamp = get_current_timestamp();
+    std::memcpy(snapshot.timestamp, timestamp, TIMESTAMP_SIZE);
     
-    current_telemetry_ = snapshot;
+    // Add to history; the ring keeps the last TELEMETRY_HISTORY_SIZE entries
+    telemetry_history_[seq % TELEMETRY_HISTORY_SIZE].store(HistorySlot{seq, snapshot});
+    telemetry_count_.store(seq + 1, std::memory_order_release);
     
-    // Add to history, keep last 1000
-    telemetry_history_.push_back(snapshot);
-    if (telemetry_history_.size() > 1000) {
-        telemetry_history_.erase(telemetry_history_.begin());
-    }
+    publish_snapshot();
+    publish_latency_.record(std::chrono::steady_clock::now() - start);
 }
 
 void RestApiServer::update_patient_state(const ivsys::PatientState& state) {
-    std::lock_guard<std::mutex> lock(data_mutex_);
+    auto start = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(publish_mutex_);
     
-    current_state_.hydration_pct = state.hydration_pct;
-    current_state_.energy_T = state.energy_T;
-    current_state_.metabolic_load = state.metabolic_load;
-    current_state_.cardiac_reserve = state.cardiac_reserve;
-    current_state_.risk_score = state.risk_score;
+    ++staging_.state.version;
+    staging_.state.hydration_pct = state.hydration_pct;
+    staging_.state.energy_T = state.energy_T;
+    staging_.state.metabolic_load = state.metabolic_load;
+    staging_.state.cardiac_reserve = state.cardiac_reserve;
+    staging_.state.risk_score = state.risk_score;
+    
+    publish_snapshot();
+    publish_latency_.record(std::chrono::steady_clock::now() - start);
 }
 
 void RestApiServer::update_control_output(double infusion_rate, const std::string& rationale) {
-    std::lock_guard<std::mutex> lock(data_mutex_);
+    auto start = std::chrono::steady_clock::now();
+    std::string timestamp = get_current_timestamp();
+    std::lock_guard<std::mutex> lock(publish_mutex_);
     
-    current_control_.infusion_rate = infusion_rate;
-    current_control_.rationale = rationale;
-    current_control_.timestamp = get_current_timestamp();
+    ++staging_.control.version;
+    staging_.control.infusion_rate = infusion_rate;
+    staging_.control.decision = ivsys::Rationale{};
+    copy_text(staging_.control.rationale, rationale);
+    copy_text(staging_.control.timestamp, timestamp);
+    
+    publish_snapshot();
+    publish_latency_.record(std::chrono::steady_clock::now() - start);
+}
+
+void RestApiServer::update_control_output(const ivsys::ControlOutput& output) {
+    auto start = std::chrono::steady_clock::now();
+    char timestamp[TIMESTAMP_SIZE];
+    format_current_timestamp(timestamp);
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+
+    ++staging_.control.version;
+    staging_.control.infusion_rate = output.infusion_ml_per_min;
+    staging_.control.decision = output.rationale;
+    staging_.control.rationale[0] = '\0';
+    std::memcpy(staging_.control.timestamp, timestamp, TIMESTAMP_SIZE);
+
+    publish_snapshot();
+    publish_latency_.record(std::chrono::steady_clock::now() - start);
+}
+
+void RestApiServer::update_prediction(const ivsys::ForwardPrediction* predictions, size_t count) {
+    auto start = std::chrono::steady_clock::now();
+    char timestamp[TIMESTAMP_SIZE];
+    format_current_timestamp(timestamp);
+    count = std::min(count, MAX_PREDICTION_HORIZONS);
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+
+    PredictionSnapshot& p = prediction_staging_;
+    ++p.version;
+    p.count = static_cast<std::uint32_t>(count);
+    for (size_t i = 0; i < count; ++i) {
+        const ivsys::ForwardPrediction& f = predictions[i];
+        p.horizons[i] = {f.horizon, f.state.hydration_pct, f.hydration_sd,
+                         f.state.energy_T, f.energy_sd, f.state.uncertainty};
+    }
+    std::memcpy(p.timestamp, timestamp, TIMESTAMP_SIZE);
+    prediction_.store(p);
+
+    publish_latency_.record(std::chrono::steady_clock::now() - start);
 }
 
 void RestApiServer::add_alert(const std::string& severity, const std::string& message) {
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    
     AlertRecord alert;
     alert.severity = severity;
     alert.message = message;
     alert.timestamp = get_current_timestamp();
     
+    std::lock_guard<std::mutex> lock(data_mutex_);
     recent_alerts_.push_back(alert);
+    ++alerts_version_;
     
     // Keep only last 100 alerts
     if (recent_alerts_.size() > 100) {
@@ -390,31 +1506,55 @@ void RestApiServer::add_alert(const std::string& severity, const std::string& me
 void RestApiServer::update_config(const std::map<std::string, std::string>& config) {
     std::lock_guard<std::mutex> lock(data_mutex_);
     current_config_ = config;
+    ++config_version_;
 }
 
 std::string RestApiServer::build_http_response(int status_code, const std::string& body,
-                                               const std::string& content_type) {
-    std::ostringstream response;
-    
-    std::string status_text;
+                                               const std::string& content_type, bool keep_alive,
+                                               const std::string& etag) {
+    const char* status_text;
     switch (status_code) {
         case 200: status_text = "OK"; break;
+        case 304: status_text = "Not Modified"; break;
         case 400: status_text = "Bad Request"; break;
         case 404: status_text = "Not Found"; break;
         case 405: status_text = "Method Not Allowed"; break;
         case 500: status_text = "Internal Server Error"; break;
+        case 503: status_text = "Service Unavailable"; break;
         default: status_text = "Unknown"; break;
     }
     
-    response << "HTTP/1.1 " << status_code << " " << status_text << "\r\n"
-             << "Content-Type: " << content_type << "\r\n"
-             << "Content-Length: " << body.length() << "\r\n"
-             << "Access-Control-Allow-Origin: *\r\n"
-             << "Connection: close\r\n"
-             << "\r\n"
-             << body;
+    std::string response;
+    response.reserve(body.size() + 224);
+    response += "HTTP/1.1 ";
+    json::append_uint(response, static_cast<std::uint64_t>(status_code));
+    response += ' ';
+    response += status_text;
+    response += "\r\nContent-Type: ";
+    response += content_type;
+    if (status_code != 304) {  // a 304 never carries a body
+        response += "\r\nContent-Length: ";
+        json::append_uint(response, body.length());
+    }
+    if (!etag.empty()) {
+        // Clients may keep the body but must revalidate before reuse
+        response += "\r\nETag: ";
+        response += etag;
+        response += "\r\nCache-Control: no-cache";
+    }
+    response += "\r\nAccess-Control-Allow-Origin: *\r\nConnection: ";
+    response += keep_alive ? "keep-alive" : "close";
+    response += "\r\n\r\n";
+    if (status_code != 304) response += body;
     
-    return response.str();
+    return response;
+}
+
+std::string RestApiServer::build_cached_response(const HttpRequest& request, const CachedBody& cached) {
+    const std::string& tags = request.if_none_match;
+    bool not_modified = !tags.empty() && (tags == "*" || tags.find(cached.etag) != std::string::npos);
+    return build_http_response(not_modified ? 304 : 200, not_modified ? std::string() : *cached.body,
+                               "application/json", request.keep_alive, cached.etag);
 }
 
 std::string RestApiServer::build_json_error(const std::string& error) {
@@ -424,31 +1564,29 @@ std::string RestApiServer::build_json_error(const std::string& error) {
 }
 
 std::string RestApiServer::get_current_timestamp() {
+    char buf[TIMESTAMP_SIZE];
+    format_current_timestamp(buf);
+    return buf;
+}
+
+void RestApiServer::format_current_timestamp(char (&out)[TIMESTAMP_SIZE]) {
     auto now = std::chrono::system_clock::now();
     auto time_t_now = std::chrono::system_clock::to_time_t(now);
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
         now.time_since_epoch()) % 1000;
-    
-    std::ostringstream oss;
-    oss << std::put_time(std::gmtime(&time_t_now), "%Y-%m-%dT%H:%M:%S");
-    oss << '.' << std::setfill('0') << std::setw(3) << ms.count() << 'Z';
-    
-    return oss.str();
+
+    // gmtime_r: handlers run concurrently on the worker pool
+    std::tm utc{};
+    gmtime_r(&time_t_now, &utc);
+    size_t n = std::strftime(out, TIMESTAMP_SIZE, "%Y-%m-%dT%H:%M:%S", &utc);
+    std::snprintf(out + n, TIMESTAMP_SIZE - n, ".%03dZ", static_cast<int>(ms.count()));
 }
 
 std::string RestApiServer::escape_json_string(const std::string& str) {
-    std::ostringstream escaped;
-    for (char c : str) {
-        switch (c) {
-            case '"': escaped << "\\\""; break;
-            case '\\': escaped << "\\\\"; break;
-            case '\n': escaped << "\\n"; break;
-            case '\r': escaped << "\\r"; break;
-            case '\t': escaped << "\\t"; break;
-            default: escaped << c; break;
-        }
-    }
-    return escaped.str();
+    std::string escaped;
+    escaped.reserve(str.size());
+    json::append_escaped(escaped, str);
+    return escaped;
 }
 
 } // namespace ivsys
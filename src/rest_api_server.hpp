@@ -7,20 +7,87 @@
  * - Read-only access to control state (observability, not control)
  * - Lightweight HTTP/1.1 implementation
  * - JSON responses for modern client compatibility
+ *
+ * Connection handling:
+ * - One event-loop thread owns every socket: a non-blocking listener and
+ *   client sockets multiplexed with epoll (level-triggered), plus an
+ *   eventfd used to wake the loop for shutdown and finished responses.
+ * - Connections are HTTP/1.1 keep-alive by default; pipelined requests are
+ *   answered in order, one in flight per connection.
+ * - Complete requests are handed to a bounded queue drained by a small
+ *   worker pool that runs route_request().  When the queue is full the
+ *   loop answers 503 itself rather than buffering without bound.
+ * - A connection idle (or stalled mid-request) for KEEP_ALIVE_IDLE_MS is
+ *   closed, so a slow client costs one socket, not the server thread.
+ * - Every routed request records its latency (queue wait + handling) in a
+ *   per-endpoint LatencyHistogram.
+ *
+ * Data publication:
+ * - The control loop's latest telemetry, state and control output are one
+ *   trivially copyable record in a SeqLock.  update_telemetry /
+ *   update_patient_state / update_control_output edit a writer-private
+ *   staging copy and publish it in O(1); readers copy the newest complete
+ *   version and never make the writer wait.
+ * - Telemetry history is a ring of SeqLock slots tagged with their sequence
+ *   number, so readers can walk it while the writer keeps appending.
+ * - Forward predictions (update_prediction) are a separate SeqLock record
+ *   served on /api/prediction; they are not part of the live stream.
+ * - Long-range trends come from a TimeSeriesStore the control loop feeds
+ *   (set_timeseries()); /api/telemetry/range?from=&to=&resolution= reads
+ *   its rollups directly and is never cached.
+ * - Alerts and config change rarely and stay under data_mutex_, copied out
+ *   before any JSON is built.
+ * - /api/metrics reports publish latency, reader retries (contention) and
+ *   per-endpoint latency.  /api/metrics/loop reports the control loop's
+ *   per-stage latency, tick overruns and jitter from the ControlLoopMetrics
+ *   registered with set_loop_metrics().
+ *
+ * Response caching:
+ * - Every published section (telemetry, state, control, history, alerts,
+ *   config) carries a version.  The first request to see a new version
+ *   serializes it, with the locale-free formatters in json_format.hpp,
+ *   and later requests reuse the same immutable body.
+ * - Cached bodies carry a strong ETag; a matching If-None-Match is
+ *   answered 304 without a body.
+ * - Telemetry history is assembled from per-entry fragments and sealed
+ *   HISTORY_CHUNK_SIZE-entry chunks, so a new tick costs one fragment
+ *   rather than re-serializing the whole window.
+ *
+ * Live stream (GET /api/stream, Server-Sent Events):
+ * - A subscriber gets one full "snapshot" event, then a "delta" event per
+ *   publish carrying only the fields that changed.  Each delta is built
+ *   once on the event loop and shared by every subscriber.
+ * - Publishing only raises a flag (and writes the eventfd once when the
+ *   flag was clear), and only while someone is subscribed.
+ * - A subscriber whose unsent backlog exceeds STREAM_MAX_BACKLOG has
+ *   frames dropped; once it has drained it is resynchronized with a full
+ *   snapshot, so deltas always apply to the state the client holds.
  */
 
 #pragma once
 
 #include "iv_system_types.hpp"
+#include "ForwardPredictor.hpp"
+#include "LatencyHistogram.hpp"
+#include "ControlLoopMetrics.hpp"
+#include "SeqLock.hpp"
+#include "timeseries_store.hpp"
 #include <string>
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <deque>
 #include <sstream>
 #include <vector>
+#include <array>
 #include <map>
+#include <memory>
+#include <unordered_map>
 #include <functional>
 #include <cstring>
+#include <cstdint>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -30,48 +97,164 @@ namespace ivsys {
 
 class RestApiServer {
 public:
-    RestApiServer(int port = 8080, const std::string& bind_address = "127.0.0.1");
+    static constexpr size_t kDefaultWorkerThreads = 4;
+    static constexpr size_t MAX_PREDICTION_HORIZONS = 8;
+
+    // port 0 binds an ephemeral port; port() reports it after start().
+    RestApiServer(int port = 8080, const std::string& bind_address = "127.0.0.1",
+                  size_t worker_threads = kDefaultWorkerThreads);
     ~RestApiServer();
     
     // Server lifecycle
     bool start();
     void stop();
     bool is_running() const { return running_.load(); }
+    int port() const { return port_; }
     
     // Data update methods (called from main control loop)
     void update_telemetry(const ivsys::Telemetry& telemetry);
     void update_patient_state(const ivsys::PatientState& state);
     void update_control_output(double infusion_rate, const std::string& rationale);
+    // Stores the rationale code; its text is rendered when served.
+    void update_control_output(const ivsys::ControlOutput& output);
+    // One entry per horizon, at most MAX_PREDICTION_HORIZONS; count 0
+    // publishes "not available yet".
+    void update_prediction(const ivsys::ForwardPrediction* predictions, size_t count);
     void add_alert(const std::string& severity, const std::string& message);
     void update_config(const std::map<std::string, std::string>& config);
+
+    // Control-loop timing served on /api/metrics/loop (null: reported as
+    // disabled).  The metrics must outlive the server or be unset first.
+    void set_loop_metrics(const ControlLoopMetrics* metrics) { loop_metrics_.store(metrics); }
+
+    // Trend store served on /api/telemetry/range (null: reported as
+    // disabled).  Same lifetime rule as set_loop_metrics().
+    void set_timeseries(const TimeSeriesStore* store) { timeseries_.store(store); }
+
+    // Server-side latency per endpoint, in route order; "other" collects
+    // unknown paths and rejected methods.
+    struct EndpointLatency {
+        std::string endpoint;
+        LatencyHistogram::Snapshot latency;
+    };
+    std::vector<EndpointLatency> endpoint_latencies() const;
+
+    size_t open_connections() const { return open_connections_.load(); }
+    // Requests answered 503 because the worker queue was full.
+    std::uint64_t rejected_requests() const { return rejected_requests_.load(); }
+
+    // Snapshot publication between the control loop and request handlers.
+    struct PublicationMetrics {
+        std::uint64_t version = 0;        // snapshots published
+        std::uint64_t reads = 0;
+        std::uint64_t read_retries = 0;   // copies repeated because a publish overlapped
+        LatencyHistogram::Snapshot publish_latency;
+    };
+    PublicationMetrics publication_metrics() const;
+
+    // Server-Sent Events subscribers on /api/stream.
+    struct StreamMetrics {
+        size_t clients = 0;
+        std::uint64_t frames_sent = 0;      // frames queued to a subscriber
+        std::uint64_t frames_dropped = 0;   // skipped for a subscriber over its backlog limit
+        std::uint64_t resyncs = 0;          // full snapshots sent after drops
+    };
+    StreamMetrics stream_metrics() const;
     
 private:
     // Maximum HTTP request size (prevents slow-loris and oversized requests)
     static constexpr size_t MAX_REQUEST_SIZE = 8192;
+    static constexpr size_t MAX_CONNECTIONS = 1024;
+    static constexpr size_t MAX_PENDING_REQUESTS = 256;
+    static constexpr int KEEP_ALIVE_IDLE_MS = 5000;
+    static constexpr int EPOLL_TIMEOUT_MS = 250;
+    static constexpr size_t STREAM_MAX_BACKLOG = 64 * 1024;
+    static constexpr int STREAM_HEARTBEAT_MS = 15000;
+    static constexpr int STREAM_STALL_MS = 30000;    // backlog with no write progress
+    static constexpr std::int64_t RANGE_DEFAULT_SPAN_MS = 60 * 60 * 1000;
 
     // Server configuration
     int port_;
     std::string bind_address_;
+    size_t worker_count_;
     int server_socket_;
+    int epoll_fd_;
+    int wake_fd_;
     
     // Thread control
     std::atomic<bool> running_;
     std::thread server_thread_;
+    std::vector<std::thread> workers_;
+
+    // Event-loop state (server thread only)
+    struct Connection {
+        std::uint64_t id = 0;          // distinguishes reuse of the same fd
+        std::string in;
+        std::string out;
+        size_t out_offset = 0;
+        bool busy = false;             // request handed to a worker
+        bool close_after_write = false;
+        bool streaming = false;        // subscribed to /api/stream
+        bool stream_resync = false;    // dropped frames; next frame must be full
+        std::chrono::steady_clock::time_point last_activity;
+        std::uint32_t events = 0;      // current epoll interest
+    };
+    std::unordered_map<int, Connection> connections_;
+    std::uint64_t next_connection_id_ = 1;
+    std::atomic<size_t> open_connections_{0};
+
+    // Parsed request line and the headers the router acts on
+    struct HttpRequest {
+        std::string method;
+        std::string path;
+        std::string query;             // after '?', undecoded
+        std::string if_none_match;
+        bool keep_alive = false;
+    };
+
+    // Worker hand-off
+    struct Job {
+        int fd;
+        std::uint64_t connection_id;
+        HttpRequest request;
+        std::chrono::steady_clock::time_point received;
+    };
+    struct Completion {
+        int fd;
+        std::uint64_t connection_id;
+        std::string response;
+        bool keep_alive;
+    };
+    std::mutex job_mutex_;
+    std::condition_variable job_cv_;
+    std::deque<Job> jobs_;
+    bool workers_stopping_ = false;
+    std::mutex completion_mutex_;
+    std::vector<Completion> completions_;
+    std::atomic<std::uint64_t> rejected_requests_{0};
+
+    // Per-endpoint latency, indexed by endpoint_index()
+    static constexpr size_t ENDPOINT_COUNT = 13;
+    static const char* const ENDPOINT_NAMES[ENDPOINT_COUNT];
+    std::array<LatencyHistogram, ENDPOINT_COUNT> endpoint_latency_;
     
-    // Data storage with thread-safe access
-    mutable std::mutex data_mutex_;
-    
+    // Fixed-size text fields keep the published records trivially copyable
+    static constexpr size_t TIMESTAMP_SIZE = 32;
+    static constexpr size_t RATIONALE_SIZE = 512;   // longer rationales are truncated
+
     struct TelemetrySnapshot {
+        std::uint64_t version;    // telemetry entries published so far
         double hydration_pct;
         double heart_rate_bpm;
         double temp_celsius;
         double spo2_pct;
         double lactate_mmol;
         double cardiac_output_L_min;
-        std::string timestamp;
+        char timestamp[TIMESTAMP_SIZE];
     };
     
     struct StateSnapshot {
+        std::uint64_t version;
         double hydration_pct;
         double energy_T;
         double metabolic_load;
@@ -80,50 +263,182 @@ private:
     };
     
     struct ControlSnapshot {
+        std::uint64_t version;
         double infusion_rate;
-        std::string rationale;
-        std::string timestamp;
+        ivsys::Rationale decision;        // code None: the text below was published
+        char rationale[RATIONALE_SIZE];
+        char timestamp[TIMESTAMP_SIZE];
     };
+
+    struct PublishedSnapshot {
+        TelemetrySnapshot telemetry;
+        StateSnapshot state;
+        ControlSnapshot control;
+    };
+
+    struct PredictionSnapshot {
+        std::uint64_t version;
+        std::uint32_t count;      // 0: predictor still warming up
+        struct Horizon {
+            int steps;
+            double hydration_pct;
+            double hydration_sd;
+            double energy_T;
+            double energy_sd;
+            double uncertainty;
+        } horizons[MAX_PREDICTION_HORIZONS];
+        char timestamp[TIMESTAMP_SIZE];
+    };
+
+    struct HistorySlot {
+        std::uint64_t sequence;   // position in the overall telemetry stream
+        TelemetrySnapshot telemetry;
+    };
+
+    // Latest values (writer side: staging_ is touched only under publish_mutex_)
+    std::mutex publish_mutex_;
+    PublishedSnapshot staging_{};
+    SeqLock<PublishedSnapshot> snapshot_;
+    LatencyHistogram publish_latency_;
+    mutable std::atomic<std::uint64_t> snapshot_reads_{0};
+    mutable std::atomic<std::uint64_t> snapshot_read_retries_{0};
+
+    // Forward predictions (prediction_staging_ under publish_mutex_)
+    PredictionSnapshot prediction_staging_{};
+    SeqLock<PredictionSnapshot> prediction_;
+
+    // History buffer: slot i % N holds stream entry i
+    static constexpr size_t TELEMETRY_HISTORY_SIZE = 1000;
+    std::array<SeqLock<HistorySlot>, TELEMETRY_HISTORY_SIZE> telemetry_history_;
+    std::atomic<std::uint64_t> telemetry_count_{0};
     
+    // Alerts and config (rarely written, copied out under the lock)
+    mutable std::mutex data_mutex_;
+
     struct AlertRecord {
         std::string severity;
         std::string message;
         std::string timestamp;
     };
     
-    TelemetrySnapshot current_telemetry_;
-    StateSnapshot current_state_;
-    ControlSnapshot current_control_;
     std::vector<AlertRecord> recent_alerts_;  // Keep last 100
     std::map<std::string, std::string> current_config_;
-    
-    // History buffers
-    std::vector<TelemetrySnapshot> telemetry_history_;  // Keep last 1000
+    std::uint64_t alerts_version_ = 0;
+    std::uint64_t config_version_ = 0;
+
+    // Serialized response bodies (reader side only; the writer never waits)
+    struct CachedBody {
+        bool filled = false;
+        std::uint64_t version = 0;
+        std::string etag;                          // empty: not cacheable
+        std::shared_ptr<const std::string> body;
+    };
+    struct ResponseCache {
+        std::mutex mutex;
+        CachedBody entry;
+    };
+    std::string instance_tag_;                     // keeps ETags unique across restarts
+    ResponseCache telemetry_cache_;
+    ResponseCache state_cache_;
+    ResponseCache control_cache_;
+    ResponseCache alerts_cache_;
+    ResponseCache config_cache_;
+    ResponseCache prediction_cache_;
+
+    // History pieces, guarded by history_cache_.mutex.  Fragment i % N is
+    // entry i; chunk c covers entries [c * CHUNK, (c + 1) * CHUNK).
+    static constexpr size_t HISTORY_CHUNK_SIZE = 50;
+    static constexpr size_t HISTORY_CHUNK_SLOTS = TELEMETRY_HISTORY_SIZE / HISTORY_CHUNK_SIZE + 1;
+    struct CachedFragment {
+        std::uint64_t sequence = UINT64_MAX;
+        std::string json;                          // empty: entry was lapped
+    };
+    struct CachedChunk {
+        std::uint64_t index = UINT64_MAX;
+        std::string json;                          // comma-joined entries
+        size_t entries = 0;
+    };
+    ResponseCache history_cache_;
+    std::vector<CachedFragment> history_fragments_;
+    std::vector<CachedChunk> history_chunks_;
+
+    // Live stream state (event loop only, except the atomics)
+    std::atomic<size_t> stream_clients_{0};
+    std::atomic<bool> stream_pending_{false};
+    bool stream_have_last_ = false;
+    PublishedSnapshot stream_last_{};
+    std::uint64_t stream_frame_id_ = 0;
+    std::chrono::steady_clock::time_point stream_last_heartbeat_;
+    std::atomic<std::uint64_t> stream_frames_sent_{0};
+    std::atomic<std::uint64_t> stream_frames_dropped_{0};
+    std::atomic<std::uint64_t> stream_resyncs_{0};
+
+    std::atomic<const ControlLoopMetrics*> loop_metrics_{nullptr};
+    std::atomic<const TimeSeriesStore*> timeseries_{nullptr};
+
+    void start_stream(int fd, Connection& conn);
+    void broadcast_stream_frame();
+    void send_stream_heartbeats();
+    void queue_stream_bytes(int fd, Connection& conn, const std::string& bytes);
+    std::string build_stream_frame(const char* event, const PublishedSnapshot* before,
+                                   const PublishedSnapshot& now) const;
+
+    template <typename Serialize>
+    CachedBody cached_body(ResponseCache& cache, char kind, std::uint64_t version,
+                           Serialize serialize);
+    const std::string& history_fragment(std::uint64_t sequence);
+    size_t append_history_chunk(std::string& json, std::uint64_t chunk, bool& first);
+    static void append_telemetry_json(std::string& json, const TelemetrySnapshot& t);
+    static void append_state_json(std::string& json, const StateSnapshot& st);
+    static void append_control_json(std::string& json, const ControlSnapshot& c);
+    static void append_prediction_json(std::string& json, const PredictionSnapshot& p);
+    static void append_snapshot_delta(std::string& json, const PublishedSnapshot& before,
+                                      const PublishedSnapshot& now);
+
+    void publish_snapshot();
+    PublishedSnapshot read_snapshot() const;
     
     // Server implementation
     void server_loop();
-    void handle_client(int client_socket);
+    void worker_loop();
+    void accept_connections();
+    void handle_readable(int fd, Connection& conn);
+    void dispatch_request(int fd, Connection& conn);
+    void flush_output(int fd, Connection& conn);
+    void drain_completions();
+    void update_interest(int fd, Connection& conn);
+    void close_connection(int fd);
+    void close_idle_connections();
+    void wake_event_loop();
     
     // HTTP handling
-    std::string parse_request_path(const std::string& request);
-    std::string route_request(const std::string& method, const std::string& path);
+    std::string route_request(const HttpRequest& request);
+    static size_t endpoint_index(const std::string& path);
     
     // API endpoints
     std::string handle_status();
-    std::string handle_telemetry();
-    std::string handle_telemetry_history();
-    std::string handle_control();
-    std::string handle_state();
-    std::string handle_alerts();
-    std::string handle_config();
+    CachedBody handle_telemetry();
+    CachedBody handle_telemetry_history();
+    std::string handle_telemetry_range(const std::string& query, int& status);
+    CachedBody handle_control();
+    CachedBody handle_state();
+    CachedBody handle_alerts();
+    CachedBody handle_config();
+    CachedBody handle_prediction();
+    std::string handle_metrics();
+    std::string handle_loop_metrics();
     
     // HTTP response builders
     std::string build_http_response(int status_code, const std::string& body, 
-                                   const std::string& content_type = "application/json");
+                                   const std::string& content_type = "application/json",
+                                   bool keep_alive = false, const std::string& etag = "");
+    std::string build_cached_response(const HttpRequest& request, const CachedBody& cached);
     std::string build_json_error(const std::string& error);
     
     // Utility
     std::string get_current_timestamp();
+    static void format_current_timestamp(char (&out)[TIMESTAMP_SIZE]);
+    static const char* rationale_text(const ControlSnapshot& c, char (&buf)[RATIONALE_SIZE]);
     std::string escape_json_string(const std::string& str);
 };
 
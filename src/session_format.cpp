@@ -0,0 +1,469 @@
+#include "session_format.hpp"
+#include "AdaptiveController.hpp"
+#include "control_text.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace ivsys {
+namespace session_format {
+
+namespace {
+
+// Column order after the timestamp.  Appending a field means bumping
+// kSchemaVersion; readers refuse unknown versions rather than guess.
+constexpr double Telemetry::* kTelemetryFields[] = {
+    &Telemetry::hydration_pct,
+    &Telemetry::heart_rate_bpm,
+    &Telemetry::temp_celsius,
+    &Telemetry::blood_loss_idx,
+    &Telemetry::fatigue_idx,
+    &Telemetry::anxiety_idx,
+    &Telemetry::signal_quality,
+    &Telemetry::spo2_pct,
+    &Telemetry::lactate_mmol,
+    &Telemetry::cardiac_output_L_min,
+    &Telemetry::vault_mesh_size_nm,
+    &Telemetry::vault_payload_pct,
+};
+constexpr size_t kTelemetryBreachedColumn = 13;
+
+constexpr double PatientState::* kStateFields[] = {
+    &PatientState::hydration_pct,
+    &PatientState::heart_rate_bpm,
+    &PatientState::coherence_sigma,
+    &PatientState::energy_T,
+    &PatientState::energy_T_absolute,
+    &PatientState::metabolic_load,
+    &PatientState::cardiac_reserve,
+    &PatientState::risk_score,
+    &PatientState::estimated_flow_velocity_cm_s,
+    &PatientState::flow_efficiency,
+    &PatientState::uncertainty,
+};
+
+static_assert(sizeof(kTelemetryFields) / sizeof(kTelemetryFields[0]) + 2 == kTelemetryColumns,
+              "telemetry column table out of sync");
+static_assert(sizeof(kStateFields) / sizeof(kStateFields[0]) + 1 == kStateColumns,
+              "state column table out of sync");
+
+enum ControlColumn : size_t {
+    kInfusionColumn = 1,
+    kConfidenceColumn = 2,
+    kOverrideColumn = 3,
+    kWarningsColumn = 4,
+    kRationaleColumn = 5
+};
+
+size_t block_bytes(std::uint16_t columns, std::uint32_t rows) {
+    return sizeof(BlockHeader) + static_cast<size_t>(columns) * rows * sizeof(double);
+}
+
+} // namespace
+
+std::uint16_t column_count(RecordType type) {
+    switch (type) {
+        case RecordType::Telemetry: return kTelemetryColumns;
+        case RecordType::Control: return kControlColumns;
+        case RecordType::State: return kStateColumns;
+    }
+    return 0;
+}
+
+std::uint32_t encode_warnings(const std::string& warning_flags) {
+    return parse_warnings(warning_flags).bits;
+}
+
+std::string decode_warnings(std::uint32_t bits) {
+    return to_string(WarningFlags{bits});
+}
+
+std::uint32_t encode_rationale(const std::string& rationale) {
+    if (rationale.compare(0, 2, "H=") != 0) return kCustomRationale;
+    std::uint32_t bits = 0;
+    if (rationale.find(" [SAFETY_LIM]") != std::string::npos) bits |= kSafetyLimited;
+    if (rationale.find(" [PRED_BOOST]") != std::string::npos) bits |= kPredictiveBoost;
+    return bits;
+}
+
+std::string decode_rationale(std::uint32_t bits, const PatientState& state, double rate) {
+    return to_string(rationale_from_bits(bits, state, rate));
+}
+
+std::uint32_t encode_rationale(const Rationale& rationale) {
+    if (rationale.code != RationaleCode::Controller) return kCustomRationale;
+    std::uint32_t bits = 0;
+    if (rationale.safety_limited) bits |= kSafetyLimited;
+    if (rationale.predictive_boost) bits |= kPredictiveBoost;
+    return bits;
+}
+
+Rationale rationale_from_bits(std::uint32_t bits, const PatientState& state, double rate) {
+    if (bits & kCustomRationale) {
+        Rationale custom;
+        custom.code = RationaleCode::Custom;
+        custom.text = "CUSTOM_RATIONALE";
+        return custom;
+    }
+    return AdaptiveController::make_rationale(state, rate,
+                                              (bits & kSafetyLimited) != 0,
+                                              (bits & kPredictiveBoost) != 0);
+}
+
+std::int64_t to_ns(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+std::chrono::steady_clock::time_point from_ns(std::int64_t ns) {
+    return std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::nanoseconds(ns)));
+}
+
+// ============================================================================
+// SessionWriter
+// ============================================================================
+
+SessionWriter::PendingBlock::PendingBlock(RecordType t, std::uint32_t capacity)
+    : type(t), columns(column_count(t)),
+      timestamps(capacity), values(static_cast<size_t>(columns - 1) * capacity) {}
+
+SessionWriter::SessionWriter(const std::string& path, const std::string& session_id,
+                             std::uint32_t block_rows)
+    : block_rows_(std::max<std::uint32_t>(block_rows, 1)),
+      telemetry_(RecordType::Telemetry, block_rows_),
+      control_(RecordType::Control, block_rows_),
+      state_(RecordType::State, block_rows_) {
+    // ~9 h of 5 Hz ticks at the default block size before the index
+    // reallocates on the control thread.
+    index_.reserve(kIndexReserve);
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        throw std::runtime_error("Failed to open session file " + path);
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(header.magic));
+    header.schema_version = kSchemaVersion;
+    header.byte_order = kByteOrderMark;
+    header.header_size = sizeof(FileHeader);
+    header.block_rows = block_rows_;
+    std::strncpy(header.session_id, session_id.c_str(), sizeof(header.session_id) - 1);
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file_.flush();
+}
+
+SessionWriter::~SessionWriter() {
+    close();
+}
+
+void SessionWriter::append_telemetry(const Telemetry& m) {
+    if (closed_) return;
+    PendingBlock& b = telemetry_;
+    b.timestamps[b.rows] = to_ns(m.timestamp);
+    size_t c = 1;
+    for (auto field : kTelemetryFields) {
+        *b.row_slot(c++, block_rows_) = m.*field;
+    }
+    *b.row_slot(kTelemetryBreachedColumn, block_rows_) = m.vault_cage_breached ? 1.0 : 0.0;
+    if (++b.rows == block_rows_) write_block(b);
+}
+
+void SessionWriter::append_control(const ControlOutput& out, const PatientState& state,
+                                   std::chrono::steady_clock::time_point t) {
+    if (closed_) return;
+    std::int64_t t_ns = to_ns(t);
+
+    PendingBlock& c = control_;
+    c.timestamps[c.rows] = t_ns;
+    *c.row_slot(kInfusionColumn, block_rows_) = out.infusion_ml_per_min;
+    *c.row_slot(kConfidenceColumn, block_rows_) = out.confidence;
+    *c.row_slot(kOverrideColumn, block_rows_) = out.safety_override ? 1.0 : 0.0;
+    *c.row_slot(kWarningsColumn, block_rows_) = out.warning_flags.bits;
+    *c.row_slot(kRationaleColumn, block_rows_) = encode_rationale(out.rationale);
+    if (++c.rows == block_rows_) write_block(c);
+
+    PendingBlock& s = state_;
+    s.timestamps[s.rows] = t_ns;
+    size_t col = 1;
+    for (auto field : kStateFields) {
+        *s.row_slot(col++, block_rows_) = state.*field;
+    }
+    if (++s.rows == block_rows_) write_block(s);
+}
+
+void SessionWriter::write_block(PendingBlock& block) {
+    if (block.rows == 0) return;
+
+    BlockHeader header{};
+    header.magic = kBlockMagic;
+    header.type = static_cast<std::uint16_t>(block.type);
+    header.columns = block.columns;
+    header.rows = block.rows;
+    auto range = std::minmax_element(block.timestamps.begin(),
+                                     block.timestamps.begin() + block.rows);
+    header.t_min_ns = *range.first;
+    header.t_max_ns = *range.second;
+
+    IndexEntry entry{};
+    entry.offset = static_cast<std::uint64_t>(file_.tellp());
+    entry.type = header.type;
+    entry.columns = header.columns;
+    entry.rows = header.rows;
+    entry.t_min_ns = header.t_min_ns;
+    entry.t_max_ns = header.t_max_ns;
+
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file_.write(reinterpret_cast<const char*>(block.timestamps.data()),
+                static_cast<std::streamsize>(block.rows * sizeof(std::int64_t)));
+    for (size_t c = 1; c < block.columns; ++c) {
+        file_.write(reinterpret_cast<const char*>(&block.values[(c - 1) * block_rows_]),
+                    static_cast<std::streamsize>(block.rows * sizeof(double)));
+    }
+    // Whole blocks reach the OS together so a crash loses at most the
+    // rows still pending in memory.
+    file_.flush();
+
+    index_.push_back(entry);
+    block.rows = 0;
+}
+
+void SessionWriter::flush() {
+    if (closed_) return;
+    write_block(telemetry_);
+    write_block(control_);
+    write_block(state_);
+}
+
+void SessionWriter::close() {
+    if (closed_) return;
+    flush();
+    closed_ = true;
+
+    Trailer trailer{};
+    trailer.index_offset = static_cast<std::uint64_t>(file_.tellp());
+    trailer.entry_count = static_cast<std::uint32_t>(index_.size());
+    trailer.magic = kIndexMagic;
+    file_.write(reinterpret_cast<const char*>(index_.data()),
+                static_cast<std::streamsize>(index_.size() * sizeof(IndexEntry)));
+    file_.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+    file_.close();
+}
+
+// ============================================================================
+// SessionReader
+// ============================================================================
+
+SessionReader::SessionReader(const void* data, size_t size)
+    : data_(static_cast<const unsigned char*>(data)), size_(size) {
+    if (reinterpret_cast<std::uintptr_t>(data_) % alignof(double) != 0) {
+        throw std::invalid_argument("SessionReader: buffer must be 8-byte aligned");
+    }
+    if (size_ < sizeof(FileHeader)) {
+        throw std::runtime_error("SessionReader: file too small for header");
+    }
+    std::memcpy(&header_, data_, sizeof(header_));
+    if (std::memcmp(header_.magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("SessionReader: not an AIIVSESS file");
+    }
+    if (header_.byte_order != kByteOrderMark) {
+        throw std::runtime_error("SessionReader: byte order mismatch");
+    }
+    if (header_.schema_version != kSchemaVersion) {
+        throw std::runtime_error("SessionReader: unsupported schema version " +
+                                 std::to_string(header_.schema_version));
+    }
+    if (header_.header_size < sizeof(FileHeader) || header_.header_size > size_) {
+        throw std::runtime_error("SessionReader: corrupt header size");
+    }
+
+    Trailer trailer{};
+    if (size_ - header_.header_size >= sizeof(Trailer)) {
+        std::memcpy(&trailer, data_ + size_ - sizeof(Trailer), sizeof(Trailer));
+    }
+    // Every bound below is a subtraction from a size already known to fit,
+    // so hostile trailer or index values cannot wrap past it.
+    size_t index_bytes = static_cast<size_t>(trailer.entry_count) * sizeof(IndexEntry);
+    if (trailer.magic == kIndexMagic &&
+        trailer.index_offset >= header_.header_size &&
+        trailer.index_offset <= size_ - sizeof(Trailer) &&
+        index_bytes == size_ - sizeof(Trailer) - trailer.index_offset) {
+        blocks_.resize(trailer.entry_count);
+        std::memcpy(blocks_.data(), data_ + trailer.index_offset, index_bytes);
+        indexed_ = true;
+        for (const auto& e : blocks_) {
+            if (!valid_block(e, static_cast<size_t>(trailer.index_offset))) {
+                throw std::runtime_error("SessionReader: index entry out of range");
+            }
+        }
+    } else {
+        scan_blocks();
+    }
+}
+
+bool SessionReader::valid_block(const IndexEntry& e, size_t end) const {
+    std::uint16_t columns = column_count(static_cast<RecordType>(e.type));
+    if (columns == 0 || e.columns != columns) return false;
+    if (e.offset < header_.header_size || e.offset % alignof(double) != 0 || e.offset > end) return false;
+    // columns <= 14 and rows < 2^32, so the product fits in 64 bits
+    if (block_bytes(e.columns, e.rows) > end - e.offset) return false;
+    BlockHeader h;
+    std::memcpy(&h, data_ + e.offset, sizeof(h));
+    return h.magic == kBlockMagic && h.type == e.type && h.columns == e.columns && h.rows == e.rows;
+}
+
+void SessionReader::scan_blocks() {
+    size_t offset = header_.header_size;
+    while (offset + sizeof(BlockHeader) <= size_) {
+        BlockHeader h;
+        std::memcpy(&h, data_ + offset, sizeof(h));
+        IndexEntry e{};
+        e.offset = offset;
+        e.type = h.type;
+        e.columns = h.columns;
+        e.rows = h.rows;
+        e.t_min_ns = h.t_min_ns;
+        e.t_max_ns = h.t_max_ns;
+        if (!valid_block(e, size_)) break;   // garbage or torn final block
+        size_t bytes = block_bytes(h.columns, h.rows);
+
+        blocks_.push_back(e);
+        offset += bytes;
+    }
+}
+
+std::string SessionReader::session_id() const {
+    return std::string(header_.session_id,
+                       strnlen(header_.session_id, sizeof(header_.session_id)));
+}
+
+std::vector<size_t> SessionReader::blocks_in_range(RecordType type, std::int64_t t0_ns,
+                                                   std::int64_t t1_ns) const {
+    std::vector<size_t> out;
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        const IndexEntry& e = blocks_[i];
+        if (e.type == static_cast<std::uint16_t>(type) &&
+            e.t_max_ns >= t0_ns && e.t_min_ns <= t1_ns) {
+            out.push_back(i);
+        }
+    }
+    return out;
+}
+
+const unsigned char* SessionReader::block_data(size_t block) const {
+    return data_ + blocks_.at(block).offset + sizeof(BlockHeader);
+}
+
+const std::int64_t* SessionReader::timestamps(size_t block) const {
+    return reinterpret_cast<const std::int64_t*>(block_data(block));
+}
+
+const double* SessionReader::column(size_t block, size_t column) const {
+    const IndexEntry& e = blocks_.at(block);
+    if (column == 0 || column >= e.columns) {
+        throw std::out_of_range("SessionReader: column index out of range");
+    }
+    return reinterpret_cast<const double*>(block_data(block)) + column * e.rows;
+}
+
+void SessionReader::read_telemetry(size_t block, std::vector<Telemetry>& out) const {
+    const IndexEntry& e = blocks_.at(block);
+    if (e.type != static_cast<std::uint16_t>(RecordType::Telemetry)) {
+        throw std::invalid_argument("SessionReader: not a telemetry block");
+    }
+    const std::int64_t* ts = timestamps(block);
+    const double* breached = column(block, kTelemetryBreachedColumn);
+    size_t first = out.size();
+    out.resize(first + e.rows);
+    for (size_t r = 0; r < e.rows; ++r) {
+        out[first + r].timestamp = from_ns(ts[r]);
+        out[first + r].vault_cage_breached = breached[r] != 0.0;
+    }
+    size_t c = 1;
+    for (auto field : kTelemetryFields) {
+        const double* col = column(block, c++);
+        for (size_t r = 0; r < e.rows; ++r) out[first + r].*field = col[r];
+    }
+}
+
+void SessionReader::read_state(size_t block, std::vector<PatientState>& out) const {
+    const IndexEntry& e = blocks_.at(block);
+    if (e.type != static_cast<std::uint16_t>(RecordType::State)) {
+        throw std::invalid_argument("SessionReader: not a state block");
+    }
+    size_t first = out.size();
+    out.resize(first + e.rows);
+    size_t c = 1;
+    for (auto field : kStateFields) {
+        const double* col = column(block, c++);
+        for (size_t r = 0; r < e.rows; ++r) out[first + r].*field = col[r];
+    }
+}
+
+std::vector<Telemetry> SessionReader::all_telemetry() const {
+    std::vector<Telemetry> out;
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        if (blocks_[i].type == static_cast<std::uint16_t>(RecordType::Telemetry)) {
+            read_telemetry(i, out);
+        }
+    }
+    return out;
+}
+
+std::vector<ControlSample> SessionReader::all_control() const {
+    std::vector<PatientState> states;
+    std::vector<std::uint32_t> rationale_bits;
+    std::vector<ControlSample> out;
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        const IndexEntry& e = blocks_[i];
+        if (e.type == static_cast<std::uint16_t>(RecordType::State)) {
+            read_state(i, states);
+        } else if (e.type == static_cast<std::uint16_t>(RecordType::Control)) {
+            const std::int64_t* ts = timestamps(i);
+            const double* infusion = column(i, kInfusionColumn);
+            const double* confidence = column(i, kConfidenceColumn);
+            const double* override_flag = column(i, kOverrideColumn);
+            const double* warnings = column(i, kWarningsColumn);
+            const double* rationale = column(i, kRationaleColumn);
+            for (size_t r = 0; r < e.rows; ++r) {
+                ControlSample s;
+                s.t = from_ns(ts[r]);
+                s.output.infusion_ml_per_min = infusion[r];
+                s.output.confidence = confidence[r];
+                s.output.safety_override = override_flag[r] != 0.0;
+                s.output.warning_flags.bits = static_cast<std::uint32_t>(warnings[r]);
+                out.push_back(std::move(s));
+                rationale_bits.push_back(static_cast<std::uint32_t>(rationale[r]));
+            }
+        }
+    }
+
+    // A torn tail can leave one table a block ahead of the other; keep
+    // only fully paired rows.
+    out.resize(std::min(out.size(), states.size()));
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i].state = states[i];
+        out[i].output.rationale = rationale_from_bits(rationale_bits[i], states[i],
+                                                      out[i].output.infusion_ml_per_min);
+    }
+    return out;
+}
+
+std::vector<std::uint64_t> load_file(const std::string& path, size_t& size_bytes) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        throw std::runtime_error("Failed to open session file " + path);
+    }
+    size_bytes = static_cast<size_t>(in.tellg());
+    std::vector<std::uint64_t> buffer((size_bytes + sizeof(std::uint64_t) - 1) /
+                                      sizeof(std::uint64_t));
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(size_bytes));
+    if (!in) {
+        throw std::runtime_error("Failed to read session file " + path);
+    }
+    return buffer;
+}
+
+} // namespace session_format
+} // namespace ivsys
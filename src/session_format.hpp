@@ -0,0 +1,242 @@
+#pragma once
+
+/*
+ * session_format.hpp
+ *
+ * Compact binary, block-columnar session format ("AIIVSESS").
+ *
+ * A session file is written next to (or instead of) the per-session CSV
+ * files.  Layout, all integers and doubles in native (little-endian) order:
+ *
+ *   FileHeader                        (88 bytes, carries schema version)
+ *   Block*                            (any order of record types)
+ *     BlockHeader                     (32 bytes: type, rows, t_min, t_max)
+ *     int64  timestamp_ns[rows]       (column 0, steady_clock ticks)
+ *     double column_c[rows]           (columns 1..N-1, one run per column)
+ *   IndexEntry[entry_count]           (one per block, timestamp ranges)
+ *   Trailer                           (16 bytes, locates the index)
+ *
+ * Every record type has a fixed column set, so a block is rows * columns
+ * * 8 bytes and a column can be read without touching the others.  If the
+ * writer never reached close() (crash, kill -9) the trailer is missing and
+ * SessionReader recovers the index by walking the block headers; every
+ * block that was fully written is still readable.
+ *
+ * Control rows hold the numeric ControlOutput fields plus two bitmasks: the
+ * SafetyMonitor warning tokens and the rationale markers.  The rationale
+ * text itself is not stored; it is regenerated from the paired State row,
+ * which is exactly the state it was rendered from.  A warning token or a
+ * rationale that does not follow the controller's format cannot be
+ * represented and is reported as OTHER_WARNING / CUSTOM_RATIONALE.
+ */
+
+#include "iv_system_types.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ivsys {
+namespace session_format {
+
+constexpr char kMagic[8] = {'A', 'I', 'I', 'V', 'S', 'E', 'S', 'S'};
+constexpr std::uint32_t kSchemaVersion = 1;
+constexpr std::uint32_t kByteOrderMark = 0x01020304u;
+constexpr std::uint32_t kBlockMagic = 0x314B4C42u;   // "BLK1"
+constexpr std::uint32_t kIndexMagic = 0x31584449u;   // "IDX1"
+constexpr std::uint32_t kDefaultBlockRows = 512;     // ~100 s of 5 Hz ticks
+constexpr const char* kFileSuffix = "_session.aivs";
+
+enum class RecordType : std::uint16_t {
+    Telemetry = 1,
+    Control = 2,
+    State = 3
+};
+
+// Column counts include the timestamp column.
+constexpr std::uint16_t kTelemetryColumns = 14;
+constexpr std::uint16_t kControlColumns = 6;
+constexpr std::uint16_t kStateColumns = 12;
+
+std::uint16_t column_count(RecordType type);
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t schema_version;
+    std::uint32_t byte_order;
+    std::uint32_t header_size;
+    std::uint32_t block_rows;
+    char session_id[64];
+};
+
+struct BlockHeader {
+    std::uint32_t magic;
+    std::uint16_t type;
+    std::uint16_t columns;
+    std::uint32_t rows;
+    std::uint32_t reserved;
+    std::int64_t t_min_ns;
+    std::int64_t t_max_ns;
+};
+
+struct IndexEntry {
+    std::uint64_t offset;   // of the BlockHeader
+    std::uint16_t type;
+    std::uint16_t columns;
+    std::uint32_t rows;
+    std::int64_t t_min_ns;
+    std::int64_t t_max_ns;
+};
+
+struct Trailer {
+    std::uint64_t index_offset;
+    std::uint32_t entry_count;
+    std::uint32_t magic;
+};
+
+static_assert(sizeof(FileHeader) == 88, "FileHeader layout is part of the schema");
+static_assert(sizeof(BlockHeader) == 32, "BlockHeader layout is part of the schema");
+static_assert(sizeof(IndexEntry) == 32, "IndexEntry layout is part of the schema");
+static_assert(sizeof(Trailer) == 16, "Trailer layout is part of the schema");
+
+// ---- Warning / rationale encoding ----
+
+// Warning bits are the WarningFlag values (iv_system_types.hpp).
+enum WarningBit : std::uint32_t {
+    kVolumeLimitApproach = static_cast<std::uint32_t>(WarningFlag::VolumeLimitApproach),
+    kLowCardiacReserve   = static_cast<std::uint32_t>(WarningFlag::LowCardiacReserve),
+    kRateChangeLimited   = static_cast<std::uint32_t>(WarningFlag::RateChangeLimited),
+    kHighRiskState       = static_cast<std::uint32_t>(WarningFlag::HighRiskState),
+    kTachycardiaDetected = static_cast<std::uint32_t>(WarningFlag::TachycardiaDetected),
+    kEmergencyMinRate    = static_cast<std::uint32_t>(WarningFlag::EmergencyMinRate),
+    kOtherWarning        = static_cast<std::uint32_t>(WarningFlag::Other)
+};
+
+enum RationaleBit : std::uint32_t {
+    kSafetyLimited   = 1u << 0,
+    kPredictiveBoost = 1u << 1,
+    kCustomRationale = 1u << 31
+};
+
+// Text forms, for CSV sessions and tests.
+std::uint32_t encode_warnings(const std::string& warning_flags);
+std::string decode_warnings(std::uint32_t bits);
+std::uint32_t encode_rationale(const std::string& rationale);
+std::string decode_rationale(std::uint32_t bits, const PatientState& state, double rate);
+
+// What the writer stores and the reader rebuilds.  A Custom rationale
+// comes back as the text "CUSTOM_RATIONALE".
+std::uint32_t encode_rationale(const Rationale& rationale);
+Rationale rationale_from_bits(std::uint32_t bits, const PatientState& state, double rate);
+
+std::int64_t to_ns(std::chrono::steady_clock::time_point t);
+std::chrono::steady_clock::time_point from_ns(std::int64_t ns);
+
+// ---- Writer ----
+
+class SessionWriter {
+public:
+    SessionWriter(const std::string& path, const std::string& session_id,
+                  std::uint32_t block_rows = kDefaultBlockRows);
+    ~SessionWriter();
+
+    SessionWriter(const SessionWriter&) = delete;
+    SessionWriter& operator=(const SessionWriter&) = delete;
+
+    void append_telemetry(const Telemetry& m);
+    // Writes one Control row and one State row with the same timestamp.
+    void append_control(const ControlOutput& out, const PatientState& state,
+                        std::chrono::steady_clock::time_point t);
+
+    // Write out every partially filled block.  Safe to call at any point;
+    // later rows simply start new blocks.
+    void flush();
+    // flush() plus the index and trailer.  Further appends are ignored.
+    void close();
+
+    size_t blocks_written() const { return index_.size(); }
+
+private:
+    struct PendingBlock {
+        RecordType type;
+        std::uint16_t columns;
+        std::uint32_t rows = 0;
+        std::vector<std::int64_t> timestamps;
+        std::vector<double> values;   // column-major, (columns - 1) * capacity
+
+        PendingBlock(RecordType t, std::uint32_t capacity);
+        double* row_slot(size_t column, std::uint32_t capacity) {
+            return &values[(column - 1) * capacity + rows];
+        }
+    };
+
+    void write_block(PendingBlock& block);
+
+    static constexpr size_t kIndexReserve = 1024;
+
+    std::ofstream file_;
+    std::uint32_t block_rows_;
+    PendingBlock telemetry_;
+    PendingBlock control_;
+    PendingBlock state_;
+    std::vector<IndexEntry> index_;
+    bool closed_ = false;
+};
+
+// ---- Reader ----
+
+struct ControlSample {
+    std::chrono::steady_clock::time_point t;
+    ControlOutput output;
+    PatientState state;
+};
+
+// Parses a session image held in memory (a loaded file or a mapping).
+// The buffer must stay alive and unchanged for the reader's lifetime and
+// be 8-byte aligned; column accessors return pointers into it.
+class SessionReader {
+public:
+    SessionReader(const void* data, size_t size);
+
+    const FileHeader& header() const { return header_; }
+    std::string session_id() const;
+    const std::vector<IndexEntry>& blocks() const { return blocks_; }
+    // False when the trailer was missing and the index was rebuilt by scan.
+    bool indexed() const { return indexed_; }
+
+    // Blocks of `type` whose timestamp range overlaps [t0_ns, t1_ns].
+    std::vector<size_t> blocks_in_range(RecordType type, std::int64_t t0_ns,
+                                        std::int64_t t1_ns) const;
+
+    const std::int64_t* timestamps(size_t block) const;
+    const double* column(size_t block, size_t column) const;
+
+    // Append every row of the block (of the matching type) to `out`.
+    void read_telemetry(size_t block, std::vector<Telemetry>& out) const;
+    void read_state(size_t block, std::vector<PatientState>& out) const;
+
+    // Whole-session helpers in write order.  Control and State rows are
+    // paired positionally, as SessionWriter::append_control wrote them.
+    std::vector<Telemetry> all_telemetry() const;
+    std::vector<ControlSample> all_control() const;
+
+private:
+    const unsigned char* block_data(size_t block) const;
+    void scan_blocks();
+    // e is a well-formed block of a known type lying within [header, end).
+    bool valid_block(const IndexEntry& e, size_t end) const;
+
+    const unsigned char* data_;
+    size_t size_;
+    FileHeader header_;
+    std::vector<IndexEntry> blocks_;
+    bool indexed_ = false;
+};
+
+// Read a whole file into an 8-byte aligned buffer suitable for SessionReader.
+std::vector<std::uint64_t> load_file(const std::string& path, size_t& size_bytes);
+
+} // namespace session_format
+} // namespace ivsys
@@ -0,0 +1,270 @@
+#include "shm_telemetry_ring.hpp"
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ivsys {
+
+namespace {
+
+std::string failure(const std::string& what, const std::string& name, int err) {
+    return what + " " + name + ": " + std::strerror(err);
+}
+
+std::uint32_t round_up_pow2(std::uint32_t n) {
+    std::uint32_t p = 2;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+bool layout_matches(const shm_ring::Header* h, std::uint32_t capacity) {
+    return h->ready.load(std::memory_order_acquire) == 1 &&
+           std::memcmp(h->magic, kShmTelemetryMagic, sizeof(kShmTelemetryMagic)) == 0 &&
+           h->layout_version == kShmTelemetryLayoutVersion &&
+           h->record_size == sizeof(ShmTelemetryRecord) &&
+           h->header_size == sizeof(shm_ring::Header) &&
+           (capacity == 0 || h->capacity == capacity);
+}
+
+} // namespace
+
+ShmTelemetryRecord to_shm_record(const Telemetry& m) {
+    ShmTelemetryRecord r{};
+    r.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        m.timestamp.time_since_epoch()).count();
+    r.hydration_pct = m.hydration_pct;
+    r.heart_rate_bpm = m.heart_rate_bpm;
+    r.temp_celsius = m.temp_celsius;
+    r.blood_loss_idx = m.blood_loss_idx;
+    r.fatigue_idx = m.fatigue_idx;
+    r.anxiety_idx = m.anxiety_idx;
+    r.signal_quality = m.signal_quality;
+    r.spo2_pct = m.spo2_pct;
+    r.lactate_mmol = m.lactate_mmol;
+    r.cardiac_output_L_min = m.cardiac_output_L_min;
+    r.vault_mesh_size_nm = m.vault_mesh_size_nm;
+    r.vault_payload_pct = m.vault_payload_pct;
+    r.flags = m.vault_cage_breached ? kShmCageBreached : 0u;
+    return r;
+}
+
+Telemetry from_shm_record(const ShmTelemetryRecord& r) {
+    Telemetry m;
+    m.timestamp = std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::nanoseconds(r.timestamp_ns)));
+    m.hydration_pct = r.hydration_pct;
+    m.heart_rate_bpm = r.heart_rate_bpm;
+    m.temp_celsius = r.temp_celsius;
+    m.blood_loss_idx = r.blood_loss_idx;
+    m.fatigue_idx = r.fatigue_idx;
+    m.anxiety_idx = r.anxiety_idx;
+    m.signal_quality = r.signal_quality;
+    m.spo2_pct = r.spo2_pct;
+    m.lactate_mmol = r.lactate_mmol;
+    m.cardiac_output_L_min = r.cardiac_output_L_min;
+    m.vault_mesh_size_nm = r.vault_mesh_size_nm;
+    m.vault_payload_pct = r.vault_payload_pct;
+    m.vault_cage_breached = (r.flags & kShmCageBreached) != 0;
+    return m;
+}
+
+size_t shm_ring::segment_bytes(std::uint32_t capacity) {
+    return sizeof(Header) + static_cast<size_t>(capacity) * sizeof(Slot);
+}
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+ShmTelemetryWriter::ShmTelemetryWriter(const std::string& name, std::uint32_t capacity)
+    : name_(name), capacity_(round_up_pow2(capacity)), bytes_(shm_ring::segment_bytes(capacity_)) {
+    // Reattach when the existing segment already has this layout
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd >= 0) {
+        struct stat st {};
+        if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) == bytes_) {
+            base_ = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (base_ == MAP_FAILED) base_ = nullptr;
+        }
+        close(fd);
+        if (base_ && !layout_matches(static_cast<shm_ring::Header*>(base_), capacity_)) {
+            munmap(base_, bytes_);
+            base_ = nullptr;
+        }
+        // Readers of a different layout keep their old mapping and go stale
+        if (!base_) shm_unlink(name.c_str());
+    }
+
+    if (!base_) {
+        fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0660);
+        if (fd < 0) throw std::runtime_error(failure("shm_open", name, errno));
+        if (ftruncate(fd, static_cast<off_t>(bytes_)) != 0) {
+            int err = errno;
+            close(fd);
+            shm_unlink(name.c_str());
+            throw std::runtime_error(failure("ftruncate", name, err));
+        }
+        base_ = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        int err = errno;
+        close(fd);
+        if (base_ == MAP_FAILED) {
+            base_ = nullptr;
+            shm_unlink(name.c_str());
+            throw std::runtime_error(failure("mmap", name, err));
+        }
+        // ftruncate zero-fills; readers check `ready` before anything else
+        header_ = new (base_) shm_ring::Header();
+        slots_ = reinterpret_cast<shm_ring::Slot*>(static_cast<char*>(base_) + sizeof(shm_ring::Header));
+        for (std::uint32_t i = 0; i < capacity_; ++i) new (&slots_[i]) shm_ring::Slot();
+        std::memcpy(header_->magic, kShmTelemetryMagic, sizeof(kShmTelemetryMagic));
+        header_->layout_version = kShmTelemetryLayoutVersion;
+        header_->record_size = sizeof(ShmTelemetryRecord);
+        header_->capacity = capacity_;
+        header_->header_size = sizeof(shm_ring::Header);
+        header_->published.store(0, std::memory_order_relaxed);
+        header_->ready.store(1, std::memory_order_release);
+    }
+    header_ = static_cast<shm_ring::Header*>(base_);
+    slots_ = reinterpret_cast<shm_ring::Slot*>(static_cast<char*>(base_) + sizeof(shm_ring::Header));
+    header_->producer_pid.store(static_cast<std::int32_t>(getpid()), std::memory_order_release);
+}
+
+ShmTelemetryWriter::~ShmTelemetryWriter() {
+    if (base_) munmap(base_, bytes_);
+}
+
+void ShmTelemetryWriter::publish(const ShmTelemetryRecord& record) {
+    std::uint64_t raw[shm_ring::kRecordWords];
+    std::memcpy(raw, &record, sizeof(record));
+
+    std::uint64_t n = header_->published.load(std::memory_order_relaxed) + 1;
+    shm_ring::Slot& slot = slots_[n & (capacity_ - 1)];
+    slot.seq.store(2 * n - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < shm_ring::kRecordWords; ++i) {
+        slot.words[i].store(raw[i], std::memory_order_relaxed);
+    }
+    slot.seq.store(2 * n, std::memory_order_release);
+    header_->published.store(n, std::memory_order_release);
+}
+
+std::uint64_t ShmTelemetryWriter::published() const {
+    return header_->published.load(std::memory_order_acquire);
+}
+
+bool ShmTelemetryWriter::unlink(const std::string& name) {
+    return shm_unlink(name.c_str()) == 0;
+}
+
+// ============================================================================
+// Reader
+// ============================================================================
+
+const char* shm_read_status_name(ShmReadStatus status) {
+    switch (status) {
+    case ShmReadStatus::Fresh:  return "fresh";
+    case ShmReadStatus::Repeat: return "repeat";
+    case ShmReadStatus::Stale:  return "stale";
+    case ShmReadStatus::Empty:  return "empty";
+    case ShmReadStatus::Torn:   return "torn";
+    }
+    return "unknown";
+}
+
+ShmTelemetryReader::ShmTelemetryReader(const std::string& name, const Options& options)
+    : options_(options) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) throw std::runtime_error(failure("shm_open", name, errno));
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        close(fd);
+        throw std::runtime_error(failure("fstat", name, err));
+    }
+    bytes_ = static_cast<size_t>(st.st_size);
+    if (bytes_ < sizeof(shm_ring::Header)) {
+        close(fd);
+        throw std::runtime_error("ShmTelemetryReader: " + name + " is too small for a ring header");
+    }
+    void* base = mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd, 0);
+    int err = errno;
+    close(fd);
+    if (base == MAP_FAILED) throw std::runtime_error(failure("mmap", name, err));
+    base_ = base;
+
+    header_ = static_cast<const shm_ring::Header*>(base_);
+    capacity_ = header_->capacity;
+    if (!layout_matches(header_, 0) || capacity_ < 2 || (capacity_ & (capacity_ - 1)) != 0 ||
+        bytes_ < shm_ring::segment_bytes(capacity_)) {
+        munmap(base, bytes_);
+        base_ = nullptr;
+        throw std::runtime_error("ShmTelemetryReader: " + name + " is not an initialized telemetry ring");
+    }
+    slots_ = reinterpret_cast<const shm_ring::Slot*>(static_cast<const char*>(base_) +
+                                                     sizeof(shm_ring::Header));
+}
+
+ShmTelemetryReader::~ShmTelemetryReader() {
+    if (base_) munmap(const_cast<void*>(base_), bytes_);
+}
+
+ShmReadStatus ShmTelemetryReader::read_latest(Telemetry& out, std::chrono::steady_clock::time_point now) {
+    ++stats_.reads;
+    std::uint64_t raw[shm_ring::kRecordWords];
+    for (unsigned attempt = 0; attempt <= options_.max_retries; ++attempt) {
+        std::uint64_t n = header_->published.load(std::memory_order_acquire);
+        if (n == 0) {
+            ++stats_.empty;
+            return ShmReadStatus::Empty;
+        }
+        const shm_ring::Slot& slot = slots_[n & (capacity_ - 1)];
+        std::uint64_t before = slot.seq.load(std::memory_order_acquire);
+        if (before == 2 * n) {
+            for (size_t i = 0; i < shm_ring::kRecordWords; ++i) {
+                raw[i] = slot.words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == before) {
+                std::memcpy(&last_, raw, sizeof(last_));
+                bool repeat = n == stats_.last_sequence;
+                // A sequence that went backwards is a re-created segment
+                if (stats_.last_sequence != 0 && n > stats_.last_sequence) {
+                    stats_.skipped += n - stats_.last_sequence - 1;
+                }
+                stats_.last_sequence = n;
+                out = from_shm_record(last_);
+
+                auto age = now - out.timestamp;
+                stats_.last_age_ms = std::chrono::duration<double, std::milli>(age).count();
+                if (age > options_.max_age || -age > options_.max_age) {
+                    ++stats_.stale;
+                    return ShmReadStatus::Stale;
+                }
+                ++(repeat ? stats_.repeats : stats_.fresh);
+                return repeat ? ShmReadStatus::Repeat : ShmReadStatus::Fresh;
+            }
+        }
+        // The writer lapped this slot; the newer record is in another one
+        ++stats_.retries;
+    }
+    ++stats_.torn;
+    return ShmReadStatus::Torn;
+}
+
+std::uint64_t ShmTelemetryReader::published() const {
+    return header_->published.load(std::memory_order_acquire);
+}
+
+std::int32_t ShmTelemetryReader::producer_pid() const {
+    return header_->producer_pid.load(std::memory_order_acquire);
+}
+
+} // namespace ivsys
@@ -0,0 +1,187 @@
+#pragma once
+
+/*
+ * shm_telemetry_ring.hpp
+ *
+ * Zero-copy telemetry ingestion from an external sensor process through a
+ * POSIX shared-memory ring.
+ *
+ * The sensor daemon owns a ShmTelemetryWriter and publishes fixed-layout
+ * ShmTelemetryRecords; the control loop owns a ShmTelemetryReader and
+ * takes the newest one each tick.  Neither side makes a syscall or blocks
+ * after setup:
+ *
+ *   - Every slot is a sequence lock (the SeqLock.hpp scheme): its sequence
+ *     is odd while the writer fills it and 2 * n once record n is complete.
+ *     The header's `published` counter is the last complete record.
+ *   - The writer never waits for the reader; a full ring overwrites the
+ *     oldest slot.  The reader copies the slot `published` points at and
+ *     retries if the writer lapped it during the copy.
+ *   - Records published between two reads are counted as skipped, reads
+ *     that find nothing new as repeats, and a newest record older than
+ *     Options::max_age as stale (a stopped or hung producer).
+ *
+ * Timestamps are steady_clock (CLOCK_MONOTONIC) nanoseconds, which every
+ * process on the host shares.  One writer process at a time: a restarted
+ * daemon reattaches to an existing segment with the same layout and
+ * continues its sequence, so attached readers never notice the restart.
+ * Setup failures throw std::runtime_error.
+ */
+
+#include "iv_system_types.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ivsys {
+
+constexpr char kShmTelemetryMagic[8] = {'A', 'I', 'I', 'V', 'S', 'H', 'M', '1'};
+constexpr std::uint32_t kShmTelemetryLayoutVersion = 1;
+constexpr const char* kDefaultTelemetryShmName = "/ai_iv_telemetry";
+
+// Wire layout shared with sensor drivers; fields are never reordered.
+struct ShmTelemetryRecord {
+    std::int64_t timestamp_ns;        // steady_clock at acquisition
+    double hydration_pct;
+    double heart_rate_bpm;
+    double temp_celsius;
+    double blood_loss_idx;
+    double fatigue_idx;
+    double anxiety_idx;
+    double signal_quality;
+    double spo2_pct;
+    double lactate_mmol;
+    double cardiac_output_L_min;
+    double vault_mesh_size_nm;
+    double vault_payload_pct;
+    std::uint32_t flags;              // kShmCageBreached
+    std::uint32_t reserved;
+};
+static_assert(sizeof(ShmTelemetryRecord) == 112, "ShmTelemetryRecord layout is part of the wire format");
+
+constexpr std::uint32_t kShmCageBreached = 1u << 0;
+
+ShmTelemetryRecord to_shm_record(const Telemetry& m);
+Telemetry from_shm_record(const ShmTelemetryRecord& r);
+
+namespace shm_ring {
+
+constexpr size_t kRecordWords = sizeof(ShmTelemetryRecord) / sizeof(std::uint64_t);
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "the shared ring needs address-free 64-bit atomics");
+
+struct Header {
+    char magic[8];
+    std::uint32_t layout_version;
+    std::uint32_t record_size;
+    std::uint32_t capacity;           // slots, a power of two
+    std::uint32_t header_size;
+    std::atomic<std::uint32_t> ready;           // 1 once the fields above are valid
+    std::atomic<std::int32_t> producer_pid;
+    alignas(64) std::atomic<std::uint64_t> published;   // last complete record, 0 = none
+};
+
+struct alignas(64) Slot {
+    std::atomic<std::uint64_t> seq;
+    std::atomic<std::uint64_t> words[kRecordWords];
+};
+
+static_assert(sizeof(Header) == 128, "ring header layout is part of the wire format");
+static_assert(sizeof(Slot) == 128, "ring slot layout is part of the wire format");
+
+size_t segment_bytes(std::uint32_t capacity);
+
+} // namespace shm_ring
+
+class ShmTelemetryWriter {
+public:
+    static constexpr std::uint32_t kDefaultCapacity = 64;
+
+    // Creates `name` (e.g. "/ai_iv_bed3"), or reattaches to it when the
+    // existing segment has the same layout and capacity.
+    explicit ShmTelemetryWriter(const std::string& name, std::uint32_t capacity = kDefaultCapacity);
+    ~ShmTelemetryWriter();
+
+    ShmTelemetryWriter(const ShmTelemetryWriter&) = delete;
+    ShmTelemetryWriter& operator=(const ShmTelemetryWriter&) = delete;
+
+    void publish(const ShmTelemetryRecord& record);
+    void publish(const Telemetry& m) { publish(to_shm_record(m)); }
+
+    std::uint64_t published() const;
+    std::uint32_t capacity() const { return capacity_; }
+    const std::string& name() const { return name_; }
+
+    // Removes the name; mapped readers keep their view until they close.
+    static bool unlink(const std::string& name);
+
+private:
+    std::string name_;
+    std::uint32_t capacity_ = 0;
+    void* base_ = nullptr;
+    size_t bytes_ = 0;
+    shm_ring::Header* header_ = nullptr;
+    shm_ring::Slot* slots_ = nullptr;
+};
+
+enum class ShmReadStatus {
+    Fresh,    // a record newer than the last read
+    Repeat,   // nothing new; the last record again, still within max_age
+    Stale,    // the newest record is older than max_age
+    Empty,    // nothing published yet
+    Torn      // the writer kept lapping the copy; nothing returned
+};
+
+const char* shm_read_status_name(ShmReadStatus status);
+
+class ShmTelemetryReader {
+public:
+    struct Options {
+        std::chrono::milliseconds max_age{500};   // 2.5 control periods
+        unsigned max_retries = 8;                 // lapped copies before Torn
+    };
+
+    struct Stats {
+        std::uint64_t reads = 0;
+        std::uint64_t fresh = 0;
+        std::uint64_t repeats = 0;
+        std::uint64_t stale = 0;
+        std::uint64_t empty = 0;
+        std::uint64_t torn = 0;
+        std::uint64_t retries = 0;        // copies redone because the writer lapped them
+        std::uint64_t skipped = 0;        // records superseded before any read saw them
+        std::uint64_t last_sequence = 0;
+        double last_age_ms = 0.0;
+    };
+
+    ShmTelemetryReader(const std::string& name) : ShmTelemetryReader(name, Options{}) {}
+    ShmTelemetryReader(const std::string& name, const Options& options);
+    ~ShmTelemetryReader();
+
+    ShmTelemetryReader(const ShmTelemetryReader&) = delete;
+    ShmTelemetryReader& operator=(const ShmTelemetryReader&) = delete;
+
+    // Copies the newest record into `out` unless the status is Empty or Torn.
+    ShmReadStatus read_latest(Telemetry& out,
+                              std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    const Stats& stats() const { return stats_; }
+    std::uint64_t published() const;
+    std::int32_t producer_pid() const;
+    std::uint32_t capacity() const { return capacity_; }
+    const Options& options() const { return options_; }
+
+private:
+    Options options_;
+    std::uint32_t capacity_ = 0;
+    const void* base_ = nullptr;
+    size_t bytes_ = 0;
+    const shm_ring::Header* header_ = nullptr;
+    const shm_ring::Slot* slots_ = nullptr;
+    ShmTelemetryRecord last_{};
+    Stats stats_;
+};
+
+} // namespace ivsys
@@ -0,0 +1,132 @@
+#include "simulation_driver.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace ivsys {
+
+SimulationDriver::SimulationDriver(const PatientProfile& profile, const Options& options)
+    : options_(options), engine_(profile, options.seed),
+      loop_metrics_(std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::duration<double>(options.dt_seconds))),
+      cycle_(profile, options.session_id, options.log_mode, options.session_format) {
+    for (const ScenarioEvent& event : options_.events) engine_.add_event(event);
+    if (options_.stage_timing) cycle_.set_loop_metrics(&loop_metrics_);
+}
+
+SimulationReport SimulationDriver::run() {
+    using Clock = std::chrono::steady_clock;
+    SimulationReport report;
+    const double dt = options_.dt_seconds;
+    const double dt_min = dt / 60.0;
+    const std::uint64_t total_ticks =
+        dt > 0.0 ? static_cast<std::uint64_t>(std::llround(options_.duration_seconds / dt)) : 0;
+
+    report.min_hydration_pct = std::numeric_limits<double>::infinity();
+    report.scenarios.resize(options_.events.size());
+    for (size_t e = 0; e < options_.events.size(); ++e) {
+        ScenarioWindowStats& w = report.scenarios[e];
+        w.event = options_.events[e];
+        w.min_hydration_pct = std::numeric_limits<double>::infinity();
+        w.min_cardiac_reserve = std::numeric_limits<double>::infinity();
+    }
+
+    SystemLogger& logger = cycle_.logger();
+    logger.log_event("Simulation started: ticks=" + std::to_string(total_ticks) +
+                     " dt_s=" + std::to_string(dt) + " seed=" + std::to_string(options_.seed) +
+                     " events=" + std::to_string(options_.events.size()));
+
+    double next_reset = options_.volume_window_seconds > 0.0
+                            ? options_.volume_window_seconds
+                            : std::numeric_limits<double>::infinity();
+    double next_progress = options_.progress_interval_seconds > 0.0 && options_.on_progress
+                               ? options_.progress_interval_seconds
+                               : std::numeric_limits<double>::infinity();
+    double rate_sum = 0.0;
+
+    const Clock::time_point wall_start = Clock::now();
+    for (std::uint64_t tick = 1; tick <= total_ticks; ++tick) {
+        const double t = static_cast<double>(tick) * dt;
+        const Clock::time_point tick_start = options_.stage_timing ? Clock::now() : Clock::time_point{};
+        StageClock stages(options_.stage_timing ? &loop_metrics_ : nullptr, tick_start);
+
+        Telemetry measurement = engine_.generate_telemetry(t);
+        stages.lap(LoopStage::Acquire);
+        CycleResult result = cycle_.step(measurement, dt);
+        if (options_.stage_timing) loop_metrics_.record_tick(Clock::now() - tick_start, {}, false, 0);
+
+        const double rate = result.command.infusion_ml_per_min;
+        const double volume = std::max(0.0, rate) * dt_min;
+        const bool warned = result.command.warning_flags.any();
+        rate_sum += rate;
+        report.total_volume_ml += volume;
+        report.max_rate_ml_min = std::max(report.max_rate_ml_min, rate);
+        report.min_hydration_pct = std::min(report.min_hydration_pct, result.state.hydration_pct);
+        report.max_risk_score = std::max(report.max_risk_score, result.state.risk_score);
+        report.safety_overrides += result.command.safety_override;
+        report.warning_ticks += warned;
+        report.emergency_ticks += result.command.warning_flags.has(WarningFlag::EmergencyMinRate);
+        report.low_quality_ticks += result.sensor_quality_low;
+
+        for (size_t e = 0; e < report.scenarios.size(); ++e) {
+            ScenarioWindowStats& w = report.scenarios[e];
+            if (SimulationEngine::envelope(w.event, t) <= 0.0) continue;
+            ++w.ticks;
+            w.mean_rate_ml_min += rate;   // divided by ticks below
+            w.peak_rate_ml_min = std::max(w.peak_rate_ml_min, rate);
+            w.volume_ml += volume;
+            w.min_hydration_pct = std::min(w.min_hydration_pct, result.state.hydration_pct);
+            w.min_cardiac_reserve = std::min(w.min_cardiac_reserve, result.state.cardiac_reserve);
+            w.max_risk_score = std::max(w.max_risk_score, result.state.risk_score);
+            w.warning_ticks += warned;
+            w.low_quality_ticks += result.sensor_quality_low;
+        }
+
+        if (t >= next_reset) {
+            cycle_.reset_24h_volume();
+            ++report.volume_resets;
+            next_reset += options_.volume_window_seconds;
+        }
+        if (t >= next_progress) {
+            SimulationProgress progress;
+            progress.ticks = tick;
+            progress.simulated_seconds = t;
+            progress.wall_seconds = std::chrono::duration<double>(Clock::now() - wall_start).count();
+            progress.volume_ml = report.total_volume_ml;
+            options_.on_progress(progress);
+            next_progress += options_.progress_interval_seconds;
+        }
+
+        report.final_vault_payload_pct = result.measurement.vault_payload_pct;
+        report.vault_cage_breached = result.measurement.vault_cage_breached;
+    }
+    report.wall_seconds = std::chrono::duration<double>(Clock::now() - wall_start).count();
+
+    report.ticks = total_ticks;
+    report.simulated_seconds = static_cast<double>(total_ticks) * dt;
+    if (report.wall_seconds > 0.0) {
+        report.ticks_per_second = static_cast<double>(total_ticks) / report.wall_seconds;
+        report.speedup = report.simulated_seconds / report.wall_seconds;
+    }
+    if (total_ticks > 0) report.mean_rate_ml_min = rate_sum / static_cast<double>(total_ticks);
+    else report.min_hydration_pct = 0.0;
+    for (ScenarioWindowStats& w : report.scenarios) {
+        if (w.ticks > 0) {
+            w.mean_rate_ml_min /= static_cast<double>(w.ticks);
+        } else {
+            w.min_hydration_pct = 0.0;
+            w.min_cardiac_reserve = 0.0;
+        }
+    }
+
+    logger.log_event("Simulation finished: ticks=" + std::to_string(report.ticks) +
+                     " wall_s=" + std::to_string(report.wall_seconds) +
+                     " ticks_per_s=" + std::to_string(report.ticks_per_second) +
+                     " volume_ml=" + std::to_string(report.total_volume_ml));
+    report.logger = logger.stats();
+    if (options_.stage_timing) report.loop = loop_metrics_.snapshot();
+    return report;
+}
+
+} // namespace ivsys
@@ -0,0 +1,111 @@
+#pragma once
+
+/*
+ * simulation_driver.hpp
+ *
+ * Headless, faster-than-real-time runs of the full control pipeline.
+ *
+ * SimulationDriver steps one PatientControlCycle (vault, estimator,
+ * precision spine, controller, safety, logger) on a virtual clock: each
+ * tick covers dt_seconds of therapy and the next one starts as soon as the
+ * previous returns.  Telemetry comes from a SimulationEngine with the
+ * configured scenario events, and every logged record carries the virtual
+ * timestamp, so a simulated session replays like a recorded one.
+ *
+ * The run is deterministic for a given profile, options and seed; only
+ * the wall-clock figures in the report vary.
+ */
+
+#include "control_cycle.hpp"
+#include "simulation_engine.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ivsys {
+
+// Outcome over the ticks an event was active (envelope > 0).
+struct ScenarioWindowStats {
+    ScenarioEvent event;
+    std::uint64_t ticks = 0;
+    double mean_rate_ml_min = 0.0;
+    double peak_rate_ml_min = 0.0;
+    double volume_ml = 0.0;
+    double min_hydration_pct = 0.0;
+    double min_cardiac_reserve = 0.0;
+    double max_risk_score = 0.0;
+    std::uint64_t warning_ticks = 0;        // any SafetyMonitor warning
+    std::uint64_t low_quality_ticks = 0;    // below the sensor-quality alert threshold
+};
+
+struct SimulationProgress {
+    std::uint64_t ticks = 0;
+    double simulated_seconds = 0.0;
+    double wall_seconds = 0.0;
+    double volume_ml = 0.0;   // total infused so far
+};
+
+struct SimulationReport {
+    std::uint64_t ticks = 0;
+    double simulated_seconds = 0.0;
+    double wall_seconds = 0.0;
+    double ticks_per_second = 0.0;   // wall clock
+    double speedup = 0.0;            // simulated seconds per wall second
+
+    double total_volume_ml = 0.0;    // across every 24 h window
+    double mean_rate_ml_min = 0.0;
+    double max_rate_ml_min = 0.0;
+    double min_hydration_pct = 0.0;
+    double max_risk_score = 0.0;
+    std::uint64_t volume_resets = 0;
+    std::uint64_t safety_overrides = 0;
+    std::uint64_t warning_ticks = 0;
+    std::uint64_t emergency_ticks = 0;      // EmergencyMinRate enforced
+    std::uint64_t low_quality_ticks = 0;
+    double final_vault_payload_pct = 0.0;
+    bool vault_cage_breached = false;
+
+    std::vector<ScenarioWindowStats> scenarios;   // one per event, in order
+    LoggerStats logger;
+    ControlLoopMetrics::Snapshot loop;            // ticks == 0 without stage timing
+};
+
+class SimulationDriver {
+public:
+    struct Options {
+        double duration_seconds = 24.0 * 3600.0;
+        double dt_seconds = 0.2;                  // therapy time per tick (5 Hz)
+        std::uint64_t seed = 1;
+        std::vector<ScenarioEvent> events;
+        std::string session_id = "sim";
+        // Sync keeps every record: the async queue would drop non-critical
+        // ones when the virtual clock outruns the writer.
+        LoggerMode log_mode = LoggerMode::Sync;
+        SessionFormat session_format = SessionFormat::Binary;
+        // Start a new SafetyMonitor volume window every this many simulated
+        // seconds; 0 keeps one window for the whole run.
+        double volume_window_seconds = 24.0 * 3600.0;
+        bool stage_timing = false;                // per-stage latency in the report
+        // Called every progress_interval_seconds of simulated time (0: never).
+        double progress_interval_seconds = 0.0;
+        std::function<void(const SimulationProgress&)> on_progress;
+    };
+
+    SimulationDriver(const PatientProfile& profile, const Options& options);
+
+    // Runs the whole duration; call once.
+    SimulationReport run();
+
+    const SimulationEngine& engine() const { return engine_; }
+    PatientControlCycle& cycle() { return cycle_; }
+
+private:
+    Options options_;
+    SimulationEngine engine_;
+    ControlLoopMetrics loop_metrics_;
+    PatientControlCycle cycle_;
+};
+
+} // namespace ivsys
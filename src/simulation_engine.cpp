@@ -1,25 +1,128 @@
 #include "simulation_engine.hpp"
+#include <algorithm>
 #include <cmath>
 
 namespace ivsys {
 
+namespace {
+
+// splitmix64 finalizer: a well-mixed 64-bit value from (seed, tick)
+std::uint64_t mix(std::uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Uniform in [-1, 1)
+double noise(std::uint64_t seed, std::uint64_t tick, std::uint64_t channel) {
+    std::uint64_t bits = mix(seed ^ mix(tick * 4 + channel));
+    return static_cast<double>(bits >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+}
+
+} // namespace
+
 SimulationEngine::SimulationEngine()
-    : base_hydration_(75.0),
-      base_hr_(70.0) {}
-
-Telemetry SimulationEngine::generate_telemetry(double t) {
-    Telemetry m{};
-    m.hydration_pct = base_hydration_ + 10.0 * std::sin(t * 0.05);
-    m.heart_rate_bpm = base_hr_ + 15.0 * std::sin(t * 0.1);
-    m.spo2_pct = 97.0;
-    m.temp_celsius = 37.0;
-    m.lactate_mmol = 2.0;
-    m.fatigue_idx = 0.3;
+    : base_hr_(70.0), seed_(1) {}
+
+SimulationEngine::SimulationEngine(const PatientProfile& profile, std::uint64_t seed)
+    : base_hr_(profile.baseline_hr_bpm), seed_(seed) {}
+
+void SimulationEngine::add_event(const ScenarioEvent& event) {
+    events_.push_back(event);
+}
+
+double SimulationEngine::envelope(const ScenarioEvent& event, double t) {
+    double end = event.start_s + event.duration_s;
+    if (event.duration_s <= 0.0 || t < event.start_s || t >= end) return 0.0;
+    double ramp = std::min(event.duration_s * kRampFraction, kMaxRampSeconds);
+    double into = t - event.start_s;
+    double left = end - t;
+    if (into < ramp) return into / ramp;
+    if (left < ramp) return left / ramp;
+    return 1.0;
+}
+
+Telemetry SimulationEngine::generate_telemetry(double t) const {
+    Telemetry m;
+    m.timestamp = std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(t)));
+
+    // Baseline: gradual dehydration and recovery pattern
+    m.hydration_pct = 65.0 + 15.0 * std::sin(t * 0.05);
+    m.heart_rate_bpm = base_hr_ + 20.0 * std::sin(t * 0.1);
+    m.temp_celsius = 37.0 + 0.5 * std::sin(t * 0.03);
     m.blood_loss_idx = 0.0;
-    m.signal_quality = 1.0;
-    m.cardiac_output_L_min = 5.0;
+    m.fatigue_idx = 0.3 + 0.2 * std::sin(t * 0.02);
     m.anxiety_idx = 0.2;
+    m.signal_quality = 0.85 + 0.1 * std::sin(t * 0.5);
+    m.spo2_pct = 97.0 + 2.0 * std::sin(t * 0.08);
+    m.lactate_mmol = 2.0 + 1.0 * std::sin(t * 0.04);
+    m.cardiac_output_L_min = 5.0 + 1.0 * std::sin(t * 0.06);
+
+    for (const ScenarioEvent& event : events_) {
+        double s = envelope(event, t) * std::clamp(event.severity, 0.0, 1.0);
+        if (s <= 0.0) continue;
+        switch (event.kind) {
+        case ScenarioKind::Hemorrhage:
+            m.blood_loss_idx += 0.8 * s;
+            m.hydration_pct -= 20.0 * s;
+            m.heart_rate_bpm += 35.0 * s;
+            m.cardiac_output_L_min -= 2.0 * s;
+            m.lactate_mmol += 3.0 * s;
+            m.spo2_pct -= 2.0 * s;
+            m.anxiety_idx += 0.3 * s;
+            break;
+        case ScenarioKind::Hypoxia:
+            m.spo2_pct -= 15.0 * s;
+            m.heart_rate_bpm += 20.0 * s;
+            m.lactate_mmol += 2.0 * s;
+            m.fatigue_idx += 0.2 * s;
+            m.anxiety_idx += 0.5 * s;
+            break;
+        case ScenarioKind::SensorDropout: {
+            // A fresh draw every 100 ms of simulated time
+            std::uint64_t tick = static_cast<std::uint64_t>(std::max(0.0, t) * 10.0);
+            m.signal_quality *= 1.0 - 0.8 * s;
+            m.hydration_pct += 8.0 * s * noise(seed_, tick, 0);
+            m.heart_rate_bpm += 25.0 * s * noise(seed_, tick, 1);
+            m.spo2_pct += 5.0 * s * noise(seed_, tick, 2);
+            m.cardiac_output_L_min += 1.0 * s * noise(seed_, tick, 3);
+            break;
+        }
+        }
+    }
+
+    m.hydration_pct = std::clamp(m.hydration_pct, 0.0, 100.0);
+    m.heart_rate_bpm = std::max(m.heart_rate_bpm, 0.0);
+    m.blood_loss_idx = std::clamp(m.blood_loss_idx, 0.0, 1.0);
+    m.fatigue_idx = std::clamp(m.fatigue_idx, 0.0, 1.0);
+    m.anxiety_idx = std::clamp(m.anxiety_idx, 0.0, 1.0);
+    m.signal_quality = std::clamp(m.signal_quality, 0.0, 1.0);
+    m.spo2_pct = std::clamp(m.spo2_pct, 0.0, 100.0);
+    m.lactate_mmol = std::max(m.lactate_mmol, 0.0);
+    m.cardiac_output_L_min = std::max(m.cardiac_output_L_min, 0.0);
     return m;
 }
 
+const char* SimulationEngine::kind_name(ScenarioKind kind) {
+    switch (kind) {
+    case ScenarioKind::Hemorrhage: return "hemorrhage";
+    case ScenarioKind::Hypoxia: return "hypoxia";
+    case ScenarioKind::SensorDropout: return "dropout";
+    }
+    return "unknown";
+}
+
+bool SimulationEngine::parse_kind(const std::string& name, ScenarioKind& kind) {
+    for (ScenarioKind k : {ScenarioKind::Hemorrhage, ScenarioKind::Hypoxia, ScenarioKind::SensorDropout}) {
+        if (name == kind_name(k)) {
+            kind = k;
+            return true;
+        }
+    }
+    return false;
+}
+
 } // namespace ivsys
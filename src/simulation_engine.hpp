@@ -1,18 +1,64 @@
 #pragma once
 
+/*
+ * simulation_engine.hpp
+ *
+ * Synthetic telemetry for one patient on a virtual clock.
+ *
+ * The baseline is the sensor waveform the single-patient loop and ward mode
+ * have always run on.  Scenario events layer clinical deteriorations on
+ * top of it, each with a linear ramp in, a hold and a linear ramp out.
+ * generate_telemetry() is a pure function of the simulated time (and the
+ * seed, for dropout noise), so a scenario run is reproducible tick for tick.
+ */
+
 #include "iv_system_types.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
 
 namespace ivsys {
 
+enum class ScenarioKind {
+    Hemorrhage,      // blood loss: hydration and cardiac output fall, HR and lactate rise
+    Hypoxia,         // SpO2 falls, HR, lactate and anxiety rise
+    SensorDropout    // signal quality collapses and readings turn noisy
+};
+
+struct ScenarioEvent {
+    ScenarioKind kind = ScenarioKind::Hemorrhage;
+    double start_s = 0.0;
+    double duration_s = 0.0;
+    double severity = 1.0;     // 0-1 scales the effect; 1 is a severe episode
+};
+
 class SimulationEngine {
 public:
+    // Ramp in and out over this fraction of the event (at most 10 min each).
+    static constexpr double kRampFraction = 0.2;
+    static constexpr double kMaxRampSeconds = 600.0;
+
     SimulationEngine();
+    explicit SimulationEngine(const PatientProfile& profile, std::uint64_t seed = 1);
+
+    void add_event(const ScenarioEvent& event);
+    const std::vector<ScenarioEvent>& events() const { return events_; }
+
+    // Telemetry at sim_time_seconds, timestamped at the steady_clock epoch
+    // plus sim_time_seconds.
+    Telemetry generate_telemetry(double sim_time_seconds) const;
+
+    // 0 outside the event, 1 while it holds at full strength.
+    static double envelope(const ScenarioEvent& event, double sim_time_seconds);
 
-    Telemetry generate_telemetry(double sim_time_seconds);
+    static const char* kind_name(ScenarioKind kind);
+    // "hemorrhage", "hypoxia" or "dropout"; false for anything else.
+    static bool parse_kind(const std::string& name, ScenarioKind& kind);
 
 private:
-    double base_hydration_;
     double base_hr_;
+    std::uint64_t seed_;
+    std::vector<ScenarioEvent> events_;
 };
 
 } // namespace ivsys
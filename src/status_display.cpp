@@ -0,0 +1,115 @@
+#include "status_display.hpp"
+#include "control_text.hpp"
+#include <iomanip>
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ivsys {
+
+StatusDisplay::StatusDisplay() : StatusDisplay(Options{}) {}
+
+StatusDisplay::StatusDisplay(const Options& options) : options_(options) {
+    if (!options_.out) options_.out = &std::cout;
+}
+
+StatusDisplay::~StatusDisplay() {
+    stop();
+}
+
+void StatusDisplay::start() {
+    if (options_.mode == DisplayMode::Headless || renderer_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        running_ = true;
+    }
+    renderer_ = std::thread([this] { render_loop(); });
+}
+
+void StatusDisplay::stop() {
+    if (!renderer_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        running_ = false;
+    }
+    wake_cv_.notify_one();
+    renderer_.join();
+    render_latest();   // the newest update may have arrived after the last frame
+}
+
+void StatusDisplay::publish(const PatientState& state, const ControlOutput& command,
+                            double cumulative_volume_ml) {
+    if (options_.mode == DisplayMode::Headless) return;
+    Frame f{};
+    f.state = state;
+    f.infusion_ml_per_min = command.infusion_ml_per_min;
+    f.confidence = command.confidence;
+    f.cumulative_volume_ml = cumulative_volume_ml;
+    f.warning_flags = command.warning_flags;
+    frame_.store(f);
+    published_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void StatusDisplay::render_loop() {
+#ifdef __linux__
+    // Best effort: terminal output should lose any contention with the
+    // control thread.  Linux applies nice values per thread.
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+#endif
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    while (running_) {
+        wake_cv_.wait_for(lock, options_.refresh_interval, [this] { return !running_; });
+        if (!running_) break;
+        lock.unlock();
+        render_latest();
+        lock.lock();
+    }
+}
+
+void StatusDisplay::render_latest() {
+    // version() counts the constructor's empty record as the first store.
+    std::uint64_t version = frame_.version();
+    if (version <= 1 || version == last_rendered_version_) return;
+    Frame f;
+    frame_.load(f);
+    last_rendered_version_ = version;
+    render(*options_.out, f);
+    rendered_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void StatusDisplay::render(std::ostream& out, const Frame& frame) {
+    const PatientState& state = frame.state;
+    out << "\n=== AI-IV Enhanced Energy Transfer System ===\n";
+    out << "Hydration: " << std::fixed << std::setprecision(1)
+        << state.hydration_pct << "%  ";
+    out << "Energy_T: " << std::setprecision(3) << state.energy_T << "  ";
+    out << "HR: " << std::setprecision(0) << state.heart_rate_bpm << " bpm\n";
+
+    out << "Energy Transfer: " << std::setprecision(2)
+        << state.energy_T_absolute << " W/kg  ";
+    out << "Flow: " << state.estimated_flow_velocity_cm_s << " cm/s  ";
+    out << "G(v): " << std::setprecision(3) << state.flow_efficiency << "\n";
+
+    out << "Risk: " << std::setprecision(2) << state.risk_score << "  ";
+    out << "Cardiac Reserve: " << state.cardiac_reserve << "  ";
+    out << "Coherence: " << state.coherence_sigma << "\n";
+
+    out << "Infusion Rate: " << std::setprecision(2)
+        << frame.infusion_ml_per_min << " ml/min  ";
+    out << "Confidence: " << frame.confidence << "\n";
+
+    if (frame.warning_flags.any()) {
+        out << "⚠️  WARNINGS: ";
+        write_warnings(out, frame.warning_flags);
+        out << "\n";
+    }
+    out << "24h Volume: " << std::setprecision(0)
+        << frame.cumulative_volume_ml << " ml\n";
+    out << std::flush;
+}
+
+} // namespace ivsys
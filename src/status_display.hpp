@@ -0,0 +1,89 @@
+#pragma once
+
+/*
+ * status_display.hpp
+ *
+ * Console status panel rendered off the control thread.
+ *
+ * - The control loop calls publish() once per tick.  It copies a small
+ *   fixed-size record into a SeqLock: O(1), no allocation, no I/O, and
+ *   it never waits on the renderer.
+ * - A renderer thread (nice +10 on Linux) wakes every refresh_interval
+ *   and draws the newest record if anything has been published since the
+ *   last frame.  Updates in between are coalesced, so a slow terminal
+ *   lowers the frame rate instead of delaying control ticks.
+ * - Headless mode starts no thread and publish() does nothing.
+ * - stop() draws one last frame if the newest update was never shown.
+ */
+
+#include "iv_system_types.hpp"
+#include "SeqLock.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <thread>
+
+namespace ivsys {
+
+enum class DisplayMode {
+    Console,    // renderer thread writes to the configured stream
+    Headless    // nothing is rendered
+};
+
+class StatusDisplay {
+public:
+    struct Options {
+        DisplayMode mode = DisplayMode::Console;
+        std::chrono::milliseconds refresh_interval{2000};
+        std::ostream* out = nullptr;               // null: std::cout
+    };
+
+    // What one frame shows; trivially copyable for the SeqLock.
+    struct Frame {
+        PatientState state;
+        double infusion_ml_per_min;
+        double confidence;
+        double cumulative_volume_ml;
+        WarningFlags warning_flags;
+    };
+
+    StatusDisplay();
+    explicit StatusDisplay(const Options& options);
+    ~StatusDisplay();
+
+    StatusDisplay(const StatusDisplay&) = delete;
+    StatusDisplay& operator=(const StatusDisplay&) = delete;
+
+    void start();
+    void stop();
+
+    // Control thread only.
+    void publish(const PatientState& state, const ControlOutput& command,
+                 double cumulative_volume_ml);
+
+    DisplayMode mode() const { return options_.mode; }
+    std::uint64_t updates_published() const { return published_.load(std::memory_order_relaxed); }
+    std::uint64_t frames_rendered() const { return rendered_.load(std::memory_order_relaxed); }
+
+    static void render(std::ostream& out, const Frame& frame);
+
+private:
+    void render_loop();
+    void render_latest();
+
+    Options options_;
+    SeqLock<Frame> frame_;
+    std::atomic<std::uint64_t> published_{0};
+    std::atomic<std::uint64_t> rendered_{0};
+    std::uint64_t last_rendered_version_ = 0;   // renderer thread (or stop()) only
+
+    std::thread renderer_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    bool running_ = false;
+};
+
+} // namespace ivsys
@@ -0,0 +1,242 @@
+#include "timeseries_store.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace ivsys {
+
+namespace {
+
+constexpr std::int64_t kBucketMs[kSeriesResolutionCount] = {0, 1000, 60 * 1000, 10 * 60 * 1000};
+
+// Floor division, so times before the epoch still bucket downwards
+std::int64_t bucket_start(std::int64_t time_ms, std::int64_t width) {
+    std::int64_t q = time_ms / width;
+    if (time_ms % width != 0 && time_ms < 0) --q;
+    return q * width;
+}
+
+void add_sample(SeriesBucket& b, const double (&values)[kSeriesChannelCount]) {
+    if (b.samples == 0) {
+        for (size_t i = 0; i < kSeriesChannelCount; ++i) {
+            b.min[i] = b.max[i] = b.sum[i] = values[i];
+        }
+    } else {
+        for (size_t i = 0; i < kSeriesChannelCount; ++i) {
+            b.min[i] = std::min(b.min[i], values[i]);
+            b.max[i] = std::max(b.max[i], values[i]);
+            b.sum[i] += values[i];
+        }
+    }
+    ++b.samples;
+}
+
+} // namespace
+
+const char* series_channel_name(SeriesChannel c) {
+    switch (c) {
+        case SeriesChannel::Hydration:     return "hydration_pct";
+        case SeriesChannel::HeartRate:     return "heart_rate_bpm";
+        case SeriesChannel::Temperature:   return "temp_celsius";
+        case SeriesChannel::SpO2:          return "spo2_pct";
+        case SeriesChannel::Lactate:       return "lactate_mmol";
+        case SeriesChannel::CardiacOutput: return "cardiac_output_L_min";
+        case SeriesChannel::InfusionRate:  return "infusion_ml_min";
+    }
+    return "unknown";
+}
+
+const char* series_resolution_name(SeriesResolution r) {
+    switch (r) {
+        case SeriesResolution::Raw:        return "raw";
+        case SeriesResolution::OneSecond:  return "1s";
+        case SeriesResolution::OneMinute:  return "1m";
+        case SeriesResolution::TenMinutes: return "10m";
+    }
+    return "unknown";
+}
+
+bool parse_series_resolution(const char* name, SeriesResolution& out) {
+    for (size_t i = 0; i < kSeriesResolutionCount; ++i) {
+        SeriesResolution r = static_cast<SeriesResolution>(i);
+        if (std::strcmp(name, series_resolution_name(r)) == 0) {
+            out = r;
+            return true;
+        }
+    }
+    return false;
+}
+
+TimeSeriesStore::TimeSeriesStore(const Options& options)
+    : options_(options),
+      raw_(std::max<size_t>(options.raw_capacity, 1)),
+      tiers_{{Tier(std::max<size_t>(options.second_capacity, 1)),
+              Tier(std::max<size_t>(options.minute_capacity, 1)),
+              Tier(std::max<size_t>(options.ten_minute_capacity, 1))}} {}
+
+std::int64_t TimeSeriesStore::bucket_ms(SeriesResolution resolution) {
+    return kBucketMs[static_cast<size_t>(resolution)];
+}
+
+size_t TimeSeriesStore::memory_bytes() const {
+    size_t bytes = raw_.size() * sizeof(SeqLock<RawSlot>);
+    for (const Tier& tier : tiers_) {
+        bytes += tier.slots.size() * sizeof(SeqLock<Slot>) + sizeof(Tier);
+    }
+    return bytes;
+}
+
+void TimeSeriesStore::append(std::int64_t time_ms, const double (&values)[kSeriesChannelCount]) {
+    std::uint64_t n = samples_.load(std::memory_order_relaxed);
+    if (n > 0 && time_ms < last_time_ms_) time_ms = last_time_ms_;
+    last_time_ms_ = time_ms;
+
+    RawSlot raw;
+    raw.sequence = n;
+    raw.time_ms = time_ms;
+    std::memcpy(raw.values, values, sizeof(raw.values));
+    raw_[n % raw_.size()].store(raw);
+
+    for (size_t t = 0; t < tiers_.size(); ++t) {
+        Tier& tier = tiers_[t];
+        std::int64_t start = bucket_start(time_ms, kBucketMs[t + 1]);
+        if (tier.staging.samples > 0 && tier.staging.start_ms != start) {
+            // Seal the finished bucket before the open one moves on, so a
+            // reader that loaded the old open bucket finds it in the ring
+            std::uint64_t seq = tier.count.load(std::memory_order_relaxed);
+            tier.slots[seq % tier.slots.size()].store(Slot{seq, tier.staging});
+            tier.count.store(seq + 1, std::memory_order_release);
+            tier.staging = SeriesBucket{};
+        }
+        tier.staging.start_ms = start;
+        add_sample(tier.staging, values);
+        tier.open.store(tier.staging);
+    }
+
+    latest_ms_.store(time_ms, std::memory_order_release);
+    samples_.store(n + 1, std::memory_order_release);
+}
+
+void TimeSeriesStore::append(std::int64_t time_ms, const Telemetry& m, double infusion_ml_min) {
+    const double values[kSeriesChannelCount] = {
+        m.hydration_pct, m.heart_rate_bpm, m.temp_celsius, m.spo2_pct,
+        m.lactate_mmol, m.cardiac_output_L_min, infusion_ml_min,
+    };
+    append(time_ms, values);
+}
+
+bool TimeSeriesStore::read_slot(const Tier& tier, std::uint64_t sequence, SeriesBucket& out) {
+    Slot slot;
+    tier.slots[sequence % tier.slots.size()].load(slot);
+    if (slot.sequence != sequence) return false;
+    out = slot.bucket;
+    return true;
+}
+
+bool TimeSeriesStore::read_raw(std::uint64_t sequence, RawSlot& out) const {
+    raw_[sequence % raw_.size()].load(out);
+    return out.sequence == sequence;
+}
+
+std::int64_t TimeSeriesStore::retained_from(SeriesResolution resolution, bool& dropped) const {
+    if (resolution == SeriesResolution::Raw) {
+        std::uint64_t end = samples_.load(std::memory_order_acquire);
+        dropped = end > raw_.size();
+        std::uint64_t seq = end > raw_.size() ? end - raw_.size() : 0;
+        RawSlot raw;
+        for (; seq < end; ++seq) {
+            if (read_raw(seq, raw)) return raw.time_ms;
+        }
+        return latest_ms();
+    }
+    const Tier& tier = tiers_[static_cast<size_t>(resolution) - 1];
+    SeriesBucket open;
+    tier.open.load(open);
+    std::uint64_t end = tier.count.load(std::memory_order_acquire);
+    dropped = end > tier.slots.size();
+    std::uint64_t seq = end > tier.slots.size() ? end - tier.slots.size() : 0;
+    SeriesBucket b;
+    for (; seq < end; ++seq) {
+        if (read_slot(tier, seq, b)) return b.start_ms;
+    }
+    return open.start_ms;
+}
+
+SeriesResolution TimeSeriesStore::pick_resolution(std::int64_t from_ms, std::int64_t to_ms,
+                                                  size_t max_points) const {
+    // Unsigned: the difference of two arbitrary client times overflows int64
+    std::uint64_t span = to_ms > from_ms
+        ? static_cast<std::uint64_t>(to_ms) - static_cast<std::uint64_t>(from_ms) : 0;
+    for (size_t i = 0; i < kSeriesResolutionCount; ++i) {
+        SeriesResolution r = static_cast<SeriesResolution>(i);
+        std::int64_t width = i == 0 ? std::max<std::int64_t>(options_.raw_period_ms, 1) : kBucketMs[i];
+        bool fits = span / static_cast<std::uint64_t>(width) + 1 <= max_points;
+        bool dropped = false;
+        std::int64_t oldest = retained_from(r, dropped);
+        if (fits && (!dropped || oldest <= from_ms)) return r;
+    }
+    return SeriesResolution::TenMinutes;
+}
+
+TimeSeriesStore::Range TimeSeriesStore::query(std::int64_t from_ms, std::int64_t to_ms,
+                                              SeriesResolution resolution) const {
+    Range range;
+    range.resolution = resolution;
+    range.bucket_ms = bucket_ms(resolution);
+    bool dropped = false;
+    range.retained_from_ms = retained_from(resolution, dropped);
+    range.complete = !dropped || range.retained_from_ms <= from_ms;
+    if (to_ms < from_ms) return range;
+
+    if (resolution == SeriesResolution::Raw) {
+        std::uint64_t end = samples_.load(std::memory_order_acquire);
+        std::uint64_t lo = end > raw_.size() ? end - raw_.size() : 0, hi = end;
+        RawSlot raw;
+        // First retained sample at or after from_ms; an overwritten slot
+        // held an older sample
+        while (lo < hi) {
+            std::uint64_t mid = lo + (hi - lo) / 2;
+            if (!read_raw(mid, raw) || raw.time_ms < from_ms) lo = mid + 1;
+            else hi = mid;
+        }
+        for (std::uint64_t seq = lo; seq < end; ++seq) {
+            if (!read_raw(seq, raw)) continue;
+            if (raw.time_ms > to_ms) break;
+            SeriesBucket b;
+            b.start_ms = raw.time_ms;
+            b.samples = 1;
+            std::memcpy(b.min, raw.values, sizeof(b.min));
+            std::memcpy(b.max, raw.values, sizeof(b.max));
+            std::memcpy(b.sum, raw.values, sizeof(b.sum));
+            range.buckets.push_back(b);
+        }
+        return range;
+    }
+
+    const Tier& tier = tiers_[static_cast<size_t>(resolution) - 1];
+    const std::int64_t width = range.bucket_ms;
+    // Open bucket first: if it is sealed while the ring is read, the ring
+    // copy (with every sample) wins below
+    SeriesBucket open;
+    tier.open.load(open);
+    std::uint64_t end = tier.count.load(std::memory_order_acquire);
+    std::uint64_t lo = end > tier.slots.size() ? end - tier.slots.size() : 0, hi = end;
+    SeriesBucket b;
+    // First bucket ending after from_ms
+    while (lo < hi) {
+        std::uint64_t mid = lo + (hi - lo) / 2;
+        if (!read_slot(tier, mid, b) || b.start_ms + width <= from_ms) lo = mid + 1;
+        else hi = mid;
+    }
+    for (std::uint64_t seq = lo; seq < end; ++seq) {
+        if (!read_slot(tier, seq, b)) continue;
+        if (b.start_ms > to_ms) break;
+        range.buckets.push_back(b);
+    }
+    bool open_sealed = !range.buckets.empty() && range.buckets.back().start_ms >= open.start_ms;
+    if (open.samples > 0 && !open_sealed && open.start_ms + width > from_ms && open.start_ms <= to_ms) {
+        range.buckets.push_back(open);
+    }
+    return range;
+}
+
+} // namespace ivsys
@@ -0,0 +1,164 @@
+#pragma once
+
+/*
+ * timeseries_store.hpp
+ *
+ * In-memory, multi-resolution trend store for one patient.
+ *
+ * The control loop appends one sample per tick; the store keeps
+ *
+ *   - Raw          every sample                      (default 10 min at 5 Hz)
+ *   - OneSecond    1 s  min / max / mean buckets     (default 1 h)
+ *   - OneMinute    1 min buckets                     (default 24 h)
+ *   - TenMinutes   10 min buckets                    (default 7 days)
+ *
+ * Every tier is a fixed-capacity ring allocated up front, so memory per
+ * patient is bounded (memory_bytes(), about 1.5 MB with the defaults) and
+ * append() never allocates.  Each rollup tier is fed directly from the
+ * raw samples, so a 10 min mean is the mean of its samples, not of means.
+ *
+ * Concurrency follows the REST telemetry history: one writer, any number
+ * of readers.  Ring slots are SeqLocks tagged with their sequence number,
+ * and each tier's still-open bucket is published in its own SeqLock after
+ * every append, so a range query sees data up to the latest tick without
+ * ever making the writer wait.
+ *
+ * Times are caller-supplied milliseconds (AIIVSystem uses the Unix epoch;
+ * tests and simulations may use a virtual clock).  A sample older than
+ * the previous one is stored at the previous sample's time, so buckets
+ * stay ordered across a wall-clock step backwards.
+ */
+
+#include "iv_system_types.hpp"
+#include "SeqLock.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ivsys {
+
+enum class SeriesResolution : std::uint8_t {
+    Raw,
+    OneSecond,
+    OneMinute,
+    TenMinutes,
+};
+constexpr size_t kSeriesResolutionCount = 4;
+
+enum class SeriesChannel : std::uint8_t {
+    Hydration,
+    HeartRate,
+    Temperature,
+    SpO2,
+    Lactate,
+    CardiacOutput,
+    InfusionRate,
+};
+constexpr size_t kSeriesChannelCount = 7;
+
+// JSON field names: the /api/telemetry names plus "infusion_ml_min"
+const char* series_channel_name(SeriesChannel c);
+// "raw", "1s", "1m", "10m"
+const char* series_resolution_name(SeriesResolution r);
+// Inverse of series_resolution_name(); false leaves out untouched.
+bool parse_series_resolution(const char* name, SeriesResolution& out);
+
+// One bucket (or, at Raw, one sample with min == max == mean).
+struct SeriesBucket {
+    std::int64_t start_ms = 0;
+    std::uint64_t samples = 0;
+    double min[kSeriesChannelCount] = {};
+    double max[kSeriesChannelCount] = {};
+    double sum[kSeriesChannelCount] = {};
+
+    double mean(SeriesChannel c) const {
+        size_t i = static_cast<size_t>(c);
+        return samples > 0 ? sum[i] / static_cast<double>(samples) : 0.0;
+    }
+};
+
+class TimeSeriesStore {
+public:
+    struct Options {
+        size_t raw_capacity = 3000;         // samples
+        size_t second_capacity = 3600;      // buckets per tier
+        size_t minute_capacity = 1440;
+        size_t ten_minute_capacity = 1008;
+        std::int64_t raw_period_ms = 200;   // expected tick spacing, for auto resolution
+    };
+
+    // Auto resolution keeps a response under this many points
+    static constexpr size_t kDefaultMaxPoints = 4000;
+
+    struct Range {
+        SeriesResolution resolution = SeriesResolution::Raw;
+        std::int64_t bucket_ms = 0;         // 0 at Raw
+        // Oldest time the tier still holds; false complete means the tier
+        // has already dropped data from the start of the requested range.
+        std::int64_t retained_from_ms = 0;
+        bool complete = true;
+        std::vector<SeriesBucket> buckets;  // oldest first, last one may still be open
+    };
+
+    TimeSeriesStore() : TimeSeriesStore(Options{}) {}
+    explicit TimeSeriesStore(const Options& options);
+
+    TimeSeriesStore(const TimeSeriesStore&) = delete;
+    TimeSeriesStore& operator=(const TimeSeriesStore&) = delete;
+
+    // Writer side (one thread).
+    void append(std::int64_t time_ms, const double (&values)[kSeriesChannelCount]);
+    void append(std::int64_t time_ms, const Telemetry& telemetry, double infusion_ml_min);
+
+    // Buckets overlapping [from_ms, to_ms] at the given resolution.
+    Range query(std::int64_t from_ms, std::int64_t to_ms, SeriesResolution resolution) const;
+
+    // Finest tier that has dropped nothing since from_ms and fits
+    // [from_ms, to_ms] in max_points; the coarsest tier when none does.
+    SeriesResolution pick_resolution(std::int64_t from_ms, std::int64_t to_ms,
+                                     size_t max_points = kDefaultMaxPoints) const;
+
+    std::uint64_t sample_count() const { return samples_.load(std::memory_order_acquire); }
+    // Time of the newest sample; 0 before the first.
+    std::int64_t latest_ms() const { return latest_ms_.load(std::memory_order_acquire); }
+
+    static std::int64_t bucket_ms(SeriesResolution resolution);
+    // Bytes held by the rings, fixed at construction.
+    size_t memory_bytes() const;
+
+private:
+    struct Slot {
+        std::uint64_t sequence;             // position in the tier's stream
+        SeriesBucket bucket;
+    };
+    struct RawSlot {
+        std::uint64_t sequence;
+        std::int64_t time_ms;
+        double values[kSeriesChannelCount];
+    };
+
+    struct Tier {
+        explicit Tier(size_t capacity) : slots(capacity) {}
+        std::vector<SeqLock<Slot>> slots;   // slot i % N holds bucket i
+        std::atomic<std::uint64_t> count{0};
+        SeqLock<SeriesBucket> open;         // samples == 0: nothing open yet
+        SeriesBucket staging;               // writer-private copy of open
+    };
+
+    // Reads ring entry `sequence`; false if it was overwritten meanwhile.
+    static bool read_slot(const Tier& tier, std::uint64_t sequence, SeriesBucket& out);
+    bool read_raw(std::uint64_t sequence, RawSlot& out) const;
+    // Oldest time the tier holds; dropped is set once it has overwritten any.
+    std::int64_t retained_from(SeriesResolution resolution, bool& dropped) const;
+
+    Options options_;
+    std::vector<SeqLock<RawSlot>> raw_;     // slot i % N holds sample i
+    std::atomic<std::uint64_t> samples_{0};
+    std::atomic<std::int64_t> latest_ms_{0};
+    std::int64_t last_time_ms_ = 0;         // writer-private
+    std::array<Tier, kSeriesResolutionCount - 1> tiers_;   // OneSecond..TenMinutes
+};
+
+} // namespace ivsys
@@ -0,0 +1,247 @@
+#include "uncertainty_engine.hpp"
+#include "precision_spine/PrecisionSpine.hpp"
+#include "Utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace ivsys {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Chunks per worker: enough for stealing to even out uneven chunks.
+constexpr size_t kChunksPerWorker = 4;
+// Weight of the newest evaluation in ns_per_sample().
+constexpr double kCostSmoothing = 0.25;
+
+std::uint64_t splitmix64(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Standard normal pairs (Box-Muller) from one sample's own stream.
+class SampleNoise {
+public:
+    explicit SampleNoise(std::uint64_t seed) : state_(seed) {}
+
+    double next() {
+        if (has_spare_) {
+            has_spare_ = false;
+            return spare_;
+        }
+        // (0, 1]: keeps log() finite
+        double u1 = (static_cast<double>(splitmix64(state_) >> 11) + 1.0) * 0x1.0p-53;
+        double u2 = static_cast<double>(splitmix64(state_) >> 11) * 0x1.0p-53;
+        double r = std::sqrt(-2.0 * std::log(u1));
+        double theta = 6.283185307179586 * u2;
+        spare_ = r * std::sin(theta);
+        has_spare_ = true;
+        return r * std::cos(theta);
+    }
+
+private:
+    std::uint64_t state_;
+    double spare_ = 0.0;
+    bool has_spare_ = false;
+};
+
+Telemetry perturb(const Telemetry& m, const SensorNoiseModel& noise, SampleNoise& rng) {
+    double scale = 1.0 + noise.quality_gain * (1.0 - Utils::clamp(m.signal_quality, 0.0, 1.0));
+    Telemetry p = m;
+    p.hydration_pct = Utils::clamp(m.hydration_pct + scale * noise.hydration_pct * rng.next(), 0.0, 100.0);
+    p.heart_rate_bpm = std::max(0.0, m.heart_rate_bpm + scale * noise.heart_rate_bpm * rng.next());
+    p.temp_celsius = m.temp_celsius + scale * noise.temp_celsius * rng.next();
+    p.spo2_pct = Utils::clamp(m.spo2_pct + scale * noise.spo2_pct * rng.next(), 0.0, 100.0);
+    p.lactate_mmol = std::max(0.0, m.lactate_mmol + scale * noise.lactate_mmol * rng.next());
+    p.fatigue_idx = Utils::clamp(m.fatigue_idx + scale * noise.fatigue_idx * rng.next(), 0.0, 1.0);
+    p.anxiety_idx = Utils::clamp(m.anxiety_idx + scale * noise.anxiety_idx * rng.next(), 0.0, 1.0);
+    p.cardiac_output_L_min =
+        std::max(0.0, m.cardiac_output_L_min + scale * noise.cardiac_output_L_min * rng.next());
+    return p;
+}
+
+// One decision on private copies, exactly as PatientControlCycle::step
+// makes it.
+struct Decision {
+    ControlOutput command;
+    bool fallback;
+};
+
+template <typename Policy>
+Decision decide_once(const Telemetry& m, const PatientProfile& profile, PolicyStateEstimator<Policy> estimator,
+                     BasicAdaptiveController<Policy> controller, BasicSafetyMonitor<Policy>& safety,
+                     double current_infusion_rate, double dt_minutes) {
+    PatientState state = estimator.estimate(m, profile, current_infusion_rate);
+    precision_spine::TreatmentFlow safe_flow =
+        precision_spine::reject_noise(precision_spine::dose_route(state));
+    PatientState validated = precision_spine::fallback_floor(safe_flow);
+    return {controller.decide(validated, safety, estimator, dt_minutes), !safe_flow.is_valid};
+}
+
+// Linear interpolation between order statistics of sorted values.
+double quantile(const std::vector<double>& sorted, double q) {
+    if (sorted.empty()) return 0.0;
+    double pos = Utils::clamp(q, 0.0, 1.0) * static_cast<double>(sorted.size() - 1);
+    size_t lo = static_cast<size_t>(pos);
+    size_t hi = std::min(lo + 1, sorted.size() - 1);
+    double frac = pos - static_cast<double>(lo);
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * frac;
+}
+
+size_t resolve_threads(size_t requested) {
+    return requested > 0 ? requested : std::max(1u, std::thread::hardware_concurrency());
+}
+
+} // namespace
+
+UncertaintyEngine::UncertaintyEngine(const Options& options)
+    : options_(options), pool_(resolve_threads(options.worker_threads)) {
+    options_.min_samples = std::max<size_t>(options_.min_samples, 2);
+    options_.max_samples = std::max(options_.max_samples, options_.min_samples);
+    options_.coverage = Utils::clamp(options_.coverage, 0.0, 1.0);
+    samples_ = std::clamp(options_.samples, options_.min_samples, options_.max_samples);
+    outcomes_.resize(options_.max_samples);
+    sorted_.reserve(options_.max_samples);
+}
+
+template <typename Policy>
+RateInterval UncertaintyEngine::evaluate(const Telemetry& measurement, const PatientProfile& profile,
+                                         const PolicyStateEstimator<Policy>& estimator,
+                                         const BasicAdaptiveController<Policy>& controller,
+                                         const BasicSafetyMonitor<Policy>& safety, double current_infusion_rate,
+                                         double dt_minutes) {
+    RateInterval result = run<Policy>(samples_, measurement, profile, estimator, controller, safety,
+                              current_infusion_rate, dt_minutes);
+
+    double cost = static_cast<double>(result.elapsed.count()) / static_cast<double>(result.samples);
+    ns_per_sample_ = ns_per_sample_ == 0.0 ? cost : ns_per_sample_ + kCostSmoothing * (cost - ns_per_sample_);
+    if (options_.budget.count() > 0 && ns_per_sample_ > 0.0) {
+        double budget_ns =
+            std::chrono::duration<double, std::nano>(options_.budget).count() * kBudgetHeadroom;
+        double fit = std::floor(budget_ns / ns_per_sample_);
+        samples_ = std::clamp(static_cast<size_t>(std::min(fit, static_cast<double>(options_.max_samples))),
+                              options_.min_samples, options_.max_samples);
+    }
+    return result;
+}
+
+template <typename Policy>
+RateInterval UncertaintyEngine::run(size_t samples, const Telemetry& measurement,
+                                    const PatientProfile& profile, const PolicyStateEstimator<Policy>& estimator,
+                                    const BasicAdaptiveController<Policy>& controller,
+                                    const BasicSafetyMonitor<Policy>& safety,
+                                    double current_infusion_rate, double dt_minutes) {
+    auto start = Clock::now();
+    const std::uint64_t evaluation = ++evaluations_;
+    const std::uint64_t base_seed = options_.seed ^ (evaluation * 0xd1b54a32d192ed03ULL);
+    samples = std::clamp(samples, options_.min_samples, options_.max_samples);
+
+    size_t chunks = std::min(samples, pool_.thread_count() * kChunksPerWorker);
+    size_t chunk_size = (samples + chunks - 1) / chunks;
+    for (size_t begin = 0; begin < samples; begin += chunk_size) {
+        size_t end = std::min(samples, begin + chunk_size);
+        pool_.submit([&, begin, end] {
+            BasicSafetyMonitor<Policy> monitor = safety;   // evaluate() only reads it
+            for (size_t i = begin; i < end; ++i) {
+                std::uint64_t seed = base_seed + i;
+                SampleNoise rng(splitmix64(seed));
+                Decision d = decide_once<Policy>(perturb(measurement, options_.noise, rng), profile, estimator,
+                                         controller, monitor, current_infusion_rate, dt_minutes);
+                outcomes_[i] = {d.command.infusion_ml_per_min, d.fallback,
+                                d.command.rationale.safety_limited, d.command.rationale.predictive_boost};
+            }
+        });
+    }
+    BasicSafetyMonitor<Policy> monitor = safety;
+    Decision nominal = decide_once<Policy>(measurement, profile, estimator, controller, monitor,
+                                   current_infusion_rate, dt_minutes);
+    pool_.wait_idle();
+
+    RateInterval r;
+    r.samples = samples;
+    r.coverage = options_.coverage;
+    r.nominal = nominal.command.infusion_ml_per_min;
+    sorted_.clear();
+    double sum = 0.0;
+    size_t fallback = 0, limited = 0, boosted = 0;
+    for (size_t i = 0; i < samples; ++i) {
+        const Outcome& o = outcomes_[i];
+        sorted_.push_back(o.rate);
+        sum += o.rate;
+        fallback += o.fallback;
+        limited += o.safety_limited;
+        boosted += o.predictive_boost;
+    }
+    double n = static_cast<double>(samples);
+    r.mean = sum / n;
+    double sq = 0.0;
+    for (double rate : sorted_) sq += (rate - r.mean) * (rate - r.mean);
+    r.sd = std::sqrt(sq / (n - 1.0));
+    std::sort(sorted_.begin(), sorted_.end());
+    double tail = (1.0 - options_.coverage) / 2.0;
+    r.lower = quantile(sorted_, tail);
+    r.median = quantile(sorted_, 0.5);
+    r.upper = quantile(sorted_, 1.0 - tail);
+    r.fallback_fraction = static_cast<double>(fallback) / n;
+    r.safety_limited_fraction = static_cast<double>(limited) / n;
+    r.predictive_boost_fraction = static_cast<double>(boosted) / n;
+    r.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+    latency_.record(r.elapsed);
+    return r;
+}
+
+template <typename Policy>
+std::vector<UncertaintyEngine::LatencyPoint> UncertaintyEngine::profile_latency(
+    const std::vector<size_t>& sample_counts, int repeats, const Telemetry& measurement,
+    const PatientProfile& profile, const PolicyStateEstimator<Policy>& estimator,
+    const BasicAdaptiveController<Policy>& controller, const BasicSafetyMonitor<Policy>& safety,
+    double current_infusion_rate, double dt_minutes) {
+    std::vector<LatencyPoint> points;
+    repeats = std::max(repeats, 1);
+    std::vector<std::chrono::nanoseconds> times(static_cast<size_t>(repeats));
+    for (size_t count : sample_counts) {
+        LatencyPoint p;
+        p.samples = std::clamp(count, options_.min_samples, options_.max_samples);
+        for (auto& t : times) {
+            t = run<Policy>(p.samples, measurement, profile, estimator, controller, safety,
+                    current_infusion_rate, dt_minutes).elapsed;
+        }
+        std::sort(times.begin(), times.end());
+        p.median = times[times.size() / 2];
+        p.max = times.back();
+        points.push_back(p);
+    }
+    return points;
+}
+
+#define IVSYS_INSTANTIATE_UNCERTAINTY(Policy)                                                          \
+    template RateInterval UncertaintyEngine::evaluate<Policy>(                                         \
+        const Telemetry&, const PatientProfile&, const PolicyStateEstimator<Policy>&,                  \
+        const BasicAdaptiveController<Policy>&, const BasicSafetyMonitor<Policy>&, double, double);   \
+    template std::vector<UncertaintyEngine::LatencyPoint> UncertaintyEngine::profile_latency<Policy>( \
+        const std::vector<size_t>&, int, const Telemetry&, const PatientProfile&,                      \
+        const PolicyStateEstimator<Policy>&, const BasicAdaptiveController<Policy>&,                   \
+        const BasicSafetyMonitor<Policy>&, double, double);
+
+IVSYS_INSTANTIATE_UNCERTAINTY(TunedPolicy)
+IVSYS_INSTANTIATE_UNCERTAINTY(StandardPolicy)
+IVSYS_INSTANTIATE_UNCERTAINTY(CardiacPolicy)
+IVSYS_INSTANTIATE_UNCERTAINTY(RenalPolicy)
+IVSYS_INSTANTIATE_UNCERTAINTY(PediatricPolicy)
+
+#undef IVSYS_INSTANTIATE_UNCERTAINTY
+
+size_t UncertaintyEngine::largest_within(const std::vector<LatencyPoint>& points,
+                                         std::chrono::nanoseconds budget) {
+    size_t best = 0;
+    for (const LatencyPoint& p : points) {
+        if (p.max <= budget) best = std::max(best, p.samples);
+    }
+    return best;
+}
+
+} // namespace ivsys
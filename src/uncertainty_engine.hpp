@@ -0,0 +1,158 @@
+#pragma once
+
+/*
+ * uncertainty_engine.hpp
+ *
+ * Monte Carlo confidence interval for one infusion decision.
+ *
+ * The tick's telemetry is perturbed by per-sensor Gaussian noise and every
+ * sample is pushed through the same path the tick takes: estimate ->
+ * precision spine -> decide (safety evaluation included), on copies of the
+ * patient's estimator, controller and safety monitor as they stood before
+ * the tick.  The spread of the resulting rates replaces the single
+ * `uncertainty` scalar and the spine's hard 0.8 cut with a distribution:
+ * interval, fraction of samples sent to the fallback floor, fraction rate
+ * limited by the safety monitor.
+ *
+ * Samples are dealt in chunks to a WorkStealingPool.  Sample i's noise
+ * depends only on (seed, evaluation, i) and rates land in a preallocated
+ * array, so a result does not depend on worker count or scheduling.
+ *
+ * Sample count vs latency: every evaluation records its wall time; with
+ * Options::budget set, the next evaluation's sample count is the largest
+ * the measured per-sample cost fits into budget * kBudgetHeadroom.
+ * profile_latency() measures a sweep of counts for choosing a fixed one.
+ *
+ * Advisory only: the controller does not read the interval.
+ */
+
+#include "iv_system_types.hpp"
+#include "AdaptiveController.hpp"
+#include "LatencyHistogram.hpp"
+#include "SafetyMonitor.hpp"
+#include "StateEstimator.hpp"
+#include "control_policy.hpp"
+#include "work_stealing_pool.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ivsys {
+
+// Standard deviation of each sensor's additive noise.  It is scaled by
+// 1 + quality_gain * (1 - signal_quality).  Perturbed readings are clamped
+// to their physical range; signal_quality itself is not perturbed.
+struct SensorNoiseModel {
+    double hydration_pct = 2.0;
+    double heart_rate_bpm = 3.0;
+    double temp_celsius = 0.1;
+    double spo2_pct = 1.0;
+    double lactate_mmol = 0.2;
+    double fatigue_idx = 0.03;
+    double anxiety_idx = 0.03;
+    double cardiac_output_L_min = 0.3;
+    double quality_gain = 1.0;
+};
+
+struct RateInterval {
+    size_t samples = 0;               // 0: not evaluated
+    double coverage = 0.0;            // of [lower, upper]
+    double nominal = 0.0;             // rate for the unperturbed telemetry
+    double mean = 0.0;
+    double sd = 0.0;
+    double lower = 0.0;
+    double median = 0.0;
+    double upper = 0.0;
+    double fallback_fraction = 0.0;        // samples routed to the fallback floor
+    double safety_limited_fraction = 0.0;  // samples capped by SafetyMonitor
+    double predictive_boost_fraction = 0.0;
+    std::chrono::nanoseconds elapsed{0};
+};
+
+class UncertaintyEngine {
+public:
+    // Share of the budget the adaptive sample count aims to use.
+    static constexpr double kBudgetHeadroom = 0.8;
+
+    struct Options {
+        size_t samples = 1024;          // fixed count, or the first adaptive one
+        size_t min_samples = 64;
+        size_t max_samples = 16384;
+        size_t worker_threads = 0;      // 0 = hardware concurrency
+        double coverage = 0.90;         // central interval
+        std::chrono::microseconds budget{0};   // > 0: adapt the sample count
+        std::uint64_t seed = 0x5eedf00dULL;
+        SensorNoiseModel noise;
+    };
+
+    struct LatencyPoint {
+        size_t samples = 0;
+        std::chrono::nanoseconds median{0};
+        std::chrono::nanoseconds max{0};
+    };
+
+    UncertaintyEngine() : UncertaintyEngine(Options{}) {}
+    explicit UncertaintyEngine(const Options& options);
+
+    UncertaintyEngine(const UncertaintyEngine&) = delete;
+    UncertaintyEngine& operator=(const UncertaintyEngine&) = delete;
+
+    // Blocks until every sample is done.  The arguments are only read, and
+    // must not change until it returns.  Not callable from a pool worker.
+    // Policy is TunedPolicy or a PatientClassPolicy (uncertainty_engine.cpp).
+    template <typename Policy>
+    RateInterval evaluate(const Telemetry& measurement, const PatientProfile& profile,
+                          const PolicyStateEstimator<Policy>& estimator,
+                          const BasicAdaptiveController<Policy>& controller,
+                          const BasicSafetyMonitor<Policy>& safety, double current_infusion_rate,
+                          double dt_minutes);
+
+    // Median and maximum wall time of `repeats` evaluations per count.
+    // Leaves the adaptive sample count as it was.
+    template <typename Policy>
+    std::vector<LatencyPoint> profile_latency(const std::vector<size_t>& sample_counts, int repeats,
+                                              const Telemetry& measurement, const PatientProfile& profile,
+                                              const PolicyStateEstimator<Policy>& estimator,
+                                              const BasicAdaptiveController<Policy>& controller,
+                                              const BasicSafetyMonitor<Policy>& safety,
+                                              double current_infusion_rate, double dt_minutes);
+    // Largest measured count whose maximum stays within budget; 0 if none.
+    static size_t largest_within(const std::vector<LatencyPoint>& points,
+                                 std::chrono::nanoseconds budget);
+
+    // Count the next evaluate() will use.
+    size_t sample_count() const { return samples_; }
+    // Smoothed wall time per sample over recent evaluations.
+    double ns_per_sample() const { return ns_per_sample_; }
+    LatencyHistogram::Snapshot latency() const { return latency_.snapshot(); }
+    size_t thread_count() const { return pool_.thread_count(); }
+    const Options& options() const { return options_; }
+
+private:
+    template <typename Policy>
+    RateInterval run(size_t samples, const Telemetry& measurement, const PatientProfile& profile,
+                     const PolicyStateEstimator<Policy>& estimator,
+                     const BasicAdaptiveController<Policy>& controller,
+                     const BasicSafetyMonitor<Policy>& safety, double current_infusion_rate,
+                     double dt_minutes);
+
+    Options options_;
+    WorkStealingPool pool_;
+    size_t samples_;
+    double ns_per_sample_ = 0.0;
+    std::uint64_t evaluations_ = 0;
+    LatencyHistogram latency_;
+
+    // Per-sample outcomes, indexed by sample
+    struct Outcome {
+        double rate;
+        bool fallback;
+        bool safety_limited;
+        bool predictive_boost;
+    };
+    std::vector<Outcome> outcomes_;
+    std::vector<double> sorted_;
+};
+
+} // namespace ivsys
@@ -0,0 +1,144 @@
+#include "whatif_engine.hpp"
+#include "work_stealing_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <thread>
+
+namespace ivsys {
+
+namespace {
+
+struct TunableField {
+    const char* key;
+    double config::ControlTuning::* field;
+};
+
+constexpr TunableField kTunableFields[] = {
+    {"max_rate_change_ml_min", &config::ControlTuning::max_rate_change_ml_min},
+    {"min_cardiac_reserve", &config::ControlTuning::min_cardiac_reserve},
+    {"high_risk_threshold", &config::ControlTuning::high_risk_threshold},
+    {"tachycardia_hr_multiplier", &config::ControlTuning::tachycardia_hr_multiplier},
+    {"volume_approach_fraction", &config::ControlTuning::volume_approach_fraction},
+    {"daily_volume_per_kg_ml", &config::ControlTuning::daily_volume_per_kg_ml},
+    {"volume_limit_rate_cap", &config::ControlTuning::volume_limit_rate_cap},
+    {"low_cardiac_rate_cap", &config::ControlTuning::low_cardiac_rate_cap},
+    {"high_risk_rate_cap", &config::ControlTuning::high_risk_rate_cap},
+    {"tachycardia_rate_cap", &config::ControlTuning::tachycardia_rate_cap},
+    {"base_rate_floor_ml_min", &config::ControlTuning::base_rate_floor_ml_min},
+    {"base_rate_gain", &config::ControlTuning::base_rate_gain},
+    {"hydration_urgency_weight", &config::ControlTuning::hydration_urgency_weight},
+    {"energy_need_weight", &config::ControlTuning::energy_need_weight},
+    {"predictive_boost_multiplier", &config::ControlTuning::predictive_boost_multiplier},
+    {"predictive_hydration_threshold", &config::ControlTuning::predictive_hydration_threshold},
+    {"cardiac_limit_threshold", &config::ControlTuning::cardiac_limit_threshold},
+    {"cardiac_scaling_base", &config::ControlTuning::cardiac_scaling_base},
+};
+
+} // namespace
+
+WhatIfEngine::WhatIfEngine() : WhatIfEngine(Options{}) {}
+
+WhatIfEngine::WhatIfEngine(const Options& options) : options_(options) {
+    if (options_.worker_threads == 0) {
+        options_.worker_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    options_.replay.resolve_energy_model();
+}
+
+bool WhatIfEngine::apply_override(config::ControlTuning& tuning, const std::string& key,
+                                  double value) {
+    for (const auto& t : kTunableFields) {
+        if (key == t.key) {
+            tuning.*(t.field) = value;
+            return true;
+        }
+    }
+    if (key == "prediction_horizon_min") {
+        tuning.prediction_horizon_min = static_cast<int>(value);
+        return true;
+    }
+    if (key == "neural_energy_proxy") {
+        tuning.neural_energy_proxy = value != 0.0;
+        return true;
+    }
+    return false;
+}
+
+std::vector<std::string> WhatIfEngine::tunable_keys() {
+    std::vector<std::string> keys;
+    for (const auto& t : kTunableFields) keys.push_back(t.key);
+    keys.push_back("prediction_horizon_min");
+    keys.push_back("neural_energy_proxy");
+    return keys;
+}
+
+WhatIfResult WhatIfEngine::run(const std::vector<WhatIfSession>& sessions,
+                               const std::vector<WhatIfConfig>& configs) const {
+    WhatIfResult result;
+    result.reports.assign(configs.size(), std::vector<ReplayReport>(sessions.size()));
+    result.session_errors.assign(sessions.size(), std::string());
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        WorkStealingPool pool(options_.worker_threads);
+        for (size_t s = 0; s < sessions.size(); ++s) {
+            pool.submit([this, s, &pool, &sessions, &configs, &result] {
+                std::shared_ptr<const DecodedSession> decoded;
+                try {
+                    decoded = std::make_shared<DecodedSession>(
+                        ReplayLogger::decode(sessions[s].info, options_.replay));
+                } catch (const std::exception& e) {
+                    result.session_errors[s] = e.what();
+                    return;
+                }
+                for (size_t c = 0; c < configs.size(); ++c) {
+                    pool.submit([this, s, c, decoded, &sessions, &configs, &result] {
+                        ReplayOptions options = options_.replay;
+                        options.tuning = configs[c].tuning;
+                        result.reports[c][s] = ReplayLogger::replay(
+                            *decoded, sessions[s].profile, options);
+                    });
+                }
+            });
+        }
+        pool.wait_idle();
+        result.steals = pool.steal_count();
+    }
+    result.wall_seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    for (size_t c = 0; c < configs.size(); ++c) {
+        WhatIfAggregate agg;
+        agg.config_name = configs[c].name;
+        double rate_weighted = 0.0, change_weighted = 0.0;
+        size_t change_ticks = 0;
+        for (size_t s = 0; s < sessions.size(); ++s) {
+            if (!result.session_errors[s].empty()) continue;
+            const ReplayReport& r = result.reports[c][s];
+            ++agg.sessions;
+            agg.ticks += r.ticks;
+            agg.safety_overrides += r.safety_overrides;
+            agg.rate_limited_ticks += r.rate_limited_ticks;
+            agg.total_volume_ml += r.total_volume_ml;
+            agg.max_abs_rate_change = std::max(agg.max_abs_rate_change, r.max_abs_rate_change);
+            rate_weighted += r.mean_rate_ml_min * static_cast<double>(r.ticks);
+            if (r.ticks > 1) {
+                change_weighted += r.mean_abs_rate_change * static_cast<double>(r.ticks - 1);
+                change_ticks += r.ticks - 1;
+            }
+        }
+        if (agg.sessions > 0) {
+            agg.mean_volume_per_session_ml = agg.total_volume_ml / static_cast<double>(agg.sessions);
+        }
+        if (agg.ticks > 0) agg.mean_rate_ml_min = rate_weighted / static_cast<double>(agg.ticks);
+        if (change_ticks > 0) {
+            agg.mean_abs_rate_change = change_weighted / static_cast<double>(change_ticks);
+        }
+        result.per_config.push_back(agg);
+    }
+    return result;
+}
+
+} // namespace ivsys
@@ -0,0 +1,82 @@
+#pragma once
+
+/*
+ * whatif_engine.hpp
+ *
+ * Replays many recorded sessions against several controller
+ * configurations at once and aggregates the outcomes per configuration.
+ *
+ * Each session is decoded once; its decode task then spawns one replay
+ * task per configuration onto the same worker, and idle workers steal
+ * them.  Reports land in a preallocated [config][session] grid and are
+ * aggregated in session order after the pool drains, so results do not
+ * depend on the worker count or on scheduling.
+ */
+
+#include "replay_logger.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ivsys {
+
+struct WhatIfConfig {
+    std::string name;
+    config::ControlTuning tuning;
+};
+
+struct WhatIfSession {
+    ReplaySessionInfo info;
+    PatientProfile profile;
+};
+
+struct WhatIfAggregate {
+    std::string config_name;
+    size_t sessions = 0;
+    size_t ticks = 0;
+    size_t safety_overrides = 0;
+    size_t rate_limited_ticks = 0;
+    double total_volume_ml = 0.0;
+    double mean_volume_per_session_ml = 0.0;
+    double mean_rate_ml_min = 0.0;        // tick-weighted across sessions
+    double mean_abs_rate_change = 0.0;    // tick-weighted across sessions
+    double max_abs_rate_change = 0.0;
+};
+
+struct WhatIfResult {
+    std::vector<WhatIfAggregate> per_config;
+    std::vector<std::vector<ReplayReport>> reports;   // [config][session]
+    std::vector<std::string> session_errors;          // empty string = decoded fine
+    double wall_seconds = 0.0;
+    std::uint64_t steals = 0;
+};
+
+class WhatIfEngine {
+public:
+    struct Options {
+        size_t worker_threads = 0;   // 0 = hardware concurrency
+        // dt, prefer_csv, mismatch tolerance and energy_model; tuning comes
+        // from each config.
+        ReplayOptions replay;
+    };
+
+    WhatIfEngine();
+    explicit WhatIfEngine(const Options& options);
+
+    // Sessions that fail to decode are reported in session_errors and left
+    // out of the aggregates.
+    WhatIfResult run(const std::vector<WhatIfSession>& sessions,
+                     const std::vector<WhatIfConfig>& configs) const;
+
+    // Set a ControlTuning field by name ("max_rate_change_ml_min", ...).
+    // Returns false for an unknown key.
+    static bool apply_override(config::ControlTuning& tuning, const std::string& key,
+                               double value);
+    static std::vector<std::string> tunable_keys();
+
+private:
+    Options options_;
+};
+
+} // namespace ivsys
@@ -0,0 +1,116 @@
+#include "work_stealing_pool.hpp"
+#include <algorithm>
+
+namespace ivsys {
+
+namespace {
+
+// Identifies the pool and deque owned by the current thread, if any.
+thread_local const WorkStealingPool* tls_pool = nullptr;
+thread_local size_t tls_index = 0;
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(size_t thread_count) {
+    thread_count = std::max<size_t>(thread_count, 1);
+    for (size_t i = 0; i < thread_count; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (size_t i = 0; i < thread_count; ++i) {
+        workers_.emplace_back(&WorkStealingPool::worker_loop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& w : workers_) {
+        if (w.joinable()) w.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task) {
+    size_t index = (tls_pool == this)
+        ? tls_index
+        : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+
+    // Count before publishing so queued_ never goes transiently negative;
+    // a worker that wakes early just retries until the push lands.
+    outstanding_.fetch_add(1);
+    queued_.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    {
+        // Taking the state lock orders this wake-up after a waiter's
+        // predicate check, so it cannot be lost.
+        std::lock_guard<std::mutex> lock(state_mutex_);
+    }
+    work_cv_.notify_one();
+}
+
+bool WorkStealingPool::pop_local(size_t index, Task& out) {
+    WorkerQueue& q = *queues_[index];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty()) return false;
+    out = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(size_t thief, Task& out) {
+    for (size_t k = 1; k < queues_.size(); ++k) {
+        WorkerQueue& q = *queues_[(thief + k) % queues_.size()];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) continue;
+        out = std::move(q.tasks.front());
+        q.tasks.pop_front();
+        steals_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::worker_loop(size_t index) {
+    tls_pool = this;
+    tls_index = index;
+
+    while (true) {
+        Task task;
+        if (pop_local(index, task) || steal(index, task)) {
+            queued_.fetch_sub(1);
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state_mutex_);
+                if (!first_error_) first_error_ = std::current_exception();
+            }
+            task = nullptr;
+            if (outstanding_.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(state_mutex_);
+                idle_cv_.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(state_mutex_);
+        work_cv_.wait(lock, [this] { return stopping_ || queued_.load() > 0; });
+        if (stopping_ && queued_.load() == 0) return;
+    }
+}
+
+void WorkStealingPool::wait_idle() {
+    std::unique_lock<std::mutex> lock(state_mutex_);
+    idle_cv_.wait(lock, [this] { return outstanding_.load() == 0; });
+    if (first_error_) {
+        std::exception_ptr error = first_error_;
+        first_error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace ivsys
@@ -0,0 +1,79 @@
+#pragma once
+
+/*
+ * work_stealing_pool.hpp
+ *
+ * Fixed-size thread pool with one task deque per worker.
+ *
+ * A worker pops its own deque from the back (most recently spawned task
+ * first, so related work stays cache-warm) and, when that is empty, steals
+ * from the front of the other workers' deques.  Tasks submitted from a
+ * worker thread go onto that worker's deque; tasks submitted from outside
+ * are dealt round-robin.
+ *
+ * Each deque is guarded by its own mutex: tasks here are coarse (whole
+ * session replays), so a lock-free Chase-Lev deque would not pay for
+ * itself.
+ *
+ * An exception escaping a task is captured; wait_idle() rethrows the first
+ * one after every outstanding task has finished.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ivsys {
+
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(size_t thread_count);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(Task task);
+
+    // Block until every submitted task, including tasks spawned by tasks,
+    // has finished.  Must not be called from a worker thread.
+    void wait_idle();
+
+    size_t thread_count() const { return workers_.size(); }
+    std::uint64_t steal_count() const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool pop_local(size_t index, Task& out);
+    bool steal(size_t thief, Task& out);
+    void worker_loop(size_t index);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::atomic<size_t> queued_{0};       // tasks sitting in a deque
+    std::atomic<size_t> outstanding_{0};  // submitted and not yet finished
+    std::atomic<size_t> next_queue_{0};
+    std::atomic<std::uint64_t> steals_{0};
+    bool stopping_ = false;               // guarded by state_mutex_
+
+    std::mutex state_mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    std::exception_ptr first_error_;      // guarded by state_mutex_
+};
+
+} // namespace ivsys
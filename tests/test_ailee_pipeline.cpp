@@ -0,0 +1,266 @@
+// AILEE staging pipeline: VitalSignalGenerator -> AileeDecisionEngine ->
+// SimulationMetricsObserver / FlowAdjustmentPlugin.  Replaces the global
+// operator new to count allocations, so it runs as its own executable.
+
+#include "../iv_logic/vital_signal_generator.hpp"
+#include "../iv_logic/ailee_decision_engine.hpp"
+#include "../iv_extensions/simulation_metrics_observer.hpp"
+#include "../iv_extensions/flow_adjustment_plugin.hpp"
+#include "test_support.hpp"
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::atomic<long> g_allocations{0};
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+using namespace ivsys;
+using namespace ivsys::extensions;
+
+static bool near(double a, double b) { return std::abs(a - b) < 1e-12; }
+
+static Telemetry vitals(double hr, double signal_quality) {
+    Telemetry m;
+    m.heart_rate_bpm = hr;
+    m.spo2_pct = 97.0;
+    m.temp_celsius = 37.0;
+    m.hydration_pct = 90.0;
+    m.lactate_mmol = 1.0;
+    m.signal_quality = signal_quality;
+    return m;
+}
+
+static SignalFrame uniform_frame(double hr, double bp, double confidence) {
+    SignalFrame frame;
+    for (size_t i = 0; i < kSignalCount; ++i) {
+        frame.signals[i].id = static_cast<SignalId>(i);
+        frame.signals[i].confidence = confidence;
+    }
+    frame[SignalId::HeartRate].value = hr;
+    frame[SignalId::BloodPressure].value = bp;
+    return frame;
+}
+
+void test_signal_frame_slots() {
+    const char* name = "test_signal_frame_slots";
+    VitalSignalGenerator generator;
+    SignalFrame frame;
+    generator.generate_signals(vitals(80.0, 0.9), frame);
+
+    const ModelSignal& hr = frame[SignalId::HeartRate];
+    if (hr.id != SignalId::HeartRate || hr.value != 80.0 || !near(hr.confidence, 0.9) ||
+        hr.degradation != DegradationReason::Stable || std::strcmp(hr.model_id(), "hr_monitor_v1") != 0) {
+        fail(name, "heart rate slot");
+    }
+    // 120 + (80 - 70) * 0.5 - (100 - 90) * 0.2
+    if (!near(frame[SignalId::BloodPressure].value, 123.0) ||
+        std::strcmp(frame[SignalId::BloodPressure].model_id(), "nibp_monitor_v1") != 0) {
+        fail(name, "blood pressure slot");
+    }
+    const ModelSignal& rr = frame[SignalId::RespiratoryRate];
+    if (!near(rr.value, 18.5) || !near(rr.confidence, 0.9 * 0.85) ||
+        std::strcmp(rr.degradation_reason(), "Derived Stable") != 0) {
+        fail(name, "respiratory rate slot");
+    }
+
+    // A 30 bpm jump costs the full 0.5 stability penalty
+    generator.generate_signals(vitals(110.0, 0.9), frame);
+    if (!near(frame[SignalId::HeartRate].confidence, 0.4) ||
+        std::strcmp(frame[SignalId::HeartRate].degradation_reason(), "High Volatility") != 0) {
+        fail(name, "volatility degradation");
+    }
+    std::cout << name << " passed\n";
+}
+
+void test_decision_verdicts() {
+    const char* name = "test_decision_verdicts";
+    AileeDecisionEngine engine;
+
+    AileeDecision d = engine.process_signals(uniform_frame(120.0, 85.0, 0.9));
+    if (d.verdict != AileeVerdict::ACCEPTED || d.action != DecisionAction::INCREASE_FLOW || d.used_fallback ||
+        std::strcmp(d.reasoning(), "[AILEE: ACCEPTED] High aggregate confidence. Consensus reached.") != 0) {
+        fail(name, "accepted");
+    }
+    if (d.contributing_count() != kSignalCount) fail(name, "contributing count");
+
+    SignalFrame borderline = uniform_frame(120.0, 85.0, 0.7);
+    d = engine.process_signals(borderline);
+    if (d.verdict != AileeVerdict::GRACE_FAILED || d.action != DecisionAction::FALLBACK_FLOW || !d.used_fallback ||
+        std::strcmp(d.reasoning(), "[AILEE: GRACE FAILED] Borderline confidence. Unsafe to apply INCREASE. "
+                                   "Triggering FALLBACK.") != 0) {
+        fail(name, "grace failed");
+    }
+    std::vector<std::string> described = describe_contributing_signals(d, borderline);
+    if (described.size() != kSignalCount || described[0] != "hr_monitor_v1 (conf: 0.700000)") {
+        fail(name, "contributing text");
+    }
+
+    d = engine.process_signals(uniform_frame(80.0, 150.0, 0.7));
+    if (d.verdict != AileeVerdict::GRACE_FAILED || std::strstr(d.reasoning(), "DECREASE") == nullptr) {
+        fail(name, "grace failed decrease");
+    }
+    d = engine.process_signals(uniform_frame(80.0, 120.0, 0.7));
+    if (d.verdict != AileeVerdict::GRACE || d.action != DecisionAction::MAINTAIN_FLOW) fail(name, "grace");
+    d = engine.process_signals(uniform_frame(80.0, 120.0, 0.3));
+    if (d.verdict != AileeVerdict::REJECTED || d.action != DecisionAction::FALLBACK_FLOW) fail(name, "rejected");
+    std::cout << name << " passed\n";
+}
+
+void test_observer_and_plugin() {
+    const char* name = "test_observer_and_plugin";
+    SimulationMetricsObserver observer;
+    SignalFrame a = uniform_frame(80.0, 120.0, 0.9);
+    SignalFrame b = uniform_frame(90.0, 125.0, 0.9);
+    observer.observe_signals(a);
+    observer.observe_signals(b);
+    // Second frame moves HR by 10 and BP by 5 across 5 slots: mean 3, over 2 observations
+    if (observer.get_metrics()["vital_signal_volatility"] != std::to_string(1.5)) fail(name, "volatility");
+
+    FlowAdjustmentPlugin plugin;
+    AileeDecisionEngine engine;
+    AileeDecision d = engine.process_signals(uniform_frame(80.0, 120.0, 0.3));
+    ControlOutput control;
+    control.infusion_ml_per_min = 0.8;
+    plugin.apply_decision(d, control);
+    if (!control.safety_override || control.rationale.code != RationaleCode::Custom ||
+        control.rationale.text != d.reasoning() || !near(control.infusion_ml_per_min, config::MIN_INFUSION_RATE_ML_MIN)) {
+        fail(name, "plugin fallback");
+    }
+    if (plugin.get_latest_log().find("Sigs=5") == std::string::npos) fail(name, "plugin log");
+    std::cout << name << " passed\n";
+}
+
+void test_sharded_observer_aggregates() {
+    const char* name = "test_sharded_observer_aggregates";
+    const int kThreads = 4, kDecisions = 5000;
+    SimulationMetricsObserver observer;
+    AileeDecision fallback, increase;
+    fallback.action = DecisionAction::FALLBACK_FLOW;
+    fallback.aggregate_confidence = 0.5;
+    increase.action = DecisionAction::INCREASE_FLOW;
+    increase.aggregate_confidence = 0.5;
+
+    // Half the threads own a Recorder, half go through the per-thread shard
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            SimulationMetricsObserver::Recorder recorder = observer.make_recorder();
+            SignalFrame frame = uniform_frame(80.0, 120.0, 0.9);
+            for (int i = 0; i < kDecisions; ++i) {
+                const AileeDecision& d = (i % 4 == 0) ? fallback : increase;
+                frame[SignalId::HeartRate].value = 80.0 + (i % 2) * 5.0;
+                if (t % 2 == 0) {
+                    recorder.observe_decision(d, 0.02);
+                    recorder.observe_signals(frame);
+                } else {
+                    observer.observe_decision(d, 0.02);
+                    observer.observe_signals(frame);
+                }
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    SimulationMetricsObserver::Metrics m = observer.snapshot();
+    const std::uint64_t total = static_cast<std::uint64_t>(kThreads) * kDecisions;
+    // One made Recorder per thread, plus a thread shard for each convenience-path thread
+    if (m.shards != static_cast<size_t>(kThreads + kThreads / 2)) fail(name, "shard count " + std::to_string(m.shards));
+    if (m.decisions != total || m.fallbacks != total / 4 || m.total_adjustments != total * 3 / 4 ||
+        m.signal_observations != total) {
+        fail(name, "counters");
+    }
+    if (!near(m.fallback_frequency, 0.25) || std::abs(m.average_confidence - 0.5) > 1e-9 ||
+        std::abs(m.average_decision_latency_ms - 0.02) > 1e-9) {
+        fail(name, "averages");
+    }
+    // Every stream saw one 0.5 jump from the 1.0 prior then held steady
+    if (m.stability_score < 99.9 || m.stability_score > 100.0) fail(name, "stability " + std::to_string(m.stability_score));
+    // HR alternates by 5 in one of 5 slots after each stream's first frame
+    double expected_volatility = 1.0 * (kDecisions - 1) / kDecisions;
+    if (std::abs(m.vital_signal_volatility - expected_volatility) > 1e-9) fail(name, "volatility");
+    if (observer.get_metrics()["total_adjustments"] != std::to_string(total * 3 / 4)) fail(name, "metrics text");
+    std::cout << name << " passed\n";
+}
+
+void test_plugin_instances_are_independent() {
+    const char* name = "test_plugin_instances_are_independent";
+    AileeDecisionEngine engine;
+    AileeDecision increase = engine.process_signals(uniform_frame(120.0, 85.0, 0.9));
+    AileeDecision rejected = engine.process_signals(uniform_frame(80.0, 120.0, 0.3));
+
+    FlowAdjustmentPlugin warm, cold;
+    if (!cold.get_latest_log().empty() || cold.latest().valid) fail(name, "log before first decision");
+
+    ControlOutput control;
+    control.infusion_ml_per_min = 1.0;
+    for (int i = 0; i < 50; ++i) warm.apply_decision(increase, control);
+
+    ControlOutput warm_fallback, cold_fallback;
+    warm.apply_decision(rejected, warm_fallback);
+    cold.apply_decision(rejected, cold_fallback);
+    if (!near(cold_fallback.infusion_ml_per_min, config::MIN_INFUSION_RATE_ML_MIN)) fail(name, "cold fallback");
+    if (warm_fallback.infusion_ml_per_min <= 1.0) fail(name, "warm fallback ignores its history");
+
+    FlowAdjustmentRecord r = warm.latest();
+    if (!r.valid || r.action != DecisionAction::FALLBACK_FLOW || !r.fallback_active ||
+        !near(r.rate_ml_min, warm_fallback.infusion_ml_per_min) || r.signal_count != kSignalCount) {
+        fail(name, "latest record");
+    }
+    std::string log = warm.get_latest_log();
+    if (log.find("] FLOW_PLUGIN: Action=FALLBACK (Rate set to rolling mean: ") == std::string::npos ||
+        log.find("| FallbackActive=TRUE | Sigs=5") == std::string::npos || log[0] != '[' || log[24] != 'Z') {
+        fail(name, "log text: " + log);
+    }
+    std::cout << name << " passed\n";
+}
+
+void test_steady_state_pipeline_does_not_allocate() {
+    const char* name = "test_steady_state_pipeline_does_not_allocate";
+    VitalSignalGenerator generator;
+    AileeDecisionEngine engine;
+    SimulationMetricsObserver observer;
+    SimulationMetricsObserver::Recorder recorder = observer.make_recorder();
+    FlowAdjustmentPlugin plugin;
+    SignalFrame frame;
+    AileeDecision decision;
+    ControlOutput control;
+
+    generator.generate_signals(vitals(80.0, 0.9), frame);
+    observer.observe_signals(frame);   // makes this thread's shard
+    long before = g_allocations.load();
+    for (int i = 0; i < 1000; ++i) {
+        generator.generate_signals(vitals(80.0 + (i % 40), (i % 3) ? 0.9 : 0.5), frame);
+        engine.process_signals(frame, decision);
+        observer.observe_signals(frame);
+        observer.observe_decision(decision, 0.01);
+        recorder.observe_signals(frame);
+        recorder.observe_decision(decision, 0.01);
+        plugin.apply_decision(decision, control);
+    }
+    long allocations = g_allocations.load() - before;
+    if (allocations != 0) fail(name, std::to_string(allocations) + " allocations in 1000 ticks");
+    std::cout << name << " passed\n";
+}
+
+int main() {
+    test_signal_frame_slots();
+    test_decision_verdicts();
+    test_observer_and_plugin();
+    test_sharded_observer_aggregates();
+    test_plugin_instances_are_independent();
+    test_steady_state_pipeline_does_not_allocate();
+    return 0;
+}
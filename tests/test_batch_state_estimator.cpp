@@ -0,0 +1,101 @@
+#include "../src/BatchStateEstimator.hpp"
+#include "../src/StateEstimator.hpp"
+#include <iostream>
+#include <cmath>
+#include <random>
+
+using namespace ivsys;
+
+static Telemetry random_telemetry(std::mt19937& rng) {
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    Telemetry m;
+    m.hydration_pct = 30.0 + 70.0 * u(rng);
+    m.heart_rate_bpm = 30.0 + 170.0 * u(rng);
+    m.temp_celsius = 34.0 + 7.0 * u(rng);
+    m.blood_loss_idx = u(rng);
+    m.fatigue_idx = u(rng);
+    m.anxiety_idx = u(rng);
+    m.signal_quality = u(rng);
+    m.spo2_pct = 80.0 + 20.0 * u(rng);
+    m.lactate_mmol = 12.0 * u(rng);
+    m.cardiac_output_L_min = 5.0;
+    return m;
+}
+
+static double max_deviation(const PatientState& a, const PatientState& b) {
+    double d = 0.0;
+    d = std::max(d, std::abs(a.hydration_pct - b.hydration_pct));
+    d = std::max(d, std::abs(a.heart_rate_bpm - b.heart_rate_bpm));
+    d = std::max(d, std::abs(a.coherence_sigma - b.coherence_sigma));
+    d = std::max(d, std::abs(a.energy_T - b.energy_T));
+    d = std::max(d, std::abs(a.metabolic_load - b.metabolic_load));
+    d = std::max(d, std::abs(a.cardiac_reserve - b.cardiac_reserve));
+    d = std::max(d, std::abs(a.risk_score - b.risk_score));
+    d = std::max(d, std::abs(a.uncertainty - b.uncertainty));
+    return d;
+}
+
+void test_fleet_matches_scalar() {
+    std::mt19937 rng(42);
+    PatientProfile profile;
+    profile.weight_kg = 70.0;
+    profile.age_years = 55.0;
+
+    TelemetryBatch batch;
+    std::vector<Telemetry> rows;
+    for (int i = 0; i < 2000; ++i) {
+        rows.push_back(random_telemetry(rng));
+        batch.push_back(rows.back(), profile.age_years);
+    }
+
+    StateBatch out;
+    BatchStateEstimator::estimate(batch, BatchLayout::Fleet, out);
+
+    for (size_t i = 0; i < rows.size(); ++i) {
+        StateEstimator fresh;
+        PatientState ref = fresh.estimate(rows[i], profile, 1.0);
+        double dev = max_deviation(ref, out.row(i));
+        if (dev > BatchStateEstimator::SCALAR_TOLERANCE) {
+            std::cerr << "test_fleet_matches_scalar failed: row " << i << " deviates by " << dev << "\n";
+            exit(1);
+        }
+    }
+
+    std::cout << "test_fleet_matches_scalar passed\n";
+}
+
+void test_series_matches_scalar() {
+    std::mt19937 rng(7);
+    PatientProfile profile;
+    profile.weight_kg = 70.0;
+    profile.age_years = 35.0;
+
+    // 120 ticks exercises the HR variance window and the 50-deep history cap.
+    TelemetryBatch batch;
+    std::vector<Telemetry> rows;
+    for (int i = 0; i < 120; ++i) {
+        rows.push_back(random_telemetry(rng));
+        batch.push_back(rows.back(), profile.age_years);
+    }
+
+    StateBatch out;
+    BatchStateEstimator::estimate(batch, BatchLayout::Series, out);
+
+    StateEstimator estimator;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        PatientState ref = estimator.estimate(rows[i], profile, 1.0);
+        double dev = max_deviation(ref, out.row(i));
+        if (dev > BatchStateEstimator::SCALAR_TOLERANCE) {
+            std::cerr << "test_series_matches_scalar failed: tick " << i << " deviates by " << dev << "\n";
+            exit(1);
+        }
+    }
+
+    std::cout << "test_series_matches_scalar passed\n";
+}
+
+int main() {
+    test_fleet_matches_scalar();
+    test_series_matches_scalar();
+    return 0;
+}
@@ -0,0 +1,323 @@
+#include "../src/cluster_replication.hpp"
+#include "../src/multi_patient_engine.hpp"
+#include "../src/simulation_engine.hpp"
+#include "test_support.hpp"
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <set>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace ivsys;
+using namespace ivsys::replication;
+
+// A hemorrhage a few minutes in keeps the controller and safety monitor busy.
+static SimulationEngine make_sim() {
+    SimulationEngine sim(make_profile(), 7);
+    sim.add_event({ScenarioKind::Hemorrhage, 60.0, 240.0, 0.8});
+    return sim;
+}
+
+static const double kDt = 0.2;
+
+// Steps both cycles through the same telemetry and requires identical decisions.
+static void run_in_lockstep(const char* name, PatientControlCycle& a, PatientControlCycle& b,
+                            const SimulationEngine& sim, int from_tick, int ticks) {
+    for (int i = from_tick; i < from_tick + ticks; ++i) {
+        Telemetry m = sim.generate_telemetry(i * kDt);
+        CycleResult ra = a.step(m, kDt);
+        CycleResult rb = b.step(m, kDt);
+        if (ra.command.infusion_ml_per_min != rb.command.infusion_ml_per_min ||
+            ra.command.confidence != rb.command.confidence ||
+            ra.command.warning_flags != rb.command.warning_flags ||
+            ra.state.energy_T != rb.state.energy_T || ra.state.risk_score != rb.state.risk_score) {
+            fail(name, "decisions diverge at tick " + std::to_string(i));
+        }
+    }
+    if (a.safety().get_cumulative_volume() != b.safety().get_cumulative_volume() || a.ticks() != b.ticks()) {
+        fail(name, "cumulative volume or tick count diverge");
+    }
+}
+
+void test_full_checkpoint_round_trip() {
+    const char* name = "test_full_checkpoint_round_trip";
+    SimulationEngine sim = make_sim();
+    PatientControlCycle primary(make_profile(), "cluster_rt_primary");
+    for (int i = 0; i < 400; ++i) primary.step(sim.generate_telemetry(i * kDt), kDt);
+
+    std::vector<std::uint8_t> bytes;
+    CheckpointWriter out(bytes);
+    primary.save_checkpoint(out, true);
+
+    PatientControlCycle standby(make_profile(), "cluster_rt_standby");
+    CheckpointReader in(bytes.data(), bytes.size());
+    if (!standby.restore_checkpoint(in, true) || !in.at_end()) fail(name, "restore");
+    run_in_lockstep(name, primary, standby, sim, 400, 600);
+
+    CheckpointReader truncated(bytes.data(), bytes.size() / 2);
+    PatientControlCycle other(make_profile(), "cluster_rt_other");
+    if (other.restore_checkpoint(truncated, true)) fail(name, "truncated checkpoint accepted");
+
+    std::cout << name << " passed\n";
+}
+
+void test_promoted_standby_resumes_identically() {
+    const char* name = "test_promoted_standby_resumes_identically";
+    SimulationEngine sim = make_sim();
+    ReplicaStore store;
+    LocalReplicaSink sink(store);
+    CheckpointPublisher::Options options;
+    options.keyframe_interval = 25;
+    CheckpointPublisher publisher("cluster_promote", &sink, options);
+
+    // Reference cycle never fails; the primary "dies" after tick 537.
+    PatientControlCycle reference(make_profile(), "cluster_promote_ref", LoggerMode::Sync,
+                                  SessionFormat::Csv, nullptr, PatientClass::Cardiac);
+    PatientControlCycle primary(make_profile(), "cluster_promote", LoggerMode::Sync,
+                                SessionFormat::Csv, nullptr, PatientClass::Cardiac);
+    const int failed_at = 537;
+    for (int i = 0; i < failed_at; ++i) {
+        Telemetry m = sim.generate_telemetry(i * kDt);
+        reference.step(m, kDt);
+        primary.step(m, kDt);
+        if (!publisher.publish(primary, m.timestamp)) fail(name, "frame refused at tick " + std::to_string(i));
+    }
+
+    PublisherStats s = publisher.stats();
+    if (s.frames != static_cast<std::uint64_t>(failed_at) || s.full_frames != 22 || s.rejected != 0) {
+        fail(name, "frames " + std::to_string(s.frames) + " full " + std::to_string(s.full_frames));
+    }
+    // Replication cost per tick is fixed: ~0.5 KB deltas, ~10 KB keyframes.
+    if (s.max_delta_bytes > 1024 || s.max_full_bytes > 16 * 1024 || s.max_full_bytes < s.max_delta_bytes) {
+        fail(name, "frame sizes delta " + std::to_string(s.max_delta_bytes) + " full " +
+                       std::to_string(s.max_full_bytes));
+    }
+
+    ReplicaInfo info;
+    if (!store.info(publisher.key(), info) || info.session_id != "cluster_promote" ||
+        info.patient_class != PatientClass::Cardiac || info.deltas != 11 || !info.in_sync) {
+        fail(name, "replica info");
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<PatientControlCycle> promoted = store.promote(publisher.key());
+    double promote_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (promote_ms > config::CONTROL_PERIOD_SEC * 1000.0) {
+        fail(name, "promotion took " + std::to_string(promote_ms) + " ms");
+    }
+    if (store.contains(publisher.key()) || promoted->patient_class() != PatientClass::Cardiac) {
+        fail(name, "promotion bookkeeping");
+    }
+    run_in_lockstep(name, reference, *promoted, sim, failed_at, 800);
+
+    std::cout << name << " passed (delta " << s.max_delta_bytes << " B, full " << s.max_full_bytes
+              << " B, encode mean " << s.encode.mean_us() << " us, promote " << promote_ms << " ms)\n";
+}
+
+// Loses frames without telling the publisher, like a lossy link.
+class LossySink : public ReplicationSink {
+public:
+    LossySink(ReplicationSink& next, std::set<int> drop) : next_(next), drop_(std::move(drop)) {}
+    bool publish(const std::uint8_t* frame, size_t size) override {
+        return drop_.count(frame_++) ? true : next_.publish(frame, size);
+    }
+
+private:
+    ReplicationSink& next_;
+    std::set<int> drop_;
+    int frame_ = 0;
+};
+
+void test_gap_forces_full_resync() {
+    const char* name = "test_gap_forces_full_resync";
+    SimulationEngine sim = make_sim();
+    ReplicaStore store;
+    LocalReplicaSink local(store);
+    LossySink lossy(local, {5});
+    CheckpointPublisher publisher("cluster_gap", &lossy);
+    PatientControlCycle primary(make_profile(), "cluster_gap");
+    PatientControlCycle reference(make_profile(), "cluster_gap_ref");
+
+    ReplicaInfo info;
+    for (int i = 0; i < 8; ++i) {
+        Telemetry m = sim.generate_telemetry(i * kDt);
+        primary.step(m, kDt);
+        reference.step(m, kDt);
+        bool accepted = publisher.publish(primary, m.timestamp);
+        store.info(publisher.key(), info);
+        if (i == 6 && (accepted || info.in_sync)) fail(name, "gap not detected");
+        if (i == 6) {
+            // Resuming now would lose ticks 5 and 6 and their infused volume
+            bool refused = false;
+            try {
+                store.promote(publisher.key());
+            } catch (const std::runtime_error&) {
+                refused = true;
+            }
+            if (!refused || !store.contains(publisher.key())) fail(name, "stale replica promoted");
+        }
+        if (i == 7 && (!accepted || !info.in_sync || info.deltas != 0)) fail(name, "no full resync after the gap");
+    }
+    if (publisher.stats().full_frames != 2 || publisher.stats().rejected != 1) fail(name, "publisher counters");
+    auto promoted = store.promote(publisher.key());
+    run_in_lockstep(name, reference, *promoted, sim, 8, 300);
+
+    std::cout << name << " passed\n";
+}
+
+void test_corrupt_frames_rejected() {
+    const char* name = "test_corrupt_frames_rejected";
+    SimulationEngine sim = make_sim();
+    std::vector<std::vector<std::uint8_t>> frames;
+    struct Capture : ReplicationSink {
+        std::vector<std::vector<std::uint8_t>>* out;
+        bool publish(const std::uint8_t* frame, size_t size) override {
+            out->emplace_back(frame, frame + size);
+            return true;
+        }
+    } capture;
+    capture.out = &frames;
+    CheckpointPublisher publisher("cluster_corrupt", &capture);
+    PatientControlCycle primary(make_profile(), "cluster_corrupt");
+    for (int i = 0; i < 3; ++i) {
+        Telemetry m = sim.generate_telemetry(i * kDt);
+        primary.step(m, kDt);
+        publisher.publish(primary, m.timestamp);
+    }
+
+    ReplicaStore store;
+    if (store.apply(frames[1].data(), frames[1].size()) != ApplyStatus::NeedsFull) fail(name, "delta before full");
+    std::vector<std::uint8_t> flipped = frames[0];
+    flipped[flipped.size() / 2] ^= 0x40;
+    if (store.apply(flipped.data(), flipped.size()) != ApplyStatus::Corrupt ||
+        store.apply(frames[0].data(), frames[0].size() - 1) != ApplyStatus::Corrupt ||
+        store.apply(frames[0].data(), 10) != ApplyStatus::Corrupt || store.contains(publisher.key())) {
+        fail(name, "corrupt frame accepted");
+    }
+    if (store.apply(frames[0].data(), frames[0].size()) != ApplyStatus::Applied ||
+        store.apply(frames[1].data(), frames[1].size()) != ApplyStatus::Applied ||
+        store.apply(frames[1].data(), frames[1].size()) != ApplyStatus::Duplicate) {
+        fail(name, "valid frames");
+    }
+
+    std::cout << name << " passed\n";
+}
+
+void test_stream_transport() {
+    const char* name = "test_stream_transport";
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) fail(name, "socketpair");
+    ::fcntl(fds[0], F_SETFL, ::fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+
+    SimulationEngine sim = make_sim();
+    StreamReplicationSink sink(fds[0]);
+    CheckpointPublisher publisher("cluster_stream", &sink);
+    PatientControlCycle primary(make_profile(), "cluster_stream");
+    PatientControlCycle reference(make_profile(), "cluster_stream_ref");
+
+    // Line noise first; the decoder must find the first frame after it.
+    const char noise[] = "AIC\x41garbage";
+    if (::write(fds[0], noise, sizeof(noise)) != static_cast<ssize_t>(sizeof(noise))) fail(name, "write");
+
+    ReplicaStore store;
+    FrameStreamDecoder decoder;
+    size_t applied = 0;
+    std::uint8_t buf[7];   // deliberately tiny reads split every frame
+    const int ticks = 60;
+    for (int i = 0; i < ticks; ++i) {
+        Telemetry m = sim.generate_telemetry(i * kDt);
+        primary.step(m, kDt);
+        reference.step(m, kDt);
+        if (!publisher.publish(primary, m.timestamp)) fail(name, "send");
+        ssize_t n;
+        while ((n = ::recv(fds[1], buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+            applied += decoder.feed(buf, static_cast<size_t>(n), store);
+        }
+    }
+    ::close(fds[0]);
+    ::close(fds[1]);
+    if (applied != static_cast<size_t>(ticks)) fail(name, "applied " + std::to_string(applied) + " frames");
+    auto promoted = store.promote(publisher.key(), {"cluster_stream_takeover", LoggerMode::Sync, SessionFormat::Csv, nullptr});
+    run_in_lockstep(name, reference, *promoted, sim, ticks, 200);
+
+    std::cout << name << " passed\n";
+}
+
+void test_shard_map_failover_moves_only_failed_node() {
+    const char* name = "test_shard_map_failover_moves_only_failed_node";
+    ShardMap map(5);
+    std::vector<size_t> primaries(1000), standbys(1000), load(5, 0);
+    for (size_t i = 0; i < primaries.size(); ++i) {
+        std::uint64_t key = patient_key("bed" + std::to_string(i));
+        primaries[i] = map.primary(key);
+        standbys[i] = map.standby(key);
+        if (primaries[i] == standbys[i] || primaries[i] >= 5 || standbys[i] >= 5) fail(name, "placement");
+        ++load[primaries[i]];
+    }
+    for (size_t n : load) {
+        if (n < 120 || n > 280) fail(name, "unbalanced load " + std::to_string(n));
+    }
+
+    map.set_alive(2, false);
+    for (size_t i = 0; i < primaries.size(); ++i) {
+        std::uint64_t key = patient_key("bed" + std::to_string(i));
+        size_t now = map.primary(key);
+        if (primaries[i] == 2 ? now != standbys[i] : now != primaries[i]) {
+            fail(name, "patient " + std::to_string(i) + " moved needlessly");
+        }
+        if (map.standby(key) == 2 || map.standby(key) == now) fail(name, "standby on a dead node");
+    }
+
+    ShardMap single(1);
+    if (single.standby(1) != ShardMap::npos) fail(name, "standby with one node");
+
+    std::cout << name << " passed\n";
+}
+
+void test_engine_streams_every_tick() {
+    const char* name = "test_engine_streams_every_tick";
+    ReplicaStore store;
+    LocalReplicaSink sink(store);
+    MultiPatientEngine::Options options;
+    options.worker_threads = 2;
+    options.period = std::chrono::milliseconds(20);
+    options.timer_resolution = std::chrono::milliseconds(2);
+    options.replication = &sink;
+    MultiPatientEngine engine(options);
+    SimulationEngine sim = make_sim();
+    for (int i = 0; i < 4; ++i) {
+        engine.add_patient(make_profile(), "cluster_engine_bed" + std::to_string(i),
+                           [sim](double t) { return sim.generate_telemetry(t); });
+    }
+    engine.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    engine.stop();
+
+    for (const PatientTickStats& s : engine.all_stats()) {
+        if (s.ticks == 0 || s.replication_frames != s.ticks || s.replication_rejected != 0 ||
+            s.replication_full_frames == 0 || s.replication_bytes == 0 || s.max_replication_us <= 0.0) {
+            fail(name, s.session_id + " replicated " + std::to_string(s.replication_frames) + " of " +
+                           std::to_string(s.ticks) + " ticks");
+        }
+        ReplicaInfo info;
+        if (!store.info(patient_key(s.session_id), info) || info.sequence != s.ticks) {
+            fail(name, s.session_id + " replica behind");
+        }
+    }
+
+    std::cout << name << " passed\n";
+}
+
+int main() {
+    test_full_checkpoint_round_trip();
+    test_promoted_standby_resumes_identically();
+    test_gap_forces_full_resync();
+    test_corrupt_frames_rejected();
+    test_stream_transport();
+    test_shard_map_failover_moves_only_failed_node();
+    test_engine_streams_every_tick();
+    return 0;
+}
@@ -0,0 +1,229 @@
+// Patient-class control policies: the compile-time pipelines behind
+// PatientControlCycle against the run-time TunedPolicy components.
+
+#include "../src/control_cycle.hpp"
+#include "../src/control_policy.hpp"
+#include "../src/uncertainty_engine.hpp"
+#include "../src/precision_spine/PrecisionSpine.hpp"
+#include "test_support.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace ivsys;
+
+// The limits are compile-time constants
+static_assert(CardiacPolicy::limits().max_rate_change_ml_min == 0.2, "cardiac step limit");
+static_assert(!PediatricPolicy::limits().neural_energy_proxy, "pediatric energy proxy");
+static_assert(std::is_same<PediatricPolicy::Energy, RuleEnergy>::value, "pediatric strategy");
+static_assert(std::is_same<StandardPolicy::Energy, ModelEnergy>::value, "standard strategy");
+
+static PatientProfile test_profile() {
+    PatientProfile profile = make_profile();
+    profile.weight_kg = 40.0;
+    return profile;
+}
+
+// Swings through dehydration and tachycardia so every limit gets exercised
+static Telemetry telemetry(int tick) {
+    Telemetry m;
+    m.hydration_pct = 57.5 + 12.5 * std::sin(tick * 0.05);
+    m.heart_rate_bpm = 95.0 + 25.0 * std::sin(tick * 0.13);
+    m.temp_celsius = 37.2;
+    m.fatigue_idx = 0.4 + 0.3 * std::sin(tick * 0.07);
+    m.anxiety_idx = 0.2;
+    m.signal_quality = (tick % 17 == 0) ? 0.5 : 0.9;
+    m.spo2_pct = 95.0;
+    m.lactate_mmol = 2.2;
+    m.cardiac_output_L_min = 5.0;
+    return m;
+}
+
+// Returns a fixed E_T so the model strategy is visible in the estimate
+class ConstantEnergyProxy : public EnergyProxyModel {
+public:
+    const char* name() const override { return "constant"; }
+    double energy_proxy(const Telemetry&) const override { return 0.123; }
+};
+
+void test_class_tuning_and_selection() {
+    const char* name = "test_class_tuning_and_selection";
+    config::ControlTuning defaults;
+    const config::ControlTuning& standard = StandardPolicy::limits();
+    if (standard.max_rate_change_ml_min != defaults.max_rate_change_ml_min ||
+        standard.base_rate_gain != defaults.base_rate_gain ||
+        standard.volume_approach_fraction != defaults.volume_approach_fraction ||
+        standard.neural_energy_proxy != defaults.neural_energy_proxy) {
+        fail(name, "standard class must be the config_defaults.hpp tuning");
+    }
+
+    for (PatientClass c : kPatientClasses) {
+        PatientClass parsed = PatientClass::Standard;
+        if (!parse_patient_class(patient_class_name(c), parsed) || parsed != c) {
+            fail(name, std::string("name round trip for ") + patient_class_name(c));
+        }
+    }
+    PatientClass untouched = PatientClass::Renal;
+    if (parse_patient_class("auto", untouched) || untouched != PatientClass::Renal) fail(name, "bad name");
+
+    PatientProfile p = test_profile();
+    if (select_patient_class(p) != PatientClass::Standard) fail(name, "adult");
+    p.renal_impairment = true;
+    if (select_patient_class(p) != PatientClass::Renal) fail(name, "renal");
+    p.cardiac_condition = true;
+    if (select_patient_class(p) != PatientClass::Cardiac) fail(name, "cardiac before renal");
+    p.age_years = 9.0;
+    if (select_patient_class(p) != PatientClass::Pediatric) fail(name, "pediatric first");
+    p.age_years = 0.0;
+    if (select_patient_class(p) != PatientClass::Cardiac) fail(name, "unset age counts as adult");
+    std::cout << name << " passed\n";
+}
+
+// Each compiled pipeline decides exactly as the run-time components given
+// the class's tuning, which is what replay --patient-class relies on.
+void test_class_pipelines_match_tuned_components() {
+    const char* name = "test_class_pipelines_match_tuned_components";
+    const double dt_minutes = config::CONTROL_PERIOD_SEC / 60.0;
+    PatientProfile profile = test_profile();
+
+    for (PatientClass c : kPatientClasses) {
+        config::ControlTuning tuning = patient_class_tuning(c);
+        std::unique_ptr<ControlPipeline> pipeline = make_control_pipeline(c, profile, default_energy_proxy());
+        if (pipeline->patient_class() != c) fail(name, "patient_class()");
+
+        StateEstimator estimator(default_energy_proxy());
+        estimator.set_neural_energy_proxy(tuning.neural_energy_proxy);
+        AdaptiveController controller(profile, tuning);
+        SafetyMonitor safety(profile, tuning);
+
+        double compiled_rate = 0.4, tuned_rate = 0.4;
+        int limited = 0;
+        for (int i = 0; i < 2000; ++i) {
+            Telemetry m = telemetry(i);
+            StageClock stages(nullptr);
+            CycleResult result;
+            pipeline->run(m, profile, compiled_rate, dt_minutes, nullptr, stages, result);
+            compiled_rate = result.command.infusion_ml_per_min;
+            pipeline->safety().update_volume(compiled_rate, dt_minutes);
+
+            PatientState s = estimator.estimate(m, profile, tuned_rate);
+            precision_spine::TreatmentFlow safe =
+                precision_spine::reject_noise(precision_spine::dose_route(s));
+            ControlOutput command = controller.decide(precision_spine::fallback_floor(safe), safety,
+                                                      estimator, dt_minutes);
+            tuned_rate = command.infusion_ml_per_min;
+            safety.update_volume(tuned_rate, dt_minutes);
+
+            if (compiled_rate != tuned_rate || result.command.warning_flags.bits != command.warning_flags.bits) {
+                fail(name, std::string(patient_class_name(c)) + " diverged at tick " + std::to_string(i));
+            }
+            if (command.warning_flags.any()) ++limited;
+        }
+        if (limited == 0) fail(name, std::string(patient_class_name(c)) + " never hit a limit");
+        if (pipeline->safety().get_cumulative_volume() != safety.get_cumulative_volume()) {
+            fail(name, "volume accounting");
+        }
+    }
+    std::cout << name << " passed\n";
+}
+
+void test_cardiac_steps_are_smaller() {
+    const char* name = "test_cardiac_steps_are_smaller";
+    const double dt_minutes = config::CONTROL_PERIOD_SEC / 60.0;
+    PatientProfile profile = test_profile();
+    std::unique_ptr<ControlPipeline> cardiac = make_control_pipeline(PatientClass::Cardiac, profile, nullptr);
+
+    // Only increases are step limited; a cap may cut the rate at once
+    double rate = 0.4, largest_rise = 0.0;
+    int limited = 0;
+    for (int i = 0; i < 2000; ++i) {
+        StageClock stages(nullptr);
+        CycleResult result;
+        cardiac->run(telemetry(i), profile, rate, dt_minutes, nullptr, stages, result);
+        double next = result.command.infusion_ml_per_min;
+        // The emergency floor may lift a rate past the step limit
+        if (!result.command.warning_flags.has(WarningFlag::EmergencyMinRate)) {
+            largest_rise = std::max(largest_rise, next - rate);
+        }
+        if (result.command.warning_flags.has(WarningFlag::RateChangeLimited)) ++limited;
+        rate = next;
+        cardiac->safety().update_volume(rate, dt_minutes);
+    }
+    if (largest_rise > CardiacPolicy::limits().max_rate_change_ml_min + 1e-12) {
+        fail(name, "rise of " + std::to_string(largest_rise) + " ml/min");
+    }
+    if (limited == 0) fail(name, "step limit never engaged");
+    std::cout << name << " passed\n";
+}
+
+void test_energy_strategy_per_class() {
+    const char* name = "test_energy_strategy_per_class";
+    PatientProfile profile = test_profile();
+    EnergyProxyModelPtr model = std::make_shared<ConstantEnergyProxy>();
+    Telemetry m = telemetry(3);
+
+    for (PatientClass c : kPatientClasses) {
+        std::unique_ptr<ControlPipeline> pipeline = make_control_pipeline(c, profile, model);
+        StageClock stages(nullptr);
+        CycleResult result;
+        pipeline->run(m, profile, 0.4, 0.2 / 60.0, nullptr, stages, result);
+        double expected = c == PatientClass::Pediatric ? StateEstimatorCore::rule_energy_proxy(m) : 0.123;
+        if (result.state.energy_T != expected) {
+            fail(name, std::string(patient_class_name(c)) + " energy_T " + std::to_string(result.state.energy_T));
+        }
+    }
+    std::cout << name << " passed\n";
+}
+
+void test_class_pipeline_uncertainty() {
+    const char* name = "test_class_pipeline_uncertainty";
+    PatientProfile profile = test_profile();
+    UncertaintyEngine::Options options;
+    options.samples = 64;
+    options.worker_threads = 2;
+    UncertaintyEngine engine(options);
+    std::unique_ptr<ControlPipeline> renal = make_control_pipeline(PatientClass::Renal, profile, nullptr);
+
+    double rate = 0.4;
+    for (int i = 0; i < 20; ++i) {
+        StageClock stages(nullptr);
+        CycleResult result;
+        renal->run(telemetry(i), profile, rate, 0.2 / 60.0, &engine, stages, result);
+        if (result.rate_interval.samples != 64) fail(name, "interval not evaluated");
+        // The unperturbed sample is this tick's own decision
+        if (result.rate_interval.nominal != result.command.infusion_ml_per_min) fail(name, "nominal rate");
+        rate = result.command.infusion_ml_per_min;
+        renal->safety().update_volume(rate, 0.2 / 60.0);
+    }
+    std::cout << name << " passed\n";
+}
+
+void test_cycle_uses_selected_class() {
+    const char* name = "test_cycle_uses_selected_class";
+    PatientProfile profile = test_profile();
+    const std::string sid = "control_policy_test";
+    {
+        PatientControlCycle cycle(profile, sid, LoggerMode::Sync, SessionFormat::Csv, nullptr,
+                                  PatientClass::Pediatric);
+        if (cycle.patient_class() != PatientClass::Pediatric) fail(name, "patient_class()");
+        for (int i = 0; i < 10; ++i) cycle.step(telemetry(i), config::CONTROL_PERIOD_SEC);
+        if (cycle.safety().get_cumulative_volume() <= 0.0) fail(name, "volume accounting");
+        if (cycle.estimator().get_history().size() != 10) fail(name, "estimator history");
+    }
+    for (const char* suffix : {"_system.log", "_telemetry.csv", "_control.csv"}) {
+        std::remove(("ai_iv_" + sid + suffix).c_str());
+    }
+    std::cout << name << " passed\n";
+}
+
+int main() {
+    test_class_tuning_and_selection();
+    test_class_pipelines_match_tuned_components();
+    test_cardiac_steps_are_smaller();
+    test_energy_strategy_per_class();
+    test_class_pipeline_uncertainty();
+    test_cycle_uses_selected_class();
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include "../src/FastMath.hpp"
+#include "../src/Utils.hpp"
+#include "../src/config_defaults.hpp"
+#include "../src/iv_system_types.hpp"
+#include "test_support.hpp"
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace ivsys;
+
+static bool same_bits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+void test_exp_relative_error() {
+    const char* name = "test_exp_relative_error";
+    double worst = 0.0, worst_x = 0.0;
+    // Dense over the physiological arguments (|x| < 60), coarse elsewhere.
+    for (double x = -60.0; x <= 60.0; x += 1.0 / 1024.0) {
+        double e = std::fabs(fastmath::exp(x) - std::exp(x)) / std::exp(x);
+        if (e > worst) { worst = e; worst_x = x; }
+    }
+    for (double x = -707.5; x <= 709.78; x += 0.0371) {
+        double e = std::fabs(fastmath::exp(x) - std::exp(x)) / std::exp(x);
+        if (e > worst) { worst = e; worst_x = x; }
+    }
+    if (worst > fastmath::kExpMaxRelError) {
+        fail(name, "relative error " + std::to_string(worst) + " at x=" + std::to_string(worst_x));
+    }
+    std::cout << "  max relative error " << worst << " (bound " << fastmath::kExpMaxRelError << ")\n";
+    std::cout << name << " passed\n";
+}
+
+void test_exp_edge_cases() {
+    const char* name = "test_exp_edge_cases";
+    const double inf = std::numeric_limits<double>::infinity();
+    if (fastmath::exp(0.0) != 1.0) fail(name, "exp(0)");
+    if (fastmath::exp(710.0) != inf || fastmath::exp(inf) != inf) fail(name, "overflow");
+    if (!std::isfinite(fastmath::exp(709.78))) fail(name, "exp(709.78) overflowed early");
+    if (fastmath::exp(-708.0) != 0.0 || fastmath::exp(-inf) != 0.0) fail(name, "underflow");
+    if (!std::isnan(fastmath::exp(std::nan("")))) fail(name, "NaN");
+    std::cout << name << " passed\n";
+}
+
+struct Range {
+    const char* what;
+    double lo, hi;
+    double a, b;   // kernel parameters (center/steepness, rate, center/sigma)
+};
+
+void test_kernels_over_physiological_ranges() {
+    const char* name = "test_kernels_over_physiological_ranges";
+    EnergyTransferParams energy;
+    // Every call site in StateEstimator.cpp / AdaptiveController.cpp.
+    const Range sigmoids[] = {
+        {"hydration_pct h_term", 0.0, 100.0, 60.0, 0.1},
+        {"spo2_pct o_term", 50.0, 100.0, 92.0, 0.3},
+        {"hr / max_hr reserve", 0.0, 2.0, 0.85, 10.0},
+        {"hydration_deficit", 0.0, 1.0, 0.5, 5.0},
+        {"cardiac_reserve limit", 0.0, 1.0, config::CARDIAC_LIMIT_THRESHOLD,
+         config::CARDIAC_SIGMOID_STEEPNESS},
+    };
+    const Range decays[] = {
+        {"blood_loss_idx b_term", 0.0, 1.0, 3.0, 0.0},
+        {"lactate excess l_term", 0.0, 18.0, 0.5, 0.0},
+    };
+    const Range gaussians[] = {
+        {"flow velocity G_v", 0.05, 40.0, energy.v_optimal_cm_s, energy.sigma_velocity},
+    };
+    const int steps = 100000;
+
+    for (const Range& r : sigmoids) {
+        double worst = 0.0;
+        for (int i = 0; i <= steps; ++i) {
+            double x = r.lo + (r.hi - r.lo) * i / steps;
+            double ref = 1.0 / (1.0 + std::exp(-r.b * (x - r.a)));
+            worst = std::max(worst, std::fabs(fastmath::sigmoid(x, r.a, r.b) - ref));
+        }
+        if (worst > fastmath::kExpMaxRelError / 4) fail(name, std::string("sigmoid ") + r.what);
+    }
+    for (const Range& r : decays) {
+        double worst = 0.0;
+        for (int i = 0; i <= steps; ++i) {
+            double x = r.lo + (r.hi - r.lo) * i / steps;
+            worst = std::max(worst, std::fabs(fastmath::exponential_decay(x, r.a) - std::exp(-r.a * x)));
+        }
+        if (worst > fastmath::kExpMaxRelError) fail(name, std::string("decay ") + r.what);
+    }
+    for (const Range& r : gaussians) {
+        double worst = 0.0;
+        for (int i = 0; i <= steps; ++i) {
+            double x = r.lo + (r.hi - r.lo) * i / steps;
+            double z = (x - r.a) / r.b;
+            worst = std::max(worst, std::fabs(fastmath::gaussian(x, r.a, r.b) - std::exp(-0.5 * z * z)));
+        }
+        if (worst > fastmath::kExpMaxRelError) fail(name, std::string("gaussian ") + r.what);
+    }
+    if (fastmath::gaussian(1.0, 0.0, 0.0) != 0.0) fail(name, "gaussian sigma <= 0");
+    std::cout << name << " passed\n";
+}
+
+void test_batch_is_bit_identical_to_scalar() {
+    const char* name = "test_batch_is_bit_identical_to_scalar";
+    for (size_t n : {size_t{0}, size_t{1}, size_t{2}, size_t{3}, size_t{1001}}) {
+        std::vector<double> x(n), out(n), in_place(n);
+        for (size_t i = 0; i < n; ++i) x[i] = -30.0 + 0.0617 * static_cast<double>(i);
+
+        fastmath::exp_batch(x.data(), out.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            if (!same_bits(out[i], fastmath::exp(x[i]))) fail(name, "exp_batch");
+        }
+        fastmath::sigmoid_batch(x.data(), out.data(), n, 1.5, 0.7);
+        for (size_t i = 0; i < n; ++i) {
+            if (!same_bits(out[i], fastmath::sigmoid(x[i], 1.5, 0.7))) fail(name, "sigmoid_batch");
+        }
+        fastmath::gaussian_batch(x.data(), out.data(), n, 2.0, 5.0);
+        for (size_t i = 0; i < n; ++i) {
+            if (!same_bits(out[i], fastmath::gaussian(x[i], 2.0, 5.0))) fail(name, "gaussian_batch");
+        }
+        in_place = x;
+        fastmath::exponential_decay_batch(in_place.data(), in_place.data(), n, 0.5);
+        for (size_t i = 0; i < n; ++i) {
+            if (!same_bits(in_place[i], fastmath::exponential_decay(x[i], 0.5))) {
+                fail(name, "exponential_decay_batch in place");
+            }
+        }
+    }
+    std::cout << name << " passed\n";
+}
+
+void test_utils_dispatch() {
+    const char* name = "test_utils_dispatch";
+    const double x = 0.123456789;
+    double expected = Utils::kFastMath ? fastmath::exp(x) : std::exp(x);
+    if (!same_bits(Utils::exp(x), expected)) fail(name, "Utils::exp uses the wrong kernel");
+    std::cout << "  Utils math: " << (Utils::kFastMath ? "fastmath" : "libm") << "\n";
+    std::cout << name << " passed\n";
+}
+
+int main() {
+    test_exp_relative_error();
+    test_exp_edge_cases();
+    test_kernels_over_physiological_ranges();
+    test_batch_is_bit_identical_to_scalar();
+    test_utils_dispatch();
+    return 0;
+}
@@ -0,0 +1,294 @@
+#include "../src/feature_export.hpp"
+#include "../src/control_cycle.hpp"
+#include "../src/session_format.hpp"
+#include "test_support.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+using namespace ivsys;
+
+static const int kTicks = 900;
+static const std::string kOutDir = "ai_iv_feature_out";
+
+// 8-byte aligned copy of a file, as the Reader requires.
+static std::vector<std::uint64_t> load_file(const std::string& path, size_t& size) {
+    std::ifstream in(path, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    size = bytes.size();
+    std::vector<std::uint64_t> words((size + 7) / 8);
+    if (size > 0) std::memcpy(words.data(), bytes.data(), size);
+    return words;
+}
+
+static bool file_exists(const std::string& path) {
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0;
+}
+
+void test_table_round_trip() {
+    const char* name = "test_table_round_trip";
+    const std::string path = kOutDir + "/roundtrip.aift";
+    std::remove(path.c_str());
+    {
+        feature_table::Writer w(path, {{"t", feature_table::ColumnType::Int64},
+                                       {"x", feature_table::ColumnType::Float64}},
+                                "roundtrip", 4);
+        for (int i = 0; i < 10; ++i) {
+            w.set(0, static_cast<std::int64_t>(100 + i));
+            w.set(1, i * 0.5);
+            w.end_row();
+        }
+        if (file_exists(path)) fail(name, "table published before close()");
+        w.close();
+        if (w.rows() != 10 || w.row_groups() != 3) fail(name, "writer counts");
+    }
+
+    size_t size = 0;
+    auto words = load_file(path, size);
+    feature_table::Reader r(words.data(), size);
+    if (r.table_id() != "roundtrip" || r.total_rows() != 10 || r.row_group_count() != 3) {
+        fail(name, "reader metadata");
+    }
+    if (r.column_index("x") != 1 || r.column_index("missing") != feature_table::Reader::npos) {
+        fail(name, "column lookup");
+    }
+    if (r.row_group(1).first_key != 104 || r.row_group(2).last_key != 109 || r.row_group(2).rows != 2) {
+        fail(name, "row group index");
+    }
+    auto t = r.read_int64(0);
+    auto x = r.read_float64(1);
+    for (int i = 0; i < 10; ++i) {
+        if (t[i] != 100 + i || x[i] != i * 0.5) fail(name, "value at row " + std::to_string(i));
+    }
+    bool threw = false;
+    try {
+        r.float64_column(0, 0);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    if (!threw) fail(name, "type mismatch not rejected");
+
+    std::cout << name << " passed\n";
+}
+
+void test_unfinished_table_rejected() {
+    const char* name = "test_unfinished_table_rejected";
+    const std::string path = kOutDir + "/unfinished.aift";
+    std::remove(path.c_str());
+    {
+        feature_table::Writer w(path, {{"t", feature_table::ColumnType::Int64}}, "unfinished", 2);
+        for (int i = 0; i < 5; ++i) {
+            w.set(0, static_cast<std::int64_t>(i));
+            w.end_row();
+        }
+        // destroyed without close()
+    }
+    if (file_exists(path) || file_exists(path + ".tmp")) fail(name, "unfinished table left behind");
+
+    {
+        feature_table::Writer w(path, {{"t", feature_table::ColumnType::Int64}}, "unfinished", 2);
+        w.set(0, static_cast<std::int64_t>(1));
+        w.end_row();
+        w.close();
+    }
+    size_t size = 0;
+    auto words = load_file(path, size);
+    for (size_t cut : {size - 1, size - sizeof(feature_table::Trailer), sizeof(feature_table::FileHeader)}) {
+        bool threw = false;
+        try {
+            feature_table::Reader r(words.data(), cut);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        if (!threw) fail(name, "truncation to " + std::to_string(cut) + " bytes accepted");
+    }
+
+    std::cout << name << " passed\n";
+}
+
+// The exported decisions and state are exactly those of ReplayLogger::replay.
+static void check_matches_replay(const char* name, bool prefer_csv) {
+    ReplaySessionInfo session = ReplayLogger::load_session("feature_a");
+    ReplayOptions replay;
+    replay.prefer_csv = prefer_csv;
+
+    std::vector<std::int64_t> ts;
+    std::vector<double> rate, energy, risk;
+    ReplayReport report = ReplayLogger::replay(session, make_profile(), replay,
+        [&](const Telemetry& m, const PatientState& s, const ControlOutput& c) {
+            ts.push_back(session_format::to_ns(m.timestamp));
+            rate.push_back(c.infusion_ml_per_min);
+            energy.push_back(s.energy_T);
+            risk.push_back(s.risk_score);
+        });
+
+    FeatureExporter::Options options;
+    options.replay = replay;
+    options.output_dir = kOutDir;
+    options.chunk_rows = 97;
+    options.row_group_rows = 256;
+    FeatureExportFile f = FeatureExporter(options).export_session({session, make_profile()});
+    if (!f.error.empty()) fail(name, f.error);
+    if (f.from_binary == prefer_csv || f.rows != report.ticks || f.row_groups != 4) {
+        fail(name, "rows " + std::to_string(f.rows) + " groups " + std::to_string(f.row_groups));
+    }
+
+    size_t size = 0;
+    auto words = load_file(f.output_path, size);
+    feature_table::Reader r(words.data(), size);
+    if (r.schema().size() != FeatureExporter::schema().size() || r.table_id() != "feature_a") {
+        fail(name, "schema");
+    }
+    auto out_ts = r.read_int64(r.column_index("timestamp_ns"));
+    auto out_rate = r.read_float64(r.column_index("infusion_rate_ml_min"));
+    auto out_energy = r.read_float64(r.column_index("energy_T"));
+    auto out_risk = r.read_float64(r.column_index("risk_score"));
+    auto out_volume = r.read_float64(r.column_index("cumulative_volume_ml"));
+    for (size_t i = 0; i < ts.size(); ++i) {
+        if (out_ts[i] != ts[i] || out_rate[i] != rate[i] || out_energy[i] != energy[i] ||
+            out_risk[i] != risk[i]) {
+            fail(name, "row " + std::to_string(i) + " differs from the replay");
+        }
+    }
+    if (std::fabs(out_volume.back() - report.total_volume_ml) > 1e-9) fail(name, "cumulative volume");
+
+    std::cout << name << " passed\n";
+}
+
+void test_export_matches_replay_binary() {
+    check_matches_replay("test_export_matches_replay_binary", false);
+}
+
+void test_export_matches_replay_csv() {
+    check_matches_replay("test_export_matches_replay_csv", true);
+}
+
+// Output bytes depend only on the session, not on chunking or workers.
+void test_parallel_export_is_deterministic() {
+    const char* name = "test_parallel_export_is_deterministic";
+    std::vector<FeatureExportSession> sessions;
+    for (const char* id : {"feature_a", "feature_b", "feature_a", "feature_b"}) {
+        sessions.push_back({ReplayLogger::load_session(id), make_profile()});
+    }
+    sessions.push_back({ReplaySessionInfo{"feature_missing", "nope.csv", "", "", ""}, make_profile()});
+
+    std::vector<std::string> baseline;
+    for (size_t workers : {1, 4}) {
+        FeatureExporter::Options options;
+        options.worker_threads = workers;
+        options.output_dir = kOutDir;
+        options.chunk_rows = workers == 1 ? 4096 : 13;
+        options.row_group_rows = 128;
+        // Duplicate ids would race on one path; give each run its own copy.
+        std::vector<FeatureExportSession> run = sessions;
+        for (size_t s = 0; s < run.size(); ++s) run[s].info.session_id += "_" + std::to_string(s);
+        FeatureExportResult result = FeatureExporter(options).run(run);
+        if (result.files.size() != run.size() || result.exported != 4 || result.failed != 1 ||
+            result.files[4].error.empty() || file_exists(result.files[4].output_path)) {
+            fail(name, "failed session not isolated");
+        }
+        if (result.rows != 4u * kTicks || result.rows_per_sec <= 0.0) fail(name, "row totals");
+        for (size_t s = 0; s < 4; ++s) {
+            std::ifstream in(result.files[s].output_path, std::ios::binary);
+            std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            if (baseline.size() < 4) {
+                baseline.push_back(bytes);
+            } else if (bytes != baseline[s]) {
+                fail(name, "output of session " + std::to_string(s) + " depends on workers/chunking");
+            }
+        }
+    }
+
+    std::cout << name << " passed\n";
+}
+
+void test_stream_telemetry_bounds_chunks() {
+    const char* name = "test_stream_telemetry_bounds_chunks";
+    ReplaySessionInfo session = ReplayLogger::load_session("feature_a");
+    for (bool csv : {false, true}) {
+        ReplayOptions options;
+        options.prefer_csv = csv;
+        size_t seen = 0, largest = 0;
+        std::int64_t last_ns = -1;
+        size_t rows = ReplayLogger::stream_telemetry(session, options, 64,
+            [&](const Telemetry* chunk, size_t count) {
+                largest = std::max(largest, count);
+                for (size_t i = 0; i < count; ++i) {
+                    std::int64_t ns = session_format::to_ns(chunk[i].timestamp);
+                    if (ns <= last_ns) fail(name, "rows out of order");
+                    last_ns = ns;
+                }
+                seen += count;
+            });
+        if (rows != static_cast<size_t>(kTicks) || seen != rows || largest == 0 || largest > 64) {
+            fail(name, std::string(csv ? "csv" : "binary") + " rows " + std::to_string(rows) +
+                           " largest chunk " + std::to_string(largest));
+        }
+    }
+
+    std::cout << name << " passed\n";
+}
+
+void test_archive_discovery() {
+    const char* name = "test_archive_discovery";
+    const std::string dir = "ai_iv_feature_archive";
+    ::mkdir(dir.c_str(), 0755);
+    for (const char* suffix : {"_telemetry.csv", "_control.csv", "_system.log", "_session.aivs"}) {
+        std::string file = std::string("ai_iv_feature_b") + suffix;
+        std::ifstream in(file, std::ios::binary);
+        std::ofstream out(dir + "/ai_iv_archived" + suffix, std::ios::binary);
+        out << in.rdbuf();
+    }
+    // CSV-only session
+    {
+        std::ifstream in("ai_iv_feature_a_telemetry.csv", std::ios::binary);
+        std::ofstream out(dir + "/ai_iv_csvonly_telemetry.csv", std::ios::binary);
+        out << in.rdbuf();
+    }
+
+    std::vector<std::string> ids = ReplayLogger::find_sessions(dir);
+    if (ids != std::vector<std::string>{"archived", "csvonly"}) fail(name, "found " + std::to_string(ids.size()));
+    ReplaySessionInfo archived = ReplayLogger::load_session("archived", dir);
+    ReplaySessionInfo csvonly = ReplayLogger::load_session("csvonly", dir);
+    if (archived.binary_file.empty() || !csvonly.binary_file.empty()) fail(name, "session files");
+
+    FeatureExporter::Options options;
+    options.output_dir = dir;
+    FeatureExportResult result = FeatureExporter(options).run(
+        {{archived, make_profile()}, {csvonly, make_profile()}});
+    if (result.exported != 2 || !result.files[0].from_binary || result.files[1].from_binary ||
+        result.files[0].output_path != dir + "/archived.aift") {
+        fail(name, "archive export");
+    }
+
+    bool threw = false;
+    try {
+        ReplayLogger::find_sessions("ai_iv_feature_no_such_dir");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    if (!threw) fail(name, "missing directory not reported");
+
+    std::cout << name << " passed\n";
+}
+
+int main() {
+    ::mkdir(kOutDir.c_str(), 0755);
+    record_session("feature_a", kTicks, 0.02);
+    record_session("feature_b", kTicks, 0.03);
+    test_table_round_trip();
+    test_unfinished_table_rejected();
+    test_export_matches_replay_binary();
+    test_export_matches_replay_csv();
+    test_parallel_export_is_deterministic();
+    test_stream_telemetry_bounds_chunks();
+    test_archive_discovery();
+    return 0;
+}
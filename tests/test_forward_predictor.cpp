@@ -0,0 +1,136 @@
+#include "../src/ForwardPredictor.hpp"
+#include "../src/StateEstimator.hpp"
+#include "test_support.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace ivsys;
+
+static PatientState state_at(double hydration, double energy) {
+    PatientState s;
+    s.hydration_pct = hydration;
+    s.energy_T = energy;
+    s.uncertainty = 0.1;
+    return s;
+}
+
+void test_warmup() {
+    const char* name = "test_warmup";
+    ForwardPredictor p;
+    for (int i = 0; i < config::PREDICTION_WARMUP_SAMPLES - 1; ++i) {
+        p.update(state_at(70.0, 0.5));
+        if (p.predict(10).has_value()) fail(name, "prediction before warm-up");
+    }
+    ForwardPrediction out[2];
+    const int horizons[] = {5, 10};
+    if (p.predict(horizons, 2, out) != 0) fail(name, "batch prediction before warm-up");
+    p.update(state_at(70.0, 0.5));
+    if (!p.predict(10).has_value()) fail(name, "no prediction after warm-up");
+    std::cout << name << " passed\n";
+}
+
+void test_tracks_linear_trend() {
+    const char* name = "test_tracks_linear_trend";
+    ForwardPredictor p;
+    const double slope = -0.05;   // hydration per step
+    int n = 400;
+    for (int i = 0; i < n; ++i) p.update(state_at(80.0 + slope * i, 0.3 + 0.0005 * i));
+
+    if (std::abs(p.hydration_trend() - slope) > 1e-3) fail(name, "hydration slope");
+    if (std::abs(p.energy_trend() - 0.0005) > 1e-4) fail(name, "energy slope");
+    for (int h : {0, 5, 10, 30}) {
+        auto f = p.predict(h);
+        double expected = 80.0 + slope * (n - 1 + h);
+        if (std::abs(f->state.hydration_pct - expected) > 0.05) {
+            fail(name, "hydration forecast at h=" + std::to_string(h));
+        }
+    }
+
+    // A flat channel predicts flat, and spread grows with the horizon.
+    ForwardPredictor flat;
+    for (int i = 0; i < 200; ++i) flat.update(state_at(65.0, 0.8));
+    auto near = flat.predict(1);
+    auto far = flat.predict(60);
+    if (std::abs(far->state.hydration_pct - 65.0) > 1e-6) fail(name, "flat forecast moved");
+    if (!(far->hydration_sd > near->hydration_sd && far->energy_sd > near->energy_sd)) {
+        fail(name, "forecast spread does not grow with horizon");
+    }
+    if (std::abs(far->state.uncertainty - std::min(1.0, 0.1 + 60 * config::UNCERTAINTY_GROWTH_PER_MIN)) > 1e-12) {
+        fail(name, "uncertainty growth");
+    }
+    std::cout << name << " passed\n";
+}
+
+void test_forecast_is_clamped() {
+    const char* name = "test_forecast_is_clamped";
+    ForwardPredictor p;
+    for (int i = 0; i < 50; ++i) p.update(state_at(10.0 - 0.2 * i, 0.1 - 0.01 * i));
+    auto f = p.predict(500);
+    if (f->state.hydration_pct != 0.0 || f->state.energy_T != 0.0) fail(name, "not clamped low");
+    if (p.predict(-5)->horizon != 0) fail(name, "negative horizon");
+    std::cout << name << " passed\n";
+}
+
+void test_cache_until_next_update() {
+    const char* name = "test_cache_until_next_update";
+    ForwardPredictor p;
+    for (int i = 0; i < 10; ++i) p.update(state_at(70.0 - 0.1 * i, 0.5));
+
+    const int horizons[] = {5, 10, 15, 30};
+    ForwardPrediction out[4];
+    if (p.predict(horizons, 4, out) != 4) fail(name, "batch count");
+    std::uint64_t computed = p.computed();
+    if (computed != 4) fail(name, "batch should compute each horizon once");
+    for (int i = 0; i < 4; ++i) {
+        auto single = p.predict(horizons[i]);
+        if (single->state.hydration_pct != out[i].state.hydration_pct ||
+            single->hydration_sd != out[i].hydration_sd) {
+            fail(name, "single and batch predictions differ");
+        }
+    }
+    if (p.computed() != computed) fail(name, "repeat query recomputed");
+
+    p.update(state_at(60.0, 0.5));
+    auto after = p.predict(10);
+    if (p.computed() != computed + 1) fail(name, "update did not invalidate the cache");
+    if (after->state.hydration_pct == out[1].state.hydration_pct) fail(name, "stale prediction served");
+    std::cout << name << " passed\n";
+}
+
+void test_estimator_feeds_predictor() {
+    const char* name = "test_estimator_feeds_predictor";
+    PatientProfile profile;
+    profile.weight_kg = 70.0;
+    StateEstimator estimator;
+    Telemetry m;
+    m.heart_rate_bpm = 75.0;
+    m.temp_celsius = 37.0;
+    m.spo2_pct = 98.0;
+    m.signal_quality = 1.0;
+
+    PatientState last;
+    for (int i = 0; i < 30; ++i) {
+        m.hydration_pct = 75.0 - 0.5 * i;
+        last = estimator.estimate(m, profile, 1.0);
+        if (i < config::PREDICTION_WARMUP_SAMPLES - 1 && estimator.predict_forward(10)) {
+            fail(name, "prediction before warm-up");
+        }
+    }
+    if (estimator.forward_predictor().samples() != 30) fail(name, "estimate() did not update");
+    auto predicted = estimator.predict_forward(10);
+    if (!predicted) fail(name, "no prediction");
+    if (!(predicted->hydration_pct < last.hydration_pct)) fail(name, "falling hydration not extrapolated");
+    if (predicted->heart_rate_bpm != last.heart_rate_bpm) fail(name, "other fields not from latest estimate");
+    std::cout << name << " passed\n";
+}
+
+int main() {
+    test_warmup();
+    test_tracks_linear_trend();
+    test_forecast_is_clamped();
+    test_cache_until_next_update();
+    test_estimator_feeds_predictor();
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include "../src/invariant_fuzzer.hpp"
+#include "test_support.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace ivsys;
+
+static InvariantFuzzer::Options small_run(size_t workers) {
+    InvariantFuzzer::Options options;
+    options.seed = 42;
+    options.cases = 3000;
+    options.worker_threads = workers;
+    options.max_ticks = 256;
+    options.max_failures = 4;
+    options.max_shrink_checks = 5000;
+    return options;
+}
+
+void test_invariants_hold() {
+    const char* name = "test_invariants_hold";
+    InvariantFuzzer::Options options = small_run(2);
+    options.adversarial_fraction = 0.5;
+    FuzzReport r = InvariantFuzzer(options).run();
+    if (r.cases != options.cases || r.adversarial_cases == 0 || r.ticks == 0) fail(name, "run size");
+    if (r.total_violations() != 0) {
+        const FuzzFailure& f = r.failures.front();
+        std::ostringstream out;
+        InvariantFuzzer::write_case(out, f.minimized);
+        fail(name, std::string(InvariantFuzzer::kind_name(f.violation.kind)) + " on\n" + out.str());
+    }
+    std::cout << name << " passed\n";
+}
+
+void test_generation_is_seeded() {
+    const char* name = "test_generation_is_seeded";
+    InvariantFuzzer fuzzer(small_run(1));
+    FuzzCase a = fuzzer.generate(InvariantFuzzer::case_seed(42, 17));
+    FuzzCase b = fuzzer.generate(InvariantFuzzer::case_seed(42, 17));
+    FuzzCase c = fuzzer.generate(InvariantFuzzer::case_seed(42, 18));
+    std::ostringstream sa, sb, sc;
+    InvariantFuzzer::write_case(sa, a);
+    InvariantFuzzer::write_case(sb, b);
+    InvariantFuzzer::write_case(sc, c);
+    if (sa.str() != sb.str() || sa.str() == sc.str()) fail(name, "case depends on more than its seed");
+    for (size_t i = 0; i < 200; ++i) {
+        FuzzCase k = fuzzer.generate(InvariantFuzzer::case_seed(7, i));
+        if (k.ticks.empty() || k.ticks.size() > 256 || k.duration_seconds() > 24.0 * 3600.0) {
+            fail(name, "case shape");
+        }
+    }
+    std::cout << name << " passed\n";
+}
+
+// A looser rate-change tuning than the invariant allows: every worker count
+// must report the same failures, each shrunk to a short case.
+void test_findings_shrink_and_repeat() {
+    const char* name = "test_findings_shrink_and_repeat";
+    FuzzReport baseline;
+    for (size_t workers : {1, 3}) {
+        InvariantFuzzer::Options options = small_run(workers);
+        options.cases = 1000;
+        options.tuning.max_rate_change_ml_min = 0.6;
+        FuzzReport r = InvariantFuzzer(options).run();
+        size_t k = static_cast<size_t>(InvariantKind::RateChangeExceeded);
+        if (r.violations[k] == 0 || r.violations[k] != r.total_violations()) fail(name, "findings");
+        if (r.failures.size() != options.max_failures) fail(name, "failure count");
+        for (const FuzzFailure& f : r.failures) {
+            if (f.violation.kind != InvariantKind::RateChangeExceeded || f.minimized.ticks.size() > 3 ||
+                f.minimized.ticks.size() > f.original_ticks) {
+                fail(name, "shrinking");
+            }
+            if (!(f.violation.observed > options.limits.max_rate_change_ml_min)) fail(name, "violation values");
+        }
+        if (workers == 1) {
+            baseline = r;
+            continue;
+        }
+        if (r.ticks != baseline.ticks || r.violations != baseline.violations) fail(name, "counts");
+        for (size_t i = 0; i < r.failures.size(); ++i) {
+            if (r.failures[i].case_seed != baseline.failures[i].case_seed ||
+                r.failures[i].minimized.ticks.size() != baseline.failures[i].minimized.ticks.size()) {
+                fail(name, "failures depend on worker count");
+            }
+        }
+    }
+    std::cout << name << " passed\n";
+}
+
+// A larger daily volume than the invariant allows: the shrinker merges the
+// accumulation into a few long ticks.
+void test_volume_findings_shrink() {
+    const char* name = "test_volume_findings_shrink";
+    InvariantFuzzer::Options options = small_run(2);
+    options.cases = 2000;
+    options.tuning.daily_volume_per_kg_ml = 45.0;
+    FuzzReport r = InvariantFuzzer(options).run();
+    if (r.violations[static_cast<size_t>(InvariantKind::VolumeCapExceeded)] == 0) fail(name, "no findings");
+    for (const FuzzFailure& f : r.failures) {
+        if (f.violation.kind != InvariantKind::VolumeCapExceeded) continue;
+        if (f.minimized.ticks.size() >= f.original_ticks && f.original_ticks > 1) fail(name, "not shrunk");
+        if (!(f.violation.observed > f.violation.limit)) fail(name, "violation values");
+        auto again = InvariantFuzzer::check(f.minimized, options.tuning, options.limits);
+        if (!again || again->kind != InvariantKind::VolumeCapExceeded) fail(name, "minimized case passes");
+        if (InvariantFuzzer::check(f.minimized, options.limits, options.limits)) {
+            fail(name, "minimized case fails under the default tuning");
+        }
+    }
+    std::cout << name << " passed\n";
+}
+
+int main() {
+    test_invariants_hold();
+    test_generation_is_seeded();
+    test_findings_shrink_and_repeat();
+    test_volume_findings_shrink();
+    return 0;
+}
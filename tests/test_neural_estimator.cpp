@@ -69,11 +69,57 @@ void test_rule_formula_agreement() {
     std::cout << "test_rule_formula_agreement passed\n";
 }
 
+void test_kernel_matches_fdeep() {
+    // predict() runs on SensorFusionKernel; it must track the fdeep model.
+    NeuralStateEstimator est;
+    est.load(NEURAL_MODEL_PATH);
+    assert(est.verify_error() <= SensorFusionKernel::kVerifyTolerance);
+
+    const float inputs[3][5] = {
+        {0.80f, 0.375f, 0.98f, 0.10f, 0.30f},
+        {0.40f, 0.65f,  0.84f, 0.40f, 0.90f},
+        {0.55f, 0.45f,  0.95f, 0.20f, 0.50f},
+    };
+    float batch[3];
+    est.predict_batch(&inputs[0][0], 3, batch);
+    for (int i = 0; i < 3; ++i) {
+        float reference = est.predict_reference(inputs[i][0], inputs[i][1], inputs[i][2],
+                                                inputs[i][3], inputs[i][4]);
+        float single = est.predict(inputs[i][0], inputs[i][1], inputs[i][2],
+                                   inputs[i][3], inputs[i][4]);
+        std::cout << "  sample " << i << ": kernel=" << single << " fdeep=" << reference << "\n";
+        assert(std::fabs(single - reference) <= SensorFusionKernel::kVerifyTolerance);
+        assert(std::fabs(batch[i] - single) <= 1e-6f);
+    }
+
+    std::cout << "test_kernel_matches_fdeep passed\n";
+}
+
+void test_blob_load_matches_json() {
+    // load_blob() skips fdeep; the kernel it builds is the same one.
+    NeuralStateEstimator json, blob;
+    json.load(NEURAL_MODEL_PATH);
+    blob.load_blob(SensorFusionKernel::blob_path_for(NEURAL_MODEL_PATH), NEURAL_MODEL_PATH);
+    assert(blob.is_loaded() && !blob.has_reference() && json.has_reference());
+    assert(blob.verify_error() <= SensorFusionKernel::kVerifyTolerance);
+    assert(blob.predict(0.55f, 0.45f, 0.95f, 0.20f, 0.50f) == json.predict(0.55f, 0.45f, 0.95f, 0.20f, 0.50f));
+    bool threw = false;
+    try {
+        blob.predict_reference(0.5f, 0.5f, 0.5f, 0.5f, 0.5f);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "test_blob_load_matches_json passed\n";
+}
+
 int main() {
     std::cout << "=== NeuralStateEstimator tests ===\n";
     test_load_and_healthy_patient();
     test_stressed_patient();
     test_rule_formula_agreement();
+    test_kernel_matches_fdeep();
+    test_blob_load_matches_json();
     std::cout << "All neural estimator tests passed\n";
     return 0;
 }
@@ -0,0 +1,105 @@
+#include "../src/precision_spine/PrecisionSpine.hpp"
+#include "test_support.hpp"
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ivsys;
+using namespace ivsys::precision_spine;
+
+static bool same_bits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+static bool same_state(const PatientState& a, const PatientState& b) {
+    return same_bits(a.hydration_pct, b.hydration_pct) &&
+           same_bits(a.heart_rate_bpm, b.heart_rate_bpm) &&
+           same_bits(a.coherence_sigma, b.coherence_sigma) &&
+           same_bits(a.energy_T, b.energy_T) &&
+           same_bits(a.energy_T_absolute, b.energy_T_absolute) &&
+           same_bits(a.metabolic_load, b.metabolic_load) &&
+           same_bits(a.cardiac_reserve, b.cardiac_reserve) &&
+           same_bits(a.risk_score, b.risk_score) &&
+           same_bits(a.estimated_flow_velocity_cm_s, b.estimated_flow_velocity_cm_s) &&
+           same_bits(a.flow_efficiency, b.flow_efficiency) &&
+           same_bits(a.uncertainty, b.uncertainty);
+}
+
+// Mostly in-range states, with every threshold, out-of-range value and NaN
+// the stages branch on mixed in.
+static std::vector<PatientState> random_states(size_t count) {
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double specials[] = {nan, -1.0, 0.0, 0.1, 0.2, 0.5, 0.7, 0.8, 20.0, 100.0, 101.0, 300.0, 301.0};
+    auto pick = [&](double lo, double hi) {
+        if (u(rng) < 0.1) return specials[rng() % (sizeof(specials) / sizeof(specials[0]))];
+        return lo + (hi - lo) * u(rng);
+    };
+    std::vector<PatientState> states(count);
+    for (PatientState& s : states) {
+        s.hydration_pct = pick(-10.0, 110.0);
+        s.heart_rate_bpm = pick(10.0, 320.0);
+        s.coherence_sigma = pick(0.0, 1.0);
+        s.energy_T = pick(0.0, 1.0);
+        s.energy_T_absolute = pick(0.0, 5.0);
+        s.metabolic_load = pick(0.0, 1.0);
+        s.cardiac_reserve = pick(-0.2, 1.0);
+        s.risk_score = pick(0.0, 1.0);
+        s.estimated_flow_velocity_cm_s = pick(-5.0, 40.0);
+        s.flow_efficiency = pick(-0.5, 1.5);
+        s.uncertainty = pick(0.0, 1.0);
+    }
+    return states;
+}
+
+void test_batch_matches_scalar_pipeline() {
+    const char* name = "test_batch_matches_scalar_pipeline";
+    for (size_t count : {size_t{0}, size_t{1}, size_t{3}, size_t{4096}}) {
+        std::vector<PatientState> raw = random_states(count);
+        std::vector<TreatmentFlow> flows = align_buffer(count);
+        for (size_t i = 0; i < count; ++i) {
+            flows[i].state = raw[i];
+            flows[i].desired_rate = 9.0;   // stale values from a previous batch
+            flows[i].is_valid = false;
+        }
+        route_batch(flows);
+
+        size_t fallbacks = 0;
+        for (size_t i = 0; i < count; ++i) {
+            TreatmentFlow safe = reject_noise(dose_route(raw[i]));
+            PatientState validated = fallback_floor(safe);
+            const TreatmentFlow& f = flows[i];
+            if (!same_state(f.state, validated)) fail(name, "state differs at row " + std::to_string(i));
+            if (f.is_valid != safe.is_valid || !same_bits(f.confidence, safe.confidence) ||
+                f.desired_rate != 0.0) {
+                fail(name, "flow fields differ at row " + std::to_string(i));
+            }
+            bool expected_floor = !safe.is_valid || safe.state.coherence_sigma < 0.2;
+            if (f.fallback_triggered != expected_floor) fail(name, "fallback_triggered at row " + std::to_string(i));
+            fallbacks += f.fallback_triggered;
+        }
+        if (count == 4096 && (fallbacks == 0 || fallbacks == count)) fail(name, "corpus misses a branch");
+    }
+    route_batch(nullptr, 0);
+    std::cout << name << " passed\n";
+}
+
+void test_align_buffer_alignment() {
+    const char* name = "test_align_buffer_alignment";
+    std::vector<TreatmentFlow> flows = align_buffer(33);
+    if (flows.size() != 33) fail(name, "size");
+    if (reinterpret_cast<std::uintptr_t>(flows.data()) % 64 != 0) fail(name, "buffer not 64-byte aligned");
+    if (sizeof(TreatmentFlow) % 64 != 0) fail(name, "flow stride not a multiple of 64");
+    std::cout << name << " passed\n";
+}
+
+int main() {
+    test_batch_matches_scalar_pipeline();
+    test_align_buffer_alignment();
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include "../src/realtime_scheduling.hpp"
+#include "test_support.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+using namespace ivsys;
+
+static bool has_failure(const RealtimeResult& r, const std::string& step) {
+    for (const std::string& f : r.failures) {
+        if (f.rfind(step, 0) == 0) return true;
+    }
+    return false;
+}
+
+// Each case runs on its own thread so affinity and policy changes stay there.
+template <typename Fn>
+static void on_thread(Fn fn) {
+    std::thread t(fn);
+    t.join();
+}
+
+void test_disabled_changes_nothing() {
+    const char* name = "test_disabled_changes_nothing";
+    RealtimeResult r = apply_realtime(RealtimeOptions{});
+    if (r.scheduling.realtime || r.scheduling.cpu != -1 || r.scheduling.fifo_priority != 0 ||
+        r.scheduling.memory_locked || r.scheduling.spin_ns != 0 || !r.failures.empty()) {
+        fail(name, "disabled options changed the scheduling");
+    }
+    std::cout << name << " passed\n";
+}
+
+void test_pinning_and_refusals_are_reported() {
+    const char* name = "test_pinning_and_refusals_are_reported";
+#ifdef __linux__
+    on_thread([name] {
+        int cpu = sched_getcpu();
+        if (cpu < 0) fail(name, "sched_getcpu");
+        RealtimeOptions options;
+        options.enabled = true;
+        options.cpu = cpu;
+        options.fifo_priority = 0;
+        options.lock_memory = false;
+        options.spin_window = std::chrono::microseconds(150);
+        RealtimeResult r = apply_realtime(options);
+        if (!r.scheduling.realtime || r.scheduling.cpu != cpu || !r.failures.empty()) {
+            fail(name, "pinning to the current core");
+        }
+        if (r.scheduling.spin_ns != 150000) fail(name, "spin window");
+
+        options.cpu = CPU_SETSIZE + 1;
+        r = apply_realtime(options);
+        if (r.scheduling.cpu != -1 || !has_failure(r, "sched_setaffinity")) {
+            fail(name, "impossible core not reported");
+        }
+    });
+    // Privileged steps either succeed or say why not; neither throws.
+    on_thread([name] {
+        RealtimeOptions options;
+        options.enabled = true;
+        options.fifo_priority = 1;
+        options.prefault_heap_bytes = 1 << 20;
+        RealtimeResult r = apply_realtime(options);
+        if ((r.scheduling.fifo_priority == 1) == has_failure(r, "SCHED_FIFO")) fail(name, "SCHED_FIFO outcome");
+        if (r.scheduling.memory_locked == has_failure(r, "mlockall")) fail(name, "mlockall outcome");
+    });
+#endif
+    bool threw = false;
+    try {
+        RealtimeOptions options;
+        options.enabled = true;
+        options.fifo_priority = 100;
+        apply_realtime(options);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    if (!threw) fail(name, "priority 100 accepted");
+    std::cout << name << " passed\n";
+}
+
+void test_hybrid_sleep_never_returns_early() {
+    const char* name = "test_hybrid_sleep_never_returns_early";
+    using Clock = std::chrono::steady_clock;
+    for (long spin_us : {0L, 50L, 5000L}) {
+        for (int i = 0; i < 20; ++i) {
+            Clock::time_point deadline = Clock::now() + std::chrono::microseconds(300 + 50 * i);
+            hybrid_sleep_until(deadline, std::chrono::microseconds(spin_us));
+            if (Clock::now() < deadline) fail(name, "returned before the deadline");
+        }
+    }
+    // A deadline in the past returns immediately.
+    hybrid_sleep_until(Clock::now() - std::chrono::seconds(1), std::chrono::microseconds(500));
+    std::cout << name << " passed\n";
+}
+
+int main() {
+    test_disabled_changes_nothing();
+    test_pinning_and_refusals_are_reported();
+    test_hybrid_sleep_never_returns_early();
+    return 0;
+}
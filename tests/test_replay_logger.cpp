@@ -0,0 +1,93 @@
+#include "../src/replay_logger.hpp"
+#include "../src/control_cycle.hpp"
+#include "test_support.hpp"
+#include <cmath>
+#include <iostream>
+#include <fstream>
+#include <string>
+
+using namespace ivsys;
+
+static const int kTicks = 1200;
+
+// Record a session the way AIIVSystem does: fixed 200 ms period.
+void test_binary_replay_reproduces_decisions() {
+    record_session("replay_test", kTicks);
+    ReplaySessionInfo session = ReplayLogger::load_session("replay_test");
+    ReplayReport r = ReplayLogger::replay(session, make_profile());
+
+    if (!r.from_binary || r.ticks != static_cast<size_t>(kTicks) ||
+        r.compared != r.ticks || r.mismatches != 0 || r.max_rate_deviation != 0.0) {
+        std::cerr << "test_binary_replay_reproduces_decisions failed: ticks " << r.ticks
+                  << " compared " << r.compared << " mismatches " << r.mismatches
+                  << " max deviation " << r.max_rate_deviation << "\n";
+        exit(1);
+    }
+    if (std::fabs(r.session_seconds - kTicks * 0.2) > 1e-6) {
+        std::cerr << "test_binary_replay_reproduces_decisions failed: session time "
+                  << r.session_seconds << "\n";
+        exit(1);
+    }
+
+    std::cout << "test_binary_replay_reproduces_decisions passed\n";
+}
+
+void test_csv_replay_tracks_decisions() {
+    ReplaySessionInfo session = ReplayLogger::load_session("replay_test");
+    ReplayOptions options;
+    options.prefer_csv = true;
+    options.mismatch_tolerance = 1e-3;
+    ReplayReport r = ReplayLogger::replay(session, make_profile(), options);
+
+    // CSV inputs are rounded to six significant digits, so decisions can
+    // drift slightly but must stay close.
+    if (r.from_binary || r.ticks != static_cast<size_t>(kTicks) ||
+        r.compared != r.ticks || r.mismatches != 0) {
+        std::cerr << "test_csv_replay_tracks_decisions failed: ticks " << r.ticks
+                  << " mismatches " << r.mismatches
+                  << " max deviation " << r.max_rate_deviation << "\n";
+        exit(1);
+    }
+
+    std::cout << "test_csv_replay_tracks_decisions passed\n";
+}
+
+void test_export_reconstructed_state() {
+    ReplaySessionInfo session = ReplayLogger::load_session("replay_test");
+    const std::string path = "ai_iv_replay_test_reconstructed.csv";
+    ReplayReport r = ReplayLogger::export_reconstructed_state(session, make_profile(), path);
+
+    std::ifstream in(path);
+    std::string line;
+    size_t lines = 0;
+    while (std::getline(in, line)) ++lines;
+    if (lines != r.ticks + 1) {
+        std::cerr << "test_export_reconstructed_state failed: " << lines << " lines\n";
+        exit(1);
+    }
+
+    std::cout << "test_export_reconstructed_state passed\n";
+}
+
+void test_missing_session_throws() {
+    bool threw = false;
+    try {
+        ReplayLogger::load_session("replay_test_does_not_exist");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    if (!threw) {
+        std::cerr << "test_missing_session_throws failed\n";
+        exit(1);
+    }
+
+    std::cout << "test_missing_session_throws passed\n";
+}
+
+int main() {
+    test_binary_replay_reproduces_decisions();
+    test_csv_replay_tracks_decisions();
+    test_export_reconstructed_state();
+    test_missing_session_throws();
+    return 0;
+}
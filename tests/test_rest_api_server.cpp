@@ -0,0 +1,721 @@
+#include "../src/rest_api_server.hpp"
+#include "../src/control_cycle.hpp"
+#include "../src/ControlLoopMetrics.hpp"
+#include "../src/LatencyHistogram.hpp"
+#include "../src/SeqLock.hpp"
+#include "../src/json_format.hpp"
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/time.h>
+
+using namespace ivsys;
+
+static int connect_to(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        std::cerr << "connect to 127.0.0.1:" << port << " failed\n";
+        exit(1);
+    }
+    // A broken server fails the test instead of hanging it.
+    struct timeval tv;
+    tv.tv_sec = 5;
+    tv.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+static void send_all(int fd, const std::string& data) {
+    size_t off = 0;
+    while (off < data.size()) {
+        ssize_t n = send(fd, data.data() + off, data.size() - off, MSG_NOSIGNAL);
+        if (n <= 0) {
+            std::cerr << "send failed\n";
+            exit(1);
+        }
+        off += static_cast<size_t>(n);
+    }
+}
+
+// Reads exactly one response (headers + Content-Length body). Leftover
+// bytes from pipelined responses stay in `pending`.
+static std::string read_response(int fd, std::string& pending) {
+    while (true) {
+        size_t header_end = pending.find("\r\n\r\n");
+        if (header_end != std::string::npos) {
+            size_t cl = pending.find("Content-Length: ");
+            size_t length = (cl == std::string::npos || cl > header_end)
+                ? 0 : std::strtoul(pending.c_str() + cl + 16, nullptr, 10);
+            size_t total = header_end + 4 + length;
+            if (pending.size() >= total) {
+                std::string response = pending.substr(0, total);
+                pending.erase(0, total);
+                return response;
+            }
+        }
+        char buf[4096];
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) return std::string();
+        pending.append(buf, static_cast<size_t>(n));
+    }
+}
+
+static std::string header_value(const std::string& response, const std::string& name) {
+    size_t pos = response.find("\r\n" + name + ": ");
+    if (pos == std::string::npos) return std::string();
+    pos += name.size() + 4;
+    return response.substr(pos, response.find("\r\n", pos) - pos);
+}
+
+static bool closed_by_peer(int fd) {
+    char c;
+    return recv(fd, &c, 1, 0) == 0;
+}
+
+static void expect(bool ok, const char* test, const std::string& what) {
+    if (!ok) {
+        std::cerr << test << " failed: " << what << "\n";
+        exit(1);
+    }
+}
+
+void test_latency_histogram_buckets() {
+    const char* name = "test_latency_histogram_buckets";
+    for (uint64_t ns : {0ull, 3ull, 4ull, 7ull, 8ull, 1000ull, 123456789ull, 1ull << 62}) {
+        size_t b = LatencyHistogram::bucket_for(ns);
+        expect(LatencyHistogram::bucket_lower_ns(b) <= ns && ns < LatencyHistogram::bucket_upper_ns(b),
+               name, "value " + std::to_string(ns) + " outside its bucket");
+    }
+
+    LatencyHistogram h;
+    for (int i = 1; i <= 1000; ++i) h.record(std::chrono::microseconds(i));
+    auto s = h.snapshot();
+    expect(s.count == 1000, name, "count");
+    expect(s.max_us() == 1000.0, name, "max");
+    double p50 = s.percentile_us(0.5);
+    double p99 = s.percentile_us(0.99);
+    expect(p50 > 500.0 * 0.75 && p50 < 500.0 * 1.25, name, "p50 " + std::to_string(p50));
+    expect(p99 > 990.0 * 0.75 && p99 <= 1000.0, name, "p99 " + std::to_string(p99));
+
+    for (int i = 0; i < 10; ++i) h.record(std::chrono::milliseconds(50));
+    auto d = h.snapshot().since(s);
+    expect(d.count == 10 && d.sum_ns == 500000000ull, name, "since() count/sum");
+    double p50_interval = d.percentile_us(0.5);
+    expect(p50_interval > 50000.0 * 0.75 && p50_interval < 50000.0 * 1.25, name,
+           "since() p50 " + std::to_string(p50_interval));
+
+    std::cout << name << " passed\n";
+}
+
+void test_json_fixed_matches_ostream() {
+    const char* name = "test_json_fixed_matches_ostream";
+    const double values[] = {0.0, -0.0049, 0.005, 1.0 / 3.0, 72.125, 72.135, -13.999,
+                             1e-9, 123456789.987654, 2.675, 37.0};
+    for (int precision : {2, 3}) {
+        for (double v : values) {
+            std::ostringstream expected;
+            expected << std::fixed << std::setprecision(precision) << v;
+            std::string got;
+            json::append_fixed(got, v, precision);
+            expect(got == expected.str(), name, got + " vs " + expected.str());
+        }
+    }
+    std::string special;
+    json::append_fixed(special, std::nan(""), 2);
+    expect(special == "null", name, "NaN must serialize as null");
+    std::string escaped;
+    json::append_escaped(escaped, std::string("a\"b\\c\n\x01"));
+    expect(escaped == "a\\\"b\\\\c\\n\\u0001", name, "escaping: " + escaped);
+
+    std::cout << name << " passed\n";
+}
+
+struct Triple {
+    std::uint64_t a, b, c;
+};
+
+void test_seqlock_readers_see_whole_records() {
+    const char* name = "test_seqlock_readers_see_whole_records";
+    SeqLock<Triple> cell;
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&] {
+            std::uint64_t last = 0;
+            while (!done.load()) {
+                Triple t = cell.load();
+                if (t.b != t.a * 2 || t.c != t.a * 3 || t.a < last) torn.fetch_add(1);
+                last = t.a;
+            }
+        });
+    }
+    for (std::uint64_t i = 1; i <= 200000; ++i) cell.store(Triple{i, i * 2, i * 3});
+    done.store(true);
+    for (auto& t : readers) t.join();
+
+    expect(torn.load() == 0, name, std::to_string(torn.load()) + " torn or stale reads");
+    expect(cell.version() == 200001, name, "version " + std::to_string(cell.version()));
+    std::cout << name << " passed\n";
+}
+
+void test_snapshot_publication_and_metrics() {
+    const char* name = "test_snapshot_publication_and_metrics";
+    RestApiServer server(0, "127.0.0.1", 2);
+    expect(server.start(), name, "start");
+
+    // Every field of a published tick carries the tick number, so a torn
+    // snapshot would show mismatched values.
+    auto publish_tick = [&server](int i) {
+        Telemetry m;
+        m.hydration_pct = m.heart_rate_bpm = m.temp_celsius = i;
+        m.spo2_pct = m.lactate_mmol = m.cardiac_output_L_min = i;
+        server.update_telemetry(m);
+        PatientState st;
+        st.hydration_pct = i;
+        server.update_patient_state(st);
+        server.update_control_output(0.5, std::string(600, 'r'));
+    };
+    int tick = 1;
+    for (; tick <= 1000; ++tick) publish_tick(tick);  // fill the history first
+
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (; !done.load(); ++tick) publish_tick(tick);
+    });
+
+    int fd = connect_to(server.port());
+    std::string pending;
+    for (int i = 0; i < 200; ++i) {
+        send_all(fd, "GET /api/telemetry HTTP/1.1\r\n\r\n");
+        std::string response = read_response(fd, pending);
+        std::string body = response.substr(response.find("\r\n\r\n") + 4);
+        std::string first = body.substr(body.find("\"hydration_pct\":") + 16);
+        std::string value = first.substr(0, first.find(','));
+        for (const char* field : {"heart_rate_bpm", "temp_celsius", "spo2_pct", "lactate_mmol"}) {
+            std::string key = std::string("\"") + field + "\":" + value + ",";
+            expect(body.find(key) != std::string::npos, name, "torn telemetry: " + body);
+        }
+    }
+    // Slots the writer laps during the walk are skipped, never torn.
+    send_all(fd, "GET /api/telemetry/history HTTP/1.1\r\n\r\n");
+    std::string history = read_response(fd, pending);
+    expect(history.rfind("HTTP/1.1 200", 0) == 0 && history.find("\"count\":") != std::string::npos,
+           name, "history under load: " + history.substr(0, 200));
+    done.store(true);
+    writer.join();
+
+    send_all(fd, "GET /api/telemetry/history HTTP/1.1\r\n\r\n");
+    history = read_response(fd, pending);
+    expect(history.find("\"count\":1000}") != std::string::npos, name, "history not full");
+
+    send_all(fd, "GET /api/control HTTP/1.1\r\n\r\n");
+    std::string control = read_response(fd, pending);
+    expect(control.find(std::string(511, 'r') + "\"") != std::string::npos, name,
+           "rationale not truncated to the fixed field");
+
+    send_all(fd, "GET /api/metrics HTTP/1.1\r\nConnection: close\r\n\r\n");
+    std::string metrics = read_response(fd, pending);
+    expect(metrics.rfind("HTTP/1.1 200", 0) == 0, name, "metrics: " + metrics);
+    expect(metrics.find("\"publish_latency\":{\"count\":") != std::string::npos &&
+           metrics.find("\"read_retries\":") != std::string::npos &&
+           metrics.find("\"/api/telemetry\":{\"count\":200,") != std::string::npos,
+           name, "metrics body: " + metrics);
+    close(fd);
+
+    auto pub = server.publication_metrics();
+    expect(pub.version == pub.publish_latency.count && pub.version >= 3000, name,
+           "publish count " + std::to_string(pub.version));
+    expect(pub.reads >= 202, name, "reads " + std::to_string(pub.reads));
+
+    server.stop();
+    std::cout << name << " passed\n";
+}
+
+void test_etag_and_history_chunks() {
+    const char* name = "test_etag_and_history_chunks";
+    RestApiServer server(0, "127.0.0.1", 2);
+    expect(server.start(), name, "start");
+
+    PatientState st;
+    st.hydration_pct = 61.5;
+    server.update_patient_state(st);
+
+    int fd = connect_to(server.port());
+    std::string pending;
+    send_all(fd, "GET /api/state HTTP/1.1\r\n\r\n");
+    std::string first = read_response(fd, pending);
+    std::string etag = header_value(first, "ETag");
+    expect(first.rfind("HTTP/1.1 200", 0) == 0 && !etag.empty(), name, "no ETag: " + first);
+    expect(first.find("\"hydration_pct\":61.500") != std::string::npos, name, "state body: " + first);
+
+    // Unchanged data: 304 with no body, then the connection keeps going.
+    send_all(fd, "GET /api/state HTTP/1.1\r\nIf-None-Match: " + etag + "\r\n\r\n");
+    std::string revalidated = read_response(fd, pending);
+    expect(revalidated.rfind("HTTP/1.1 304", 0) == 0, name, "expected 304: " + revalidated);
+    expect(revalidated.size() == revalidated.find("\r\n\r\n") + 4, name, "304 carried a body");
+
+    // A new publish changes the tag and the body.
+    st.hydration_pct = 62.0;
+    server.update_patient_state(st);
+    send_all(fd, "GET /api/state HTTP/1.1\r\nIf-None-Match: " + etag + "\r\n\r\n");
+    std::string changed = read_response(fd, pending);
+    expect(changed.rfind("HTTP/1.1 200", 0) == 0 && header_value(changed, "ETag") != etag &&
+           changed.find("\"hydration_pct\":62.000") != std::string::npos,
+           name, "stale state served: " + changed);
+
+    // History across several ring wraps: last 1000 entries, oldest first,
+    // whether served from sealed chunks or single fragments.
+    int published = 0;
+    for (int round = 0; round < 3; ++round) {
+        int ticks = round == 0 ? 1234 : 17 + round * 33;
+        for (int i = 0; i < ticks; ++i) {
+            Telemetry m;
+            m.hydration_pct = ++published;
+            server.update_telemetry(m);
+        }
+        send_all(fd, "GET /api/telemetry/history HTTP/1.1\r\n\r\n");
+        std::string history = read_response(fd, pending);
+        expect(history.find("\"count\":1000}") != std::string::npos, name, "history count");
+        int expected = published - 999;
+        size_t pos = 0;
+        int seen = 0;
+        while ((pos = history.find("\"hydration_pct\":", pos)) != std::string::npos) {
+            pos += 16;
+            int value = std::atoi(history.c_str() + pos);
+            expect(value == expected, name, "history entry " + std::to_string(value) +
+                                                ", expected " + std::to_string(expected));
+            ++expected;
+            ++seen;
+        }
+        expect(seen == 1000, name, "history entries " + std::to_string(seen));
+
+        std::string history_etag = header_value(history, "ETag");
+        send_all(fd, "GET /api/telemetry/history HTTP/1.1\r\nIf-None-Match: " + history_etag + "\r\n\r\n");
+        expect(read_response(fd, pending).rfind("HTTP/1.1 304", 0) == 0, name, "history not revalidated");
+    }
+    close(fd);
+
+    server.stop();
+    std::cout << name << " passed\n";
+}
+
+void test_keep_alive_and_pipelining() {
+    const char* name = "test_keep_alive_and_pipelining";
+    RestApiServer server(0, "127.0.0.1", 2);
+    expect(server.start(), name, "start");
+
+    int fd = connect_to(server.port());
+    std::string pending;
+
+    // Two pipelined requests on one connection are answered in order.
+    send_all(fd, "GET /api/status HTTP/1.1\r\nHost: x\r\n\r\n"
+                 "GET /api/nope HTTP/1.1\r\nHost: x\r\n\r\n");
+    std::string first = read_response(fd, pending);
+    std::string second = read_response(fd, pending);
+    expect(first.rfind("HTTP/1.1 200", 0) == 0, name, "first response: " + first);
+    expect(first.find("Connection: keep-alive") != std::string::npos, name, "not keep-alive");
+    expect(second.rfind("HTTP/1.1 404", 0) == 0, name, "second response: " + second);
+
+    // Still open: a third request on the same socket, asking to close.
+    send_all(fd, "GET /api/state/ HTTP/1.1\r\nConnection: close\r\n\r\n");
+    std::string third = read_response(fd, pending);
+    expect(third.rfind("HTTP/1.1 200", 0) == 0, name, "third response: " + third);
+    expect(third.find("Connection: close") != std::string::npos, name, "close not honoured");
+    expect(closed_by_peer(fd), name, "connection left open after Connection: close");
+    close(fd);
+
+    // HTTP/1.0 closes by default; methods other than GET are refused.
+    fd = connect_to(server.port());
+    pending.clear();
+    send_all(fd, "POST /api/control HTTP/1.0\r\nContent-Length: 4\r\n\r\nabcd");
+    std::string refused = read_response(fd, pending);
+    expect(refused.rfind("HTTP/1.1 405", 0) == 0, name, "POST response: " + refused);
+    expect(closed_by_peer(fd), name, "HTTP/1.0 connection left open");
+    close(fd);
+
+    auto latencies = server.endpoint_latencies();
+    expect(latencies[0].endpoint == "/api/status" && latencies[0].latency.count == 1, name,
+           "status latency not recorded");
+    expect(latencies[4].endpoint == "/api/state" && latencies[4].latency.count == 1, name,
+           "state latency not recorded");
+    expect(latencies.back().endpoint == "other" && latencies.back().latency.count == 2, name,
+           "unknown path / bad method not counted as other");
+
+    // A Content-Length that is negative, not a number or so large that it
+    // wraps the framing arithmetic is refused and the connection closed.
+    for (const char* length : {"-1", "abc", "18446744073709551615", "4x", ""}) {
+        fd = connect_to(server.port());
+        pending.clear();
+        send_all(fd, std::string("GET /api/status HTTP/1.1\r\nContent-Length: ") + length +
+                         "\r\n\r\nGET /api/nope HTTP/1.1\r\n\r\n");
+        std::string rejected = read_response(fd, pending);
+        expect(rejected.rfind("HTTP/1.1 400", 0) == 0, name,
+               std::string("Content-Length ") + length + ": " + rejected);
+        expect(closed_by_peer(fd), name, std::string("Content-Length ") + length + " left open");
+        close(fd);
+    }
+
+    server.stop();
+    std::cout << name << " passed\n";
+}
+
+void test_slow_client_does_not_stall_others() {
+    const char* name = "test_slow_client_does_not_stall_others";
+    RestApiServer server(0, "127.0.0.1", 2);
+    expect(server.start(), name, "start");
+
+    // Half a request, never finished.
+    int slow = connect_to(server.port());
+    send_all(slow, "GET /api/sta");
+
+    for (int i = 0; i < 20; ++i) {
+        int fd = connect_to(server.port());
+        std::string pending;
+        send_all(fd, "GET /api/telemetry HTTP/1.1\r\nConnection: close\r\n\r\n");
+        std::string response = read_response(fd, pending);
+        expect(response.rfind("HTTP/1.1 200", 0) == 0, name, "request behind slow client failed");
+        close(fd);
+    }
+
+    // Oversized request headers are rejected and the socket closed.
+    int big = connect_to(server.port());
+    std::string pending;
+    send_all(big, "GET /api/status HTTP/1.1\r\nX-Pad: " + std::string(9000, 'a') + "\r\n\r\n");
+    std::string response = read_response(big, pending);
+    expect(response.rfind("HTTP/1.1 400", 0) == 0, name, "oversized request: " + response);
+    close(big);
+
+    // Finishing the slow request still works on the same connection.
+    pending.clear();
+    send_all(slow, "tus HTTP/1.1\r\n\r\n");
+    response = read_response(slow, pending);
+    expect(response.rfind("HTTP/1.1 200", 0) == 0, name, "slow client never answered");
+    close(slow);
+
+    server.stop();
+    expect(server.open_connections() == 0, name, "connections left after stop");
+    std::cout << name << " passed\n";
+}
+
+// Reads from a stream until `marker` has been seen, returning what arrived.
+static std::string read_stream_until(int fd, std::string& pending, const std::string& marker) {
+    char buf[4096];
+    while (pending.find(marker) == std::string::npos) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            std::cerr << "stream ended before '" << marker << "'\n";
+            exit(1);
+        }
+        pending.append(buf, static_cast<size_t>(n));
+    }
+    size_t end = pending.find(marker) + marker.size();
+    std::string out = pending.substr(0, end);
+    pending.erase(0, end);
+    return out;
+}
+
+void test_stream_snapshot_then_deltas() {
+    const char* name = "test_stream_snapshot_then_deltas";
+    RestApiServer server(0, "127.0.0.1", 2);
+    expect(server.start(), name, "start");
+
+    Telemetry m;
+    m.hydration_pct = 55.0;
+    m.heart_rate_bpm = 80.0;
+    server.update_telemetry(m);
+
+    int fd = connect_to(server.port());
+    std::string pending;
+    send_all(fd, "GET /api/stream HTTP/1.1\r\nAccept: text/event-stream\r\n\r\n");
+    std::string head = read_stream_until(fd, pending, "\r\n\r\n");
+    expect(head.rfind("HTTP/1.1 200", 0) == 0 &&
+           header_value(head, "Content-Type") == "text/event-stream",
+           name, "stream headers: " + head);
+
+    // First event is the full snapshot.
+    std::string first = read_stream_until(fd, pending, "\n\n");  // retry hint
+    first = read_stream_until(fd, pending, "\n\n");
+    expect(first.find("event: snapshot") != std::string::npos &&
+           first.find("\"state\":{") != std::string::npos &&
+           first.find("\"heart_rate_bpm\":80.00") != std::string::npos,
+           name, "initial snapshot: " + first);
+
+    // One changed field: the delta carries it and nothing else.
+    m.heart_rate_bpm = 91.0;
+    server.update_telemetry(m);
+    std::string delta = read_stream_until(fd, pending, "\n\n");
+    expect(delta.find("event: delta") != std::string::npos &&
+           delta.find("\"heart_rate_bpm\":91.00") != std::string::npos, name, "delta: " + delta);
+    expect(delta.find("hydration_pct") == std::string::npos &&
+           delta.find("\"state\"") == std::string::npos &&
+           delta.find("\"control\"") == std::string::npos,
+           name, "delta carried unchanged fields: " + delta);
+
+    RestApiServer::StreamMetrics metrics = server.stream_metrics();
+    expect(metrics.clients == 1 && metrics.frames_sent >= 2, name, "stream metrics");
+
+    // Ordinary requests keep working alongside a subscriber.
+    int other = connect_to(server.port());
+    std::string other_pending;
+    send_all(other, "GET /api/metrics HTTP/1.1\r\n\r\n");
+    std::string report = read_response(other, other_pending);
+    expect(report.find("\"streams\":{\"clients\":1") != std::string::npos, name, "metrics: " + report);
+    close(other);
+
+    close(fd);
+    server.stop();
+    std::cout << name << " passed\n";
+}
+
+void test_stream_backpressure_resyncs() {
+    const char* name = "test_stream_backpressure_resyncs";
+    RestApiServer server(0, "127.0.0.1", 2);
+    expect(server.start(), name, "start");
+
+    int fd = connect_to(server.port());
+    std::string pending;
+    send_all(fd, "GET /api/stream HTTP/1.1\r\n\r\n");
+
+    // Never read: the server-side backlog grows until deltas are dropped.
+    std::string rationale(500, 'x');
+    int tick = 0;
+    for (int attempt = 0; attempt < 20000 && server.stream_metrics().frames_dropped == 0; ++attempt) {
+        for (int i = 0; i < 50; ++i) {
+            rationale[static_cast<size_t>(tick % 500)] = static_cast<char>('a' + tick % 26);
+            server.update_control_output(0.1 + 0.001 * (tick % 100), rationale);
+            ++tick;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    expect(server.stream_metrics().frames_dropped > 0, name, "no frames dropped");
+
+    // Drain while publishing: the client must get a fresh snapshot.
+    read_stream_until(fd, pending, "event: snapshot");  // the initial one
+    bool resynced = false;
+    char buf[65536];
+    for (int attempt = 0; attempt < 20000 && !resynced; ++attempt) {
+        server.update_control_output(0.2 + 0.001 * (attempt % 100), "drain " + std::to_string(attempt));
+        ssize_t n = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (n > 0) pending.append(buf, static_cast<size_t>(n));
+        if (n == 0) break;
+        resynced = pending.find("event: snapshot") != std::string::npos;
+        if (n < 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    expect(resynced && server.stream_metrics().resyncs > 0, name, "no resync snapshot");
+
+    close(fd);
+    server.stop();
+    std::cout << name << " passed\n";
+}
+
+void test_loop_metrics_endpoint() {
+    const char* name = "test_loop_metrics_endpoint";
+    RestApiServer server(0, "127.0.0.1", 1);
+    expect(server.start(), name, "start");
+    int fd = connect_to(server.port());
+    std::string pending;
+
+    send_all(fd, "GET /api/metrics/loop HTTP/1.1\r\n\r\n");
+    std::string body = read_response(fd, pending);
+    expect(body.find("{\"enabled\":false}") != std::string::npos, name, "unregistered: " + body);
+
+    // Every stage a cycle times must be recorded once per step.
+    ControlLoopMetrics metrics(std::chrono::milliseconds(200));
+    PatientProfile profile;
+    profile.weight_kg = 75.0;
+    profile.age_years = 35.0;
+    profile.baseline_hr_bpm = 70.0;
+    profile.max_safe_infusion_rate = 1.5;
+    profile.current_tissue_perfusion = 0.85;
+    {
+        PatientControlCycle cycle(profile, "loop_metrics_test", LoggerMode::Sync, SessionFormat::Binary);
+        cycle.set_loop_metrics(&metrics);
+        for (int i = 0; i < 20; ++i) {
+            Telemetry m;
+            m.hydration_pct = 65.0;
+            m.heart_rate_bpm = 75.0;
+            m.spo2_pct = 97.0;
+            m.signal_quality = 0.9;
+            StageClock stages(&metrics);
+            stages.lap(LoopStage::Acquire);
+            cycle.step(m, 0.2);
+            metrics.record_tick(std::chrono::milliseconds(1), std::chrono::microseconds(i == 3 ? 250000 : 10),
+                                i == 3, i == 3 ? 1 : 0);
+        }
+    }
+    ControlLoopMetrics::Snapshot snap = metrics.snapshot();
+    for (LoopStage stage : {LoopStage::Acquire, LoopStage::Vault, LoopStage::Estimate,
+                            LoopStage::Spine, LoopStage::Decide, LoopStage::Log}) {
+        expect(snap.stage(stage).count == 20, name,
+               std::string("stage ") + ControlLoopMetrics::stage_name(stage));
+    }
+    expect(snap.stage(LoopStage::Publish).count == 0, name, "publish stage recorded without a publish");
+    expect(snap.ticks == 20 && snap.overruns == 1 && snap.skipped_periods == 1, name, "tick counters");
+
+    LoopScheduling sched;
+    sched.realtime = true;
+    sched.cpu = 2;
+    sched.fifo_priority = 80;
+    sched.spin_ns = 250000;
+    metrics.set_scheduling(sched);
+    server.set_loop_metrics(&metrics);
+    send_all(fd, "GET /api/metrics/loop HTTP/1.1\r\nConnection: close\r\n\r\n");
+    body = read_response(fd, pending);
+    expect(body.rfind("HTTP/1.1 200", 0) == 0, name, "status: " + body);
+    expect(body.find("\"scheduling\":{\"realtime\":true,\"cpu\":2,\"policy\":\"fifo\",\"priority\":80,"
+                     "\"memory_locked\":false,\"spin_us\":250.000},") != std::string::npos,
+           name, "scheduling: " + body);
+    expect(body.find("{\"enabled\":true,\"period_ms\":200.000,\"scheduling\":") != std::string::npos &&
+           body.find("\"ticks\":20,\"overruns\":1,"
+                     "\"skipped_periods\":1,") != std::string::npos &&
+           body.find("\"estimate\":{\"count\":20,") != std::string::npos &&
+           body.find("\"publish\":{\"count\":0,") != std::string::npos &&
+           body.find("\"jitter\":{\"count\":20,") != std::string::npos,
+           name, "body: " + body);
+    close(fd);
+    server.set_loop_metrics(nullptr);
+    server.stop();
+    std::cout << name << " passed\n";
+}
+
+void test_prediction_endpoint() {
+    const char* name = "test_prediction_endpoint";
+    RestApiServer server(0, "127.0.0.1", 1);
+    expect(server.start(), name, "start");
+
+    int fd = connect_to(server.port());
+    std::string pending;
+    send_all(fd, "GET /api/prediction HTTP/1.1\r\n\r\n");
+    std::string empty = read_response(fd, pending);
+    expect(empty.find("\"available\":false,\"horizons\":[]") != std::string::npos, name,
+           "before first publish: " + empty);
+
+    ForwardPredictor predictor;
+    for (int i = 0; i < 20; ++i) {
+        PatientState st;
+        st.hydration_pct = 70.0 - 0.5 * i;
+        st.energy_T = 0.6;
+        predictor.update(st);
+    }
+    const int horizons[] = {5, 30};
+    ForwardPrediction predictions[2];
+    server.update_prediction(predictions, predictor.predict(horizons, 2, predictions));
+
+    send_all(fd, "GET /api/prediction HTTP/1.1\r\n\r\n");
+    std::string body = read_response(fd, pending);
+    std::string etag = header_value(body, "ETag");
+    expect(body.rfind("HTTP/1.1 200", 0) == 0 && !etag.empty(), name, "no ETag: " + body);
+    expect(body.find("\"available\":true") != std::string::npos &&
+           body.find("{\"steps\":5,\"seconds\":1.0,") != std::string::npos &&
+           body.find("{\"steps\":30,\"seconds\":6.0,") != std::string::npos, name, "horizons: " + body);
+    std::string h30 = body.substr(body.find("{\"steps\":30,\"seconds\":6.0,"));
+    double hydration30 = std::atof(h30.c_str() + h30.find("\"hydration_pct\":") + 16);
+    expect(std::abs(hydration30 - predictions[1].state.hydration_pct) < 1e-3 && hydration30 < 60.5,
+           name, "30-step hydration: " + h30);
+
+    send_all(fd, "GET /api/prediction HTTP/1.1\r\nIf-None-Match: " + etag + "\r\n\r\n");
+    expect(read_response(fd, pending).rfind("HTTP/1.1 304", 0) == 0, name, "not revalidated");
+    close(fd);
+
+    server.stop();
+    std::cout << name << " passed\n";
+}
+
+void test_telemetry_range_endpoint() {
+    const char* name = "test_telemetry_range_endpoint";
+    RestApiServer server(0, "127.0.0.1", 1);
+    expect(server.start(), name, "start");
+    int fd = connect_to(server.port());
+    std::string pending;
+
+    send_all(fd, "GET /api/telemetry/range HTTP/1.1\r\n\r\n");
+    std::string disabled = read_response(fd, pending);
+    expect(disabled.find("{\"enabled\":false}") != std::string::npos, name, "without a store: " + disabled);
+
+    // Two hours at 5 Hz on a virtual clock
+    TimeSeriesStore store;
+    server.set_timeseries(&store);
+    const std::int64_t t0 = 1700000400000;
+    Telemetry m;
+    for (std::int64_t i = 0; i < 2 * 60 * 60 * 5; ++i) {
+        m.heart_rate_bpm = 60.0 + static_cast<double>(i % 300) / 10.0;
+        m.hydration_pct = 65.0;
+        store.append(t0 + i * 200, m, 0.5);
+    }
+
+    std::string path = "/api/telemetry/range?from=" + std::to_string(t0 + 60 * 60 * 1000) +
+                       "&to=" + std::to_string(t0 + 70 * 60 * 1000 - 1) + "&resolution=1m";
+    send_all(fd, "GET " + path + " HTTP/1.1\r\n\r\n");
+    std::string minutes = read_response(fd, pending);
+    expect(minutes.rfind("HTTP/1.1 200", 0) == 0 &&
+           minutes.find("\"resolution\":\"1m\",\"auto\":false,\"bucket_ms\":60000") != std::string::npos &&
+           minutes.find("\"complete\":true,\"count\":10,") != std::string::npos, name, "1m range: " + minutes);
+    // The heart rate ramps 60.0..89.9 once a minute
+    expect(minutes.find("\"heart_rate_bpm\":{\"min\":[60.000,") != std::string::npos &&
+           minutes.find("\"mean\":[74.950,") != std::string::npos &&
+           minutes.find("\"max\":[89.900,") != std::string::npos &&
+           minutes.find("\"infusion_ml_min\":{\"min\":[0.500,") != std::string::npos, name,
+           "1m rollups: " + minutes);
+
+    // Defaults: the last hour at the finest tier that holds it
+    send_all(fd, "GET /api/telemetry/range HTTP/1.1\r\n\r\n");
+    std::string automatic = read_response(fd, pending);
+    expect(automatic.find("\"resolution\":\"1s\",\"auto\":true") != std::string::npos &&
+           automatic.find("\"to_ms\":" + std::to_string(store.latest_ms()) + ",") != std::string::npos,
+           name, "auto: " + automatic.substr(0, 300));
+
+    // Extreme bounds: empty ranges, not overflow
+    for (const char* edge : {"?to=-9223372036854775808", "?from=-9223372036854775808&to=9223372036854775807"}) {
+        send_all(fd, std::string("GET /api/telemetry/range") + edge + " HTTP/1.1\r\n\r\n");
+        std::string extreme = read_response(fd, pending);
+        expect(extreme.rfind("HTTP/1.1 200", 0) == 0 && extreme.find("\"enabled\":true") != std::string::npos,
+               name, std::string(edge) + ": " + extreme.substr(0, 300));
+    }
+
+    for (const char* bad : {"?from=abc", "?from=10&to=5", "?resolution=5m"}) {
+        send_all(fd, std::string("GET /api/telemetry/range") + bad + " HTTP/1.1\r\n\r\n");
+        std::string rejected = read_response(fd, pending);
+        expect(rejected.rfind("HTTP/1.1 400", 0) == 0 && rejected.find("\"error\"") != std::string::npos,
+               name, std::string(bad) + ": " + rejected);
+    }
+
+    send_all(fd, "GET /api/metrics HTTP/1.1\r\n\r\n");
+    std::string metrics = read_response(fd, pending);
+    expect(metrics.find("\"timeseries\":{\"enabled\":true,\"samples\":36000,\"memory_bytes\":" +
+                        std::to_string(store.memory_bytes()) + "}") != std::string::npos,
+           name, "metrics: " + metrics);
+    close(fd);
+
+    server.stop();
+    server.set_timeseries(nullptr);
+    std::cout << name << " passed\n";
+}
+
+int main() {
+    test_latency_histogram_buckets();
+    test_json_fixed_matches_ostream();
+    test_seqlock_readers_see_whole_records();
+    test_keep_alive_and_pipelining();
+    test_slow_client_does_not_stall_others();
+    test_snapshot_publication_and_metrics();
+    test_etag_and_history_chunks();
+    test_stream_snapshot_then_deltas();
+    test_stream_backpressure_resyncs();
+    test_loop_metrics_endpoint();
+    test_prediction_endpoint();
+    test_telemetry_range_endpoint();
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include "../src/RingBuffer.hpp"
+#include <iostream>
+#include <cmath>
+#include <random>
+#include <deque>
+
+using namespace ivsys;
+
+void test_ring_buffer_overwrite() {
+    RingBuffer<int, 4> ring;
+    for (int i = 0; i < 10; ++i) ring.push_back(i);
+
+    if (ring.size() != 4 || ring.front() != 6 || ring.back() != 9) {
+        std::cerr << "test_ring_buffer_overwrite failed: expected window [6..9]\n";
+        exit(1);
+    }
+    int expected = 6;
+    for (int v : ring) {
+        if (v != expected++) {
+            std::cerr << "test_ring_buffer_overwrite failed: iteration order\n";
+            exit(1);
+        }
+    }
+
+    std::cout << "test_ring_buffer_overwrite passed\n";
+}
+
+void test_rolling_stats_match_direct() {
+    std::mt19937 rng(3);
+    std::normal_distribution<double> hr(80.0, 25.0);
+
+    RollingStats<20> stats;
+    std::deque<double> ref;
+
+    // Run well past the resync interval to cover drift correction.
+    for (int i = 0; i < 5000; ++i) {
+        double x = hr(rng) + 0.01 * i;
+        stats.push(x);
+        ref.push_back(x);
+        if (ref.size() > 20) ref.pop_front();
+
+        double n = static_cast<double>(ref.size());
+        double mean = 0.0;
+        for (double v : ref) mean += v;
+        mean /= n;
+        double var = 0.0;
+        for (double v : ref) var += (v - mean) * (v - mean);
+        var /= n;
+
+        double slope = 0.0;
+        if (ref.size() >= 2) {
+            double kbar = (n - 1.0) / 2.0, num = 0.0, den = 0.0;
+            for (size_t k = 0; k < ref.size(); ++k) {
+                num += (k - kbar) * (ref[k] - mean);
+                den += (k - kbar) * (k - kbar);
+            }
+            slope = num / den;
+        }
+
+        if (std::abs(stats.mean() - mean) > 1e-9 ||
+            std::abs(stats.variance() - var) > 1e-7 ||
+            std::abs(stats.trend() - slope) > 1e-7) {
+            std::cerr << "test_rolling_stats_match_direct failed at sample " << i
+                      << ": mean " << stats.mean() << " vs " << mean
+                      << ", var " << stats.variance() << " vs " << var
+                      << ", trend " << stats.trend() << " vs " << slope << "\n";
+            exit(1);
+        }
+    }
+
+    std::cout << "test_rolling_stats_match_direct passed\n";
+}
+
+void test_rolling_stats_recover_from_non_finite() {
+    const double bad[] = {std::nan(""), HUGE_VAL, -HUGE_VAL};
+    for (double x : bad) {
+        RollingStats<5> stats;
+        for (int i = 0; i < 10; ++i) stats.push(70.0 + i);
+        stats.push(x);
+        if (std::isfinite(stats.mean())) {
+            std::cerr << "test_rolling_stats_recover_from_non_finite failed: " << x
+                      << " in the window left the mean finite\n";
+            exit(1);
+        }
+        // Once the sample has left the window the statistics are exact again,
+        // long before the periodic resync.
+        for (int i = 0; i < 5; ++i) stats.push(i % 2 ? 90.0 : 50.0);
+        double mean = (50.0 * 3 + 90.0 * 2) / 5.0;
+        double var = (3 * (50.0 - mean) * (50.0 - mean) + 2 * (90.0 - mean) * (90.0 - mean)) / 5.0;
+        if (std::abs(stats.mean() - mean) > 1e-9 || std::abs(stats.variance() - var) > 1e-7 ||
+            !std::isfinite(stats.trend()) || !std::isfinite(stats.mean_squared_deviation(70.0))) {
+            std::cerr << "test_rolling_stats_recover_from_non_finite failed: after " << x
+                      << " mean " << stats.mean() << " var " << stats.variance()
+                      << " trend " << stats.trend() << "\n";
+            exit(1);
+        }
+    }
+
+    std::cout << "test_rolling_stats_recover_from_non_finite passed\n";
+}
+
+int main() {
+    test_ring_buffer_overwrite();
+    test_rolling_stats_match_direct();
+    test_rolling_stats_recover_from_non_finite();
+    return 0;
+}
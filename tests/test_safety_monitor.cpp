@@ -34,7 +34,7 @@ void test_volume_limit() {
         std::cerr << "test_volume_limit failed: max_allowed_rate " << check.max_allowed_rate << " > 0.3\n";
         exit(1);
     }
-    if (check.warnings.find("VOLUME_LIMIT_APPROACH") == std::string::npos) {
+    if (!check.warnings.has(WarningFlag::VolumeLimitApproach)) {
          std::cerr << "test_volume_limit failed: warning missing\n";
          exit(1);
     }
@@ -63,7 +63,7 @@ void test_cardiac_reserve() {
         std::cerr << "test_cardiac_reserve failed: max_allowed_rate " << check.max_allowed_rate << " > 0.5\n";
         exit(1);
     }
-    if (check.warnings.find("LOW_CARDIAC_RESERVE") == std::string::npos) {
+    if (!check.warnings.has(WarningFlag::LowCardiacReserve)) {
          std::cerr << "test_cardiac_reserve failed: warning missing\n";
          exit(1);
     }
@@ -71,8 +71,70 @@ void test_cardiac_reserve() {
     std::cout << "test_cardiac_reserve passed\n";
 }
 
+// Found by ai_iv_fuzz: a 3 kg renal patient over one long step used to be
+// allowed the 0.3 ml/min volume cap past the 24h limit.
+void test_volume_limit_is_hard() {
+    PatientProfile profile;
+    profile.weight_kg = 3.0;
+    profile.renal_impairment = true;
+    profile.max_safe_infusion_rate = 1.5;
+
+    SafetyMonitor monitor(profile);
+    // Max volume = 3 * 35 * 0.6 = 63 ml
+    monitor.update_volume(1.0, 60.0);
+
+    PatientState state;
+    state.cardiac_reserve = 1.0;
+    state.risk_score = 0.0;
+    state.heart_rate_bpm = 70.0;
+    state.hydration_pct = 90.0;
+
+    // 3 ml left; a 60 minute step may use at most 0.05 ml/min
+    auto check = monitor.evaluate(1.0, state, 60.0);
+    if (std::abs(check.max_allowed_rate - 0.05) > 1e-12) {
+        std::cerr << "test_volume_limit_is_hard failed: max_allowed_rate " << check.max_allowed_rate << "\n";
+        exit(1);
+    }
+    monitor.update_volume(check.max_allowed_rate, 60.0);
+    if (monitor.get_cumulative_volume() > monitor.get_max_volume_24h() + 1e-9) {
+        std::cerr << "test_volume_limit_is_hard failed: 24h limit exceeded\n";
+        exit(1);
+    }
+
+    std::cout << "test_volume_limit_is_hard passed\n";
+}
+
+// Found by ai_iv_fuzz: the emergency floor used to exceed a profile
+// maximum below EMERGENCY_MIN_RATE.
+void test_emergency_floor_respects_profile_max() {
+    PatientProfile profile;
+    profile.weight_kg = 70.0;
+    profile.max_safe_infusion_rate = 0.05;
+
+    SafetyMonitor monitor(profile);
+    monitor.update_volume(100.0, 24.5); // the whole 2450 ml: nothing left to allow
+
+    PatientState state;
+    state.cardiac_reserve = 1.0;
+    state.risk_score = 0.0;
+    state.heart_rate_bpm = 70.0;
+    state.hydration_pct = 40.0;
+
+    auto check = monitor.evaluate(1.0, state, 1.0);
+    if (check.max_allowed_rate > profile.max_safe_infusion_rate ||
+        !check.warnings.has(WarningFlag::EmergencyMinRate)) {
+        std::cerr << "test_emergency_floor_respects_profile_max failed: max_allowed_rate "
+                  << check.max_allowed_rate << "\n";
+        exit(1);
+    }
+
+    std::cout << "test_emergency_floor_respects_profile_max passed\n";
+}
+
 int main() {
     test_volume_limit();
     test_cardiac_reserve();
+    test_volume_limit_is_hard();
+    test_emergency_floor_respects_profile_max();
     return 0;
 }
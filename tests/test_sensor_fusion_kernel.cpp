@@ -0,0 +1,228 @@
+#include "../src/SensorFusionKernel.hpp"
+#include "test_support.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#ifndef NEURAL_MODEL_PATH
+#define NEURAL_MODEL_PATH "models/sensor_fusion_fdeep.json"
+#endif
+
+using namespace ivsys;
+
+static std::string read_model_text() {
+    std::ifstream in(NEURAL_MODEL_PATH);
+    std::ostringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+void test_load_checks_embedded_vectors() {
+    const char* name = "test_load_checks_embedded_vectors";
+    SensorFusionKernel kernel;
+    kernel.load(NEURAL_MODEL_PATH);
+    if (!kernel.is_loaded() || kernel.load_check_samples() == 0) fail(name, "no test vectors checked");
+    if (kernel.load_check_error() > SensorFusionKernel::kVerifyTolerance) fail(name, "check error");
+
+    // Same expectations as the fdeep-backed estimator tests.
+    float healthy = kernel.predict(0.80f, 0.375f, 0.98f, 0.10f, 0.30f);
+    float stressed = kernel.predict(0.40f, 0.65f, 0.84f, 0.40f, 0.90f);
+    if (!(healthy > 0.6f && healthy <= 1.0f)) fail(name, "healthy E_T " + std::to_string(healthy));
+    if (!(stressed < 0.5f && stressed >= 0.0f)) fail(name, "stressed E_T " + std::to_string(stressed));
+    std::cout << name << " passed\n";
+}
+
+void test_batch_matches_single() {
+    const char* name = "test_batch_matches_single";
+    SensorFusionKernel kernel;
+    kernel.load(NEURAL_MODEL_PATH);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    // Every tail length around the lane width, plus a long run.
+    for (size_t count : {size_t{1}, size_t{2}, size_t{3}, size_t{4}, size_t{5}, size_t{7},
+                         size_t{8}, size_t{9}, size_t{1001}}) {
+        std::vector<float> inputs(count * SensorFusionKernel::kInputs);
+        for (float& x : inputs) x = u(rng);
+        std::vector<float> outputs(count, -1.0f);
+        kernel.predict_batch(inputs.data(), count, outputs.data());
+        for (size_t s = 0; s < count; ++s) {
+            float single = kernel.predict(&inputs[s * SensorFusionKernel::kInputs]);
+            if (std::fabs(single - outputs[s]) > 1e-6f) {
+                fail(name, "row " + std::to_string(s) + " of " + std::to_string(count));
+            }
+        }
+    }
+    kernel.predict_batch(nullptr, 0, nullptr);  // empty batch is a no-op
+    std::cout << name << " passed\n";
+}
+
+void test_rejects_bad_models() {
+    const char* name = "test_rejects_bad_models";
+    const std::string good = read_model_text();
+    if (good.empty()) fail(name, "could not read " NEURAL_MODEL_PATH);
+
+    auto rejects = [](const std::string& text) {
+        SensorFusionKernel kernel;
+        try {
+            kernel.load_from_json(text);
+        } catch (const std::runtime_error&) {
+            return !kernel.is_loaded();
+        }
+        return false;
+    };
+
+    if (!rejects("{\"trainable_params\": {")) fail(name, "truncated JSON accepted");
+    if (!rejects("{\"trainable_params\": {}}")) fail(name, "missing layers accepted");
+
+    // Corrupt the output bias: shapes still match, but the embedded test
+    // vector no longer does.
+    std::string tampered = good;
+    size_t pos = tampered.find("\"energy_output\"", tampered.find("\"trainable_params\""));
+    pos = tampered.find("\"bias\"", pos);
+    pos = tampered.find('"', tampered.find('[', pos)) + 1;
+    tampered.replace(pos, tampered.find('"', pos) - pos, "AACAPw==");  // 1.0f
+    if (!rejects(tampered)) fail(name, "tampered bias accepted");
+
+    SensorFusionKernel unloaded;
+    try {
+        unloaded.predict(0.5f, 0.5f, 0.5f, 0.5f, 0.5f);
+        fail(name, "predict before load did not throw");
+    } catch (const std::runtime_error&) {
+    }
+    try {
+        unloaded.load("models/does_not_exist.json");
+        fail(name, "missing file did not throw");
+    } catch (const std::runtime_error&) {
+    }
+    std::cout << name << " passed\n";
+}
+
+// A blob predicts bit-for-bit what the JSON it was packed from does.
+void test_blob_round_trip() {
+    const char* name = "test_blob_round_trip";
+    SensorFusionKernel json;
+    json.load(NEURAL_MODEL_PATH);
+    const std::string path = "ai_iv_test_model.aimb";
+    json.write_blob(path);
+
+    SensorFusionKernel blob;
+    blob.load_blob(path);
+    std::remove(path.c_str());
+    if (!blob.is_loaded() || blob.load_check_samples() != json.load_check_samples()) {
+        fail(name, "test vectors not carried over");
+    }
+    if (blob.to_blob() != json.to_blob()) fail(name, "re-packed blob differs");
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    for (int i = 0; i < 10000; ++i) {
+        float x[SensorFusionKernel::kInputs];
+        for (float& v : x) v = u(rng);
+        float a = json.predict(x), b = blob.predict(x);
+        if (std::memcmp(&a, &b, sizeof(a)) != 0) fail(name, "prediction differs at sample " + std::to_string(i));
+    }
+
+    if (SensorFusionKernel::blob_path_for("models/m.json") != "models/m.aimb" ||
+        SensorFusionKernel::blob_path_for("m") != "m.aimb") {
+        fail(name, "blob_path_for");
+    }
+    std::cout << name << " passed\n";
+}
+
+// The blob committed next to the JSON model must be in step with it.
+void test_committed_blob_matches_json() {
+    const char* name = "test_committed_blob_matches_json";
+    SensorFusionKernel json, blob;
+    json.load(NEURAL_MODEL_PATH);
+    try {
+        blob.load_blob(SensorFusionKernel::blob_path_for(NEURAL_MODEL_PATH), NEURAL_MODEL_PATH);
+    } catch (const std::runtime_error& e) {
+        fail(name, std::string(e.what()) + "; run make model-blob");
+    }
+    if (blob.to_blob() != json.to_blob()) fail(name, "blob differs from the JSON");
+    if (blob.source_checksum() == 0 || blob.source_checksum() != json.source_checksum()) {
+        fail(name, "source checksum");
+    }
+
+    // The same blob against a retrained (here: reformatted) JSON is stale
+    const std::string retrained = "ai_iv_test_retrained.json";
+    {
+        std::ofstream out(retrained, std::ios::binary);
+        out << read_model_text() << "\n";
+    }
+    bool stale = false;
+    try {
+        SensorFusionKernel again;
+        again.load_blob(SensorFusionKernel::blob_path_for(NEURAL_MODEL_PATH), retrained);
+    } catch (const std::runtime_error&) {
+        stale = true;
+    }
+    std::remove(retrained.c_str());
+    if (!stale) fail(name, "stale blob accepted");
+    std::cout << name << " passed\n";
+}
+
+void test_rejects_bad_blobs() {
+    const char* name = "test_rejects_bad_blobs";
+    SensorFusionKernel json;
+    json.load(NEURAL_MODEL_PATH);
+    const std::string good = json.to_blob();
+    const size_t header = sizeof(SensorFusionKernel::BlobHeader);
+
+    auto rejects = [](const std::string& blob) {
+        SensorFusionKernel kernel;
+        try {
+            kernel.load_from_blob(blob.data(), blob.size());
+        } catch (const std::runtime_error&) {
+            return !kernel.is_loaded();
+        }
+        return false;
+    };
+    auto with_u32 = [&](size_t offset, std::uint32_t value) {
+        std::string b = good;
+        std::memcpy(&b[offset], &value, sizeof(value));
+        return b;
+    };
+
+    if (rejects(good)) fail(name, "good blob rejected");
+    if (!rejects(good.substr(0, header - 1))) fail(name, "truncated header accepted");
+    if (!rejects(good.substr(0, good.size() - 4))) fail(name, "truncated payload accepted");
+    if (!rejects(good + "xxxx")) fail(name, "trailing bytes accepted");
+    std::string magic = good;
+    magic[0] = 'X';
+    if (!rejects(magic)) fail(name, "bad magic accepted");
+    if (!rejects(with_u32(offsetof(SensorFusionKernel::BlobHeader, version), 2))) fail(name, "version 2 accepted");
+    if (!rejects(with_u32(offsetof(SensorFusionKernel::BlobHeader, hidden1), 32))) fail(name, "shape accepted");
+
+    // One flipped weight bit: caught by the checksum before the weights are used
+    std::string flipped = good;
+    flipped[header + 17] ^= 0x01;
+    if (!rejects(flipped)) fail(name, "checksum mismatch accepted");
+
+    try {
+        SensorFusionKernel missing;
+        missing.load_blob("models/does_not_exist.aimb");
+        fail(name, "missing file did not throw");
+    } catch (const std::runtime_error&) {
+    }
+    std::cout << name << " passed\n";
+}
+
+int main() {
+    test_load_checks_embedded_vectors();
+    test_batch_matches_single();
+    test_rejects_bad_models();
+    test_blob_round_trip();
+    test_committed_blob_matches_json();
+    test_rejects_bad_blobs();
+    return 0;
+}
@@ -0,0 +1,315 @@
+#include "../src/SystemLogger.hpp"
+#include "../src/session_format.hpp"
+#include "../src/AdaptiveController.hpp"
+#include "../src/control_text.hpp"
+#include "test_support.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+using namespace ivsys;
+using namespace ivsys::session_format;
+
+static std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+static std::chrono::steady_clock::time_point tick_time(int i) {
+    return std::chrono::steady_clock::time_point(std::chrono::seconds(1000)) +
+           std::chrono::milliseconds(200 * i);
+}
+
+static Telemetry make_telemetry(int i) {
+    Telemetry m;
+    m.timestamp = tick_time(i);
+    m.hydration_pct = 60.0 + i * 0.013;
+    m.heart_rate_bpm = 72.0 + (i % 7) * 0.37;
+    m.temp_celsius = 37.0 + (i % 5) * 0.01;
+    m.signal_quality = 0.95;
+    m.spo2_pct = 97.5;
+    m.lactate_mmol = 1.2 + i * 1e-4;
+    m.vault_mesh_size_nm = 8.0 + i * 0.001;
+    m.vault_payload_pct = 100.0 - i * 0.01;
+    m.vault_cage_breached = i > 700;
+    return m;
+}
+
+void test_binary_converts_to_identical_csv() {
+    const int ticks = 1300;   // two full blocks plus a partial one
+    {
+        SystemLogger logger("session_format_test", LoggerMode::Sync,
+                            SystemLogger::kDefaultQueueCapacity, SessionFormat::Both);
+        for (int i = 0; i < ticks; ++i) {
+            Telemetry m = make_telemetry(i);
+            logger.log_telemetry(m);
+
+            PatientState state;
+            state.hydration_pct = m.hydration_pct;
+            state.heart_rate_bpm = m.heart_rate_bpm;
+            state.coherence_sigma = 0.8;
+            state.energy_T = 0.6 + i * 1e-4;
+            state.energy_T_absolute = 1.7;
+            state.cardiac_reserve = 0.5;
+            state.risk_score = 0.2;
+            state.estimated_flow_velocity_cm_s = 19.5;
+            state.flow_efficiency = 0.99;
+            ControlOutput out;
+            out.infusion_ml_per_min = 0.4 + (i % 13) * 0.01;
+            out.confidence = 0.9;
+            if (i % 10 == 0) {
+                out.warning_flags.set(WarningFlag::RateChangeLimited);
+                out.warning_flags.set(WarningFlag::HighRiskState);
+            }
+            out.rationale = AdaptiveController::make_rationale(
+                state, out.infusion_ml_per_min, i % 10 == 0, i % 3 == 0);
+            logger.log_control(out, state, m.timestamp);
+        }
+    }
+
+    size_t size = 0;
+    auto buffer = load_file(std::string("ai_iv_session_format_test") + kFileSuffix, size);
+    SessionReader reader(buffer.data(), size);
+    if (!reader.indexed() || reader.session_id() != "session_format_test" ||
+        reader.header().schema_version != kSchemaVersion) {
+        std::cerr << "test_binary_converts_to_identical_csv failed: bad header/index\n";
+        exit(1);
+    }
+
+    std::ostringstream telemetry, control;
+    telemetry << SystemLogger::kTelemetryCsvHeader;
+    for (const auto& m : reader.all_telemetry()) SystemLogger::write_telemetry_row(telemetry, m);
+    control << SystemLogger::kControlCsvHeader;
+    for (const auto& s : reader.all_control()) {
+        SystemLogger::write_control_row(control, s.output, s.state, s.t);
+    }
+
+    if (telemetry.str() != read_file("ai_iv_session_format_test_telemetry.csv")) {
+        std::cerr << "test_binary_converts_to_identical_csv failed: telemetry differs\n";
+        exit(1);
+    }
+    if (control.str() != read_file("ai_iv_session_format_test_control.csv")) {
+        std::cerr << "test_binary_converts_to_identical_csv failed: control differs\n";
+        exit(1);
+    }
+
+    std::cout << "test_binary_converts_to_identical_csv passed\n";
+}
+
+void test_block_index_by_timestamp() {
+    const std::string path = "ai_iv_session_index_test" + std::string(kFileSuffix);
+    {
+        SessionWriter writer(path, "session_index_test", 10);
+        for (int i = 0; i < 95; ++i) writer.append_telemetry(make_telemetry(i));
+    }
+
+    size_t size = 0;
+    auto buffer = load_file(path, size);
+    SessionReader reader(buffer.data(), size);
+    if (reader.blocks().size() != 10) {
+        std::cerr << "test_block_index_by_timestamp failed: expected 10 blocks, got "
+                  << reader.blocks().size() << "\n";
+        exit(1);
+    }
+
+    // Ticks 25..34 span blocks 2 and 3.
+    auto hits = reader.blocks_in_range(RecordType::Telemetry,
+                                       to_ns(tick_time(25)), to_ns(tick_time(34)));
+    if (hits.size() != 2 || hits[0] != 2 || hits[1] != 3) {
+        std::cerr << "test_block_index_by_timestamp failed: wrong range hits\n";
+        exit(1);
+    }
+    if (!reader.blocks_in_range(RecordType::Control, 0, to_ns(tick_time(100))).empty()) {
+        std::cerr << "test_block_index_by_timestamp failed: control blocks reported\n";
+        exit(1);
+    }
+
+    // Column access reads one field without assembling rows.
+    const double* hr = reader.column(hits[0], 2);
+    if (hr[5] != make_telemetry(25).heart_rate_bpm ||
+        reader.timestamps(hits[0])[5] != to_ns(tick_time(25))) {
+        std::cerr << "test_block_index_by_timestamp failed: column value mismatch\n";
+        exit(1);
+    }
+
+    std::cout << "test_block_index_by_timestamp passed\n";
+}
+
+void test_recovers_unclosed_file() {
+    const std::string path = "ai_iv_session_torn_test" + std::string(kFileSuffix);
+    {
+        SessionWriter writer(path, "session_torn_test", 16);
+        for (int i = 0; i < 40; ++i) writer.append_telemetry(make_telemetry(i));
+    }
+
+    // Drop the index and trailer and tear the last block in half, as if the
+    // process died mid-write.
+    std::string bytes = read_file(path);
+    size_t index_bytes = 3 * sizeof(IndexEntry) + sizeof(Trailer);
+    size_t last_block = sizeof(BlockHeader) + 8 * kTelemetryColumns * 8;
+    bytes.resize(bytes.size() - index_bytes - last_block / 2);
+
+    std::vector<std::uint64_t> buffer((bytes.size() + 7) / 8);
+    std::memcpy(buffer.data(), bytes.data(), bytes.size());
+    SessionReader reader(buffer.data(), bytes.size());
+    auto rows = reader.all_telemetry();
+    if (reader.indexed() || reader.blocks().size() != 2 || rows.size() != 32 ||
+        rows[31].heart_rate_bpm != make_telemetry(31).heart_rate_bpm) {
+        std::cerr << "test_recovers_unclosed_file failed: recovered "
+                  << reader.blocks().size() << " blocks, " << rows.size() << " rows\n";
+        exit(1);
+    }
+
+    std::cout << "test_recovers_unclosed_file passed\n";
+}
+
+// Index entries and trailers that would read outside the file are refused
+// (or, for a bad trailer, ignored in favour of a block scan).
+void test_rejects_corrupt_index() {
+    const std::string path = "ai_iv_session_corrupt_test" + std::string(kFileSuffix);
+    {
+        SessionWriter writer(path, "session_corrupt_test", 16);
+        for (int i = 0; i < 40; ++i) writer.append_telemetry(make_telemetry(i));
+    }
+    const std::string good = read_file(path);
+    std::remove(path.c_str());
+    const size_t index_offset = good.size() - sizeof(Trailer) - 3 * sizeof(IndexEntry);
+
+    auto open = [](const std::string& bytes, bool& threw) {
+        std::vector<std::uint64_t> buffer((bytes.size() + 7) / 8);
+        std::memcpy(buffer.data(), bytes.data(), bytes.size());
+        threw = false;
+        try {
+            SessionReader reader(buffer.data(), bytes.size());
+            return reader.all_telemetry().size();
+        } catch (const std::runtime_error&) {
+            threw = true;
+            return size_t{0};
+        }
+    };
+    auto with_entry = [&](const std::string& bytes, size_t at, auto edit) {
+        std::string out = bytes;
+        IndexEntry e;
+        std::memcpy(&e, out.data() + at, sizeof(e));
+        edit(e);
+        std::memcpy(&out[at], &e, sizeof(e));
+        return out;
+    };
+
+    // A lone control entry whose offset + size wraps to just past the header
+    std::string tiny = good.substr(0, sizeof(FileHeader));
+    IndexEntry wrap{};
+    wrap.type = static_cast<std::uint16_t>(RecordType::Control);
+    wrap.columns = kControlColumns;
+    wrap.rows = 1u << 28;
+    wrap.offset = 0 - static_cast<std::uint64_t>(sizeof(BlockHeader) + kControlColumns * 8ull * wrap.rows) + 8;
+    Trailer trailer{sizeof(FileHeader), 1, kIndexMagic};
+    tiny.append(reinterpret_cast<const char*>(&wrap), sizeof(wrap));
+    tiny.append(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+
+    std::vector<std::pair<const char*, std::string>> corrupt = {
+        {"wrapping offset", tiny},
+        {"offset before header", with_entry(good, index_offset, [](IndexEntry& e) { e.offset = 0; })},
+        {"misaligned offset", with_entry(good, index_offset, [](IndexEntry& e) { e.offset += 4; })},
+        {"offset inside a block", with_entry(good, index_offset, [](IndexEntry& e) { e.offset += 8; })},
+        {"wrong column count", with_entry(good, index_offset, [](IndexEntry& e) { e.columns = 3; })},
+        {"unknown type", with_entry(good, index_offset, [](IndexEntry& e) { e.type = 9; e.columns = 0; })},
+        {"rows past the index", with_entry(good, index_offset, [](IndexEntry& e) { e.rows = 1u << 30; })},
+    };
+    bool threw = false;
+    for (const auto& c : corrupt) {
+        open(c.second, threw);
+        if (!threw) fail("test_rejects_corrupt_index", std::string(c.first) + " accepted");
+    }
+
+    // A trailer pointing outside the file is not an index: fall back to the scan
+    std::string bad_trailer = good;
+    Trailer t;
+    std::memcpy(&t, bad_trailer.data() + bad_trailer.size() - sizeof(t), sizeof(t));
+    t.index_offset = ~std::uint64_t{0} - 8;
+    std::memcpy(&bad_trailer[bad_trailer.size() - sizeof(t)], &t, sizeof(t));
+    if (open(bad_trailer, threw) != 40 || threw) fail("test_rejects_corrupt_index", "scan fallback");
+    if (open(good, threw) != 40 || threw) fail("test_rejects_corrupt_index", "intact file");
+
+    std::cout << "test_rejects_corrupt_index passed\n";
+}
+
+void test_flag_encoding() {
+    std::string known = "VOLUME_LIMIT_APPROACH TACHYCARDIA_DETECTED ";
+    if (decode_warnings(encode_warnings(known)) != known) {
+        std::cerr << "test_flag_encoding failed: known warnings did not round-trip\n";
+        exit(1);
+    }
+    std::uint32_t bits = encode_warnings("AILEE_FALLBACK LOW_CARDIAC_RESERVE");
+    if (!(bits & kOtherWarning) || !(bits & kLowCardiacReserve)) {
+        std::cerr << "test_flag_encoding failed: unknown token not flagged\n";
+        exit(1);
+    }
+    if (encode_rationale("plugin override") != kCustomRationale) {
+        std::cerr << "test_flag_encoding failed: custom rationale not flagged\n";
+        exit(1);
+    }
+
+    ControlOutput out;
+    out.rationale.code = RationaleCode::Custom;
+    out.rationale.text = "plugin override";
+    if (encode_rationale(out.rationale) != kCustomRationale ||
+        rationale_from_bits(kCustomRationale, PatientState{}, 0.0).code != RationaleCode::Custom) {
+        std::cerr << "test_flag_encoding failed: custom rationale code\n";
+        exit(1);
+    }
+
+    std::cout << "test_flag_encoding passed\n";
+}
+
+// The fixed-buffer renderer used by the REST snapshot must produce the
+// same text as the stream renderer used for CSV rows.
+void test_rationale_renderers_agree() {
+    const double values[] = {0.0, -0.0, 0.005, 0.015, -0.125, 1.0 / 3.0, 65.4321, 99.995, 1234.5, -7.0e5};
+    const size_t n = sizeof(values) / sizeof(values[0]);
+    for (size_t i = 0; i < 40; ++i) {
+        PatientState state;
+        state.hydration_pct = values[i % n];
+        state.energy_T = values[(i + 1) % n];
+        state.energy_T_absolute = values[(i + 2) % n];
+        state.risk_score = values[(i + 3) % n];
+        state.cardiac_reserve = values[(i + 4) % n];
+        state.coherence_sigma = values[(i + 5) % n];
+        state.estimated_flow_velocity_cm_s = values[(i + 6) % n];
+        state.flow_efficiency = values[(i + 7) % n];
+        Rationale r = AdaptiveController::make_rationale(state, values[(i + 8) % n], i % 2 == 0, i % 3 == 0);
+        char buf[kRationaleTextCapacity];
+        size_t len = format_rationale(buf, sizeof(buf), r);
+        std::string streamed = to_string(r);
+        if (streamed != std::string(buf, len) || streamed.compare(0, 2, "H=") != 0) {
+            std::cerr << "test_rationale_renderers_agree failed: \"" << streamed << "\" vs \"" << buf << "\"\n";
+            exit(1);
+        }
+    }
+    WarningFlags all{0xFFFFFFFFu};
+    char small[24];
+    size_t len = format_warnings(small, sizeof(small), all);
+    if (len != sizeof(small) - 1 || to_string(all).compare(0, len, small) != 0) {
+        std::cerr << "test_rationale_renderers_agree failed: truncated warnings\n";
+        exit(1);
+    }
+
+    std::cout << "test_rationale_renderers_agree passed\n";
+}
+
+int main() {
+    test_binary_converts_to_identical_csv();
+    test_block_index_by_timestamp();
+    test_recovers_unclosed_file();
+    test_rejects_corrupt_index();
+    test_flag_encoding();
+    test_rationale_renderers_agree();
+    return 0;
+}
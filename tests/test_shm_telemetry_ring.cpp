@@ -0,0 +1,221 @@
+#include "../src/shm_telemetry_ring.hpp"
+#include "test_support.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ivsys;
+
+static std::string ring_name(const char* suffix) {
+    return "/ai_iv_test_" + std::to_string(getpid()) + "_" + suffix;
+}
+
+// Every field carries `k`, so a torn copy shows up as a mismatch.
+static Telemetry tagged(double k) {
+    Telemetry m;
+    m.hydration_pct = k;
+    m.heart_rate_bpm = k;
+    m.temp_celsius = k;
+    m.blood_loss_idx = k;
+    m.fatigue_idx = k;
+    m.anxiety_idx = k;
+    m.signal_quality = k;
+    m.spo2_pct = k;
+    m.lactate_mmol = k;
+    m.cardiac_output_L_min = k;
+    m.vault_mesh_size_nm = k;
+    m.vault_payload_pct = k;
+    m.vault_cage_breached = static_cast<long long>(k) % 2 == 1;
+    return m;
+}
+
+static bool consistent(const Telemetry& m) {
+    double k = m.hydration_pct;
+    return m.heart_rate_bpm == k && m.temp_celsius == k && m.blood_loss_idx == k &&
+           m.fatigue_idx == k && m.anxiety_idx == k && m.signal_quality == k && m.spo2_pct == k &&
+           m.lactate_mmol == k && m.cardiac_output_L_min == k && m.vault_mesh_size_nm == k &&
+           m.vault_payload_pct == k && m.vault_cage_breached == (static_cast<long long>(k) % 2 == 1);
+}
+
+void test_record_round_trip() {
+    const char* name = "test_record_round_trip";
+    std::string shm = ring_name("roundtrip");
+    ShmTelemetryWriter writer(shm);
+    ShmTelemetryReader reader(shm);
+    if (reader.capacity() != ShmTelemetryWriter::kDefaultCapacity) fail(name, "capacity");
+    if (reader.producer_pid() != getpid()) fail(name, "producer pid");
+
+    Telemetry m;
+    m.hydration_pct = 61.5;
+    m.heart_rate_bpm = 88.0;
+    m.temp_celsius = 37.2;
+    m.blood_loss_idx = 0.1;
+    m.fatigue_idx = 0.2;
+    m.anxiety_idx = 0.3;
+    m.signal_quality = 0.9;
+    m.spo2_pct = 97.0;
+    m.lactate_mmol = 1.4;
+    m.cardiac_output_L_min = 5.1;
+    m.vault_mesh_size_nm = 12.0;
+    m.vault_payload_pct = 80.0;
+    m.vault_cage_breached = true;
+    writer.publish(m);
+
+    Telemetry out;
+    if (reader.read_latest(out, m.timestamp) != ShmReadStatus::Fresh) fail(name, "status");
+    if (out.timestamp != m.timestamp || out.hydration_pct != 61.5 || out.heart_rate_bpm != 88.0 ||
+        out.spo2_pct != 97.0 || out.vault_payload_pct != 80.0 || !out.vault_cage_breached) {
+        fail(name, "fields");
+    }
+    ShmTelemetryWriter::unlink(shm);
+    std::cout << name << " passed\n";
+}
+
+void test_staleness_and_counters() {
+    const char* name = "test_staleness_and_counters";
+    std::string shm = ring_name("counters");
+    ShmTelemetryWriter writer(shm, 8);
+    ShmTelemetryReader::Options options;
+    options.max_age = std::chrono::milliseconds(500);
+    ShmTelemetryReader reader(shm, options);
+
+    Telemetry out;
+    auto t0 = std::chrono::steady_clock::now();
+    if (reader.read_latest(out, t0) != ShmReadStatus::Empty) fail(name, "empty ring");
+
+    Telemetry m = tagged(1.0);
+    m.timestamp = t0;
+    writer.publish(m);
+    if (reader.read_latest(out, t0) != ShmReadStatus::Fresh) fail(name, "first read");
+    if (reader.read_latest(out, t0 + std::chrono::milliseconds(200)) != ShmReadStatus::Repeat) {
+        fail(name, "repeat");
+    }
+    // A producer that stopped publishing goes stale
+    if (reader.read_latest(out, t0 + std::chrono::milliseconds(501)) != ShmReadStatus::Stale) {
+        fail(name, "stale");
+    }
+
+    // 20 records through an 8-slot ring: only the newest is read
+    for (int k = 2; k <= 21; ++k) {
+        Telemetry next = tagged(k);
+        next.timestamp = t0 + std::chrono::milliseconds(k);
+        writer.publish(next);
+    }
+    if (reader.read_latest(out, t0 + std::chrono::milliseconds(30)) != ShmReadStatus::Fresh ||
+        out.hydration_pct != 21.0) {
+        fail(name, "newest after lapping");
+    }
+
+    const ShmTelemetryReader::Stats& s = reader.stats();
+    if (s.reads != 5 || s.empty != 1 || s.fresh != 2 || s.repeats != 1 || s.stale != 1 ||
+        s.skipped != 19 || s.last_sequence != 21 || s.torn != 0) {
+        fail(name, "counters");
+    }
+    if (writer.published() != 21 || reader.published() != 21) fail(name, "published");
+    ShmTelemetryWriter::unlink(shm);
+    std::cout << name << " passed\n";
+}
+
+void test_concurrent_producer_never_tears() {
+    const char* name = "test_concurrent_producer_never_tears";
+    std::string shm = ring_name("concurrent");
+    ShmTelemetryWriter writer(shm, 4);
+    ShmTelemetryReader reader(shm);
+    constexpr int kRecords = 200000;
+
+    std::atomic<bool> done{false};
+    std::thread producer([&] {
+        for (int k = 1; k <= kRecords; ++k) writer.publish(tagged(k));
+        done.store(true, std::memory_order_release);
+    });
+
+    Telemetry out;
+    double first = 0.0, last = 0.0;
+    std::uint64_t reads = 0;
+    while (!done.load(std::memory_order_acquire) || last < kRecords) {
+        ShmReadStatus status = reader.read_latest(out, std::chrono::steady_clock::now());
+        if (status != ShmReadStatus::Fresh && status != ShmReadStatus::Repeat) continue;
+        if (!consistent(out)) fail(name, "torn record");
+        if (out.hydration_pct < last) fail(name, "sequence went backwards");
+        if (first == 0.0) first = out.hydration_pct;
+        last = out.hydration_pct;
+        ++reads;
+    }
+    producer.join();
+
+    const ShmTelemetryReader::Stats& s = reader.stats();
+    if (s.last_sequence != static_cast<std::uint64_t>(kRecords) || reads == 0) fail(name, "coverage");
+    // Every record from the first one read on was either read or skipped
+    if (s.fresh + s.skipped != static_cast<std::uint64_t>(kRecords - first + 1)) fail(name, "skip accounting");
+    ShmTelemetryWriter::unlink(shm);
+    std::cout << name << " passed\n";
+}
+
+// A sensor daemon restarting in another process reattaches to the segment
+// and continues its sequence, so the attached reader just sees new data.
+void test_producer_process_restart() {
+    const char* name = "test_producer_process_restart";
+    std::string shm = ring_name("restart");
+    {
+        ShmTelemetryWriter writer(shm);
+        writer.publish(tagged(5.0));
+    }
+    ShmTelemetryReader reader(shm);
+    Telemetry out;
+    reader.read_latest(out, out.timestamp);
+
+    pid_t child = fork();
+    if (child < 0) fail(name, "fork");
+    if (child == 0) {
+        ShmTelemetryWriter writer(shm);
+        Telemetry m = tagged(7.0);
+        writer.publish(m);
+        _exit(writer.published() == 2 ? 0 : 1);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) fail(name, "child did not continue the sequence");
+
+    if (reader.read_latest(out, std::chrono::steady_clock::now()) != ShmReadStatus::Fresh ||
+        out.hydration_pct != 7.0 || !consistent(out)) {
+        fail(name, "record from the restarted producer");
+    }
+    if (reader.producer_pid() != child || reader.stats().skipped != 0) fail(name, "producer pid");
+
+    // A different capacity is a new segment; the old reader keeps its view
+    ShmTelemetryWriter resized(shm, 16);
+    resized.publish(tagged(9.0));
+    if (reader.published() != 2) fail(name, "old mapping disturbed");
+    ShmTelemetryReader fresh(shm);
+    if (fresh.capacity() != 16 || fresh.published() != 1) fail(name, "recreated segment");
+    ShmTelemetryWriter::unlink(shm);
+    std::cout << name << " passed\n";
+}
+
+void test_open_errors() {
+    const char* name = "test_open_errors";
+    bool threw = false;
+    try {
+        ShmTelemetryReader reader(ring_name("missing"));
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    if (!threw) fail(name, "missing segment");
+    std::cout << name << " passed\n";
+}
+
+int main() {
+    test_record_round_trip();
+    test_staleness_and_counters();
+    test_concurrent_producer_never_tears();
+    test_producer_process_restart();
+    test_open_errors();
+    return 0;
+}
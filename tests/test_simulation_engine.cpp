@@ -0,0 +1,134 @@
+#include "../src/simulation_driver.hpp"
+#include "test_support.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace ivsys;
+
+static void remove_session(const std::string& id) {
+    for (const char* suffix : {"_system.log", "_telemetry.csv", "_control.csv", "_session.aivs"}) {
+        std::remove(("ai_iv_" + id + suffix).c_str());
+    }
+}
+
+void test_scenario_effects() {
+    const char* name = "test_scenario_effects";
+    SimulationEngine baseline(make_profile(), 5);
+    SimulationEngine sim(make_profile(), 5);
+    sim.add_event({ScenarioKind::Hemorrhage, 1000.0, 1000.0, 1.0});
+    sim.add_event({ScenarioKind::Hypoxia, 3000.0, 1000.0, 0.5});
+    sim.add_event({ScenarioKind::SensorDropout, 5000.0, 1000.0, 1.0});
+
+    // Outside every event the waveform is the baseline.
+    for (double t : {0.0, 999.0, 2000.0, 2500.0, 6000.0}) {
+        Telemetry a = sim.generate_telemetry(t), b = baseline.generate_telemetry(t);
+        if (a.hydration_pct != b.hydration_pct || a.spo2_pct != b.spo2_pct ||
+            a.signal_quality != b.signal_quality) {
+            fail(name, "event active outside its window at t=" + std::to_string(t));
+        }
+    }
+    if (SimulationEngine::envelope(sim.events()[0], 1100.0) >= 1.0 ||
+        SimulationEngine::envelope(sim.events()[0], 1500.0) != 1.0) {
+        fail(name, "ramp envelope");
+    }
+
+    Telemetry bleed = sim.generate_telemetry(1500.0), calm = baseline.generate_telemetry(1500.0);
+    if (!(bleed.blood_loss_idx > 0.5 && bleed.hydration_pct < calm.hydration_pct - 15.0 &&
+          bleed.heart_rate_bpm > calm.heart_rate_bpm + 30.0 &&
+          bleed.cardiac_output_L_min < calm.cardiac_output_L_min)) {
+        fail(name, "hemorrhage");
+    }
+    Telemetry hypoxic = sim.generate_telemetry(3500.0);
+    calm = baseline.generate_telemetry(3500.0);
+    if (std::abs(hypoxic.spo2_pct - (calm.spo2_pct - 7.5)) > 1e-9 || !(hypoxic.lactate_mmol > calm.lactate_mmol)) {
+        fail(name, "hypoxia at half severity");
+    }
+    Telemetry dropout = sim.generate_telemetry(5500.0);
+    calm = baseline.generate_telemetry(5500.0);
+    if (!(dropout.signal_quality < 0.6 * calm.signal_quality)) fail(name, "dropout signal quality");
+
+    // Deterministic for a seed, different across seeds.
+    SimulationEngine other(make_profile(), 6);
+    other.add_event(sim.events()[2]);
+    bool differs = false;
+    for (double t = 5500.0; t < 5510.0; t += 0.2) {
+        if (sim.generate_telemetry(t).heart_rate_bpm != sim.generate_telemetry(t).heart_rate_bpm) {
+            fail(name, "not deterministic");
+        }
+        differs |= sim.generate_telemetry(t).heart_rate_bpm != other.generate_telemetry(t).heart_rate_bpm;
+    }
+    if (!differs) fail(name, "seed has no effect on dropout noise");
+
+    ScenarioKind kind;
+    if (!SimulationEngine::parse_kind("hypoxia", kind) || kind != ScenarioKind::Hypoxia ||
+        SimulationEngine::parse_kind("fever", kind)) {
+        fail(name, "parse_kind");
+    }
+    std::cout << name << " passed\n";
+}
+
+void test_virtual_clock() {
+    const char* name = "test_virtual_clock";
+    SimulationEngine sim(make_profile());
+    Telemetry a = sim.generate_telemetry(10.0), b = sim.generate_telemetry(10.2);
+    double seconds = std::chrono::duration<double>(a.timestamp.time_since_epoch()).count();
+    double step = std::chrono::duration<double>(b.timestamp - a.timestamp).count();
+    if (std::abs(seconds - 10.0) > 1e-6 || std::abs(step - 0.2) > 1e-6) fail(name, "timestamps");
+    std::cout << name << " passed\n";
+}
+
+void test_driver_runs_scenarios() {
+    const char* name = "test_driver_runs_scenarios";
+    SimulationDriver::Options options;
+    options.duration_seconds = 2.0 * 3600.0;
+    options.dt_seconds = 1.0;
+    options.session_id = "sim_test";
+    options.volume_window_seconds = 3600.0;
+    options.stage_timing = true;
+    options.events = {{ScenarioKind::Hemorrhage, 1800.0, 1200.0, 1.0},
+                      {ScenarioKind::SensorDropout, 4800.0, 600.0, 1.0}};
+    options.progress_interval_seconds = 1800.0;
+    int progress_calls = 0;
+    options.on_progress = [&](const SimulationProgress&) { ++progress_calls; };
+
+    SimulationReport r = SimulationDriver(make_profile(), options).run();
+    if (r.ticks != 7200 || std::abs(r.simulated_seconds - 7200.0) > 1e-9) fail(name, "tick count");
+    if (progress_calls != 4) fail(name, "progress callbacks");
+    if (r.volume_resets != 2) fail(name, "volume windows");
+    if (!(r.ticks_per_second > 0.0 && r.speedup > 1.0)) fail(name, "throughput");
+    if (!(r.total_volume_ml > 0.0 && r.mean_rate_ml_min > 0.0 && r.max_rate_ml_min <= 1.5)) {
+        fail(name, "infusion");
+    }
+    if (r.loop.ticks != 7200 || r.loop.stage(LoopStage::Decide).count != 7200) fail(name, "stage timing");
+    if (r.logger.dropped != 0) fail(name, "sync logger dropped records");
+
+    const ScenarioWindowStats& bleed = r.scenarios[0];
+    const ScenarioWindowStats& dropout = r.scenarios[1];
+    if (bleed.ticks != 1199 || dropout.ticks != 599) fail(name, "event windows");
+    if (!(bleed.min_hydration_pct < r.min_hydration_pct + 1e-9)) fail(name, "bleed is not the low point");
+    if (!(dropout.low_quality_ticks > dropout.ticks / 2)) fail(name, "dropout did not degrade quality");
+    if (!(bleed.mean_rate_ml_min > r.mean_rate_ml_min)) fail(name, "controller did not respond to the bleed");
+
+    // Same options, same decisions.
+    options.stage_timing = false;
+    options.session_id = "sim_test_again";
+    SimulationReport again = SimulationDriver(make_profile(), options).run();
+    if (again.total_volume_ml != r.total_volume_ml || again.warning_ticks != r.warning_ticks ||
+        again.scenarios[0].peak_rate_ml_min != bleed.peak_rate_ml_min) {
+        fail(name, "not reproducible");
+    }
+    if (again.loop.ticks != 0) fail(name, "timing without stage_timing");
+    remove_session("sim_test");
+    remove_session("sim_test_again");
+    std::cout << name << " passed\n";
+}
+
+int main() {
+    test_scenario_effects();
+    test_virtual_clock();
+    test_driver_runs_scenarios();
+    return 0;
+}
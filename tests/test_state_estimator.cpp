@@ -2,6 +2,14 @@
 #include <iostream>
 #include <cassert>
 #include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#ifndef NEURAL_MODEL_PATH
+#define NEURAL_MODEL_PATH "models/sensor_fusion_fdeep.json"
+#endif
 
 using namespace ivsys;
 
@@ -37,7 +45,119 @@ void test_estimate_basic() {
     std::cout << "test_estimate_basic passed\n";
 }
 
+// Constant E_T, so the test can see which strategy estimate() used.
+class FixedEnergyProxy : public EnergyProxyModel {
+public:
+    explicit FixedEnergyProxy(double value) : value_(value) {}
+    const char* name() const override { return "fixed"; }
+    double energy_proxy(const Telemetry&) const override { return value_; }
+
+private:
+    double value_;
+};
+
+void test_energy_proxy_injection() {
+    PatientProfile profile;
+    Telemetry m;
+    m.hydration_pct = 70.0;
+
+    StateEstimator rule;
+    StateEstimator injected(std::make_shared<FixedEnergyProxy>(0.123));
+    double rule_T = rule.estimate(m, profile, 0.4).energy_T;
+    if (rule_T != StateEstimator::rule_energy_proxy(m)) {
+        std::cerr << "test_energy_proxy_injection failed: default estimator is not rule-based\n";
+        exit(1);
+    }
+    if (injected.estimate(m, profile, 0.4).energy_T != 0.123) {
+        std::cerr << "test_energy_proxy_injection failed: injected model not used\n";
+        exit(1);
+    }
+    injected.set_neural_energy_proxy(false);
+    if (injected.estimate(m, profile, 0.4).energy_T != rule_T) {
+        std::cerr << "test_energy_proxy_injection failed: rule override ignored\n";
+        exit(1);
+    }
+    if (default_energy_proxy() == nullptr) {
+        std::cerr << "test_energy_proxy_injection failed: no default model\n";
+        exit(1);
+    }
+    std::cout << "test_energy_proxy_injection passed\n";
+}
+
+void test_shared_model_across_threads() {
+    // One read-only kernel model, many estimators on many threads: every
+    // thread must see exactly the single-threaded values.
+    auto model = std::make_shared<const KernelEnergyProxy>(NEURAL_MODEL_PATH);
+    PatientProfile profile;
+
+    auto run = [&](std::vector<double>& out) {
+        StateEstimator estimator(model);
+        for (int i = 0; i < 2000; ++i) {
+            Telemetry m;
+            m.hydration_pct = 40.0 + (i % 50);
+            m.heart_rate_bpm = 60.0 + (i % 70);
+            m.lactate_mmol = 1.0 + (i % 9);
+            out.push_back(estimator.estimate(m, profile, 0.4).energy_T);
+        }
+    };
+
+    std::vector<double> expected;
+    run(expected);
+    std::vector<std::vector<double>> results(4);
+    std::vector<std::thread> threads;
+    for (auto& r : results) threads.emplace_back(run, std::ref(r));
+    for (auto& t : threads) t.join();
+    for (const auto& r : results) {
+        if (r != expected) {
+            std::cerr << "test_shared_model_across_threads failed: results differ across threads\n";
+            exit(1);
+        }
+    }
+    std::cout << "test_shared_model_across_threads passed\n";
+}
+
+void test_kernel_model_prefers_blob() {
+    EnergyProxyLoadReport report;
+    EnergyProxyModelPtr model = load_kernel_energy_proxy(NEURAL_MODEL_PATH, &report);
+    if (report.source != "blob" || report.model != "kernel" || !report.fallback_reason.empty() ||
+        report.path != SensorFusionKernel::blob_path_for(NEURAL_MODEL_PATH)) {
+        std::cerr << "test_kernel_model_prefers_blob failed: blob not used (" << report.fallback_reason << ")\n";
+        exit(1);
+    }
+
+    // No blob next to this copy of the JSON: falls back, same predictions.
+    // (A blob packed from another JSON is rejected the same way.)
+    const std::string copy = "ai_iv_test_model_copy.json";
+    {
+        std::ifstream in(NEURAL_MODEL_PATH, std::ios::binary);
+        std::ofstream out(copy, std::ios::binary);
+        out << in.rdbuf();
+    }
+    EnergyProxyLoadReport fallback;
+    EnergyProxyModelPtr from_json = load_kernel_energy_proxy(copy, &fallback);
+    std::remove(copy.c_str());
+    Telemetry m;
+    m.hydration_pct = 55.0;
+    m.heart_rate_bpm = 110.0;
+    m.lactate_mmol = 3.0;
+    if (fallback.source != "json" || fallback.fallback_reason.empty() ||
+        from_json->energy_proxy(m) != model->energy_proxy(m)) {
+        std::cerr << "test_kernel_model_prefers_blob failed: JSON fallback\n";
+        exit(1);
+    }
+    try {
+        load_kernel_energy_proxy("models/does_not_exist.json");
+        std::cerr << "test_kernel_model_prefers_blob failed: missing model did not throw\n";
+        exit(1);
+    } catch (const std::runtime_error&) {
+    }
+    std::cout << "test_kernel_model_prefers_blob passed\n";
+}
+
 int main() {
     test_estimate_basic();
+    test_energy_proxy_injection();
+    test_shared_model_across_threads();
+    test_kernel_model_prefers_blob();
     return 0;
 }
@@ -0,0 +1,108 @@
+#include "../src/status_display.hpp"
+#include "test_support.hpp"
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace ivsys;
+
+static size_t count_frames(const std::string& text) {
+    size_t n = 0;
+    for (size_t pos = text.find("=== AI-IV"); pos != std::string::npos; pos = text.find("=== AI-IV", pos + 1)) ++n;
+    return n;
+}
+
+static PatientState state_with_hydration(double hydration) {
+    PatientState s;
+    s.hydration_pct = hydration;
+    s.heart_rate_bpm = 72.0;
+    return s;
+}
+
+void test_updates_are_coalesced() {
+    const char* name = "test_updates_are_coalesced";
+    std::ostringstream out;
+    StatusDisplay::Options options;
+    options.refresh_interval = std::chrono::milliseconds(20);
+    options.out = &out;
+    StatusDisplay display(options);
+    display.start();
+
+    ControlOutput cmd;
+    cmd.infusion_ml_per_min = 0.75;
+    cmd.confidence = 0.9;
+    for (int i = 1; i <= 500; ++i) {
+        display.publish(state_with_hydration(40.0 + i * 0.01), cmd, 120.0);
+    }
+    display.stop();
+
+    std::string text = out.str();
+    if (display.updates_published() != 500) fail(name, "publish count");
+    if (display.frames_rendered() == 0) fail(name, "no frame rendered");
+    if (display.frames_rendered() >= display.updates_published()) fail(name, "updates were not coalesced");
+    if (count_frames(text) != display.frames_rendered()) fail(name, "frame counter disagrees with output");
+    // stop() always shows the newest update.
+    if (text.rfind("Hydration: 45.0%") == std::string::npos ||
+        text.rfind("Hydration: 45.0%") < text.rfind("=== AI-IV")) {
+        fail(name, "last frame does not show the last update");
+    }
+    if (text.find("WARNINGS") != std::string::npos) fail(name, "warnings shown without flags");
+    std::cout << name << " passed\n";
+}
+
+void test_frame_matches_panel_format() {
+    const char* name = "test_frame_matches_panel_format";
+    StatusDisplay::Frame frame{};
+    frame.state = state_with_hydration(61.25);
+    frame.infusion_ml_per_min = 1.234;
+    frame.confidence = 0.5;
+    frame.cumulative_volume_ml = 250.4;
+    frame.warning_flags.set(WarningFlag::HighRiskState);
+    frame.warning_flags.set(WarningFlag::TachycardiaDetected);
+    std::ostringstream out;
+    StatusDisplay::render(out, frame);
+    std::string text = out.str();
+    for (const char* expected : {"Hydration: 61.2%", "HR: 72 bpm", "Infusion Rate: 1.23 ml/min",
+                                 "WARNINGS: HIGH_RISK_STATE TACHYCARDIA_DETECTED \n", "24h Volume: 250 ml"}) {
+        if (text.find(expected) == std::string::npos) fail(name, std::string("missing ") + expected);
+    }
+    std::cout << name << " passed\n";
+}
+
+void test_headless_renders_nothing() {
+    const char* name = "test_headless_renders_nothing";
+    std::ostringstream out;
+    StatusDisplay::Options options;
+    options.mode = DisplayMode::Headless;
+    options.refresh_interval = std::chrono::milliseconds(1);
+    options.out = &out;
+    StatusDisplay display(options);
+    display.start();
+    for (int i = 0; i < 100; ++i) display.publish(PatientState{}, ControlOutput{}, 0.0);
+    display.stop();
+    if (!out.str().empty()) fail(name, "headless display wrote output");
+    if (display.frames_rendered() != 0 || display.updates_published() != 0) fail(name, "headless counters");
+    std::cout << name << " passed\n";
+}
+
+void test_stop_without_updates() {
+    const char* name = "test_stop_without_updates";
+    std::ostringstream out;
+    StatusDisplay::Options options;
+    options.out = &out;
+    {
+        StatusDisplay display(options);
+        display.start();
+    }   // destructor stops the thread
+    if (!out.str().empty()) fail(name, "rendered a frame with nothing published");
+    std::cout << name << " passed\n";
+}
+
+int main() {
+    test_updates_are_coalesced();
+    test_frame_matches_panel_format();
+    test_headless_renders_nothing();
+    test_stop_without_updates();
+    return 0;
+}
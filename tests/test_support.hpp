@@ -0,0 +1,70 @@
+#pragma once
+
+/*
+ * test_support.hpp
+ *
+ * Helpers shared by the test programs: the failure reporter, the reference
+ * adult profile and a recorder that writes a session through
+ * PatientControlCycle for the replay-based tests.
+ */
+
+#include "../src/control_cycle.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+
+// Print "<test> failed: <what>" and exit non-zero.
+[[noreturn]] inline void fail(const char* test, const std::string& what) {
+    std::cerr << test << " failed: " << what << "\n";
+    std::exit(1);
+}
+
+// 75 kg, 35 y adult at rest; tests that need another weight or condition
+// adjust the copy.
+inline ivsys::PatientProfile make_profile() {
+    ivsys::PatientProfile p;
+    p.weight_kg = 75.0;
+    p.age_years = 35.0;
+    p.baseline_hr_bpm = 70.0;
+    p.max_safe_infusion_rate = 1.5;
+    p.current_tissue_perfusion = 0.85;
+    p.energy_params = ivsys::EnergyTransferParams();
+    return p;
+}
+
+// Record `ticks` 200 ms ticks of make_profile() as `session_id`, with
+// telemetry(t) at therapy time t.  Timestamps run from a fixed epoch so
+// recordings are reproducible.
+inline void record_session(const std::string& session_id, int ticks, ivsys::SessionFormat format,
+                           const std::function<ivsys::Telemetry(double t, int i)>& telemetry) {
+    ivsys::PatientControlCycle cycle(make_profile(), session_id, ivsys::LoggerMode::Sync, format);
+    auto t0 = std::chrono::steady_clock::time_point(std::chrono::seconds(5000));
+    for (int i = 0; i < ticks; ++i) {
+        ivsys::Telemetry m = telemetry(i * 0.2, i);
+        m.timestamp = t0 + std::chrono::milliseconds(200 * i);
+        cycle.step(m, 0.2);
+    }
+}
+
+// The replay tests' trace: hydration drifting down by `drift` %/s with
+// slow heart-rate, temperature, fatigue and lactate trends; both formats.
+inline void record_session(const std::string& session_id, int ticks, double drift = 0.02) {
+    record_session(session_id, ticks, ivsys::SessionFormat::Both, [drift](double t, int i) {
+        ivsys::Telemetry m;
+        m.hydration_pct = 62.0 - t * drift + 0.5 * std::sin(t * 0.1);
+        m.heart_rate_bpm = 72.0 + 6.0 * std::sin(t * 0.05) + (i % 9) * 0.3;
+        m.temp_celsius = 37.0 + 0.2 * std::sin(t * 0.01);
+        m.blood_loss_idx = 0.05;
+        m.fatigue_idx = std::min(1.0, t / 300.0);
+        m.anxiety_idx = 0.2;
+        m.signal_quality = 0.9;
+        m.spo2_pct = 97.0;
+        m.lactate_mmol = 1.0 + t / 200.0;
+        m.cardiac_output_L_min = 5.0;
+        return m;
+    });
+}
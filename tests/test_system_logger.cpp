@@ -0,0 +1,134 @@
+#include "../src/SystemLogger.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace ivsys;
+
+static std::string read_file(const std::string& path) {
+    std::ifstream in(path);
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+static void write_session(const std::string& session_id, LoggerMode mode) {
+    SystemLogger logger(session_id, mode);
+    auto t0 = std::chrono::steady_clock::time_point(std::chrono::seconds(1000));
+    for (int i = 0; i < 200; ++i) {
+        Telemetry m;
+        m.timestamp = t0 + std::chrono::milliseconds(200 * i);
+        m.hydration_pct = 60.0 + i * 0.1;
+        m.heart_rate_bpm = 72.0;
+        m.spo2_pct = 97.0;
+        logger.log_telemetry(m);
+
+        ControlOutput out;
+        out.infusion_ml_per_min = 0.5;
+        out.confidence = 0.9;
+        out.rationale.code = RationaleCode::Controller;
+        out.rationale.hydration_pct = m.hydration_pct;
+        out.rationale.rate_ml_min = out.infusion_ml_per_min;
+        out.rationale.safety_limited = (i % 7 == 0);
+        if (i % 10 == 0) out.warning_flags.set(WarningFlag::RateChangeLimited);
+        PatientState state;
+        state.energy_T = 0.7;
+        logger.log_control(out, state, m.timestamp);
+    }
+    logger.log_alert(AlertSeverity::Critical, "LoggerTest", "ASYNC_CRITICAL",
+                     "Critical alert through the logger", std::string("{\"i\":1}"));
+    const SystemLogger::AlertValue values[] = {{"risk_score", 0.75}, {"threshold", 0.7}};
+    logger.log_alert(AlertSeverity::Warn, "LoggerTest", "NUMERIC_CONTEXT",
+                     "Alert with \"numeric\" context", values, 2);
+}
+
+void test_async_matches_sync_output() {
+    write_session("logger_test_sync", LoggerMode::Sync);
+    write_session("logger_test_async", LoggerMode::Async);
+
+    for (const char* suffix : {"_telemetry.csv", "_control.csv"}) {
+        std::string sync_out = read_file(std::string("ai_iv_logger_test_sync") + suffix);
+        std::string async_out = read_file(std::string("ai_iv_logger_test_async") + suffix);
+        if (sync_out.empty() || sync_out != async_out) {
+            std::cerr << "test_async_matches_sync_output failed: " << suffix << " differs\n";
+            exit(1);
+        }
+    }
+
+    std::string control = read_file("ai_iv_logger_test_sync_control.csv");
+    if (control.find(",\"RATE_CHANGE_LIMITED \",\"H=60.00% E_T=0.00 T=0.00W/kg R=0.00 C_res=0.00 "
+                     "σ=0.00 v=0.00cm/s G(v)=0.00 u=0.50ml/min [SAFETY_LIM]\"\n") == std::string::npos) {
+        std::cerr << "test_async_matches_sync_output failed: rendered control row\n";
+        exit(1);
+    }
+
+    for (const char* session : {"ai_iv_logger_test_sync_system.log", "ai_iv_logger_test_async_system.log"}) {
+        std::string log = read_file(session);
+        if (log.find("\"code\":\"ASYNC_CRITICAL\"") == std::string::npos ||
+            log.find("\"context\":{\"i\":1}") == std::string::npos) {
+            std::cerr << "test_async_matches_sync_output failed: critical alert missing\n";
+            exit(1);
+        }
+        if (log.find("\"message\":\"Alert with \\\"numeric\\\" context\","
+                     "\"context\":{\"risk_score\":0.750000,\"threshold\":0.700000}}") == std::string::npos) {
+            std::cerr << "test_async_matches_sync_output failed: numeric alert context in " << session << "\n";
+            exit(1);
+        }
+    }
+
+    std::cout << "test_async_matches_sync_output passed\n";
+}
+
+void test_async_stats() {
+    LoggerStats stats;
+    {
+        SystemLogger logger("logger_test_stats", LoggerMode::Async, 64);
+        Telemetry m;
+        for (int i = 0; i < 10; ++i) logger.log_telemetry(m);
+        stats = logger.stats();
+    }
+    if (stats.queue_capacity < 64 || stats.enqueued + stats.dropped != 10) {
+        std::cerr << "test_async_stats failed: enqueued " << stats.enqueued
+                  << " dropped " << stats.dropped << "\n";
+        exit(1);
+    }
+
+    std::cout << "test_async_stats passed\n";
+}
+
+void test_loop_metrics_summary() {
+    ControlLoopMetrics metrics;
+    for (int i = 0; i < 5; ++i) {
+        for (size_t s = 0; s < ControlLoopMetrics::kStageCount; ++s) {
+            metrics.record_stage(static_cast<LoopStage>(s), std::chrono::milliseconds(150));
+        }
+        metrics.record_tick(std::chrono::milliseconds(i == 0 ? 450 : 190), std::chrono::milliseconds(120),
+                            i == 0, i == 0 ? 2 : 0);
+    }
+    LoggerStats stats;
+    {
+        // Worst-case widths still fit the async record's message field.
+        SystemLogger logger("logger_test_loop", LoggerMode::Async);
+        logger.log_loop_metrics(metrics.snapshot());
+        stats = logger.stats();
+    }
+    std::string log = read_file("ai_iv_logger_test_loop_system.log");
+    if (stats.truncated != 0 ||
+        log.find("LOOP_METRICS ticks=5 overruns=1 skipped=2 exec_us=p50:") == std::string::npos ||
+        log.find(" jitter_us=p99:") == std::string::npos ||
+        log.find("LOOP_STAGES p99_us acquire=") == std::string::npos ||
+        log.find(" display=") == std::string::npos) {
+        std::cerr << "test_loop_metrics_summary failed:\n" << log;
+        exit(1);
+    }
+
+    std::cout << "test_loop_metrics_summary passed\n";
+}
+
+int main() {
+    test_async_matches_sync_output();
+    test_async_stats();
+    test_loop_metrics_summary();
+    return 0;
+}
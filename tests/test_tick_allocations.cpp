@@ -0,0 +1,95 @@
+// Counts heap allocations made by a steady-state control tick: the cycle
+// step plus the publishes AIIVSystem does after it.  Replaces the global
+// operator new, so it runs as its own executable.
+
+#include "../src/control_cycle.hpp"
+#include "../src/rest_api_server.hpp"
+#include "../src/status_display.hpp"
+#include "test_support.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <sstream>
+#include <string>
+
+static std::atomic<long> g_allocations{0};
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+using namespace ivsys;
+
+// Telemetry that keeps warnings and alerts firing every tick.
+static Telemetry stressed_telemetry(int tick) {
+    Telemetry m;
+    m.timestamp = std::chrono::steady_clock::now();
+    m.hydration_pct = 45.0 + (tick % 7);
+    m.heart_rate_bpm = 130.0;
+    m.temp_celsius = 38.5;
+    m.fatigue_idx = 0.8;
+    m.lactate_mmol = 4.0;
+    m.spo2_pct = 91.0;
+    m.signal_quality = (tick % 2) ? 0.5 : 0.9;
+    m.cardiac_output_L_min = 4.0;
+    return m;
+}
+
+void test_steady_state_tick_does_not_allocate() {
+    const char* name = "test_steady_state_tick_does_not_allocate";
+    for (LoggerMode mode : {LoggerMode::Sync, LoggerMode::Async}) {
+        for (SessionFormat format : {SessionFormat::Csv, SessionFormat::Binary}) {
+            std::ostringstream console;
+            StatusDisplay::Options display_options;
+            display_options.out = &console;
+            StatusDisplay display(display_options);
+            RestApiServer rest(0, "127.0.0.1", 1);
+            PatientControlCycle cycle(make_profile(), "tick_alloc_test", mode, format);
+
+            bool warned = false;
+            auto tick = [&](int i) {
+                CycleResult result = cycle.step(stressed_telemetry(i), 0.2);
+                rest.update_telemetry(result.measurement);
+                rest.update_patient_state(result.state);
+                rest.update_control_output(result.command);
+                ForwardPrediction predictions[std::size(config::PUBLISHED_PREDICTION_HORIZON_STEPS)];
+                rest.update_prediction(predictions, cycle.estimator().predict_horizons(
+                    config::PUBLISHED_PREDICTION_HORIZON_STEPS,
+                    std::size(config::PUBLISHED_PREDICTION_HORIZON_STEPS), predictions));
+                display.publish(result.validated_state, result.command,
+                                cycle.safety().get_cumulative_volume());
+                warned |= result.command.warning_flags.any();
+            };
+            // Warm-up: history buffers, file buffers and session blocks
+            // reach their steady size.
+            for (int i = 0; i < 600; ++i) tick(i);
+
+            long before = g_allocations.load();
+            for (int i = 600; i < 1600; ++i) tick(i);
+            long allocations = g_allocations.load() - before;
+
+            if (!warned) fail(name, "stress telemetry raised no warnings");
+            if (allocations != 0) {
+                fail(name, std::to_string(allocations) + " allocations in 1000 ticks (" +
+                           (mode == LoggerMode::Sync ? "sync" : "async") + ", " +
+                           (format == SessionFormat::Csv ? "csv" : "binary") + ")");
+            }
+        }
+    }
+    std::remove("ai_iv_tick_alloc_test_system.log");
+    std::remove("ai_iv_tick_alloc_test_telemetry.csv");
+    std::remove("ai_iv_tick_alloc_test_control.csv");
+    std::remove("ai_iv_tick_alloc_test_session.aivs");
+    std::cout << name << " passed\n";
+}
+
+int main() {
+    test_steady_state_tick_does_not_allocate();
+    return 0;
+}
@@ -0,0 +1,214 @@
+// TimeSeriesStore: rollup accuracy, bounded retention, resolution choice
+// and readers racing the control-loop writer.
+
+#include "../src/timeseries_store.hpp"
+#include "test_support.hpp"
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ivsys;
+
+static constexpr std::int64_t kTickMs = 200;
+
+static void sample_values(std::int64_t tick, double (&v)[kSeriesChannelCount]) {
+    v[0] = 60.0 + 10.0 * std::sin(tick * 0.001);
+    v[1] = 80.0 + 15.0 * std::sin(tick * 0.013);
+    v[2] = 37.0 + 0.01 * static_cast<double>(tick % 7);
+    v[3] = 96.0 - 0.1 * static_cast<double>(tick % 11);
+    v[4] = 1.5 + 0.5 * std::cos(tick * 0.02);
+    v[5] = 5.0;
+    v[6] = 0.4 + 0.001 * static_cast<double>(tick % 100);
+}
+
+static void fill(TimeSeriesStore& store, std::int64_t t0_ms, std::int64_t ticks) {
+    double v[kSeriesChannelCount];
+    for (std::int64_t i = 0; i < ticks; ++i) {
+        sample_values(i, v);
+        store.append(t0_ms + i * kTickMs, v);
+    }
+}
+
+// Every rollup equals the min / max / mean of the raw samples it covers.
+void test_rollups_match_samples() {
+    const char* name = "test_rollups_match_samples";
+    TimeSeriesStore store;
+    const std::int64_t t0 = 1700000400000;   // a Unix-epoch time, ms, on a 10 min boundary
+    const std::int64_t ticks = 90 * 60 * 1000 / kTickMs;
+    fill(store, t0, ticks);
+
+    for (SeriesResolution r : {SeriesResolution::OneSecond, SeriesResolution::OneMinute,
+                               SeriesResolution::TenMinutes}) {
+        const std::int64_t width = TimeSeriesStore::bucket_ms(r);
+        const std::int64_t from = t0 + 30 * 60 * 1000, to = t0 + 90 * 60 * 1000 - 1;
+        TimeSeriesStore::Range range = store.query(from, to, r);
+        const std::string res = series_resolution_name(r);
+        if (!range.complete) fail(name, res + " range reported incomplete");
+        if (range.buckets.size() != static_cast<size_t>((to - from + 1) / width)) {
+            fail(name, res + " bucket count " + std::to_string(range.buckets.size()));
+        }
+        for (const SeriesBucket& b : range.buckets) {
+            std::int64_t first = (b.start_ms - t0) / kTickMs, last = first + width / kTickMs;
+            if (b.samples != static_cast<std::uint64_t>(last - first)) fail(name, res + " samples");
+            for (size_t c = 0; c < kSeriesChannelCount; ++c) {
+                double lo = 1e300, hi = -1e300, sum = 0.0, v[kSeriesChannelCount];
+                for (std::int64_t i = first; i < last; ++i) {
+                    sample_values(i, v);
+                    lo = std::min(lo, v[c]);
+                    hi = std::max(hi, v[c]);
+                    sum += v[c];
+                }
+                double mean = b.mean(static_cast<SeriesChannel>(c));
+                if (b.min[c] != lo || b.max[c] != hi || std::abs(mean - sum / (last - first)) > 1e-9) {
+                    fail(name, res + " channel " + series_channel_name(static_cast<SeriesChannel>(c)));
+                }
+            }
+        }
+    }
+
+    // The newest bucket of each tier is the open one, up to the last tick
+    TimeSeriesStore::Range tail = store.query(store.latest_ms() - 1, store.latest_ms(),
+                                              SeriesResolution::TenMinutes);
+    if (tail.buckets.size() != 1 || tail.buckets[0].samples != 10 * 60 * 1000 / kTickMs) {
+        fail(name, "open ten-minute bucket");
+    }
+    std::cout << name << " passed\n";
+}
+
+void test_retention_is_bounded() {
+    const char* name = "test_retention_is_bounded";
+    TimeSeriesStore::Options options;
+    options.raw_capacity = 100;
+    options.second_capacity = 60;
+    options.minute_capacity = 30;
+    options.ten_minute_capacity = 10;
+    TimeSeriesStore store(options);
+    const size_t bytes = store.memory_bytes();
+
+    const std::int64_t ticks = 3 * 60 * 60 * 1000 / kTickMs;
+    fill(store, 0, ticks);
+    if (store.memory_bytes() != bytes) fail(name, "memory grew");
+    if (store.sample_count() != static_cast<std::uint64_t>(ticks)) fail(name, "sample count");
+
+    const std::int64_t end = store.latest_ms();
+    TimeSeriesStore::Range raw = store.query(0, end, SeriesResolution::Raw);
+    if (raw.buckets.size() != 100 || raw.complete) fail(name, "raw keeps its last 100 samples");
+    if (raw.retained_from_ms != end - 99 * kTickMs) fail(name, "raw retained_from_ms");
+
+    // 30 sealed minutes plus the open one
+    TimeSeriesStore::Range minutes = store.query(0, end, SeriesResolution::OneMinute);
+    if (minutes.buckets.size() != 31 || minutes.complete) fail(name, "minute ring");
+    TimeSeriesStore::Range recent = store.query(minutes.retained_from_ms, end, SeriesResolution::OneMinute);
+    if (!recent.complete || recent.buckets.size() != 31) fail(name, "retained minutes are complete");
+    for (size_t i = 1; i < minutes.buckets.size(); ++i) {
+        if (minutes.buckets[i].start_ms != minutes.buckets[i - 1].start_ms + 60 * 1000) {
+            fail(name, "minute buckets out of order");
+        }
+    }
+    std::cout << name << " passed\n";
+}
+
+void test_auto_resolution() {
+    const char* name = "test_auto_resolution";
+    TimeSeriesStore store;
+    const std::int64_t day_ms = 24 * 60 * 60 * 1000;
+    fill(store, 0, (day_ms + 2 * 60 * 60 * 1000) / kTickMs);
+    const std::int64_t end = store.latest_ms();
+
+    struct Case { std::int64_t span_ms; SeriesResolution expected; } cases[] = {
+        {5 * 60 * 1000, SeriesResolution::Raw},
+        {60 * 60 * 1000, SeriesResolution::OneSecond},
+        {6 * 60 * 60 * 1000, SeriesResolution::OneMinute},
+        {day_ms - 60 * 1000, SeriesResolution::OneMinute},
+        // older than the minute ring holds
+        {2 * day_ms, SeriesResolution::TenMinutes},
+    };
+    for (const Case& c : cases) {
+        SeriesResolution got = store.pick_resolution(end - c.span_ms, end);
+        if (got != c.expected) {
+            fail(name, "span " + std::to_string(c.span_ms) + " ms picked " + series_resolution_name(got));
+        }
+    }
+
+    // A young session is served at full detail however wide the window
+    TimeSeriesStore young;
+    fill(young, day_ms, 60 * 1000 / kTickMs);
+    if (young.pick_resolution(0, young.latest_ms(), 100000000) != SeriesResolution::Raw) {
+        fail(name, "young session");
+    }
+    if (!young.query(0, young.latest_ms(), SeriesResolution::Raw).complete) fail(name, "young complete");
+
+    SeriesResolution parsed = SeriesResolution::Raw;
+    if (!parse_series_resolution("10m", parsed) || parsed != SeriesResolution::TenMinutes) fail(name, "parse");
+    if (parse_series_resolution("5m", parsed) || parsed != SeriesResolution::TenMinutes) fail(name, "bad name");
+    std::cout << name << " passed\n";
+}
+
+void test_clock_step_back_keeps_order() {
+    const char* name = "test_clock_step_back_keeps_order";
+    TimeSeriesStore store;
+    double v[kSeriesChannelCount] = {};
+    store.append(10000, v);
+    store.append(10200, v);
+    store.append(9000, v);     // wall clock stepped back
+    store.append(10400, v);
+    TimeSeriesStore::Range raw = store.query(0, 20000, SeriesResolution::Raw);
+    if (raw.buckets.size() != 4 || raw.buckets[2].start_ms != 10200) fail(name, "raw order");
+    TimeSeriesStore::Range seconds = store.query(0, 20000, SeriesResolution::OneSecond);
+    if (seconds.buckets.size() != 1 || seconds.buckets[0].samples != 4) fail(name, "one second bucket");
+    std::cout << name << " passed\n";
+}
+
+// Readers see every bucket once, in order, and never a torn one.
+void test_readers_during_appends() {
+    const char* name = "test_readers_during_appends";
+    TimeSeriesStore::Options options;
+    options.second_capacity = 64;   // small, so readers race the wrap too
+    TimeSeriesStore store(options);
+    std::atomic<bool> done{false};
+    std::atomic<int> errors{0};
+    std::atomic<std::uint64_t> queries{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&] {
+            while (!done.load(std::memory_order_acquire)) {
+                std::int64_t to = store.latest_ms();
+                TimeSeriesStore::Range range = store.query(to - 20 * 1000, to, SeriesResolution::OneSecond);
+                for (size_t i = 0; i < range.buckets.size(); ++i) {
+                    const SeriesBucket& b = range.buckets[i];
+                    bool open = i + 1 == range.buckets.size();
+                    // Every channel holds the same value at every tick
+                    bool torn = b.min[0] != b.min[6] || b.max[0] != b.max[6] || b.sum[0] != b.sum[6];
+                    bool ordered = i == 0 || b.start_ms > range.buckets[i - 1].start_ms;
+                    if (torn || !ordered || (!open && b.samples != 5) || b.samples > 5) ++errors;
+                }
+                queries.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    double v[kSeriesChannelCount];
+    for (std::int64_t i = 0; i < 200000; ++i) {
+        for (double& x : v) x = static_cast<double>(i);
+        store.append(i * kTickMs, v);
+    }
+    done.store(true, std::memory_order_release);
+    for (std::thread& t : readers) t.join();
+    if (errors.load() != 0) fail(name, std::to_string(errors.load()) + " bad buckets");
+    if (queries.load() == 0) fail(name, "readers never ran");
+    std::cout << name << " passed\n";
+}
+
+int main() {
+    test_rollups_match_samples();
+    test_retention_is_bounded();
+    test_auto_resolution();
+    test_clock_step_back_keeps_order();
+    test_readers_during_appends();
+    return 0;
+}
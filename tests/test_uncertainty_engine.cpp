@@ -0,0 +1,191 @@
+#include "../src/uncertainty_engine.hpp"
+#include "../src/control_cycle.hpp"
+#include "test_support.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace ivsys;
+
+static Telemetry telemetry(int tick, double quality = 0.9) {
+    Telemetry m;
+    m.hydration_pct = 58.0 + 4.0 * std::sin(tick * 0.1);
+    m.heart_rate_bpm = 88.0;
+    m.temp_celsius = 37.2;
+    m.fatigue_idx = 0.4;
+    m.anxiety_idx = 0.2;
+    m.signal_quality = quality;
+    m.spo2_pct = 96.0;
+    m.lactate_mmol = 2.2;
+    m.cardiac_output_L_min = 5.0;
+    return m;
+}
+
+// An estimator, controller and monitor with some history behind them.
+struct Patient {
+    PatientProfile profile = make_profile();
+    StateEstimator estimator{default_energy_proxy()};
+    AdaptiveController controller{profile};
+    SafetyMonitor safety{profile};
+    double rate = 0.4;
+
+    Patient() {
+        for (int i = 0; i < 30; ++i) {
+            PatientState s = estimator.estimate(telemetry(i), profile, rate);
+            rate = controller.decide(s, safety, estimator, 0.2 / 60.0).infusion_ml_per_min;
+            safety.update_volume(rate, 0.2 / 60.0);
+        }
+    }
+
+    RateInterval evaluate(UncertaintyEngine& engine, const Telemetry& m) {
+        return engine.evaluate(m, profile, estimator, controller, safety, rate, 0.2 / 60.0);
+    }
+};
+
+static bool same_distribution(const RateInterval& a, const RateInterval& b) {
+    return a.samples == b.samples && a.nominal == b.nominal && a.mean == b.mean && a.sd == b.sd &&
+           a.lower == b.lower && a.median == b.median && a.upper == b.upper &&
+           a.fallback_fraction == b.fallback_fraction &&
+           a.safety_limited_fraction == b.safety_limited_fraction &&
+           a.predictive_boost_fraction == b.predictive_boost_fraction;
+}
+
+void test_zero_noise_collapses_to_nominal() {
+    const char* name = "test_zero_noise_collapses_to_nominal";
+    Patient p;
+    UncertaintyEngine::Options options;
+    options.samples = 128;
+    options.worker_threads = 2;
+    options.noise = SensorNoiseModel{0, 0, 0, 0, 0, 0, 0, 0, 0};
+    UncertaintyEngine engine(options);
+    RateInterval r = p.evaluate(engine, telemetry(30));
+    if (r.samples != 128) fail(name, "sample count");
+    if (r.lower != r.nominal || r.upper != r.nominal || r.median != r.nominal || r.sd > 1e-12) {
+        fail(name, "noise-free samples differ from the nominal decision");
+    }
+    std::cout << name << " passed\n";
+}
+
+void test_independent_of_worker_count() {
+    const char* name = "test_independent_of_worker_count";
+    Patient p;
+    RateInterval baseline;
+    for (size_t workers : {1, 3, 4}) {
+        UncertaintyEngine::Options options;
+        options.samples = 500;
+        options.worker_threads = workers;
+        UncertaintyEngine engine(options);
+        RateInterval r = p.evaluate(engine, telemetry(30));
+        if (workers == 1) baseline = r;
+        else if (!same_distribution(r, baseline)) fail(name, std::to_string(workers) + " workers");
+    }
+    std::cout << name << " passed\n";
+}
+
+void test_interval_shape_and_inputs_untouched() {
+    const char* name = "test_interval_shape_and_inputs_untouched";
+    Patient p;
+    Patient reference;
+    UncertaintyEngine::Options options;
+    options.samples = 2000;
+    options.worker_threads = 2;
+    UncertaintyEngine engine(options);
+    RateInterval r = p.evaluate(engine, telemetry(30));
+    if (!(r.lower <= r.median && r.median <= r.upper)) fail(name, "quantiles out of order");
+    if (!(r.sd > 0.0 && r.upper > r.lower)) fail(name, "sensor noise produced no spread");
+    if (r.lower < 0.0 || r.upper > p.profile.max_safe_infusion_rate) fail(name, "rate outside bounds");
+    if (std::abs(r.coverage - 0.90) > 1e-12) fail(name, "coverage");
+
+    // Noisier sensors, wider interval.
+    options.noise.hydration_pct *= 4.0;
+    options.noise.heart_rate_bpm *= 4.0;
+    UncertaintyEngine noisy(options);
+    RateInterval wide = p.evaluate(noisy, telemetry(30));
+    if (!(wide.upper - wide.lower > r.upper - r.lower)) fail(name, "more noise did not widen the interval");
+
+    // The patient's own objects are unchanged: their next decision matches
+    // one made without the engine.
+    Telemetry next = telemetry(31);
+    PatientState s1 = p.estimator.estimate(next, p.profile, p.rate);
+    PatientState s2 = reference.estimator.estimate(next, reference.profile, reference.rate);
+    ControlOutput c1 = p.controller.decide(s1, p.safety, p.estimator, 0.2 / 60.0);
+    ControlOutput c2 = reference.controller.decide(s2, reference.safety, reference.estimator, 0.2 / 60.0);
+    if (c1.infusion_ml_per_min != c2.infusion_ml_per_min) fail(name, "evaluate() changed the patient");
+    std::cout << name << " passed\n";
+}
+
+void test_sample_budget() {
+    const char* name = "test_sample_budget";
+    Patient p;
+    UncertaintyEngine::Options options;
+    options.samples = 256;
+    options.min_samples = 64;
+    options.max_samples = 8192;
+    options.worker_threads = 2;
+    options.budget = std::chrono::milliseconds(5);
+    UncertaintyEngine engine(options);
+    for (int i = 0; i < 5; ++i) p.evaluate(engine, telemetry(30 + i));
+    size_t next = engine.sample_count();
+    if (next < options.min_samples || next > options.max_samples) fail(name, "count outside limits");
+    double planned_ns = static_cast<double>(next) * engine.ns_per_sample();
+    double budget_ns = 5e6 * UncertaintyEngine::kBudgetHeadroom;
+    if (next > options.min_samples && next < options.max_samples &&
+        (planned_ns > budget_ns || planned_ns + engine.ns_per_sample() <= budget_ns)) {
+        fail(name, "count is not the largest that fits the budget");
+    }
+    if (engine.latency().count != 5) fail(name, "evaluations not recorded");
+
+    auto points = engine.profile_latency({64, 256, 1024}, 3, telemetry(40), p.profile, p.estimator,
+                                         p.controller, p.safety, p.rate, 0.2 / 60.0);
+    if (points.size() != 3 || points[1].samples != 256 || points[1].max < points[1].median) {
+        fail(name, "latency profile");
+    }
+    if (engine.sample_count() != next) fail(name, "profiling moved the adaptive count");
+
+    std::vector<UncertaintyEngine::LatencyPoint> synthetic = {
+        {256, std::chrono::milliseconds(10), std::chrono::milliseconds(20)},
+        {1024, std::chrono::milliseconds(60), std::chrono::milliseconds(150)},
+        {4096, std::chrono::milliseconds(180), std::chrono::milliseconds(260)},
+    };
+    if (UncertaintyEngine::largest_within(synthetic, std::chrono::milliseconds(200)) != 1024 ||
+        UncertaintyEngine::largest_within(synthetic, std::chrono::milliseconds(5)) != 0) {
+        fail(name, "largest_within");
+    }
+    std::cout << name << " passed\n";
+}
+
+void test_cycle_decisions_unchanged() {
+    const char* name = "test_cycle_decisions_unchanged";
+    UncertaintyEngine::Options options;
+    options.samples = 256;
+    options.worker_threads = 2;
+    UncertaintyEngine engine(options);
+    PatientControlCycle with(make_profile(), "mc_test_with");
+    PatientControlCycle without(make_profile(), "mc_test_without");
+    with.set_uncertainty_engine(&engine);
+    for (int i = 0; i < 40; ++i) {
+        CycleResult a = with.step(telemetry(i, i % 5 == 0 ? 0.3 : 0.9), 0.2);
+        CycleResult b = without.step(telemetry(i, i % 5 == 0 ? 0.3 : 0.9), 0.2);
+        if (a.rate_interval.samples != 256 || b.rate_interval.samples != 0) fail(name, "interval presence");
+        if (a.command.infusion_ml_per_min != b.command.infusion_ml_per_min) fail(name, "decision changed");
+        if (a.command.infusion_ml_per_min != a.rate_interval.nominal) fail(name, "nominal differs from the decision");
+    }
+    for (const char* s : {"with", "without"}) {
+        std::string id = std::string("mc_test_") + s;
+        std::remove(("ai_iv_" + id + "_system.log").c_str());
+        std::remove(("ai_iv_" + id + "_telemetry.csv").c_str());
+        std::remove(("ai_iv_" + id + "_control.csv").c_str());
+    }
+    std::cout << name << " passed\n";
+}
+
+int main() {
+    test_zero_noise_collapses_to_nominal();
+    test_independent_of_worker_count();
+    test_interval_shape_and_inputs_untouched();
+    test_sample_budget();
+    test_cycle_decisions_unchanged();
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include "../src/domains/metabojoint_population.hpp"
+#include "test_support.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ai_iv::domains::metabojoint;
+
+// A spread of parameterizations around the V3.1 defaults, some of which
+// never breach the steric trap.
+static std::vector<VaultParams> swept_params(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::vector<VaultParams> params(n);
+    for (VaultParams& p : params) {
+        p.hydrodynamic_radius_nm = 4.0 + 9.0 * u(rng);
+        p.overlap_param_y = 0.5 + u(rng);
+        p.vol_fraction_v2s = 0.05 + 0.3 * u(rng);
+        p.cleavage_ph_max = 6.8 + 0.5 * u(rng);
+        p.cathepsin_threshold = 0.2 * u(rng);
+        p.cleavage_gain_pct = 4.0 * u(rng);
+        p.release_gain_per_min = 0.2 + 1.5 * u(rng);
+    }
+    return params;
+}
+
+static bool same_state(const VaultPopulation& pop, size_t i, const MetaboJointVault& v) {
+    return pop.mesh_size(i) == v.get_mesh_size() && pop.payload_remaining(i) == v.get_payload_remaining() &&
+           pop.cleavage_progression(i) == v.get_cleavage_progression() &&
+           pop.is_steric_cage_breached(i) == v.is_steric_cage_breached();
+}
+
+void test_step_matches_scalar() {
+    const char* name = "test_step_matches_scalar";
+    const size_t n = 37;   // not a whole tile: padding lanes in play
+    std::vector<VaultParams> params = swept_params(n, 7);
+    VaultPopulation pop(params);
+    std::vector<MetaboJointVault> vaults(params.begin(), params.end());
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> ph_dist(6.0, 8.5), cat_dist(-0.1, 1.1);
+    std::vector<double> ph(n), cat(n), released(n);
+    for (int tick = 0; tick < 400; ++tick) {
+        for (size_t i = 0; i < n; ++i) {
+            ph[i] = ph_dist(rng);
+            cat[i] = cat_dist(rng);
+        }
+        pop.update_telemetry(ph.data(), cat.data());
+        double total = pop.tick_elution(0.2, released.data());
+        double expected_total = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            vaults[i].update_telemetry(ph[i], cat[i]);
+            double r = vaults[i].tick_elution(0.2);
+            expected_total += r;
+            if (released[i] != r) fail(name, "release differs at vault " + std::to_string(i));
+            if (!same_state(pop, i, vaults[i])) fail(name, "state differs at vault " + std::to_string(i));
+        }
+        if (total != expected_total) fail(name, "total release");
+    }
+    size_t breached = 0;
+    for (const MetaboJointVault& v : vaults) breached += v.is_steric_cage_breached();
+    if (breached == 0 || breached == n || pop.breached_count() != breached) fail(name, "breach coverage");
+    if (pop.ticks() != 400) fail(name, "tick count");
+    std::cout << name << " passed\n";
+}
+
+void test_fast_forward_matches_scalar() {
+    const char* name = "test_fast_forward_matches_scalar";
+    const size_t n = 50;
+    std::vector<VaultParams> params = swept_params(n, 3);
+    VaultPopulation pop(params);
+    std::vector<MetaboJointVault> vaults(params.begin(), params.end());
+
+    // Piecewise-constant trajectory: circulation, marrow niche, washout.
+    struct Segment { size_t steps; double ph; double cat; double dt; };
+    const Segment segments[] = {{150, 7.4, 0.05, 0.2}, {37, 6.9, 0.6, 0.2}, {500, 6.7, 0.9, 1.0},
+                                {0, 6.7, 0.9, 1.0}, {3000, 7.3, 0.0, 5.0}};
+    const size_t record_every = 7;
+    ElutionCurve curve;
+    std::vector<std::vector<double>> expected;   // per recorded tick
+    size_t tick = 0;
+    for (const Segment& s : segments) {
+        std::vector<double> ph(n), cat(n);
+        for (size_t i = 0; i < n; ++i) {
+            ph[i] = s.ph + 0.02 * static_cast<double>(i % 5);
+            cat[i] = s.cat * (0.5 + 0.01 * static_cast<double>(i));
+        }
+        pop.fast_forward(s.steps, s.dt, ph.data(), cat.data(), &curve, record_every);
+        for (size_t step = 0; step < s.steps; ++step) {
+            for (size_t i = 0; i < n; ++i) {
+                vaults[i].update_telemetry(ph[i], cat[i]);
+                vaults[i].tick_elution(s.dt);
+            }
+            if (++tick % record_every == 0) {
+                expected.emplace_back();
+                for (const MetaboJointVault& v : vaults) expected.back().push_back(v.get_payload_remaining());
+            }
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (!same_state(pop, i, vaults[i])) fail(name, "state differs at vault " + std::to_string(i));
+        }
+    }
+    if (pop.ticks() != tick || curve.vaults != n || curve.samples() != expected.size()) {
+        fail(name, "curve shape");
+    }
+    for (size_t k = 0; k < expected.size(); ++k) {
+        for (size_t i = 0; i < n; ++i) {
+            if (curve.payload(k, i) != expected[k][i]) fail(name, "curve sample " + std::to_string(k));
+        }
+    }
+    size_t eluted = 0;
+    for (size_t i = 0; i < n; ++i) eluted += pop.payload_remaining(i) < 100.0;
+    if (eluted == 0 || eluted == n) fail(name, "trajectory does not separate the parameterizations");
+    if (std::abs(curve.elapsed_seconds.front() - 7 * 0.2) > 1e-12) fail(name, "sample times");
+    std::cout << name << " passed\n";
+}
+
+void test_sealed_population_holds_payload() {
+    const char* name = "test_sealed_population_holds_payload";
+    VaultPopulation pop(10);
+    pop.fast_forward(24 * 3600, 1.0, 7.4, 0.9);
+    for (size_t i = 0; i < pop.size(); ++i) {
+        if (pop.payload_remaining(i) != 100.0 || pop.is_steric_cage_breached(i)) {
+            fail(name, "steric trap leaked at pH 7.4");
+        }
+    }
+    if (pop.elapsed_seconds() != 24 * 3600.0) fail(name, "clock");
+    std::cout << name << " passed\n";
+}
+
+int main() {
+    test_step_matches_scalar();
+    test_fast_forward_matches_scalar();
+    test_sealed_population_holds_payload();
+    return 0;
+}
@@ -0,0 +1,760 @@
+/*
+ * bench_control_loop.cpp
+ *
+ * Per-stage microbenchmarks for the control loop, emitted as JSON so
+ * results can be diffed across releases and used to size hardware.
+ *
+ * Usage:
+ *   ai_iv_bench [--filter SUBSTR] [--min-time-ms N] [--samples N]
+ *               [--out FILE] [--label TEXT] [--list]
+ *
+ * Every case is calibrated so that --samples timed batches take about
+ * --min-time-ms in total; ns_per_op gives min / median / mean / max over
+ * the batches (track the median).  A summary table goes to stderr and the
+ * JSON document to --out (default stdout):
+ *
+ *   {"schema": "ai-iv-bench/1", "label": "...",
+ *    "build": {"compiler": "...", "fast_math": false, "neural": false},
+ *    "host": {"system": "Linux", "machine": "x86_64", "hardware_threads": 8},
+ *    "results": [{"name": "state_estimator.estimate", "iterations": 123456,
+ *                 "samples": 5, "ns_per_op": {"min": ..., "median": ...,
+ *                 "mean": ..., "max": ...}, "ops_per_sec": ..., "extra": {}}]}
+ *
+ * rest.http.* cases time a loopback keep-alive GET after a publish (so
+ * the body is re-serialized every time); their "extra" holds the server's
+ * own p50/p99 handling latency.  logger.* cases write ai_iv_bench_*
+ * session files and delete them afterwards.
+ */
+
+#include "AdaptiveController.hpp"
+#include "BatchStateEstimator.hpp"
+#include "EnergyProxyModel.hpp"
+#include "ForwardPredictor.hpp"
+#include "SafetyMonitor.hpp"
+#include "StateEstimator.hpp"
+#include "SystemLogger.hpp"
+#include "Utils.hpp"
+#include "control_cycle.hpp"
+#include "domains/metabojoint_population.hpp"
+#include "json_format.hpp"
+#include "precision_spine/PrecisionSpine.hpp"
+#include "rest_api_server.hpp"
+#include "uncertainty_engine.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <sys/utsname.h>
+
+#ifndef NEURAL_MODEL_PATH
+#define NEURAL_MODEL_PATH "models/sensor_fusion_fdeep.json"
+#endif
+
+using namespace ivsys;
+
+namespace {
+
+// Keeps the compiler from discarding a benchmarked result.
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+struct BenchOptions {
+    std::string filter;
+    double min_time_ms = 200.0;
+    size_t samples = 5;
+    bool list_only = false;
+};
+
+struct BenchResult {
+    std::string name;
+    std::uint64_t iterations = 0;   // per sample
+    size_t samples = 0;
+    double min_ns = 0.0;
+    double median_ns = 0.0;
+    double mean_ns = 0.0;
+    double max_ns = 0.0;
+    std::vector<std::pair<std::string, double>> extra;
+};
+
+class BenchRunner {
+public:
+    explicit BenchRunner(BenchOptions options) : options_(std::move(options)) {}
+
+    bool wants(const std::string& name) const {
+        return options_.filter.empty() || name.find(options_.filter) != std::string::npos;
+    }
+
+    template <typename Op>
+    void run(const std::string& name, Op&& op) {
+        run_paced(name, op, 0, [] {});
+    }
+
+    // As run(), but timed batches hold at most `every` operations (0: no
+    // limit) and pause() runs untimed after each one, e.g. to let a
+    // consumer thread drain.
+    template <typename Op, typename Pause>
+    void run_paced(const std::string& name, Op&& op, std::uint64_t every, Pause&& pause) {
+        if (!wants(name)) return;
+        if (options_.list_only) {
+            std::cout << name << "\n";
+            return;
+        }
+        results_.push_back(measure(name, op, every, pause));
+        const BenchResult& r = results_.back();
+        std::cerr << std::left << std::setw(34) << r.name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12) << r.median_ns << " ns/op"
+                  << std::setw(12) << r.min_ns << " min" << std::setw(12) << r.max_ns << " max\n";
+    }
+
+    // Attaches a named value to the result of an already-run case.
+    void annotate(const std::string& name, const std::string& key, double value) {
+        for (auto& r : results_) {
+            if (r.name == name) r.extra.emplace_back(key, value);
+        }
+    }
+
+    bool list_only() const { return options_.list_only; }
+    const std::vector<BenchResult>& results() const { return results_; }
+
+private:
+    template <typename Op, typename Pause>
+    BenchResult measure(const std::string& name, Op& op, std::uint64_t every, Pause& pause) {
+        using clock = std::chrono::steady_clock;
+        const std::uint64_t limit = every == 0 ? std::uint64_t{1} << 40 : every;
+        auto time_batch = [&](std::uint64_t n) {
+            auto start = clock::now();
+            for (std::uint64_t i = 0; i < n; ++i) op();
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start);
+            pause();
+            return static_cast<double>(elapsed.count());
+        };
+
+        // Warm up and find a batch size that takes at least 1 ms.
+        std::uint64_t n = 1;
+        double elapsed = time_batch(n);
+        while (elapsed < 1e6 && n < limit) {
+            n = std::min(n * 2, limit);
+            elapsed = time_batch(n);
+        }
+        double per_op = elapsed / static_cast<double>(n);
+        size_t samples = std::max<size_t>(options_.samples, 1);
+        double sample_budget_ns = options_.min_time_ms * 1e6 / static_cast<double>(samples);
+        std::uint64_t iterations = std::clamp<std::uint64_t>(
+            static_cast<std::uint64_t>(sample_budget_ns / std::max(per_op, 1.0)), 1, limit);
+
+        std::vector<double> per_sample;
+        per_sample.reserve(samples);
+        for (size_t s = 0; s < samples; ++s) {
+            per_sample.push_back(time_batch(iterations) / static_cast<double>(iterations));
+        }
+        std::sort(per_sample.begin(), per_sample.end());
+
+        BenchResult r;
+        r.name = name;
+        r.iterations = iterations;
+        r.samples = samples;
+        r.min_ns = per_sample.front();
+        r.max_ns = per_sample.back();
+        r.median_ns = samples % 2 ? per_sample[samples / 2]
+                                  : 0.5 * (per_sample[samples / 2 - 1] + per_sample[samples / 2]);
+        double sum = 0.0;
+        for (double v : per_sample) sum += v;
+        r.mean_ns = sum / static_cast<double>(samples);
+        return r;
+    }
+
+    BenchOptions options_;
+    std::vector<BenchResult> results_;
+};
+
+PatientProfile reference_profile() {
+    PatientProfile p;
+    p.weight_kg = 75.0;
+    p.age_years = 35.0;
+    p.baseline_hr_bpm = 70.0;
+    p.max_safe_infusion_rate = 1.5;
+    p.current_tissue_perfusion = 0.85;
+    p.energy_params = EnergyTransferParams();
+    return p;
+}
+
+// Deterministic telemetry covering normal and stressed physiology, so the
+// branches in the estimator and controller are all exercised.
+std::vector<Telemetry> telemetry_corpus(size_t count) {
+    std::mt19937 rng(20240601);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::vector<Telemetry> corpus(count);
+    for (size_t i = 0; i < count; ++i) {
+        Telemetry& m = corpus[i];
+        double t = 0.2 * static_cast<double>(i);
+        m.hydration_pct = 60.0 + 15.0 * std::sin(t * 0.05) + 2.0 * u(rng);
+        m.heart_rate_bpm = 75.0 + 30.0 * std::sin(t * 0.1) + 4.0 * u(rng);
+        m.temp_celsius = 37.0 + 0.5 * std::sin(t * 0.03);
+        m.blood_loss_idx = 0.1 * u(rng);
+        m.fatigue_idx = 0.3 + 0.3 * std::sin(t * 0.02);
+        m.anxiety_idx = 0.2;
+        m.signal_quality = 0.5 + 0.5 * u(rng);
+        m.spo2_pct = 94.0 + 4.0 * std::sin(t * 0.08);
+        m.lactate_mmol = 2.0 + 1.5 * std::sin(t * 0.04);
+        m.cardiac_output_L_min = 5.0 + std::sin(t * 0.06);
+    }
+    return corpus;
+}
+
+// Stepping through a corpus whose size is a power of two.
+struct Cursor {
+    size_t i = 0;
+    size_t next(size_t mask) { return i++ & mask; }
+};
+
+void bench_estimator(BenchRunner& bench, const std::vector<Telemetry>& corpus,
+                     const PatientProfile& profile) {
+    const size_t mask = corpus.size() - 1;
+
+    StateEstimator estimator(rule_energy_proxy());
+    Cursor c;
+    bench.run("state_estimator.estimate", [&] {
+        PatientState s = estimator.estimate(corpus[c.next(mask)], profile, 0.5);
+        keep(s);
+    });
+    bench.run("state_estimator.predict_forward", [&] {
+        auto s = estimator.predict_forward(15);
+        keep(s);
+    });
+
+    std::vector<PatientState> states;
+    StateEstimator warm(rule_energy_proxy());
+    for (const Telemetry& m : corpus) states.push_back(warm.estimate(m, profile, 0.5));
+    // update() plus the four published horizons, i.e. every cache miss a tick can cause.
+    ForwardPredictor predictor;
+    bench.run("forward_predictor.update_predict4", [&] {
+        predictor.update(states[c.next(mask)]);
+        ForwardPrediction out[std::size(config::PUBLISHED_PREDICTION_HORIZON_STEPS)];
+        size_t n = predictor.predict(config::PUBLISHED_PREDICTION_HORIZON_STEPS,
+                                     std::size(config::PUBLISHED_PREDICTION_HORIZON_STEPS), out);
+        keep(n);
+        keep(out[0]);
+    });
+    bench.run("precision_spine.dose_route", [&] {
+        auto f = precision_spine::dose_route(states[c.next(mask)]);
+        keep(f);
+    });
+    std::vector<precision_spine::TreatmentFlow> flows;
+    for (const PatientState& s : states) flows.push_back(precision_spine::dose_route(s));
+    bench.run("precision_spine.reject_noise", [&] {
+        auto f = precision_spine::reject_noise(flows[c.next(mask)]);
+        keep(f);
+    });
+    bench.run("precision_spine.fallback_floor", [&] {
+        auto s = precision_spine::fallback_floor(flows[c.next(mask)]);
+        keep(s);
+    });
+
+    // Whole spine over 4096 flows: per-flow scalar stages vs route_batch
+    // in place over an align_buffer() (including loading the raw states).
+    const size_t spine_rows = 4096;
+    std::vector<PatientState> validated(spine_rows);
+    bench.run("precision_spine.scalar_4096", [&] {
+        for (size_t i = 0; i < spine_rows; ++i) {
+            validated[i] = precision_spine::fallback_floor(
+                precision_spine::reject_noise(precision_spine::dose_route(states[i & mask])));
+        }
+        keep(validated);
+    });
+    std::vector<precision_spine::TreatmentFlow> batch_flows = precision_spine::align_buffer(spine_rows);
+    bench.run("precision_spine.route_batch_4096", [&] {
+        for (size_t i = 0; i < spine_rows; ++i) batch_flows[i].state = states[i & mask];
+        precision_spine::route_batch(batch_flows);
+        keep(batch_flows);
+    });
+
+    SafetyMonitor safety(profile);
+    bench.run("safety_monitor.evaluate", [&] {
+        auto check = safety.evaluate(0.8, states[c.next(mask)], 0.2 / 60.0);
+        keep(check);
+    });
+    AdaptiveController controller(profile);
+    bench.run("adaptive_controller.decide", [&] {
+        ControlOutput out = controller.decide(states[c.next(mask)], safety, estimator, 0.2 / 60.0);
+        keep(out);
+    });
+    // One Monte Carlo interval at a fixed 256 samples on two workers.
+    if (bench.wants("uncertainty_engine.evaluate_256")) {
+        UncertaintyEngine::Options mc;
+        mc.samples = 256;
+        mc.worker_threads = 2;
+        UncertaintyEngine engine(mc);
+        bench.run("uncertainty_engine.evaluate_256", [&] {
+            RateInterval r = engine.evaluate(corpus[c.next(mask)], profile, estimator, controller,
+                                             safety, 0.5, 0.2 / 60.0);
+            keep(r);
+        });
+        bench.annotate("uncertainty_engine.evaluate_256", "samples", 256.0);
+    }
+
+    TelemetryBatch batch;
+    batch.reserve(4096);
+    for (size_t i = 0; i < 4096; ++i) batch.push_back(corpus[i & mask], profile.age_years);
+    StateBatch scored;
+    if (bench.wants("batch_state_estimator.fleet_4096")) {
+        bench.run("batch_state_estimator.fleet_4096", [&] {
+            BatchStateEstimator::estimate(batch, BatchLayout::Fleet, scored);
+            keep(scored);
+        });
+        bench.annotate("batch_state_estimator.fleet_4096", "rows", 4096.0);
+    }
+}
+
+void bench_energy_proxy(BenchRunner& bench, const std::vector<Telemetry>& corpus) {
+    const size_t mask = corpus.size() - 1;
+    Cursor c;
+    auto run_model = [&](const std::string& name, const EnergyProxyModel& model) {
+        bench.run(name, [&] {
+            double e = model.energy_proxy(corpus[c.next(mask)]);
+            keep(e);
+        });
+    };
+
+    run_model("energy_proxy.rule", *rule_energy_proxy());
+    const std::string kernel_case = "energy_proxy.kernel";
+    if (bench.wants(kernel_case) && !bench.list_only()) {
+        try {
+            KernelEnergyProxy kernel(NEURAL_MODEL_PATH);
+            run_model(kernel_case, kernel);
+        } catch (const std::exception& e) {
+            std::cerr << "Skipping " << kernel_case << ": " << e.what() << "\n";
+        }
+    } else {
+        bench.run(kernel_case, [] {});
+    }
+
+    // Cold model load, per format: what a new patient cycle would pay
+    const std::string path = NEURAL_MODEL_PATH;
+    const struct { const char* name; ModelFormat format; } loads[] = {
+        {"energy_proxy.load_json", ModelFormat::Json},
+        {"energy_proxy.load_blob", ModelFormat::Blob},
+    };
+    for (const auto& l : loads) {
+        if (bench.wants(l.name) && !bench.list_only()) {
+            try {
+                KernelEnergyProxy probe(path, l.format);
+                bench.run(l.name, [&] {
+                    KernelEnergyProxy model(path, l.format);
+                    keep(model);
+                });
+            } catch (const std::exception& e) {
+                std::cerr << "Skipping " << l.name << ": " << e.what() << "\n";
+            }
+        } else {
+            bench.run(l.name, [] {});
+        }
+    }
+#ifdef ENABLE_NEURAL_ESTIMATOR
+    const std::string neural_case = "energy_proxy.neural";
+    if (bench.wants(neural_case) && !bench.list_only()) {
+        try {
+            NeuralEnergyProxy neural(NEURAL_MODEL_PATH);
+            run_model(neural_case, neural);
+        } catch (const std::exception& e) {
+            std::cerr << "Skipping " << neural_case << ": " << e.what() << "\n";
+        }
+    } else {
+        bench.run(neural_case, [] {});
+    }
+#endif
+}
+
+void remove_session_files(const std::string& session_id) {
+    const std::string prefix = "ai_iv_" + session_id;
+    for (const char* suffix : {"_system.log", "_telemetry.csv", "_control.csv", "_session.aivs"}) {
+        std::remove((prefix + suffix).c_str());
+    }
+}
+
+void bench_logger(BenchRunner& bench, const std::vector<Telemetry>& corpus,
+                  const PatientProfile& profile) {
+    const size_t mask = corpus.size() - 1;
+    std::vector<std::pair<ControlOutput, PatientState>> decisions;
+    {
+        StateEstimator estimator(rule_energy_proxy());
+        SafetyMonitor safety(profile);
+        AdaptiveController controller(profile);
+        for (const Telemetry& m : corpus) {
+            PatientState s = estimator.estimate(m, profile, 0.5);
+            decisions.emplace_back(controller.decide(s, safety, estimator, 0.2 / 60.0), s);
+        }
+    }
+
+    struct Variant {
+        const char* name;
+        LoggerMode mode;
+        SessionFormat format;
+    };
+    const Variant variants[] = {
+        {"sync_csv", LoggerMode::Sync, SessionFormat::Csv},
+        {"sync_binary", LoggerMode::Sync, SessionFormat::Binary},
+        {"async_csv", LoggerMode::Async, SessionFormat::Csv},
+    };
+    for (const Variant& v : variants) {
+        const std::string telemetry_case = std::string("logger.") + v.name + ".telemetry";
+        const std::string control_case = std::string("logger.") + v.name + ".control";
+        if (!bench.wants(telemetry_case) && !bench.wants(control_case)) continue;
+        if (bench.list_only()) {
+            bench.run(telemetry_case, [] {});
+            bench.run(control_case, [] {});
+            continue;
+        }
+
+        const std::string session_id = std::string("bench_") + v.name;
+        {
+            SystemLogger logger(session_id, v.mode, SystemLogger::kDefaultQueueCapacity, v.format);
+            // Async cases time the enqueue only: batches stay at half the
+            // queue and the writer drains between them, so nothing is dropped.
+            const std::uint64_t every =
+                v.mode == LoggerMode::Async ? SystemLogger::kDefaultQueueCapacity / 2 : 0;
+            auto drain = [&logger] {
+                while (logger.stats().queue_depth > 0) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+            };
+            Cursor c;
+            bench.run_paced(telemetry_case, [&] { logger.log_telemetry(corpus[c.next(mask)]); },
+                            every, drain);
+            bench.run_paced(control_case, [&] {
+                const auto& d = decisions[c.next(mask)];
+                logger.log_control(d.first, d.second, corpus[c.i & mask].timestamp);
+            }, every, drain);
+            if (v.mode == LoggerMode::Async) {
+                double dropped = static_cast<double>(logger.stats().dropped);
+                bench.annotate(telemetry_case, "dropped", dropped);
+                bench.annotate(control_case, "dropped", dropped);
+            }
+        }
+        remove_session_files(session_id);
+    }
+}
+
+void bench_control_cycle(BenchRunner& bench, const std::vector<Telemetry>& corpus,
+                         const PatientProfile& profile) {
+    const std::string name = "control_cycle.step";
+    if (!bench.wants(name)) return;
+    if (bench.list_only()) {
+        bench.run(name, [] {});
+        return;
+    }
+    const std::string session_id = "bench_cycle";
+    {
+        const size_t mask = corpus.size() - 1;
+        PatientControlCycle cycle(profile, session_id, LoggerMode::Async, SessionFormat::Binary,
+                                  rule_energy_proxy());
+        Cursor c;
+        bench.run(name, [&] {
+            CycleResult r = cycle.step(corpus[c.next(mask)], 0.2);
+            keep(r);
+        });
+    }
+    remove_session_files(session_id);
+}
+
+// Scalar vault tick vs the population, and a 24 h elution curve
+// (1 s steps, one sample a minute) for 10k vaults.
+void bench_vault(BenchRunner& bench) {
+    using namespace ai_iv::domains::metabojoint;
+    MetaboJointVault vault;
+    bench.run("metabojoint.vault_tick", [&] {
+        vault.update_telemetry(6.8, 0.7);
+        double released = vault.tick_elution(0.2);
+        keep(released);
+    });
+
+    const size_t vaults = 10000;
+    std::vector<VaultParams> params(vaults);
+    for (size_t i = 0; i < vaults; ++i) {
+        params[i].hydrodynamic_radius_nm = 6.0 + 5.0 * static_cast<double>(i) / vaults;
+        params[i].release_gain_per_min = 0.2 + static_cast<double>(i % 7) / 7.0;
+    }
+    if (bench.wants("vault_population.tick_10k")) {
+        VaultPopulation population(params);
+        bench.run("vault_population.tick_10k", [&] {
+            population.update_telemetry(6.8, 0.7);
+            double released = population.tick_elution(0.2);
+            keep(released);
+        });
+        bench.annotate("vault_population.tick_10k", "vaults", static_cast<double>(vaults));
+    }
+    const std::string curve_case = "vault_population.fast_forward_24h_10k";
+    if (bench.wants(curve_case)) {
+        bench.run(curve_case, [&] {
+            VaultPopulation population(params);
+            ElutionCurve curve;
+            population.fast_forward(3600, 1.0, 7.4, 0.05, &curve, 60);        // circulation
+            population.fast_forward(23 * 3600, 1.0, 6.8, 0.7, &curve, 60);    // marrow niche
+            keep(curve.payload_pct.back());
+        });
+        bench.annotate(curve_case, "vaults", static_cast<double>(vaults));
+    }
+}
+
+// Formats a PatientState the way /api/state does.
+void append_state_fields(std::string& json, const PatientState& s) {
+    json += "{\"hydration_pct\":";
+    json::append_fixed(json, s.hydration_pct, 2);
+    json += ",\"energy_T\":";
+    json::append_fixed(json, s.energy_T, 3);
+    json += ",\"metabolic_load\":";
+    json::append_fixed(json, s.metabolic_load, 3);
+    json += ",\"cardiac_reserve\":";
+    json::append_fixed(json, s.cardiac_reserve, 3);
+    json += ",\"risk_score\":";
+    json::append_fixed(json, s.risk_score, 3);
+    json += "}";
+}
+
+int connect_loopback(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// One keep-alive GET; returns false on any I/O or framing error.
+bool http_get(int fd, const std::string& request, std::string& pending) {
+    size_t off = 0;
+    while (off < request.size()) {
+        ssize_t n = send(fd, request.data() + off, request.size() - off, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        off += static_cast<size_t>(n);
+    }
+    char buf[16384];
+    for (;;) {
+        size_t header_end = pending.find("\r\n\r\n");
+        if (header_end != std::string::npos) {
+            size_t cl = pending.find("Content-Length: ");
+            if (cl == std::string::npos || cl > header_end) return false;
+            size_t length = std::strtoul(pending.c_str() + cl + 16, nullptr, 10);
+            size_t total = header_end + 4 + length;
+            if (pending.size() >= total) {
+                pending.erase(0, total);
+                return true;
+            }
+        }
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) return false;
+        pending.append(buf, static_cast<size_t>(n));
+    }
+}
+
+void bench_rest(BenchRunner& bench, const std::vector<Telemetry>& corpus,
+                const PatientProfile& profile) {
+    const size_t mask = corpus.size() - 1;
+    std::vector<PatientState> states;
+    {
+        StateEstimator estimator(rule_energy_proxy());
+        for (const Telemetry& m : corpus) states.push_back(estimator.estimate(m, profile, 0.5));
+    }
+    Cursor c;
+    std::string json;
+    bench.run("rest.json.state", [&] {
+        json.clear();
+        append_state_fields(json, states[c.next(mask)]);
+        keep(json);
+    });
+    const std::string rationale = "Hydration deficit; coherence modulation applied (sigma=0.62)";
+    bench.run("rest.json.escaped_rationale", [&] {
+        json.clear();
+        json::append_escaped(json, rationale);
+        keep(json);
+    });
+
+    struct Endpoint {
+        const char* name;
+        const char* path;
+        const char* server_endpoint;   // RestApiServer::endpoint_latencies() label
+    };
+    const Endpoint endpoints[] = {
+        {"rest.http.state", "/api/state", "/api/state"},
+        {"rest.http.telemetry", "/api/telemetry", "/api/telemetry"},
+        {"rest.http.telemetry_history", "/api/telemetry/history", "/api/telemetry/history"},
+    };
+    bool any = false;
+    for (const Endpoint& e : endpoints) any = any || bench.wants(e.name);
+    if (!any) return;
+    if (bench.list_only()) {
+        for (const Endpoint& e : endpoints) bench.run(e.name, [] {});
+        return;
+    }
+
+    RestApiServer server(0, "127.0.0.1", 1);
+    if (!server.start()) {
+        std::cerr << "Skipping rest.http.*: server did not start\n";
+        return;
+    }
+    // Fill the history ring so /api/telemetry/history returns a full page.
+    for (size_t i = 0; i < 1000; ++i) server.update_telemetry(corpus[i & mask]);
+
+    int fd = connect_loopback(server.port());
+    if (fd < 0) {
+        std::cerr << "Skipping rest.http.*: cannot connect\n";
+        server.stop();
+        return;
+    }
+    std::string pending;
+    bool ok = true;
+    for (const Endpoint& e : endpoints) {
+        const std::string request = std::string("GET ") + e.path + " HTTP/1.1\r\nHost: bench\r\n\r\n";
+        bench.run(e.name, [&] {
+            size_t i = c.next(mask);
+            server.update_telemetry(corpus[i]);
+            server.update_patient_state(states[i]);
+            ok = http_get(fd, request, pending) && ok;
+        });
+        for (const auto& latency : server.endpoint_latencies()) {
+            if (latency.endpoint != e.server_endpoint) continue;
+            bench.annotate(e.name, "server_p50_us", latency.latency.percentile_us(0.50));
+            bench.annotate(e.name, "server_p99_us", latency.latency.percentile_us(0.99));
+        }
+        if (!ok) break;
+    }
+    close(fd);
+    server.stop();
+    if (!ok) std::cerr << "Warning: rest.http.* saw a failed request; results are not valid\n";
+}
+
+std::string results_json(const std::vector<BenchResult>& results, const std::string& label) {
+    std::string out = "{\n  \"schema\": \"ai-iv-bench/1\",\n  \"label\": \"";
+    json::append_escaped(out, label);
+    out += "\",\n  \"build\": {\"compiler\": \"";
+    json::append_escaped(out, __VERSION__);
+    out += "\", \"fast_math\": ";
+    out += Utils::kFastMath ? "true" : "false";
+    out += ", \"neural\": ";
+#ifdef ENABLE_NEURAL_ESTIMATOR
+    out += "true";
+#else
+    out += "false";
+#endif
+    out += "},\n  \"host\": {";
+    utsname host{};
+    if (uname(&host) == 0) {
+        out += "\"system\": \"";
+        json::append_escaped(out, host.sysname);
+        out += "\", \"machine\": \"";
+        json::append_escaped(out, host.machine);
+        out += "\", ";
+    }
+    out += "\"hardware_threads\": ";
+    json::append_uint(out, std::thread::hardware_concurrency());
+    out += "},\n  \"results\": [";
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        out += i == 0 ? "\n    " : ",\n    ";
+        out += "{\"name\": \"";
+        json::append_escaped(out, r.name);
+        out += "\", \"iterations\": ";
+        json::append_uint(out, r.iterations);
+        out += ", \"samples\": ";
+        json::append_uint(out, r.samples);
+        out += ", \"ns_per_op\": {\"min\": ";
+        json::append_fixed(out, r.min_ns, 2);
+        out += ", \"median\": ";
+        json::append_fixed(out, r.median_ns, 2);
+        out += ", \"mean\": ";
+        json::append_fixed(out, r.mean_ns, 2);
+        out += ", \"max\": ";
+        json::append_fixed(out, r.max_ns, 2);
+        out += "}, \"ops_per_sec\": ";
+        json::append_fixed(out, r.median_ns > 0.0 ? 1e9 / r.median_ns : 0.0, 0);
+        out += ", \"extra\": {";
+        for (size_t k = 0; k < r.extra.size(); ++k) {
+            if (k) out += ", ";
+            out += "\"";
+            json::append_escaped(out, r.extra[k].first);
+            out += "\": ";
+            json::append_fixed(out, r.extra[k].second, 3);
+        }
+        out += "}}";
+    }
+    out += "\n  ]\n}\n";
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    std::string out_path;
+    std::string label;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--list") {
+            options.list_only = true;
+        } else if ((arg == "--filter" || arg == "--min-time-ms" || arg == "--samples" ||
+                    arg == "--out" || arg == "--label") && i + 1 < argc) {
+            std::string value = argv[++i];
+            if (arg == "--filter") options.filter = value;
+            else if (arg == "--out") out_path = value;
+            else if (arg == "--label") label = value;
+            else if (arg == "--samples") options.samples = std::strtoul(value.c_str(), nullptr, 10);
+            else options.min_time_ms = std::strtod(value.c_str(), nullptr);
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--filter SUBSTR] [--min-time-ms N] [--samples N]"
+                      << " [--out FILE] [--label TEXT] [--list]\n";
+            return 1;
+        }
+    }
+    if (options.samples == 0 || !(options.min_time_ms > 0.0)) {
+        std::cerr << "Error: --samples and --min-time-ms must be positive\n";
+        return 1;
+    }
+
+    const PatientProfile profile = reference_profile();
+    const std::vector<Telemetry> corpus = telemetry_corpus(1024);
+
+    BenchRunner bench(options);
+    bench_estimator(bench, corpus, profile);
+    bench_energy_proxy(bench, corpus);
+    bench_logger(bench, corpus, profile);
+    bench_control_cycle(bench, corpus, profile);
+    bench_vault(bench);
+    bench_rest(bench, corpus, profile);
+    if (options.list_only) return 0;
+
+    const std::string document = results_json(bench.results(), label);
+    if (out_path.empty()) {
+        std::cout << document;
+    } else {
+        std::ofstream out(out_path);
+        out << document;
+        if (!out) {
+            std::cerr << "Error: cannot write " << out_path << "\n";
+            return 1;
+        }
+        std::cerr << "Wrote " << bench.results().size() << " result(s) to " << out_path << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+/*
+ * export_features.cpp
+ *
+ * Export recorded sessions to columnar feature tables for model training.
+ *
+ * Usage:
+ *   ai_iv_export (--archive DIR | <session_id>...) --out DIR
+ *                [--workers N] [--chunk-rows N] [--row-group-rows N] [--csv]
+ *                [--patient-class standard|cardiac|renal|pediatric]
+ *
+ * --archive exports every session found in DIR (ai_iv_<id>_telemetry.csv
+ * or ai_iv_<id>_session.aivs); otherwise the listed sessions are looked up
+ * in the working directory.  Each session becomes <out>/<id>.aift, read by
+ * tools/read_feature_table.py.  Sessions are replayed with the reference
+ * patient profile simulated by ai_iv.  Exits non-zero if any session fails.
+ */
+
+#include "feature_export.hpp"
+#include "control_policy.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+using namespace ivsys;
+
+int main(int argc, char** argv) {
+    std::vector<std::string> session_ids;
+    std::string archive;
+    FeatureExporter::Options options;
+    options.output_dir.clear();
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--csv") {
+            options.replay.prefer_csv = true;
+            continue;
+        }
+        if (arg.rfind("--", 0) != 0) {
+            // Each id maps to one output file; a repeat would have two
+            // workers writing it at once
+            if (std::find(session_ids.begin(), session_ids.end(), arg) == session_ids.end()) {
+                session_ids.push_back(arg);
+            }
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Error: " << arg << " expects a value\n";
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--archive") archive = value;
+        else if (arg == "--out") options.output_dir = value;
+        else if (arg == "--workers") options.worker_threads = std::strtoul(value.c_str(), nullptr, 10);
+        else if (arg == "--chunk-rows") options.chunk_rows = std::strtoul(value.c_str(), nullptr, 10);
+        else if (arg == "--row-group-rows") {
+            options.row_group_rows = static_cast<std::uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (arg == "--patient-class") {
+            PatientClass patient_class;
+            if (!parse_patient_class(value, patient_class)) {
+                std::cerr << "Error: --patient-class expects standard, cardiac, renal or pediatric\n";
+                return 1;
+            }
+            options.replay.tuning = patient_class_tuning(patient_class);
+        } else {
+            std::cerr << "Error: unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+    if (options.output_dir.empty() || (archive.empty() == session_ids.empty())) {
+        std::cerr << "Usage: " << argv[0] << " (--archive DIR | <session_id>...) --out DIR"
+                  << " [--workers N] [--chunk-rows N] [--row-group-rows N] [--csv]"
+                  << " [--patient-class standard|cardiac|renal|pediatric]\n";
+        return 1;
+    }
+    if (::mkdir(options.output_dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::cerr << "Error: cannot create " << options.output_dir << "\n";
+        return 1;
+    }
+
+    PatientProfile profile;
+    profile.weight_kg = 75.0;
+    profile.age_years = 35.0;
+    profile.baseline_hr_bpm = 70.0;
+    profile.max_safe_infusion_rate = 1.5;
+    profile.current_tissue_perfusion = 0.85;
+    profile.energy_params = EnergyTransferParams();
+
+    std::vector<FeatureExportSession> sessions;
+    try {
+        if (!archive.empty()) session_ids = ReplayLogger::find_sessions(archive);
+        for (const auto& id : session_ids) {
+            sessions.push_back({archive.empty() ? ReplayLogger::load_session(id)
+                                                : ReplayLogger::load_session(id, archive),
+                                profile});
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    FeatureExporter exporter(options);
+    FeatureExportResult result = exporter.run(sessions);
+    std::cout << std::fixed;
+    for (const auto& f : result.files) {
+        if (!f.error.empty()) {
+            std::cerr << "Failed " << f.session_id << ": " << f.error << "\n";
+            continue;
+        }
+        std::cout << "  " << f.session_id << " (" << (f.from_binary ? "binary" : "csv") << "): "
+                  << f.rows << " rows, " << f.row_groups << " row group(s), "
+                  << std::setprecision(1) << f.output_bytes / 1e6 << " MB -> " << f.output_path << "\n";
+    }
+    std::cout << result.exported << " of " << sessions.size() << " session(s) exported, "
+              << result.rows << " rows in " << std::setprecision(3) << result.wall_seconds << " s ("
+              << std::setprecision(0) << result.rows_per_sec << " rows/s, "
+              << std::setprecision(1) << result.input_mb_per_sec << " MB/s in, "
+              << exporter.options().worker_threads << " worker(s), "
+              << result.steals << " steals, "
+              << exporter.worker_buffer_bytes() / 1024 << " KiB buffered per worker)\n";
+    return result.failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+/*
+ * fuzz_invariants.cpp
+ *
+ * Parallel property testing of the SafetyMonitor / AdaptiveController
+ * invariants over randomized and adversarial telemetry (see
+ * invariant_fuzzer.hpp).
+ *
+ * Usage:
+ *   ai_iv_fuzz [--cases N | --seconds S] [--seed N] [--workers N]
+ *              [--max-ticks N] [--adversarial F] [--finite-only]
+ *              [--max-failures N] [--no-shrink] [--dump PATH]
+ *              [--tuning key=value[,key=value...]]
+ *   ai_iv_fuzz --case SEED      check, shrink and print one case
+ *
+ * --tuning runs the controller and monitor with overridden ControlTuning
+ * fields (ai_iv_whatif --list-keys) while the invariants keep the
+ * compile-time limits, e.g. --tuning max_rate_change_ml_min=0.5.
+ *
+ * Exits 0 when no invariant broke, 2 otherwise.  Each failure prints its
+ * case seed; --case reproduces it.  --dump writes every minimized case
+ * as CSV.
+ */
+
+#include "invariant_fuzzer.hpp"
+#include "whatif_engine.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace ivsys;
+
+static void print_failure(const FuzzFailure& f) {
+    const InvariantViolation& v = f.violation;
+    std::cout << "seed=" << f.case_seed << ": "
+              << InvariantFuzzer::kind_name(v.kind) << " at tick " << v.tick << " (observed "
+              << std::setprecision(6) << v.observed << ", limit " << v.limit << "); "
+              << f.original_ticks << " -> " << f.minimized.ticks.size() << " ticks after "
+              << f.shrink_checks << " checks\n";
+}
+
+// "key=value[,key=value...]" onto `tuning`
+static bool parse_tuning(const std::string& spec, config::ControlTuning& tuning) {
+    size_t pos = 0;
+    while (pos < spec.size()) {
+        size_t comma = spec.find(',', pos);
+        std::string item = spec.substr(pos, comma == std::string::npos ? std::string::npos
+                                                                          : comma - pos);
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) return false;
+        char* end = nullptr;
+        double value = std::strtod(item.c_str() + eq + 1, &end);
+        if (end == item.c_str() + eq + 1 || !WhatIfEngine::apply_override(tuning, item.substr(0, eq), value)) {
+            return false;
+        }
+        if (comma == std::string::npos) break;
+        pos = comma + 1;
+    }
+    return !spec.empty();
+}
+
+int main(int argc, char** argv) {
+    InvariantFuzzer::Options options;
+    std::string dump_path;
+    bool single = false;
+    std::uint64_t single_seed = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--finite-only") {
+            options.non_finite = false;
+            continue;
+        }
+        if (flag == "--no-shrink") {
+            options.max_shrink_checks = 0;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--cases N | --seconds S] [--seed N] [--workers N] [--max-ticks N]"
+                      << " [--adversarial F] [--finite-only] [--max-failures N] [--no-shrink]"
+                      << " [--dump PATH] [--tuning key=value,...] | --case SEED\n";
+            return 1;
+        }
+        std::string arg = argv[++i];
+        char* end = nullptr;
+        if (flag == "--dump") {
+            dump_path = arg;
+            continue;
+        }
+        if (flag == "--tuning") {
+            if (!parse_tuning(arg, options.tuning)) {
+                std::cerr << "Error: bad --tuning '" << arg << "' (see ai_iv_whatif --list-keys)\n";
+                return 1;
+            }
+            continue;
+        }
+        if (flag == "--adversarial") {
+            options.adversarial_fraction = std::strtod(arg.c_str(), &end);
+            if (end == arg.c_str() || *end != '\0' || options.adversarial_fraction < 0.0 ||
+                options.adversarial_fraction > 1.0) {
+                std::cerr << "Error: --adversarial expects a fraction in [0, 1]\n";
+                return 1;
+            }
+            continue;
+        }
+        unsigned long long value = std::strtoull(arg.c_str(), &end, 10);
+        if (end == arg.c_str() || *end != '\0') {
+            std::cerr << "Error: " << flag << " expects a non-negative integer\n";
+            return 1;
+        }
+        if (flag == "--cases") options.cases = value;
+        else if (flag == "--seconds") {
+            options.time_budget = std::chrono::seconds(value);
+            options.cases = UINT64_MAX;
+        }
+        else if (flag == "--seed") options.seed = value;
+        else if (flag == "--workers") options.worker_threads = static_cast<size_t>(value);
+        else if (flag == "--max-ticks") options.max_ticks = static_cast<size_t>(value);
+        else if (flag == "--max-failures") options.max_failures = static_cast<size_t>(value);
+        else if (flag == "--case") {
+            single = true;
+            single_seed = value;
+        } else {
+            std::cerr << "Error: unknown option " << flag << "\n";
+            return 1;
+        }
+    }
+
+    InvariantFuzzer fuzzer(options);
+    if (single) {
+        FuzzCase c = fuzzer.generate(single_seed);
+        auto v = InvariantFuzzer::check(c, options.tuning, options.limits);
+        if (!v) {
+            std::cout << "Case " << single_seed << " (" << c.ticks.size() << " ticks) holds every invariant\n";
+            return 0;
+        }
+        FuzzFailure f;
+        f.case_seed = single_seed;
+        f.original_ticks = c.ticks.size();
+        f.minimized = options.max_shrink_checks > 0
+            ? InvariantFuzzer::shrink(c, v->kind, options.tuning, options.limits,
+                                      options.max_shrink_checks, &f.shrink_checks)
+            : c;
+        f.violation = *InvariantFuzzer::check(f.minimized, options.tuning, options.limits);
+        std::cout << "  ";
+        print_failure(f);
+        InvariantFuzzer::write_case(std::cout, f.minimized);
+        return 2;
+    }
+
+    FuzzReport r = fuzzer.run();
+    std::cout << std::fixed << std::setprecision(0)
+              << r.cases << " cases (" << r.adversarial_cases << " adversarial), " << r.ticks
+              << " ticks, " << std::setprecision(1) << r.simulated_seconds / 3600.0
+              << " h of therapy on " << r.workers << " worker(s) in " << std::setprecision(2)
+              << r.wall_seconds << " s\n"
+              << std::setprecision(0) << "  cases/s: " << r.cases_per_second
+              << "  (" << r.cases_per_second * 60.0 << "/min)  ticks/s: " << r.ticks_per_second << "\n";
+    for (size_t k = 0; k < r.violations.size(); ++k) {
+        std::cout << "  " << std::left << std::setw(22) << InvariantFuzzer::kind_name(static_cast<InvariantKind>(k))
+                  << std::right << r.violations[k] << "\n";
+    }
+    std::cout << std::defaultfloat;
+    for (const FuzzFailure& f : r.failures) {
+        std::cout << "  case " << f.case_index << " ";
+        print_failure(f);
+    }
+
+    if (!dump_path.empty() && !r.failures.empty()) {
+        std::ofstream out(dump_path);
+        for (const FuzzFailure& f : r.failures) {
+            InvariantFuzzer::write_case(out, f.minimized);
+            out << "\n";
+        }
+        std::cout << "Minimized cases written to " << dump_path << "\n";
+    }
+    return r.total_violations() == 0 ? 0 : 2;
+}
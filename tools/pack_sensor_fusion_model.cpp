@@ -0,0 +1,82 @@
+/*
+ * pack_sensor_fusion_model.cpp
+ *
+ * Offline step after tools/train_sensor_fusion_model.py: loads the
+ * frugally-deep JSON model into SensorFusionKernel (which checks its
+ * embedded test vectors), writes the packed blob the runtime maps at
+ * startup, reloads the blob and checks it predicts bit-identically, and
+ * reports the cold-load time of both formats.  The blob records the
+ * JSON's checksum, so the runtime ignores it once the JSON is retrained.
+ *
+ * Usage:
+ *   ai_iv_model_pack [--in models/sensor_fusion_fdeep.json] [--out PATH]
+ *
+ * --out defaults to SensorFusionKernel::blob_path_for(--in), i.e.
+ * models/sensor_fusion_fdeep.aimb.  Exits non-zero if anything fails.
+ */
+
+#include "SensorFusionKernel.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace ivsys;
+
+template <typename F>
+static double time_us(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    std::string in = "models/sensor_fusion_fdeep.json";
+    std::string out;
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (i + 1 >= argc || (flag != "--in" && flag != "--out")) {
+            std::cerr << "Usage: " << argv[0] << " [--in MODEL.json] [--out MODEL.aimb]\n";
+            return 1;
+        }
+        (flag == "--in" ? in : out) = argv[++i];
+    }
+    if (out.empty()) out = SensorFusionKernel::blob_path_for(in);
+
+    try {
+        SensorFusionKernel json;
+        double json_us = time_us([&] { json.load(in); });
+        json.write_blob(out);
+
+        SensorFusionKernel blob;
+        double blob_us = time_us([&] { blob.load_blob(out, in); });
+
+        // Every grid point must match to the bit, not just within tolerance
+        constexpr int steps = 6;
+        float x[SensorFusionKernel::kInputs];
+        for (int point = 0; point < steps * steps * steps * steps * steps; ++point) {
+            int rest = point;
+            for (float& v : x) {
+                v = static_cast<float>(rest % steps) / (steps - 1);
+                rest /= steps;
+            }
+            float a = json.predict(x), b = blob.predict(x);
+            if (std::memcmp(&a, &b, sizeof(a)) != 0) {
+                std::cerr << "Error: blob prediction differs from the JSON model at grid point " << point << "\n";
+                return 1;
+            }
+        }
+
+        std::cout << "Packed " << in << " -> " << out << " (" << json.to_blob().size() << " bytes, "
+                  << blob.load_check_samples() << " test vectors, max error " << blob.load_check_error() << ")\n"
+                  << std::fixed << std::setprecision(1)
+                  << "Cold load: json " << json_us << " us, blob " << blob_us << " us\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
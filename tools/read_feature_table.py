@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""
+Read the columnar feature tables written by ai_iv_export (.aift).
+
+The layout is documented in src/feature_table.hpp: a 96-byte header, row
+groups of contiguous 8-byte column runs, then the schema and row-group
+index in a footer located by the 24-byte trailer.  Only the standard
+library is required; when numpy is installed, columns are returned as
+numpy arrays mapped straight from the file (no copy, no parsing).
+
+Usage:
+  python3 tools/read_feature_table.py TABLE.aift [COLUMN...]
+
+Prints the schema and row count, then the first rows of the named columns
+(all columns by default).  As a module:
+
+  from read_feature_table import read_table
+  table = read_table("exports/1712345678.aift")
+  rates = table.column("infusion_rate_ml_min")
+"""
+
+import array
+import mmap
+import struct
+import sys
+
+MAGIC = b"AIIVFEAT"
+VERSION = 1
+BYTE_ORDER_MARK = 0x01020304
+ROW_GROUP_MAGIC = 0x31505247
+TRAILER_MAGIC = 0x31525446
+
+HEADER = struct.Struct("<8sIIIIII64s")      # FileHeader, 96 bytes
+ROW_GROUP_HEADER = struct.Struct("<IIII")   # 16 bytes
+COLUMN_DESC = struct.Struct("<40sII")       # 48 bytes
+ROW_GROUP_ENTRY = struct.Struct("<QQqq")    # 32 bytes
+TRAILER = struct.Struct("<QQII")            # 24 bytes
+
+INT64 = 1
+FLOAT64 = 2
+
+try:
+    import numpy as np
+except ImportError:  # stdlib fallback
+    np = None
+
+
+class FeatureTable:
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self._data = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        data = self._data
+        if len(data) < HEADER.size + TRAILER.size:
+            raise ValueError(f"{path}: file too short")
+        magic, version, bom, header_size, column_count, _, _, table_id = HEADER.unpack_from(data, 0)
+        if magic != MAGIC or version != VERSION or bom != BYTE_ORDER_MARK or header_size != HEADER.size:
+            raise ValueError(f"{path}: not a version {VERSION} feature table")
+        footer_offset, total_rows, group_count, trailer_magic = TRAILER.unpack_from(data, len(data) - TRAILER.size)
+        footer_bytes = column_count * COLUMN_DESC.size + group_count * ROW_GROUP_ENTRY.size
+        if trailer_magic != TRAILER_MAGIC or footer_offset + footer_bytes + TRAILER.size != len(data):
+            raise ValueError(f"{path}: missing or damaged footer (unfinished export?)")
+
+        self.table_id = table_id.split(b"\0", 1)[0].decode()
+        self.total_rows = total_rows
+        self.columns = []   # [(name, type)]
+        pos = footer_offset
+        for _ in range(column_count):
+            name, kind, _ = COLUMN_DESC.unpack_from(data, pos)
+            self.columns.append((name.split(b"\0", 1)[0].decode(), kind))
+            pos += COLUMN_DESC.size
+        self.row_groups = []   # [(offset, rows, first_key, last_key)]
+        for _ in range(group_count):
+            offset, rows, first_key, last_key = ROW_GROUP_ENTRY.unpack_from(data, pos)
+            group_magic, group_rows, group_columns, _ = ROW_GROUP_HEADER.unpack_from(data, offset)
+            if group_magic != ROW_GROUP_MAGIC or group_rows != rows or group_columns != column_count:
+                raise ValueError(f"{path}: bad row group at offset {offset}")
+            self.row_groups.append((offset, rows, first_key, last_key))
+            pos += ROW_GROUP_ENTRY.size
+        if sum(g[1] for g in self.row_groups) != total_rows:
+            raise ValueError(f"{path}: row count mismatch")
+
+    def names(self):
+        return [name for name, _ in self.columns]
+
+    def column(self, name):
+        """Every value of one column, all row groups in order."""
+        index = self.names().index(name)
+        kind = self.columns[index][1]
+        parts = []
+        for offset, rows, _, _ in self.row_groups:
+            start = offset + ROW_GROUP_HEADER.size + index * rows * 8
+            if np is not None:
+                dtype = "<i8" if kind == INT64 else "<f8"
+                parts.append(np.frombuffer(self._data, dtype=dtype, count=rows, offset=start))
+            else:
+                values = array.array("q" if kind == INT64 else "d")
+                values.frombytes(self._data[start:start + rows * 8])
+                if sys.byteorder != "little":
+                    values.byteswap()
+                parts.append(values)
+        if np is not None:
+            return np.concatenate(parts) if len(parts) != 1 else parts[0]
+        out = array.array("q" if kind == INT64 else "d")
+        for part in parts:
+            out.extend(part)
+        return out
+
+
+def read_table(path):
+    return FeatureTable(path)
+
+
+def main(argv):
+    if len(argv) < 2:
+        print(f"Usage: {argv[0]} TABLE.aift [COLUMN...]", file=sys.stderr)
+        return 1
+    table = read_table(argv[1])
+    names = argv[2:] or table.names()
+    print(f"{argv[1]}: session {table.table_id}, {table.total_rows} rows, "
+          f"{len(table.row_groups)} row group(s), {len(table.columns)} columns")
+    columns = [table.column(name) for name in names]
+    print(",".join(names))
+    for row in range(min(5, table.total_rows)):
+        print(",".join(str(c[row]) for c in columns))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
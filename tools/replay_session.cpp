@@ -0,0 +1,110 @@
+/*
+ * replay_session.cpp
+ *
+ * Replay a recorded session through the control pipeline at full speed and
+ * print per-stage throughput.
+ *
+ * Usage: ai_iv_replay <session_id> [--csv] [--export PATH]
+ *                     [--weight KG] [--age Y] [--baseline-hr BPM] [--max-rate ML_MIN]
+ *                     [--patient-class standard|cardiac|renal|pediatric]
+ *
+ * Session files are looked up as ai_iv_<session_id>_* in the working
+ * directory.  The profile defaults to the reference patient simulated by
+ * ai_iv; override it to match the recorded patient.  --patient-class
+ * replays with that class's limits, as logged by ai_iv ("Patient class:").
+ */
+
+#include "replay_logger.hpp"
+#include "control_policy.hpp"
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace ivsys;
+
+static void print_stage(const char* name, const ReplayStageStats& s) {
+    std::cout << "  " << std::left << std::setw(10) << name << std::right
+              << std::setw(10) << std::setprecision(3) << s.seconds * 1000.0 << " ms"
+              << std::setw(14) << std::setprecision(0) << s.rows_per_sec << " rows/s\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <session_id> [--csv] [--export PATH]"
+                  << " [--weight KG] [--age Y] [--baseline-hr BPM] [--max-rate ML_MIN]"
+                  << " [--patient-class standard|cardiac|renal|pediatric]\n";
+        return 1;
+    }
+
+    PatientProfile profile;
+    profile.weight_kg = 75.0;
+    profile.age_years = 35.0;
+    profile.baseline_hr_bpm = 70.0;
+    profile.max_safe_infusion_rate = 1.5;
+    profile.current_tissue_perfusion = 0.85;
+    profile.energy_params = EnergyTransferParams();
+
+    ReplayOptions options;
+    std::string export_path;
+    for (int i = 2; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--csv") {
+            options.prefer_csv = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Error: " << flag << " expects a value\n";
+            return 1;
+        }
+        std::string arg = argv[++i];
+        if (flag == "--export") export_path = arg;
+        else if (flag == "--weight") profile.weight_kg = std::atof(arg.c_str());
+        else if (flag == "--age") profile.age_years = std::atof(arg.c_str());
+        else if (flag == "--baseline-hr") profile.baseline_hr_bpm = std::atof(arg.c_str());
+        else if (flag == "--max-rate") profile.max_safe_infusion_rate = std::atof(arg.c_str());
+        else if (flag == "--patient-class") {
+            PatientClass patient_class;
+            if (!parse_patient_class(arg, patient_class)) {
+                std::cerr << "Error: --patient-class expects standard, cardiac, renal or pediatric\n";
+                return 1;
+            }
+            options.tuning = patient_class_tuning(patient_class);
+        }
+        else {
+            std::cerr << "Error: unknown option " << flag << "\n";
+            return 1;
+        }
+    }
+
+    try {
+        ReplaySessionInfo session = ReplayLogger::load_session(argv[1]);
+        ReplayReport r = export_path.empty()
+            ? ReplayLogger::replay(session, profile, options)
+            : ReplayLogger::export_reconstructed_state(session, profile, export_path, options);
+
+        std::cout << std::fixed
+                  << "Session " << r.session_id << " (" << (r.from_binary ? "binary" : "csv")
+                  << "): " << r.ticks << " ticks, "
+                  << std::setprecision(1) << r.session_seconds / 3600.0 << " h of therapy\n";
+        print_stage("decode", r.decode);
+        print_stage("estimate", r.estimate);
+        print_stage("spine", r.spine);
+        print_stage("control", r.control);
+        std::cout << "  total     " << std::setw(10) << std::setprecision(3)
+                  << r.total_seconds * 1000.0 << " ms  (" << std::setprecision(0)
+                  << r.speedup << "x real time)\n";
+        std::cout << "  Logged decisions compared: " << r.compared
+                  << ", mismatches: " << r.mismatches
+                  << ", max |delta rate|: " << std::setprecision(6) << r.max_rate_deviation
+                  << " ml/min\n";
+        if (!export_path.empty()) {
+            std::cout << "  Reconstructed state written to " << export_path << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
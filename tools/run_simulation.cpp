@@ -0,0 +1,228 @@
+/*
+ * run_simulation.cpp
+ *
+ * Headless soak runs of the full control pipeline on a virtual clock.
+ *
+ * Usage:
+ *   ai_iv_sim [--duration-h H | --duration S] [--dt-ms MS] [--seed N]
+ *             [--scenario KIND:START_MIN:DURATION_MIN[:SEVERITY]]...
+ *             [--session-id ID] [--log-mode sync|async]
+ *             [--session-format csv|binary|both] [--progress-min M]
+ *             [--volume-window-h H] [--stage-timing]
+ *
+ * KIND is hemorrhage, hypoxia or dropout; SEVERITY is 0-1 (default 1).
+ * Example, three simulated days with a bleed on day two:
+ *   ai_iv_sim --duration-h 72 --scenario hemorrhage:1800:45:0.8 \
+ *       --scenario dropout:3000:10
+ *
+ * The session (binary by default) is written as ai_iv_<id>_* like any
+ * other, with virtual timestamps, so ai_iv_replay and ai_iv_whatif accept
+ * it.  The simulated patient is the ai_iv reference profile.
+ */
+
+#include "simulation_driver.hpp"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ivsys;
+
+static bool parse_positive(const std::string& text, double& out) {
+    char* end = nullptr;
+    out = std::strtod(text.c_str(), &end);
+    return end != text.c_str() && *end == '\0' && out > 0.0;
+}
+
+static bool parse_scenario(const std::string& spec, ScenarioEvent& event) {
+    std::vector<std::string> parts;
+    size_t pos = 0;
+    while (true) {
+        size_t colon = spec.find(':', pos);
+        parts.push_back(spec.substr(pos, colon == std::string::npos ? std::string::npos : colon - pos));
+        if (colon == std::string::npos) break;
+        pos = colon + 1;
+    }
+    if (parts.size() < 3 || parts.size() > 4) return false;
+    if (!SimulationEngine::parse_kind(parts[0], event.kind)) return false;
+
+    char* end = nullptr;
+    double start_min = std::strtod(parts[1].c_str(), &end);
+    if (end == parts[1].c_str() || *end != '\0' || start_min < 0.0) return false;
+    double duration_min = 0.0;
+    if (!parse_positive(parts[2], duration_min)) return false;
+    event.start_s = start_min * 60.0;
+    event.duration_s = duration_min * 60.0;
+    event.severity = 1.0;
+    if (parts.size() == 4 && (!parse_positive(parts[3], event.severity) || event.severity > 1.0)) {
+        return false;
+    }
+    return true;
+}
+
+static void print_usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0
+              << " [--duration-h H | --duration S] [--dt-ms MS] [--seed N]"
+              << " [--scenario KIND:START_MIN:DURATION_MIN[:SEVERITY]]..."
+              << " [--session-id ID] [--log-mode sync|async] [--session-format csv|binary|both]"
+              << " [--progress-min M] [--volume-window-h H] [--stage-timing]\n"
+              << "KIND: hemorrhage, hypoxia or dropout\n";
+}
+
+int main(int argc, char** argv) {
+    SimulationDriver::Options options;
+    bool custom_session_id = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--stage-timing") {
+            options.stage_timing = true;
+            continue;
+        }
+        if (flag == "--help" || i + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        std::string arg = argv[++i];
+        double value = 0.0;
+        if (flag == "--scenario") {
+            ScenarioEvent event;
+            if (!parse_scenario(arg, event)) {
+                std::cerr << "Error: bad --scenario '" << arg << "'\n";
+                print_usage(argv[0]);
+                return 1;
+            }
+            options.events.push_back(event);
+        } else if (flag == "--session-id") {
+            options.session_id = arg;
+            custom_session_id = true;
+        } else if (flag == "--log-mode") {
+            if (arg == "async") options.log_mode = LoggerMode::Async;
+            else if (arg == "sync") options.log_mode = LoggerMode::Sync;
+            else {
+                std::cerr << "Error: --log-mode expects sync or async\n";
+                return 1;
+            }
+        } else if (flag == "--session-format") {
+            if (arg == "csv") options.session_format = SessionFormat::Csv;
+            else if (arg == "binary") options.session_format = SessionFormat::Binary;
+            else if (arg == "both") options.session_format = SessionFormat::Both;
+            else {
+                std::cerr << "Error: --session-format expects csv, binary or both\n";
+                return 1;
+            }
+        } else if (flag == "--seed") {
+            char* end = nullptr;
+            options.seed = std::strtoull(arg.c_str(), &end, 10);
+            if (end == arg.c_str() || *end != '\0') {
+                std::cerr << "Error: --seed expects a non-negative integer\n";
+                return 1;
+            }
+        } else if (flag == "--volume-window-h") {
+            // 0 keeps a single volume window for the whole run
+            char* end = nullptr;
+            value = std::strtod(arg.c_str(), &end);
+            if (end == arg.c_str() || *end != '\0' || value < 0.0) {
+                std::cerr << "Error: --volume-window-h expects a non-negative number\n";
+                return 1;
+            }
+            options.volume_window_seconds = value * 3600.0;
+        } else if (!parse_positive(arg, value)) {
+            std::cerr << "Error: " << flag << " expects a positive number\n";
+            return 1;
+        } else if (flag == "--duration-h") {
+            options.duration_seconds = value * 3600.0;
+        } else if (flag == "--duration") {
+            options.duration_seconds = value;
+        } else if (flag == "--dt-ms") {
+            options.dt_seconds = value / 1000.0;
+        } else if (flag == "--progress-min") {
+            options.progress_interval_seconds = value * 60.0;
+        } else {
+            std::cerr << "Error: unknown option " << flag << "\n";
+            return 1;
+        }
+    }
+    if (!custom_session_id) options.session_id = "sim_" + std::to_string(options.seed);
+
+    PatientProfile profile;
+    profile.weight_kg = 75.0;
+    profile.age_years = 35.0;
+    profile.baseline_hr_bpm = 70.0;
+    profile.max_safe_infusion_rate = 1.5;
+    profile.current_tissue_perfusion = 0.85;
+    profile.energy_params = EnergyTransferParams();
+
+    std::cout << std::fixed << std::setprecision(1);
+    options.on_progress = [](const SimulationProgress& p) {
+        std::cout << "  t=" << p.simulated_seconds / 3600.0 << " h  ticks=" << p.ticks
+                  << "  wall=" << p.wall_seconds << " s  volume=" << p.volume_ml << " mL\n"
+                  << std::flush;
+    };
+
+    std::cout << "Simulating " << options.duration_seconds / 3600.0 << " h at dt="
+              << options.dt_seconds * 1000.0 << " ms, session " << options.session_id << "\n";
+    for (const ScenarioEvent& e : options.events) {
+        std::cout << "  " << SimulationEngine::kind_name(e.kind) << " at " << e.start_s / 60.0
+                  << " min for " << e.duration_s / 60.0 << " min, severity "
+                  << std::setprecision(2) << e.severity << std::setprecision(1) << "\n";
+    }
+
+    SimulationDriver driver(profile, options);
+    SimulationReport r = driver.run();
+
+    std::cout << "\n" << r.ticks << " ticks (" << r.simulated_seconds / 3600.0 << " h simulated) in "
+              << std::setprecision(3) << r.wall_seconds << " s wall\n"
+              << std::setprecision(0) << "  ticks/s:          " << r.ticks_per_second << "\n"
+              << "  speedup:          " << r.speedup << "x real time\n"
+              << std::setprecision(1)
+              << "  volume:           " << r.total_volume_ml << " mL (" << r.volume_resets
+              << " 24h window reset(s))\n"
+              << std::setprecision(3)
+              << "  rate:             mean " << r.mean_rate_ml_min << ", max " << r.max_rate_ml_min
+              << " mL/min\n"
+              << std::setprecision(1)
+              << "  min hydration:    " << r.min_hydration_pct << " %\n"
+              << std::setprecision(3)
+              << "  max risk:         " << r.max_risk_score << "\n"
+              << "  warning ticks:    " << r.warning_ticks << " (" << r.emergency_ticks
+              << " emergency, " << r.safety_overrides << " overrides)\n"
+              << "  low quality:      " << r.low_quality_ticks << " ticks\n"
+              << std::setprecision(1)
+              << "  vault payload:    " << r.final_vault_payload_pct << " %"
+              << (r.vault_cage_breached ? " (cage breached)" : "") << "\n";
+    if (r.logger.dropped > 0) {
+        std::cout << "  logger dropped:   " << r.logger.dropped << " records\n";
+    }
+
+    for (const ScenarioWindowStats& w : r.scenarios) {
+        std::cout << "\n" << std::setprecision(1) << SimulationEngine::kind_name(w.event.kind) << " @"
+                  << w.event.start_s / 60.0
+                  << " min: " << w.ticks << " ticks\n"
+                  << std::setprecision(3)
+                  << "  rate:             mean " << w.mean_rate_ml_min << ", peak " << w.peak_rate_ml_min
+                  << " mL/min, " << std::setprecision(1) << w.volume_ml << " mL\n"
+                  << "  min hydration:    " << w.min_hydration_pct << " %\n"
+                  << std::setprecision(3)
+                  << "  min reserve:      " << w.min_cardiac_reserve << "\n"
+                  << "  max risk:         " << w.max_risk_score << "\n"
+                  << "  warning ticks:    " << w.warning_ticks << "\n"
+                  << "  low quality:      " << w.low_quality_ticks << " ticks\n";
+    }
+
+    if (r.loop.ticks > 0) {
+        std::cout << "\nStage latency (us)      p50      p99      max\n" << std::setprecision(2);
+        for (size_t s = 0; s < ControlLoopMetrics::kStageCount; ++s) {
+            const auto& h = r.loop.stages[s];
+            if (h.count == 0) continue;
+            std::cout << "  " << std::left << std::setw(16)
+                      << ControlLoopMetrics::stage_name(static_cast<LoopStage>(s)) << std::right
+                      << std::setw(9) << h.percentile_us(0.50) << std::setw(9) << h.percentile_us(0.99)
+                      << std::setw(9) << h.max_us() << "\n";
+        }
+        std::cout << "  " << std::left << std::setw(16) << "tick" << std::right << std::setw(9)
+                  << r.loop.tick.percentile_us(0.50) << std::setw(9) << r.loop.tick.percentile_us(0.99)
+                  << std::setw(9) << r.loop.tick.max_us() << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * session_to_csv.cpp
+ *
+ * Convert a binary session (ai_iv_<id>_session.aivs) back to the CSV layout
+ * SystemLogger writes in SessionFormat::Csv, so existing dashboards and the
+ * Python tooling can consume binary sessions unchanged.
+ *
+ * Usage: ai_iv_session_to_csv <session.aivs> [output_prefix]
+ *
+ * Writes <output_prefix>_telemetry.csv and <output_prefix>_control.csv.
+ * The default prefix is the input path with "_session.aivs" removed, which
+ * recreates the file names the CSV logger would have used.
+ */
+
+#include "SystemLogger.hpp"
+#include "session_format.hpp"
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace ivsys;
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <session.aivs> [output_prefix]\n";
+        return 1;
+    }
+
+    std::string input = argv[1];
+    std::string prefix;
+    if (argc == 3) {
+        prefix = argv[2];
+    } else {
+        std::string suffix = session_format::kFileSuffix;
+        prefix = input;
+        if (prefix.size() > suffix.size() &&
+            prefix.compare(prefix.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            prefix.resize(prefix.size() - suffix.size());
+        }
+    }
+
+    try {
+        size_t size = 0;
+        auto buffer = session_format::load_file(input, size);
+        session_format::SessionReader reader(buffer.data(), size);
+        if (!reader.indexed()) {
+            std::cerr << "Warning: " << input
+                      << " has no index (writer did not close); recovered "
+                      << reader.blocks().size() << " block(s) by scan\n";
+        }
+
+        std::ofstream telemetry(prefix + "_telemetry.csv");
+        std::ofstream control(prefix + "_control.csv");
+        if (!telemetry.is_open() || !control.is_open()) {
+            std::cerr << "Error: cannot open output files with prefix " << prefix << "\n";
+            return 1;
+        }
+
+        telemetry << SystemLogger::kTelemetryCsvHeader;
+        size_t telemetry_rows = 0;
+        for (const Telemetry& m : reader.all_telemetry()) {
+            SystemLogger::write_telemetry_row(telemetry, m);
+            ++telemetry_rows;
+        }
+
+        control << SystemLogger::kControlCsvHeader;
+        size_t control_rows = 0;
+        for (const auto& s : reader.all_control()) {
+            SystemLogger::write_control_row(control, s.output, s.state, s.t);
+            ++control_rows;
+        }
+
+        std::cout << "Session " << reader.session_id() << ": "
+                  << telemetry_rows << " telemetry row(s), "
+                  << control_rows << " control row(s) -> " << prefix << "_*.csv\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
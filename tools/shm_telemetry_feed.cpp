@@ -0,0 +1,125 @@
+/*
+ * shm_telemetry_feed.cpp
+ *
+ * Reference sensor driver for the shared-memory telemetry ring: publishes
+ * SimulationEngine's waveform in real time, as an external sensor daemon
+ * would, for ai_iv --telemetry-shm NAME to consume.
+ *
+ * Usage:
+ *   ai_iv_shm_feed [--name NAME] [--hz HZ] [--seconds S] [--capacity N]
+ *                  [--seed N] [--stall-at S --stall-s S] [--unlink]
+ *
+ * Defaults: --name /ai_iv_telemetry, 50 Hz, runs until SIGINT/SIGTERM.
+ * --stall-at / --stall-s pause publishing for a while to exercise the
+ * reader's staleness handling.  --unlink removes the name on exit.
+ */
+
+#include "shm_telemetry_ring.hpp"
+#include "simulation_engine.hpp"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace ivsys;
+
+static std::atomic<bool> g_stop{false};
+
+static void on_signal(int) { g_stop.store(true); }
+
+int main(int argc, char** argv) {
+    std::string name = kDefaultTelemetryShmName;
+    double hz = 50.0, seconds = 0.0, stall_at = -1.0, stall_s = 0.0;
+    unsigned long capacity = ShmTelemetryWriter::kDefaultCapacity;
+    unsigned long long seed = 1;
+    bool unlink_on_exit = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--unlink") {
+            unlink_on_exit = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--name NAME] [--hz HZ] [--seconds S] [--capacity N] [--seed N]"
+                      << " [--stall-at S --stall-s S] [--unlink]\n";
+            return 1;
+        }
+        std::string arg = argv[++i];
+        if (flag == "--name") {
+            name = arg;
+            continue;
+        }
+        char* end = nullptr;
+        double value = std::strtod(arg.c_str(), &end);
+        if (end == arg.c_str() || *end != '\0' || value < 0.0) {
+            std::cerr << "Error: " << flag << " expects a non-negative number\n";
+            return 1;
+        }
+        if (flag == "--hz") hz = value;
+        else if (flag == "--seconds") seconds = value;
+        else if (flag == "--capacity") capacity = static_cast<unsigned long>(value);
+        else if (flag == "--seed") seed = static_cast<unsigned long long>(value);
+        else if (flag == "--stall-at") stall_at = value;
+        else if (flag == "--stall-s") stall_s = value;
+        else {
+            std::cerr << "Error: unknown option " << flag << "\n";
+            return 1;
+        }
+    }
+    if (hz <= 0.0 || capacity < 2) {
+        std::cerr << "Error: --hz must be positive and --capacity at least 2\n";
+        return 1;
+    }
+
+    PatientProfile profile;
+    profile.weight_kg = 75.0;
+    profile.age_years = 35.0;
+    profile.baseline_hr_bpm = 70.0;
+    profile.max_safe_infusion_rate = 1.5;
+    profile.current_tissue_perfusion = 0.85;
+    profile.energy_params = EnergyTransferParams();
+    SimulationEngine sim(profile, seed);
+
+    std::unique_ptr<ShmTelemetryWriter> writer;
+    try {
+        writer = std::make_unique<ShmTelemetryWriter>(name, static_cast<std::uint32_t>(capacity));
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+    std::cout << "Publishing to " << name << " at " << hz << " Hz (" << writer->capacity()
+              << " slots, sequence " << writer->published() << ")\n" << std::flush;
+
+    using Clock = std::chrono::steady_clock;
+    const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / hz));
+    const auto start = Clock::now();
+    auto next = start;
+    bool stalled = false;
+    while (!g_stop.load()) {
+        double t = std::chrono::duration<double>(Clock::now() - start).count();
+        if (seconds > 0.0 && t >= seconds) break;
+        bool stall = stall_at >= 0.0 && t >= stall_at && t < stall_at + stall_s;
+        if (stall != stalled) {
+            std::cout << (stall ? "Stalled" : "Resumed") << " at t=" << t << " s\n" << std::flush;
+            stalled = stall;
+        }
+        if (!stall) {
+            Telemetry m = sim.generate_telemetry(t);
+            m.timestamp = Clock::now();
+            writer->publish(m);
+        }
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+
+    std::cout << "Published " << writer->published() << " records\n";
+    if (unlink_on_exit) ShmTelemetryWriter::unlink(name);
+    return 0;
+}
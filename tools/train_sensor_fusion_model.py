@@ -4,7 +4,7 @@ Train and export the AI-IV sensor fusion neural network.
 
 This script trains a small feedforward neural network that learns to
 replicate the hand-crafted energy proxy formula (StateEstimator::
-calculate_energy_proxy) via knowledge distillation.  Once trained, the
+rule_energy_proxy) via knowledge distillation.  Once trained, the
 model is exported to two interchange formats:
 
   models/sensor_fusion_fdeep.json   — loaded at runtime by the C++ build
@@ -13,6 +13,10 @@ model is exported to two interchange formats:
                                       embedded / mobile deployment
   models/sensor_fusion.h5           — Keras HDF5 checkpoint
 
+`make model-blob` then packs the JSON into models/sensor_fusion_fdeep.aimb,
+the checksummed binary weight blob the runtime maps at startup
+(tools/pack_sensor_fusion_model.cpp); commit it alongside the JSON.
+
 Model architecture (241 parameters):
   Input  (5 features)  →  Dense-16 ReLU  →  Dense-8 ReLU  →  Dense-1 Sigmoid
 
@@ -44,7 +48,7 @@ import numpy as np
 
 # ─────────────────────────────────────────────────────────────────────────────
 # Reference formula (knowledge-distillation target)
-# Mirrors StateEstimator::calculate_energy_proxy exactly.
+# Mirrors StateEstimator::rule_energy_proxy exactly.
 # ─────────────────────────────────────────────────────────────────────────────
 
 def _sigmoid(x: float, center: float, steepness: float) -> float:
@@ -61,7 +65,7 @@ def reference_energy_proxy(
     fatigue_idx: float,
     blood_loss_idx: float = 0.0,
 ) -> float:
-    """Exact copy of StateEstimator::calculate_energy_proxy (C++).
+    """Exact copy of StateEstimator::rule_energy_proxy (C++).
 
     blood_loss_idx defaults to 0.0 because the neural network does not take
     blood loss as an input feature — blood loss is already captured by the
@@ -304,7 +308,7 @@ def main():
     model = train(epochs=args.epochs, batch_size=args.batch_size)
     print("\nExporting …")
     export_all(model, out_dir=args.out_dir)
-    print("\nDone.")
+    print("\nDone.  Run `make model-blob` to refresh the packed runtime blob.")
 
 
 if __name__ == "__main__":
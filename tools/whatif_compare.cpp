@@ -0,0 +1,137 @@
+/*
+ * whatif_compare.cpp
+ *
+ * Replay recorded sessions against several controller configurations in
+ * parallel and print per-configuration aggregates.
+ *
+ * Usage:
+ *   ai_iv_whatif <session_id>... [--config NAME:key=value[,key=value...]]...
+ *                [--workers N] [--csv] [--list-keys]
+ *
+ * A "baseline" configuration (compile-time defaults) is always included.
+ * Example:
+ *   ai_iv_whatif 1712345678 1712349999 \
+ *       --config tight:max_rate_change_ml_min=0.15 \
+ *       --config rule:neural_energy_proxy=0
+ *
+ * Sessions are replayed with the reference patient profile simulated by
+ * ai_iv.
+ */
+
+#include "whatif_engine.hpp"
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ivsys;
+
+static bool parse_config(const std::string& spec, WhatIfConfig& out) {
+    size_t colon = spec.find(':');
+    out.name = spec.substr(0, colon);
+    if (out.name.empty()) return false;
+    if (colon == std::string::npos) return true;
+
+    size_t pos = colon + 1;
+    while (pos < spec.size()) {
+        size_t comma = spec.find(',', pos);
+        std::string item = spec.substr(pos, comma == std::string::npos ? std::string::npos
+                                                                          : comma - pos);
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) return false;
+        char* end = nullptr;
+        double value = std::strtod(item.c_str() + eq + 1, &end);
+        if (end == item.c_str() + eq + 1 ||
+            !WhatIfEngine::apply_override(out.tuning, item.substr(0, eq), value)) {
+            return false;
+        }
+        if (comma == std::string::npos) break;
+        pos = comma + 1;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> session_ids;
+    std::vector<WhatIfConfig> configs{{"baseline", config::ControlTuning{}}};
+    WhatIfEngine::Options options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--list-keys") {
+            for (const auto& key : WhatIfEngine::tunable_keys()) std::cout << key << "\n";
+            return 0;
+        } else if (arg == "--csv") {
+            options.replay.prefer_csv = true;
+        } else if ((arg == "--config" || arg == "--workers") && i + 1 < argc) {
+            std::string value = argv[++i];
+            if (arg == "--workers") {
+                options.worker_threads = static_cast<size_t>(std::strtoul(value.c_str(), nullptr, 10));
+                continue;
+            }
+            WhatIfConfig cfg;
+            if (!parse_config(value, cfg)) {
+                std::cerr << "Error: bad --config '" << value << "' (see --list-keys)\n";
+                return 1;
+            }
+            configs.push_back(cfg);
+        } else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Error: unknown option " << arg << "\n";
+            return 1;
+        } else {
+            session_ids.push_back(arg);
+        }
+    }
+    if (session_ids.empty()) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <session_id>... [--config NAME:key=value[,key=value...]]..."
+                  << " [--workers N] [--csv] [--list-keys]\n";
+        return 1;
+    }
+
+    PatientProfile profile;
+    profile.weight_kg = 75.0;
+    profile.age_years = 35.0;
+    profile.baseline_hr_bpm = 70.0;
+    profile.max_safe_infusion_rate = 1.5;
+    profile.current_tissue_perfusion = 0.85;
+    profile.energy_params = EnergyTransferParams();
+
+    std::vector<WhatIfSession> sessions;
+    try {
+        for (const auto& id : session_ids) {
+            sessions.push_back({ReplayLogger::load_session(id), profile});
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    WhatIfResult result = WhatIfEngine(options).run(sessions, configs);
+    for (size_t s = 0; s < sessions.size(); ++s) {
+        if (!result.session_errors[s].empty()) {
+            std::cerr << "Skipped " << session_ids[s] << ": " << result.session_errors[s] << "\n";
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(3)
+              << sessions.size() << " session(s) x " << configs.size() << " config(s) in "
+              << result.wall_seconds << " s (" << result.steals << " steals)\n\n"
+              << std::left << std::setw(16) << "config" << std::right
+              << std::setw(10) << "ticks" << std::setw(11) << "overrides"
+              << std::setw(13) << "rate_limited" << std::setw(13) << "volume_ml"
+              << std::setw(11) << "mean_rate" << std::setw(15) << "mean_|d_rate|"
+              << std::setw(14) << "max_|d_rate|" << "\n";
+    for (const auto& a : result.per_config) {
+        std::cout << std::left << std::setw(16) << a.config_name << std::right
+                  << std::setw(10) << a.ticks << std::setw(11) << a.safety_overrides
+                  << std::setw(13) << a.rate_limited_ticks
+                  << std::setw(13) << std::setprecision(1) << a.total_volume_ml
+                  << std::setw(11) << std::setprecision(3) << a.mean_rate_ml_min
+                  << std::setw(15) << std::setprecision(4) << a.mean_abs_rate_change
+                  << std::setw(14) << a.max_abs_rate_change << "\n";
+    }
+    return 0;
+}